@@ -52,6 +52,7 @@
 #include <boost/algorithm/string/replace.hpp>
 #include <boost/regex.hpp>
 #include <boost/foreach.hpp>
+#include <boost/bind.hpp>
 #ifdef  HAVE_LIBNUMA
 #include <numa.h>
 #endif
@@ -264,7 +265,8 @@ GPP_i::component_description::component_description() :
   app_started(false),
   reservation(-1.0),
   terminated(false),
-  pstat_idx(0)
+  pstat_idx(0),
+  pstat_samples(0)
 { memset(pstat_history, 0, sizeof(pstat_history) ); }
 
 
@@ -275,7 +277,8 @@ GPP_i::component_description::component_description( const std::string &appId) :
   app_started(false),
   reservation(-1.0),
   terminated(false),
-  pstat_idx(0)
+  pstat_idx(0),
+  pstat_samples(0)
 { memset(pstat_history, 0, sizeof(pstat_history) ); }
 
 
@@ -298,6 +301,7 @@ void GPP_i::component_description::add_history( int64_t ptime ) {
   if ( ptime == -1 ) ptime=0; /// Log error ..
   pstat_idx = (pstat_idx + 1)% pstat_history_len;
   pstat_history[pstat_idx] = ptime;
+  pstat_samples++;
 }
 
 void GPP_i::component_description::add_history( ) {
@@ -305,10 +309,13 @@ void GPP_i::component_description::add_history( ) {
   if ( ptime < 0 ) ptime=0; /// Log error ..
   pstat_idx = (pstat_idx + 1)% pstat_history_len;
   pstat_history[pstat_idx] = ptime;
+  pstat_samples++;
 }
 
 int64_t  GPP_i::component_description::get_pstat_usage( bool refresh) {
   if ( refresh) add_history();
+  // the first sample has no interval to measure against
+  if ( pstat_samples < 2 ) return 0;
   int64_t retval=0;
   int8_t p1_idx = pstat_idx -1;
   if ( p1_idx < 0 ) p1_idx = pstat_history_len-1;
@@ -402,6 +409,8 @@ void GPP_i::_init() {
   s << tmp_user_id;
   user_id = s.str();
   n_reservations =0;
+  last_total_ticks = -1;
+  last_busy_ticks = -1;
   sig_fd = -1;
 
   //
@@ -517,6 +526,14 @@ void GPP_i::postConstruction (std::string &profile,
 
   _signalThread.start();
 
+  // start the process launcher, components are forked from it instead of this process
+  if ( _launcher.start() ) {
+    LOG_INFO(GPP_i, "Process launcher started, components will be spawned through the launcher");
+  }
+  else {
+    LOG_WARN(GPP_i, "Unable to start process launcher, components will be forked from the GPP (errno: " << errno << ")");
+  }
+
 }
 
 void GPP_i::update_grp_child_pids() {
@@ -813,14 +830,19 @@ GPP_i::initializeResourceMonitors()
 
   data_model.push_back( system_monitor );
 
-  // add system limits reader
+  // system wide limits change slowly, read them at most once a second
+  system_monitor->getSysLimits()->set_refresh_interval( 1.0 );
+
+  // add system limits reader, process limits are updated by the data model and by update()
+  // on each cycle, only read them once per cycle
   process_limits.reset( new ProcessLimits( getpid() ) );
+  process_limits->set_refresh_interval( threshold_cycle_time / 2000.0 );
 
   data_model.push_back( process_limits );
 
   //  observer to monitor when cpu idle pass threshold value
   addThresholdMonitor( ThresholdMonitorPtr( new CpuThresholdMonitor(_identifier, &modified_thresholds.cpu_idle,
-                                                                    *(system_monitor->getCpuStats()), false )));
+                                                                    *(system_monitor->getCpuStats()), false, &cpu_idle_window )));
 
   // add available memory monitor, mem_free defaults to MB
   addThresholdMonitor( ThresholdMonitorPtr( new FreeMemoryThresholdMonitor(_identifier,
@@ -972,6 +994,7 @@ void GPP_i::initialize() throw (CF::LifeCycle::InitializeError, CORBA::SystemExc
   gpp_limits.max_threads = pid_rpt.threads_limit;
   gpp_limits.current_open_files = pid_rpt.files;
   gpp_limits.max_open_files = pid_rpt.files_limit;
+  gpp_limits.component_threads = pid_rpt.component_threads;
 
   // enable monitors to push out state change events..
   MonitorSequence::iterator iter=threshold_monitors.begin();
@@ -1050,6 +1073,8 @@ void GPP_i::releaseObject() throw (CORBA::SystemException, CF::LifeCycle::Releas
   _handle_io_redirects = false;
   _redirectedIO.stop();
   _redirectedIO.release();
+  // the SIGCHLD thread no longer reaps children, stop and reap the launcher helper here
+  _launcher.stop();
   if ( odm_consumer ) odm_consumer.reset();
   GPP_base::releaseObject();
 }
@@ -1281,6 +1306,14 @@ CF::ExecutableDevice::ProcessID_Type GPP_i::do_execute (const char* name, const
         argv[i] = const_cast<char*> (args[i].c_str());
     }
 
+    // the resource's environment, including thread level affinity directives, is built before
+    // fork since the child of a multithreaded process may only make async-signal-safe calls
+    std::vector<std::string> environment = redhawk::affinity::thread_environment( options );
+    std::vector<char*> envp(environment.size() + 1, NULL);
+    for (std::size_t i = 0; i < environment.size(); ++i) {
+        envp[i] = const_cast<char*> (environment[i].c_str());
+    }
+
     rh_logger::LevelPtr  lvl = GPP_i::__logger->getLevel();
 
     // setup to capture stdout and stderr from children.
@@ -1298,8 +1331,50 @@ CF::ExecutableDevice::ProcessID_Type GPP_i::do_execute (const char* name, const
  
     }
     
+    // spawn through the launcher unless nic affinity without a blacklist is requested, which
+    // binds memory with numa_bind and only applies from inside the new process. The launcher
+    // restarts its helper if it has exited, and reports unavailable if that fails
+    int pid = -1;
+    bool launched = false;
+    if ( _launcher.is_running() && !( redhawk::affinity::has_nic_affinity(options) && bl_cpus.empty() ) ) {
+      ProcessLauncher::Request request;
+      request.argv = args;
+      request.search_path = ( args[0] == "valgrind" );
+      request.redirect_fd = _handle_io_redirects ? comp_fd[1] : -1;
+      std::string thread_directives = redhawk::affinity::format_thread_directives( options );
+      if ( !thread_directives.empty() ) {
+        request.environment.push_back( redhawk::affinity::THREAD_AFFINITY_ENV + "=" + thread_directives );
+      }
+
+      int error = 0;
+      ProcessLauncher::Result result = _launcher.launch( request, 
+                                                         boost::bind( &GPP_i::_prepare_launch, this, boost::cref(options), std::string(name), _1 ),
+                                                         pid, error );
+      if ( result == ProcessLauncher::LAUNCHED ) {
+        launched = true;
+        ProcessLauncher::Metrics metrics = _launcher.get_metrics();
+        LOG_DEBUG(GPP_i, "Launched process " << path << " pid: " << pid << " latency(ms) last/mean/max: " << 
+                  metrics.last_ms << "/" << metrics.mean_ms << "/" << metrics.max_ms << " launches: " << metrics.launches << " failures: " << metrics.failures );
+      }
+      else if ( result == ProcessLauncher::FAILED ) {
+        LOG_ERROR(GPP_i, "Error when launching process (cmd=" << path << " errno=" << error << " msg=\"" << strerror(error) << "\")");
+        if ( _handle_io_redirects ) {
+          close(comp_fd[0]);
+          close(comp_fd[1]);
+        }
+        launched = true;
+        pid = -1;
+        errno = error;
+      }
+      else {
+        LOG_WARN(GPP_i, "Process launcher is not available, forking process " << path);
+      }
+    }
+
     // fork child process
-    int pid = fork();
+    if ( !launched ) {
+      pid = fork();
+    }
 
     if (pid == 0) {
 
@@ -1366,9 +1441,9 @@ CF::ExecutableDevice::ProcessID_Type GPP_i::do_execute (const char* name, const
         {
           if (strcmp(argv[0], "valgrind") == 0) {
               // Find valgrind in the path
-              returnval = execvp(argv[0], &argv[0]);
+              returnval = execvpe(argv[0], &argv[0], &envp[0]);
           } else {
-              returnval = execv(argv[0], &argv[0]);
+              returnval = execve(argv[0], &argv[0], &envp[0]);
           }
 
           num_retries--;
@@ -1389,7 +1464,7 @@ CF::ExecutableDevice::ProcessID_Type GPP_i::do_execute (const char* name, const
         exit(returnval);
     }
     else if (pid < 0 ){
-        LOG_ERROR(GPP_i, "Error forking child process (errno: " << errno << " msg=\"" << strerror(errno) << "\")" );
+        LOG_ERROR(GPP_i, "Error creating child process (errno: " << errno << " msg=\"" << strerror(errno) << "\")" );
         switch (errno) {
             case E2BIG:
                 throw CF::ExecutableDevice::ExecuteFail(CF::CF_E2BIG,
@@ -1511,26 +1586,32 @@ bool GPP_i::_check_thread_limits( const thresholds_struct &thresholds)
 {
     float _tthreshold = 1 - __thresholds.threads * .01;
 
-    if (gpp_limits.max_threads != -1) {
-      //
-      // check current process limits
-      //
-      LOG_TRACE(GPP_i, "_gpp_check_limits threads (cur/max): "  << gpp_limits.current_threads << "/" << gpp_limits.max_threads );
-      if (gpp_limits.current_threads>(gpp_limits.max_threads*_tthreshold)) {
-        LOG_WARN(GPP_i, "GPP process thread limit threshold exceeded,  count/threshold: " <<  gpp_limits.current_threads   << "/" << (gpp_limits.max_threads*_tthreshold) );
-        return true;
+    //
+    // check current process limits, RLIMIT_NPROC counts every thread owned by the user so the
+    // threads of the deployed components count against it as well
+    //
+    const int64_t threads = (int64_t)gpp_limits.current_threads + gpp_limits.component_threads;
+    if ( gpp_threads_threshold.check( threads, gpp_limits.max_threads, _tthreshold ) ) {
+      if ( gpp_threads_threshold.changed() ) {
+        LOG_WARN(GPP_i, "GPP process thread limit threshold exceeded,  count(gpp+components)/threshold: " <<  gpp_limits.current_threads << "+" << gpp_limits.component_threads << "/" << gpp_threads_threshold.threshold() );
       }
+      return true;
+    }
+    if ( gpp_threads_threshold.changed() ) {
+      LOG_TRACE(GPP_i, "_gpp_check_limits threads (cur/max): "  << threads << "/" << gpp_limits.max_threads );
     }
 
-    if ( sys_limits.max_threads != -1 ) {
-      //
-      // check current system limits
-      //
-      LOG_TRACE(GPP_i, "_sys_check_limits threads (cur/max): "  << sys_limits.current_threads << "/" << sys_limits.max_threads );
-      if (sys_limits.current_threads>( sys_limits.max_threads *_tthreshold)) {
-        LOG_WARN(GPP_i, "SYSTEM thread limit threshold exceeded,  count/threshold: " <<  sys_limits.current_threads   << "/" << (sys_limits.max_threads*_tthreshold) );
-        return true;
+    //
+    // check current system limits
+    //
+    if ( sys_threads_threshold.check( sys_limits.current_threads, sys_limits.max_threads, _tthreshold ) ) {
+      if ( sys_threads_threshold.changed() ) {
+        LOG_WARN(GPP_i, "SYSTEM thread limit threshold exceeded,  count/threshold: " <<  sys_limits.current_threads   << "/" << sys_threads_threshold.threshold() );
       }
+      return true;
+    }
+    if ( sys_threads_threshold.changed() ) {
+      LOG_TRACE(GPP_i, "_sys_check_limits threads (cur/max): "  << sys_limits.current_threads << "/" << sys_limits.max_threads );
     }
     return false;
 }
@@ -1539,26 +1620,30 @@ bool GPP_i::_check_file_limits( const thresholds_struct &thresholds)
 {
     float _fthreshold = 1 - __thresholds.files_available * .01;
 
-    if (gpp_limits.max_open_files != -1) {
-      //
-      // check current process limits
-      //
-      LOG_TRACE(GPP_i, "_gpp_check_limits threads (cur/max): "  << gpp_limits.current_open_files << "/" << gpp_limits.max_open_files );
-      if (gpp_limits.current_open_files>(gpp_limits.max_open_files*_fthreshold)) {
-        LOG_WARN(GPP_i, "GPP process thread limit threshold exceeded,  count/threshold: " <<  gpp_limits.current_open_files   << "/" << (gpp_limits.max_open_files*_fthreshold) );
-        return true;
+    //
+    // check current process limits
+    //
+    if ( gpp_files_threshold.check( gpp_limits.current_open_files, gpp_limits.max_open_files, _fthreshold ) ) {
+      if ( gpp_files_threshold.changed() ) {
+        LOG_WARN(GPP_i, "GPP process file limit threshold exceeded,  count/threshold: " <<  gpp_limits.current_open_files   << "/" << gpp_files_threshold.threshold() );
       }
+      return true;
+    }
+    if ( gpp_files_threshold.changed() ) {
+      LOG_TRACE(GPP_i, "_gpp_check_limits files (cur/max): "  << gpp_limits.current_open_files << "/" << gpp_limits.max_open_files );
     }
 
-    if ( sys_limits.max_open_files != -1 ) {
-      //
-      // check current system limits
-      //
-      LOG_TRACE(GPP_i, "_sys_check_limits threads (cur/max): "  << sys_limits.current_open_files << "/" << sys_limits.max_open_files );
-      if (sys_limits.current_open_files>( sys_limits.max_open_files *_fthreshold)) {
-        LOG_WARN(GPP_i, "SYSTEM thread limit threshold exceeded,  count/threshold: " <<  sys_limits.current_open_files   << "/" << (sys_limits.max_open_files*_fthreshold) );
-        return true;
+    //
+    // check current system limits
+    //
+    if ( sys_files_threshold.check( sys_limits.current_open_files, sys_limits.max_open_files, _fthreshold ) ) {
+      if ( sys_files_threshold.changed() ) {
+        LOG_WARN(GPP_i, "SYSTEM file limit threshold exceeded,  count/threshold: " <<  sys_limits.current_open_files   << "/" << sys_files_threshold.threshold() );
       }
+      return true;
+    }
+    if ( sys_files_threshold.changed() ) {
+      LOG_TRACE(GPP_i, "_sys_check_limits files (cur/max): "  << sys_limits.current_open_files << "/" << sys_limits.max_open_files );
     }
     return false;
 }
@@ -1572,8 +1657,8 @@ bool GPP_i::_check_file_limits( const thresholds_struct &thresholds)
 
 void GPP_i::updateUsageState()
 {
-  double sys_idle = system_monitor->get_idle_percent();
-  double sys_idle_avg = system_monitor->get_idle_average();
+  double sys_idle = system_monitor->get_idle_window(cpu_idle_window);
+  double sys_idle_avg = system_monitor->get_idle_ewma();
   double sys_load = system_monitor->get_loadavg();
   int64_t mem_free = system_monitor->get_mem_free();
   
@@ -1598,7 +1683,7 @@ void GPP_i::updateUsageState()
                 " RESRV: threshold " <<  max_allowable_load << " Actual: " << subscribed  << std::endl <<
                 " Ingress threshold: " << mcastnicIngressThresholdValue << " capacity: " <<  mcastnicIngressCapacity  << std::endl <<
                 " Egress threshold: " << mcastnicEgressThresholdValue << " capacity: " <<  mcastnicEgressCapacity  << std::endl  <<
-                " Threads threshold: " << gpp_limits.max_threads << " Actual: " << gpp_limits.current_threads << std::endl <<
+                " Threads threshold: " << gpp_limits.max_threads << " Actual: " << gpp_limits.current_threads << " Components: " << gpp_limits.component_threads << std::endl <<
                 " NIC: " << std::endl << oss.str()
                 );
   }
@@ -1639,7 +1724,7 @@ void GPP_i::updateUsageState()
   }
   else if (!(thresholds.threads < 0) && _check_thread_limits(thresholds)) {
       std::ostringstream oss;
-      oss << "Threshold: " << gpp_limits.max_threads << " Actual: " << gpp_limits.current_threads;
+      oss << "Threshold: " << gpp_limits.max_threads << " Actual: " << gpp_limits.current_threads << " (+" << gpp_limits.component_threads << " component)";
       _setReason( "ULIMIT (MAX_THREADS)", oss.str() );
       setUsageState(CF::Device::BUSY);
   }
@@ -1699,6 +1784,24 @@ void GPP_i::_setReason( const std::string &reason, const std::string &event, con
     }
 }
 
+bool GPP_i::_prepare_launch( const CF::Properties &options, const std::string &name, const pid_t rsc_pid )
+{
+  // an affinity failure is only a warning, execute does not fail on it and the resource runs
+  // without the requested affinity
+  try {
+    RH_DEBUG(redhawk::affinity::get_affinity_logger(), " Calling set resource affinity....exec:" << name << " pid:" << rsc_pid << " options=" << options.length());
+    set_resource_affinity( options, rsc_pid, name.c_str() );
+  }
+  catch( redhawk::affinity::AffinityFailed &ex ) {
+    LOG_WARN(GPP_i, "Unable to satisfy affinity request for: " << name << " Reason: " << ex.what() );
+  }
+  catch( ... ) {
+    LOG_WARN(GPP_i, "Unhandled exception during affinity processing for resource: " << name  );
+  }
+  return true;
+}
+
+
 /**
   override ExecutableDevice::set_resource_affinity to handle localized settings.
   
@@ -1792,6 +1895,9 @@ int GPP_i::serviceFunction()
   
   time_mark = now;
 
+  // pick up changes to the smoothing period before the next cpu sample
+  system_monitor->getCpuStats()->set_ewma_period( cpu_idle_ewma_period );
+
   // update data model for the GPP
   try {      
     std::for_each( data_model.begin(), data_model.end(), boost::bind( &Updateable::update, _1 ) );
@@ -2369,53 +2475,19 @@ void GPP_i::update()
 {
   // establish what the actual load is per floor_reservation
   // if the actual load -per is less than the reservation, compute the different and add the difference to the cpu_idle
-  // read the clock from the system (start)
+  //
+  // the load is measured over the interval since the previous update, the system ticks and each
+  // process' time are sampled once per call and differenced against the prior sample
 
   int64_t user=0, system=0;
   ProcStat::GetTicks( system, user);
-  int64_t f_start_total = system;
-  int64_t f_use_start_total = user;
-  float reservation_set = 0;
-  size_t nres=0;
-  int64_t usage=0;
-
-  {
-    WriteLock rlock(pidLock);
-    
-    this->update_grp_child_pids();
-    
-    ProcessList::iterator i=this->pids.begin();
-    for ( ; i!=pids.end(); i++) {
-      
-      if ( !i->terminated ) {
-
-        // update pstat usage for each process
-        usage = i->get_pstat_usage();
-
-        if ( !i->app_started ) {
-          nres++;
-          if ( i->reservation == -1) {
-            reservation_set += idle_capacity_modifier;
-          } else {
-            reservation_set += 100.0 * i->reservation/((float)processor_cores);
-          }
-        }
-      }
-    }
-  }
-  LOG_TRACE(GPP_i, __FUNCTION__ << " Completed first pass, record pstats for nproc: " << nres << " res_set " << reservation_set );
-
-  // set number reservations that are not started
-  n_reservations = nres;
-  
-  // wait a little bit
-  usleep(500000);
-
-
-  user=0, system=0;
-  ProcStat::GetTicks( system, user);
+  int64_t f_start_total = ( last_total_ticks < 0 ) ? system : last_total_ticks;
+  int64_t f_use_start_total = ( last_busy_ticks < 0 ) ? user : last_busy_ticks;
   int64_t f_end_total = system;
   int64_t f_use_end_total = user;
+  last_total_ticks = system;
+  last_busy_ticks = user;
+
   float f_total = (float)(f_end_total-f_start_total);
   if ( f_total <= 0.0 ) {
     LOG_TRACE(GPP_i, __FUNCTION__ << std::endl<< " System Ticks end/start " << f_end_total << "/" << f_start_total << std::endl );
@@ -2424,9 +2496,16 @@ void GPP_i::update()
   float inverse_load_per_core = ((float)processor_cores)/(f_total);
   float aggregate_usage = 0;
   float non_specialized_aggregate_usage = 0;
+  float reservation_set = 0;
+  size_t nres=0;
+  int64_t usage=0;
   double percent_core;
 
-  ReadLock rlock(pidLock);
+  WriteLock rlock(pidLock);
+
+  this->update_grp_child_pids();
+  _update_tracked_pids();
+
   ProcessList::iterator i=this->pids.begin(); 
   int usage_out=0;
   for ( ; i!=pids.end(); i++, usage_out++) {
@@ -2457,7 +2536,15 @@ void GPP_i::update()
       }
 #endif
 
-      if ( i->app_started ) {
+      if ( !i->app_started ) {
+        nres++;
+        if ( res == -1) {
+          reservation_set += idle_capacity_modifier;
+        } else {
+          reservation_set += 100.0 * res/((float)processor_cores);
+        }
+      }
+      else {
 
         // if component is not using enough the add difference between minimum and current load
         if ( percent_core < res ) {
@@ -2473,8 +2560,11 @@ void GPP_i::update()
       }
     }
   }
+
+  // set number reservations that are not started
+  n_reservations = nres;
   
-  LOG_TRACE(GPP_i, __FUNCTION__ << " Completed SECOND pass, record pstats for processes" );
+  LOG_TRACE(GPP_i, __FUNCTION__ << " Completed pass, record pstats for nproc: " << pids.size() << " reservations: " << nres << " res_set " << reservation_set );
 
   aggregate_usage *= inverse_load_per_core;
   non_specialized_aggregate_usage *= inverse_load_per_core;
@@ -2489,6 +2579,8 @@ void GPP_i::update()
            " modified_threshold(req+res)=" << modified_thresholds.cpu_idle << std::endl << 
            " system: idle: " << system_monitor->get_idle_percent() << std::endl << 
            "         idle avg: " << system_monitor->get_idle_average() << std::endl << 
+           "         idle window: " << system_monitor->get_idle_window(cpu_idle_window) << std::endl << 
+           "         idle ewma: " << system_monitor->get_idle_ewma() << std::endl << 
            " threshold(req): " << __thresholds.cpu_idle << std::endl <<
            " idle modifier: " << idle_capacity_modifier << std::endl <<
            " reserved_cap_per_component: " << reserved_capacity_per_component << std::endl <<
@@ -2545,6 +2637,7 @@ void GPP_i::update()
   gpp_limits.max_threads = pid_rpt.threads_limit;
   gpp_limits.current_open_files = pid_rpt.files;
   gpp_limits.max_open_files = pid_rpt.files_limit;
+  gpp_limits.component_threads = pid_rpt.component_threads;
 }
 
 
@@ -2554,7 +2647,9 @@ int GPP_i::sigchld_handler(int sig)
   fd_set readfds;
   FD_ZERO(&readfds);
   FD_SET(sig_fd, &readfds);
-  struct timeval tv = {0, 50};
+  // block for up to the thread's interval waiting for a child to exit, so that
+  // children are reaped right away
+  struct timeval tv = {0, 100000};
   struct signalfd_siginfo si;
   ssize_t s;
   uint32_t cnt=1;
@@ -2565,6 +2660,9 @@ int GPP_i::sigchld_handler(int sig)
       FD_ZERO(&readfds);
       FD_SET(sig_fd, &readfds);
       select(sig_fd+1, &readfds, NULL, NULL, &tv);
+      // after the first wait, only drain pending events
+      tv.tv_sec = 0;
+      tv.tv_usec = 0;
       if (FD_ISSET(sig_fd, &readfds)) {
         LOG_TRACE(GPP_i, " Checking for signals from SIGNALFD(" << sig_fd << ") cnt:" << cnt++ );
         s = read(sig_fd, &si, sizeof(struct signalfd_siginfo));
@@ -2609,6 +2707,8 @@ int GPP_i::sigchld_handler(int sig)
   }
 
   //LOG_TRACE(GPP_i, "sigchld_handler RETURN.........loop cnt:" << cnt);
+  // the wait for events above replaces the thread's delay
+  if ( sig_fd > -1 ) return NORMAL;
   return NOOP;
 }
 
@@ -2745,6 +2845,7 @@ void GPP_i::addProcess(int pid, const std::string &appName, const std::string &i
   tmp.core_usage = 0;
   tmp.parent = this;
   pids.push_front( tmp );
+  _update_tracked_pids();
   LOG_DEBUG(GPP_i, "END Adding Process/RES: "  <<  pid << "/" << req_reservation << "  APP:" << appName );
 }
 
@@ -2765,6 +2866,25 @@ void GPP_i::markPidTerminated( const int pid)
     LOG_DEBUG(GPP_i, " Mark For Termination: "  <<  it->pid << "  APP:" << it->appName );
     it->app_started= false;
     it->terminated = true;
+    _update_tracked_pids();
+}
+
+void GPP_i::_update_tracked_pids()
+{
+  // thread accounting for the process limits only covers the component process groups, a
+  // group that has not been scanned yet is represented by its leader
+  std::vector<int> tracked_pids;
+  for ( ProcessList::iterator i=pids.begin(); i!=pids.end(); i++ ) {
+    if ( i->terminated ) continue;
+    std::map<int,grp_values>::const_iterator grp = grp_children.find(i->pid);
+    if ( grp != grp_children.end() ) {
+      tracked_pids.insert( tracked_pids.end(), grp->second.pids.begin(), grp->second.pids.end() );
+    }
+    else {
+      tracked_pids.push_back( i->pid );
+    }
+  }
+  if ( process_limits ) process_limits->set_tracked_pids( tracked_pids );
 }
 
 void GPP_i::removeProcess(int pid)
@@ -2776,6 +2896,7 @@ void GPP_i::removeProcess(int pid)
     if ( result != pids.end() ) {
       LOG_DEBUG(GPP_i, "Monitor Process: REMOVE Process: " << result->pid << " app: " << result->appName );
       pids.erase(result);
+      _update_tracked_pids();
     }
   }
 
@@ -33,6 +33,7 @@
 #include "reports/SystemMonitorReporting.h"
 #include "reports/CpuThresholdMonitor.h"
 #include "reports/NicThroughputThresholdMonitor.h"
+#include "utils/ProcessLauncher.h"
 #include "NicFacade.h"
 #include "ossie/Events.h"
 
@@ -162,6 +163,7 @@ class GPP_i : public GPP_base
           bool        terminated;
           uint64_t    pstat_history[pstat_history_len];
           uint8_t     pstat_idx;
+          uint32_t    pstat_samples;
           std::vector<int> pids;
           GPP_i       *parent;
 
@@ -263,6 +265,8 @@ class GPP_i : public GPP_base
 
           ProcessList                                         pids;
           size_t                                              n_reservations;
+          int64_t                                             last_total_ticks;      // /proc/stat totals from the previous update
+          int64_t                                             last_busy_ticks;
           Lock                                                pidLock;
           Lock                                                fdsLock;
           ProcessFds                                          redirectedFds;
@@ -275,6 +279,10 @@ class GPP_i : public GPP_base
           NicMonitorSequence                                  nic_monitors;
           SystemMonitorPtr                                    system_monitor;
           ProcessLimitsPtr                                    process_limits;
+          LimitThreshold                                      gpp_threads_threshold;
+          LimitThreshold                                      sys_threads_threshold;
+          LimitThreshold                                      gpp_files_threshold;
+          LimitThreshold                                      sys_files_threshold;
           ExecPartitionList                                   execPartitions;
         
           Lock                                                monitorLock;
@@ -313,6 +321,12 @@ class GPP_i : public GPP_base
 
           bool  _component_cleanup( const int pid, const int exit_status );
 
+          //
+          // pass the process groups of the deployed components to the process limits, caller
+          // must hold pidLock
+          //
+          void  _update_tracked_pids();
+
           //
           // setup execution partitions for launching components
           // 
@@ -332,6 +346,10 @@ class GPP_i : public GPP_base
           //
           int   _apply_affinity( const affinity_struct &affinity, const pid_t rsc_pid, const char *rsc_name  );
 
+          // apply placement to a process held by the launcher before it executes, affinity failures are
+          // logged and do not abort the launch
+          bool  _prepare_launch( const CF::Properties &options, const std::string &name, const pid_t rsc_pid );
+
           //
           // get the next available partition to use for luanching resources
           //
@@ -389,6 +407,7 @@ class GPP_i : public GPP_base
 
           std::string user_id;
           ossie::ProcessThread                                _signalThread;
+          ProcessLauncher                                     _launcher;
           ossie::ProcessThread                                _redirectedIO;
         };
 
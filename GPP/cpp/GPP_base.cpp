@@ -373,6 +373,24 @@ void GPP_base::loadProperties()
                 "milliseconds",
                 "external",
                 "property");
+
+    addProperty(cpu_idle_window,
+                1.0,
+                "cpu_idle_window",
+                "cpu_idle_window",
+                "readwrite",
+                "seconds",
+                "external",
+                "property");
+
+    addProperty(cpu_idle_ewma_period,
+                10.0,
+                "cpu_idle_ewma_period",
+                "cpu_idle_ewma_period",
+                "readwrite",
+                "seconds",
+                "external",
+                "property");
     
     addProperty(gpp_limits,
                 ulimit_struct(),
@@ -82,6 +82,10 @@ class GPP_base : public ExecutableDevice_impl, protected ThreadedComponent
         std::string busy_reason;
         // time between cycles to refresh threshold metrics
         CORBA::ULong threshold_cycle_time;
+        // seconds of history used for the cpu idle measurement
+        double cpu_idle_window;
+        // time constant of the smoothed cpu idle measurement
+        double cpu_idle_ewma_period;
         // ulimits for the GPP process
         ulimit_struct gpp_limits;
         // ulimits for the system as a whole
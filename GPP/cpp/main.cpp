@@ -18,11 +18,14 @@
  * along with this program.  If not, see http://www.gnu.org/licenses/.
  */
 #include <iostream>
+#include <cstring>
+#include <cstdlib>
 #include <string>
 #include <vector>
 #include "ossie/ossieSupport.h"
 
 #include "GPP.h"
+#include "utils/ProcessLauncher.h"
 
 GPP_i *devicePtr;
 
@@ -36,6 +39,12 @@ void signal_catcher(int sig)
 }
 int main(int argc, char* argv[])
 {
+  // the GPP re-executes itself as its process launcher, serve launch requests instead of
+  // starting the device
+  if ( argc > 2 && strcmp(argv[1], ProcessLauncher::LAUNCHER_ARG) == 0 ) {
+    return ProcessLauncher::serve( atoi(argv[2]) );
+  }
+
   //
   // Install signal handler for processing SIGCHLD through
   // signal file descriptor to avoid whitelist/blacklist function calls
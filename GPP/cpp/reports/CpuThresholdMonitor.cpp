@@ -24,21 +24,27 @@
 class CpuUsageAccumulatorQueryFunction
 {
 public:
-	CpuUsageAccumulatorQueryFunction( const CpuStatistics& cpu_usage_accumulator ):
-	cpu_usage_accumulator_(cpu_usage_accumulator)
+	CpuUsageAccumulatorQueryFunction( const CpuStatistics& cpu_usage_accumulator, const double* window ):
+	cpu_usage_accumulator_(cpu_usage_accumulator),
+	window_(window)
 	{}
 
-	float operator()() const { return cpu_usage_accumulator_.get_idle_percent(); }
+	float operator()() const {
+		if ( window_ && *window_ > 0.0 ) return cpu_usage_accumulator_.get_idle_window(*window_);
+		return cpu_usage_accumulator_.get_idle_percent();
+	}
 
 private:
 	const CpuStatistics& cpu_usage_accumulator_;
+	const double*        window_;
 };
 
 CpuThresholdMonitor::CpuThresholdMonitor( const std::string& source_id, 
                                           const float* threshold, 
                                           const CpuStatistics & cpu_usage_accumulator,
-                                          const bool enableDispatch ):
-  GenericThresholdMonitor<float>(source_id, GetResourceId(), GetMessageClass(), MakeCref(*threshold), CpuUsageAccumulatorQueryFunction(cpu_usage_accumulator), enableDispatch )
+                                          const bool enableDispatch,
+                                          const double* window ):
+  GenericThresholdMonitor<float>(source_id, GetResourceId(), GetMessageClass(), MakeCref(*threshold), CpuUsageAccumulatorQueryFunction(cpu_usage_accumulator, window), enableDispatch )
 {
 
 }
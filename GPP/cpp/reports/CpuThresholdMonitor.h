@@ -26,8 +26,10 @@
 class CpuThresholdMonitor : public GenericThresholdMonitor<float>
 {
 public:
+  // window: seconds of history the idle measurement covers, read on each check; NULL or 0 uses
+  // the most recent interval
   CpuThresholdMonitor( const std::string& source_id, const float* threshold, const CpuStatistics & cpu_usage_accumulator,
-                       const bool enableDispatch=false );
+                       const bool enableDispatch=false, const double* window=0 );
 
 	static std::string GetResourceId(){ return "cpu"; }
 	static std::string GetMessageClass(){ return "CPU_IDLE"; }
@@ -53,6 +53,14 @@ double SystemMonitor::get_idle_average() const {
   return cpu_usage_stats_->get_idle_average();
 }
 
+double SystemMonitor::get_idle_window( const double window ) const {
+  return cpu_usage_stats_->get_idle_window( window );
+}
+
+double SystemMonitor::get_idle_ewma() const {
+  return cpu_usage_stats_->get_idle_ewma();
+}
+
 uint64_t SystemMonitor::get_mem_free() const {
  return report_.virtual_memory_free;
 }
@@ -81,6 +89,10 @@ const SystemMonitor::CpuStatsPtr SystemMonitor::getCpuStats() const {
   return cpu_usage_stats_;
 }
 
+const SysLimitsPtr SystemMonitor::getSysLimits() const {
+  return sys_limit_state_;
+}
+
 void
 SystemMonitor::report()
 {
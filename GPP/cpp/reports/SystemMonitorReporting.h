@@ -71,6 +71,8 @@ public:
  
   double   get_idle_percent() const;
   double   get_idle_average() const;
+  double   get_idle_window( const double window ) const;
+  double   get_idle_ewma() const;
   uint64_t get_mem_free() const;
   uint64_t get_phys_free() const;
   uint64_t get_all_usage() const;
@@ -79,6 +81,7 @@ public:
   const Report &getReport() const;
   void report();
   const CpuStatsPtr getCpuStats() const;
+  const SysLimitsPtr getSysLimits() const;
     
 private:
     CpuStatsPtr     cpu_usage_stats_;
@@ -23,6 +23,7 @@
 #include <sstream>
 #include <fstream>
 #include <linux/limits.h>
+#include <time.h>
 #include <sys/time.h>
 #include <sys/resource.h>
 #include <boost/asio.hpp>
@@ -31,7 +32,6 @@
 #include <boost/algorithm/string.hpp>
 #include <boost/filesystem/operations.hpp>
 #include "Limits.h"
-#include "utils/popen.h"
 
 #if BOOST_FILESYSTEM_VERSION < 3
 #define BOOST_PATH_STRING(x) (x)
@@ -52,7 +52,9 @@ Limits::get() const
   return contents;
 }
 
-Limits::Limits()
+Limits::Limits() :
+  refresh_interval(0.0),
+  last_refresh(-1.0)
 {
 }
 
@@ -62,6 +64,53 @@ Limits::~Limits()
 
 
 
+void Limits::set_refresh_interval( const double seconds )
+{
+  refresh_interval = seconds;
+}
+
+double Limits::get_refresh_interval() const
+{
+  return refresh_interval;
+}
+
+bool Limits::_refresh_due()
+{
+  struct timespec ts;
+  clock_gettime( CLOCK_MONOTONIC, &ts );
+  double now = (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+  if ( last_refresh >= 0.0 && ( now - last_refresh ) < refresh_interval ) {
+    return false;
+  }
+  last_refresh = now;
+  return true;
+}
+
+
+//
+// read the num_threads field (20) from /proc/<pid>/stat, the command name is skipped
+// by searching for its closing paren since it may contain spaces
+//
+static int64_t _read_num_threads( const int pid )
+{
+  std::ostringstream fname;
+  fname << "/proc/" << pid << "/stat";
+  std::ifstream stat_file(fname.str().c_str(), std::ifstream::in);
+  if ( !stat_file.good() ) return 0;
+  std::string line;
+  std::getline( stat_file, line );
+  std::string::size_type pos = line.rfind(')');
+  if ( pos == std::string::npos ) return 0;
+  std::istringstream fields( line.substr(pos+1) );
+  std::string field;
+  // state is field 3, num_threads is field 20
+  for ( int i=3; i < 20 && (fields >> field); i++ );
+  int64_t nthreads=0;
+  if ( !(fields >> nthreads) ) return 0;
+  return nthreads;
+}
+
+
 SysLimits::SysLimits()
 {
 }
@@ -72,6 +121,8 @@ SysLimits::~SysLimits()
 
 void SysLimits::update_state()
 {
+  if ( !_refresh_due() ) return;
+
   Contents tmp;
 
   //  grab current file handles 
@@ -121,21 +172,28 @@ void SysLimits::update_state()
   catch( ... ) {
   }
 
-  try {
-    std::string line = utils::popen("ps -eo nlwp | tail -n +2 | awk '{ num_threads += $1 } END { print num_threads }' ", true);
-    if ( line != "ERROR" ) {
+  //  the fourth field of loadavg is runnable/total scheduling entities, total is the
+  //  number of threads on the system
+  try{
+    fname = "/proc/loadavg";
+    std::ifstream loadavg(fname.c_str(), std::ifstream::in);
+    if ( !loadavg.good()) throw std::ifstream::failure("unable to open " + fname );
+    std::string line;
+    if ( std::getline( loadavg, line ) ) {
       std::vector<std::string> values;
-      boost::split(values, line, boost::is_any_of(std::string(" \t")), boost::algorithm::token_compress_on );
-      DEBUG(" system active threads: " << line);
-      if ( values.size() > 0 ) {
-        try {
-          tmp.threads = boost::lexical_cast<int>( values[0] );
-        }
-        catch( boost::bad_lexical_cast ){
+      boost::split( values, line, boost::is_any_of(std::string(" \t")), boost::algorithm::token_compress_on );
+      DEBUG(" loadavg line: " << line);
+      if ( values.size() > 3 ) {
+        std::string::size_type pos = values[3].find('/');
+        if ( pos != std::string::npos ) {
+          try {
+            tmp.threads = boost::lexical_cast<int64_t>( values[3].substr(pos+1) );
+          }
+          catch( boost::bad_lexical_cast ){
+          }
         }
       }
     }
-
   }
   catch( ... ) {
   }
@@ -156,8 +214,21 @@ ProcessLimits::~ProcessLimits()
 {
 }
 
+void ProcessLimits::set_tracked_pids( const std::vector<int> &pids )
+{
+  boost::mutex::scoped_lock lock(tracked_lock);
+  if ( pids != tracked_pids ) {
+    tracked_pids = pids;
+    last_refresh = -1.0;
+  }
+}
+
 void ProcessLimits::update_state()
 {
+  // the tracked pids are set by the threads that launch and reap components
+  boost::mutex::scoped_lock lock(tracked_lock);
+  if ( !_refresh_due() ) return;
+
   Contents tmp;
 
   if ( pid < 0 ) pid = getpid();
@@ -209,6 +280,11 @@ void ProcessLimits::update_state()
     }
   }
 
+  std::vector<int>::const_iterator tpid = tracked_pids.begin();
+  for ( ; tpid != tracked_pids.end(); tpid++ ) {
+    if ( *tpid != pid ) tmp.component_threads += _read_num_threads( *tpid );
+  }
+
   std::stringstream subfilepath;
   subfilepath<< BOOST_PATH_STRING(pid_dir)<<"/fd/";
   boost::filesystem::path subFilePath(subfilepath.str());
@@ -219,13 +295,52 @@ void ProcessLimits::update_state()
     }
   }
 
-  DEBUG( " Process: threads/max " << tmp.threads << "/" << tmp.threads_limit  );
+  DEBUG( " Process: threads/components/max " << tmp.threads << "/" << tmp.component_threads << "/" << tmp.threads_limit  );
   DEBUG( " Process: files/max " << tmp.files << "/" << tmp.files_limit  );
 
   contents = tmp;
 }
 
 
+LimitThreshold::LimitThreshold() :
+  valid(false),
+  count(0),
+  limit(-1),
+  fraction(0.0),
+  level(0.0),
+  exceeded(false),
+  transition(false)
+{
+}
 
+bool LimitThreshold::check( const int64_t in_count, const int64_t in_limit, const double in_fraction )
+{
+  if ( valid && in_count == count && in_limit == limit && in_fraction == fraction ) {
+    transition = false;
+    return exceeded;
+  }
 
+  // the level only moves when the limit or the fraction does
+  if ( !valid || in_limit != limit || in_fraction != fraction ) {
+    level = in_limit * in_fraction;
+  }
+  count = in_count;
+  limit = in_limit;
+  fraction = in_fraction;
+
+  bool last = exceeded;
+  exceeded = ( limit >= 0 ) && ( count > level );
+  transition = ( exceeded != last );
+  valid = true;
+  return exceeded;
+}
 
+bool LimitThreshold::changed() const
+{
+  return transition;
+}
+
+double LimitThreshold::threshold() const
+{
+  return level;
+}
@@ -24,6 +24,7 @@
 #include <string>
 #include <vector>
 #include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
 #include "states/State.h"
 
 class Limits;
@@ -41,11 +42,12 @@ class Limits : public State
 
  public:
   struct Contents {
-  Contents() : threads(0), threads_limit(-1), files(0), files_limit(-1) {};
+  Contents() : threads(0), threads_limit(-1), files(0), files_limit(-1), component_threads(0) {};
     int64_t          threads;
     int64_t          threads_limit;
     int64_t          files;
     int64_t          files_limit;
+    int64_t          component_threads;   // threads of the tracked processes, not part of threads
   };
 
     
@@ -58,10 +60,20 @@ class Limits : public State
 
   // return contents of file
   const Contents    &get() const;
+
+  // minimum seconds between reads of the /proc sources, updates inside the interval
+  // keep the cached contents.  0 reads on every update
+  void              set_refresh_interval( const double seconds );
+  double            get_refresh_interval() const;
     
  protected:
 
+  // true if the refresh interval has elapsed since the last read, marks the read time
+  bool              _refresh_due();
+
   Contents        contents;
+  double          refresh_interval;
+  double          last_refresh;
 
  private:
 
@@ -95,9 +107,49 @@ class ProcessLimits : public Limits
 
   void              update_state();
 
+  // additional processes whose threads are totaled in component_threads (i.e. deployed
+  // components, RLIMIT_NPROC applies to all threads owned by the user), a change to the
+  // list is picked up by the next update regardless of the refresh interval
+  void              set_tracked_pids( const std::vector<int> &pids );
+
  protected:
 
-  int pid;
+  int               pid;
+  std::vector<int>  tracked_pids;
+  boost::mutex      tracked_lock;
+
+};
+
+
+//
+// Tracks whether a count is above a fraction of its limit.  The outcome is only
+// re-evaluated when the count, the limit or the fraction has changed since the
+// previous check, so checks between refreshes of the limits cost a comparison
+//
+class LimitThreshold
+{
+
+ public:
+  LimitThreshold();
+
+  // returns true if count is above limit*fraction, a negative limit is unlimited
+  bool              check( const int64_t count, const int64_t limit, const double fraction );
+
+  // true if the last check changed the outcome (the first check starts from not exceeded)
+  bool              changed() const;
+
+  // count that must be exceeded, as of the last check
+  double            threshold() const;
+
+ private:
+
+  bool              valid;
+  int64_t           count;
+  int64_t           limit;
+  double            fraction;
+  double            level;
+  bool              exceeded;
+  bool              transition;
 
 };
 
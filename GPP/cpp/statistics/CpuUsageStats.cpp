@@ -19,6 +19,8 @@
  */
 #include <numeric>
 #include <iostream>
+#include <cmath>
+#include <time.h>
 #include "CpuUsageStats.h"
 
 
@@ -28,6 +30,15 @@
 #define DEBUG(x)            
 #endif
 
+static double _monotonic_seconds()
+{
+  struct timespec ts;
+  clock_gettime( CLOCK_MONOTONIC, &ts );
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+const double CpuUsageStats::DEFAULT_EWMA_PERIOD = 10.0;
+
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -41,9 +52,13 @@ CpuUsageStats::CpuUsageStats( const int nhistory ):
   cpus_(0),
   metrics_(ProcStat::CPU_JIFFIES_MAX, 0.0 ),
   average_(ProcStat::CPU_JIFFIES_MAX , 0.0 ),
-  history_db_(nhistory)
+  history_db_(nhistory),
+  samples_(DEFAULT_NSAMPLES),
+  ewma_period_(DEFAULT_EWMA_PERIOD),
+  idle_ewma_(-1.0)
 {
   _update_stats();
+  _add_sample();
 }
 
 CpuUsageStats::CpuUsageStats(const CpuList &cpus, const int nhistory  ):
@@ -51,9 +66,13 @@ CpuUsageStats::CpuUsageStats(const CpuList &cpus, const int nhistory  ):
   cpus_(cpus),
   metrics_(ProcStat::CPU_JIFFIES_MAX , 0.0 ),
   average_(ProcStat::CPU_JIFFIES_MAX , 0.0 ),
-  history_db_(nhistory)
+  history_db_(nhistory),
+  samples_(DEFAULT_NSAMPLES),
+  ewma_period_(DEFAULT_EWMA_PERIOD),
+  idle_ewma_(-1.0)
 {
   _update_stats();
+  _add_sample();
 }
 
 
@@ -66,6 +85,43 @@ CpuUsageStats::CpuUsageStats(const CpuUsageStats &src  )
     metrics_ = src.metrics_;
     average_ = src.average_;
     history_db_ = src.history_db_;
+    cpus_all_itv = src.cpus_all_itv;
+    cpus_user_itv = src.cpus_user_itv;
+    boost::mutex::scoped_lock lock(src.samples_lock_);
+    samples_ = src.samples_;
+    ewma_period_ = src.ewma_period_;
+    idle_ewma_ = src.idle_ewma_;
+}
+
+CpuUsageStats &CpuUsageStats::operator=(const CpuUsageStats &src  )
+{
+    if ( this == &src ) return *this;
+
+    prev_cpus_stat_ = src.prev_cpus_stat_;
+    current_cpus_stat_ = src.current_cpus_stat_;
+    proc_stat_ = src.proc_stat_;
+    cpus_ = src.cpus_;
+    metrics_ = src.metrics_;
+    average_ = src.average_;
+    history_db_ = src.history_db_;
+    cpus_all_itv = src.cpus_all_itv;
+    cpus_user_itv = src.cpus_user_itv;
+
+    // copy under the source's lock, then publish under ours, so the two locks are never held together
+    SampleHistory samples;
+    double ewma_period;
+    double idle_ewma;
+    {
+      boost::mutex::scoped_lock lock(src.samples_lock_);
+      samples = src.samples_;
+      ewma_period = src.ewma_period_;
+      idle_ewma = src.idle_ewma_;
+    }
+    boost::mutex::scoped_lock lock(samples_lock_);
+    samples_.swap( samples );
+    ewma_period_ = ewma_period;
+    idle_ewma_ = idle_ewma;
+    return *this;
 }
 
 double CpuUsageStats::get_user_percent() const
@@ -99,6 +155,51 @@ double CpuUsageStats::get_idle_average() const
   return average_[ ProcStat::CPU_JIFFIES_IDLE ];
 }
 
+double CpuUsageStats::get_idle_window( const double window ) const
+{
+  Accumulator itv = 0;
+  Accumulator idle = 0;
+  {
+    boost::mutex::scoped_lock lock(samples_lock_);
+    // walk back from the latest snapshot to the first one at least window seconds older
+    if ( samples_.size() >= 2 ) {
+      const Sample &last = samples_.back();
+      SampleHistory::const_reverse_iterator first = samples_.rbegin() + 1;
+      while ( (first + 1) != samples_.rend() && (last.when - first->when) < window ) {
+        ++first;
+      }
+      itv = last.total - first->total;
+      idle = last.idle - first->idle;
+    }
+  }
+
+  if ( itv == 0 ) return get_idle_percent();
+  return (double)idle / (double)itv * 100.0;
+}
+
+double CpuUsageStats::get_idle_ewma() const
+{
+  double idle_ewma;
+  {
+    boost::mutex::scoped_lock lock(samples_lock_);
+    idle_ewma = idle_ewma_;
+  }
+  if ( idle_ewma < 0.0 ) return get_idle_percent();
+  return idle_ewma;
+}
+
+void CpuUsageStats::set_ewma_period( const double seconds )
+{
+  boost::mutex::scoped_lock lock(samples_lock_);
+  ewma_period_ = seconds;
+}
+
+double CpuUsageStats::get_ewma_period() const
+{
+  boost::mutex::scoped_lock lock(samples_lock_);
+  return ewma_period_;
+}
+
 uint64_t CpuUsageStats::get_all_usage() const
 {
   return cpus_all_itv;
@@ -119,6 +220,12 @@ void CpuUsageStats::compute_statistics()
 
   // sum up all jiffies for all required cpus or all
   Accumulator cpus_itv =  _get_interval_total();
+
+  // no clock ticks since the last snapshot, keep the last metrics instead of reporting an idle of 0
+  if ( cpus_itv == 0 && !history_db_.empty() ) {
+    return;
+  }
+
   cpus_all_itv = cpus_itv;
   cpus_user_itv =_get_user_total();
 
@@ -135,6 +242,17 @@ void CpuUsageStats::compute_statistics()
   average_[ ProcStat::CPU_JIFFIES_SYSTEM ] = _calc_average( ProcStat::CPU_JIFFIES_SYSTEM );
   average_[ ProcStat::CPU_JIFFIES_IDLE ] = _calc_average( ProcStat::CPU_JIFFIES_IDLE );
 
+  // record the snapshot and fold the interval's idle into the smoothed value, weighting by the
+  // elapsed time so irregular sample periods do not skew the average
+  double dt = _add_sample();
+  boost::mutex::scoped_lock lock(samples_lock_);
+  if ( idle_ewma_ < 0.0 || ewma_period_ <= 0.0 ) {
+    idle_ewma_ = metrics_[ ProcStat::CPU_JIFFIES_IDLE ];
+  }
+  else {
+    double alpha = 1.0 - std::exp( -dt / ewma_period_ );
+    idle_ewma_ += alpha * ( metrics_[ ProcStat::CPU_JIFFIES_IDLE ] - idle_ewma_ );
+  }
 }
 
 uint32_t CpuUsageStats::get_ncpus() const 
@@ -174,6 +292,20 @@ CpuUsageStats::Accumulator CpuUsageStats::_get_user_total() const
 }
 
 
+double CpuUsageStats::_add_sample()
+{
+  Sample sample;
+  sample.when = _monotonic_seconds();
+  sample.total = _sum_jiffies( current_cpus_stat_ );
+  sample.idle = _sum_jiffie_field( current_cpus_stat_, ProcStat::CPU_JIFFIES_IDLE );
+
+  boost::mutex::scoped_lock lock(samples_lock_);
+  double dt = samples_.empty() ? 0.0 : sample.when - samples_.back().when;
+  samples_.push_back( sample );
+  return dt;
+}
+
+
 void CpuUsageStats::_update_stats() {
   proc_stat_.update_state();
   if ( cpus_.size() == 0 ) {
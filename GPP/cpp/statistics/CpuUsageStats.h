@@ -23,6 +23,7 @@
 #include <iosfwd>
 #include <boost/shared_ptr.hpp>
 #include <boost/circular_buffer.hpp>
+#include <boost/thread/mutex.hpp>
 #include "Statistics.h"
 #include "states/ProcStat.h"
 
@@ -41,6 +42,11 @@ class CpuUsageStats : public CpuStatistics
   typedef std::vector< double >    MetricsList;
   typedef boost::circular_buffer< MetricsList > MetricsHistory;
 
+  // default capacity of the /proc/stat snapshot ring, and time constant (seconds) of the
+  // smoothed idle percentage
+  static const int    DEFAULT_NSAMPLES = 64;
+  static const double DEFAULT_EWMA_PERIOD;
+
 public:
 
   // Perform CPU usage based on specified list of cpus...
@@ -49,6 +55,7 @@ public:
   CpuUsageStats( const int nhistory=5 );
   CpuUsageStats( const CpuList &cpus, const int nhistory=5 );
   CpuUsageStats( const CpuUsageStats &src );
+  CpuUsageStats &operator=( const CpuUsageStats &src );
 
   virtual ~CpuUsageStats() {}
 
@@ -61,13 +68,34 @@ public:
   virtual double get_user_average() const;
   virtual double get_system_average() const;
   virtual double get_idle_average() const;
+  virtual double get_idle_window( const double window ) const;
+  virtual double get_idle_ewma() const;
           uint64_t   get_all_usage() const;       
           uint64_t   get_user_usage() const;
 
+  // time constant of the smoothed idle percentage in seconds
+          void       set_ewma_period( const double seconds );
+          double     get_ewma_period() const;
+
 protected:
 
     typedef ProcStat::Jiffie        Accumulator;
 
+    //
+    // timestamped snapshot of the summed jiffies for the monitored cpus, utilization
+    // over any window is the difference between two snapshots
+    //
+    struct Sample {
+      double       when;      // monotonic clock, seconds
+      Accumulator  total;
+      Accumulator  idle;
+    };
+    typedef boost::circular_buffer< Sample > SampleHistory;
+
+    // takes a snapshot of the current jiffies and appends it to the ring, returning the
+    // seconds since the previous snapshot (0 if there is none)
+    double              _add_sample();
+
     virtual Accumulator _get_interval_total() const;
     virtual Accumulator _get_user_total() const;
     virtual double      _calc_metric( const ProcStat::CpuJiffiesField & jiffie, const Accumulator itv ) const;
@@ -90,6 +118,12 @@ private:
     MetricsHistory          history_db_;
     Accumulator             cpus_all_itv;
     Accumulator             cpus_user_itv;
+    // samples_, ewma_period_ and idle_ewma_ are read from CORBA threads while the
+    // monitoring thread updates them
+    mutable boost::mutex    samples_lock_;
+    SampleHistory           samples_;
+    double                  ewma_period_;
+    double                  idle_ewma_;
 };
 
 
@@ -47,6 +47,13 @@ class CpuStatistics : virtual public Statistics
   virtual double get_user_average() const = 0;
   virtual double get_system_average() const = 0;
   virtual double get_idle_average() const = 0;
+
+  // idle percentage measured over at least the last window seconds, implementations
+  // without a sample history report their most recent interval
+  virtual double get_idle_window( const double window ) const { return get_idle_percent(); }
+
+  // exponentially weighted idle percentage, defaults to the history average
+  virtual double get_idle_ewma() const { return get_idle_average(); }
 };
 
 
@@ -1057,6 +1057,7 @@ struct ulimit_struct {
     CORBA::Long max_threads;
     CORBA::Long current_open_files;
     CORBA::Long max_open_files;
+    CORBA::Long component_threads;
 };
 
 inline bool operator>>= (const CORBA::Any& a, ulimit_struct& s) {
@@ -1075,6 +1076,9 @@ inline bool operator>>= (const CORBA::Any& a, ulimit_struct& s) {
     if (props.contains("max_open_files")) {
         if (!(props["max_open_files"] >>= s.max_open_files)) return false;
     }
+    if (props.contains("component_threads")) {
+        if (!(props["component_threads"] >>= s.component_threads)) return false;
+    }
     return true;
 }
 
@@ -1088,6 +1092,8 @@ inline void operator<<= (CORBA::Any& a, const ulimit_struct& s) {
     props["current_open_files"] = s.current_open_files;
  
     props["max_open_files"] = s.max_open_files;
+ 
+    props["component_threads"] = s.component_threads;
     a <<= props;
 }
 
@@ -1100,6 +1106,8 @@ inline bool operator== (const ulimit_struct& s1, const ulimit_struct& s2) {
         return false;
     if (s1.max_open_files!=s2.max_open_files)
         return false;
+    if (s1.component_threads!=s2.component_threads)
+        return false;
     return true;
 }
 
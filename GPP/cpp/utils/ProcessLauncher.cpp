@@ -0,0 +1,620 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK GPP.
+ *
+ * REDHAWK GPP is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK GPP is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <cerrno>
+#include <sstream>
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <dirent.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <sys/prctl.h>
+#include <linux/limits.h>
+#include "ProcessLauncher.h"
+
+extern char **environ;
+
+#ifndef PR_SET_CHILD_SUBREAPER
+#define PR_SET_CHILD_SUBREAPER 36
+#endif
+
+const char * const ProcessLauncher::LAUNCHER_ARG = "__GPP_PROCESS_LAUNCHER__";
+
+namespace {
+
+  enum {
+    FLAG_SEARCH_PATH = 0x1,
+    FLAG_REDIRECT    = 0x2
+  };
+
+  // spawn request, followed by length bytes of NUL terminated strings: cwd, argv, environment
+  struct RequestHeader {
+    uint32_t flags;
+    uint32_t nargs;
+    uint32_t nenv;
+    uint32_t length;
+  };
+
+  // number of exec attempts when the executable is still open for writing (ETXTBSY),
+  // the delay doubles on each attempt
+  const int EXEC_RETRIES = 6;
+  const useconds_t EXEC_RETRY_DELAY = 10000;
+
+  // most descriptors passed with one message: the release and status pipes of a held process
+  const size_t MAX_PASS_FDS = 2;
+
+  // minimum time between attempts to restart a helper that failed to start
+  const double RESTART_DELAY_MS = 1000.0;
+
+  // time the helper gets to exit on its own after its socket is closed
+  const int HELPER_EXIT_TIMEOUT_MS = 1000;
+
+  double now_ms()
+  {
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec * 1e-6;
+  }
+
+  bool write_all( const int fd, const void *buf, size_t len )
+  {
+    const char *ptr = static_cast<const char*>(buf);
+    while ( len > 0 ) {
+      ssize_t n = send( fd, ptr, len, MSG_NOSIGNAL );
+      if ( n < 0 && errno == ENOTSOCK ) n = write( fd, ptr, len );
+      if ( n < 0 ) {
+        if ( errno == EINTR ) continue;
+        return false;
+      }
+      ptr += n;
+      len -= n;
+    }
+    return true;
+  }
+
+  bool read_all( const int fd, void *buf, size_t len )
+  {
+    char *ptr = static_cast<char*>(buf);
+    while ( len > 0 ) {
+      ssize_t n = read( fd, ptr, len );
+      if ( n < 0 && errno == EINTR ) continue;
+      if ( n <= 0 ) return false;
+      ptr += n;
+      len -= n;
+    }
+    return true;
+  }
+
+  bool write_int( const int fd, const int32_t value )
+  {
+    return write_all( fd, &value, sizeof(value) );
+  }
+
+  bool read_int( const int fd, int32_t &value )
+  {
+    return read_all( fd, &value, sizeof(value) );
+  }
+
+  //
+  // send a fixed size message with descriptors attached
+  //
+  bool send_message( const int fd, const void *buf, const size_t len, const int *pass_fds, const size_t nfds )
+  {
+    struct msghdr msg;
+    struct iovec iov;
+    char control[CMSG_SPACE(sizeof(int)*MAX_PASS_FDS)];
+    memset( &msg, 0, sizeof(msg) );
+    iov.iov_base = const_cast<void*>(buf);
+    iov.iov_len = len;
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    if ( nfds > 0 ) {
+      memset( control, 0, sizeof(control) );
+      msg.msg_control = control;
+      msg.msg_controllen = CMSG_SPACE(sizeof(int)*nfds);
+      struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+      cmsg->cmsg_level = SOL_SOCKET;
+      cmsg->cmsg_type = SCM_RIGHTS;
+      cmsg->cmsg_len = CMSG_LEN(sizeof(int)*nfds);
+      memcpy( CMSG_DATA(cmsg), pass_fds, sizeof(int)*nfds );
+    }
+    ssize_t n;
+    do {
+      n = sendmsg( fd, &msg, MSG_NOSIGNAL );
+    } while ( n < 0 && errno == EINTR );
+    if ( n < 0 ) return false;
+    return write_all( fd, static_cast<const char*>(buf) + n, len - n );
+  }
+
+  //
+  // receive a fixed size message and any descriptors attached to it (unused slots are set to
+  // -1), returns 0 when the other end closed
+  //
+  int recv_message( const int fd, void *buf, const size_t len, int *pass_fds, const size_t nfds )
+  {
+    struct msghdr msg;
+    struct iovec iov;
+    char control[CMSG_SPACE(sizeof(int)*MAX_PASS_FDS)];
+    memset( &msg, 0, sizeof(msg) );
+    iov.iov_base = buf;
+    iov.iov_len = len;
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    for ( size_t i=0; i < nfds; i++ ) pass_fds[i] = -1;
+    ssize_t n;
+    do {
+      n = recvmsg( fd, &msg, MSG_CMSG_CLOEXEC );
+    } while ( n < 0 && errno == EINTR );
+    if ( n <= 0 ) return n;
+    for ( struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg) ) {
+      if ( cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS ) {
+        size_t count = ( cmsg->cmsg_len - CMSG_LEN(0) ) / sizeof(int);
+        int received[MAX_PASS_FDS];
+        memcpy( received, CMSG_DATA(cmsg), sizeof(int)*std::min(count, (size_t)MAX_PASS_FDS) );
+        for ( size_t i=0; i < count && i < MAX_PASS_FDS; i++ ) {
+          if ( i < nfds ) pass_fds[i] = received[i];
+          else close( received[i] );
+        }
+      }
+    }
+    if ( !read_all( fd, static_cast<char*>(buf) + n, len - n ) ) return -1;
+    return 1;
+  }
+
+  void close_inherited_fds( const int keep )
+  {
+    DIR *dir = opendir( "/proc/self/fd" );
+    if ( !dir ) return;
+    std::vector<int> fds;
+    struct dirent *entry;
+    while ( (entry = readdir(dir)) != NULL ) {
+      int fd = atoi( entry->d_name );
+      if ( fd > STDERR_FILENO && fd != keep && fd != dirfd(dir) ) fds.push_back( fd );
+    }
+    closedir( dir );
+    for ( size_t i=0; i < fds.size(); i++ ) close( fds[i] );
+  }
+
+  //
+  // runs in the process being launched: wait for the device to release it, then exec.  Failures
+  // are reported through the status pipe, which closes on a successful exec
+  //
+  void exec_held_process( const ProcessLauncher::Request &request,
+                          const std::string &cwd,
+                          std::vector<char*> &argv,
+                          std::vector<char*> &envp,
+                          const int go_fd,
+                          const int status_fd )
+  {
+    setpgid( 0, 0 );
+
+    if ( request.redirect_fd > -1 ) {
+      if ( dup2( request.redirect_fd, STDERR_FILENO ) == -1 ||
+           dup2( request.redirect_fd, STDOUT_FILENO ) == -1 ) {
+        write_int( status_fd, errno );
+        _exit( -1 );
+      }
+      close( request.redirect_fd );
+    }
+
+    if ( !cwd.empty() && chdir( cwd.c_str() ) != 0 ) {
+      write_int( status_fd, errno );
+      _exit( -1 );
+    }
+
+    char go = 0;
+    if ( !read_all( go_fd, &go, 1 ) || !go ) {
+      _exit( -1 );
+    }
+    close( go_fd );
+
+    useconds_t delay = EXEC_RETRY_DELAY;
+    for ( int retries = EXEC_RETRIES; ; retries-- ) {
+      if ( request.search_path ) {
+        execvpe( argv[0], &argv[0], &envp[0] );
+      } else {
+        execve( argv[0], &argv[0], &envp[0] );
+      }
+      if ( retries <= 1 || errno != ETXTBSY ) break;
+      usleep( delay );
+      delay *= 2;
+    }
+
+    write_int( status_fd, errno );
+    _exit( -1 );
+  }
+
+  //
+  // fork the held process, returns its pid or -errno
+  //
+  int32_t spawn_held_process( const ProcessLauncher::Request &request,
+                              const std::string &cwd,
+                              std::vector<char*> &argv,
+                              std::vector<char*> &envp,
+                              int &go_fd,
+                              int &status_fd )
+  {
+    int go[2];
+    int status[2];
+    if ( pipe2( go, O_CLOEXEC ) != 0 ) return -errno;
+    if ( pipe2( status, O_CLOEXEC ) != 0 ) {
+      int err = errno;
+      close( go[0] ); close( go[1] );
+      return -err;
+    }
+
+    // the intermediate process exits as soon as the process is forked so the process is
+    // re-parented to the device, which is the nearest child subreaper
+    pid_t intermediate = fork();
+    if ( intermediate == 0 ) {
+      close( go[1] );
+      close( status[0] );
+      pid_t pid = fork();
+      if ( pid == 0 ) {
+        exec_held_process( request, cwd, argv, envp, go[0], status[1] );
+      }
+      write_int( status[1], pid < 0 ? -errno : pid );
+      _exit( 0 );
+    }
+
+    int err = errno;
+    close( go[0] );
+    close( status[1] );
+    int32_t pid = -err;
+    if ( intermediate > 0 ) {
+      if ( !read_int( status[0], pid ) ) pid = -ECHILD;
+      int wstatus;
+      while ( waitpid( intermediate, &wstatus, 0 ) < 0 && errno == EINTR );
+    }
+
+    if ( pid < 0 ) {
+      close( go[1] );
+      close( status[0] );
+    }
+    else {
+      go_fd = go[1];
+      status_fd = status[0];
+    }
+    return pid;
+  }
+
+};
+
+
+ProcessLauncher::ProcessLauncher() :
+  _fd(-1),
+  _pid(-1),
+  _restart_time(0.0)
+{
+}
+
+ProcessLauncher::~ProcessLauncher()
+{
+  stop();
+}
+
+bool ProcessLauncher::start( const std::string &path )
+{
+  boost::mutex::scoped_lock lock(_lock);
+  if ( _fd > -1 ) return true;
+
+  std::string exe = path;
+  if ( exe.empty() ) {
+    char buf[PATH_MAX];
+    ssize_t len = readlink( "/proc/self/exe", buf, sizeof(buf)-1 );
+    if ( len <= 0 ) return false;
+    buf[len] = '\0';
+    exe = buf;
+  }
+
+  // launched processes are re-parented to this process, so they can be reaped and monitored
+  // as if they were forked directly
+  if ( prctl( PR_SET_CHILD_SUBREAPER, 1, 0, 0, 0 ) != 0 ) return false;
+
+  _path = exe;
+  if ( !_start_helper() ) {
+    _path.clear();
+    return false;
+  }
+  return true;
+}
+
+void ProcessLauncher::stop()
+{
+  boost::mutex::scoped_lock lock(_lock);
+  _stop_helper();
+  _path.clear();
+}
+
+bool ProcessLauncher::is_running() const
+{
+  boost::mutex::scoped_lock lock(_lock);
+  return !_path.empty();
+}
+
+ProcessLauncher::Metrics ProcessLauncher::get_metrics() const
+{
+  boost::mutex::scoped_lock lock(_lock);
+  return _metrics;
+}
+
+bool ProcessLauncher::_start_helper()
+{
+  int sv[2];
+  if ( socketpair( AF_UNIX, SOCK_STREAM, 0, sv ) != 0 ) return false;
+  fcntl( sv[0], F_SETFD, FD_CLOEXEC );
+
+  std::ostringstream fd_arg;
+  fd_arg << sv[1];
+  std::string fd_str = fd_arg.str();
+  std::vector<char*> argv;
+  argv.push_back( const_cast<char*>(_path.c_str()) );
+  argv.push_back( const_cast<char*>(LAUNCHER_ARG) );
+  argv.push_back( const_cast<char*>(fd_str.c_str()) );
+  argv.push_back( NULL );
+
+  pid_t pid = fork();
+  if ( pid == 0 ) {
+    execv( argv[0], &argv[0] );
+    _exit( 127 );
+  }
+  close( sv[1] );
+  if ( pid < 0 ) {
+    close( sv[0] );
+    return false;
+  }
+  _fd = sv[0];
+  _pid = pid;
+
+  // the helper reports ready once it is serving requests
+  int32_t ready = -1;
+  if ( !read_int( _fd, ready ) || ready != 0 ) {
+    _stop_helper();
+    return false;
+  }
+  return true;
+}
+
+bool ProcessLauncher::_restart_helper()
+{
+  // a helper that cannot be started is not retried on every launch
+  double now = now_ms();
+  if ( now < _restart_time ) return false;
+  _stop_helper();
+  if ( _start_helper() ) return true;
+  _restart_time = now + RESTART_DELAY_MS;
+  return false;
+}
+
+void ProcessLauncher::_stop_helper()
+{
+  // the helper exits when its end of the socket closes
+  if ( _fd > -1 ) close( _fd );
+  _fd = -1;
+  if ( _pid < 0 ) return;
+
+  // reap the helper, unless the device's SIGCHLD handling already has (ECHILD)
+  int status;
+  pid_t ret;
+  int waited = 0;
+  while ( (ret = waitpid( _pid, &status, WNOHANG )) == 0 && waited < HELPER_EXIT_TIMEOUT_MS ) {
+    usleep( 10000 );
+    waited += 10;
+  }
+  if ( ret == 0 ) {
+    kill( _pid, SIGKILL );
+    while ( waitpid( _pid, &status, 0 ) < 0 && errno == EINTR );
+  }
+  _pid = -1;
+}
+
+void ProcessLauncher::_record( const double ms, const bool ok )
+{
+  boost::mutex::scoped_lock lock(_lock);
+  if ( !ok ) {
+    _metrics.failures++;
+    return;
+  }
+  _metrics.launches++;
+  _metrics.last_ms = ms;
+  _metrics.mean_ms += ( ms - _metrics.mean_ms ) / (double)_metrics.launches;
+  if ( ms > _metrics.max_ms ) _metrics.max_ms = ms;
+}
+
+int32_t ProcessLauncher::_send_request( const Request &request, int &go_fd, int &status_fd )
+{
+  // the process runs with the device's current working directory and environment
+  std::string payload;
+  char *cwd = getcwd( NULL, 0 );
+  if ( cwd ) {
+    payload.append( cwd );
+    free( cwd );
+  }
+  payload.push_back( '\0' );
+
+  RequestHeader header;
+  header.flags = 0;
+  if ( request.search_path ) header.flags |= FLAG_SEARCH_PATH;
+  if ( request.redirect_fd > -1 ) header.flags |= FLAG_REDIRECT;
+  header.nargs = request.argv.size();
+  for ( size_t i=0; i < request.argv.size(); i++ ) {
+    payload.append( request.argv[i] );
+    payload.push_back( '\0' );
+  }
+  header.nenv = 0;
+  for ( char **env = environ; env && *env; env++ ) {
+    const char *eq = strchr( *env, '=' );
+    size_t name_len = eq ? (size_t)(eq - *env) + 1 : strlen( *env );
+    bool overridden = false;
+    for ( size_t i=0; i < request.environment.size() && !overridden; i++ ) {
+      overridden = request.environment[i].compare( 0, name_len, *env, name_len ) == 0;
+    }
+    if ( overridden ) continue;
+    payload.append( *env );
+    payload.push_back( '\0' );
+    header.nenv++;
+  }
+  for ( size_t i=0; i < request.environment.size(); i++, header.nenv++ ) {
+    payload.append( request.environment[i] );
+    payload.push_back( '\0' );
+  }
+  header.length = payload.size();
+
+  const size_t nfds = ( request.redirect_fd > -1 ) ? 1 : 0;
+  if ( !send_message( _fd, &header, sizeof(header), &request.redirect_fd, nfds ) ||
+       !write_all( _fd, payload.data(), payload.size() ) ) {
+    return -ECONNRESET;
+  }
+
+  int32_t reply = 0;
+  int fds[MAX_PASS_FDS];
+  if ( recv_message( _fd, &reply, sizeof(reply), fds, MAX_PASS_FDS ) <= 0 ) {
+    return -ECONNRESET;
+  }
+  if ( reply > 0 && ( fds[0] < 0 || fds[1] < 0 ) ) {
+    // the process was forked but cannot be controlled, closing the release pipe aborts it
+    reply = -EBADF;
+  }
+  if ( reply <= 0 ) {
+    for ( size_t i=0; i < MAX_PASS_FDS; i++ ) {
+      if ( fds[i] > -1 ) close( fds[i] );
+    }
+    return reply;
+  }
+  go_fd = fds[0];
+  status_fd = fds[1];
+  return reply;
+}
+
+ProcessLauncher::Result ProcessLauncher::launch( const Request &request, const PrepareFunc &prepare, pid_t &pid, int &error )
+{
+  pid = -1;
+  error = 0;
+  if ( request.argv.empty() ) {
+    error = EINVAL;
+    return FAILED;
+  }
+
+  double start = now_ms();
+
+  // only the exchange with the helper is serialized, placement and the wait for exec are not
+  int go_fd = -1;
+  int status_fd = -1;
+  int32_t reply = -ECONNRESET;
+  {
+    boost::mutex::scoped_lock lock(_lock);
+    if ( _path.empty() ) return UNAVAILABLE;
+
+    // restart a helper that has exited, and retry once if it exits during the request
+    for ( int attempt=0; attempt < 2 && reply == -ECONNRESET; attempt++ ) {
+      if ( _fd < 0 && !_restart_helper() ) return UNAVAILABLE;
+      reply = _send_request( request, go_fd, status_fd );
+      if ( reply == -ECONNRESET ) _stop_helper();
+    }
+    if ( reply == -ECONNRESET ) return UNAVAILABLE;
+  }
+
+  if ( reply < 0 ) {
+    error = -reply;
+    _record( 0.0, false );
+    return FAILED;
+  }
+  pid = reply;
+
+  bool go = prepare.empty() ? true : prepare( pid );
+
+  // release or abort the process, then wait for the status pipe to report an exec failure or
+  // to close on a successful exec
+  char go_byte = go ? 1 : 0;
+  bool released = write_all( go_fd, &go_byte, 1 );
+  close( go_fd );
+  int32_t status = 0;
+  if ( go && !read_int( status_fd, status ) ) status = 0;
+  close( status_fd );
+  if ( go && !released && status == 0 ) status = ECHILD;
+
+  if ( !go || status != 0 ) {
+    error = go ? status : EPERM;
+    _record( 0.0, false );
+    return FAILED;
+  }
+
+  _record( now_ms() - start, true );
+  return LAUNCHED;
+}
+
+int ProcessLauncher::serve( const int fd )
+{
+  close_inherited_fds( fd );
+  fcntl( fd, F_SETFD, FD_CLOEXEC );
+  if ( !write_int( fd, 0 ) ) return -1;
+
+  while ( true ) {
+    RequestHeader header;
+    Request request;
+    int ret = recv_message( fd, &header, sizeof(header), &request.redirect_fd, 1 );
+    if ( ret <= 0 ) break;
+
+    std::vector<char> payload( header.length + 1, '\0' );
+    if ( header.length && !read_all( fd, &payload[0], header.length ) ) break;
+
+    // split the payload into the working directory, argument and environment lists
+    std::vector<char*> strings;
+    for ( size_t pos=0; pos < header.length; pos += strlen(&payload[pos]) + 1 ) {
+      strings.push_back( &payload[pos] );
+    }
+    if ( strings.size() < 1 + header.nargs + header.nenv || header.nargs == 0 ) {
+      if ( request.redirect_fd > -1 ) close( request.redirect_fd );
+      if ( !write_int( fd, -EINVAL ) ) break;
+      continue;
+    }
+    std::string cwd( strings[0] );
+    std::vector<char*> argv( strings.begin() + 1, strings.begin() + 1 + header.nargs );
+    argv.push_back( NULL );
+    std::vector<char*> envp( strings.begin() + 1 + header.nargs, strings.begin() + 1 + header.nargs + header.nenv );
+    envp.push_back( NULL );
+    request.search_path = header.flags & FLAG_SEARCH_PATH;
+    if ( !(header.flags & FLAG_REDIRECT) && request.redirect_fd > -1 ) {
+      close( request.redirect_fd );
+      request.redirect_fd = -1;
+    }
+
+    // hand the release and status pipes to the device, which releases the process once it
+    // has been placed and reads the exec result itself
+    int fds[MAX_PASS_FDS] = { -1, -1 };
+    int32_t pid = spawn_held_process( request, cwd, argv, envp, fds[0], fds[1] );
+    if ( request.redirect_fd > -1 ) close( request.redirect_fd );
+    bool sent = send_message( fd, &pid, sizeof(pid), fds, pid > 0 ? MAX_PASS_FDS : 0 );
+    for ( size_t i=0; i < MAX_PASS_FDS; i++ ) {
+      if ( fds[i] > -1 ) close( fds[i] );
+    }
+    if ( !sent ) break;
+  }
+
+  close( fd );
+  return 0;
+}
@@ -0,0 +1,125 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK GPP.
+ *
+ * REDHAWK GPP is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK GPP is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+#ifndef PROCESS_LAUNCHER_H_
+#define PROCESS_LAUNCHER_H_
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <sys/types.h>
+#include <boost/function.hpp>
+#include <boost/thread/mutex.hpp>
+
+//
+// ProcessLauncher
+//
+// Spawns component processes from a small helper process instead of forking the device.  The
+// helper is a fresh exec of the device binary that only serves launch requests over a local
+// socket, so each fork copies the helper's page tables rather than the device's ORB threads
+// and mappings.
+//
+// A launch forks twice in the helper so the new process is re-parented to the device (the
+// device is made a child subreaper), and holds the process before exec until the device has
+// applied its placement (affinity) to the pid.  The process is its own process group leader,
+// runs with the device's current environment and working directory and can have stdout and
+// stderr redirected to a descriptor passed with the request.
+//
+// The helper hands the held process' release and exec status pipes back to the device, so only
+// the request itself is serialized; placement and the wait for exec run concurrently across
+// launches.  A helper that exits is restarted by the next launch.
+//
+class ProcessLauncher
+{
+public:
+
+  // argument that switches the device binary into the helper's request loop
+  static const char * const LAUNCHER_ARG;
+
+  struct Request {
+    Request() : search_path(false), redirect_fd(-1) {};
+    std::vector<std::string>   argv;
+    std::vector<std::string>   environment;         // NAME=VALUE entries that override the device's
+    bool                       search_path;         // use execvp to resolve argv[0]
+    int                        redirect_fd;         // dup'ed to stdout/stderr if > -1
+  };
+
+  enum Result {
+    LAUNCHED = 0,
+    FAILED,                                         // spawn or exec failed, error is set
+    UNAVAILABLE                                     // helper is not running
+  };
+
+  //
+  // called with the pid of the held process, return false to abort the launch
+  //
+  typedef boost::function< bool (pid_t) >  PrepareFunc;
+
+  struct Metrics {
+    Metrics() : launches(0), failures(0), last_ms(0.0), mean_ms(0.0), max_ms(0.0) {};
+    uint64_t   launches;
+    uint64_t   failures;
+    double     last_ms;                             // request to confirmed exec
+    double     mean_ms;
+    double     max_ms;
+  };
+
+  ProcessLauncher();
+  ~ProcessLauncher();
+
+  // start the helper by executing the binary at path (default is the running executable)
+  bool    start( const std::string &path=std::string() );
+
+  // stop the helper and wait for it to exit
+  void    stop();
+
+  // true between a successful start() and stop(), even if the helper has to be restarted
+  bool    is_running() const;
+
+  Result  launch( const Request &request, const PrepareFunc &prepare, pid_t &pid, int &error );
+
+  Metrics get_metrics() const;
+
+  // helper process entry point, serves requests from fd until the device closes its end
+  static int serve( const int fd );
+
+private:
+  ProcessLauncher( const ProcessLauncher & );
+  ProcessLauncher &operator=( const ProcessLauncher & );
+
+  // helper management, called with _lock held
+  bool    _start_helper();
+  bool    _restart_helper();
+  void    _stop_helper();
+
+  // send the request and receive the held process' pid, release and status descriptors, with
+  // _lock held
+  int32_t _send_request( const Request &request, int &go_fd, int &status_fd );
+
+  void    _record( const double ms, const bool ok );
+
+  std::string            _path;
+  int                    _fd;
+  pid_t                  _pid;
+  double                 _restart_time;
+  mutable boost::mutex   _lock;
+  Metrics                _metrics;
+};
+
+#endif
@@ -316,13 +316,133 @@ class ComponentTests(ossie.utils.testing.ScaComponentTestCase):
             self.fail("Process failed to execute")
         time.sleep(1)    
         self.comp_obj.terminate(pid)
-        try:
-            os.kill(pid, 0)
-        except OSError:
-            pass
-        else:
+        if not self.waitForExit(pid):
             self.fail("Process failed to terminate")
             
+    def testTerminateLatency(self):
+        self.runGPP()
+
+        configureProps = self.getPropertySet(kinds=("configure",), modes=("readwrite", "writeonly"), includeNil=False)
+        self.comp_obj.configure(configureProps)
+
+        fs_stub = ComponentTests.FileSystemStub()
+        fs_stub_var = fs_stub._this()
+        self.comp_obj.load(fs_stub_var, "/component_stub.py", CF.LoadableDevice.EXECUTABLE)
+
+        comp_id = "DCE:00000000-0000-0000-0000-000000000000:waveform_1"
+        app_id = "waveform_1"
+        appReg = ApplicationRegistrarStub(comp_id, app_id)
+        appreg_ior = sb.orb.object_to_string(appReg._this())
+        pid = self.comp_obj.execute("/component_stub.py", [], [CF.DataType(id="COMPONENT_IDENTIFIER", value=any.to_any(comp_id)),
+                                                               CF.DataType(id="NAME_BINDING", value=any.to_any("component_stub")),CF.DataType(id="PROFILE_NAME", value=any.to_any("/component_stub/component_stub.spd.xml")),
+                                                               CF.DataType(id="NAMING_CONTEXT_IOR", value=any.to_any(appreg_ior))])
+        self.assertNotEqual(pid, 0)
+        time.sleep(1)
+
+        # terminate returns once the group has been signaled; the shutdown
+        # (and any escalation) continues in the background
+        begin = time.time()
+        self.comp_obj.terminate(pid)
+        elapsed = time.time() - begin
+        self.assertTrue(elapsed < 0.5, "terminate took %f seconds" % elapsed)
+
+        # The component exits on SIGINT, so every process in the group should
+        # be gone well before the 2 second grace period runs out (a zombie
+        # awaiting the GPP's reaper counts as exited)
+        end = time.time() + 1.5
+        running = self.getRunningGroupMembers(pid)
+        while running and time.time() < end:
+            time.sleep(0.05)
+            running = self.getRunningGroupMembers(pid)
+        self.assertEqual(running, [], "processes %s in group %d are still running" % (running, pid))
+
+    def getRunningGroupMembers(self, pgroup):
+        running = []
+        for entry in os.listdir('/proc'):
+            if not entry.isdigit():
+                continue
+            try:
+                stat = open('/proc/%s/stat' % entry).read()
+            except IOError:
+                continue
+            fields = stat[stat.rfind(')')+2:].split()
+            if int(fields[2]) == pgroup and fields[0] not in ('Z', 'X'):
+                running.append(int(entry))
+        return running
+
+    def waitForExit(self, pid, timeout=5.0):
+        # terminate returns once the process has been signaled; it exits, and
+        # is reaped by the GPP, shortly afterwards
+        end = time.time() + timeout
+        while True:
+            try:
+                os.kill(pid, 0)
+            except OSError:
+                return True
+            if time.time() >= end:
+                return False
+            time.sleep(0.05)
+
+    def getParentPid(self, pid):
+        stat = open('/proc/%d/stat' % pid).read()
+        return int(stat[stat.rfind(')')+2:].split()[1])
+
+    def getLauncherHelpers(self):
+        helpers = []
+        for entry in os.listdir('/proc'):
+            if not entry.isdigit():
+                continue
+            try:
+                args = open('/proc/%s/cmdline' % entry).read().split('\0')
+            except IOError:
+                continue
+            if '__GPP_PROCESS_LAUNCHER__' in args:
+                helpers.append(int(entry))
+        return helpers
+
+    def testProcessLauncher(self):
+        self.runGPP()
+
+        configureProps = self.getPropertySet(kinds=("configure",), modes=("readwrite", "writeonly"), includeNil=False)
+        self.comp_obj.configure(configureProps)
+
+        fs_stub = ComponentTests.FileSystemStub()
+        fs_stub_var = fs_stub._this()
+        self.comp_obj.load(fs_stub_var, "/component_stub.py", CF.LoadableDevice.EXECUTABLE)
+
+        def execute_stub(waveform):
+            comp_id = "DCE:00000000-0000-0000-0000-000000000000:" + waveform
+            appReg = ApplicationRegistrarStub(comp_id, waveform)
+            appreg_ior = sb.orb.object_to_string(appReg._this())
+            return self.comp_obj.execute("/component_stub.py", [], [CF.DataType(id="COMPONENT_IDENTIFIER", value=any.to_any(comp_id)),
+                                                                    CF.DataType(id="NAME_BINDING", value=any.to_any("component_stub")),CF.DataType(id="PROFILE_NAME", value=any.to_any("/component_stub/component_stub.spd.xml")),
+                                                                    CF.DataType(id="NAMING_CONTEXT_IOR", value=any.to_any(appreg_ior))])
+
+        # The GPP starts one launcher helper, and the components it spawns
+        # are re-parented to the GPP
+        helpers = self.getLauncherHelpers()
+        self.assertEqual(len(helpers), 1)
+        gpp_pid = self.getParentPid(helpers[0])
+        pid = execute_stub("waveform_1")
+        self.assertNotEqual(pid, 0)
+        self.assertEqual(self.getParentPid(pid), gpp_pid)
+
+        # A helper that dies is replaced on the next launch, rather than
+        # falling back to forking the GPP
+        os.kill(helpers[0], signal.SIGKILL)
+        time.sleep(1)
+        pid2 = execute_stub("waveform_2")
+        self.assertNotEqual(pid2, 0)
+        self.assertEqual(self.getParentPid(pid2), gpp_pid)
+        new_helpers = self.getLauncherHelpers()
+        self.assertEqual(len(new_helpers), 1)
+        self.assertNotEqual(new_helpers[0], helpers[0])
+        self.assertEqual(self.getParentPid(new_helpers[0]), gpp_pid)
+
+        time.sleep(1)
+        self.comp_obj.terminate(pid)
+        self.comp_obj.terminate(pid2)
+
     def testBusy(self):
         self.runGPP()
 
@@ -380,17 +500,46 @@ class ComponentTests(ossie.utils.testing.ScaComponentTestCase):
             self.fail("Process failed to execute")
         time.sleep(1)    
         self.comp_obj.terminate(pid)
-        try:
-            # kill all busy.py just in case
-            os.system('pkill -9 -f busy.py')
-            os.kill(pid, 0)
-        except OSError:
-            pass
-        else:
+        # kill all busy.py just in case
+        os.system('pkill -9 -f busy.py')
+        if not self.waitForExit(pid):
             self.fail("Process failed to terminate")
 
 
 
+    def test_cpu_idle_smoothing(self):
+        self.runGPP()
+
+        self.assertAlmostEqual(self.comp.cpu_idle_window.queryValue(), 1.0)
+        self.assertAlmostEqual(self.comp.cpu_idle_ewma_period.queryValue(), 10.0)
+        self.assertEqual(self.comp_obj._get_usageState(), CF.Device.IDLE)
+
+        # With a long smoothing period, a few seconds of full load are not
+        # enough to report BUSY on cpu idle
+        self.comp.cpu_idle_ewma_period = 3600.0
+        self.comp.cpu_idle_window = 0.5
+        self.assertAlmostEqual(self.comp.cpu_idle_ewma_period.queryValue(), 3600.0)
+        self.assertAlmostEqual(self.comp.cpu_idle_window.queryValue(), 0.5)
+        procs = []
+        try:
+            for core in range(multiprocessing.cpu_count()*2):
+                procs.append(subprocess.Popen('./busy.py'))
+            time.sleep(5)
+            self.assertFalse("CPU IDLE" in self.comp.busy_reason.queryValue().upper())
+
+            # Without smoothing, the windowed measurement alone decides
+            self.comp.cpu_idle_ewma_period = 0.0
+            cpu_busy = False
+            for i in xrange(10):
+                if "CPU IDLE" in self.comp.busy_reason.queryValue().upper():
+                    cpu_busy = True
+                    break
+                time.sleep(.5)
+            self.assertTrue(cpu_busy)
+        finally:
+            for proc in procs:
+                proc.kill()
+
     def test_busy_allow(self):
         self.runGPP(execparam_overrides={'DEBUG_LEVEL': 3 })
 
@@ -538,13 +687,9 @@ class ComponentTests(ossie.utils.testing.ScaComponentTestCase):
             self.fail("Process failed to execute")
         time.sleep(1)
         self.comp_obj.terminate(pid)
-        try:
-            # kill all busy.py just in case
-            os.system('pkill -9 -f busy.py')
-            os.kill(pid, 0)
-        except OSError:
-            pass
-        else:
+        # kill all busy.py just in case
+        os.system('pkill -9 -f busy.py')
+        if not self.waitForExit(pid):
             self.fail("Process failed to terminate")
 
 
@@ -598,12 +743,7 @@ class ComponentTests(ossie.utils.testing.ScaComponentTestCase):
         self.assertEqual(scrname, "waveform_1.MyComponent")
         
         self.comp_obj.terminate(pid)
-        time.sleep(1)
-        try:
-            os.kill(pid, 0)
-        except OSError:
-            pass
-        else:
+        if not self.waitForExit(pid):
             self.fail("Process failed to terminate")
         
         output,status = commands.getstatusoutput('screen -wipe')
@@ -837,6 +977,48 @@ class ComponentTests(ossie.utils.testing.ScaComponentTestCase):
         self.assertTrue('sys_limits::current_open_files')
         self.assertTrue('sys_limits::max_open_files')
 
+    def getThreadCount(self, pid):
+        for line in open('/proc/%d/status' % pid):
+            if line.startswith('Threads:'):
+                return int(line.split()[1])
+        return 0
+
+    def test_gpp_limits_component_threads(self):
+        self.runGPP()
+
+        configureProps = self.getPropertySet(kinds=("configure",), modes=("readwrite", "writeonly"), includeNil=False)
+        self.comp_obj.configure(configureProps)
+        wait_amount = (self.comp.threshold_cycle_time / 1000.0) * 4
+        self.assertEqual(self.comp.gpp_limits.component_threads, 0)
+
+        fs_stub = ComponentTests.FileSystemStub()
+        fs_stub_var = fs_stub._this()
+        self.comp_obj.load(fs_stub_var, "/component_stub.py", CF.LoadableDevice.EXECUTABLE)
+
+        comp_id = "DCE:00000000-0000-0000-0000-000000000000:waveform_1"
+        app_id = "waveform_1"
+        appReg = ApplicationRegistrarStub(comp_id, app_id)
+        appreg_ior = sb.orb.object_to_string(appReg._this())
+        pid = self.comp_obj.execute("/component_stub.py", [], [CF.DataType(id="COMPONENT_IDENTIFIER", value=any.to_any(comp_id)),
+                                                               CF.DataType(id="NAME_BINDING", value=any.to_any("component_stub")),CF.DataType(id="PROFILE_NAME", value=any.to_any("/component_stub/component_stub.spd.xml")),
+                                                               CF.DataType(id="NAMING_CONTEXT_IOR", value=any.to_any(appreg_ior))])
+        self.assertNotEqual(pid, 0)
+        time.sleep(wait_amount)
+
+        # The component's threads are reported on their own, and are not part
+        # of the GPP's own thread count
+        limits = self.comp.gpp_limits
+        gpp_threads = self.getThreadCount(self.comp._process.pid())
+        self.assertTrue(limits.component_threads > 0)
+        self.assertTrue(limits.current_threads < gpp_threads + limits.component_threads,
+                        "current_threads %d includes component threads (gpp %d, components %d)" % (limits.current_threads, gpp_threads, limits.component_threads))
+
+        self.comp_obj.terminate(pid)
+        if not self.waitForExit(pid):
+            self.fail("Process failed to terminate")
+        time.sleep(wait_amount)
+        self.assertEqual(self.comp.gpp_limits.component_threads, 0)
+
     def get_single_nic_interface(self):
         import commands
         (exitstatus, ifconfig_info) = commands.getstatusoutput('/sbin/ifconfig -a')
@@ -1037,11 +1219,7 @@ class ComponentTests(ossie.utils.testing.ScaComponentTestCase):
             self.fail("Process failed to execute")
         time.sleep(1)    
         self.comp_obj.terminate(pid)
-        try:
-            os.kill(pid, 0)
-        except OSError:
-            pass
-        else:
+        if not self.waitForExit(pid):
             self.fail("Process failed to terminate")
 
 
@@ -1116,11 +1294,7 @@ class ComponentTests(ossie.utils.testing.ScaComponentTestCase):
                 self.fail("Process failed to execute")
             time.sleep(1)    
             self.comp_obj.terminate(pid)
-            try:
-                os.kill(pid, 0)
-            except OSError:
-                pass
-            else:
+            if not self.waitForExit(pid):
                 self.fail("Process failed to terminate")
 
     def testForceOverride(self):
@@ -1178,11 +1352,7 @@ class ComponentTests(ossie.utils.testing.ScaComponentTestCase):
                 self.fail("Process failed to execute")
             time.sleep(1)    
             self.comp_obj.terminate(pid)
-            try:
-                os.kill(pid, 0)
-            except OSError:
-                pass
-            else:
+            if not self.waitForExit(pid):
                 self.fail("Process failed to terminate")
 
     def testReservation(self):
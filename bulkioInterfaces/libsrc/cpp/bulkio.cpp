@@ -22,6 +22,8 @@
 
 
 *******************************************************************************************/
+#include <algorithm>
+
 #include "bulkio_p.h"
 #include "bulkio_traits.h"
 
@@ -79,6 +81,52 @@ namespace  bulkio {
   }
 
 
+  LatencyHistogram::LatencyHistogram()
+  {
+    reset();
+  }
+
+  void LatencyHistogram::record(unsigned long long nsecs)
+  {
+    size_t bucket = 0;
+    while ((nsecs >>= 1) && (bucket < (BUCKETS - 1))) {
+      ++bucket;
+    }
+    ++buckets[bucket];
+  }
+
+  void LatencyHistogram::reset()
+  {
+    std::fill(buckets, buckets + BUCKETS, 0);
+  }
+
+  unsigned long long LatencyHistogram::count() const
+  {
+    unsigned long long total = 0;
+    for (size_t bucket = 0; bucket < BUCKETS; ++bucket) {
+      total += buckets[bucket];
+    }
+    return total;
+  }
+
+  unsigned long long LatencyHistogram::percentile(double pct) const
+  {
+    const unsigned long long total = count();
+    if (total == 0) {
+      return 0;
+    }
+    const double target = total * pct / 100.0;
+    unsigned long long running = 0;
+    for (size_t bucket = 0; bucket < BUCKETS; ++bucket) {
+      running += buckets[bucket];
+      if ((running > 0) && (running >= target)) {
+        return (2ULL << bucket);
+      }
+    }
+    return (2ULL << (BUCKETS - 1));
+  }
+
+
   linkStatistics::linkStatistics( ):
     portName(""),
     nbytes(1)
@@ -98,6 +146,7 @@ namespace  bulkio {
     flush_sec = 0;
     flush_usec = 0;
     connection_errors=0;
+    dropped_total = 0;
   }
 
 
@@ -120,6 +169,7 @@ namespace  bulkio {
     flush_sec = 0;
     flush_usec = 0;
     connection_errors=0;
+    dropped_total = 0;
   }
 
 
@@ -187,6 +237,19 @@ namespace  bulkio {
     }
   }
 
+  void linkStatistics::dropped(const std::string &streamID, unsigned int packets) {
+    dropped_packets[streamID] += packets;
+    dropped_total += packets;
+  }
+
+  uint64_t linkStatistics::droppedPackets(const std::string &streamID) {
+    DropCountMap::iterator iter = dropped_packets.find(streamID);
+    if (iter == dropped_packets.end()) {
+      return 0;
+    }
+    return iter->second;
+  }
+
   BULKIO::PortStatistics linkStatistics::retrieve() {
     if (!enabled) {
       return runningStats;
@@ -236,33 +299,55 @@ namespace  bulkio {
       p++;
     }
 
+    this->runningStats.keywords.length(0);
+    redhawk::PropertyMap& keywords = redhawk::PropertyMap::cast(this->runningStats.keywords);
     if ((this->flush_sec != 0) && (this->flush_usec != 0)) {
       double flushTotalTime = (((double)tv.tv_sec) - this->flush_sec) + (((double)tv.tv_usec - this->flush_usec) / ((double)1e6));
-      this->runningStats.keywords.length(1);
-      this->runningStats.keywords[0].id = CORBA::string_dup("timeSinceLastFlush");
-      this->runningStats.keywords[0].value <<= CORBA::Double(flushTotalTime);
+      keywords["timeSinceLastFlush"] = CORBA::Double(flushTotalTime);
+    }
+
+    // Packets discarded by the overflow policy, in total and per stream
+    if (dropped_total > 0) {
+      keywords["droppedPackets"] = CORBA::ULongLong(dropped_total);
+      for (DropCountMap::iterator iter = dropped_packets.begin(); iter != dropped_packets.end(); ++iter) {
+        keywords["droppedPackets::" + iter->first] = CORBA::ULongLong(iter->second);
+      }
     }
 
     return runningStats;
   }
 
 
+  namespace {
+    //
+    // Takes ownership of the sequence's buffer as the vector's storage, without
+    // copying. This depends on the layout of the GNU libstdc++ vector.
+    //
+    template <class Vector, class Sequence>
+    void adopt_buffer(Vector& vector, const Sequence& data)
+    {
+      typedef typename Vector::value_type ValueType;
+      typedef typename std::_Vector_base< ValueType, typename Vector::allocator_type >::_Vector_impl *ImplPtr;
+
+      const size_t length = data.length();
+      ImplPtr impl = reinterpret_cast<ImplPtr>(&vector);
+      impl->_M_start = reinterpret_cast<ValueType*>(const_cast<Sequence&>(data).get_buffer(1));
+      impl->_M_finish = impl->_M_start + length;
+      impl->_M_end_of_storage = impl->_M_finish;
+    }
+  }
+
+
   template < typename DataTransferTraits >
   DataTransfer< DataTransferTraits >::DataTransfer(const PortSequenceType & data, const BULKIO::PrecisionUTCTime &_T, bool _EOS, const char* _streamID, BULKIO::StreamSRI &_H, bool _sriChanged, bool _inputQueueFlushed)
   {
-    int dataLength = data.length();
-
-    typedef typename std::_Vector_base< TransportType, typename DataTransferTraits::DataBufferType::allocator_type >::_Vector_impl *VectorPtr;
-    
-    VectorPtr vectorPtr = (VectorPtr)(&dataBuffer);
-    vectorPtr->_M_start = const_cast< PortSequenceType *>(&data)->get_buffer(1);
-    vectorPtr->_M_finish = vectorPtr->_M_start + dataLength;
-    vectorPtr->_M_end_of_storage = vectorPtr->_M_finish;
+    adopt_buffer(dataBuffer, data);
 
     //
     // removed...
     //
 #if 0
+    int dataLength = data.length();
     dataBuffer.resize(dataLength);
     if (dataLength > 0) {
       memcpy(&dataBuffer[0], &data[0], dataLength * sizeof(data[0]));
@@ -274,11 +359,25 @@ namespace  bulkio {
     EOS = _EOS;
     streamID = _streamID;
     SRI = _H;
+    sharedSRI.reset(new BULKIO::StreamSRI(_H));
     sriChanged = _sriChanged;
     inputQueueFlushed = _inputQueueFlushed;
   }
 
 
+  template < typename DataTransferTraits >
+  DataTransfer< DataTransferTraits >::DataTransfer(const PortSequenceType & data, const BULKIO::PrecisionUTCTime &_T, bool _EOS, const std::string& _streamID, const SharedSRI &_H, bool _sriChanged, bool _inputQueueFlushed) :
+    T(_T),
+    EOS(_EOS),
+    streamID(_streamID),
+    sriChanged(_sriChanged),
+    inputQueueFlushed(_inputQueueFlushed),
+    sharedSRI(_H)
+  {
+    adopt_buffer(dataBuffer, data);
+  }
+
+
 
 
 
@@ -23,8 +23,10 @@
 
 #include <queue>
 #include <list>
+#include <map>
 #include <vector>
 #include <set>
+#include <boost/shared_ptr.hpp>
 #include <boost/thread/condition_variable.hpp>
 #include <boost/thread/locks.hpp>
 #include <boost/thread/locks.hpp>
@@ -73,20 +75,36 @@ namespace bulkio {
 
   typedef std::vector< BULKIO::StreamSRI >                               SriList;
 
+  //
+  // Immutable StreamSRI shared by reference between an input port's stream state, its queued
+  // packets and the data blocks read from them, instead of a copy per packet
+  //
+  typedef boost::shared_ptr< const BULKIO::StreamSRI >                   SharedSRI;
+
   //
   // Tracks an SRI and which connections have the most recent version
   //
   struct SriMapStruct {
     BULKIO::StreamSRI        sri;
+    // Version of sri assigned by its source (see bulkio::sri::nextVersion),
+    // or 0 if it was pushed without one; equal non-zero versions mean an
+    // identical SRI, so no field comparison is needed
+    unsigned long            version;
     std::set<std::string>    connections;
+    // Connections that have received any SRI for the stream, and so need an
+    // EOS on disconnect even if they do not have the current one
+    std::set<std::string>    delivered;
 
-    SriMapStruct( const BULKIO::StreamSRI &in_sri ) {
+    SriMapStruct( const BULKIO::StreamSRI &in_sri, unsigned long in_version=0 ) {
       sri = in_sri;
+      version = in_version;
     };
 
     SriMapStruct( const SriMapStruct &src ) {
       sri = src.sri;
+      version = src.version;
       connections = src.connections;
+      delivered = src.delivered;
     };
   };
 
@@ -174,6 +192,15 @@ namespace bulkio {
 
       virtual void update(unsigned int elementsReceived, float queueSize, bool EOS, const std::string &streamID, bool flush = false);
 
+      //
+      // Count packets for streamID that were discarded by the port's overflow policy; drop
+      // counts are kept whether or not statistics are enabled
+      //
+      virtual void dropped(const std::string &streamID, unsigned int packets = 1);
+
+      virtual uint64_t droppedPackets(const std::string &streamID);
+      virtual uint64_t droppedPackets() { return dropped_total; };
+
       StreamIDList getActiveStreamIDs(){return activeStreamIDs;};
 
       virtual BULKIO::PortStatistics retrieve();
@@ -204,9 +231,33 @@ namespace bulkio {
 
       double flush_sec;                   // track time since last queue flush happened
       double flush_usec;                  // track time since last queue flush happened
+
+      typedef std::map< std::string, uint64_t > DropCountMap;
+      DropCountMap dropped_packets;       // packets discarded per stream
+      uint64_t dropped_total;
   };
 
 
+  //
+  // Policy applied by a provides port when a packet arrives in non-blocking mode and the port
+  // queue, or the packet's stream, has reached its depth or byte limit
+  //
+  //   FLUSH_QUEUE  - discard every queued packet (default)
+  //   DROP_OLDEST  - discard the oldest queued packets of the offending stream until the new packet fits
+  //   DROP_NEWEST  - discard the incoming packet
+  //   BLOCK_STREAM - block the pushPacket call of the offending stream until its packets are consumed
+  //
+  // The offending stream is the packet's own stream when a per-stream limit is reached, or the stream
+  // with the most queued data when a port-wide limit is reached.  End-of-stream packets are never
+  // dropped; the next packet queued for a stream that lost packets is marked with inputQueueFlushed.
+  //
+  enum OverflowPolicy {
+    FLUSH_QUEUE = 0,
+    DROP_OLDEST,
+    DROP_NEWEST,
+    BLOCK_STREAM
+  };
+
   class queueSemaphore {
 
   public:
@@ -232,6 +283,30 @@ namespace bulkio {
 
   };
 
+  //
+  // Histogram of latencies with power-of-two buckets: bucket n counts latencies of at least 2^n and less
+  // than 2^(n+1) nanoseconds, except that bucket 0 also counts zero and the last bucket counts everything
+  // longer.
+  //
+  struct LatencyHistogram {
+    static const size_t BUCKETS = 32;
+
+    LatencyHistogram();
+
+    void record(unsigned long long nsecs);
+
+    void reset();
+
+    // Total number of latencies recorded
+    unsigned long long count() const;
+
+    // Upper bound, in nanoseconds, of the bucket that contains the given percentile (0-100) of the
+    // recorded latencies; 0 if none have been recorded
+    unsigned long long percentile(double pct) const;
+
+    unsigned long long buckets[BUCKETS];
+  };
+
   namespace Const {
 
     //
@@ -315,6 +390,53 @@ namespace bulkio {
       void normalize(BULKIO::PrecisionUTCTime& time);
     };
 
+    /*
+     * Compact time stamp that keeps time as a 64-bit count of nanoseconds
+     * since J1970, so that offsets and comparisons use integer arithmetic and
+     * do not accumulate floating point error. Conversion to and from a
+     * PrecisionUTCTime is exact to the nanosecond; the timecode mode, status
+     * and sample offset are carried unchanged.
+     */
+    class NanoTime {
+    public:
+      static const int64_t NS_PER_SEC = 1000000000LL;
+
+      NanoTime();
+      explicit NanoTime(const BULKIO::PrecisionUTCTime& time);
+
+      BULKIO::PrecisionUTCTime toUTC() const;
+
+      int64_t nanoseconds() const { return _ns; }
+      void    nanoseconds(int64_t ns) { _ns = ns; }
+
+      /*
+       * Returns the offset in nanoseconds of the given sample, rounded to the
+       * nearest nanosecond
+       */
+      static int64_t sampleOffset(size_t samples, double xdelta);
+
+      NanoTime& operator+=(int64_t ns) { _ns += ns; return *this; }
+      NanoTime& operator-=(int64_t ns) { _ns -= ns; return *this; }
+      NanoTime  operator+(int64_t ns) const { NanoTime result(*this); return result += ns; }
+      NanoTime  operator-(int64_t ns) const { NanoTime result(*this); return result -= ns; }
+      int64_t   operator-(const NanoTime& other) const { return _ns - other._ns; }
+
+      // Comparisons are by time only, consistent with ordering; the timecode
+      // mode, status and sample offset are not compared
+      bool operator==(const NanoTime& other) const { return _ns == other._ns; }
+      bool operator!=(const NanoTime& other) const { return _ns != other._ns; }
+      bool operator<(const NanoTime& other) const { return _ns < other._ns; }
+      bool operator<=(const NanoTime& other) const { return _ns <= other._ns; }
+      bool operator>(const NanoTime& other) const { return _ns > other._ns; }
+      bool operator>=(const NanoTime& other) const { return _ns >= other._ns; }
+
+    private:
+      int64_t  _ns;
+      Int16    _tcmode;
+      Int16    _tcstatus;
+      double   _toff;
+    };
+
 
     /*
      * A default time stamp comparison method 
@@ -383,6 +505,13 @@ namespace bulkio {
      */
     int compareFields(const BULKIO::StreamSRI& lhs, const BULKIO::StreamSRI& rhs);
 
+    /*
+     * Returns a new SRI version number, unique within the process and never 0;
+     * an SRI tagged with a version can be recognized as unchanged when the
+     * same version is seen again, without a field-by-field comparison
+     */
+    unsigned long nextVersion();
+
     /*
      * Default comparator method when comparing SRI objects
      *
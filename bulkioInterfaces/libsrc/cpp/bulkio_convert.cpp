@@ -0,0 +1,791 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK bulkioInterfaces.
+ *
+ * REDHAWK bulkioInterfaces is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK bulkioInterfaces is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#include "bulkio_convert.h"
+
+#if defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__))
+#define BULKIO_CONVERT_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// The AVX2 kernels are compiled with per-function target attributes so that
+// the rest of the library does not require AVX2; this needs GCC 4.9 or clang
+#if defined(BULKIO_CONVERT_SSE2) && \
+    (defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define BULKIO_CONVERT_AVX2 1
+#include <immintrin.h>
+#define BULKIO_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace {
+
+  // Kernels for one instruction set
+  struct Kernels {
+    bulkio::convert::InstructionSet isa;
+    void (*int8ToFloat)(const int8_t*, float*, size_t, float);
+    void (*uint8ToFloat)(const uint8_t*, float*, size_t, float);
+    void (*int16ToFloat)(const int16_t*, float*, size_t, float);
+    void (*uint16ToFloat)(const uint16_t*, float*, size_t, float);
+    void (*int32ToFloat)(const int32_t*, float*, size_t, float);
+    void (*floatToDouble)(const float*, double*, size_t, double);
+    void (*doubleToFloat)(const double*, float*, size_t, float);
+    void (*scaleFloat)(const float*, float*, size_t, float);
+    void (*scaleDouble)(const double*, double*, size_t, double);
+    void (*byteswap16)(uint16_t*, size_t);
+    void (*byteswap32)(uint32_t*, size_t);
+    void (*byteswap64)(uint64_t*, size_t);
+    void (*deinterleaveFloat)(const float*, float*, float*, size_t);
+    void (*deinterleaveDouble)(const double*, double*, double*, size_t);
+    void (*interleaveFloat)(const float*, const float*, float*, size_t);
+    void (*interleaveDouble)(const double*, const double*, double*, size_t);
+  };
+
+  //
+  // Scalar kernels, also used to finish the tail of the vector kernels
+  //
+  namespace scalar {
+
+    template <typename Src, typename Dst>
+    void convert(const Src* src, Dst* dst, size_t count, Dst scale)
+    {
+      for (size_t index = 0; index < count; ++index) {
+        dst[index] = static_cast<Dst>(src[index]) * scale;
+      }
+    }
+
+    template <typename T>
+    void scale(const T* src, T* dst, size_t count, T factor)
+    {
+      for (size_t index = 0; index < count; ++index) {
+        dst[index] = src[index] * factor;
+      }
+    }
+
+    void byteswap16(uint16_t* data, size_t count)
+    {
+      for (size_t index = 0; index < count; ++index) {
+        data[index] = (data[index] << 8) | (data[index] >> 8);
+      }
+    }
+
+    void byteswap32(uint32_t* data, size_t count)
+    {
+      for (size_t index = 0; index < count; ++index) {
+        data[index] = __builtin_bswap32(data[index]);
+      }
+    }
+
+    void byteswap64(uint64_t* data, size_t count)
+    {
+      for (size_t index = 0; index < count; ++index) {
+        data[index] = __builtin_bswap64(data[index]);
+      }
+    }
+
+    template <typename T>
+    void deinterleave(const T* src, T* real, T* imag, size_t count)
+    {
+      for (size_t index = 0; index < count; ++index) {
+        real[index] = src[2*index];
+        imag[index] = src[2*index+1];
+      }
+    }
+
+    template <typename T>
+    void interleave(const T* real, const T* imag, T* dst, size_t count)
+    {
+      for (size_t index = 0; index < count; ++index) {
+        dst[2*index] = real[index];
+        dst[2*index+1] = imag[index];
+      }
+    }
+
+    const Kernels kernels = {
+      bulkio::convert::SCALAR,
+      &convert<int8_t,float>,
+      &convert<uint8_t,float>,
+      &convert<int16_t,float>,
+      &convert<uint16_t,float>,
+      &convert<int32_t,float>,
+      &convert<float,double>,
+      &convert<double,float>,
+      &scale<float>,
+      &scale<double>,
+      &byteswap16,
+      &byteswap32,
+      &byteswap64,
+      &deinterleave<float>,
+      &deinterleave<double>,
+      &interleave<float>,
+      &interleave<double>
+    };
+  }
+
+#ifdef BULKIO_CONVERT_SSE2
+  //
+  // SSE2 kernels, the baseline for x86_64
+  //
+  namespace sse2 {
+
+    void int8ToFloat(const int8_t* src, float* dst, size_t count, float scale)
+    {
+      const __m128 factor = _mm_set1_ps(scale);
+      size_t index = 0;
+      for (; (index + 16) <= count; index += 16) {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + index));
+        // Sign-extend by placing each byte in the high half and shifting down
+        const __m128i lo16 = _mm_srai_epi16(_mm_unpacklo_epi8(bytes, bytes), 8);
+        const __m128i hi16 = _mm_srai_epi16(_mm_unpackhi_epi8(bytes, bytes), 8);
+        const __m128i v0 = _mm_srai_epi32(_mm_unpacklo_epi16(lo16, lo16), 16);
+        const __m128i v1 = _mm_srai_epi32(_mm_unpackhi_epi16(lo16, lo16), 16);
+        const __m128i v2 = _mm_srai_epi32(_mm_unpacklo_epi16(hi16, hi16), 16);
+        const __m128i v3 = _mm_srai_epi32(_mm_unpackhi_epi16(hi16, hi16), 16);
+        _mm_storeu_ps(dst + index, _mm_mul_ps(_mm_cvtepi32_ps(v0), factor));
+        _mm_storeu_ps(dst + index + 4, _mm_mul_ps(_mm_cvtepi32_ps(v1), factor));
+        _mm_storeu_ps(dst + index + 8, _mm_mul_ps(_mm_cvtepi32_ps(v2), factor));
+        _mm_storeu_ps(dst + index + 12, _mm_mul_ps(_mm_cvtepi32_ps(v3), factor));
+      }
+      scalar::convert(src + index, dst + index, count - index, scale);
+    }
+
+    void uint8ToFloat(const uint8_t* src, float* dst, size_t count, float scale)
+    {
+      const __m128 factor = _mm_set1_ps(scale);
+      const __m128i zero = _mm_setzero_si128();
+      size_t index = 0;
+      for (; (index + 16) <= count; index += 16) {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + index));
+        const __m128i lo16 = _mm_unpacklo_epi8(bytes, zero);
+        const __m128i hi16 = _mm_unpackhi_epi8(bytes, zero);
+        _mm_storeu_ps(dst + index, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo16, zero)), factor));
+        _mm_storeu_ps(dst + index + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo16, zero)), factor));
+        _mm_storeu_ps(dst + index + 8, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi16, zero)), factor));
+        _mm_storeu_ps(dst + index + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi16, zero)), factor));
+      }
+      scalar::convert(src + index, dst + index, count - index, scale);
+    }
+
+    void int16ToFloat(const int16_t* src, float* dst, size_t count, float scale)
+    {
+      const __m128 factor = _mm_set1_ps(scale);
+      size_t index = 0;
+      for (; (index + 8) <= count; index += 8) {
+        const __m128i words = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + index));
+        const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(words, words), 16);
+        const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(words, words), 16);
+        _mm_storeu_ps(dst + index, _mm_mul_ps(_mm_cvtepi32_ps(lo), factor));
+        _mm_storeu_ps(dst + index + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), factor));
+      }
+      scalar::convert(src + index, dst + index, count - index, scale);
+    }
+
+    void uint16ToFloat(const uint16_t* src, float* dst, size_t count, float scale)
+    {
+      const __m128 factor = _mm_set1_ps(scale);
+      const __m128i zero = _mm_setzero_si128();
+      size_t index = 0;
+      for (; (index + 8) <= count; index += 8) {
+        const __m128i words = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + index));
+        const __m128i lo = _mm_unpacklo_epi16(words, zero);
+        const __m128i hi = _mm_unpackhi_epi16(words, zero);
+        _mm_storeu_ps(dst + index, _mm_mul_ps(_mm_cvtepi32_ps(lo), factor));
+        _mm_storeu_ps(dst + index + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), factor));
+      }
+      scalar::convert(src + index, dst + index, count - index, scale);
+    }
+
+    void int32ToFloat(const int32_t* src, float* dst, size_t count, float scale)
+    {
+      const __m128 factor = _mm_set1_ps(scale);
+      size_t index = 0;
+      for (; (index + 4) <= count; index += 4) {
+        const __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + index));
+        _mm_storeu_ps(dst + index, _mm_mul_ps(_mm_cvtepi32_ps(values), factor));
+      }
+      scalar::convert(src + index, dst + index, count - index, scale);
+    }
+
+    void floatToDouble(const float* src, double* dst, size_t count, double scale)
+    {
+      const __m128d factor = _mm_set1_pd(scale);
+      size_t index = 0;
+      for (; (index + 4) <= count; index += 4) {
+        const __m128 values = _mm_loadu_ps(src + index);
+        _mm_storeu_pd(dst + index, _mm_mul_pd(_mm_cvtps_pd(values), factor));
+        _mm_storeu_pd(dst + index + 2, _mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(values, values)), factor));
+      }
+      scalar::convert(src + index, dst + index, count - index, scale);
+    }
+
+    void doubleToFloat(const double* src, float* dst, size_t count, float scale)
+    {
+      const __m128 factor = _mm_set1_ps(scale);
+      size_t index = 0;
+      for (; (index + 4) <= count; index += 4) {
+        const __m128 lo = _mm_cvtpd_ps(_mm_loadu_pd(src + index));
+        const __m128 hi = _mm_cvtpd_ps(_mm_loadu_pd(src + index + 2));
+        _mm_storeu_ps(dst + index, _mm_mul_ps(_mm_movelh_ps(lo, hi), factor));
+      }
+      scalar::convert(src + index, dst + index, count - index, scale);
+    }
+
+    void scaleFloat(const float* src, float* dst, size_t count, float scale)
+    {
+      const __m128 factor = _mm_set1_ps(scale);
+      size_t index = 0;
+      for (; (index + 4) <= count; index += 4) {
+        _mm_storeu_ps(dst + index, _mm_mul_ps(_mm_loadu_ps(src + index), factor));
+      }
+      scalar::scale(src + index, dst + index, count - index, scale);
+    }
+
+    void scaleDouble(const double* src, double* dst, size_t count, double scale)
+    {
+      const __m128d factor = _mm_set1_pd(scale);
+      size_t index = 0;
+      for (; (index + 2) <= count; index += 2) {
+        _mm_storeu_pd(dst + index, _mm_mul_pd(_mm_loadu_pd(src + index), factor));
+      }
+      scalar::scale(src + index, dst + index, count - index, scale);
+    }
+
+    // SSE2 has no byte shuffle; swap the bytes within each 16-bit word, after
+    // reordering the words for the wider types
+    inline __m128i swapWordBytes(__m128i values)
+    {
+      return _mm_or_si128(_mm_slli_epi16(values, 8), _mm_srli_epi16(values, 8));
+    }
+
+    void byteswap16(uint16_t* data, size_t count)
+    {
+      size_t index = 0;
+      for (; (index + 8) <= count; index += 8) {
+        __m128i* ptr = reinterpret_cast<__m128i*>(data + index);
+        _mm_storeu_si128(ptr, swapWordBytes(_mm_loadu_si128(ptr)));
+      }
+      scalar::byteswap16(data + index, count - index);
+    }
+
+    void byteswap32(uint32_t* data, size_t count)
+    {
+      size_t index = 0;
+      for (; (index + 4) <= count; index += 4) {
+        __m128i* ptr = reinterpret_cast<__m128i*>(data + index);
+        __m128i values = _mm_loadu_si128(ptr);
+        values = _mm_shufflelo_epi16(values, _MM_SHUFFLE(2,3,0,1));
+        values = _mm_shufflehi_epi16(values, _MM_SHUFFLE(2,3,0,1));
+        _mm_storeu_si128(ptr, swapWordBytes(values));
+      }
+      scalar::byteswap32(data + index, count - index);
+    }
+
+    void byteswap64(uint64_t* data, size_t count)
+    {
+      size_t index = 0;
+      for (; (index + 2) <= count; index += 2) {
+        __m128i* ptr = reinterpret_cast<__m128i*>(data + index);
+        __m128i values = _mm_loadu_si128(ptr);
+        values = _mm_shufflelo_epi16(values, _MM_SHUFFLE(0,1,2,3));
+        values = _mm_shufflehi_epi16(values, _MM_SHUFFLE(0,1,2,3));
+        _mm_storeu_si128(ptr, swapWordBytes(values));
+      }
+      scalar::byteswap64(data + index, count - index);
+    }
+
+    void deinterleaveFloat(const float* src, float* real, float* imag, size_t count)
+    {
+      size_t index = 0;
+      for (; (index + 4) <= count; index += 4) {
+        const __m128 first = _mm_loadu_ps(src + 2*index);
+        const __m128 second = _mm_loadu_ps(src + 2*index + 4);
+        _mm_storeu_ps(real + index, _mm_shuffle_ps(first, second, _MM_SHUFFLE(2,0,2,0)));
+        _mm_storeu_ps(imag + index, _mm_shuffle_ps(first, second, _MM_SHUFFLE(3,1,3,1)));
+      }
+      scalar::deinterleave(src + 2*index, real + index, imag + index, count - index);
+    }
+
+    void deinterleaveDouble(const double* src, double* real, double* imag, size_t count)
+    {
+      size_t index = 0;
+      for (; (index + 2) <= count; index += 2) {
+        const __m128d first = _mm_loadu_pd(src + 2*index);
+        const __m128d second = _mm_loadu_pd(src + 2*index + 2);
+        _mm_storeu_pd(real + index, _mm_unpacklo_pd(first, second));
+        _mm_storeu_pd(imag + index, _mm_unpackhi_pd(first, second));
+      }
+      scalar::deinterleave(src + 2*index, real + index, imag + index, count - index);
+    }
+
+    void interleaveFloat(const float* real, const float* imag, float* dst, size_t count)
+    {
+      size_t index = 0;
+      for (; (index + 4) <= count; index += 4) {
+        const __m128 re = _mm_loadu_ps(real + index);
+        const __m128 im = _mm_loadu_ps(imag + index);
+        _mm_storeu_ps(dst + 2*index, _mm_unpacklo_ps(re, im));
+        _mm_storeu_ps(dst + 2*index + 4, _mm_unpackhi_ps(re, im));
+      }
+      scalar::interleave(real + index, imag + index, dst + 2*index, count - index);
+    }
+
+    void interleaveDouble(const double* real, const double* imag, double* dst, size_t count)
+    {
+      size_t index = 0;
+      for (; (index + 2) <= count; index += 2) {
+        const __m128d re = _mm_loadu_pd(real + index);
+        const __m128d im = _mm_loadu_pd(imag + index);
+        _mm_storeu_pd(dst + 2*index, _mm_unpacklo_pd(re, im));
+        _mm_storeu_pd(dst + 2*index + 2, _mm_unpackhi_pd(re, im));
+      }
+      scalar::interleave(real + index, imag + index, dst + 2*index, count - index);
+    }
+
+    const Kernels kernels = {
+      bulkio::convert::SSE2,
+      &int8ToFloat,
+      &uint8ToFloat,
+      &int16ToFloat,
+      &uint16ToFloat,
+      &int32ToFloat,
+      &floatToDouble,
+      &doubleToFloat,
+      &scaleFloat,
+      &scaleDouble,
+      &byteswap16,
+      &byteswap32,
+      &byteswap64,
+      &deinterleaveFloat,
+      &deinterleaveDouble,
+      &interleaveFloat,
+      &interleaveDouble
+    };
+  }
+#endif
+
+#ifdef BULKIO_CONVERT_AVX2
+  //
+  // AVX2 kernels; the widening conversions use the sign/zero-extending loads
+  // and the byte swaps use byte shuffles
+  //
+  namespace avx2 {
+
+    BULKIO_TARGET_AVX2
+    void int8ToFloat(const int8_t* src, float* dst, size_t count, float scale)
+    {
+      const __m256 factor = _mm256_set1_ps(scale);
+      size_t index = 0;
+      for (; (index + 16) <= count; index += 16) {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + index));
+        const __m256i lo = _mm256_cvtepi8_epi32(bytes);
+        const __m256i hi = _mm256_cvtepi8_epi32(_mm_srli_si128(bytes, 8));
+        _mm256_storeu_ps(dst + index, _mm256_mul_ps(_mm256_cvtepi32_ps(lo), factor));
+        _mm256_storeu_ps(dst + index + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(hi), factor));
+      }
+      scalar::convert(src + index, dst + index, count - index, scale);
+    }
+
+    BULKIO_TARGET_AVX2
+    void uint8ToFloat(const uint8_t* src, float* dst, size_t count, float scale)
+    {
+      const __m256 factor = _mm256_set1_ps(scale);
+      size_t index = 0;
+      for (; (index + 16) <= count; index += 16) {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + index));
+        const __m256i lo = _mm256_cvtepu8_epi32(bytes);
+        const __m256i hi = _mm256_cvtepu8_epi32(_mm_srli_si128(bytes, 8));
+        _mm256_storeu_ps(dst + index, _mm256_mul_ps(_mm256_cvtepi32_ps(lo), factor));
+        _mm256_storeu_ps(dst + index + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(hi), factor));
+      }
+      scalar::convert(src + index, dst + index, count - index, scale);
+    }
+
+    BULKIO_TARGET_AVX2
+    void int16ToFloat(const int16_t* src, float* dst, size_t count, float scale)
+    {
+      const __m256 factor = _mm256_set1_ps(scale);
+      size_t index = 0;
+      for (; (index + 16) <= count; index += 16) {
+        const __m256i lo = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + index)));
+        const __m256i hi = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + index + 8)));
+        _mm256_storeu_ps(dst + index, _mm256_mul_ps(_mm256_cvtepi32_ps(lo), factor));
+        _mm256_storeu_ps(dst + index + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(hi), factor));
+      }
+      scalar::convert(src + index, dst + index, count - index, scale);
+    }
+
+    BULKIO_TARGET_AVX2
+    void uint16ToFloat(const uint16_t* src, float* dst, size_t count, float scale)
+    {
+      const __m256 factor = _mm256_set1_ps(scale);
+      size_t index = 0;
+      for (; (index + 16) <= count; index += 16) {
+        const __m256i lo = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + index)));
+        const __m256i hi = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + index + 8)));
+        _mm256_storeu_ps(dst + index, _mm256_mul_ps(_mm256_cvtepi32_ps(lo), factor));
+        _mm256_storeu_ps(dst + index + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(hi), factor));
+      }
+      scalar::convert(src + index, dst + index, count - index, scale);
+    }
+
+    BULKIO_TARGET_AVX2
+    void int32ToFloat(const int32_t* src, float* dst, size_t count, float scale)
+    {
+      const __m256 factor = _mm256_set1_ps(scale);
+      size_t index = 0;
+      for (; (index + 8) <= count; index += 8) {
+        const __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + index));
+        _mm256_storeu_ps(dst + index, _mm256_mul_ps(_mm256_cvtepi32_ps(values), factor));
+      }
+      scalar::convert(src + index, dst + index, count - index, scale);
+    }
+
+    BULKIO_TARGET_AVX2
+    void floatToDouble(const float* src, double* dst, size_t count, double scale)
+    {
+      const __m256d factor = _mm256_set1_pd(scale);
+      size_t index = 0;
+      for (; (index + 8) <= count; index += 8) {
+        const __m256d lo = _mm256_cvtps_pd(_mm_loadu_ps(src + index));
+        const __m256d hi = _mm256_cvtps_pd(_mm_loadu_ps(src + index + 4));
+        _mm256_storeu_pd(dst + index, _mm256_mul_pd(lo, factor));
+        _mm256_storeu_pd(dst + index + 4, _mm256_mul_pd(hi, factor));
+      }
+      scalar::convert(src + index, dst + index, count - index, scale);
+    }
+
+    BULKIO_TARGET_AVX2
+    void doubleToFloat(const double* src, float* dst, size_t count, float scale)
+    {
+      const __m256 factor = _mm256_set1_ps(scale);
+      size_t index = 0;
+      for (; (index + 8) <= count; index += 8) {
+        const __m128 lo = _mm256_cvtpd_ps(_mm256_loadu_pd(src + index));
+        const __m128 hi = _mm256_cvtpd_ps(_mm256_loadu_pd(src + index + 4));
+        const __m256 values = _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+        _mm256_storeu_ps(dst + index, _mm256_mul_ps(values, factor));
+      }
+      scalar::convert(src + index, dst + index, count - index, scale);
+    }
+
+    BULKIO_TARGET_AVX2
+    void scaleFloat(const float* src, float* dst, size_t count, float scale)
+    {
+      const __m256 factor = _mm256_set1_ps(scale);
+      size_t index = 0;
+      for (; (index + 8) <= count; index += 8) {
+        _mm256_storeu_ps(dst + index, _mm256_mul_ps(_mm256_loadu_ps(src + index), factor));
+      }
+      scalar::scale(src + index, dst + index, count - index, scale);
+    }
+
+    BULKIO_TARGET_AVX2
+    void scaleDouble(const double* src, double* dst, size_t count, double scale)
+    {
+      const __m256d factor = _mm256_set1_pd(scale);
+      size_t index = 0;
+      for (; (index + 4) <= count; index += 4) {
+        _mm256_storeu_pd(dst + index, _mm256_mul_pd(_mm256_loadu_pd(src + index), factor));
+      }
+      scalar::scale(src + index, dst + index, count - index, scale);
+    }
+
+    BULKIO_TARGET_AVX2
+    void shuffleBytes(void* data, size_t bytes, __m256i mask)
+    {
+      char* ptr = reinterpret_cast<char*>(data);
+      for (size_t offset = 0; (offset + 32) <= bytes; offset += 32) {
+        __m256i* block = reinterpret_cast<__m256i*>(ptr + offset);
+        _mm256_storeu_si256(block, _mm256_shuffle_epi8(_mm256_loadu_si256(block), mask));
+      }
+    }
+
+    BULKIO_TARGET_AVX2
+    void byteswap16(uint16_t* data, size_t count)
+    {
+      const __m256i mask = _mm256_setr_epi8(1,0,3,2,5,4,7,6,9,8,11,10,13,12,15,14,
+                                            1,0,3,2,5,4,7,6,9,8,11,10,13,12,15,14);
+      const size_t vectored = count - (count % 16);
+      shuffleBytes(data, vectored * sizeof(uint16_t), mask);
+      scalar::byteswap16(data + vectored, count - vectored);
+    }
+
+    BULKIO_TARGET_AVX2
+    void byteswap32(uint32_t* data, size_t count)
+    {
+      const __m256i mask = _mm256_setr_epi8(3,2,1,0,7,6,5,4,11,10,9,8,15,14,13,12,
+                                            3,2,1,0,7,6,5,4,11,10,9,8,15,14,13,12);
+      const size_t vectored = count - (count % 8);
+      shuffleBytes(data, vectored * sizeof(uint32_t), mask);
+      scalar::byteswap32(data + vectored, count - vectored);
+    }
+
+    BULKIO_TARGET_AVX2
+    void byteswap64(uint64_t* data, size_t count)
+    {
+      const __m256i mask = _mm256_setr_epi8(7,6,5,4,3,2,1,0,15,14,13,12,11,10,9,8,
+                                            7,6,5,4,3,2,1,0,15,14,13,12,11,10,9,8);
+      const size_t vectored = count - (count % 4);
+      shuffleBytes(data, vectored * sizeof(uint64_t), mask);
+      scalar::byteswap64(data + vectored, count - vectored);
+    }
+
+    BULKIO_TARGET_AVX2
+    void deinterleaveFloat(const float* src, float* real, float* imag, size_t count)
+    {
+      size_t index = 0;
+      for (; (index + 8) <= count; index += 8) {
+        const __m256 first = _mm256_loadu_ps(src + 2*index);
+        const __m256 second = _mm256_loadu_ps(src + 2*index + 8);
+        // In-lane shuffles leave the 64-bit pairs in (0, 2, 1, 3) order
+        const __m256 re = _mm256_shuffle_ps(first, second, _MM_SHUFFLE(2,0,2,0));
+        const __m256 im = _mm256_shuffle_ps(first, second, _MM_SHUFFLE(3,1,3,1));
+        _mm256_storeu_ps(real + index, _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(re), _MM_SHUFFLE(3,1,2,0))));
+        _mm256_storeu_ps(imag + index, _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(im), _MM_SHUFFLE(3,1,2,0))));
+      }
+      scalar::deinterleave(src + 2*index, real + index, imag + index, count - index);
+    }
+
+    BULKIO_TARGET_AVX2
+    void deinterleaveDouble(const double* src, double* real, double* imag, size_t count)
+    {
+      size_t index = 0;
+      for (; (index + 4) <= count; index += 4) {
+        const __m256d first = _mm256_loadu_pd(src + 2*index);
+        const __m256d second = _mm256_loadu_pd(src + 2*index + 4);
+        const __m256d re = _mm256_unpacklo_pd(first, second);
+        const __m256d im = _mm256_unpackhi_pd(first, second);
+        _mm256_storeu_pd(real + index, _mm256_permute4x64_pd(re, _MM_SHUFFLE(3,1,2,0)));
+        _mm256_storeu_pd(imag + index, _mm256_permute4x64_pd(im, _MM_SHUFFLE(3,1,2,0)));
+      }
+      scalar::deinterleave(src + 2*index, real + index, imag + index, count - index);
+    }
+
+    BULKIO_TARGET_AVX2
+    void interleaveFloat(const float* real, const float* imag, float* dst, size_t count)
+    {
+      size_t index = 0;
+      for (; (index + 8) <= count; index += 8) {
+        const __m256 re = _mm256_loadu_ps(real + index);
+        const __m256 im = _mm256_loadu_ps(imag + index);
+        const __m256 lo = _mm256_unpacklo_ps(re, im);
+        const __m256 hi = _mm256_unpackhi_ps(re, im);
+        _mm256_storeu_ps(dst + 2*index, _mm256_permute2f128_ps(lo, hi, 0x20));
+        _mm256_storeu_ps(dst + 2*index + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+      }
+      scalar::interleave(real + index, imag + index, dst + 2*index, count - index);
+    }
+
+    BULKIO_TARGET_AVX2
+    void interleaveDouble(const double* real, const double* imag, double* dst, size_t count)
+    {
+      size_t index = 0;
+      for (; (index + 4) <= count; index += 4) {
+        const __m256d re = _mm256_loadu_pd(real + index);
+        const __m256d im = _mm256_loadu_pd(imag + index);
+        const __m256d lo = _mm256_unpacklo_pd(re, im);
+        const __m256d hi = _mm256_unpackhi_pd(re, im);
+        _mm256_storeu_pd(dst + 2*index, _mm256_permute2f128_pd(lo, hi, 0x20));
+        _mm256_storeu_pd(dst + 2*index + 4, _mm256_permute2f128_pd(lo, hi, 0x31));
+      }
+      scalar::interleave(real + index, imag + index, dst + 2*index, count - index);
+    }
+
+    const Kernels kernels = {
+      bulkio::convert::AVX2,
+      &int8ToFloat,
+      &uint8ToFloat,
+      &int16ToFloat,
+      &uint16ToFloat,
+      &int32ToFloat,
+      &floatToDouble,
+      &doubleToFloat,
+      &scaleFloat,
+      &scaleDouble,
+      &byteswap16,
+      &byteswap32,
+      &byteswap64,
+      &deinterleaveFloat,
+      &deinterleaveDouble,
+      &interleaveFloat,
+      &interleaveDouble
+    };
+  }
+#endif
+
+  const Kernels* getKernels(bulkio::convert::InstructionSet isa)
+  {
+    switch (isa) {
+#ifdef BULKIO_CONVERT_AVX2
+    case bulkio::convert::AVX2:
+      return &avx2::kernels;
+#endif
+#ifdef BULKIO_CONVERT_SSE2
+    case bulkio::convert::SSE2:
+      return &sse2::kernels;
+#endif
+    default:
+      return &scalar::kernels;
+    }
+  }
+
+  // Selected when the library loads, or on first use if called from another
+  // static initializer; only replaced by useInstructionSet()
+  const Kernels* activeKernels = 0;
+
+  inline const Kernels& kernels()
+  {
+    if (!activeKernels) {
+      activeKernels = getKernels(bulkio::convert::supportedInstructionSet());
+    }
+    return *activeKernels;
+  }
+
+  const Kernels& initialKernels = kernels();
+
+}
+
+namespace bulkio {
+
+  namespace convert {
+
+    InstructionSet supportedInstructionSet()
+    {
+#ifdef BULKIO_CONVERT_AVX2
+      __builtin_cpu_init();
+      if (__builtin_cpu_supports("avx2")) {
+        return AVX2;
+      }
+#endif
+#ifdef BULKIO_CONVERT_SSE2
+      return SSE2;
+#else
+      return SCALAR;
+#endif
+    }
+
+    InstructionSet activeInstructionSet()
+    {
+      return kernels().isa;
+    }
+
+    InstructionSet useInstructionSet(InstructionSet isa)
+    {
+      if (isa > supportedInstructionSet()) {
+        isa = supportedInstructionSet();
+      }
+      activeKernels = getKernels(isa);
+      return activeKernels->isa;
+    }
+
+    const char* instructionSetName(InstructionSet isa)
+    {
+      switch (isa) {
+      case AVX2:
+        return "avx2";
+      case SSE2:
+        return "sse2";
+      default:
+        return "scalar";
+      }
+    }
+
+    void convert(const int8_t* src, float* dst, size_t count, float scale)
+    {
+      kernels().int8ToFloat(src, dst, count, scale);
+    }
+
+    void convert(const uint8_t* src, float* dst, size_t count, float scale)
+    {
+      kernels().uint8ToFloat(src, dst, count, scale);
+    }
+
+    void convert(const int16_t* src, float* dst, size_t count, float scale)
+    {
+      kernels().int16ToFloat(src, dst, count, scale);
+    }
+
+    void convert(const uint16_t* src, float* dst, size_t count, float scale)
+    {
+      kernels().uint16ToFloat(src, dst, count, scale);
+    }
+
+    void convert(const int32_t* src, float* dst, size_t count, float scale)
+    {
+      kernels().int32ToFloat(src, dst, count, scale);
+    }
+
+    void convert(const float* src, double* dst, size_t count, double scale)
+    {
+      kernels().floatToDouble(src, dst, count, scale);
+    }
+
+    void convert(const double* src, float* dst, size_t count, float scale)
+    {
+      kernels().doubleToFloat(src, dst, count, scale);
+    }
+
+    void scale(const float* src, float* dst, size_t count, float factor)
+    {
+      kernels().scaleFloat(src, dst, count, factor);
+    }
+
+    void scale(const double* src, double* dst, size_t count, double factor)
+    {
+      kernels().scaleDouble(src, dst, count, factor);
+    }
+
+    void byteswap16(void* data, size_t count)
+    {
+      kernels().byteswap16(reinterpret_cast<uint16_t*>(data), count);
+    }
+
+    void byteswap32(void* data, size_t count)
+    {
+      kernels().byteswap32(reinterpret_cast<uint32_t*>(data), count);
+    }
+
+    void byteswap64(void* data, size_t count)
+    {
+      kernels().byteswap64(reinterpret_cast<uint64_t*>(data), count);
+    }
+
+    void deinterleave(const std::complex<float>* src, float* real, float* imag, size_t count)
+    {
+      kernels().deinterleaveFloat(reinterpret_cast<const float*>(src), real, imag, count);
+    }
+
+    void deinterleave(const std::complex<double>* src, double* real, double* imag, size_t count)
+    {
+      kernels().deinterleaveDouble(reinterpret_cast<const double*>(src), real, imag, count);
+    }
+
+    void interleave(const float* real, const float* imag, std::complex<float>* dst, size_t count)
+    {
+      kernels().interleaveFloat(real, imag, reinterpret_cast<float*>(dst), count);
+    }
+
+    void interleave(const double* real, const double* imag, std::complex<double>* dst, size_t count)
+    {
+      kernels().interleaveDouble(real, imag, reinterpret_cast<double*>(dst), count);
+    }
+
+  }
+
+}
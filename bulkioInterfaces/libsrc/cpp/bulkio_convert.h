@@ -0,0 +1,214 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK bulkioInterfaces.
+ *
+ * REDHAWK bulkioInterfaces is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK bulkioInterfaces is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#ifndef __bulkio_convert_h
+#define __bulkio_convert_h
+
+#include <algorithm>
+#include <complex>
+#include <cstddef>
+#include <stdint.h>
+
+namespace bulkio {
+
+  /**
+   * @brief  Sample conversion kernels.
+   *
+   * The functions in this namespace convert, scale, byte-swap and
+   * (de)interleave sample buffers such as those returned from an
+   * InputStream read. The common conversions (8 and 16-bit integers and
+   * 32-bit integers to float, float to/from double) have SSE2 and AVX2
+   * implementations that are selected at run time based on the features of
+   * the host processor; all other type pairs use a scalar loop.
+   *
+   * Source and destination buffers may not overlap unless noted.
+   */
+  namespace convert {
+
+    /**
+     * @brief  Instruction sets used by the conversion kernels.
+     */
+    enum InstructionSet {
+      SCALAR = 0,
+      SSE2,
+      AVX2
+    };
+
+    /**
+     * @brief  Returns the best instruction set supported by the processor
+     *         (and this build of the library).
+     */
+    InstructionSet supportedInstructionSet();
+
+    /**
+     * @brief  Returns the instruction set the kernels currently use.
+     */
+    InstructionSet activeInstructionSet();
+
+    /**
+     * @brief  Selects the instruction set the kernels use.
+     * @param isa  Requested instruction set.
+     * @returns  The instruction set in use, which is limited to
+     *           supportedInstructionSet().
+     *
+     * Intended for testing and benchmarking; by default the best supported
+     * instruction set is used.
+     */
+    InstructionSet useInstructionSet(InstructionSet isa);
+
+    /**
+     * @brief  Returns the name of an instruction set ("scalar", "sse2" or
+     *         "avx2").
+     */
+    const char* instructionSetName(InstructionSet isa);
+
+    /**
+     * @brief  Converts @a count samples, multiplying each by @a scale.
+     *
+     * Integer sources are converted exactly before scaling; for example, a
+     * scale of 1/32768 maps 16-bit samples onto [-1.0, 1.0).
+     */
+    void convert(const int8_t* src, float* dst, size_t count, float scale);
+    void convert(const uint8_t* src, float* dst, size_t count, float scale);
+    void convert(const int16_t* src, float* dst, size_t count, float scale);
+    void convert(const uint16_t* src, float* dst, size_t count, float scale);
+    void convert(const int32_t* src, float* dst, size_t count, float scale);
+    void convert(const float* src, double* dst, size_t count, double scale);
+    void convert(const double* src, float* dst, size_t count, float scale);
+
+    /**
+     * @brief  Converts @a count samples by value.
+     */
+    inline void convert(const int8_t* src, float* dst, size_t count)
+    {
+      convert(src, dst, count, 1.0f);
+    }
+
+    inline void convert(const uint8_t* src, float* dst, size_t count)
+    {
+      convert(src, dst, count, 1.0f);
+    }
+
+    inline void convert(const int16_t* src, float* dst, size_t count)
+    {
+      convert(src, dst, count, 1.0f);
+    }
+
+    inline void convert(const uint16_t* src, float* dst, size_t count)
+    {
+      convert(src, dst, count, 1.0f);
+    }
+
+    inline void convert(const int32_t* src, float* dst, size_t count)
+    {
+      convert(src, dst, count, 1.0f);
+    }
+
+    inline void convert(const float* src, double* dst, size_t count)
+    {
+      convert(src, dst, count, 1.0);
+    }
+
+    inline void convert(const double* src, float* dst, size_t count)
+    {
+      convert(src, dst, count, 1.0f);
+    }
+
+    /**
+     * @brief  Scalar conversion for type pairs without a dedicated kernel.
+     */
+    template <typename Src, typename Dst>
+    inline void convert(const Src* src, Dst* dst, size_t count)
+    {
+      for (size_t index = 0; index < count; ++index) {
+        dst[index] = static_cast<Dst>(src[index]);
+      }
+    }
+
+    template <typename Src, typename Dst>
+    inline void convert(const Src* src, Dst* dst, size_t count, Dst scale)
+    {
+      for (size_t index = 0; index < count; ++index) {
+        dst[index] = static_cast<Dst>(src[index]) * scale;
+      }
+    }
+
+    /**
+     * @brief  Copies samples of the same type.
+     */
+    template <typename T>
+    inline void convert(const T* src, T* dst, size_t count)
+    {
+      std::copy(src, src + count, dst);
+    }
+
+    /**
+     * @brief  Multiplies @a count samples by @a factor.
+     *
+     * @a src and @a dst may be the same buffer.
+     */
+    void scale(const float* src, float* dst, size_t count, float factor);
+    void scale(const double* src, double* dst, size_t count, double factor);
+
+    /**
+     * @brief  Reverses the byte order of @a count 16, 32 or 64-bit values in
+     *         place.
+     */
+    void byteswap16(void* data, size_t count);
+    void byteswap32(void* data, size_t count);
+    void byteswap64(void* data, size_t count);
+
+    template <typename T>
+    inline void byteswap(T* data, size_t count)
+    {
+      switch (sizeof(T)) {
+      case 2:
+        byteswap16(data, count);
+        break;
+      case 4:
+        byteswap32(data, count);
+        break;
+      case 8:
+        byteswap64(data, count);
+        break;
+      default:
+        break;
+      }
+    }
+
+    /**
+     * @brief  Splits @a count interleaved complex samples into separate real
+     *         and imaginary buffers.
+     */
+    void deinterleave(const std::complex<float>* src, float* real, float* imag, size_t count);
+    void deinterleave(const std::complex<double>* src, double* real, double* imag, size_t count);
+
+    /**
+     * @brief  Combines @a count real and imaginary values into interleaved
+     *         complex samples.
+     */
+    void interleave(const float* real, const float* imag, std::complex<float>* dst, size_t count);
+    void interleave(const double* real, const double* imag, std::complex<double>* dst, size_t count);
+
+  }  // end of convert namespace
+
+}  // end of bulkio namespace
+
+#endif
@@ -34,7 +34,7 @@ template <class T>
 struct DataBlock<T>::Impl
 {
   std::vector<T> data;
-  BULKIO::StreamSRI sri;
+  boost::shared_ptr<const BULKIO::StreamSRI> sri;
   std::list<SampleTimestamp> timestamps;
   int sriChangeFlags;
   bool inputQueueFlushed;
@@ -49,6 +49,14 @@ DataBlock<T>::DataBlock() :
 template <class T>
 DataBlock<T>::DataBlock(const BULKIO::StreamSRI& sri, size_t size) :
   _impl(new Impl())
+{
+  _impl->data.resize(size);
+  _impl->sri.reset(new BULKIO::StreamSRI(sri));
+}
+
+template <class T>
+DataBlock<T>::DataBlock(const boost::shared_ptr<const BULKIO::StreamSRI>& sri, size_t size) :
+  _impl(new Impl())
 {
   _impl->data.resize(size);
   _impl->sri = sri;
@@ -67,13 +75,13 @@ DataBlock<T> DataBlock<T>::copy() const
 template <class T>
 const BULKIO::StreamSRI& DataBlock<T>::sri() const
 {
-  return _impl->sri;
+  return *(_impl->sri);
 }
 
 template <class T>
 double DataBlock<T>::xdelta() const
 {
-  return _impl->sri.xdelta;
+  return _impl->sri->xdelta;
 }
 
 template <class T>
@@ -103,7 +111,7 @@ void DataBlock<T>::resize(size_t count)
 template <class T>
 bool DataBlock<T>::complex() const
 {
-  return (_impl->sri.mode != 0);
+  return (_impl->sri->mode != 0);
 }
 
 template <class T>
@@ -162,7 +170,7 @@ double DataBlock<T>::getNetTimeDrift() const
     throw std::logic_error("no timestamp at offset 0");
   }
 
-  return get_drift(timestamps.front(), timestamps.back(), _impl->sri.xdelta);
+  return get_drift(timestamps.front(), timestamps.back(), _impl->sri->xdelta);
 }
 
 template <class T>
@@ -181,7 +189,7 @@ double DataBlock<T>::getMaxTimeDrift() const
   std::list<SampleTimestamp>::const_iterator next = current;
   ++next;
   for (; next != timestamps.end(); ++current, ++next) {
-    double drift = get_drift(*current, *next, _impl->sri.xdelta);
+    double drift = get_drift(*current, *next, _impl->sri->xdelta);
     if (std::abs(drift) > std::abs(max)) {
       max = drift;
     }
@@ -28,6 +28,8 @@
 
 #include <BULKIO/bulkioDataTypes.h>
 
+#include "bulkio_convert.h"
+
 namespace bulkio {
 
   /**
@@ -171,6 +173,18 @@ namespace bulkio {
      */
     DataBlock(const BULKIO::StreamSRI& sri, size_t size=0);
 
+    /**
+     * @brief  Construct a %DataBlock that shares an existing SRI.
+     * @param sri  Shared, immutable SRI that describes the data.
+     * @param size  Number of samples to allocate.
+     *
+     * Equivalent to the constructor above, but references @a sri instead of
+     * copying it, so that blocks read from the same stream share one SRI.
+     *
+     * @note  This method is typically called by InputStream.
+     */
+    DataBlock(const boost::shared_ptr<const BULKIO::StreamSRI>& sri, size_t size=0);
+
     /**
      * @brief  Copies this block's data and metadata.
      * @returns  A new block.
@@ -182,6 +196,36 @@ namespace bulkio {
      */
     DataBlock copy() const;
 
+    /**
+     * @brief  Converts this block's data to another sample type.
+     * @tparam U  Sample type of the new block.
+     * @returns  A new block of type @a U.
+     * @see  convert::convert()
+     *
+     * Makes a copy of this block with each sample converted to @a U, using
+     * the vectorized conversion kernels where available. The new block has
+     * the same SRI, time stamps and status flags as this block.
+     *
+     * If this block is invalid, returns a new null block.
+     */
+    template <class U>
+    DataBlock<U> as() const;
+
+    /**
+     * @brief  Converts and scales this block's data to another sample type.
+     * @tparam U  Sample type of the new block.
+     * @param scale  Factor applied to each converted sample.
+     * @returns  A new block of type @a U.
+     * @see  as()
+     *
+     * For example, to normalize 16-bit samples to the range [-1.0, 1.0):
+     * @code
+     *   bulkio::FloatDataBlock normalized = block.as<float>(1.0f / 32768.0f);
+     * @endcode
+     */
+    template <class U>
+    DataBlock<U> as(U scale) const;
+
     /**
      * @brief  Gets the stream metadata.
      * @returns  Read-only reference to stream SRI.
@@ -480,6 +524,37 @@ namespace bulkio {
     /// @endcond IMPL
   };
 
+  /// @cond IMPL
+  template <class T>
+  template <class U>
+  DataBlock<U> DataBlock<T>::as() const
+  {
+    return as<U>(U(1));
+  }
+
+  template <class T>
+  template <class U>
+  DataBlock<U> DataBlock<T>::as(U scale) const
+  {
+    if (!_impl) {
+      return DataBlock<U>();
+    }
+    DataBlock<U> result(sri(), size());
+    if (scale == U(1)) {
+      convert::convert(data(), result.data(), size());
+    } else {
+      convert::convert(data(), result.data(), size(), scale);
+    }
+    std::list<SampleTimestamp> timestamps = getTimestamps();
+    for (std::list<SampleTimestamp>::iterator ts = timestamps.begin(); ts != timestamps.end(); ++ts) {
+      result.addTimestamp(*ts);
+    }
+    result.sriChangeFlags(sriChangeFlags());
+    result.inputQueueFlushed(inputQueueFlushed());
+    return result;
+  }
+  /// @endcond
+
   typedef DataBlock<int8_t>           CharDataBlock;
   typedef DataBlock<CORBA::Octet>     OctetDataBlock;
   typedef DataBlock<CORBA::Short>     ShortDataBlock;
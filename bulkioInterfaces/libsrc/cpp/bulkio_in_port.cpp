@@ -17,9 +17,12 @@
  * You should have received a copy of the GNU Lesser General Public License
  * along with this program.  If not, see http://www.gnu.org/licenses/.
  */
+#include <algorithm>
+
 #include <bulkio_p.h>
 
 #include <bulkio_in_port.h>
+#include <ossie/tracing.h>
 
 namespace  bulkio {
 
@@ -61,7 +64,15 @@ namespace  bulkio {
     blocking(false),
     queueSem(new queueSemaphore(100)),
     stats(new linkStatistics(port_name, sizeof(TransportType))),
-    logger(logger)
+    logger(logger),
+    queueBytes(0),
+    overflowPolicy(FLUSH_QUEUE),
+    maxStreamQueueDepth(0),
+    maxQueueBytes(0),
+    maxStreamQueueBytes(0),
+    spinBudget(0),
+    queueSequence(0),
+    lastQueueTime(0)
   {
     std::string _cmpMsg("USER_DEFINED");
     std::string _sriMsg("EMPTY");
@@ -98,6 +109,10 @@ namespace  bulkio {
     // block any data coming out of getPacket.. 
     block();
 
+    // leave any stream selectors that still include this port; InPort has
+    // already done so, because selectors read its streams
+    _detachSelectors();
+
     LOG_TRACE( logger, "PORT:" << name << " DUMP PKTS:" << workQueue.size() );
 
     // purge the queue...
@@ -106,6 +121,11 @@ namespace  bulkio {
       workQueue.pop_front();
       delete tmp;
     }
+    while (discardQueue.size() != 0) {
+      DataTransferType *tmp = discardQueue.front();
+      discardQueue.pop_front();
+      delete tmp;
+    }
 
     // clean up allocated containers
     if ( queueSem ) delete queueSem;
@@ -148,12 +168,12 @@ namespace  bulkio {
   {
     SCOPED_LOCK lock(sriUpdateLock);
     BULKIO::StreamSRISequence seq_rtn;
-    SriMap::iterator currH;
+    SharedSriMap::iterator currH;
     int i = 0;
     for (currH = currentHs.begin(); currH != currentHs.end(); currH++) {
       i++;
       seq_rtn.length(i);
-      seq_rtn[i-1] = currH->second.first;
+      seq_rtn[i-1] = *(currH->second.first);
     }
     BULKIO::StreamSRISequence_var retSRI = new BULKIO::StreamSRISequence(seq_rtn);
 
@@ -180,6 +200,113 @@ namespace  bulkio {
   {
     SCOPED_LOCK lock(dataBufferLock);
     queueSem->setMaxValue(newDepth);
+    spaceAvailable.notify_all();
+  }
+
+  template < typename PortTraits >
+  void InPortBase< PortTraits >::setOverflowPolicy(OverflowPolicy policy)
+  {
+    SCOPED_LOCK lock(dataBufferLock);
+    overflowPolicy = policy;
+    spaceAvailable.notify_all();
+  }
+
+  template < typename PortTraits >
+  OverflowPolicy InPortBase< PortTraits >::getOverflowPolicy()
+  {
+    SCOPED_LOCK lock(dataBufferLock);
+    return overflowPolicy;
+  }
+
+  template < typename PortTraits >
+  void InPortBase< PortTraits >::setMaxStreamQueueDepth(int newDepth)
+  {
+    SCOPED_LOCK lock(dataBufferLock);
+    maxStreamQueueDepth = (newDepth > 0) ? newDepth : 0;
+    spaceAvailable.notify_all();
+  }
+
+  template < typename PortTraits >
+  int InPortBase< PortTraits >::getMaxStreamQueueDepth()
+  {
+    SCOPED_LOCK lock(dataBufferLock);
+    return maxStreamQueueDepth;
+  }
+
+  template < typename PortTraits >
+  void InPortBase< PortTraits >::setMaxQueueBytes(size_t newBytes)
+  {
+    SCOPED_LOCK lock(dataBufferLock);
+    maxQueueBytes = newBytes;
+    spaceAvailable.notify_all();
+  }
+
+  template < typename PortTraits >
+  size_t InPortBase< PortTraits >::getMaxQueueBytes()
+  {
+    SCOPED_LOCK lock(dataBufferLock);
+    return maxQueueBytes;
+  }
+
+  template < typename PortTraits >
+  void InPortBase< PortTraits >::setMaxStreamQueueBytes(size_t newBytes)
+  {
+    SCOPED_LOCK lock(dataBufferLock);
+    maxStreamQueueBytes = newBytes;
+    spaceAvailable.notify_all();
+  }
+
+  template < typename PortTraits >
+  size_t InPortBase< PortTraits >::getMaxStreamQueueBytes()
+  {
+    SCOPED_LOCK lock(dataBufferLock);
+    return maxStreamQueueBytes;
+  }
+
+  template < typename PortTraits >
+  void InPortBase< PortTraits >::setSpinBudget(unsigned int usecs)
+  {
+    SCOPED_LOCK lock(dataBufferLock);
+    spinBudget = usecs;
+  }
+
+  template < typename PortTraits >
+  unsigned int InPortBase< PortTraits >::getSpinBudget()
+  {
+    SCOPED_LOCK lock(dataBufferLock);
+    return spinBudget;
+  }
+
+  template < typename PortTraits >
+  LatencyHistogram InPortBase< PortTraits >::getHandoffLatency()
+  {
+    SCOPED_LOCK lock(dataBufferLock);
+    return handoffLatency;
+  }
+
+  template < typename PortTraits >
+  void InPortBase< PortTraits >::resetHandoffLatency()
+  {
+    SCOPED_LOCK lock(dataBufferLock);
+    handoffLatency.reset();
+  }
+
+  template < typename PortTraits >
+  int InPortBase< PortTraits >::getStreamQueueDepth(const std::string& streamID)
+  {
+    SCOPED_LOCK lock(dataBufferLock);
+    typename StreamQueueMap::iterator state = streamQueues.find(streamID);
+    if (state == streamQueues.end()) {
+      return 0;
+    }
+    return state->second.packets;
+  }
+
+  template < typename PortTraits >
+  uint64_t InPortBase< PortTraits >::getDroppedPackets(const std::string& streamID)
+  {
+    SCOPED_LOCK lock(dataBufferLock);
+    return stats->droppedPackets(streamID);
   }
 
   template < typename PortTraits >
@@ -198,63 +325,105 @@ namespace  bulkio {
     LOG_TRACE(logger,"pushSRI - FIND- PORT:" << name << " NEW SRI:" << streamID << " Mode:" << H.mode << " XDELTA:" << 1.0/H.xdelta );
 
     SCOPED_LOCK lock(sriUpdateLock);
-    SriMap::iterator currH = currentHs.find(streamID);
+    SharedSriMap::iterator currH = currentHs.find(streamID);
     if (currH == currentHs.end()) {
       LOG_DEBUG(logger,"pushSRI  PORT:" << name << " NEW SRI:" << streamID << " Mode:" << H.mode );
       if ( newStreamCallback ) (*newStreamCallback)(tmpH);
-      currentHs[streamID] = std::make_pair(tmpH, true);
+      currentHs[streamID] = std::make_pair(SharedSRI(new BULKIO::StreamSRI(tmpH)), true);
       lock.unlock();
       
       createStream(streamID, tmpH);
     } else {
-      if ( sri_cmp && !sri_cmp(tmpH, currH->second.first)) {
+      if ( sri_cmp && !sri_cmp(tmpH, *(currH->second.first))) {
         LOG_DEBUG(logger,"pushSRI  PORT:" << name << " SAME SRI:" << streamID << " Mode:" << H.mode );
-        currentHs[streamID] = std::make_pair(tmpH, true);
+        // Replace rather than modify the shared SRI, since queued packets
+        // still refer to the previous one
+        currH->second = std::make_pair(SharedSRI(new BULKIO::StreamSRI(tmpH)), true);
       }
     }
     TRACE_EXIT( logger, "InPort::pushSRI"  );
   }
 
 
+  namespace {
+    // Hint to the processor that the thread is polling, reducing power use
+    // and yielding resources to a sibling hyperthread
+    inline void cpu_relax()
+    {
+#if defined(__i386__) || defined(__x86_64__)
+      __asm__ __volatile__("pause");
+#elif defined(__aarch64__)
+      __asm__ __volatile__("yield");
+#endif
+    }
+
+    template <class T>
+    inline typename std::deque<T>::iterator do_erase(std::deque<T>& container, typename std::deque<T>::iterator pos)
+    {
+      if (pos == container.begin()) {
+        // PERFORMANCE NOTE:
+        // In a 1-item deque, erase will end up calling pop_back(); however,
+        // this can lead to greatly reduced performance (observed as 1/4 the
+        // data rate on some systems). In the case where the deque alternates
+        // between 0 and 1 packets (i.e., data is consumed as fast as it is
+        // produced), alternating calls to push_back() and pop_back() will
+        // always cause allocation and deallocation. Explicitly calling
+        // pop_front() if it's the first element prevents this worst case
+        // scenario.
+        container.pop_front();
+        return container.begin();
+      } else {
+        return container.erase(pos);
+      }
+    }
+  }
+
   template < typename PortTraits >
   void  InPortBase< PortTraits >::queuePacket(const PushArgumentType data, const BULKIO::PrecisionUTCTime& T, CORBA::Boolean EOS, const char* streamID)
   {
 
     TRACE_ENTER( logger, "InPort::pushPacket"  );
+    RH_TRACE_SPAN( "bulkio", "InPort::pushPacket" );
     if (queueSem->getMaxValue() == 0) {
       TRACE_EXIT( logger, "InPort::pushPacket"  );
       return;
     }
 
-    if (!_acceptPacket(streamID, EOS)) {
+    // Convert the stream ID once; the packet and the port's bookkeeping copy
+    // the string held by the stream's SRI entry
+    std::string stream_id(streamID);
+    if (!_acceptPacket(stream_id, EOS)) {
       return;
     }
 
-    BULKIO::StreamSRI tmpH = {1, 0.0, 1.0, 1, 0, 0.0, 0.0, 0, 0, streamID, false, 0};
+    SharedSRI sri;
     bool sriChanged = false;
     bool portBlocking = false;
 
-    SriMap::iterator currH;
     {
       SCOPED_LOCK lock(sriUpdateLock);
 
-      currH = currentHs.find(std::string(streamID));
+      SharedSriMap::iterator currH = currentHs.find(stream_id);
       if (currH != currentHs.end()) {
-        tmpH = currH->second.first;
+        // The packet shares the stream's current SRI instead of copying it
+        sri = currH->second.first;
         sriChanged = currH->second.second;
-        currentHs[streamID] = std::make_pair(currH->second.first, false);
+        currH->second.second = false;
+        stream_id = currH->first;
       } else {
         // Unknown stream ID, register a new default SRI following the logic in pushSRI,
         // and set the SRI changed flag
-        LOG_WARN(logger, "InPort::pushPacket received data for stream '" << streamID << "' with no SRI");
+        LOG_WARN(logger, "InPort::pushPacket received data for stream '" << stream_id << "' with no SRI");
+        BULKIO::StreamSRI tmpH = {1, 0.0, 1.0, 1, 0, 0.0, 0.0, 0, 0, streamID, false, 0};
         sriChanged = true;
         if (newStreamCallback) {
           (*newStreamCallback)(tmpH);
         }
-        currentHs[streamID] = std::make_pair(tmpH, false);
+        sri.reset(new BULKIO::StreamSRI(tmpH));
+        currentHs[stream_id] = std::make_pair(sri, false);
         lock.unlock();
 
-        createStream(streamID, tmpH);
+        createStream(stream_id, tmpH);
       }
       portBlocking = blocking;
     }
@@ -262,47 +431,103 @@ namespace  bulkio {
     const size_t length = _getElementLength(data);
     LOG_DEBUG( logger, "bulkio::InPort port blocking:" << portBlocking );
     bool flushToReport = false;
+    WorkQueue discarded;
     if(portBlocking) {
       queueSem->incr();
       SCOPED_LOCK lock(dataBufferLock);
       LOG_TRACE( logger, "bulkio::InPort pushPacket NEW PACKET (QUEUE" << workQueue.size()+1 << ")" );
-      stats->update(length, (float)(workQueue.size()+1)/(float)queueSem->getMaxValue(), EOS, streamID, false);
-      DataTransferType *tmpIn = new DataTransferType(data, T, EOS, streamID, tmpH, sriChanged, false);
-      workQueue.push_back(tmpIn);
+      stats->update(length, (float)(workQueue.size()+1)/(float)queueSem->getMaxValue(), EOS, stream_id, false);
+      DataTransferType *tmpIn = new DataTransferType(data, T, EOS, stream_id, sri, sriChanged, false);
+      _enqueuePacket(tmpIn, _packetBytes(tmpIn));
       dataAvailable.notify_all();
     } else {
+      // Create the packet before taking the lock so its size is known for the
+      // byte limits
+      DataTransferType *tmpIn = new DataTransferType(data, T, EOS, stream_id, sri, sriChanged, false);
+      const size_t bytes = _packetBytes(tmpIn);
+
       SCOPED_LOCK lock(dataBufferLock);
-      bool sriChangedHappened = false;
-      bool flagEOS = false;
-      if (workQueue.size() == queueSem->getMaxValue()) { // reached maximum queue depth - flush the queue
-        LOG_DEBUG( logger, "bulkio::InPort pushPacket PURGE INPUT QUEUE (SIZE" << workQueue.size() << ")" );
-        flushToReport = true;
-        DataTransferType *tmp;
-        while (workQueue.size() != 0) {
-          tmp = workQueue.front();
-          if (tmp->sriChanged == true) {
-            sriChangedHappened = true;
+      QueueStatus status = _checkQueueLimits(stream_id, bytes);
+      while (status != QUEUE_ROOM) {
+        if (overflowPolicy == FLUSH_QUEUE) {
+          // Purge the full queue, or the offending stream's packets if only
+          // the stream is over its limit, folding SRI change and end-of-
+          // stream flags into the new packet
+          LOG_DEBUG( logger, "bulkio::InPort pushPacket PURGE INPUT QUEUE (SIZE" << workQueue.size() << ")" );
+          flushToReport = true;
+          for (typename WorkQueue::iterator ii = workQueue.begin(); ii != workQueue.end();) {
+            if ((status == QUEUE_STREAM_FULL) && ((*ii)->streamID != stream_id)) {
+              ++ii;
+              continue;
+            }
+            DataTransferType *tmp = *ii;
+            if (tmp->sriChanged == true) {
+              tmpIn->sriChanged = true;
+            }
+            if (tmp->EOS == true) {
+              tmpIn->EOS = true;
+            }
+            ii = bulkio::do_erase(workQueue, ii);
+            _packetDequeued(tmp);
+            stats->dropped(tmp->streamID);
+            discarded.push_back(tmp);
+          }
+          break;
+        } else if (overflowPolicy == DROP_NEWEST) {
+          if (tmpIn->EOS) {
+            // Never lose an end-of-stream; allow the queue to exceed its limit
+            break;
           }
-          if (tmp->EOS == true) {
-              flagEOS = true;
+          LOG_DEBUG( logger, "bulkio::InPort pushPacket DROP NEW PACKET stream:" << stream_id );
+          StreamQueueState& state = streamQueues[stream_id];
+          state.sriChanged = state.sriChanged || tmpIn->sriChanged;
+          state.flushed = true;
+          stats->dropped(stream_id);
+          discarded.push_back(tmpIn);
+          tmpIn = 0;
+          break;
+        } else if ((overflowPolicy == BLOCK_STREAM) &&
+                   ((status == QUEUE_STREAM_FULL) || (_largestStream() == stream_id))) {
+          // This stream is the offender; wait for the consumer to make room
+          if (breakBlock) {
+            break;
+          }
+          boost::system_time to_time = boost::get_system_time() + boost::posix_time::seconds(1);
+          spaceAvailable.timed_wait(lock, to_time);
+        } else {
+          // DROP_OLDEST, or BLOCK_STREAM when another stream is filling the
+          // port: discard the offender's oldest packet
+          const std::string offender = (status == QUEUE_STREAM_FULL) ? stream_id : _largestStream();
+          if (!_dropOldest(offender) && ((offender == stream_id) || !_dropOldest(stream_id))) {
+            // Nothing left that can be dropped; allow the queue to exceed its limit
+            break;
           }
-          workQueue.pop_front();
-          delete tmp;
         }
+        status = _checkQueueLimits(stream_id, bytes);
       }
-      if (sriChangedHappened)
-        sriChanged = true;
-      if (flagEOS)
-          EOS = true;
 
-      LOG_DEBUG( logger, "bulkio::InPort pushPacket NEW Packet (QUEUE=" << workQueue.size()+1 << ")");
-      stats->update(length, (float)(workQueue.size()+1)/(float)queueSem->getMaxValue(), EOS, streamID, flushToReport);
-      DataTransferType *tmpIn = new DataTransferType(data, T, EOS, streamID, tmpH, sriChanged, flushToReport);
-      workQueue.push_back(tmpIn);
-      dataAvailable.notify_all();
+      if (tmpIn) {
+        tmpIn->inputQueueFlushed = flushToReport;
+        LOG_DEBUG( logger, "bulkio::InPort pushPacket NEW Packet (QUEUE=" << workQueue.size()+1 << ")");
+        stats->update(length, (float)(workQueue.size()+1)/(float)queueSem->getMaxValue(), tmpIn->EOS, stream_id, flushToReport);
+        _enqueuePacket(tmpIn, bytes);
+        dataAvailable.notify_all();
+      }
+
+      // Hand the discarded packets to the consumer to free; if it is not
+      // reading, free them here once they would exceed a full queue
+      discardQueue.insert(discardQueue.end(), discarded.begin(), discarded.end());
+      discarded.clear();
+      if (discardQueue.size() > queueSem->getMaxValue()) {
+        discarded.swap(discardQueue);
+      }
+    }
+
+    for (typename WorkQueue::iterator ii = discarded.begin(); ii != discarded.end(); ++ii) {
+      delete *ii;
     }
 
-    packetReceived(streamID);
+    packetReceived(stream_id);
 
     TRACE_EXIT( logger, "InPort::pushPacket"  );
   }
@@ -315,9 +540,13 @@ namespace  bulkio {
     uint64_t msecs = (unsigned long)((timeout - secs) * 1e6);
     boost::system_time to_time  = boost::get_system_time() + boost::posix_time::seconds(secs) + boost::posix_time::microseconds(msecs);
     boost::mutex::scoped_lock lock(this->dataBufferLock);
+    const unsigned long long spin_end = workQueue.empty() ? _spinDeadline(timeout) : 0;
+    bool waited = false;
     while (!breakBlock && workQueue.empty()) {
       if (timeout == 0) {
         break;
+      } else if (_spinForPacket(lock, spin_end)) {
+        // A packet arrived (or the port was blocked) while polling
       } else if (timeout > 0) {
         if (!dataAvailable.timed_wait(lock, to_time)) {
           break;
@@ -325,13 +554,16 @@ namespace  bulkio {
       } else {
         dataAvailable.wait(lock);
       }
+      waited = true;
     }
 
     if (breakBlock || workQueue.empty()) {
       return 0;
-    } else {
-      return workQueue.front();
     }
+    if (waited) {
+      _recordHandoff();
+    }
+    return workQueue.front();
   }
 
   template < typename PortTraits >
@@ -375,6 +607,43 @@ namespace  bulkio {
   {
     if (isStreamActive(streamID)) {
       packetWaiters.notify(streamID);
+
+      SCOPED_LOCK lock(selectorsLock);
+      for (std::vector<StreamSelector*>::iterator selector = selectors.begin(); selector != selectors.end(); ++selector) {
+        (*selector)->_packetReceived(this, streamID);
+      }
+    }
+  }
+
+  template < typename PortTraits >
+  void InPortBase< PortTraits >::_addSelector(StreamSelector* selector)
+  {
+    SCOPED_LOCK lock(selectorsLock);
+    if (std::find(selectors.begin(), selectors.end(), selector) == selectors.end()) {
+      selectors.push_back(selector);
+    }
+  }
+
+  template < typename PortTraits >
+  void InPortBase< PortTraits >::_removeSelector(StreamSelector* selector)
+  {
+    SCOPED_LOCK lock(selectorsLock);
+    selectors.erase(std::remove(selectors.begin(), selectors.end(), selector), selectors.end());
+  }
+
+  template < typename PortTraits >
+  void InPortBase< PortTraits >::_detachSelectors()
+  {
+    // _removeSource waits for any select in progress to finish checking this
+    // port, and calls back into _removeSelector, so selectorsLock must not be
+    // held while calling it
+    std::vector<StreamSelector*> attached;
+    {
+      SCOPED_LOCK lock(selectorsLock);
+      attached = selectors;
+    }
+    for (std::vector<StreamSelector*>::iterator selector = attached.begin(); selector != attached.end(); ++selector) {
+      (*selector)->_removeSource(this);
     }
   }
 
@@ -395,7 +664,14 @@ namespace  bulkio {
     breakBlock = true;
     queueSem->release();
     dataAvailable.notify_all();
+    spaceAvailable.notify_all();
     packetWaiters.interrupt();
+    {
+      SCOPED_LOCK lock(selectorsLock);
+      for (std::vector<StreamSelector*>::iterator selector = selectors.begin(); selector != selectors.end(); ++selector) {
+        (*selector)->_portBlocked(this);
+      }
+    }
     TRACE_EXIT( logger, "InPort::block"  );
   }
 
@@ -439,6 +715,19 @@ namespace  bulkio {
 
   template < typename PortTraits >
   typename InPortBase< PortTraits >::DataTransferType * InPortBase< PortTraits >::getPacket(float timeout, const std::string& streamID)
+  {
+    DataTransferType* packet = _getPacket(timeout, streamID);
+    if (packet && packet->sharedSRI) {
+      // Queued packets only share their stream's SRI; callers of getPacket
+      // expect their own copy
+      packet->SRI = *(packet->sharedSRI);
+    }
+    return packet;
+  }
+
+
+  template < typename PortTraits >
+  typename InPortBase< PortTraits >::DataTransferType * InPortBase< PortTraits >::_getPacket(float timeout, const std::string& streamID)
   {
     TRACE_ENTER( logger, "InPort::getPacket"  );
     if (breakBlock) {
@@ -447,16 +736,22 @@ namespace  bulkio {
     }
 
     DataTransferType *tmp=NULL;
+    WorkQueue discarded;
     {
       SCOPED_LOCK lock(dataBufferLock);
       tmp = fetchPacket(streamID);
       uint64_t secs = (unsigned long)(trunc(timeout));
       uint64_t msecs = (unsigned long)((timeout - secs) * 1e6);
       boost::system_time to_time  = boost::get_system_time() + boost::posix_time::seconds(secs) + boost::posix_time::microseconds(msecs);
+      const unsigned long long spin_end = tmp ? 0 : _spinDeadline(timeout);
+      bool waited = false;
       while (!tmp) {
+        waited = true;
         if (timeout == 0.0) {
           TRACE_EXIT( logger, "InPort::getPacket"  );
           return NULL;
+        } else if (_spinForPacket(lock, spin_end)) {
+          // A packet arrived (or the port was blocked) while polling
         } else if (timeout > 0){
           if (!dataAvailable.timed_wait(lock, to_time)) {
             TRACE_EXIT( logger, "InPort::getPacket"  );
@@ -476,7 +771,17 @@ namespace  bulkio {
       }
       
       LOG_TRACE( logger, "bulkio.InPort getPacket PORT:" << name << " (QUEUE="<< workQueue.size() << ")" );
+      if (waited) {
+        _recordHandoff();
+      }
 
+      // Take ownership of any packets dropped by pushPacket, to free them
+      // after releasing the lock
+      discarded.swap(discardQueue);
+    }
+
+    for (typename WorkQueue::iterator ii = discarded.begin(); ii != discarded.end(); ++ii) {
+      delete *ii;
     }
 
     if (!tmp) {
@@ -505,26 +810,51 @@ namespace  bulkio {
     return tmp;
   }
 
-  namespace {
-    template <class T>
-    inline typename std::deque<T>::iterator do_erase(std::deque<T>& container, typename std::deque<T>::iterator pos)
-    {
-      if (pos == container.begin()) {
-        // PERFORMANCE NOTE:
-        // In a 1-item deque, erase will end up calling pop_back(); however,
-        // this can lead to greatly reduced performance (observed as 1/4 the
-        // data rate on some systems). In the case where the deque alternates
-        // between 0 and 1 packets (i.e., data is consumed as fast as it is
-        // produced), alternating calls to push_back() and pop_back() will
-        // always cause allocation and deallocation. Explicitly calling
-        // pop_front() if it's the first element prevents this worst case
-        // scenario.
-        container.pop_front();
-        return container.begin();
-      } else {
-        return container.erase(pos);
+  template < typename PortTraits >
+  unsigned long long InPortBase< PortTraits >::_spinDeadline(float timeout)
+  {
+    if ((spinBudget == 0) || (timeout == 0.0)) {
+      return 0;
+    }
+    unsigned long long budget = spinBudget * 1000ULL;
+    if ((timeout > 0.0) && ((timeout * 1e9) < budget)) {
+      budget = timeout * 1e9;
+    }
+    return redhawk::tracing::now() + budget;
+  }
+
+  template < typename PortTraits >
+  bool InPortBase< PortTraits >::_spinForPacket(SCOPED_LOCK& lock, unsigned long long deadline)
+  {
+    if ((deadline == 0) || (redhawk::tracing::now() >= deadline)) {
+      return false;
+    }
+
+    const unsigned long sequence = queueSequence;
+    const volatile bool& blocked = breakBlock;
+    lock.unlock();
+    bool received = false;
+    for (unsigned int polls = 1; ; ++polls) {
+      if ((queueSequence != sequence) || blocked) {
+        received = true;
+        break;
+      }
+      // Reading the clock costs far more than checking the counter, so only
+      // check the deadline periodically
+      if (((polls % 64) == 0) && (redhawk::tracing::now() >= deadline)) {
+        break;
       }
+      cpu_relax();
     }
+    lock.lock();
+    return received;
+  }
+
+  template < typename PortTraits >
+  void InPortBase< PortTraits >::_recordHandoff()
+  {
+    const unsigned long long now = redhawk::tracing::now();
+    handoffLatency.record((now > lastQueueTime) ? (now - lastQueueTime) : 0);
   }
 
   template < typename PortTraits >
@@ -536,6 +866,7 @@ namespace  bulkio {
       }
       DataTransferType* packet = workQueue.front();
       workQueue.pop_front();
+      _packetDequeued(packet);
       return packet;
     }
 
@@ -543,6 +874,7 @@ namespace  bulkio {
       if ((*ii)->streamID == streamID) {
         DataTransferType* packet = *ii;
         bulkio::do_erase(workQueue, ii);
+        _packetDequeued(packet);
         return packet;
       }
     }
@@ -556,6 +888,7 @@ namespace  bulkio {
     for (typename WorkQueue::iterator ii = workQueue.begin(); ii != workQueue.end();) {
       if ((*ii)->streamID == streamID) {
         bool eos = (*ii)->EOS;
+        _packetDequeued(*ii);
         delete *ii;
         ii = bulkio::do_erase(workQueue, ii);
         if (blocking) {
@@ -570,20 +903,149 @@ namespace  bulkio {
     }
   }
 
+  template < typename PortTraits >
+  size_t InPortBase< PortTraits >::_packetBytes(const DataTransferType* packet)
+  {
+    return packet->dataBuffer.size() * sizeof(typename DataTransferType::DataBufferType::value_type);
+  }
+
+  template < typename PortTraits >
+  typename InPortBase< PortTraits >::QueueStatus InPortBase< PortTraits >::_checkQueueLimits(const std::string& streamID, size_t bytes)
+  {
+    // Caller must hold dataBufferLock
+    if (workQueue.size() >= queueSem->getMaxValue()) {
+      return QUEUE_PORT_FULL;
+    }
+    // A byte limit never rejects a packet into an empty queue, so that a
+    // single packet larger than the limit can still be delivered
+    if (maxQueueBytes && !workQueue.empty() && ((queueBytes + bytes) > maxQueueBytes)) {
+      return QUEUE_PORT_FULL;
+    }
+    if (maxStreamQueueDepth || maxStreamQueueBytes) {
+      typename StreamQueueMap::iterator state = streamQueues.find(streamID);
+      if (state != streamQueues.end()) {
+        if (maxStreamQueueDepth && (state->second.packets >= maxStreamQueueDepth)) {
+          return QUEUE_STREAM_FULL;
+        }
+        if (maxStreamQueueBytes && (state->second.packets > 0) && ((state->second.bytes + bytes) > maxStreamQueueBytes)) {
+          return QUEUE_STREAM_FULL;
+        }
+      }
+    }
+    return QUEUE_ROOM;
+  }
+
+  template < typename PortTraits >
+  void InPortBase< PortTraits >::_enqueuePacket(DataTransferType* packet, size_t bytes)
+  {
+    // Caller must hold dataBufferLock
+    StreamQueueState& state = streamQueues[packet->streamID];
+    if (state.sriChanged) {
+      packet->sriChanged = true;
+      state.sriChanged = false;
+    }
+    if (state.flushed) {
+      packet->inputQueueFlushed = true;
+      state.flushed = false;
+    }
+    state.packets++;
+    state.bytes += bytes;
+    queueBytes += bytes;
+    workQueue.push_back(packet);
+    lastQueueTime = redhawk::tracing::now();
+    queueSequence = queueSequence + 1;
+  }
+
+  template < typename PortTraits >
+  void InPortBase< PortTraits >::_packetDequeued(DataTransferType* packet)
+  {
+    // Caller must hold dataBufferLock, and has already removed the packet
+    // from the work queue
+    const size_t bytes = _packetBytes(packet);
+    queueBytes -= std::min(bytes, queueBytes);
+    typename StreamQueueMap::iterator state = streamQueues.find(packet->streamID);
+    if (state != streamQueues.end()) {
+      state->second.bytes -= std::min(bytes, state->second.bytes);
+      if (state->second.packets > 0) {
+        state->second.packets--;
+      }
+      if ((state->second.packets == 0) && !state->second.sriChanged && !state->second.flushed) {
+        streamQueues.erase(state);
+      }
+    }
+    spaceAvailable.notify_all();
+  }
+
+  template < typename PortTraits >
+  void InPortBase< PortTraits >::_dropPacket(typename WorkQueue::iterator pos)
+  {
+    // Caller must hold dataBufferLock; the packet's SRI change is carried to
+    // the stream's next packet, which is also marked as following lost data
+    DataTransferType* packet = *pos;
+    typename WorkQueue::iterator next = bulkio::do_erase(workQueue, pos);
+    for (; next != workQueue.end(); ++next) {
+      if ((*next)->streamID == packet->streamID) {
+        break;
+      }
+    }
+    if (next != workQueue.end()) {
+      (*next)->sriChanged = (*next)->sriChanged || packet->sriChanged;
+      (*next)->inputQueueFlushed = true;
+    } else {
+      StreamQueueState& state = streamQueues[packet->streamID];
+      state.sriChanged = state.sriChanged || packet->sriChanged;
+      state.flushed = true;
+    }
+    _packetDequeued(packet);
+    stats->dropped(packet->streamID);
+    discardQueue.push_back(packet);
+  }
+
+  template < typename PortTraits >
+  bool InPortBase< PortTraits >::_dropOldest(const std::string& streamID)
+  {
+    // Caller must hold dataBufferLock
+    for (typename WorkQueue::iterator ii = workQueue.begin(); ii != workQueue.end(); ++ii) {
+      if (((*ii)->streamID == streamID) && !(*ii)->EOS) {
+        LOG_DEBUG( logger, "bulkio::InPort pushPacket DROP OLDEST PACKET stream:" << streamID );
+        _dropPacket(ii);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  template < typename PortTraits >
+  std::string InPortBase< PortTraits >::_largestStream()
+  {
+    // Caller must hold dataBufferLock; measured in bytes if there is a byte
+    // limit, otherwise in packets
+    std::string largest;
+    size_t largest_size = 0;
+    for (typename StreamQueueMap::iterator state = streamQueues.begin(); state != streamQueues.end(); ++state) {
+      size_t size = maxQueueBytes ? state->second.bytes : state->second.packets;
+      if (size > largest_size) {
+        largest = state->first;
+        largest_size = size;
+      }
+    }
+    return largest;
+  }
+
   template < typename PortTraits >
   bool InPortBase< PortTraits >::_handleEOS(const std::string& streamID)
   {
     bool turnOffBlocking = false;
     SCOPED_LOCK lock2(sriUpdateLock);
-    SriMap::iterator target = currentHs.find(streamID);
+    SharedSriMap::iterator target = currentHs.find(streamID);
     if (target != currentHs.end()) {
-      bool sriBlocking = target->second.first.blocking;
+      bool sriBlocking = target->second.first->blocking;
       currentHs.erase(target);
       if (sriBlocking) {
         turnOffBlocking = true;
-        SriMap::iterator currH;
+        SharedSriMap::iterator currH;
         for (currH = currentHs.begin(); currH != currentHs.end(); currH++) {
-          if (currH->second.first.blocking) {
+          if (currH->second.first->blocking) {
             turnOffBlocking = false;
             break;
           }
@@ -645,7 +1107,7 @@ namespace  bulkio {
         if (!firstPacket) break;
       }
       firstPacket = false;
-      if (packet->SRI.mode) {
+      if (packet->sharedSRI->mode) {
           item_size = 2;
       }
       samples += packet->dataBuffer.size();
@@ -724,6 +1186,14 @@ namespace  bulkio {
   {
   }
 
+  template < typename PortTraits >
+  InPort< PortTraits >::~InPort()
+  {
+    // Stream selectors call back into this class for its streams, so they
+    // must be done with the port before the stream members are destroyed
+    this->_detachSelectors();
+  }
+
   template < typename PortTraits >
   void InPort< PortTraits >::pushPacket(const PortSequenceType& data, const BULKIO::PrecisionUTCTime& T, CORBA::Boolean EOS, const char* streamID)
   {
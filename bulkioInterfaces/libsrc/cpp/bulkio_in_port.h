@@ -34,6 +34,7 @@
 #include "bulkio_base.h"
 #include "bulkio_traits.h"
 #include "bulkio_in_stream.h"
+#include "bulkio_stream_selector.h"
 #include "bulkio_callbacks.h"
 
 namespace bulkio {
@@ -103,6 +104,10 @@ namespace bulkio {
      * @param streamID  stream id to match on for when pulling data from the port's work queue
      * @return dataTranfer *  pointer to a data transfer object from the port's work queue
      * @return NULL - no data available
+     *
+     * Note: InputStream reads take packets from the queue directly, without
+     * copying the stream's SRI into each packet, and do not go through either
+     * getPacket overload; overriding getPacket does not affect them.
      */
     virtual DataTransferType *getPacket(float timeout, const std::string &streamID);
 
@@ -170,8 +175,8 @@ namespace bulkio {
     virtual int getCurrentQueueDepth();
 
     /*
-     *  getMaxQueueDepth - returns the maximum size of the queue , if this water mark is reached the queue will be purged, and the
-     *                     component of the port will be notified in getPacket method
+     *  getMaxQueueDepth - returns the maximum size of the queue , if this water mark is reached the overflow policy is applied
+     *                     (by default the queue is purged), and the component of the port will be notified in getPacket method
      * @return int - maximum size the queue can reach before purging occurs
      */
     virtual int getMaxQueueDepth();
@@ -181,6 +186,66 @@ namespace bulkio {
      */
     virtual void setMaxQueueDepth(int newDepth);
 
+    /*
+     * setOverflowPolicy - selects how the port handles a packet that arrives when the queue, or the packet's
+     *                     stream, has reached its limit and the port is not blocking (see OverflowPolicy)
+     */
+    virtual void setOverflowPolicy(OverflowPolicy policy);
+
+    virtual OverflowPolicy getOverflowPolicy();
+
+    /*
+     * setMaxStreamQueueDepth - maximum number of packets any one stream may have on the queue, 0 for no
+     *                          per-stream limit (default)
+     */
+    virtual void setMaxStreamQueueDepth(int newDepth);
+
+    virtual int getMaxStreamQueueDepth();
+
+    /*
+     * setMaxQueueBytes - maximum number of bytes of data on the queue, in addition to the packet count
+     *                    limit, 0 for no byte limit (default)
+     */
+    virtual void setMaxQueueBytes(size_t newBytes);
+
+    virtual size_t getMaxQueueBytes();
+
+    /*
+     * setMaxStreamQueueBytes - maximum number of bytes of data any one stream may have on the queue, 0 for
+     *                          no per-stream byte limit (default)
+     */
+    virtual void setMaxStreamQueueBytes(size_t newBytes);
+
+    virtual size_t getMaxStreamQueueBytes();
+
+    /*
+     * setSpinBudget - time in microseconds that getPacket and InputStream reads poll the queue before
+     *                 blocking to wait for data, 0 to always block immediately (default).  Polling avoids
+     *                 the thread wake-up on every packet at the cost of a busy CPU, so it is best suited to
+     *                 latency-sensitive consumers running on dedicated cores.
+     */
+    virtual void setSpinBudget(unsigned int usecs);
+
+    virtual unsigned int getSpinBudget();
+
+    /*
+     * getHandoffLatency - returns a histogram of the time from when a packet is queued to when a consumer
+     *                     that was waiting for data receives it
+     */
+    virtual LatencyHistogram getHandoffLatency();
+
+    virtual void resetHandoffLatency();
+
+    /*
+     * getStreamQueueDepth - returns the number of packets on the queue for a stream
+     */
+    virtual int getStreamQueueDepth(const std::string& streamID);
+
+    /*
+     * getDroppedPackets - returns the number of packets for a stream discarded by the overflow policy
+     */
+    virtual uint64_t getDroppedPackets(const std::string& streamID);
+
     //
     // Allow the component to control the flow of data from the port to the component.  Block will restrict the flow of data back into the
     // component.  Call in component's stop method
@@ -270,9 +335,12 @@ namespace bulkio {
     boost::shared_ptr< SriListener >              newStreamCallback;
 
     //
-    //  List of SRI objects managed by StreamID
+    //  List of SRI objects managed by StreamID; each SRI is shared with the stream's queued
+    //  packets and is replaced, never modified, when the stream's SRI changes
     //
-    SriMap                                         currentHs;
+    typedef std::map< std::string, std::pair< SharedSRI, bool > > SharedSriMap;
+
+    SharedSriMap                                   currentHs;
 
     //
     // synchronizes access to the workQueue member
@@ -320,6 +388,66 @@ namespace bulkio {
     //
     redhawk::signal<std::string> packetWaiters;
 
+    //
+    // Stream selectors that include this port, notified as packets are queued
+    //
+    std::vector<StreamSelector*>                   selectors;
+    MUTEX                                          selectorsLock;
+
+    friend class StreamSelector;
+    void _addSelector(StreamSelector* selector);
+    void _removeSelector(StreamSelector* selector);
+    void _detachSelectors();
+
+    //
+    // Per-stream accounting of the work queue, and pending flags for the next packet queued for a
+    // stream after one of its packets was dropped; guarded by dataBufferLock
+    //
+    struct StreamQueueState {
+      StreamQueueState() : packets(0), bytes(0), sriChanged(false), flushed(false) {};
+      size_t packets;
+      size_t bytes;
+      bool   sriChanged;
+      bool   flushed;
+    };
+    typedef std::map< std::string, StreamQueueState > StreamQueueMap;
+
+    StreamQueueMap                                 streamQueues;
+
+    //
+    // Total size in bytes of the packets in the work queue
+    //
+    size_t                                         queueBytes;
+
+    //
+    // Overflow handling and limits for non-blocking mode
+    //
+    OverflowPolicy                                 overflowPolicy;
+    size_t                                         maxStreamQueueDepth;
+    size_t                                         maxQueueBytes;
+    size_t                                         maxStreamQueueBytes;
+
+    //
+    // Signalled when packets leave the work queue, for streams blocked by the BLOCK_STREAM policy
+    //
+    CONDITION                                      spaceAvailable;
+
+    //
+    // Polling support for low-latency consumers: the spin budget in microseconds, a counter bumped
+    // whenever a packet is queued that polling consumers check without holding dataBufferLock, the time
+    // the last packet was queued and the resulting handoff latencies
+    //
+    unsigned int                                   spinBudget;
+    volatile unsigned long                         queueSequence;
+    unsigned long long                             lastQueueTime;
+    LatencyHistogram                               handoffLatency;
+
+    //
+    // Packets discarded by pushPacket; they are freed by the consumer in getPacket rather than on the
+    // ORB thread while holding dataBufferLock
+    //
+    WorkQueue                                      discardQueue;
+
     //
     // Queues a packet received via pushPacket; in most cases, this method maps
     // exactly to pushPacket, except for dataFile
@@ -339,12 +467,44 @@ namespace bulkio {
     virtual bool isStreamEnabled(const std::string& streamID);
 
     DataTransferType* fetchPacket(const std::string& streamID);
+
+    // getPacket without copying the shared SRI into the packet's SRI member,
+    // for use by InputStream; it is not virtual, so it bypasses any override
+    // of getPacket
+    DataTransferType* _getPacket(float timeout, const std::string& streamID);
+
+    // Returns the time to stop polling for a blocking call with the given timeout, or 0 if the call
+    // should not poll; requires caller to hold dataBufferLock
+    unsigned long long _spinDeadline(float timeout);
+
+    // Polls with dataBufferLock released until a packet is queued, the port is blocked or the deadline
+    // passes; returns with the lock held, and false if the deadline passed
+    bool _spinForPacket(SCOPED_LOCK& lock, unsigned long long deadline);
+
+    // Records the handoff latency of the packet a waiting consumer received; requires caller to hold
+    // dataBufferLock
+    void _recordHandoff();
     void packetReceived(const std::string& streamID);
 
     // Discard currently queued packets for the given stream ID, up to the
     // first end-of-stream; requires caller to hold dataBufferLock
     void discardPacketsForStream(const std::string& streamID);
 
+    // Work queue helpers that keep the per-stream accounting current; all
+    // require the caller to hold dataBufferLock
+    enum QueueStatus {
+      QUEUE_ROOM = 0,
+      QUEUE_STREAM_FULL,
+      QUEUE_PORT_FULL
+    };
+    QueueStatus _checkQueueLimits(const std::string& streamID, size_t bytes);
+    void _enqueuePacket(DataTransferType* packet, size_t bytes);
+    void _packetDequeued(DataTransferType* packet);
+    void _dropPacket(typename WorkQueue::iterator pos);
+    bool _dropOldest(const std::string& streamID);
+    std::string _largestStream();
+    static size_t _packetBytes(const DataTransferType* packet);
+
     friend class InputStream<PortTraits>;
     size_t samplesAvailable(const std::string& streamID, bool firstPacket);
 
@@ -428,6 +588,8 @@ namespace bulkio {
        
     InPort(std::string port_name, void *);
 
+    virtual ~InPort();
+
     //
     // pushPacket called by the source component when pushing a vector of data into a component.  This method will save off the data
     //            vector, timestamp, EOS and streamID onto a queue for consumption by the component via the getPacket method
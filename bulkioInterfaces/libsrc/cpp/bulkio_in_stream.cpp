@@ -69,7 +69,7 @@ public:
 
   Impl(const BULKIO::StreamSRI& sri, bulkio::InPort<PortTraits>* port) :
     _streamID(sri.streamID),
-    _sri(sri),
+    _sri(new BULKIO::StreamSRI(sri)),
     _eosState(EOS_NONE),
     _port(port),
     _queue(),
@@ -93,7 +93,7 @@ public:
 
   const BULKIO::StreamSRI& sri() const
   {
-    return _sri;
+    return *_sri;
   }
 
   bool eos()
@@ -117,7 +117,7 @@ public:
     size_t queued = _samplesQueued;
     if (queued > 0) {
       // Adjust number of samples to account for complex data, if necessary
-      const BULKIO::StreamSRI& sri = _queue.front()->SRI;
+      const BULKIO::StreamSRI& sri = *(_queue.front()->sharedSRI);
       if (sri.mode) {
         queued /= 2;
       }
@@ -390,9 +390,9 @@ private:
     DataTransferType* front = _queue.front();
     int sriChangeFlags = bulkio::sri::NONE;
     if (front->sriChanged) {
-      sriChangeFlags = bulkio::sri::compareFields(_sri, front->SRI);
+      sriChangeFlags = bulkio::sri::compareFields(*_sri, *(front->sharedSRI));
       front->sriChanged = false;
-      _sri = front->SRI;
+      _sri = front->sharedSRI;
     }
 
     if ( _newstream ) {
@@ -437,19 +437,22 @@ private:
       // must be accounted for, so adjust the timestamp based on the SRI.
       // Otherwise, the adjustment is a noop.
       BULKIO::PrecisionUTCTime time = packet->T;
-      double time_offset = packet_offset * packet->SRI.xdelta;
+      double xdelta = packet->sharedSRI->xdelta;
       size_t sample_offset = data_offset;
-      if (packet->SRI.mode) {
+      if (packet->sharedSRI->mode) {
         // Complex data; each sample is two values
-        time_offset /= 2.0;
+        xdelta /= 2.0;
         sample_offset /= 2;
       }
 
       // If there is a time offset, apply the adjustment and mark the timestamp
-      // so that the caller knows it was calculated rather than received
+      // so that the caller knows it was calculated rather than received; the
+      // offset is applied in integer nanoseconds, which is exact for repeated
+      // partial reads of a packet
       bool synthetic = false;
-      if (time_offset > 0.0) {
-        time += time_offset;
+      const int64_t time_offset = bulkio::time::NanoTime::sampleOffset(packet_offset, xdelta);
+      if (time_offset > 0) {
+        time = (bulkio::time::NanoTime(time) + time_offset).toUTC();
         synthetic = true;
       }
 
@@ -487,7 +490,7 @@ private:
       }
     }
 
-    return &(_queue.front()->SRI);
+    return _queue.front()->sharedSRI.get();
   }
 
   bool _fetchPacket(bool blocking)
@@ -508,7 +511,7 @@ private:
     }
 
     float timeout = blocking?bulkio::Const::BLOCKING:bulkio::Const::NON_BLOCKING;
-    DataTransferType* packet = _port->getPacket(timeout, _streamID);
+    DataTransferType* packet = _port->_getPacket(timeout, _streamID);
     if (!packet) {
       return false;
     }
@@ -554,7 +557,7 @@ private:
   }
 
   const std::string _streamID;
-  BULKIO::StreamSRI _sri;
+  bulkio::SharedSRI _sri;
   EosState _eosState;
   InPort<PortTraits>* _port;
   typedef std::vector<DataTransferType*> QueueType;
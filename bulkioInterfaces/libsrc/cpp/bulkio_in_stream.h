@@ -329,6 +329,59 @@ namespace bulkio {
      */
     DataBlockType tryread(size_t count, size_t consume);
 
+    /**
+     * @brief  Reads the next packet, converting to another sample type.
+     * @tparam U  Sample type of the returned data block.
+     * @returns  Valid data block if successful.
+     * @returns  Null data block if the read failed.
+     * @pre  Stream is valid.
+     * @see  read()
+     * @see  DataBlock::as()
+     *
+     * Equivalent to read() followed by a conversion of the data block to
+     * @a U, for example:
+     * @code
+     *   bulkio::FloatDataBlock block = stream.readAs<float>();
+     * @endcode
+     *
+     * Common conversions, such as from 8 or 16-bit integers to float, use
+     * vectorized kernels.
+     */
+    template <class U>
+    DataBlock<U> readAs()
+    {
+      return read().template as<U>();
+    }
+
+    /**
+     * @brief  Reads a specified number of samples, converting to another
+     *         sample type.
+     * @tparam U  Sample type of the returned data block.
+     * @param count  Number of samples to read
+     * @see  read(size_t)
+     * @see  readAs()
+     */
+    template <class U>
+    DataBlock<U> readAs(size_t count)
+    {
+      return read(count).template as<U>();
+    }
+
+    /**
+     * @brief  Reads a specified number of samples, with overlap, converting to
+     *         another sample type.
+     * @tparam U  Sample type of the returned data block.
+     * @param count  Number of samples to read.
+     * @param consume  Number of samples to advance read pointer.
+     * @see  read(size_t,size_t)
+     * @see  readAs()
+     */
+    template <class U>
+    DataBlock<U> readAs(size_t count, size_t consume)
+    {
+      return read(count, consume).template as<U>();
+    }
+
     /**
      * @brief  Discard a specified number of samples.
      * @param count  Number of samples to skip.
@@ -24,6 +24,7 @@
 #include "bulkio_out_port.h"
 #include "bulkio_p.h"
 #include "bulkio_time_operators.h"
+#include <ossie/tracing.h>
 
 // Suppress warnings for access to "deprecated" currentSRI member--it's the
 // public access that's deprecated, not the member itself
@@ -120,8 +121,10 @@ namespace  bulkio {
       sri_iter=  currentSRIs.find( sid );
     }
     else {
-      // overwrite the SRI 
+      // overwrite the SRI; it carries no version, so a later queueSRI always
+      // counts as a change
       sri_iter->second.sri = H;
+      sri_iter->second.version = 0;
 
       // reset connections list to be empty
       sri_iter->second.connections.clear();
@@ -132,12 +135,12 @@ namespace  bulkio {
         if (!_isStreamRoutedToConnection(sid, i->second)) {
           continue;
         }
-
         std::string cid = i->second;
         LOG_DEBUG(logger,"pushSRI - PORT:" << name << " CONNECTION:" << i->second << " SRI streamID:" << H.streamID << " Mode:" << H.mode << " XDELTA:" << 1.0/H.xdelta );  
         try {
           i->first->pushSRI(H);
           sri_iter->second.connections.insert( i->second );
+          sri_iter->second.delivered.insert( i->second );
         } catch( CORBA::TRANSIENT &ex ) {
             if ( reportConnectionErrors(cid) ) {
                 LOG_ERROR( logger, "PUSH-SRI FAILED (Transient), PORT/CONNECTION: " << name << "/" << cid );
@@ -163,6 +166,27 @@ namespace  bulkio {
   }
 
 
+  template < typename PortTraits >
+  void OutPortBase< PortTraits >::queueSRI(const BULKIO::StreamSRI& H, unsigned long version) {
+
+    SCOPED_LOCK lock(updatingPortsLock);
+
+    std::string sid( H.streamID );
+    typename OutPortSriMap::iterator sri_iter = currentSRIs.find( sid );
+    if ( sri_iter == currentSRIs.end() ) {
+      // need to use insert since we do not have default CTOR for SriMapStruct
+      currentSRIs.insert( OutPortSriMap::value_type( sid, SriMapStruct( H, version ) ) );
+    }
+    else if ( version == 0 || sri_iter->second.version != version ) {
+      // Every connection receives the update with its next packet; queueing
+      // the current version again leaves the connections as they are
+      sri_iter->second.sri = H;
+      sri_iter->second.version = version;
+      sri_iter->second.connections.clear();
+    }
+  }
+
+
   template < typename PortTraits >
   bool OutPortBase< PortTraits >::_isStreamRoutedToConnection(
           const std::string& streamID,
@@ -250,6 +274,8 @@ namespace  bulkio {
             continue;
           }
 
+          RH_TRACE_SPAN( "bulkio", "OutPort::pushPacket" );
+
           if ( sri_iter != currentSRIs.end() && sri_iter->second.connections.count( port->second ) == 0 ) {
             this->_pushSRI( port, sri_iter->second );
           }
@@ -391,8 +417,9 @@ namespace  bulkio {
         for (; cSRIs!=currentSRIs.end(); cSRIs++) {
           std::string cSriSid(cSRIs->second.sri.streamID);
 
-          // Check if we have sent out sri/data to the connection
-          if ( cSRIs->second.connections.count( cid ) != 0 ) {
+          // Check if we have sent out sri/data to the connection; it may have
+          // a queued update pending, so check what was delivered
+          if ( cSRIs->second.delivered.count( cid ) != 0 ) {
             if (_isStreamRoutedToConnection(cSriSid, cid)) {
               try {
                 _sendEOS(ii->first, cSriSid);
@@ -403,6 +430,7 @@ namespace  bulkio {
 
           // remove connection id from sri connections list
           cSRIs->second.connections.erase( cid );
+          cSRIs->second.delivered.erase( cid );
 
         }
         LOG_DEBUG( logger, "DISCONNECT, PORT/CONNECTION: "  << name << "/" << connectionId );
@@ -434,6 +462,7 @@ namespace  bulkio {
       try {
           connPair->first->pushSRI(sri_ctx.sri);
           sri_ctx.connections.insert( connPair->second );
+          sri_ctx.delivered.insert( connPair->second );
           LOG_TRACE( logger, "_pushSRI()  connection_id/streamID " << connPair->second << "/" << sri_ctx.sri.streamID );
       } catch( CORBA::TRANSIENT &ex ) {
           if ( reportConnectionErrors(cid) ) {
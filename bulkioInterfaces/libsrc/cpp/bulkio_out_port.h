@@ -195,6 +195,21 @@ namespace bulkio {
     //
     virtual void pushSRI(const BULKIO::StreamSRI& H);
 
+    //
+    // queueSRI - records an SRI update for a stream without sending it; each connection receives the update
+    //            immediately before its next packet for the stream, so that several changes between packets
+    //            result in a single pushSRI call.  Unlike pushSRI, queueing the version that is already current
+    //            does not send the SRI again.
+    //
+    //            OutputStream writes hand their SRI updates to queueSRI; they do not call pushSRI.  Subclasses
+    //            that override pushSRI to observe or modify the SRI of streams must also override queueSRI.
+    //
+    // @param H - StreamSRI object that defines the new state of the stream
+    // @param version - version of H from bulkio::sri::nextVersion(); queueing the current version again is a
+    //                  no-op.  Callers that do not track versions pass 0.
+    //
+    virtual void queueSRI(const BULKIO::StreamSRI& H, unsigned long version=0);
+
 
     //
     // statisics - returns a PortStatistics object for this uses port
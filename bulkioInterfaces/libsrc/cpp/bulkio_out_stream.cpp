@@ -18,6 +18,10 @@
  * along with this program.  If not, see http://www.gnu.org/licenses/.
  */
 
+#include <stdexcept>
+
+#include <ossie/prop_helpers.h>
+
 #include "bulkio_out_stream.h"
 #include "bulkio_out_port.h"
 
@@ -48,7 +52,8 @@ public:
     _streamID(streamID),
     _port(port),
     _sri(bulkio::sri::create(streamID)),
-    _sriUpdated(true)
+    _sriVersion(bulkio::sri::nextVersion()),
+    _queuedVersion(0)
   {
   }
 
@@ -56,7 +61,8 @@ public:
     _streamID(sri.streamID),
     _port(port),
     _sri(sri),
-    _sriUpdated(true)
+    _sriVersion(bulkio::sri::nextVersion()),
+    _queuedVersion(0)
   {
   }
 
@@ -75,7 +81,8 @@ public:
     // Copy the new SRI, except for the stream ID, which is immutable
     _sri = sri;
     _sri.streamID = _streamID.c_str();
-    _sriUpdated = true;
+    _keywordIndex.invalidate();
+    _sriChanged();
   }
 
   void setXDelta(double delta)
@@ -96,19 +103,49 @@ public:
   void setKeywords(const _CORBA_Unbounded_Sequence<CF::DataType>& properties)
   {
     _sri.keywords = properties;
-    _sriUpdated = true;
+    _keywordIndex.invalidate();
+    _sriChanged();
+  }
+
+  const redhawk::PropertyType* findKeyword(const std::string& name) const
+  {
+    const redhawk::PropertyMap& keywords = redhawk::PropertyMap::cast(_sri.keywords);
+    size_t offset = _keywordIndex.find(_sri.keywords, name);
+    if (offset < keywords.size()) {
+      return &keywords[offset];
+    }
+    return 0;
   }
 
   void setKeyword(const std::string& name, const CORBA::Any& value)
   {
-    redhawk::PropertyMap::cast(_sri.keywords)[name] = value;
-    _sriUpdated = true;
+    redhawk::PropertyMap& keywords = redhawk::PropertyMap::cast(_sri.keywords);
+    size_t offset = _keywordIndex.find(_sri.keywords, name);
+    if (offset < keywords.size()) {
+      std::string action("eq");
+      if (ossie::compare_anys(keywords[offset].value, value, action)) {
+        return;
+      }
+      keywords[offset].value = value;
+    } else {
+      CF::DataType keyword;
+      keyword.id = name.c_str();
+      keyword.value = value;
+      keywords.push_back(keyword);
+    }
+    _sriChanged();
   }
 
   void eraseKeyword(const std::string& name)
   {
-    redhawk::PropertyMap::cast(_sri.keywords).erase(name);
-    _sriUpdated = true;
+    redhawk::PropertyMap& keywords = redhawk::PropertyMap::cast(_sri.keywords);
+    size_t offset = _keywordIndex.find(_sri.keywords, name);
+    if (offset >= keywords.size()) {
+      return;
+    }
+    keywords.erase(keywords.begin() + offset);
+    _keywordIndex.invalidate();
+    _sriChanged();
   }
 
   template <class Sample>
@@ -142,9 +179,11 @@ public:
 
   void write(const ScalarType* data, size_t count, const BULKIO::PrecisionUTCTime& time)
   {
-    if (_sriUpdated) {
-      _port->pushSRI(_sri);
-      _sriUpdated = false;
+    if (_sriVersion != _queuedVersion) {
+      // The port sends the SRI to each connection ahead of its next packet;
+      // queueSRI is virtual so that port subclasses can intercept it
+      _port->queueSRI(_sri, _sriVersion);
+      _queuedVersion = _sriVersion;
     }
     _send(reinterpret_cast<const TransportType*>(data), count, time, false);
   }
@@ -177,13 +216,25 @@ private:
       return;
     }
     field = value;
-    _sriUpdated = true;
+    _sriChanged();
+  }
+
+  void _sriChanged()
+  {
+    // Only actual changes get a new version, so that setting a value that
+    // is already current does not cause the SRI to be queued again
+    _sriVersion = bulkio::sri::nextVersion();
   }
 
   const std::string _streamID;
   OutPort<PortTraits>* _port;
   BULKIO::StreamSRI _sri;
-  bool _sriUpdated;
+  // Keyword lookups are made on every setKeyword; the index avoids scanning
+  // long keyword lists
+  redhawk::PropertyIndex _keywordIndex;
+  // Version of _sri, and the version last queued on the port
+  unsigned long _sriVersion;
+  unsigned long _queuedVersion;
 };
 
 template <class PortTraits>
@@ -267,13 +318,17 @@ void OutputStream<PortTraits>::keywords(const _CORBA_Unbounded_Sequence<CF::Data
 template <class PortTraits>
 bool OutputStream<PortTraits>::hasKeyword(const std::string& name) const
 {
-  return keywords().contains(name);
+  return _impl->findKeyword(name) != 0;
 }
 
 template <class PortTraits>
 const redhawk::Value& OutputStream<PortTraits>::getKeyword(const std::string& name) const
 {
-  return keywords()[name];
+  const redhawk::PropertyType* keyword = _impl->findKeyword(name);
+  if (!keyword) {
+    throw std::invalid_argument("id '"+name+"' not found");
+  }
+  return keyword->getValue();
 }
 
 template <class PortTraits>
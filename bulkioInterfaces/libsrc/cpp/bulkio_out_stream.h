@@ -87,8 +87,11 @@ namespace bulkio {
    * @par  SRI Changes
    * Updates to the stream that modify its SRI are cached locally until the
    * next write to minimize the number of updates that are published. When
-   * there are pending SRI changes, the %OutputStream pushes the updated SRI
-   * first, followed by the data.
+   * there are pending SRI changes, the %OutputStream queues the updated SRI
+   * on the port with OutPort::queueSRI(), and each connection receives it
+   * ahead of its next packet for the stream. Setting a value that is already
+   * current is not an SRI change. The stream does not call OutPort::pushSRI();
+   * port subclasses that intercept SRI must override queueSRI() as well.
    */
   template <class PortTraits>
   class OutputStream {
@@ -0,0 +1,1446 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK bulkioInterfaces.
+ *
+ * REDHAWK bulkioInterfaces is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK bulkioInterfaces is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <endian.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include "bulkio_packet_engine.h"
+#include "bulkio_base.h"
+#include "bulkio_time_operators.h"
+
+namespace {
+
+  //
+  // Big-endian field access; packet headers are not necessarily aligned for
+  // their field sizes, so the bytes are assembled individually
+  //
+  inline uint16_t load16(const unsigned char* ptr)
+  {
+    return (uint16_t(ptr[0]) << 8) | ptr[1];
+  }
+
+  inline uint32_t load32(const unsigned char* ptr)
+  {
+    return (uint32_t(load16(ptr)) << 16) | load16(ptr + 2);
+  }
+
+  inline uint64_t load64(const unsigned char* ptr)
+  {
+    return (uint64_t(load32(ptr)) << 32) | load32(ptr + 4);
+  }
+
+  inline void store16(unsigned char* ptr, uint16_t value)
+  {
+    ptr[0] = value >> 8;
+    ptr[1] = value;
+  }
+
+  inline void store32(unsigned char* ptr, uint32_t value)
+  {
+    store16(ptr, value >> 16);
+    store16(ptr + 2, value);
+  }
+
+  inline void store64(unsigned char* ptr, uint64_t value)
+  {
+    store32(ptr, value >> 32);
+    store32(ptr + 4, value);
+  }
+
+  struct in_addr parseAddress(const std::string& address)
+  {
+    struct in_addr result;
+    if (address.empty()) {
+      result.s_addr = htonl(INADDR_ANY);
+    } else if (inet_aton(address.c_str(), &result) == 0) {
+      throw bulkio::net::SocketError("invalid address '" + address + "'");
+    }
+    return result;
+  }
+
+  bool isMulticast(const struct in_addr& address)
+  {
+    return IN_MULTICAST(ntohl(address.s_addr));
+  }
+
+  // Time covered by a number of payload bytes
+  double elapsed(size_t bytes, size_t sampleSize, bool complex, double xdelta)
+  {
+    size_t samples = bytes / sampleSize;
+    if (complex) {
+      samples /= 2;
+    }
+    return samples * xdelta;
+  }
+}
+
+using namespace bulkio::net;
+
+SocketError::SocketError(const std::string& message, int error) :
+  std::runtime_error(error ? (message + ": " + strerror(error)) : message),
+  _error(error)
+{
+}
+
+int SocketError::error() const
+{
+  return _error;
+}
+
+//
+// PacketRing
+//
+class PacketRing::Impl {
+public:
+  Impl(size_t count, size_t packetSize) :
+    packetSize(packetSize),
+    // Keep every buffer 16-byte aligned relative to the first, so that
+    // payloads at the usual header offsets are aligned for the swap kernels
+    stride((packetSize + 15) & ~size_t(15)),
+    data(count * stride),
+    lengths(count, 0)
+  {
+#if defined(__linux__)
+    iovecs.resize(count);
+    headers.resize(count);
+    for (size_t index = 0; index < count; ++index) {
+      iovecs[index].iov_base = &data[index * stride];
+      iovecs[index].iov_len = packetSize;
+      memset(&headers[index], 0, sizeof(struct mmsghdr));
+      headers[index].msg_hdr.msg_iov = &iovecs[index];
+      headers[index].msg_hdr.msg_iovlen = 1;
+    }
+#endif
+  }
+
+  size_t packetSize;
+  size_t stride;
+  std::vector<unsigned char> data;
+  std::vector<size_t> lengths;
+#if defined(__linux__)
+  std::vector<struct iovec> iovecs;
+  std::vector<struct mmsghdr> headers;
+#endif
+};
+
+PacketRing::PacketRing(size_t count, size_t packetSize) :
+  _impl(new Impl(std::max(count, size_t(1)), packetSize))
+{
+}
+
+PacketRing::~PacketRing()
+{
+}
+
+size_t PacketRing::capacity() const
+{
+  return _impl->lengths.size();
+}
+
+size_t PacketRing::packetSize() const
+{
+  return _impl->packetSize;
+}
+
+unsigned char* PacketRing::buffer(size_t index)
+{
+  return &_impl->data[index * _impl->stride];
+}
+
+const unsigned char* PacketRing::buffer(size_t index) const
+{
+  return &_impl->data[index * _impl->stride];
+}
+
+size_t PacketRing::length(size_t index) const
+{
+  return _impl->lengths[index];
+}
+
+void PacketRing::setLength(size_t index, size_t length)
+{
+  _impl->lengths[index] = length;
+}
+
+//
+// UdpSocket
+//
+UdpSocket::UdpSocket() :
+  _fd(-1)
+{
+}
+
+UdpSocket::~UdpSocket()
+{
+  close();
+}
+
+void UdpSocket::bind(const std::string& address, unsigned short port, const std::string& iface)
+{
+  close();
+
+  struct in_addr group = parseAddress(address);
+  struct in_addr local = parseAddress(iface);
+
+  _fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+  if (_fd < 0) {
+    throw SocketError("cannot create socket", errno);
+  }
+
+  // Allow multiple receivers of the same multicast stream on this host
+  int reuse = 1;
+  setsockopt(_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+  // Binding to the group address, rather than any address, keeps the socket
+  // from receiving other groups that use the same port
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr = group;
+  if (::bind(_fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0) {
+    int error = errno;
+    close();
+    throw SocketError("cannot bind to " + address, error);
+  }
+
+  if (isMulticast(group)) {
+    struct ip_mreq mreq;
+    mreq.imr_multiaddr = group;
+    mreq.imr_interface = local;
+    if (setsockopt(_fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) {
+      int error = errno;
+      close();
+      throw SocketError("cannot join multicast group " + address, error);
+    }
+  }
+}
+
+void UdpSocket::connect(const std::string& address, unsigned short port, const std::string& iface,
+                        int ttl, bool loopback)
+{
+  close();
+
+  struct in_addr group = parseAddress(address);
+  struct in_addr local = parseAddress(iface);
+
+  _fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+  if (_fd < 0) {
+    throw SocketError("cannot create socket", errno);
+  }
+
+  if (isMulticast(group)) {
+    unsigned char value = ttl;
+    setsockopt(_fd, IPPROTO_IP, IP_MULTICAST_TTL, &value, sizeof(value));
+    value = loopback ? 1 : 0;
+    setsockopt(_fd, IPPROTO_IP, IP_MULTICAST_LOOP, &value, sizeof(value));
+    if (!iface.empty() && (setsockopt(_fd, IPPROTO_IP, IP_MULTICAST_IF, &local, sizeof(local)) < 0)) {
+      int error = errno;
+      close();
+      throw SocketError("cannot send multicast on interface " + iface, error);
+    }
+  }
+
+  // Connecting fixes the destination, so that the batched send does not
+  // need an address per packet
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr = group;
+  if (::connect(_fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0) {
+    int error = errno;
+    close();
+    throw SocketError("cannot connect to " + address, error);
+  }
+}
+
+void UdpSocket::setReceiveBufferSize(size_t bytes)
+{
+  if (_fd < 0) {
+    return;
+  }
+  int size = bytes;
+  setsockopt(_fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+}
+
+size_t UdpSocket::receive(PacketRing& ring, float timeout)
+{
+  if (_fd < 0) {
+    return 0;
+  }
+
+  struct pollfd fds;
+  fds.fd = _fd;
+  fds.events = POLLIN;
+  fds.revents = 0;
+  int msec = (timeout < 0.0) ? -1 : static_cast<int>(timeout * 1000);
+  if (::poll(&fds, 1, msec) <= 0) {
+    // Timeout or interrupted
+    return 0;
+  }
+
+#if defined(__linux__)
+  PacketRing::Impl& impl = *(ring._impl);
+  for (size_t index = 0; index < impl.iovecs.size(); ++index) {
+    impl.iovecs[index].iov_len = impl.packetSize;
+  }
+  int count = ::recvmmsg(_fd, &impl.headers[0], impl.headers.size(), MSG_DONTWAIT, 0);
+  if (count < 0) {
+    return 0;
+  }
+  for (int index = 0; index < count; ++index) {
+    impl.lengths[index] = impl.headers[index].msg_len;
+  }
+  return count;
+#else
+  size_t count = 0;
+  while (count < ring.capacity()) {
+    ssize_t bytes = ::recv(_fd, ring.buffer(count), ring.packetSize(), MSG_DONTWAIT);
+    if (bytes < 0) {
+      break;
+    }
+    ring.setLength(count, bytes);
+    ++count;
+  }
+  return count;
+#endif
+}
+
+size_t UdpSocket::send(PacketRing& ring, size_t count)
+{
+  if (_fd < 0) {
+    return 0;
+  }
+
+  size_t sent = 0;
+#if defined(__linux__)
+  PacketRing::Impl& impl = *(ring._impl);
+  for (size_t index = 0; index < count; ++index) {
+    impl.iovecs[index].iov_len = impl.lengths[index];
+  }
+  while (sent < count) {
+    int status = ::sendmmsg(_fd, &impl.headers[sent], count - sent, 0);
+    if (status < 0) {
+      // A refused connection is reported for an earlier packet (there was no
+      // receiver at the time), and is cleared by reporting it
+      if ((errno == EINTR) || (errno == ECONNREFUSED)) {
+        continue;
+      }
+      break;
+    }
+    sent += status;
+  }
+#else
+  while (sent < count) {
+    ssize_t status = ::send(_fd, ring.buffer(sent), ring.length(sent), 0);
+    if (status < 0) {
+      if ((errno == EINTR) || (errno == ECONNREFUSED)) {
+        continue;
+      }
+      break;
+    }
+    ++sent;
+  }
+#endif
+  return sent;
+}
+
+void UdpSocket::close()
+{
+  if (_fd >= 0) {
+    ::close(_fd);
+    _fd = -1;
+  }
+}
+
+bool UdpSocket::isOpen() const
+{
+  return (_fd >= 0);
+}
+
+size_t bulkio::net::sampleSize(SampleFormat format)
+{
+  switch (format) {
+  case FORMAT_INT8:
+    return 1;
+  case FORMAT_INT16:
+    return 2;
+  case FORMAT_INT32:
+  case FORMAT_FLOAT:
+    return 4;
+  case FORMAT_DOUBLE:
+    return 8;
+  default:
+    return 0;
+  }
+}
+
+void bulkio::net::copySwapped(void* dst, const void* src, size_t bytes, size_t sampleSize)
+{
+  if (dst != src) {
+    memcpy(dst, src, bytes);
+  }
+#if __BYTE_ORDER == __LITTLE_ENDIAN
+  switch (sampleSize) {
+  case 2:
+    bulkio::convert::byteswap16(dst, bytes / 2);
+    break;
+  case 4:
+    bulkio::convert::byteswap32(dst, bytes / 4);
+    break;
+  case 8:
+    bulkio::convert::byteswap64(dst, bytes / 8);
+    break;
+  default:
+    break;
+  }
+#endif
+}
+
+PacketStatistics::PacketStatistics() :
+  packets(0),
+  bytes(0),
+  batches(0),
+  dropped(0),
+  invalid(0)
+{
+}
+
+//
+// PacketReceiver
+//
+namespace {
+  // Receive threads wake up at this interval to check whether they have been
+  // stopped
+  const float RECEIVE_TIMEOUT = 0.125;
+
+  // Sockets ask for enough kernel buffering to ride out a scheduling delay at
+  // high packet rates
+  const size_t RECEIVE_BUFFER_SIZE = 8 * 1024 * 1024;
+}
+
+PacketReceiver::PacketReceiver(size_t packetSize, size_t batchSize) :
+  _ring(batchSize, packetSize),
+  _packets(_ring.capacity()),
+  _running(false)
+{
+}
+
+PacketReceiver::~PacketReceiver()
+{
+  stop();
+}
+
+void PacketReceiver::start(BlockCallback callback)
+{
+  if (_thread) {
+    return;
+  }
+  _running = true;
+  _thread.reset(new boost::thread(&PacketReceiver::_run, this, callback));
+}
+
+void PacketReceiver::stop()
+{
+  if (!_thread) {
+    return;
+  }
+  _running = false;
+  _thread->join();
+  _thread.reset();
+}
+
+bool PacketReceiver::isRunning() const
+{
+  return (_thread.get() != 0);
+}
+
+size_t PacketReceiver::poll(const BlockCallback& callback, float timeout)
+{
+  size_t count = _socket.receive(_ring, timeout);
+  if (count == 0) {
+    return 0;
+  }
+
+  size_t bytes = 0;
+  size_t dropped = 0;
+  size_t invalid_count = 0;
+  size_t decoded = 0;
+  for (size_t index = 0; index < count; ++index) {
+    bytes += _ring.length(index);
+    Packet& packet = _packets[decoded];
+    bool invalid = false;
+    if (decode(_ring.buffer(index), _ring.length(index), packet, invalid)) {
+      dropped += packet.lost;
+      ++decoded;
+    } else if (invalid) {
+      ++invalid_count;
+    }
+  }
+
+  {
+    boost::mutex::scoped_lock lock(_statsMutex);
+    _stats.packets += count;
+    _stats.bytes += bytes;
+    _stats.batches++;
+    _stats.dropped += dropped;
+    _stats.invalid += invalid_count;
+  }
+
+  // Deliver each run of packets that continue one another as a single block
+  size_t first = 0;
+  for (size_t index = 1; index <= decoded; ++index) {
+    if (index < decoded) {
+      const Packet& prev = _packets[index - 1];
+      const Packet& next = _packets[index];
+      if ((next.lost == 0) && (next.format == prev.format) && (next.complex == prev.complex) &&
+          (next.xdelta == prev.xdelta)) {
+        continue;
+      }
+    }
+    _deliver(callback, _packets, first, index);
+    first = index;
+  }
+  return count;
+}
+
+PacketStatistics PacketReceiver::statistics() const
+{
+  boost::mutex::scoped_lock lock(_statsMutex);
+  return _stats;
+}
+
+UdpSocket& PacketReceiver::socket()
+{
+  return _socket;
+}
+
+void PacketReceiver::_run(BlockCallback callback)
+{
+  while (_running) {
+    poll(callback, RECEIVE_TIMEOUT);
+  }
+}
+
+void PacketReceiver::_deliver(const BlockCallback& callback, std::vector<Packet>& packets, size_t first, size_t last)
+{
+  const Packet& head = packets[first];
+  const size_t sample_size = sampleSize(head.format);
+
+  PacketBlock block;
+  block.format = head.format;
+  block.complex = head.complex;
+  block.xdelta = head.xdelta;
+  block.time = head.time;
+  block.discontinuity = (head.lost > 0);
+
+  if ((last - first) == 1) {
+    // Swap a lone packet in place, avoiding a copy
+    copySwapped(head.payload, head.payload, head.bytes, sample_size);
+    block.data = head.payload;
+    block.samples = head.bytes / sample_size;
+  } else {
+    size_t total = 0;
+    for (size_t index = first; index < last; ++index) {
+      total += packets[index].bytes;
+    }
+    _staging.resize(total);
+    unsigned char* dest = &_staging[0];
+    for (size_t index = first; index < last; ++index) {
+      memcpy(dest, packets[index].payload, packets[index].bytes);
+      dest += packets[index].bytes;
+    }
+    copySwapped(&_staging[0], &_staging[0], total, sample_size);
+    block.data = &_staging[0];
+    block.samples = total / sample_size;
+  }
+
+  callback(block);
+}
+
+//
+// PacketSender
+//
+PacketSender::PacketSender(SampleFormat format, size_t packetSize, size_t batchSize, size_t granularity) :
+  _format(format),
+  _ring(batchSize, packetSize),
+  _queued(0),
+  _granularity(std::max(granularity, size_t(1))),
+  _pendingTime(bulkio::time::utils::notSet()),
+  _pendingComplex(false),
+  _pendingXdelta(0.0)
+{
+}
+
+PacketSender::~PacketSender()
+{
+  // Sending the queued packets does not involve the subclass; any partial
+  // packet is discarded
+  flush();
+}
+
+void PacketSender::flush()
+{
+  if (_queued == 0) {
+    return;
+  }
+
+  size_t sent = _socket.send(_ring, _queued);
+  size_t bytes = 0;
+  for (size_t index = 0; index < sent; ++index) {
+    bytes += _ring.length(index);
+  }
+
+  boost::mutex::scoped_lock lock(_statsMutex);
+  _stats.packets += sent;
+  _stats.bytes += bytes;
+  _stats.batches++;
+  _stats.invalid += (_queued - sent);
+  _queued = 0;
+}
+
+void PacketSender::finish()
+{
+  if (!_pending.empty()) {
+    _pending.resize(_granularity, 0);
+    packetize(&_pending[0], _pending.size(), _pendingComplex, _pendingTime, _pendingXdelta);
+    _pending.clear();
+  }
+  flush();
+}
+
+SampleFormat PacketSender::format() const
+{
+  return _format;
+}
+
+PacketStatistics PacketSender::statistics() const
+{
+  boost::mutex::scoped_lock lock(_statsMutex);
+  return _stats;
+}
+
+UdpSocket& PacketSender::socket()
+{
+  return _socket;
+}
+
+unsigned char* PacketSender::nextPacket()
+{
+  if (_queued == _ring.capacity()) {
+    flush();
+  }
+  return _ring.buffer(_queued);
+}
+
+void PacketSender::commitPacket(size_t length)
+{
+  _ring.setLength(_queued, length);
+  ++_queued;
+}
+
+void PacketSender::_write(const unsigned char* data, size_t count, bool complex,
+                          const BULKIO::PrecisionUTCTime& time, double xdelta)
+{
+  const size_t sample_size = sampleSize(_format);
+  size_t bytes = count * sample_size;
+  BULKIO::PrecisionUTCTime start = time;
+
+  if (!_pending.empty()) {
+    // Complete the data held back from the last write
+    size_t used = std::min(_granularity - _pending.size(), bytes);
+    _pending.insert(_pending.end(), data, data + used);
+    data += used;
+    bytes -= used;
+    if (_pending.size() < _granularity) {
+      return;
+    }
+    packetize(&_pending[0], _pending.size(), complex, _pendingTime, xdelta);
+    _pending.clear();
+    start = time + elapsed(used, sample_size, complex, xdelta);
+  }
+
+  size_t whole = bytes - (bytes % _granularity);
+  if (whole > 0) {
+    packetize(data, whole, complex, start, xdelta);
+  }
+  if (whole < bytes) {
+    _pending.assign(data + whole, data + bytes);
+    _pendingTime = start + elapsed(whole, sample_size, complex, xdelta);
+    _pendingComplex = complex;
+    _pendingXdelta = xdelta;
+  }
+}
+
+//
+// SDDS
+//
+namespace {
+  namespace sdds_impl {
+    // Ticks per second of the 250ps time tag
+    const uint64_t TICKS_PER_SECOND = 4000000000ULL;
+
+    // Scale of the 64-bit frequency field: 2^63 / 125 MHz
+    const double FREQUENCY_SCALE = 73786976294.838211;
+
+    // Number of data packets in the sequence number space, excluding parity
+    const int SEQUENCE_MODULUS = 65536 - 65536 / 32;
+
+    const size_t SECONDS_PER_YEAR = 365 * 86400;
+
+    int sequenceIndex(uint16_t sequence)
+    {
+      return sequence - (sequence + 1) / 32;
+    }
+
+    double yearStart(int year)
+    {
+      long days = 365L * (year - 1970) + (year - 1969) / 4 - (year - 1901) / 100 + (year - 1601) / 400;
+      return days * 86400.0;
+    }
+
+    int yearOf(double seconds)
+    {
+      time_t value = static_cast<time_t>(seconds);
+      struct tm result;
+      gmtime_r(&value, &result);
+      return result.tm_year + 1900;
+    }
+  }
+}
+
+bulkio::sdds::Header::Header() :
+  standardFormat(true),
+  startOfSequence(false),
+  complex(false),
+  bitsPerSample(0),
+  sequence(0),
+  timeTagValid(false),
+  clockValid(false),
+  timeTag(0),
+  timeTagExtension(0),
+  frequency(0.0)
+{
+}
+
+bool bulkio::sdds::parseHeader(const unsigned char* packet, size_t length, Header& header)
+{
+  if (length < HEADER_SIZE) {
+    return false;
+  }
+  header.standardFormat = (packet[0] & 0x80);
+  if (!header.standardFormat) {
+    return false;
+  }
+  header.startOfSequence = (packet[0] & 0x40);
+  header.complex = (packet[1] & 0x80);
+  header.bitsPerSample = (packet[1] & 0x1F);
+  header.sequence = load16(packet + 2);
+  uint16_t info = load16(packet + 4);
+  header.timeTagValid = (info & 0x4000);
+  header.clockValid = (info & 0x2000);
+  header.timeTag = load64(packet + 8);
+  header.timeTagExtension = load32(packet + 16);
+  header.frequency = load64(packet + 24) / sdds_impl::FREQUENCY_SCALE;
+  return true;
+}
+
+void bulkio::sdds::formatHeader(const Header& header, unsigned char* packet)
+{
+  memset(packet, 0, HEADER_SIZE);
+  packet[0] = (header.standardFormat ? 0x80 : 0) | (header.startOfSequence ? 0x40 : 0);
+  packet[1] = (header.complex ? 0x80 : 0) | (header.bitsPerSample & 0x1F);
+  store16(packet + 2, header.sequence);
+  store16(packet + 4, (header.timeTagValid ? 0x4000 : 0) | (header.clockValid ? 0x2000 : 0));
+  store64(packet + 8, header.timeTag);
+  store32(packet + 16, header.timeTagExtension);
+  store64(packet + 24, static_cast<uint64_t>(header.frequency * sdds_impl::FREQUENCY_SCALE + 0.5));
+}
+
+uint16_t bulkio::sdds::nextSequence(uint16_t sequence)
+{
+  ++sequence;
+  if ((sequence % 32) == 31) {
+    ++sequence;
+  }
+  return sequence;
+}
+
+size_t bulkio::sdds::sequenceGap(uint16_t expected, uint16_t received)
+{
+  int gap = sdds_impl::sequenceIndex(received) - sdds_impl::sequenceIndex(expected);
+  if (gap < 0) {
+    gap += sdds_impl::SEQUENCE_MODULUS;
+  }
+  return gap;
+}
+
+BULKIO::PrecisionUTCTime bulkio::sdds::toUTC(uint64_t timeTag, uint32_t extension, double reference)
+{
+  uint64_t whole = timeTag / sdds_impl::TICKS_PER_SECOND;
+  double fractional = ((timeTag % sdds_impl::TICKS_PER_SECOND) + extension / 4294967296.0) / sdds_impl::TICKS_PER_SECOND;
+
+  // The time tag does not carry the year; assume it is the year of the
+  // reference time, unless that puts it well into the future, as happens
+  // around the new year
+  int year = sdds_impl::yearOf(reference);
+  double seconds = sdds_impl::yearStart(year) + whole;
+  if (seconds > (reference + sdds_impl::SECONDS_PER_YEAR / 2)) {
+    seconds = sdds_impl::yearStart(year - 1) + whole;
+  }
+  return bulkio::time::utils::create(seconds, fractional, BULKIO::TCM_SDDS);
+}
+
+void bulkio::sdds::fromUTC(const BULKIO::PrecisionUTCTime& time, uint64_t& timeTag, uint32_t& extension)
+{
+  double whole = time.twsec - sdds_impl::yearStart(sdds_impl::yearOf(time.twsec));
+  double ticks = time.tfsec * sdds_impl::TICKS_PER_SECOND;
+  double integral = std::floor(ticks);
+  timeTag = static_cast<uint64_t>(whole) * sdds_impl::TICKS_PER_SECOND + static_cast<uint64_t>(integral);
+  extension = static_cast<uint32_t>((ticks - integral) * 4294967296.0);
+}
+
+bulkio::sdds::Receiver::Receiver(const BULKIO::SDDSStreamDefinition& stream, const std::string& iface,
+                                 size_t batchSize) :
+  net::PacketReceiver(PACKET_SIZE, batchSize),
+  _started(false),
+  _expected(0)
+{
+  _socket.bind(std::string(stream.multicastAddress), stream.port, iface);
+  _socket.setReceiveBufferSize(RECEIVE_BUFFER_SIZE);
+}
+
+bulkio::sdds::Receiver::~Receiver()
+{
+  stop();
+}
+
+bool bulkio::sdds::Receiver::decode(unsigned char* buffer, size_t length, Packet& packet, bool& invalid)
+{
+  Header header;
+  if (!parseHeader(buffer, length, header)) {
+    invalid = true;
+    return false;
+  }
+
+  // Parity packets are not used
+  if ((header.sequence % 32) == 31) {
+    return false;
+  }
+
+  if (header.bitsPerSample == 8) {
+    packet.format = net::FORMAT_INT8;
+  } else if (header.bitsPerSample == 16) {
+    packet.format = net::FORMAT_INT16;
+  } else {
+    invalid = true;
+    return false;
+  }
+
+  if (_started) {
+    packet.lost = sequenceGap(_expected, header.sequence);
+    if (packet.lost >= size_t(sdds_impl::SEQUENCE_MODULUS / 2)) {
+      // Far enough behind to be a duplicate or reordered packet; it cannot
+      // be delivered in order, so drop it
+      return false;
+    }
+  } else {
+    packet.lost = 0;
+    _started = true;
+  }
+  _expected = nextSequence(header.sequence);
+
+  size_t sample_size = net::sampleSize(packet.format);
+  size_t bytes = std::min(length - HEADER_SIZE, PAYLOAD_SIZE);
+  packet.payload = buffer + HEADER_SIZE;
+  packet.bytes = bytes - (bytes % sample_size);
+  packet.complex = header.complex;
+  if (header.frequency > 0.0) {
+    packet.xdelta = (header.complex ? 2.0 : 1.0) / header.frequency;
+  } else {
+    packet.xdelta = 0.0;
+  }
+  if (header.timeTagValid) {
+    packet.time = toUTC(header.timeTag, header.timeTagExtension, ::time(0));
+  } else {
+    packet.time = bulkio::time::utils::notSet();
+  }
+  return true;
+}
+
+namespace {
+  bulkio::net::SampleFormat sddsFormat(BULKIO::SDDSDataDigraph format)
+  {
+    switch (format) {
+    case BULKIO::SDDS_SB:
+    case BULKIO::SDDS_CB:
+      return bulkio::net::FORMAT_INT8;
+    case BULKIO::SDDS_SI:
+    case BULKIO::SDDS_CI:
+      return bulkio::net::FORMAT_INT16;
+    default:
+      throw std::invalid_argument("unsupported SDDS data format");
+    }
+  }
+}
+
+bulkio::sdds::Sender::Sender(const BULKIO::SDDSStreamDefinition& stream, const std::string& iface,
+                             int ttl, bool loopback, size_t batchSize) :
+  net::PacketSender(sddsFormat(stream.dataFormat), PACKET_SIZE, batchSize, PAYLOAD_SIZE),
+  _sequence(0),
+  _first(true)
+{
+  _socket.connect(std::string(stream.multicastAddress), stream.port, iface, ttl, loopback);
+}
+
+void bulkio::sdds::Sender::packetize(const unsigned char* data, size_t bytes, bool complex,
+                                     const BULKIO::PrecisionUTCTime& time, double xdelta)
+{
+  const size_t sample_size = net::sampleSize(_format);
+
+  Header header;
+  header.complex = complex;
+  header.bitsPerSample = sample_size * 8;
+  header.timeTagValid = (time.tcstatus == BULKIO::TCS_VALID);
+  header.clockValid = (xdelta > 0.0);
+  if (header.clockValid) {
+    header.frequency = (complex ? 2.0 : 1.0) / xdelta;
+  }
+
+  for (size_t offset = 0; offset < bytes; offset += PAYLOAD_SIZE) {
+    unsigned char* packet = nextPacket();
+    header.startOfSequence = _first;
+    header.sequence = _sequence;
+    if (header.timeTagValid) {
+      fromUTC(time + elapsed(offset, sample_size, complex, xdelta), header.timeTag, header.timeTagExtension);
+    }
+    formatHeader(header, packet);
+    net::copySwapped(packet + HEADER_SIZE, data + offset, PAYLOAD_SIZE, sample_size);
+    commitPacket(PACKET_SIZE);
+
+    _sequence = nextSequence(_sequence);
+    _first = false;
+  }
+}
+
+//
+// VRT
+//
+namespace {
+  namespace vrt_impl {
+    // Number of 32-bit words in each context field, indexed by its bit in
+    // the context indicator field (CIF0), for the fields that precede the
+    // data payload format
+    const int FIELD_WORDS[32] = {
+      0, 0, 0, 0, 0, 0, 0, 0,
+      0, 0, 0, 0, 0, 0, 0, 2,  // 15: data payload format
+      1, 2, 1, 1, 2, 2, 1, 1,  // 21: sample rate
+      1, 2, 2, 2, 2, 2, 1, 0
+    };
+    const uint32_t CIF_SAMPLE_RATE = 1U << 21;
+    const uint32_t CIF_PAYLOAD_FORMAT = 1U << 15;
+
+    // Sample rate is a 64-bit fixed point number with 20 fractional bits
+    const double SAMPLE_RATE_SCALE = 1048576.0;
+
+    const double PICOSECONDS = 1e12;
+
+    // Data packets between periodic context packets, so that a receiver
+    // that joins late does not wait long for the format
+    const int CONTEXT_INTERVAL = 128;
+
+    // Largest header the sender writes: header word, stream ID, integer and
+    // fractional timestamps
+    const size_t MAX_HEADER_SIZE = 20;
+
+    // Size of the sender's context packets: header word, stream ID, CIF0,
+    // sample rate and payload format
+    const size_t CONTEXT_SIZE = 28;
+
+    bool hasStreamID(bulkio::vrt::PacketType type)
+    {
+      return (type != bulkio::vrt::IF_DATA) && (type != bulkio::vrt::EXT_DATA);
+    }
+
+    bool isData(bulkio::vrt::PacketType type)
+    {
+      return (type < bulkio::vrt::IF_CONTEXT);
+    }
+
+    uint32_t hashStreamID(const std::string& id)
+    {
+      // FNV-1a
+      uint32_t hash = 2166136261U;
+      for (std::string::const_iterator ch = id.begin(); ch != id.end(); ++ch) {
+        hash ^= static_cast<unsigned char>(*ch);
+        hash *= 16777619U;
+      }
+      return hash;
+    }
+
+    size_t payloadGranularity(bulkio::net::SampleFormat format)
+    {
+      // Payloads are whole words, and must hold whole complex samples
+      return std::max(size_t(4), 2 * bulkio::net::sampleSize(format));
+    }
+  }
+}
+
+bulkio::vrt::Header::Header() :
+  packetType(IF_DATA_STREAM_ID),
+  hasClassID(false),
+  hasTrailer(false),
+  tsi(TSI_NONE),
+  tsf(TSF_NONE),
+  packetCount(0),
+  packetWords(0),
+  streamID(0),
+  classID(0),
+  integerSeconds(0),
+  fractionalSeconds(0),
+  payloadOffset(0),
+  payloadBytes(0)
+{
+}
+
+bool bulkio::vrt::parseHeader(const unsigned char* packet, size_t length, Header& header)
+{
+  if (length < 4) {
+    return false;
+  }
+  uint32_t word = load32(packet);
+  int type = word >> 28;
+  if (type > EXT_CONTEXT) {
+    return false;
+  }
+  header.packetType = static_cast<PacketType>(type);
+  header.hasClassID = (word & (1U << 27));
+  header.hasTrailer = vrt_impl::isData(header.packetType) && (word & (1U << 26));
+  header.tsi = static_cast<IntegerTimestamp>((word >> 22) & 0x3);
+  header.tsf = static_cast<FractionalTimestamp>((word >> 20) & 0x3);
+  header.packetCount = (word >> 16) & 0xF;
+  header.packetWords = word & 0xFFFF;
+
+  const size_t packet_bytes = header.packetWords * 4;
+  if ((packet_bytes == 0) || (packet_bytes > length)) {
+    return false;
+  }
+
+  size_t offset = 4;
+  const size_t end = packet_bytes - (header.hasTrailer ? 4 : 0);
+  if (vrt_impl::hasStreamID(header.packetType)) {
+    if ((offset + 4) > end) {
+      return false;
+    }
+    header.streamID = load32(packet + offset);
+    offset += 4;
+  } else {
+    header.streamID = 0;
+  }
+  if (header.hasClassID) {
+    if ((offset + 8) > end) {
+      return false;
+    }
+    header.classID = load64(packet + offset);
+    offset += 8;
+  }
+  if (header.tsi != TSI_NONE) {
+    if ((offset + 4) > end) {
+      return false;
+    }
+    header.integerSeconds = load32(packet + offset);
+    offset += 4;
+  }
+  if (header.tsf != TSF_NONE) {
+    if ((offset + 8) > end) {
+      return false;
+    }
+    header.fractionalSeconds = load64(packet + offset);
+    offset += 8;
+  }
+  header.payloadOffset = offset;
+  header.payloadBytes = end - offset;
+  return true;
+}
+
+size_t bulkio::vrt::formatHeader(const Header& header, unsigned char* packet)
+{
+  size_t offset = 4;
+  if (vrt_impl::hasStreamID(header.packetType)) {
+    store32(packet + offset, header.streamID);
+    offset += 4;
+  }
+  if (header.hasClassID) {
+    store64(packet + offset, header.classID);
+    offset += 8;
+  }
+  if (header.tsi != TSI_NONE) {
+    store32(packet + offset, header.integerSeconds);
+    offset += 4;
+  }
+  if (header.tsf != TSF_NONE) {
+    store64(packet + offset, header.fractionalSeconds);
+    offset += 8;
+  }
+
+  bool trailer = header.hasTrailer && vrt_impl::isData(header.packetType);
+  size_t words = (offset + header.payloadBytes + (trailer ? 4 : 0) + 3) / 4;
+  uint32_t word = (uint32_t(header.packetType) << 28) | (words & 0xFFFF);
+  word |= (header.hasClassID ? (1U << 27) : 0);
+  word |= (trailer ? (1U << 26) : 0);
+  word |= (uint32_t(header.tsi) & 0x3) << 22;
+  word |= (uint32_t(header.tsf) & 0x3) << 20;
+  word |= (uint32_t(header.packetCount) & 0xF) << 16;
+  store32(packet, word);
+  return offset;
+}
+
+bulkio::vrt::Context::Context() :
+  hasSampleRate(false),
+  sampleRate(0.0),
+  hasFormat(false),
+  format(net::FORMAT_INVALID),
+  complex(false)
+{
+}
+
+namespace {
+  bulkio::net::SampleFormat decodePayloadFormat(uint32_t word, bool& complex)
+  {
+    bool link_efficient = (word & (1U << 31));
+    int complexity = (word >> 29) & 0x3;
+    int item_format = (word >> 24) & 0x1F;
+    int packing_size = ((word >> 6) & 0x3F) + 1;
+    int item_size = (word & 0x3F) + 1;
+
+    complex = (complexity == 1);
+    if (link_efficient || (complexity > 1) || (packing_size != item_size)) {
+      return bulkio::net::FORMAT_INVALID;
+    }
+    if (item_format == 0x00) {
+      switch (item_size) {
+      case 8:
+        return bulkio::net::FORMAT_INT8;
+      case 16:
+        return bulkio::net::FORMAT_INT16;
+      case 32:
+        return bulkio::net::FORMAT_INT32;
+      default:
+        break;
+      }
+    } else if ((item_format == 0x0E) && (item_size == 32)) {
+      return bulkio::net::FORMAT_FLOAT;
+    } else if ((item_format == 0x0F) && (item_size == 64)) {
+      return bulkio::net::FORMAT_DOUBLE;
+    }
+    return bulkio::net::FORMAT_INVALID;
+  }
+
+  uint32_t encodePayloadFormat(bulkio::net::SampleFormat format, bool complex)
+  {
+    uint32_t item_format = 0x00;
+    if (format == bulkio::net::FORMAT_FLOAT) {
+      item_format = 0x0E;
+    } else if (format == bulkio::net::FORMAT_DOUBLE) {
+      item_format = 0x0F;
+    }
+    uint32_t bits = bulkio::net::sampleSize(format) * 8 - 1;
+    return ((complex ? 1U : 0U) << 29) | (item_format << 24) | (bits << 6) | bits;
+  }
+}
+
+bool bulkio::vrt::parseContext(const unsigned char* packet, const Header& header, Context& context)
+{
+  if ((header.packetType != IF_CONTEXT) || (header.payloadBytes < 4)) {
+    return false;
+  }
+  const unsigned char* field = packet + header.payloadOffset;
+  const unsigned char* end = field + header.payloadBytes;
+  uint32_t indicators = load32(field);
+  field += 4;
+
+  context = Context();
+  for (int bit = 30; bit >= 15; --bit) {
+    uint32_t mask = 1U << bit;
+    if (!(indicators & mask)) {
+      continue;
+    }
+    size_t bytes = vrt_impl::FIELD_WORDS[bit] * 4;
+    if ((field + bytes) > end) {
+      return false;
+    }
+    if (mask == vrt_impl::CIF_SAMPLE_RATE) {
+      context.hasSampleRate = true;
+      context.sampleRate = static_cast<int64_t>(load64(field)) / vrt_impl::SAMPLE_RATE_SCALE;
+    } else if (mask == vrt_impl::CIF_PAYLOAD_FORMAT) {
+      context.format = decodePayloadFormat(load32(field), context.complex);
+      context.hasFormat = (context.format != net::FORMAT_INVALID);
+    }
+    field += bytes;
+  }
+  return true;
+}
+
+size_t bulkio::vrt::formatContext(Header header, const Context& context, unsigned char* packet)
+{
+  header.packetType = IF_CONTEXT;
+  header.hasTrailer = false;
+  header.payloadBytes = 4 + (context.hasSampleRate ? 8 : 0) + (context.hasFormat ? 8 : 0);
+  size_t offset = formatHeader(header, packet);
+
+  unsigned char* field = packet + offset;
+  uint32_t indicators = (context.hasSampleRate ? vrt_impl::CIF_SAMPLE_RATE : 0);
+  indicators |= (context.hasFormat ? vrt_impl::CIF_PAYLOAD_FORMAT : 0);
+  store32(field, indicators);
+  field += 4;
+  if (context.hasSampleRate) {
+    store64(field, static_cast<int64_t>(context.sampleRate * vrt_impl::SAMPLE_RATE_SCALE + 0.5));
+    field += 8;
+  }
+  if (context.hasFormat) {
+    store32(field, encodePayloadFormat(context.format, context.complex));
+    // Repeat count and vector size (both one less than the actual value)
+    store32(field + 4, 0);
+    field += 8;
+  }
+  return offset + header.payloadBytes;
+}
+
+bulkio::net::SampleFormat bulkio::vrt::sampleFormat(const BULKIO::VITA49DataPacketPayloadFormat& format)
+{
+  if (!format.packing_method_processing_efficient) {
+    return net::FORMAT_INVALID;
+  }
+  if ((format.complexity != BULKIO::VITA49_REAL) && (format.complexity != BULKIO::VITA49_COMPLEX_CARTESIAN)) {
+    return net::FORMAT_INVALID;
+  }
+  switch (format.data_item_format) {
+  case BULKIO::VITA49_8T:
+    return net::FORMAT_INT8;
+  case BULKIO::VITA49_16T:
+    return net::FORMAT_INT16;
+  case BULKIO::VITA49_32T:
+    return net::FORMAT_INT32;
+  case BULKIO::VITA49_32F:
+    return net::FORMAT_FLOAT;
+  case BULKIO::VITA49_64F:
+    return net::FORMAT_DOUBLE;
+  default:
+    return net::FORMAT_INVALID;
+  }
+}
+
+bulkio::vrt::Receiver::Receiver(const BULKIO::VITA49StreamDefinition& stream, const std::string& iface,
+                                size_t batchSize) :
+  net::PacketReceiver(MAX_PACKET_SIZE, batchSize),
+  _format(net::FORMAT_INVALID),
+  _complex(false),
+  _xdelta(0.0),
+  _started(false),
+  _expected(0)
+{
+  if (stream.protocol != BULKIO::VITA49_UDP_TRANSPORT) {
+    throw std::invalid_argument("unsupported VITA-49 transport protocol");
+  }
+  if (stream.valid_data_format) {
+    _format = sampleFormat(stream.data_format);
+    _complex = (stream.data_format.complexity == BULKIO::VITA49_COMPLEX_CARTESIAN);
+  }
+  _socket.bind(std::string(stream.ip_address), stream.port, iface);
+  _socket.setReceiveBufferSize(RECEIVE_BUFFER_SIZE);
+}
+
+bulkio::vrt::Receiver::~Receiver()
+{
+  stop();
+}
+
+bool bulkio::vrt::Receiver::decode(unsigned char* buffer, size_t length, Packet& packet, bool& invalid)
+{
+  Header header;
+  if (!parseHeader(buffer, length, header)) {
+    invalid = true;
+    return false;
+  }
+
+  if (header.packetType == IF_CONTEXT) {
+    Context context;
+    if (!parseContext(buffer, header, context)) {
+      invalid = true;
+      return false;
+    }
+    if (context.hasSampleRate && (context.sampleRate > 0.0)) {
+      _xdelta = 1.0 / context.sampleRate;
+    }
+    if (context.hasFormat) {
+      _format = context.format;
+      _complex = context.complex;
+    }
+    return false;
+  }
+
+  // Extension packets are vendor-specific, and data cannot be interpreted
+  // until the format is known from the stream definition or a context packet
+  if ((header.packetType != IF_DATA) && (header.packetType != IF_DATA_STREAM_ID)) {
+    return false;
+  }
+  if (_format == net::FORMAT_INVALID) {
+    return false;
+  }
+
+  if (_started) {
+    packet.lost = (header.packetCount - _expected) & 0xF;
+  } else {
+    packet.lost = 0;
+    _started = true;
+  }
+  _expected = (header.packetCount + 1) & 0xF;
+
+  size_t sample_size = net::sampleSize(_format);
+  packet.payload = buffer + header.payloadOffset;
+  packet.bytes = header.payloadBytes - (header.payloadBytes % sample_size);
+  packet.format = _format;
+  packet.complex = _complex;
+  packet.xdelta = _xdelta;
+  if (header.tsi == TSI_UTC) {
+    double fractional = 0.0;
+    if (header.tsf == TSF_REAL_TIME) {
+      fractional = header.fractionalSeconds / vrt_impl::PICOSECONDS;
+    }
+    packet.time = bulkio::time::utils::create(header.integerSeconds, fractional, BULKIO::TCM_CPU);
+  } else {
+    packet.time = bulkio::time::utils::notSet();
+  }
+  return true;
+}
+
+namespace {
+  bulkio::net::SampleFormat vrtFormat(const BULKIO::VITA49StreamDefinition& stream)
+  {
+    if (stream.protocol != BULKIO::VITA49_UDP_TRANSPORT) {
+      throw std::invalid_argument("unsupported VITA-49 transport protocol");
+    }
+    bulkio::net::SampleFormat format = bulkio::vrt::sampleFormat(stream.data_format);
+    if (format == bulkio::net::FORMAT_INVALID) {
+      throw std::invalid_argument("unsupported VITA-49 data format");
+    }
+    return format;
+  }
+}
+
+bulkio::vrt::Sender::Sender(const BULKIO::VITA49StreamDefinition& stream, const std::string& iface,
+                            int ttl, bool loopback, size_t batchSize, size_t payloadBytes) :
+  net::PacketSender(vrtFormat(stream), std::max(vrt_impl::MAX_HEADER_SIZE + payloadBytes, vrt_impl::CONTEXT_SIZE), batchSize,
+                    vrt_impl::payloadGranularity(vrtFormat(stream))),
+  _streamID(vrt_impl::hashStreamID(std::string(stream.id))),
+  _payloadBytes(payloadBytes),
+  _packetCount(0),
+  _contextPacketCount(0),
+  _contextCount(0),
+  _xdelta(0.0),
+  _complex(false),
+  _first(true)
+{
+  size_t granularity = vrt_impl::payloadGranularity(_format);
+  _payloadBytes -= (_payloadBytes % granularity);
+  if (_payloadBytes == 0) {
+    throw std::invalid_argument("VITA-49 payload size is too small for the data format");
+  }
+  _socket.connect(std::string(stream.ip_address), stream.port, iface, ttl, loopback);
+}
+
+void bulkio::vrt::Sender::packetize(const unsigned char* data, size_t bytes, bool complex,
+                                    const BULKIO::PrecisionUTCTime& time, double xdelta)
+{
+  const size_t sample_size = net::sampleSize(_format);
+  const bool time_valid = (time.tcstatus == BULKIO::TCS_VALID);
+
+  Header header;
+  header.packetType = IF_DATA_STREAM_ID;
+  header.streamID = _streamID;
+  if (time_valid) {
+    header.tsi = TSI_UTC;
+    header.tsf = TSF_REAL_TIME;
+  }
+
+  for (size_t offset = 0; offset < bytes; offset += _payloadBytes) {
+    if (_first || (xdelta != _xdelta) || (complex != _complex) || (_contextCount >= vrt_impl::CONTEXT_INTERVAL)) {
+      _sendContext(xdelta, complex);
+    }
+
+    size_t payload = std::min(_payloadBytes, bytes - offset);
+    unsigned char* packet = nextPacket();
+    header.packetCount = _packetCount;
+    header.payloadBytes = payload;
+    if (time_valid) {
+      BULKIO::PrecisionUTCTime packet_time = time + elapsed(offset, sample_size, complex, xdelta);
+      header.integerSeconds = static_cast<uint32_t>(packet_time.twsec);
+      uint64_t picoseconds = static_cast<uint64_t>(packet_time.tfsec * vrt_impl::PICOSECONDS + 0.5);
+      if (picoseconds >= 1000000000000ULL) {
+        header.integerSeconds++;
+        picoseconds -= 1000000000000ULL;
+      }
+      header.fractionalSeconds = picoseconds;
+    }
+    size_t header_size = formatHeader(header, packet);
+    net::copySwapped(packet + header_size, data + offset, payload, sample_size);
+    commitPacket(header_size + payload);
+
+    _packetCount = (_packetCount + 1) & 0xF;
+    ++_contextCount;
+  }
+}
+
+void bulkio::vrt::Sender::_sendContext(double xdelta, bool complex)
+{
+  Context context;
+  context.hasSampleRate = (xdelta > 0.0);
+  if (context.hasSampleRate) {
+    context.sampleRate = 1.0 / xdelta;
+  }
+  context.hasFormat = true;
+  context.format = _format;
+  context.complex = complex;
+
+  Header header;
+  header.streamID = _streamID;
+  header.packetCount = _contextPacketCount;
+  unsigned char* packet = nextPacket();
+  commitPacket(formatContext(header, context, packet));
+
+  _contextPacketCount = (_contextPacketCount + 1) & 0xF;
+  _contextCount = 0;
+  _xdelta = xdelta;
+  _complex = complex;
+  _first = false;
+}
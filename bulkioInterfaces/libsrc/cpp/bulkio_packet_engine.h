@@ -0,0 +1,829 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK bulkioInterfaces.
+ *
+ * REDHAWK bulkioInterfaces is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK bulkioInterfaces is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#ifndef __bulkio_packet_engine_h
+#define __bulkio_packet_engine_h
+
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <stdint.h>
+
+#include <boost/function.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <ossie/BULKIO/bulkioDataTypes.h>
+#include <ossie/BULKIO/bio_dataSDDS.h>
+#include <ossie/BULKIO/bio_dataVITA49.h>
+
+#include "bulkio_convert.h"
+
+namespace bulkio {
+
+  /**
+   * @brief  Network transport for the SDDS and VITA-49 attachable ports.
+   *
+   * The attachable ports only exchange stream definitions; the data itself
+   * travels over UDP. The classes in this namespace turn a stream definition
+   * into a running network stream: receivers read batches of packets from a
+   * (usually multicast) socket and deliver the samples to an OutputStream,
+   * and senders packetize samples, such as those read from an InputStream,
+   * and transmit them in batches.
+   *
+   * Batched socket I/O uses recvmmsg/sendmmsg where available (Linux), so
+   * that a single system call moves up to a full ring of packets. Payload
+   * byte-swapping uses the bulkio::convert kernels.
+   */
+  namespace net {
+
+    /**
+     * @brief  Error opening or using a socket.
+     */
+    class SocketError : public std::runtime_error {
+    public:
+      SocketError(const std::string& message, int error=0);
+
+      /**
+       * @brief  Returns the system error number, or 0 if there is none.
+       */
+      int error() const;
+
+    private:
+      int _error;
+    };
+
+    /**
+     * @brief  Fixed set of preallocated packet buffers.
+     *
+     * The buffers, and the descriptors used to send or receive all of them
+     * in one system call, are allocated once so that the I/O path does not
+     * allocate memory.
+     */
+    class PacketRing {
+    public:
+      /**
+       * @brief  Allocates @a count buffers of @a packetSize bytes.
+       */
+      PacketRing(size_t count, size_t packetSize);
+      ~PacketRing();
+
+      size_t capacity() const;
+      size_t packetSize() const;
+
+      unsigned char* buffer(size_t index);
+      const unsigned char* buffer(size_t index) const;
+
+      /**
+       * @brief  Number of valid bytes in buffer @a index.
+       */
+      size_t length(size_t index) const;
+      void setLength(size_t index, size_t length);
+
+    private:
+      friend class UdpSocket;
+      class Impl;
+      boost::scoped_ptr<Impl> _impl;
+
+      // Non-copyable
+      PacketRing(const PacketRing&);
+      PacketRing& operator=(const PacketRing&);
+    };
+
+    /**
+     * @brief  UDP socket with batched send and receive.
+     */
+    class UdpSocket {
+    public:
+      UdpSocket();
+      ~UdpSocket();
+
+      /**
+       * @brief  Opens the socket for receiving.
+       * @param address  Local or multicast group address; an empty string
+       *                 receives on all interfaces.
+       * @param port  UDP port.
+       * @param iface  Address of the interface to join a multicast group
+       *               on; empty to let the system choose.
+       * @throw SocketError  If the socket cannot be opened or bound.
+       */
+      void bind(const std::string& address, unsigned short port, const std::string& iface=std::string());
+
+      /**
+       * @brief  Opens the socket for sending to @a address.
+       * @param address  Destination unicast or multicast group address.
+       * @param port  Destination UDP port.
+       * @param iface  Address of the interface to send multicast on; empty
+       *               to let the system choose.
+       * @param ttl  Multicast time-to-live.
+       * @param loopback  If true, multicast is also delivered to receivers
+       *                  on this host.
+       * @throw SocketError  If the socket cannot be opened.
+       */
+      void connect(const std::string& address, unsigned short port, const std::string& iface=std::string(),
+                   int ttl=1, bool loopback=true);
+
+      /**
+       * @brief  Requests a kernel receive buffer of @a bytes.
+       */
+      void setReceiveBufferSize(size_t bytes);
+
+      /**
+       * @brief  Receives a batch of packets.
+       * @param ring  Buffers to receive into.
+       * @param timeout  Seconds to wait for the first packet; a negative
+       *                 value waits indefinitely.
+       * @returns  Number of packets received, up to the ring's capacity.
+       *
+       * Once a packet is available, any others already queued in the kernel
+       * are received without waiting. The length of each packet is stored in
+       * the ring.
+       */
+      size_t receive(PacketRing& ring, float timeout);
+
+      /**
+       * @brief  Sends the first @a count packets in @a ring.
+       * @returns  Number of packets sent.
+       */
+      size_t send(PacketRing& ring, size_t count);
+
+      void close();
+      bool isOpen() const;
+
+    private:
+      int _fd;
+
+      // Non-copyable
+      UdpSocket(const UdpSocket&);
+      UdpSocket& operator=(const UdpSocket&);
+    };
+
+    /**
+     * @brief  Sample formats carried in packet payloads.
+     */
+    enum SampleFormat {
+      FORMAT_INVALID = 0,
+      FORMAT_INT8,
+      FORMAT_INT16,
+      FORMAT_INT32,
+      FORMAT_FLOAT,
+      FORMAT_DOUBLE
+    };
+
+    /**
+     * @brief  Returns the size in bytes of one sample of @a format.
+     */
+    size_t sampleSize(SampleFormat format);
+
+    /**
+     * @brief  Packet counters for a receiver or sender.
+     */
+    struct PacketStatistics {
+      PacketStatistics();
+
+      uint64_t packets;
+      uint64_t bytes;
+      uint64_t batches;
+      // Packets lost, according to the sequence numbers (receive only)
+      uint64_t dropped;
+      // Packets that could not be decoded, or sent (receive and send)
+      uint64_t invalid;
+    };
+
+    /**
+     * @brief  Samples from a run of consecutive, identically formatted
+     *         packets, in host byte order.
+     */
+    struct PacketBlock {
+      const void* data;
+      size_t samples;
+      SampleFormat format;
+      bool complex;
+      double xdelta;
+      BULKIO::PrecisionUTCTime time;
+      // True if packets were lost immediately before this block
+      bool discontinuity;
+    };
+
+    /**
+     * @brief  Base class for packet receivers.
+     *
+     * A receiver reads batches of packets into a PacketRing, decodes them,
+     * and merges consecutive packets with the same format into a single
+     * block, which is byte-swapped in one pass and delivered to a callback.
+     * The callback can be an OutputStream, in which case the samples are
+     * converted to the stream's type and the stream's xdelta and complex
+     * mode follow the packets. Lost packets are reported to the stream's
+     * readers by incrementing the DISCONTINUITIES keyword, which is pushed
+     * with the first block after the gap.
+     */
+    class PacketReceiver {
+    public:
+      typedef boost::function<void (const PacketBlock&)> BlockCallback;
+
+      virtual ~PacketReceiver();
+
+      /**
+       * @brief  Starts a thread that delivers blocks to @a callback.
+       */
+      void start(BlockCallback callback);
+
+      /**
+       * @brief  Starts a thread that writes the received data to an
+       *         OutputStream.
+       */
+      template <class OutStream>
+      void startStream(OutStream stream)
+      {
+        start(StreamWriter<OutStream>(stream));
+      }
+
+      /**
+       * @brief  Stops the receive thread, if running.
+       */
+      void stop();
+
+      bool isRunning() const;
+
+      /**
+       * @brief  Receives and delivers one batch of packets.
+       * @param callback  Receives the decoded blocks.
+       * @param timeout  Seconds to wait for the first packet.
+       * @returns  Number of packets received.
+       *
+       * For callers that run their own receive loop, instead of start().
+       */
+      size_t poll(const BlockCallback& callback, float timeout);
+
+      PacketStatistics statistics() const;
+
+      UdpSocket& socket();
+
+    protected:
+      PacketReceiver(size_t packetSize, size_t batchSize);
+
+      /**
+       * @brief  A decoded packet, referencing its buffer in the ring.
+       */
+      struct Packet {
+        unsigned char* payload;
+        size_t bytes;
+        SampleFormat format;
+        bool complex;
+        double xdelta;
+        BULKIO::PrecisionUTCTime time;
+        // Number of packets lost before this one, from its sequence number
+        size_t lost;
+      };
+
+      /**
+       * @brief  Decodes one received packet.
+       * @returns  True if the packet carries data; false to skip it.
+       *
+       * Subclasses should count packets that are malformed (as opposed to
+       * valid packets without data) by returning false with @a invalid set.
+       */
+      virtual bool decode(unsigned char* buffer, size_t length, Packet& packet, bool& invalid) = 0;
+
+      // Subclasses must stop the receive thread in their destructors, since
+      // it calls decode()
+      UdpSocket _socket;
+
+    private:
+      void _run(BlockCallback callback);
+      void _deliver(const BlockCallback& callback, std::vector<Packet>& packets, size_t first, size_t last);
+
+      template <class OutStream>
+      class StreamWriter {
+      public:
+        typedef typename OutStream::ScalarType ScalarType;
+
+        StreamWriter(OutStream stream) :
+          _stream(stream),
+          _discontinuities(0)
+        {
+        }
+
+        void operator() (const PacketBlock& block)
+        {
+          if (block.discontinuity) {
+            _stream.setKeyword("DISCONTINUITIES", ++_discontinuities);
+          }
+          if (block.complex != _stream.complex()) {
+            _stream.complex(block.complex);
+          }
+          if ((block.xdelta > 0.0) && (block.xdelta != _stream.xdelta())) {
+            _stream.xdelta(block.xdelta);
+          }
+          _buffer.resize(block.samples);
+          switch (block.format) {
+          case FORMAT_INT8:
+            bulkio::convert::convert(static_cast<const int8_t*>(block.data), &_buffer[0], block.samples);
+            break;
+          case FORMAT_INT16:
+            bulkio::convert::convert(static_cast<const int16_t*>(block.data), &_buffer[0], block.samples);
+            break;
+          case FORMAT_INT32:
+            bulkio::convert::convert(static_cast<const int32_t*>(block.data), &_buffer[0], block.samples);
+            break;
+          case FORMAT_FLOAT:
+            bulkio::convert::convert(static_cast<const float*>(block.data), &_buffer[0], block.samples);
+            break;
+          case FORMAT_DOUBLE:
+            bulkio::convert::convert(static_cast<const double*>(block.data), &_buffer[0], block.samples);
+            break;
+          default:
+            return;
+          }
+          _stream.write(&_buffer[0], _buffer.size(), block.time);
+        }
+
+      private:
+        OutStream _stream;
+        CORBA::ULong _discontinuities;
+        std::vector<ScalarType> _buffer;
+      };
+
+      PacketRing _ring;
+      std::vector<Packet> _packets;
+      std::vector<unsigned char> _staging;
+      boost::scoped_ptr<boost::thread> _thread;
+      volatile bool _running;
+      mutable boost::mutex _statsMutex;
+      PacketStatistics _stats;
+    };
+
+    /**
+     * @brief  Base class for packet senders.
+     *
+     * Samples are packed into the buffers of a PacketRing, which is sent in
+     * one batch when it fills or on flush().
+     */
+    class PacketSender {
+    public:
+      virtual ~PacketSender();
+
+      /**
+       * @brief  Sends any packets that have not been sent yet.
+       */
+      void flush();
+
+      /**
+       * @brief  Sends the partial packet held back from the last write,
+       *         padded with zeros, then flushes.
+       *
+       * Call at the end of a stream. The destructor cannot packetize, so it
+       * discards any partial packet.
+       */
+      void finish();
+
+      /**
+       * @brief  Packetizes and queues samples for sending.
+       * @param data  Samples, in host byte order.
+       * @param count  Number of scalar samples.
+       * @param complex  True if @a data is interleaved complex.
+       * @param time  Time stamp of the first sample.
+       * @param xdelta  Sample interval, in seconds.
+       *
+       * The samples are converted to the sender's wire format.
+       */
+      template <typename T>
+      void write(const T* data, size_t count, bool complex, const BULKIO::PrecisionUTCTime& time, double xdelta)
+      {
+        switch (_format) {
+        case FORMAT_INT8:
+          _write(_convert<int8_t>(data, count), count, complex, time, xdelta);
+          break;
+        case FORMAT_INT16:
+          _write(_convert<int16_t>(data, count), count, complex, time, xdelta);
+          break;
+        case FORMAT_INT32:
+          _write(_convert<int32_t>(data, count), count, complex, time, xdelta);
+          break;
+        case FORMAT_FLOAT:
+          _write(_convert<float>(data, count), count, complex, time, xdelta);
+          break;
+        case FORMAT_DOUBLE:
+          _write(_convert<double>(data, count), count, complex, time, xdelta);
+          break;
+        default:
+          break;
+        }
+      }
+
+      /**
+       * @brief  Sends the next block of data from an InputStream.
+       * @param stream  Input stream to read from.
+       * @returns  Number of samples sent; zero if no data was available.
+       *
+       * Reads without blocking, and flushes after each block. At the end of
+       * the stream, the last partial packet is padded and sent.
+       */
+      template <class InStream>
+      size_t send(InStream& stream)
+      {
+        typename InStream::DataBlockType block = stream.tryread();
+        if (!block) {
+          if (stream.eos()) {
+            finish();
+          }
+          return 0;
+        }
+        write(block.data(), block.size(), block.complex(), block.getTimestamps().front().time, block.xdelta());
+        if (stream.eos()) {
+          finish();
+        } else {
+          flush();
+        }
+        return block.size();
+      }
+
+      SampleFormat format() const;
+
+      PacketStatistics statistics() const;
+
+      UdpSocket& socket();
+
+    protected:
+      /**
+       * @param format  Wire format of the samples.
+       * @param packetSize  Size of the packet buffers.
+       * @param batchSize  Number of packets to send per system call.
+       * @param granularity  Number of payload bytes that packetize() must
+       *                     be given a multiple of; any remainder is held
+       *                     until the next write.
+       */
+      PacketSender(SampleFormat format, size_t packetSize, size_t batchSize, size_t granularity);
+
+      /**
+       * @brief  Packetizes samples that are already in the wire format.
+       *
+       * Implementations call nextPacket() for each buffer to fill, and
+       * commitPacket() once it is complete. The size of @a data is a
+       * multiple of the granularity given to the constructor.
+       */
+      virtual void packetize(const unsigned char* data, size_t bytes, bool complex,
+                             const BULKIO::PrecisionUTCTime& time, double xdelta) = 0;
+
+      unsigned char* nextPacket();
+      void commitPacket(size_t length);
+
+      SampleFormat _format;
+      UdpSocket _socket;
+
+    private:
+      template <typename Dst, typename Src>
+      const unsigned char* _convert(const Src* data, size_t count)
+      {
+        _staging.resize(count * sizeof(Dst));
+        bulkio::convert::convert(data, reinterpret_cast<Dst*>(&_staging[0]), count);
+        return &_staging[0];
+      }
+
+      void _write(const unsigned char* data, size_t count, bool complex,
+                  const BULKIO::PrecisionUTCTime& time, double xdelta);
+
+      PacketRing _ring;
+      size_t _queued;
+      size_t _granularity;
+      std::vector<unsigned char> _staging;
+      std::vector<unsigned char> _pending;
+      BULKIO::PrecisionUTCTime _pendingTime;
+      bool _pendingComplex;
+      double _pendingXdelta;
+      mutable boost::mutex _statsMutex;
+      PacketStatistics _stats;
+    };
+
+    /**
+     * @brief  Copies @a bytes of samples of @a sampleSize bytes, converting
+     *         between host and network byte order.
+     */
+    void copySwapped(void* dst, const void* src, size_t bytes, size_t sampleSize);
+
+  }  // end of net namespace
+
+  /**
+   * @brief  SDDS packet format.
+   *
+   * Each packet has a 56-byte header and 1024 bytes of big-endian payload.
+   * Time tags count 250 picosecond ticks from the start of the current UTC
+   * year. Only 8 and 16-bit samples are supported.
+   */
+  namespace sdds {
+
+    const size_t HEADER_SIZE = 56;
+    const size_t PAYLOAD_SIZE = 1024;
+    const size_t PACKET_SIZE = HEADER_SIZE + PAYLOAD_SIZE;
+
+    /**
+     * @brief  Decoded SDDS header fields.
+     */
+    struct Header {
+      Header();
+
+      bool standardFormat;
+      bool startOfSequence;
+      bool complex;
+      int bitsPerSample;
+      uint16_t sequence;
+      bool timeTagValid;
+      bool clockValid;
+      // 250ps ticks since the start of the year, and the extension in units
+      // of 2^-32 ticks
+      uint64_t timeTag;
+      uint32_t timeTagExtension;
+      // Synchronous sample clock frequency, in Hz
+      double frequency;
+    };
+
+    /**
+     * @brief  Decodes the header of an SDDS packet.
+     * @returns  False if the packet is too short or not standard format.
+     */
+    bool parseHeader(const unsigned char* packet, size_t length, Header& header);
+
+    /**
+     * @brief  Encodes @a header into the first HEADER_SIZE bytes of
+     *         @a packet.
+     */
+    void formatHeader(const Header& header, unsigned char* packet);
+
+    /**
+     * @brief  Returns the frame sequence number after @a sequence.
+     *
+     * Every 32nd sequence number is reserved for parity packets, which are
+     * skipped.
+     */
+    uint16_t nextSequence(uint16_t sequence);
+
+    /**
+     * @brief  Returns the number of data packets from @a expected up to, but
+     *         not including, @a received.
+     */
+    size_t sequenceGap(uint16_t expected, uint16_t received);
+
+    /**
+     * @brief  Converts an SDDS time tag to UTC, relative to the year that
+     *         contains @a reference (seconds since the epoch).
+     */
+    BULKIO::PrecisionUTCTime toUTC(uint64_t timeTag, uint32_t extension, double reference);
+
+    /**
+     * @brief  Converts UTC to an SDDS time tag.
+     */
+    void fromUTC(const BULKIO::PrecisionUTCTime& time, uint64_t& timeTag, uint32_t& extension);
+
+    /**
+     * @brief  Receives an SDDS stream.
+     */
+    class Receiver : public net::PacketReceiver {
+    public:
+      /**
+       * @brief  Joins the multicast group and port in @a stream.
+       * @param stream  Stream definition from an attach call.
+       * @param iface  Address of the interface to join the group on.
+       * @param batchSize  Number of packets to receive per system call.
+       * @throw net::SocketError  If the socket cannot be opened.
+       */
+      Receiver(const BULKIO::SDDSStreamDefinition& stream, const std::string& iface=std::string(),
+               size_t batchSize=64);
+      virtual ~Receiver();
+
+    protected:
+      virtual bool decode(unsigned char* buffer, size_t length, Packet& packet, bool& invalid);
+
+    private:
+      bool _started;
+      uint16_t _expected;
+    };
+
+    /**
+     * @brief  Sends an SDDS stream.
+     */
+    class Sender : public net::PacketSender {
+    public:
+      /**
+       * @brief  Sends to the multicast group and port in @a stream.
+       * @param stream  Stream definition; its data format must be 8 or
+       *                16-bit scalar or complex.
+       * @param iface  Address of the interface to send on.
+       * @param ttl  Multicast time-to-live.
+       * @param loopback  If true, the stream is also delivered on this host.
+       * @param batchSize  Number of packets to send per system call.
+       * @throw std::invalid_argument  If the data format is not supported.
+       * @throw net::SocketError  If the socket cannot be opened.
+       *
+       * Data is sent in whole packets; a partial packet is held until the
+       * next write, or until finish() pads it to a whole packet.
+       */
+      Sender(const BULKIO::SDDSStreamDefinition& stream, const std::string& iface=std::string(),
+             int ttl=1, bool loopback=true, size_t batchSize=64);
+
+    protected:
+      virtual void packetize(const unsigned char* data, size_t bytes, bool complex,
+                             const BULKIO::PrecisionUTCTime& time, double xdelta);
+
+    private:
+      uint16_t _sequence;
+      bool _first;
+    };
+
+  }  // end of sdds namespace
+
+  /**
+   * @brief  VITA-49 (VRT) packet format.
+   *
+   * Supports IF data packets with processing-efficient payloads of 8, 16 or
+   * 32-bit integers or 32 or 64-bit floats, with UTC integer and real-time
+   * fractional time stamps. The sample rate, and the payload format if the
+   * stream definition does not give one, are read from IF context packets.
+   */
+  namespace vrt {
+
+    enum PacketType {
+      IF_DATA = 0,
+      IF_DATA_STREAM_ID = 1,
+      EXT_DATA = 2,
+      EXT_DATA_STREAM_ID = 3,
+      IF_CONTEXT = 4,
+      EXT_CONTEXT = 5
+    };
+
+    enum IntegerTimestamp {
+      TSI_NONE = 0,
+      TSI_UTC = 1,
+      TSI_GPS = 2,
+      TSI_OTHER = 3
+    };
+
+    enum FractionalTimestamp {
+      TSF_NONE = 0,
+      TSF_SAMPLE_COUNT = 1,
+      TSF_REAL_TIME = 2,
+      TSF_FREE_RUNNING = 3
+    };
+
+    /**
+     * @brief  Decoded VRT header fields.
+     */
+    struct Header {
+      Header();
+
+      PacketType packetType;
+      bool hasClassID;
+      bool hasTrailer;
+      IntegerTimestamp tsi;
+      FractionalTimestamp tsf;
+      int packetCount;
+      // Total packet size, in 32-bit words
+      size_t packetWords;
+      uint32_t streamID;
+      uint64_t classID;
+      uint32_t integerSeconds;
+      uint64_t fractionalSeconds;
+      // Offset and size of the payload, in bytes
+      size_t payloadOffset;
+      size_t payloadBytes;
+    };
+
+    /**
+     * @brief  Decodes the header of a VRT packet.
+     * @returns  False if the packet is malformed or truncated.
+     */
+    bool parseHeader(const unsigned char* packet, size_t length, Header& header);
+
+    /**
+     * @brief  Encodes @a header into @a packet.
+     * @returns  Size of the header in bytes.
+     *
+     * The packet size is computed from @a header's payloadBytes.
+     */
+    size_t formatHeader(const Header& header, unsigned char* packet);
+
+    /**
+     * @brief  Fields of interest from an IF context packet.
+     */
+    struct Context {
+      Context();
+
+      bool hasSampleRate;
+      double sampleRate;
+      bool hasFormat;
+      net::SampleFormat format;
+      bool complex;
+    };
+
+    /**
+     * @brief  Reads the sample rate and data payload format from an IF
+     *         context packet.
+     * @returns  False if the packet is not a context packet, or is truncated.
+     */
+    bool parseContext(const unsigned char* packet, const Header& header, Context& context);
+
+    /**
+     * @brief  Encodes an IF context packet with the fields set in
+     *         @a context.
+     * @returns  Size of the packet in bytes.
+     */
+    size_t formatContext(Header header, const Context& context, unsigned char* packet);
+
+    /**
+     * @brief  Returns the sample format for a payload format.
+     * @returns  FORMAT_INVALID if the format is not supported.
+     */
+    net::SampleFormat sampleFormat(const BULKIO::VITA49DataPacketPayloadFormat& format);
+
+    /**
+     * @brief  Receives a VRT stream over UDP.
+     */
+    class Receiver : public net::PacketReceiver {
+    public:
+      /**
+       * @brief  Binds to the address and port in @a stream.
+       * @param stream  Stream definition from an attach call; its data format
+       *                is used if valid_data_format is set.
+       * @param iface  Address of the interface to join a multicast group on.
+       * @param batchSize  Number of packets to receive per system call.
+       * @throw std::invalid_argument  If the transport is not UDP.
+       * @throw net::SocketError  If the socket cannot be opened.
+       */
+      Receiver(const BULKIO::VITA49StreamDefinition& stream, const std::string& iface=std::string(),
+               size_t batchSize=64);
+      virtual ~Receiver();
+
+    protected:
+      virtual bool decode(unsigned char* buffer, size_t length, Packet& packet, bool& invalid);
+
+    private:
+      net::SampleFormat _format;
+      bool _complex;
+      double _xdelta;
+      bool _started;
+      int _expected;
+    };
+
+    // Largest VRT packet a Receiver accepts, in bytes
+    const size_t MAX_PACKET_SIZE = 9216;
+
+    /**
+     * @brief  Sends a VRT stream over UDP.
+     */
+    class Sender : public net::PacketSender {
+    public:
+      /**
+       * @brief  Sends to the address and port in @a stream.
+       * @param stream  Stream definition; its data format must be a
+       *                processing-efficient format supported by sampleFormat().
+       * @param iface  Address of the interface to send multicast on.
+       * @param ttl  Multicast time-to-live.
+       * @param loopback  If true, multicast is also delivered on this host.
+       * @param batchSize  Number of packets to send per system call.
+       * @param payloadBytes  Maximum payload per packet.
+       * @throw std::invalid_argument  If the data format is not supported.
+       * @throw net::SocketError  If the socket cannot be opened.
+       */
+      Sender(const BULKIO::VITA49StreamDefinition& stream, const std::string& iface=std::string(),
+             int ttl=1, bool loopback=true, size_t batchSize=64, size_t payloadBytes=1024);
+
+    protected:
+      virtual void packetize(const unsigned char* data, size_t bytes, bool complex,
+                             const BULKIO::PrecisionUTCTime& time, double xdelta);
+
+    private:
+      void _sendContext(double xdelta, bool complex);
+
+      uint32_t _streamID;
+      size_t _payloadBytes;
+      int _packetCount;
+      int _contextPacketCount;
+      // Data packets sent since the last context packet
+      int _contextCount;
+      double _xdelta;
+      bool _complex;
+      bool _first;
+    };
+
+  }  // end of vrt namespace
+
+}  // end of bulkio namespace
+
+#endif
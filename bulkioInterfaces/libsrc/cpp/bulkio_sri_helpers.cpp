@@ -97,6 +97,12 @@ bool DefaultComparator( const BULKIO::StreamSRI &SRI_1, const BULKIO::StreamSRI
     return result;
   }
 
+  unsigned long nextVersion()
+  {
+    static volatile unsigned long version = 0;
+    return __sync_add_and_fetch(&version, 1);
+  }
+
   BULKIO::StreamSRI create( std::string sid, const double srate , const Int16 xunits, const bool blocking ) {
 
     BULKIO::StreamSRI sri;
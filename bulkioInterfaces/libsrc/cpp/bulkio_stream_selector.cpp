@@ -0,0 +1,324 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK bulkioInterfaces.
+ *
+ * REDHAWK bulkioInterfaces is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK bulkioInterfaces is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#include <algorithm>
+
+#include <boost/thread/thread_time.hpp>
+
+#include "bulkio_stream_selector.h"
+
+using bulkio::StreamSelector;
+
+namespace {
+  // Orders ready streams by descending priority, then by the order in which
+  // they were last serviced (least recent first)
+  struct ServiceOrder {
+    ServiceOrder(const StreamSelector::ReadyList& ready, const std::vector<unsigned long long>& serviced) :
+      ready(ready),
+      serviced(serviced)
+    {
+    }
+
+    bool operator() (size_t lhs, size_t rhs) const
+    {
+      if (ready[lhs].priority() != ready[rhs].priority()) {
+        return ready[lhs].priority() > ready[rhs].priority();
+      }
+      return serviced[lhs] < serviced[rhs];
+    }
+
+    const StreamSelector::ReadyList& ready;
+    const std::vector<unsigned long long>& serviced;
+  };
+}
+
+StreamSelector::StreamSelector() :
+  _signalled(0),
+  _collecting(0),
+  _interrupts(0),
+  _sequence(0)
+{
+}
+
+StreamSelector::~StreamSelector()
+{
+  SourceMap sources;
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+    sources.swap(_sources);
+    _streams.clear();
+  }
+  for (SourceMap::iterator source = sources.begin(); source != sources.end(); ++source) {
+    source->second.source->detach(this);
+  }
+}
+
+StreamSelector::ReadyList StreamSelector::select(float timeout)
+{
+  return _select(0, timeout, false);
+}
+
+StreamSelector::ReadyList StreamSelector::select(size_t samples, float timeout)
+{
+  return _select(samples, timeout, false);
+}
+
+bool StreamSelector::next(ReadyStream& ready, float timeout)
+{
+  ReadyList result = _select(0, timeout, true);
+  if (result.empty()) {
+    return false;
+  }
+  ready = result.front();
+  return true;
+}
+
+void StreamSelector::interrupt()
+{
+  boost::mutex::scoped_lock lock(_mutex);
+  ++_interrupts;
+  _cond.notify_all();
+}
+
+void StreamSelector::_addSource(Source* source, int priority)
+{
+  boost::shared_ptr<Source> entry(source);
+  const void* port = source->port();
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+    SourceMap::iterator existing = _sources.find(port);
+    if (existing != _sources.end()) {
+      existing->second.priority = priority;
+      return;
+    }
+    SourceEntry& added = _sources[port];
+    added.source = entry;
+    added.priority = priority;
+  }
+
+  // Register for notifications before checking the existing streams, so that
+  // no packets are missed in between
+  source->attach(this);
+
+  std::vector<std::string> streams = source->activeStreams();
+  for (std::vector<std::string>::iterator stream_id = streams.begin(); stream_id != streams.end(); ++stream_id) {
+    _packetReceived(port, *stream_id);
+  }
+}
+
+void StreamSelector::_removeSource(const void* port)
+{
+  boost::shared_ptr<Source> source;
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+    SourceMap::iterator existing = _sources.find(port);
+    if (existing == _sources.end()) {
+      return;
+    }
+    source = existing->second.source;
+    _sources.erase(existing);
+
+    StreamStateMap::iterator stream = _streams.lower_bound(StreamKey(port, std::string()));
+    while ((stream != _streams.end()) && (stream->first.first == port)) {
+      if (stream->second.signalled) {
+        --_signalled;
+      }
+      _streams.erase(stream++);
+    }
+
+    // A select in progress may still be checking the port's streams; the
+    // port must not go away until it is done
+    while (_collecting > 0) {
+      _collected.wait(lock);
+    }
+  }
+
+  // The port's selector lock is taken by the port when it notifies, so the
+  // selector must not hold its own lock here
+  source->detach(this);
+}
+
+void StreamSelector::_packetReceived(const void* port, const std::string& streamID)
+{
+  boost::mutex::scoped_lock lock(_mutex);
+  if (_sources.find(port) == _sources.end()) {
+    return;
+  }
+  StreamEntry& entry = _streams[StreamKey(port, streamID)];
+  if (!entry.signalled) {
+    entry.signalled = true;
+    ++_signalled;
+    _cond.notify_one();
+  }
+}
+
+void StreamSelector::_portBlocked(const void* /*unused*/)
+{
+  interrupt();
+}
+
+StreamSelector::ReadyList StreamSelector::_select(size_t samples, float timeout, bool single)
+{
+  boost::system_time end_time;
+  if (timeout > 0.0) {
+    end_time = boost::get_system_time() + boost::posix_time::microseconds(static_cast<long>(timeout * 1e6));
+  }
+
+  boost::mutex::scoped_lock lock(_mutex);
+  // Only interrupts that happen during this call wake it
+  const unsigned long long interrupts = _interrupts;
+  ReadyList ready;
+  while (true) {
+    if (_signalled > 0) {
+      // Check the streams that have received data; the ports are not called
+      // with the selector lock held
+      lock.unlock();
+      bool found = _collect(samples, ready);
+      lock.lock();
+      if (found) {
+        break;
+      }
+    }
+
+    if (_interrupts != interrupts) {
+      break;
+    }
+
+    if (timeout == 0.0) {
+      break;
+    } else if (timeout < 0.0) {
+      _cond.wait(lock);
+    } else if (!_cond.timed_wait(lock, end_time)) {
+      break;
+    }
+  }
+
+  _serviced(ready, single);
+  return ready;
+}
+
+bool StreamSelector::_collect(size_t samples, ReadyList& ready)
+{
+  // Take the current set of signalled streams, clearing the flag so that any
+  // packets that arrive while checking are not lost
+  std::vector<StreamKey> candidates;
+  std::vector< boost::shared_ptr<Source> > sources;
+  std::vector<int> priorities;
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+    for (StreamStateMap::iterator stream = _streams.begin(); stream != _streams.end(); ++stream) {
+      if (stream->second.signalled) {
+        stream->second.signalled = false;
+        SourceMap::iterator source = _sources.find(stream->first.first);
+        if (source != _sources.end()) {
+          candidates.push_back(stream->first);
+          sources.push_back(source->second.source);
+          priorities.push_back(source->second.priority);
+        }
+      }
+    }
+    _signalled = 0;
+    ++_collecting;
+  }
+
+  // The sources' ports are called without the selector lock; removing a
+  // source waits until the collecting count drops to zero
+  std::vector< boost::shared_ptr<const void> > streams;
+  streams.reserve(candidates.size());
+  try {
+    for (size_t index = 0; index < candidates.size(); ++index) {
+      streams.push_back(sources[index]->readyStream(candidates[index].second, samples));
+    }
+  } catch (...) {
+    boost::mutex::scoped_lock lock(_mutex);
+    _doneCollecting();
+    throw;
+  }
+
+  boost::mutex::scoped_lock lock(_mutex);
+  _doneCollecting();
+  for (size_t index = 0; index < candidates.size(); ++index) {
+    StreamStateMap::iterator entry = _streams.find(candidates[index]);
+    if (entry == _streams.end()) {
+      // Port was removed while checking
+      continue;
+    }
+    if (streams[index]) {
+      // Ready streams stay signalled until they are found to be empty, since
+      // the reader may not consume all of the data
+      if (!entry->second.signalled) {
+        entry->second.signalled = true;
+        ++_signalled;
+      }
+      ReadyStream stream;
+      stream._port = candidates[index].first;
+      stream._streamID = candidates[index].second;
+      stream._priority = priorities[index];
+      stream._stream = streams[index];
+      ready.push_back(stream);
+    } else if (!entry->second.signalled) {
+      // Forget idle streams; when they receive data again, they are treated
+      // as least recently serviced
+      _streams.erase(entry);
+    }
+  }
+  return !ready.empty();
+}
+
+void StreamSelector::_doneCollecting()
+{
+  // Caller must hold _mutex
+  if (--_collecting == 0) {
+    _collected.notify_all();
+  }
+}
+
+void StreamSelector::_serviced(ReadyList& ready, bool single)
+{
+  if (ready.empty()) {
+    return;
+  }
+
+  std::vector<unsigned long long> serviced;
+  std::vector<size_t> order;
+  for (size_t index = 0; index < ready.size(); ++index) {
+    StreamStateMap::iterator entry = _streams.find(StreamKey(ready[index]._port, ready[index]._streamID));
+    serviced.push_back((entry != _streams.end()) ? entry->second.serviced : 0);
+    order.push_back(index);
+  }
+  std::stable_sort(order.begin(), order.end(), ServiceOrder(ready, serviced));
+
+  ReadyList sorted;
+  sorted.reserve(ready.size());
+  for (std::vector<size_t>::iterator index = order.begin(); index != order.end(); ++index) {
+    sorted.push_back(ready[*index]);
+  }
+  if (single) {
+    sorted.resize(1);
+  }
+
+  for (ReadyList::iterator stream = sorted.begin(); stream != sorted.end(); ++stream) {
+    StreamStateMap::iterator entry = _streams.find(StreamKey(stream->_port, stream->_streamID));
+    if (entry != _streams.end()) {
+      entry->second.serviced = ++_sequence;
+    }
+  }
+  ready.swap(sorted);
+}
@@ -0,0 +1,350 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK bulkioInterfaces.
+ *
+ * REDHAWK bulkioInterfaces is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK bulkioInterfaces is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#ifndef __bulkio_stream_selector_h
+#define __bulkio_stream_selector_h
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+#include "bulkio_base.h"
+#include "bulkio_in_stream.h"
+
+namespace bulkio {
+
+  template <class PortTraits>
+  class InPortBase;
+
+  /**
+   * @brief  Waits for input streams to become ready across multiple InPorts.
+   * @headerfile  bulkio_stream_selector.h <bulkio/bulkio_stream_selector.h>
+   *
+   * %StreamSelector allows a single thread to wait on the streams of any
+   * number of input ports, which may be of different types, and returns the
+   * streams that can be read without blocking. It is intended for components
+   * that merge many inputs, such as channel combiners or recorders, that
+   * would otherwise poll each port in turn.
+   *
+   * The ports notify the selector as packets arrive, so only the streams that
+   * have received data since the last check are examined. Ready streams are
+   * returned in order of descending port priority; among streams of equal
+   * priority, the stream that was least recently returned comes first, so
+   * that a busy stream cannot starve the others.
+   *
+   * @code
+   * bulkio::StreamSelector selector;
+   * selector.add(dataFloat_in);
+   * selector.add(dataShort_in, 1);
+   * bulkio::StreamSelector::ReadyList ready = selector.select(0.1);
+   * for (size_t ii = 0; ii < ready.size(); ++ii) {
+   *   if (ready[ii].from(dataShort_in)) {
+   *     bulkio::InShortStream stream = ready[ii].stream(dataShort_in);
+   *     ...
+   *   }
+   * }
+   * @endcode
+   *
+   * Destroying a port removes it from any selectors that include it. Only
+   * one thread at a time should call select() or next() on a given selector.
+   */
+  class StreamSelector {
+  public:
+    /**
+     * @brief  An input stream that is ready for reading.
+     */
+    class ReadyStream {
+    public:
+      ReadyStream() :
+        _port(0),
+        _priority(0)
+      {
+      }
+
+      /**
+       * @brief  Returns the stream ID of the ready stream.
+       */
+      const std::string& streamID() const
+      {
+        return _streamID;
+      }
+
+      /**
+       * @brief  Returns the priority of the port the stream belongs to.
+       */
+      int priority() const
+      {
+        return _priority;
+      }
+
+      /**
+       * @brief  Checks whether the stream belongs to a given port.
+       * @param port  Input port.
+       * @returns  True if the stream was received on @a port.
+       */
+      template <class PortTraits>
+      bool from(const InPortBase<PortTraits>* port) const
+      {
+        return (_port == port);
+      }
+
+      /**
+       * @brief  Returns the ready input stream.
+       * @param port  Input port the stream was received on.
+       * @returns  Input stream if the stream was received on @a port.
+       * @returns  Null input stream if the stream is from another port.
+       */
+      template <class PortTraits>
+      InputStream<PortTraits> stream(const InPortBase<PortTraits>* port) const
+      {
+        if (!from(port)) {
+          return InputStream<PortTraits>();
+        }
+        return *(static_cast<const InputStream<PortTraits>*>(_stream.get()));
+      }
+
+    private:
+      friend class StreamSelector;
+
+      const void* _port;
+      std::string _streamID;
+      int _priority;
+      boost::shared_ptr<const void> _stream;
+    };
+
+    typedef std::vector<ReadyStream> ReadyList;
+
+    StreamSelector();
+
+    /**
+     * @brief  Destructor.
+     *
+     * Removes the selector from all of its ports.
+     */
+    ~StreamSelector();
+
+    /**
+     * @brief  Adds an input port to the selector.
+     * @param port  Input port.
+     * @param priority  Relative priority of the port's streams; streams from
+     *                  higher priority ports are returned first.
+     *
+     * Streams on @a port that already have data queued are ready
+     * immediately. Adding a port that is already in the selector updates its
+     * priority.
+     */
+    template <class PortTraits>
+    void add(InPort<PortTraits>* port, int priority=0)
+    {
+      _addSource(new PortSource<PortTraits>(port), priority);
+    }
+
+    /**
+     * @brief  Removes an input port from the selector.
+     * @param port  Input port.
+     */
+    template <class PortTraits>
+    void remove(InPort<PortTraits>* port)
+    {
+      _removeSource(static_cast<InPortBase<PortTraits>*>(port));
+    }
+
+    /**
+     * @brief  Waits for any stream to become ready for reading.
+     * @param timeout  Seconds to wait; a negative value waits indefinitely,
+     *                 and zero does not wait.
+     * @returns  All ready streams, in service order.
+     * @returns  Empty list if the timeout expires, or a port is stopped or
+     *           the selector is interrupted.
+     *
+     * A stream is ready when InputStream::ready() would return true.
+     */
+    ReadyList select(float timeout=bulkio::Const::BLOCKING);
+
+    /**
+     * @brief  Waits for any stream to have at least @a samples available.
+     * @param samples  Minimum number of samples.
+     * @param timeout  Seconds to wait; a negative value waits indefinitely,
+     *                 and zero does not wait.
+     * @returns  All ready streams, in service order.
+     * @returns  Empty list if the timeout expires, or a port is stopped or
+     *           the selector is interrupted.
+     */
+    ReadyList select(size_t samples, float timeout);
+
+    /**
+     * @brief  Waits for the next stream to service.
+     * @param[out] ready  The highest priority, least recently serviced ready
+     *                    stream.
+     * @param timeout  Seconds to wait; a negative value waits indefinitely,
+     *                 and zero does not wait.
+     * @returns  True if a stream is ready, false otherwise.
+     *
+     * Unlike select(), only the returned stream is considered serviced,
+     * which gives round-robin scheduling when reading one stream at a time.
+     */
+    bool next(ReadyStream& ready, float timeout=bulkio::Const::BLOCKING);
+
+    /**
+     * @brief  Wakes a thread blocked in select() or next().
+     *
+     * The blocked call returns the streams that are ready, which may be
+     * none. An interrupt only affects calls that are in progress; it is not
+     * remembered for the next call.
+     */
+    void interrupt();
+
+  private:
+    /// @cond IMPL
+    template <class PortTraits>
+    friend class InPortBase;
+
+    // Type-independent interface to an input port
+    class Source {
+    public:
+      virtual ~Source() { }
+      virtual const void* port() const = 0;
+      virtual void attach(StreamSelector* selector) = 0;
+      virtual void detach(StreamSelector* selector) = 0;
+      virtual std::vector<std::string> activeStreams() = 0;
+      virtual boost::shared_ptr<const void> readyStream(const std::string& streamID, size_t samples) = 0;
+    };
+
+    template <class PortTraits>
+    class PortSource : public Source {
+    public:
+      typedef InPort<PortTraits> PortType;
+      typedef InputStream<PortTraits> StreamType;
+
+      PortSource(PortType* port) :
+        _port(port)
+      {
+      }
+
+      virtual const void* port() const
+      {
+        return static_cast<InPortBase<PortTraits>*>(_port);
+      }
+
+      virtual void attach(StreamSelector* selector)
+      {
+        StreamSelector::_attach(static_cast<InPortBase<PortTraits>*>(_port), selector);
+      }
+
+      virtual void detach(StreamSelector* selector)
+      {
+        StreamSelector::_detach(static_cast<InPortBase<PortTraits>*>(_port), selector);
+      }
+
+      virtual std::vector<std::string> activeStreams()
+      {
+        typename PortType::StreamList streams = _port->getStreams();
+        std::vector<std::string> result;
+        for (typename PortType::StreamList::iterator stream = streams.begin(); stream != streams.end(); ++stream) {
+          result.push_back(stream->streamID());
+        }
+        return result;
+      }
+
+      virtual boost::shared_ptr<const void> readyStream(const std::string& streamID, size_t samples)
+      {
+        StreamType stream = _port->getStream(streamID);
+        if (!stream) {
+          return boost::shared_ptr<const void>();
+        }
+        bool ready = (samples == 0) ? stream.ready() : (stream.samplesAvailable() >= samples);
+        if (!ready) {
+          return boost::shared_ptr<const void>();
+        }
+        return boost::make_shared<StreamType>(stream);
+      }
+
+    private:
+      PortType* _port;
+    };
+
+    template <class PortTraits>
+    static void _attach(InPortBase<PortTraits>* port, StreamSelector* selector)
+    {
+      port->_addSelector(selector);
+    }
+
+    template <class PortTraits>
+    static void _detach(InPortBase<PortTraits>* port, StreamSelector* selector)
+    {
+      port->_removeSelector(selector);
+    }
+
+    void _addSource(Source* source, int priority);
+    void _removeSource(const void* port);
+
+    // Called by ports when a packet is queued for a stream
+    void _packetReceived(const void* port, const std::string& streamID);
+
+    // Called by ports when they are stopped
+    void _portBlocked(const void* port);
+
+    ReadyList _select(size_t samples, float timeout, bool single);
+    bool _collect(size_t samples, ReadyList& ready);
+    void _doneCollecting();
+    void _serviced(ReadyList& ready, bool single);
+
+    struct SourceEntry {
+      boost::shared_ptr<Source> source;
+      int priority;
+    };
+    typedef std::map<const void*,SourceEntry> SourceMap;
+
+    // Per-stream scheduling state; a stream is signalled when it has
+    // received data since it was last found not to be ready
+    struct StreamEntry {
+      StreamEntry() : signalled(false), serviced(0) { }
+      bool signalled;
+      unsigned long long serviced;
+    };
+    typedef std::pair<const void*,std::string> StreamKey;
+    typedef std::map<StreamKey,StreamEntry> StreamStateMap;
+
+    boost::mutex _mutex;
+    boost::condition_variable _cond;
+    SourceMap _sources;
+    StreamStateMap _streams;
+    size_t _signalled;
+    // Number of _collect calls that are checking ports without the lock
+    size_t _collecting;
+    boost::condition_variable _collected;
+    // Incremented by interrupt(); select() returns when it changes
+    unsigned long long _interrupts;
+    unsigned long long _sequence;
+
+    // Non-copyable
+    StreamSelector(const StreamSelector&);
+    StreamSelector& operator=(const StreamSelector&);
+    /// @endcond
+  };
+
+} // end of bulkio namespace
+
+#endif
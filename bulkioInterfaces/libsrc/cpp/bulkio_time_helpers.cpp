@@ -106,6 +106,52 @@ namespace  bulkio {
       return (T1 == T2);
     }
 
+    const int64_t NanoTime::NS_PER_SEC;
+
+    NanoTime::NanoTime() :
+      _ns(0),
+      _tcmode(BULKIO::TCM_OFF),
+      _tcstatus(BULKIO::TCS_INVALID),
+      _toff(0.0)
+    {
+    }
+
+    NanoTime::NanoTime(const BULKIO::PrecisionUTCTime& time) :
+      _tcmode(time.tcmode),
+      _tcstatus(time.tcstatus),
+      _toff(time.toff)
+    {
+      // Normalize a copy so that the whole seconds have no fraction, and the
+      // fractional seconds are in [0,1)
+      BULKIO::PrecisionUTCTime utc = time;
+      utils::normalize(utc);
+      _ns = static_cast<int64_t>(utc.twsec) * NS_PER_SEC + llround(utc.tfsec * NS_PER_SEC);
+    }
+
+    BULKIO::PrecisionUTCTime NanoTime::toUTC() const
+    {
+      // Divide rounding towards negative infinity, so that the fractional
+      // seconds are never negative
+      int64_t whole = _ns / NS_PER_SEC;
+      int64_t frac = _ns % NS_PER_SEC;
+      if (frac < 0) {
+        frac += NS_PER_SEC;
+        whole -= 1;
+      }
+      BULKIO::PrecisionUTCTime time;
+      time.tcmode = _tcmode;
+      time.tcstatus = _tcstatus;
+      time.toff = _toff;
+      time.twsec = whole;
+      time.tfsec = frac / static_cast<double>(NS_PER_SEC);
+      return time;
+    }
+
+    int64_t NanoTime::sampleOffset(size_t samples, double xdelta)
+    {
+      return llround(samples * xdelta * NS_PER_SEC);
+    }
+
   }  // end of timestamp namespace
 
 
@@ -103,6 +103,12 @@ struct DataTransfer {
   // 
   DataTransfer(const PortSequenceType & data, const BULKIO::PrecisionUTCTime &_T, bool _EOS, const char* _streamID, BULKIO::StreamSRI &_H, bool _sriChanged, bool _inputQueueFlushed);
 
+  //
+  // Construct a DataTransfer that shares the stream's SRI; the SRI member is only filled in
+  // when the packet is returned from getPacket
+  //
+  DataTransfer(const PortSequenceType & data, const BULKIO::PrecisionUTCTime &_T, bool _EOS, const std::string& _streamID, const SharedSRI &_H, bool _sriChanged, bool _inputQueueFlushed);
+
   DataBufferType   dataBuffer;            
     BULKIO::PrecisionUTCTime T;
     bool EOS;
@@ -110,6 +116,7 @@ struct DataTransfer {
     BULKIO::StreamSRI SRI;
     bool sriChanged;
     bool inputQueueFlushed;
+    SharedSRI sharedSRI;
 
     redhawk::PropertyMap& getKeywords()
     {
@@ -137,6 +144,7 @@ struct DataTransfer< StringDataTransferTraits >
         EOS = _EOS;
         streamID = _streamID;
         SRI = _H;
+        sharedSRI.reset(new BULKIO::StreamSRI(_H));
         sriChanged = _sriChanged;
         inputQueueFlushed = _inputQueueFlushed;
     }
@@ -146,9 +154,20 @@ struct DataTransfer< StringDataTransferTraits >
         EOS = _EOS;
         streamID = _streamID;
         SRI = _H;
+        sharedSRI.reset(new BULKIO::StreamSRI(_H));
         sriChanged = _sriChanged;
         inputQueueFlushed = _inputQueueFlushed;
     }
+ DataTransfer(const char *data, const BULKIO::PrecisionUTCTime &_T, bool _EOS, const std::string& _streamID, const SharedSRI &_H, bool _sriChanged, bool _inputQueueFlushed) :
+        T(_T),
+        EOS(_EOS),
+        streamID(_streamID),
+        sriChanged(_sriChanged),
+        inputQueueFlushed(_inputQueueFlushed),
+        sharedSRI(_H)
+    {
+        if ( data != NULL )  dataBuffer = data;
+    }
     DataBufferType   dataBuffer;
     BULKIO::PrecisionUTCTime T;
     bool EOS;
@@ -156,6 +175,7 @@ struct DataTransfer< StringDataTransferTraits >
     BULKIO::StreamSRI SRI;
     bool sriChanged;
     bool inputQueueFlushed;
+    SharedSRI sharedSRI;
 
 };
 
@@ -253,3 +253,42 @@ Bulkio_Helper_Fixture::test_time_string()
   oss << bulkio::time::utils::create(1451933967.0, 0.2893569);
   CPPUNIT_ASSERT_EQUAL_MESSAGE("Reference", std::string("2016:01:04::18:59:27.289357"), oss.str());
 }
+
+void
+Bulkio_Helper_Fixture::test_time_nanotime()
+{
+  // Round trip through integer nanoseconds
+  BULKIO::PrecisionUTCTime reference = bulkio::time::utils::create(100.0, 0.5);
+  bulkio::time::NanoTime ns(reference);
+  CPPUNIT_ASSERT_EQUAL_MESSAGE("Nanoseconds", (int64_t) 100500000000LL, ns.nanoseconds());
+  CPPUNIT_ASSERT_EQUAL_MESSAGE("Round trip", reference, ns.toUTC());
+
+  // Sample offsets are exact for whole nanosecond sample periods
+  CPPUNIT_ASSERT_EQUAL_MESSAGE("Sample offset", (int64_t) 1000000000LL,
+                               bulkio::time::NanoTime::sampleOffset(1000, 1e-3));
+
+  // Arithmetic carries into whole seconds
+  bulkio::time::NanoTime later = ns + 750000000LL;
+  BULKIO::PrecisionUTCTime expected = bulkio::time::utils::create(101.0, 0.25);
+  CPPUNIT_ASSERT_EQUAL_MESSAGE("Increment", expected, later.toUTC());
+  CPPUNIT_ASSERT_EQUAL_MESSAGE("Difference", (int64_t) 750000000LL, later - ns);
+
+  // Decrement below the original whole second
+  later -= 1500000000LL;
+  expected = bulkio::time::utils::create(99.0, 0.75);
+  CPPUNIT_ASSERT_EQUAL_MESSAGE("Decrement", expected, later.toUTC());
+
+  // Comparison
+  CPPUNIT_ASSERT(later < ns);
+  CPPUNIT_ASSERT(ns > later);
+  CPPUNIT_ASSERT(ns == bulkio::time::NanoTime(reference));
+  CPPUNIT_ASSERT(ns != later);
+
+  // Equality agrees with ordering: only the time is compared
+  BULKIO::PrecisionUTCTime invalid = reference;
+  invalid.tcstatus = BULKIO::TCS_INVALID;
+  bulkio::time::NanoTime same(invalid);
+  CPPUNIT_ASSERT(ns == same);
+  CPPUNIT_ASSERT(!(ns < same) && !(same < ns));
+  CPPUNIT_ASSERT(ns <= same && ns >= same);
+}
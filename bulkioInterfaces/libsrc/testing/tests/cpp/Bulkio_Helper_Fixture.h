@@ -33,6 +33,7 @@ class Bulkio_Helper_Fixture : public CppUnit::TestFixture
   CPPUNIT_TEST( test_time_normalize );
   CPPUNIT_TEST( test_time_operators );
   CPPUNIT_TEST( test_time_string );
+  CPPUNIT_TEST( test_time_nanotime );
   CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -48,6 +49,7 @@ public:
   void test_time_normalize();
   void test_time_operators();
   void test_time_string();
+  void test_time_nanotime();
 };
 
 #endif  // BULKIO_HELPER_FIXTURE_H
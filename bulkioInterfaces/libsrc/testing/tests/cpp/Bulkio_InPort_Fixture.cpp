@@ -18,6 +18,8 @@
  * along with this program.  If not, see http://www.gnu.org/licenses/.
  */
 #include <boost/scoped_ptr.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
 
 #include "Bulkio_InPort_Fixture.h"
 #include "bulkio.h"
@@ -772,3 +774,264 @@ Bulkio_InPort_Fixture::test_subclass()
   CPPUNIT_ASSERT_NO_THROW( port );
 }
 
+
+
+template <typename T>
+void Bulkio_InPort_Fixture::push_packets(T* port, const std::string& streamID, int count, int length)
+{
+  typename T::PortSequenceType data;
+  for (int ii = 0; ii < count; ++ii) {
+    data.length(length);
+    port->pushPacket(data, bulkio::time::utils::now(), false, streamID.c_str());
+  }
+}
+
+
+namespace {
+  void delayed_push(bulkio::InShortPort* port, const std::string& streamID, int delayMsec)
+  {
+    boost::this_thread::sleep(boost::posix_time::milliseconds(delayMsec));
+    bulkio::InShortPort::PortSequenceType data;
+    data.length(1);
+    port->pushPacket(data, bulkio::time::utils::now(), false, streamID.c_str());
+  }
+}
+
+void 
+Bulkio_InPort_Fixture::test_overflow_policies()
+{
+  bulkio::InShortPort *port = new bulkio::InShortPort("test_overflow_policies", logger );
+  port->pushSRI(bulkio::sri::create("stream_a"));
+  port->pushSRI(bulkio::sri::create("stream_b"));
+  CPPUNIT_ASSERT( port->getOverflowPolicy() == bulkio::FLUSH_QUEUE );
+
+  // Default policy purges the whole queue when it is full
+  port->setMaxQueueDepth(4);
+  push_packets(port, "stream_b", 1);
+  push_packets(port, "stream_a", 4);
+  CPPUNIT_ASSERT_EQUAL(1, port->getCurrentQueueDepth());
+  CPPUNIT_ASSERT_EQUAL(0, port->getStreamQueueDepth("stream_b"));
+  CPPUNIT_ASSERT_EQUAL((uint64_t) 1, port->getDroppedPackets("stream_b"));
+  CPPUNIT_ASSERT_EQUAL((uint64_t) 3, port->getDroppedPackets("stream_a"));
+  bulkio::InShortPort::dataTransfer *pkt = port->getPacket(bulkio::Const::NON_BLOCKING);
+  CPPUNIT_ASSERT( pkt != NULL );
+  CPPUNIT_ASSERT( pkt->inputQueueFlushed );
+  delete pkt;
+
+  // Drop-oldest only discards data from the stream over its limit
+  port->setMaxQueueDepth(100);
+  port->setMaxStreamQueueDepth(2);
+  port->setOverflowPolicy(bulkio::DROP_OLDEST);
+  push_packets(port, "stream_b", 1);
+  push_packets(port, "stream_a", 1, 1);
+  push_packets(port, "stream_a", 1, 2);
+  push_packets(port, "stream_a", 1, 3);
+  CPPUNIT_ASSERT_EQUAL(2, port->getStreamQueueDepth("stream_a"));
+  CPPUNIT_ASSERT_EQUAL(1, port->getStreamQueueDepth("stream_b"));
+  CPPUNIT_ASSERT_EQUAL((uint64_t) 4, port->getDroppedPackets("stream_a"));
+  CPPUNIT_ASSERT_EQUAL((uint64_t) 1, port->getDroppedPackets("stream_b"));
+
+  pkt = port->getPacket(bulkio::Const::NON_BLOCKING, "stream_b");
+  CPPUNIT_ASSERT( pkt != NULL );
+  CPPUNIT_ASSERT( !pkt->inputQueueFlushed );
+  delete pkt;
+  pkt = port->getPacket(bulkio::Const::NON_BLOCKING, "stream_a");
+  CPPUNIT_ASSERT( pkt != NULL );
+  CPPUNIT_ASSERT_EQUAL((size_t) 2, pkt->dataBuffer.size());
+  CPPUNIT_ASSERT( pkt->inputQueueFlushed );
+  delete pkt;
+  pkt = port->getPacket(bulkio::Const::NON_BLOCKING, "stream_a");
+  CPPUNIT_ASSERT( pkt != NULL );
+  CPPUNIT_ASSERT_EQUAL((size_t) 3, pkt->dataBuffer.size());
+  CPPUNIT_ASSERT( !pkt->inputQueueFlushed );
+  delete pkt;
+  CPPUNIT_ASSERT_EQUAL(0, port->getCurrentQueueDepth());
+
+  // Drop-newest discards the incoming packet, and the stream's next packet
+  // reports the loss
+  port->setOverflowPolicy(bulkio::DROP_NEWEST);
+  push_packets(port, "stream_a", 1, 1);
+  push_packets(port, "stream_a", 1, 2);
+  push_packets(port, "stream_a", 1, 3);
+  CPPUNIT_ASSERT_EQUAL(2, port->getStreamQueueDepth("stream_a"));
+  CPPUNIT_ASSERT_EQUAL((uint64_t) 5, port->getDroppedPackets("stream_a"));
+  pkt = port->getPacket(bulkio::Const::NON_BLOCKING);
+  CPPUNIT_ASSERT_EQUAL((size_t) 1, pkt->dataBuffer.size());
+  delete pkt;
+  pkt = port->getPacket(bulkio::Const::NON_BLOCKING);
+  CPPUNIT_ASSERT_EQUAL((size_t) 2, pkt->dataBuffer.size());
+  CPPUNIT_ASSERT( !pkt->inputQueueFlushed );
+  delete pkt;
+  push_packets(port, "stream_a", 1, 4);
+  pkt = port->getPacket(bulkio::Const::NON_BLOCKING);
+  CPPUNIT_ASSERT_EQUAL((size_t) 4, pkt->dataBuffer.size());
+  CPPUNIT_ASSERT( pkt->inputQueueFlushed );
+  delete pkt;
+
+  // Byte limits apply in addition to the packet counts
+  port->setMaxStreamQueueDepth(0);
+  port->setMaxStreamQueueBytes(64 * sizeof(CORBA::Short));
+  port->setOverflowPolicy(bulkio::DROP_OLDEST);
+  push_packets(port, "stream_a", 4, 32);
+  CPPUNIT_ASSERT_EQUAL(2, port->getStreamQueueDepth("stream_a"));
+  CPPUNIT_ASSERT_EQUAL((uint64_t) 7, port->getDroppedPackets("stream_a"));
+
+  // Drop counts are reported in the port statistics
+  BULKIO::PortStatistics *stats = port->statistics();
+  const redhawk::PropertyMap& keywords = redhawk::PropertyMap::cast(stats->keywords);
+  CPPUNIT_ASSERT( keywords.contains("droppedPackets::stream_a") );
+  CPPUNIT_ASSERT_EQUAL((CORBA::ULongLong) 7, keywords["droppedPackets::stream_a"].toULongLong());
+  CPPUNIT_ASSERT_EQUAL((CORBA::ULongLong) 8, keywords["droppedPackets"].toULongLong());
+  delete stats;
+
+  // Block-stream makes the producer of the stream over its limit wait for
+  // the consumer to make room, instead of dropping anything
+  while ((pkt = port->getPacket(bulkio::Const::NON_BLOCKING))) {
+    delete pkt;
+  }
+  port->setMaxStreamQueueBytes(0);
+  port->setMaxStreamQueueDepth(2);
+  port->setOverflowPolicy(bulkio::BLOCK_STREAM);
+  push_packets(port, "stream_a", 2);
+  boost::thread producer(boost::bind(&delayed_push, port, "stream_a", 0));
+  CPPUNIT_ASSERT( !producer.timed_join(boost::posix_time::milliseconds(100)) );
+  CPPUNIT_ASSERT_EQUAL(2, port->getStreamQueueDepth("stream_a"));
+
+  // Reading a packet releases the producer
+  pkt = port->getPacket(bulkio::Const::NON_BLOCKING, "stream_a");
+  CPPUNIT_ASSERT( pkt != NULL );
+  delete pkt;
+  CPPUNIT_ASSERT( producer.timed_join(boost::posix_time::seconds(1)) );
+  CPPUNIT_ASSERT_EQUAL(2, port->getStreamQueueDepth("stream_a"));
+  CPPUNIT_ASSERT_EQUAL((uint64_t) 7, port->getDroppedPackets("stream_a"));
+
+  delete port;
+}
+
+void
+Bulkio_InPort_Fixture::test_shared_sri()
+{
+  bulkio::InFloatPort *port = new bulkio::InFloatPort("test_shared_sri", logger );
+  BULKIO::StreamSRI sri = bulkio::sri::create("stream_a");
+  sri.xdelta = 0.5;
+  port->pushSRI(sri);
+  push_packets(port, "stream_a", 2);
+
+  // Packets queued before an SRI change keep the SRI they arrived with
+  sri.xdelta = 0.25;
+  port->pushSRI(sri);
+  push_packets(port, "stream_a", 1);
+
+  bulkio::InFloatPort::dataTransfer *pkt = port->getPacket(bulkio::Const::NON_BLOCKING);
+  CPPUNIT_ASSERT( pkt != NULL );
+  CPPUNIT_ASSERT_EQUAL(std::string("stream_a"), std::string(pkt->SRI.streamID));
+  CPPUNIT_ASSERT_EQUAL(0.5, pkt->SRI.xdelta);
+  CPPUNIT_ASSERT( pkt->sriChanged );
+  delete pkt;
+  pkt = port->getPacket(bulkio::Const::NON_BLOCKING);
+  CPPUNIT_ASSERT_EQUAL(0.5, pkt->SRI.xdelta);
+  CPPUNIT_ASSERT( !pkt->sriChanged );
+  delete pkt;
+  pkt = port->getPacket(bulkio::Const::NON_BLOCKING);
+  CPPUNIT_ASSERT_EQUAL(0.25, pkt->SRI.xdelta);
+  CPPUNIT_ASSERT( pkt->sriChanged );
+  delete pkt;
+
+  // Data for an unknown stream gets a default SRI
+  push_packets(port, "stream_b", 1);
+  pkt = port->getPacket(bulkio::Const::NON_BLOCKING);
+  CPPUNIT_ASSERT( pkt != NULL );
+  CPPUNIT_ASSERT_EQUAL(std::string("stream_b"), pkt->streamID);
+  CPPUNIT_ASSERT_EQUAL(std::string("stream_b"), std::string(pkt->SRI.streamID));
+  CPPUNIT_ASSERT_EQUAL(1.0, pkt->SRI.xdelta);
+  delete pkt;
+
+  delete port;
+}
+
+
+void
+Bulkio_InPort_Fixture::test_spin_budget()
+{
+  bulkio::InShortPort *port = new bulkio::InShortPort("test_spin_budget", logger );
+  port->pushSRI(bulkio::sri::create("stream_a"));
+  CPPUNIT_ASSERT_EQUAL(0U, port->getSpinBudget());
+  CPPUNIT_ASSERT_EQUAL((unsigned long long) 0, port->getHandoffLatency().count());
+
+  // Packets that are already queued do not count as a handoff
+  port->setSpinBudget(100000);
+  CPPUNIT_ASSERT_EQUAL(100000U, port->getSpinBudget());
+  push_packets(port, "stream_a", 1);
+  bulkio::InShortPort::dataTransfer *pkt = port->getPacket(bulkio::Const::BLOCKING);
+  CPPUNIT_ASSERT( pkt != NULL );
+  delete pkt;
+  CPPUNIT_ASSERT_EQUAL((unsigned long long) 0, port->getHandoffLatency().count());
+
+  // A packet that arrives within the spin budget is received while polling
+  boost::thread pusher(boost::bind(&delayed_push, port, "stream_a", 10));
+  pkt = port->getPacket(1.0);
+  pusher.join();
+  CPPUNIT_ASSERT( pkt != NULL );
+  delete pkt;
+  CPPUNIT_ASSERT_EQUAL((unsigned long long) 1, port->getHandoffLatency().count());
+
+  // The same applies when waiting on a specific stream, even if packets for
+  // other streams arrive first
+  port->pushSRI(bulkio::sri::create("stream_b"));
+  pusher = boost::thread(boost::bind(&delayed_push, port, "stream_b", 5));
+  boost::thread pusher2(boost::bind(&delayed_push, port, "stream_a", 20));
+  pkt = port->getPacket(1.0, "stream_a");
+  pusher.join();
+  pusher2.join();
+  CPPUNIT_ASSERT( pkt != NULL );
+  CPPUNIT_ASSERT_EQUAL(std::string("stream_a"), pkt->streamID);
+  delete pkt;
+  pkt = port->getPacket(bulkio::Const::NON_BLOCKING, "stream_b");
+  CPPUNIT_ASSERT( pkt != NULL );
+  delete pkt;
+
+  // Polling never exceeds the caller's timeout
+  port->setSpinBudget(1000000);
+  boost::system_time start = boost::get_system_time();
+  pkt = port->getPacket(0.01);
+  CPPUNIT_ASSERT( pkt == NULL );
+  CPPUNIT_ASSERT( (boost::get_system_time() - start) < boost::posix_time::milliseconds(500) );
+
+  // Blocking the port releases a polling consumer
+  boost::thread blocker(boost::bind(&bulkio::InShortPort::block, port));
+  pkt = port->getPacket(bulkio::Const::BLOCKING);
+  blocker.join();
+  CPPUNIT_ASSERT( pkt == NULL );
+
+  port->resetHandoffLatency();
+  CPPUNIT_ASSERT_EQUAL((unsigned long long) 0, port->getHandoffLatency().count());
+
+  delete port;
+}
+
+void
+Bulkio_InPort_Fixture::test_current_stream_wait()
+{
+  bulkio::InShortPort *port = new bulkio::InShortPort("test_current_stream_wait", logger );
+  port->pushSRI(bulkio::sri::create("stream_a"));
+
+  // getCurrentStream must return the stream for a packet that arrives while
+  // it is waiting, both with and without a spin budget
+  const unsigned int budgets[] = { 0, 100000 };
+  for (size_t ii = 0; ii < 2; ++ii) {
+    port->setSpinBudget(budgets[ii]);
+    boost::thread pusher(boost::bind(&delayed_push, port, "stream_a", 20));
+    bulkio::InShortStream stream = port->getCurrentStream(1.0);
+    pusher.join();
+    CPPUNIT_ASSERT( stream );
+    CPPUNIT_ASSERT_EQUAL(std::string("stream_a"), stream.streamID());
+    bulkio::ShortDataBlock block = stream.read();
+    CPPUNIT_ASSERT( block );
+  }
+
+  // Timing out with nothing queued returns an invalid stream
+  bulkio::InShortStream stream = port->getCurrentStream(0.01);
+  CPPUNIT_ASSERT( !stream );
+
+  delete port;
+}
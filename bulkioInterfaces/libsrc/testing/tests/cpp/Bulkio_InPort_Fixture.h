@@ -51,6 +51,10 @@ class Bulkio_InPort_Fixture : public CppUnit::TestFixture
   CPPUNIT_TEST( test_create_sdds );
   CPPUNIT_TEST( test_sdds );
   CPPUNIT_TEST( test_subclass );
+  CPPUNIT_TEST( test_overflow_policies );
+  CPPUNIT_TEST( test_shared_sri );
+  CPPUNIT_TEST( test_spin_budget );
+  CPPUNIT_TEST( test_current_stream_wait );
   CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -82,11 +86,16 @@ public:
   void test_create_sdds();
   void test_sdds();
   void test_subclass();
+  void test_overflow_policies();
+  void test_shared_sri();
+  void test_spin_budget();
+  void test_current_stream_wait();
 
   template < typename T > void test_port_api( T *port );
   template < typename T > void test_sri_change( T *port );
   template < typename T > void test_stream_disable( T *port );
   template < typename T > void test_stream_sri_changed( T *port );
+  template < typename T > void push_packets( T *port, const std::string& streamID, int count, int length=1 );
 
   rh_logger::LoggerPtr logger;
 };
@@ -0,0 +1,209 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK bulkioInterfaces.
+ *
+ * REDHAWK bulkioInterfaces is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK bulkioInterfaces is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+//
+// Measures the bulkio conversion kernels against plain scalar loops of the
+// kind components typically write, for each instruction set the host
+// supports, across a range of buffer sizes.
+//
+// usage: ConvertBenchmark [total samples per measurement]
+//
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <complex>
+#include <vector>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include <bulkio_convert.h>
+
+namespace {
+
+    size_t totalSamples = 64 * 1024 * 1024;
+
+    const size_t BENCHMARK_SIZES[] = { 64, 512, 4096, 32768, 262144 };
+    const size_t NUM_BENCHMARK_SIZES = sizeof(BENCHMARK_SIZES) / sizeof(BENCHMARK_SIZES[0]);
+
+    double now()
+    {
+        static const boost::posix_time::ptime epoch = boost::posix_time::microsec_clock::universal_time();
+        return (boost::posix_time::microsec_clock::universal_time() - epoch).total_microseconds() * 1e-6;
+    }
+
+    // Each benchmark processes a buffer of the given size repeatedly, for
+    // approximately totalSamples samples
+    class Benchmark {
+    public:
+        virtual ~Benchmark() { }
+        virtual const char* name() const = 0;
+        virtual void resize(size_t count) = 0;
+        virtual void reference() = 0;
+        virtual void kernel() = 0;
+    };
+
+    template <typename Src, typename Dst>
+    class ConvertBenchmark : public Benchmark {
+    public:
+        ConvertBenchmark(const char* name) : _name(name) { }
+        const char* name() const { return _name; }
+        void resize(size_t count)
+        {
+            _src.assign(count, Src(1));
+            _dst.resize(count);
+        }
+        void reference()
+        {
+            for (size_t index = 0; index < _src.size(); ++index) {
+                _dst[index] = static_cast<Dst>(_src[index]) * Dst(0.5);
+            }
+        }
+        void kernel()
+        {
+            bulkio::convert::convert(&_src[0], &_dst[0], _src.size(), Dst(0.5));
+        }
+    private:
+        const char* _name;
+        std::vector<Src> _src;
+        std::vector<Dst> _dst;
+    };
+
+    template <typename T>
+    class ByteswapBenchmark : public Benchmark {
+    public:
+        ByteswapBenchmark(const char* name) : _name(name) { }
+        const char* name() const { return _name; }
+        void resize(size_t count)
+        {
+            _data.assign(count, T(1));
+        }
+        void reference()
+        {
+            for (size_t index = 0; index < _data.size(); ++index) {
+                const char* src = reinterpret_cast<const char*>(&_data[index]);
+                T value;
+                char* dst = reinterpret_cast<char*>(&value);
+                for (size_t byte = 0; byte < sizeof(T); ++byte) {
+                    dst[byte] = src[sizeof(T) - byte - 1];
+                }
+                _data[index] = value;
+            }
+        }
+        void kernel()
+        {
+            bulkio::convert::byteswap(&_data[0], _data.size());
+        }
+    private:
+        const char* _name;
+        std::vector<T> _data;
+    };
+
+    template <typename T>
+    class DeinterleaveBenchmark : public Benchmark {
+    public:
+        DeinterleaveBenchmark(const char* name) : _name(name) { }
+        const char* name() const { return _name; }
+        void resize(size_t count)
+        {
+            // Sizes are in terms of scalars
+            _src.assign(count / 2, std::complex<T>(1, -1));
+            _real.resize(count / 2);
+            _imag.resize(count / 2);
+        }
+        void reference()
+        {
+            for (size_t index = 0; index < _src.size(); ++index) {
+                _real[index] = _src[index].real();
+                _imag[index] = _src[index].imag();
+            }
+        }
+        void kernel()
+        {
+            bulkio::convert::deinterleave(&_src[0], &_real[0], &_imag[0], _src.size());
+        }
+    private:
+        const char* _name;
+        std::vector<std::complex<T> > _src;
+        std::vector<T> _real;
+        std::vector<T> _imag;
+    };
+
+    // Returns the throughput in millions of samples per second
+    double measure(Benchmark& benchmark, size_t size, bool reference)
+    {
+        benchmark.resize(size);
+        const size_t iterations = std::max(totalSamples / size, (size_t) 1);
+        // Warm up the caches
+        reference ? benchmark.reference() : benchmark.kernel();
+        const double start = now();
+        for (size_t pass = 0; pass < iterations; ++pass) {
+            reference ? benchmark.reference() : benchmark.kernel();
+        }
+        const double elapsed = now() - start;
+        return (iterations * size) / elapsed * 1e-6;
+    }
+
+    void run(Benchmark& benchmark)
+    {
+        const int supported = bulkio::convert::supportedInstructionSet();
+        std::cout << benchmark.name() << " (Msamples/sec)" << std::endl;
+        std::cout << std::setw(10) << "size" << std::setw(10) << "loop";
+        for (int isa = bulkio::convert::SCALAR; isa <= supported; ++isa) {
+            std::cout << std::setw(10) << bulkio::convert::instructionSetName(static_cast<bulkio::convert::InstructionSet>(isa));
+        }
+        std::cout << std::endl;
+
+        for (size_t ii = 0; ii < NUM_BENCHMARK_SIZES; ++ii) {
+            const size_t size = BENCHMARK_SIZES[ii];
+            std::cout << std::setw(10) << size << std::fixed << std::setprecision(1);
+            std::cout << std::setw(10) << measure(benchmark, size, true);
+            for (int isa = bulkio::convert::SCALAR; isa <= supported; ++isa) {
+                bulkio::convert::useInstructionSet(static_cast<bulkio::convert::InstructionSet>(isa));
+                std::cout << std::setw(10) << measure(benchmark, size, false);
+            }
+            std::cout << std::endl;
+        }
+        std::cout << std::endl;
+        bulkio::convert::useInstructionSet(bulkio::convert::supportedInstructionSet());
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc > 1) {
+        totalSamples = strtoul(argv[1], 0, 10);
+    }
+
+    ConvertBenchmark<int8_t,float> int8ToFloat("int8 -> float");
+    ConvertBenchmark<int16_t,float> int16ToFloat("int16 -> float");
+    ConvertBenchmark<float,double> floatToDouble("float -> double");
+    ConvertBenchmark<double,float> doubleToFloat("double -> float");
+    ByteswapBenchmark<uint16_t> byteswap16("byteswap 16");
+    ByteswapBenchmark<uint32_t> byteswap32("byteswap 32");
+    DeinterleaveBenchmark<float> deinterleave("deinterleave complex float");
+
+    Benchmark* benchmarks[] = { &int8ToFloat, &int16ToFloat, &floatToDouble, &doubleToFloat,
+                                &byteswap16, &byteswap32, &deinterleave };
+    for (size_t index = 0; index < sizeof(benchmarks) / sizeof(benchmarks[0]); ++index) {
+        run(*benchmarks[index]);
+    }
+    return 0;
+}
@@ -0,0 +1,253 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK bulkioInterfaces.
+ *
+ * REDHAWK bulkioInterfaces is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK bulkioInterfaces is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#include "ConvertTest.h"
+#include "bulkio.h"
+
+#include <cstdlib>
+#include <vector>
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ConvertTest);
+
+namespace {
+    // Sizes cover empty buffers, buffers shorter than one vector and buffers
+    // with a partial vector at the end
+    const size_t TEST_SIZES[] = { 0, 1, 3, 7, 8, 15, 16, 17, 31, 33, 64, 1023 };
+    const size_t NUM_TEST_SIZES = sizeof(TEST_SIZES) / sizeof(TEST_SIZES[0]);
+
+    template <typename T>
+    std::vector<T> makeData(size_t count)
+    {
+        std::vector<T> data(count);
+        for (size_t index = 0; index < count; ++index) {
+            data[index] = static_cast<T>(rand());
+        }
+        return data;
+    }
+}
+
+void ConvertTest::setUp()
+{
+    srand(1);
+}
+
+void ConvertTest::tearDown()
+{
+    bulkio::convert::useInstructionSet(bulkio::convert::supportedInstructionSet());
+}
+
+void ConvertTest::forEachInstructionSet(TestMethod method)
+{
+    const int supported = bulkio::convert::supportedInstructionSet();
+    for (int isa = bulkio::convert::SCALAR; isa <= supported; ++isa) {
+        bulkio::convert::useInstructionSet(static_cast<bulkio::convert::InstructionSet>(isa));
+        (this->*method)();
+    }
+}
+
+template <typename T>
+void ConvertTest::checkIntegerToFloat()
+{
+    const std::string name = bulkio::convert::instructionSetName(bulkio::convert::activeInstructionSet());
+    for (size_t ii = 0; ii < NUM_TEST_SIZES; ++ii) {
+        const size_t count = TEST_SIZES[ii];
+        std::vector<T> src = makeData<T>(count);
+        std::vector<float> dst(count + 1, -1.0f);
+        bulkio::convert::convert(&src[0], &dst[0], count, 0.5f);
+        for (size_t index = 0; index < count; ++index) {
+            CPPUNIT_ASSERT_EQUAL_MESSAGE(name, static_cast<float>(src[index]) * 0.5f, dst[index]);
+        }
+        CPPUNIT_ASSERT_EQUAL_MESSAGE(name + " wrote past end", -1.0f, dst[count]);
+    }
+}
+
+void ConvertTest::checkIntegerToFloatAll()
+{
+    checkIntegerToFloat<int8_t>();
+    checkIntegerToFloat<uint8_t>();
+    checkIntegerToFloat<int16_t>();
+    checkIntegerToFloat<uint16_t>();
+    checkIntegerToFloat<int32_t>();
+}
+
+void ConvertTest::testIntegerToFloat()
+{
+    forEachInstructionSet(&ConvertTest::checkIntegerToFloatAll);
+
+    // Full range of signed and unsigned 8-bit values
+    std::vector<int8_t> signed8(256);
+    std::vector<uint8_t> unsigned8(256);
+    for (int value = 0; value < 256; ++value) {
+        signed8[value] = static_cast<int8_t>(value - 128);
+        unsigned8[value] = static_cast<uint8_t>(value);
+    }
+    std::vector<float> dst(256);
+    bulkio::convert::convert(&signed8[0], &dst[0], dst.size());
+    CPPUNIT_ASSERT_EQUAL(-128.0f, dst[0]);
+    CPPUNIT_ASSERT_EQUAL(127.0f, dst[255]);
+    bulkio::convert::convert(&unsigned8[0], &dst[0], dst.size());
+    CPPUNIT_ASSERT_EQUAL(0.0f, dst[0]);
+    CPPUNIT_ASSERT_EQUAL(255.0f, dst[255]);
+}
+
+void ConvertTest::checkFloatDouble()
+{
+    for (size_t ii = 0; ii < NUM_TEST_SIZES; ++ii) {
+        const size_t count = TEST_SIZES[ii];
+        std::vector<float> src = makeData<float>(count);
+        std::vector<double> wide(count);
+        bulkio::convert::convert(&src[0], &wide[0], count);
+        std::vector<float> narrow(count);
+        bulkio::convert::convert(&wide[0], &narrow[0], count);
+        for (size_t index = 0; index < count; ++index) {
+            CPPUNIT_ASSERT_EQUAL(static_cast<double>(src[index]), wide[index]);
+            CPPUNIT_ASSERT_EQUAL(src[index], narrow[index]);
+        }
+    }
+}
+
+void ConvertTest::testFloatDouble()
+{
+    forEachInstructionSet(&ConvertTest::checkFloatDouble);
+}
+
+void ConvertTest::checkScale()
+{
+    for (size_t ii = 0; ii < NUM_TEST_SIZES; ++ii) {
+        const size_t count = TEST_SIZES[ii];
+        std::vector<float> floats = makeData<float>(count);
+        std::vector<float> scaled(count);
+        bulkio::convert::scale(&floats[0], &scaled[0], count, 0.25f);
+        std::vector<double> doubles = makeData<double>(count);
+        std::vector<double> expected(doubles);
+        // In-place scaling is allowed
+        bulkio::convert::scale(&doubles[0], &doubles[0], count, 0.25);
+        for (size_t index = 0; index < count; ++index) {
+            CPPUNIT_ASSERT_EQUAL(floats[index] * 0.25f, scaled[index]);
+            CPPUNIT_ASSERT_EQUAL(expected[index] * 0.25, doubles[index]);
+        }
+    }
+}
+
+void ConvertTest::testScale()
+{
+    forEachInstructionSet(&ConvertTest::checkScale);
+}
+
+void ConvertTest::checkByteswap()
+{
+    for (size_t ii = 0; ii < NUM_TEST_SIZES; ++ii) {
+        const size_t count = TEST_SIZES[ii];
+        std::vector<uint16_t> words(count);
+        std::vector<uint32_t> longs(count);
+        std::vector<uint64_t> longlongs(count);
+        for (size_t index = 0; index < count; ++index) {
+            words[index] = 0x0102 + index;
+            longs[index] = 0x01020304 + index;
+            longlongs[index] = 0x0102030405060708ULL + index;
+        }
+        bulkio::convert::byteswap(&words[0], count);
+        bulkio::convert::byteswap(&longs[0], count);
+        bulkio::convert::byteswap(&longlongs[0], count);
+        for (size_t index = 0; index < count; ++index) {
+            const uint16_t word = 0x0102 + index;
+            CPPUNIT_ASSERT_EQUAL(static_cast<uint16_t>((word << 8) | (word >> 8)), words[index]);
+            CPPUNIT_ASSERT_EQUAL(static_cast<uint32_t>(__builtin_bswap32(0x01020304 + index)), longs[index]);
+            CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(__builtin_bswap64(0x0102030405060708ULL + index)), longlongs[index]);
+        }
+    }
+}
+
+void ConvertTest::testByteswap()
+{
+    forEachInstructionSet(&ConvertTest::checkByteswap);
+}
+
+void ConvertTest::checkInterleave()
+{
+    for (size_t ii = 0; ii < NUM_TEST_SIZES; ++ii) {
+        const size_t count = TEST_SIZES[ii];
+        std::vector<std::complex<float> > cxfloat(count);
+        std::vector<std::complex<double> > cxdouble(count);
+        for (size_t index = 0; index < count; ++index) {
+            cxfloat[index] = std::complex<float>(index, -1.0 * index);
+            cxdouble[index] = std::complex<double>(index, -1.0 * index);
+        }
+
+        std::vector<float> freal(count), fimag(count);
+        bulkio::convert::deinterleave(&cxfloat[0], &freal[0], &fimag[0], count);
+        std::vector<double> dreal(count), dimag(count);
+        bulkio::convert::deinterleave(&cxdouble[0], &dreal[0], &dimag[0], count);
+        for (size_t index = 0; index < count; ++index) {
+            CPPUNIT_ASSERT_EQUAL(cxfloat[index].real(), freal[index]);
+            CPPUNIT_ASSERT_EQUAL(cxfloat[index].imag(), fimag[index]);
+            CPPUNIT_ASSERT_EQUAL(cxdouble[index].real(), dreal[index]);
+            CPPUNIT_ASSERT_EQUAL(cxdouble[index].imag(), dimag[index]);
+        }
+
+        std::vector<std::complex<float> > fresult(count);
+        bulkio::convert::interleave(&freal[0], &fimag[0], &fresult[0], count);
+        std::vector<std::complex<double> > dresult(count);
+        bulkio::convert::interleave(&dreal[0], &dimag[0], &dresult[0], count);
+        CPPUNIT_ASSERT(fresult == cxfloat);
+        CPPUNIT_ASSERT(dresult == cxdouble);
+    }
+}
+
+void ConvertTest::testInterleave()
+{
+    forEachInstructionSet(&ConvertTest::checkInterleave);
+}
+
+void ConvertTest::testDataBlockAs()
+{
+    // A null block converts to a null block
+    bulkio::ShortDataBlock empty;
+    CPPUNIT_ASSERT(!empty.as<float>());
+
+    BULKIO::StreamSRI sri = bulkio::sri::create("convert_test");
+    sri.mode = 1;
+    bulkio::ShortDataBlock block(sri, 100);
+    for (size_t index = 0; index < block.size(); ++index) {
+        block.data()[index] = index * 256;
+    }
+    block.addTimestamp(bulkio::SampleTimestamp(bulkio::time::utils::create(100.0, 0.5), 0));
+    block.addTimestamp(bulkio::SampleTimestamp(bulkio::time::utils::create(101.0, 0.0), 25, true));
+    block.sriChangeFlags(bulkio::sri::MODE);
+    block.inputQueueFlushed(true);
+
+    bulkio::FloatDataBlock result = block.as<float>(1.0f / 32768.0f);
+    CPPUNIT_ASSERT(!!result);
+    CPPUNIT_ASSERT_EQUAL(block.size(), result.size());
+    for (size_t index = 0; index < result.size(); ++index) {
+        CPPUNIT_ASSERT_EQUAL(block.data()[index] / 32768.0f, result.data()[index]);
+    }
+
+    // Metadata is carried over
+    CPPUNIT_ASSERT_EQUAL(std::string("convert_test"), std::string(result.sri().streamID));
+    CPPUNIT_ASSERT(result.complex());
+    CPPUNIT_ASSERT_EQUAL(block.sriChangeFlags(), result.sriChangeFlags());
+    CPPUNIT_ASSERT(result.inputQueueFlushed());
+    std::list<bulkio::SampleTimestamp> timestamps = result.getTimestamps();
+    CPPUNIT_ASSERT_EQUAL((size_t) 2, timestamps.size());
+    CPPUNIT_ASSERT_EQUAL((size_t) 25, timestamps.back().offset);
+    CPPUNIT_ASSERT(timestamps.back().synthetic);
+    CPPUNIT_ASSERT_EQUAL(bulkio::time::utils::create(101.0, 0.0), timestamps.back().time);
+}
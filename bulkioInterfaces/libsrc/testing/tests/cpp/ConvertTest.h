@@ -0,0 +1,62 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK bulkioInterfaces.
+ *
+ * REDHAWK bulkioInterfaces is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK bulkioInterfaces is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+#ifndef BULKIO_CONVERTTEST_H
+#define BULKIO_CONVERTTEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class ConvertTest : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE(ConvertTest);
+    CPPUNIT_TEST(testIntegerToFloat);
+    CPPUNIT_TEST(testFloatDouble);
+    CPPUNIT_TEST(testScale);
+    CPPUNIT_TEST(testByteswap);
+    CPPUNIT_TEST(testInterleave);
+    CPPUNIT_TEST(testDataBlockAs);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp();
+    void tearDown();
+
+    void testIntegerToFloat();
+    void testFloatDouble();
+    void testScale();
+    void testByteswap();
+    void testInterleave();
+    void testDataBlockAs();
+
+private:
+    // Runs a test method once for each instruction set the host supports
+    typedef void (ConvertTest::*TestMethod)();
+    void forEachInstructionSet(TestMethod method);
+
+    template <typename T>
+    void checkIntegerToFloat();
+
+    void checkIntegerToFloatAll();
+    void checkFloatDouble();
+    void checkScale();
+    void checkByteswap();
+    void checkInterleave();
+};
+
+#endif  // BULKIO_CONVERTTEST_H
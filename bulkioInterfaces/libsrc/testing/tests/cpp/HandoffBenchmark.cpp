@@ -0,0 +1,119 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK bulkioInterfaces.
+ *
+ * REDHAWK bulkioInterfaces is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK bulkioInterfaces is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+//
+// Measures the latency from pushPacket to a consumer waiting in getPacket or
+// InputStream::read, with the consumer blocking immediately and with a range
+// of spin budgets. The producer paces its packets so that the consumer is
+// always waiting when one arrives.
+//
+// usage: HandoffBenchmark [packets per measurement] [microseconds between packets]
+//
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+#include <bulkio.h>
+
+namespace {
+
+    size_t totalPackets = 20000;
+    unsigned int packetInterval = 200;
+
+    const unsigned int SPIN_BUDGETS[] = { 0, 50, 500, 5000 };
+    const size_t NUM_SPIN_BUDGETS = sizeof(SPIN_BUDGETS) / sizeof(SPIN_BUDGETS[0]);
+
+    const double PERCENTILES[] = { 50.0, 90.0, 99.0, 99.9 };
+    const char* PERCENTILE_LABELS[] = { "50%", "90%", "99%", "99.9%" };
+    const size_t NUM_PERCENTILES = sizeof(PERCENTILES) / sizeof(PERCENTILES[0]);
+
+    void produce(bulkio::InShortPort* port)
+    {
+        bulkio::InShortPort::PortSequenceType data;
+        data.length(64);
+        for (size_t count = 0; count < totalPackets; ++count) {
+            boost::this_thread::sleep(boost::posix_time::microseconds(packetInterval));
+            port->pushPacket(data, bulkio::time::utils::now(), false, "handoff");
+        }
+    }
+
+    void consumePackets(bulkio::InShortPort* port)
+    {
+        for (size_t count = 0; count < totalPackets; ++count) {
+            delete port->getPacket(bulkio::Const::BLOCKING);
+        }
+    }
+
+    void consumeStream(bulkio::InShortPort* port)
+    {
+        bulkio::InShortStream stream = port->getStream("handoff");
+        for (size_t count = 0; count < totalPackets; ++count) {
+            stream.read();
+        }
+    }
+
+    void measure(const char* name, void (*consume)(bulkio::InShortPort*))
+    {
+        // Percentiles are reported as the upper bound of their histogram bucket
+        std::cout << name << " handoff latency (usec)" << std::endl;
+        std::cout << std::setw(10) << "spin";
+        for (size_t ii = 0; ii < NUM_PERCENTILES; ++ii) {
+            std::cout << std::setw(10) << PERCENTILE_LABELS[ii];
+        }
+        std::cout << std::endl;
+
+        for (size_t ii = 0; ii < NUM_SPIN_BUDGETS; ++ii) {
+            bulkio::InShortPort port("dataShort_in");
+            port.setMaxQueueDepth(totalPackets + 1);
+            port.pushSRI(bulkio::sri::create("handoff"));
+            port.setSpinBudget(SPIN_BUDGETS[ii]);
+
+            boost::thread producer(boost::bind(&produce, &port));
+            consume(&port);
+            producer.join();
+
+            const bulkio::LatencyHistogram histogram = port.getHandoffLatency();
+            std::cout << std::setw(10) << SPIN_BUDGETS[ii] << std::fixed << std::setprecision(1);
+            for (size_t jj = 0; jj < NUM_PERCENTILES; ++jj) {
+                std::cout << std::setw(10) << (histogram.percentile(PERCENTILES[jj]) * 1e-3);
+            }
+            std::cout << std::endl;
+        }
+        std::cout << std::endl;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc > 1) {
+        totalPackets = strtoul(argv[1], 0, 10);
+    }
+    if (argc > 2) {
+        packetInterval = strtoul(argv[2], 0, 10);
+    }
+
+    measure("getPacket", &consumePackets);
+    measure("InputStream::read", &consumeStream);
+    return 0;
+}
@@ -19,6 +19,9 @@
  */
 
 #include "OutStreamTest.h"
+
+#include <boost/lexical_cast.hpp>
+
 #include "bulkio.h"
 
 template <class Port>
@@ -77,6 +80,139 @@ void OutStreamTest<Port>::testWriteTimestampsMixed()
    _writeTimestampsImpl(stream, false);
 }
 
+template <class Port>
+void OutStreamTest<Port>::testSriCoalesced()
+{
+    StreamType stream = port->createStream("sri_coalesced");
+    std::vector<ScalarType> buffer;
+    buffer.resize(16);
+
+    stream.write(&buffer[0], buffer.size(), bulkio::time::utils::now());
+    CPPUNIT_ASSERT_EQUAL((size_t) 1, stub->H.size());
+    CPPUNIT_ASSERT_EQUAL((size_t) 1, stub->packets.size());
+
+    // Several updates between writes should result in a single SRI push
+    stream.xdelta(0.125);
+    stream.setKeyword("COL_RF", 101.1e6);
+    stream.setKeyword("CHAN_RF", 101.5e6);
+    stream.setKeyword("COL_RF", 99.9e6);
+    stream.write(&buffer[0], buffer.size(), bulkio::time::utils::now());
+    CPPUNIT_ASSERT_EQUAL((size_t) 2, stub->H.size());
+    CPPUNIT_ASSERT_EQUAL((size_t) 2, stub->packets.size());
+    CPPUNIT_ASSERT_EQUAL(0.125, stub->H.back().xdelta);
+    CPPUNIT_ASSERT_EQUAL((CORBA::ULong) 2, stub->H.back().keywords.length());
+
+    // Re-setting the same values should not push the SRI again
+    stream.setKeyword("CHAN_RF", 101.5e6);
+    stream.write(&buffer[0], buffer.size(), bulkio::time::utils::now());
+    CPPUNIT_ASSERT_EQUAL((size_t) 2, stub->H.size());
+    CPPUNIT_ASSERT_EQUAL((size_t) 3, stub->packets.size());
+}
+
+template <class Port>
+void OutStreamTest<Port>::testSriReverted()
+{
+    StreamType stream = port->createStream("sri_reverted");
+    std::vector<ScalarType> buffer;
+    buffer.resize(16);
+
+    stream.setKeyword("COL_RF", 101.1e6);
+    stream.write(&buffer[0], buffer.size(), bulkio::time::utils::now());
+    CPPUNIT_ASSERT_EQUAL((size_t) 1, stub->H.size());
+
+    // Route only another stream to the connection, so that it never receives
+    // the updated SRI
+    std::vector<bulkio::connection_descriptor_struct> filter(1);
+    filter[0].connection_id = "test_connection";
+    filter[0].stream_id = "other_stream";
+    filter[0].port_name = "data" + getPortName() + "_out";
+    port->updateConnectionFilter(filter);
+    stream.setKeyword("COL_RF", 99.9e6);
+    stream.write(&buffer[0], buffer.size(), bulkio::time::utils::now());
+    CPPUNIT_ASSERT_EQUAL((size_t) 1, stub->packets.size());
+
+    // Reverting is a change of its own; SRI updates are tracked by version,
+    // not compared against what the connection last received
+    port->updateConnectionFilter(std::vector<bulkio::connection_descriptor_struct>());
+    stream.setKeyword("COL_RF", 101.1e6);
+    stream.write(&buffer[0], buffer.size(), bulkio::time::utils::now());
+    CPPUNIT_ASSERT_EQUAL((size_t) 2, stub->H.size());
+    CPPUNIT_ASSERT_EQUAL(101.1e6, redhawk::PropertyMap::cast(stub->H.back().keywords)["COL_RF"].toDouble());
+    CPPUNIT_ASSERT_EQUAL((size_t) 2, stub->packets.size());
+}
+
+template <class Port>
+void OutStreamTest<Port>::testKeywordIndex()
+{
+    StreamType stream = port->createStream("keyword_index");
+
+    // Use enough keywords that lookups go through the hashed index
+    const int KEYWORD_COUNT = 4 * redhawk::PropertyIndex::DEFAULT_THRESHOLD;
+    for (int index = 0; index < KEYWORD_COUNT; ++index) {
+        stream.setKeyword("KW_" + boost::lexical_cast<std::string>(index), index);
+    }
+    CPPUNIT_ASSERT_EQUAL((size_t) KEYWORD_COUNT, stream.keywords().size());
+    for (int index = 0; index < KEYWORD_COUNT; ++index) {
+        const std::string name = "KW_" + boost::lexical_cast<std::string>(index);
+        CPPUNIT_ASSERT(stream.hasKeyword(name));
+        CPPUNIT_ASSERT_EQUAL((CORBA::Long) index, stream.getKeyword(name).toLong());
+    }
+
+    // Erasing shifts the keywords that follow
+    stream.eraseKeyword("KW_0");
+    stream.eraseKeyword("KW_10");
+    CPPUNIT_ASSERT(!stream.hasKeyword("KW_0"));
+    CPPUNIT_ASSERT(!stream.hasKeyword("KW_10"));
+    CPPUNIT_ASSERT_EQUAL((CORBA::Long) 11, stream.getKeyword("KW_11").toLong());
+    stream.setKeyword("KW_10", 100);
+    CPPUNIT_ASSERT_EQUAL((size_t) KEYWORD_COUNT - 1, stream.keywords().size());
+    CPPUNIT_ASSERT_EQUAL((CORBA::Long) 100, stream.getKeyword("KW_10").toLong());
+
+    // Replacing the keywords, in reverse order, and the whole SRI
+    redhawk::PropertyMap reversed;
+    for (int index = KEYWORD_COUNT - 1; index >= 0; --index) {
+        reversed["KW_" + boost::lexical_cast<std::string>(index)] = -index;
+    }
+    stream.keywords(reversed);
+    CPPUNIT_ASSERT_EQUAL((CORBA::Long) 0, stream.getKeyword("KW_0").toLong());
+    CPPUNIT_ASSERT_EQUAL((CORBA::Long) -10, stream.getKeyword("KW_10").toLong());
+
+    BULKIO::StreamSRI sri = stream.sri();
+    redhawk::PropertyMap::cast(sri.keywords).erase("KW_1");
+    stream.sri(sri);
+    CPPUNIT_ASSERT(!stream.hasKeyword("KW_1"));
+    CPPUNIT_ASSERT_EQUAL((CORBA::Long) -2, stream.getKeyword("KW_2").toLong());
+
+    // Appended properties are picked up without invalidating the index; any
+    // other change requires invalidate(), after which misses are trusted
+    redhawk::PropertyMap props;
+    for (int index = 0; index < KEYWORD_COUNT; ++index) {
+        props["KW_" + boost::lexical_cast<std::string>(index)] = index;
+    }
+    redhawk::PropertyIndex propIndex;
+    CPPUNIT_ASSERT_EQUAL((size_t) 5, propIndex.find(props, "KW_5"));
+    props["APPENDED"] = 0;
+    CPPUNIT_ASSERT_EQUAL(props.size() - 1, propIndex.find(props, "APPENDED"));
+    props.erase("KW_0");
+    propIndex.invalidate();
+    CPPUNIT_ASSERT_EQUAL((size_t) 4, propIndex.find(props, "KW_5"));
+    props[0].id = "RENAMED";
+    propIndex.invalidate();
+    CPPUNIT_ASSERT_EQUAL((size_t) 0, propIndex.find(props, "RENAMED"));
+    CPPUNIT_ASSERT_EQUAL(props.size(), propIndex.find(props, "KW_1"));
+    CPPUNIT_ASSERT_EQUAL(props.size(), propIndex.find(props, "MISSING"));
+
+    // IndexedPropertyMap keeps its index current through its own interface
+    redhawk::IndexedPropertyMap indexed(props);
+    CPPUNIT_ASSERT(indexed.contains("KW_5"));
+    indexed.erase("KW_5");
+    CPPUNIT_ASSERT(!indexed.contains("KW_5"));
+    CPPUNIT_ASSERT_EQUAL((CORBA::Long) 6, indexed["KW_6"].toLong());
+    indexed["KW_5"] = 50;
+    CPPUNIT_ASSERT_EQUAL((CORBA::Long) 50, indexed["KW_5"].toLong());
+    CPPUNIT_ASSERT(indexed.find("MISSING") == indexed.end());
+}
+
 template <class Port>
 void OutStreamTest<Port>::_writeTimestampsImpl(StreamType& stream, bool complexData)
 {
@@ -32,6 +32,9 @@ class OutStreamTest : public CppUnit::TestFixture
     CPPUNIT_TEST(testWriteTimestampsReal);
     CPPUNIT_TEST(testWriteTimestampsComplex);
     CPPUNIT_TEST(testWriteTimestampsMixed);
+    CPPUNIT_TEST(testSriCoalesced);
+    CPPUNIT_TEST(testSriReverted);
+    CPPUNIT_TEST(testKeywordIndex);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -42,6 +45,11 @@ public:
     void testWriteTimestampsComplex();
     void testWriteTimestampsMixed();
 
+    void testSriCoalesced();
+    void testSriReverted();
+
+    void testKeywordIndex();
+
 private:
     typedef typename Port::StreamType StreamType;
     typedef typename StreamType::ScalarType ScalarType;
@@ -0,0 +1,458 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK bulkioInterfaces.
+ *
+ * REDHAWK bulkioInterfaces is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK bulkioInterfaces is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#include "PacketEngineTest.h"
+
+#include <cstring>
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+CPPUNIT_TEST_SUITE_REGISTRATION(PacketEngineTest);
+
+namespace {
+    // Administratively scoped multicast; the senders use a TTL of 1 with
+    // loopback enabled, so the packets do not leave the host
+    const char* MULTICAST_GROUP = "239.255.73.1";
+    const unsigned short BASE_PORT = 29500;
+
+    const float RECEIVE_TIMEOUT = 1.0;
+
+    template <typename T>
+    std::vector<T> makeData(size_t count)
+    {
+        std::vector<T> data(count);
+        for (size_t index = 0; index < count; ++index) {
+            data[index] = static_cast<T>(index % 1000) - 500;
+        }
+        return data;
+    }
+
+    // Receives until the expected number of packets arrive, or nothing is
+    // received within the timeout
+    void receivePackets(bulkio::net::PacketReceiver& receiver, const bulkio::net::PacketReceiver::BlockCallback& callback,
+                        size_t packets)
+    {
+        size_t count = 0;
+        while (count < packets) {
+            size_t batch = receiver.poll(callback, RECEIVE_TIMEOUT);
+            if (batch == 0) {
+                break;
+            }
+            count += batch;
+        }
+    }
+}
+
+void PacketEngineTest::setUp()
+{
+    blocks.clear();
+    received.clear();
+}
+
+void PacketEngineTest::tearDown()
+{
+}
+
+void PacketEngineTest::blockReceived(const bulkio::net::PacketBlock& block)
+{
+    blocks.push_back(block);
+    const unsigned char* data = static_cast<const unsigned char*>(block.data);
+    received.insert(received.end(), data, data + block.samples * bulkio::net::sampleSize(block.format));
+}
+
+template <typename T>
+std::vector<T> PacketEngineTest::receivedData() const
+{
+    std::vector<T> result(received.size() / sizeof(T));
+    if (!result.empty()) {
+        memcpy(&result[0], &received[0], result.size() * sizeof(T));
+    }
+    return result;
+}
+
+BULKIO::SDDSStreamDefinition PacketEngineTest::sddsStream(unsigned short port) const
+{
+    BULKIO::SDDSStreamDefinition stream;
+    stream.id = "sdds_stream";
+    stream.dataFormat = BULKIO::SDDS_CI;
+    stream.multicastAddress = MULTICAST_GROUP;
+    stream.vlan = 0;
+    stream.port = BASE_PORT + port;
+    stream.sampleRate = 0;
+    stream.timeTagValid = true;
+    stream.privateInfo = "";
+    return stream;
+}
+
+BULKIO::VITA49StreamDefinition PacketEngineTest::vrtStream(unsigned short port) const
+{
+    BULKIO::VITA49StreamDefinition stream;
+    stream.ip_address = MULTICAST_GROUP;
+    stream.vlan = 0;
+    stream.port = BASE_PORT + port;
+    stream.protocol = BULKIO::VITA49_UDP_TRANSPORT;
+    stream.id = "vrt_stream";
+    stream.valid_data_format = false;
+    stream.data_format.packing_method_processing_efficient = true;
+    stream.data_format.complexity = BULKIO::VITA49_REAL;
+    stream.data_format.data_item_format = BULKIO::VITA49_32F;
+    stream.data_format.repeating = false;
+    stream.data_format.event_tag_size = 0;
+    stream.data_format.channel_tag_size = 0;
+    stream.data_format.item_packing_field_size = 31;
+    stream.data_format.data_item_size = 31;
+    stream.data_format.repeat_count = 0;
+    stream.data_format.vector_size = 0;
+    return stream;
+}
+
+void PacketEngineTest::testSDDSHeader()
+{
+    bulkio::sdds::Header header;
+    header.startOfSequence = true;
+    header.complex = true;
+    header.bitsPerSample = 16;
+    header.sequence = 1234;
+    header.timeTagValid = true;
+    header.clockValid = true;
+    header.timeTag = 0x0123456789ABCDEFULL;
+    header.timeTagExtension = 0x89ABCDEF;
+    header.frequency = 5e6;
+
+    unsigned char packet[bulkio::sdds::PACKET_SIZE];
+    bulkio::sdds::formatHeader(header, packet);
+
+    // Fields are big-endian
+    CPPUNIT_ASSERT_EQUAL(0xC0, (int) packet[0]);
+    CPPUNIT_ASSERT_EQUAL(0x90, (int) packet[1]);
+    CPPUNIT_ASSERT_EQUAL(0x04, (int) packet[2]);
+    CPPUNIT_ASSERT_EQUAL(0xD2, (int) packet[3]);
+
+    bulkio::sdds::Header parsed;
+    CPPUNIT_ASSERT(bulkio::sdds::parseHeader(packet, sizeof(packet), parsed));
+    CPPUNIT_ASSERT(parsed.standardFormat);
+    CPPUNIT_ASSERT(parsed.startOfSequence);
+    CPPUNIT_ASSERT(parsed.complex);
+    CPPUNIT_ASSERT_EQUAL(16, parsed.bitsPerSample);
+    CPPUNIT_ASSERT_EQUAL(header.sequence, parsed.sequence);
+    CPPUNIT_ASSERT(parsed.timeTagValid);
+    CPPUNIT_ASSERT(parsed.clockValid);
+    CPPUNIT_ASSERT_EQUAL(header.timeTag, parsed.timeTag);
+    CPPUNIT_ASSERT_EQUAL(header.timeTagExtension, parsed.timeTagExtension);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(header.frequency, parsed.frequency, 1e-6);
+
+    // Truncated and non-standard packets are rejected
+    CPPUNIT_ASSERT(!bulkio::sdds::parseHeader(packet, bulkio::sdds::HEADER_SIZE - 1, parsed));
+    packet[0] &= 0x7F;
+    CPPUNIT_ASSERT(!bulkio::sdds::parseHeader(packet, sizeof(packet), parsed));
+}
+
+void PacketEngineTest::testSDDSSequence()
+{
+    // Parity packets (every 32nd) are skipped
+    CPPUNIT_ASSERT_EQUAL((uint16_t) 1, bulkio::sdds::nextSequence(0));
+    CPPUNIT_ASSERT_EQUAL((uint16_t) 32, bulkio::sdds::nextSequence(30));
+    CPPUNIT_ASSERT_EQUAL((uint16_t) 0, bulkio::sdds::nextSequence(65534));
+
+    CPPUNIT_ASSERT_EQUAL((size_t) 0, bulkio::sdds::sequenceGap(100, 100));
+    CPPUNIT_ASSERT_EQUAL((size_t) 2, bulkio::sdds::sequenceGap(100, 102));
+
+    // Gaps across parity packets and the wrap do not count them
+    CPPUNIT_ASSERT_EQUAL((size_t) 2, bulkio::sdds::sequenceGap(29, 32));
+    CPPUNIT_ASSERT_EQUAL((size_t) 1, bulkio::sdds::sequenceGap(65534, 0));
+}
+
+void PacketEngineTest::testSDDSTimeTag()
+{
+    BULKIO::PrecisionUTCTime now = bulkio::time::utils::now();
+    now.tcmode = BULKIO::TCM_SDDS;
+
+    uint64_t time_tag;
+    uint32_t extension;
+    bulkio::sdds::fromUTC(now, time_tag, extension);
+    BULKIO::PrecisionUTCTime result = bulkio::sdds::toUTC(time_tag, extension, now.twsec);
+    CPPUNIT_ASSERT_EQUAL(now.twsec, result.twsec);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(now.tfsec, result.tfsec, 1e-12);
+    CPPUNIT_ASSERT_EQUAL(BULKIO::TCM_SDDS, result.tcmode);
+    CPPUNIT_ASSERT_EQUAL(BULKIO::TCS_VALID, result.tcstatus);
+
+    // A time tag from the end of last year, received just after the new
+    // year, stays in the previous year (2017-12-31T23:59:59Z and
+    // 2018-01-01T00:00:01Z)
+    BULKIO::PrecisionUTCTime before = bulkio::time::utils::create(1514764799.0, 0.5);
+    bulkio::sdds::fromUTC(before, time_tag, extension);
+    result = bulkio::sdds::toUTC(time_tag, extension, 1514764801.0);
+    CPPUNIT_ASSERT_EQUAL(before.twsec, result.twsec);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(before.tfsec, result.tfsec, 1e-12);
+}
+
+void PacketEngineTest::testSDDSLoopback()
+{
+    BULKIO::SDDSStreamDefinition stream = sddsStream(0);
+    bulkio::sdds::Receiver receiver(stream);
+    bulkio::sdds::Sender sender(stream);
+    CPPUNIT_ASSERT_EQUAL(bulkio::net::FORMAT_INT16, sender.format());
+
+    // 10 full packets of complex shorts, plus a partial packet that is held
+    // back until the next write
+    const size_t samples_per_packet = bulkio::sdds::PAYLOAD_SIZE / sizeof(int16_t);
+    std::vector<float> data = makeData<float>(samples_per_packet * 10 + 100);
+    BULKIO::PrecisionUTCTime time = bulkio::time::utils::now();
+    const double xdelta = 1.0 / 5e6;
+    sender.write(&data[0], data.size(), true, time, xdelta);
+    sender.flush();
+    CPPUNIT_ASSERT_EQUAL((uint64_t) 10, sender.statistics().packets);
+
+    bulkio::net::PacketReceiver::BlockCallback callback = boost::bind(&PacketEngineTest::blockReceived, this, _1);
+    receivePackets(receiver, callback, 10);
+
+    std::vector<int16_t> result = receivedData<int16_t>();
+    CPPUNIT_ASSERT_EQUAL(samples_per_packet * 10, result.size());
+    for (size_t index = 0; index < result.size(); ++index) {
+        CPPUNIT_ASSERT_EQUAL((int16_t) data[index], result[index]);
+    }
+    CPPUNIT_ASSERT(!blocks.empty());
+    CPPUNIT_ASSERT(blocks[0].complex);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(xdelta, blocks[0].xdelta, 1e-15);
+    CPPUNIT_ASSERT_EQUAL(BULKIO::TCS_VALID, blocks[0].time.tcstatus);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, blocks[0].time - time, 1e-9);
+    CPPUNIT_ASSERT(!blocks[0].discontinuity);
+
+    // Completing the held-back packet sends it
+    sender.write(&data[0], samples_per_packet - 100, true, time, xdelta);
+    sender.flush();
+    receivePackets(receiver, callback, 1);
+    CPPUNIT_ASSERT_EQUAL(samples_per_packet * 11 * sizeof(int16_t), received.size());
+
+    // At the end of the stream, a partial packet is padded with zeros
+    sender.write(&data[0], 100, true, time, xdelta);
+    sender.flush();
+    CPPUNIT_ASSERT_EQUAL((uint64_t) 11, sender.statistics().packets);
+    sender.finish();
+    CPPUNIT_ASSERT_EQUAL((uint64_t) 12, sender.statistics().packets);
+    receivePackets(receiver, callback, 1);
+    result = receivedData<int16_t>();
+    CPPUNIT_ASSERT_EQUAL(samples_per_packet * 12, result.size());
+    for (size_t index = 0; index < samples_per_packet; ++index) {
+        int16_t expected = (index < 100) ? (int16_t) data[index] : 0;
+        CPPUNIT_ASSERT_EQUAL(expected, result[samples_per_packet * 11 + index]);
+    }
+
+    bulkio::net::PacketStatistics stats = receiver.statistics();
+    CPPUNIT_ASSERT_EQUAL((uint64_t) 12, stats.packets);
+    CPPUNIT_ASSERT_EQUAL((uint64_t) 0, stats.dropped);
+    CPPUNIT_ASSERT_EQUAL((uint64_t) 0, stats.invalid);
+}
+
+void PacketEngineTest::testSDDSDropped()
+{
+    BULKIO::SDDSStreamDefinition stream = sddsStream(1);
+    bulkio::sdds::Receiver receiver(stream);
+
+    // Send packets directly, skipping some sequence numbers and including a
+    // malformed packet
+    bulkio::net::UdpSocket socket;
+    socket.connect(MULTICAST_GROUP, stream.port);
+    const uint16_t sequences[] = { 10, 11, 14, 15 };
+    bulkio::net::PacketRing ring(5, bulkio::sdds::PACKET_SIZE);
+    for (size_t index = 0; index < 4; ++index) {
+        bulkio::sdds::Header header;
+        header.bitsPerSample = 16;
+        header.sequence = sequences[index];
+        bulkio::sdds::formatHeader(header, ring.buffer(index));
+        memset(ring.buffer(index) + bulkio::sdds::HEADER_SIZE, 0, bulkio::sdds::PAYLOAD_SIZE);
+        ring.setLength(index, bulkio::sdds::PACKET_SIZE);
+    }
+    ring.setLength(4, bulkio::sdds::HEADER_SIZE / 2);
+    CPPUNIT_ASSERT_EQUAL((size_t) 5, socket.send(ring, 5));
+
+    bulkio::net::PacketReceiver::BlockCallback callback = boost::bind(&PacketEngineTest::blockReceived, this, _1);
+    receivePackets(receiver, callback, 5);
+
+    bulkio::net::PacketStatistics stats = receiver.statistics();
+    CPPUNIT_ASSERT_EQUAL((uint64_t) 5, stats.packets);
+    CPPUNIT_ASSERT_EQUAL((uint64_t) 2, stats.dropped);
+    CPPUNIT_ASSERT_EQUAL((uint64_t) 1, stats.invalid);
+
+    // The gap splits the data into two blocks
+    CPPUNIT_ASSERT_EQUAL((size_t) 2, blocks.size());
+    CPPUNIT_ASSERT(!blocks[0].discontinuity);
+    CPPUNIT_ASSERT(blocks[1].discontinuity);
+    CPPUNIT_ASSERT(blocks[1].time.tcstatus != BULKIO::TCS_VALID);
+}
+
+void PacketEngineTest::testVRTHeader()
+{
+    bulkio::vrt::Header header;
+    header.packetType = bulkio::vrt::IF_DATA_STREAM_ID;
+    header.tsi = bulkio::vrt::TSI_UTC;
+    header.tsf = bulkio::vrt::TSF_REAL_TIME;
+    header.packetCount = 7;
+    header.streamID = 0xDEADBEEF;
+    header.integerSeconds = 1500000000;
+    header.fractionalSeconds = 250000000000ULL;
+    header.payloadBytes = 64;
+
+    unsigned char packet[128];
+    size_t offset = bulkio::vrt::formatHeader(header, packet);
+    CPPUNIT_ASSERT_EQUAL((size_t) 20, offset);
+
+    bulkio::vrt::Header parsed;
+    CPPUNIT_ASSERT(bulkio::vrt::parseHeader(packet, offset + header.payloadBytes, parsed));
+    CPPUNIT_ASSERT_EQUAL(header.packetType, parsed.packetType);
+    CPPUNIT_ASSERT_EQUAL(header.tsi, parsed.tsi);
+    CPPUNIT_ASSERT_EQUAL(header.tsf, parsed.tsf);
+    CPPUNIT_ASSERT_EQUAL(header.packetCount, parsed.packetCount);
+    CPPUNIT_ASSERT_EQUAL((size_t) 21, parsed.packetWords);
+    CPPUNIT_ASSERT_EQUAL(header.streamID, parsed.streamID);
+    CPPUNIT_ASSERT_EQUAL(header.integerSeconds, parsed.integerSeconds);
+    CPPUNIT_ASSERT_EQUAL(header.fractionalSeconds, parsed.fractionalSeconds);
+    CPPUNIT_ASSERT_EQUAL(offset, parsed.payloadOffset);
+    CPPUNIT_ASSERT_EQUAL(header.payloadBytes, parsed.payloadBytes);
+
+    // The packet size must fit in the received length
+    CPPUNIT_ASSERT(!bulkio::vrt::parseHeader(packet, offset + header.payloadBytes - 4, parsed));
+}
+
+void PacketEngineTest::testVRTContext()
+{
+    bulkio::vrt::Context context;
+    context.hasSampleRate = true;
+    context.sampleRate = 12.5e6;
+    context.hasFormat = true;
+    context.format = bulkio::net::FORMAT_INT16;
+    context.complex = true;
+
+    bulkio::vrt::Header header;
+    header.streamID = 1;
+    unsigned char packet[64];
+    size_t length = bulkio::vrt::formatContext(header, context, packet);
+
+    bulkio::vrt::Header parsed;
+    CPPUNIT_ASSERT(bulkio::vrt::parseHeader(packet, length, parsed));
+    CPPUNIT_ASSERT_EQUAL(bulkio::vrt::IF_CONTEXT, parsed.packetType);
+
+    bulkio::vrt::Context result;
+    CPPUNIT_ASSERT(bulkio::vrt::parseContext(packet, parsed, result));
+    CPPUNIT_ASSERT(result.hasSampleRate);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(context.sampleRate, result.sampleRate, 1e-6);
+    CPPUNIT_ASSERT(result.hasFormat);
+    CPPUNIT_ASSERT_EQUAL(context.format, result.format);
+    CPPUNIT_ASSERT(result.complex);
+
+    // Payload formats from stream definitions
+    BULKIO::VITA49StreamDefinition stream = vrtStream(0);
+    CPPUNIT_ASSERT_EQUAL(bulkio::net::FORMAT_FLOAT, bulkio::vrt::sampleFormat(stream.data_format));
+    stream.data_format.data_item_format = BULKIO::VITA49_16T;
+    CPPUNIT_ASSERT_EQUAL(bulkio::net::FORMAT_INT16, bulkio::vrt::sampleFormat(stream.data_format));
+    stream.data_format.data_item_format = BULKIO::VITA49_4P;
+    CPPUNIT_ASSERT_EQUAL(bulkio::net::FORMAT_INVALID, bulkio::vrt::sampleFormat(stream.data_format));
+}
+
+void PacketEngineTest::testVRTLoopback()
+{
+    BULKIO::VITA49StreamDefinition stream = vrtStream(2);
+    bulkio::vrt::Receiver receiver(stream);
+    bulkio::vrt::Sender sender(stream);
+
+    // The receiver does not know the format until the sender's initial
+    // context packet arrives
+    std::vector<float> data = makeData<float>(1000);
+    BULKIO::PrecisionUTCTime time = bulkio::time::utils::now();
+    const double xdelta = 1.0 / 1e6;
+    sender.write(&data[0], data.size(), false, time, xdelta);
+    sender.flush();
+
+    // One context packet, then 4000 bytes of data in 1024-byte payloads
+    bulkio::net::PacketReceiver::BlockCallback callback = boost::bind(&PacketEngineTest::blockReceived, this, _1);
+    receivePackets(receiver, callback, 5);
+
+    CPPUNIT_ASSERT(received.size() / sizeof(float) == data.size());
+    std::vector<float> result = receivedData<float>();
+    for (size_t index = 0; index < result.size(); ++index) {
+        CPPUNIT_ASSERT_EQUAL(data[index], result[index]);
+    }
+    CPPUNIT_ASSERT(!blocks.empty());
+    CPPUNIT_ASSERT_EQUAL(bulkio::net::FORMAT_FLOAT, blocks[0].format);
+    CPPUNIT_ASSERT(!blocks[0].complex);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(xdelta, blocks[0].xdelta, 1e-15);
+    CPPUNIT_ASSERT_EQUAL(time.twsec, blocks[0].time.twsec);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(time.tfsec, blocks[0].time.tfsec, 1e-11);
+
+    bulkio::net::PacketStatistics stats = receiver.statistics();
+    CPPUNIT_ASSERT_EQUAL((uint64_t) 5, stats.packets);
+    CPPUNIT_ASSERT_EQUAL((uint64_t) 0, stats.dropped);
+}
+
+void PacketEngineTest::testSendStream()
+{
+    BULKIO::VITA49StreamDefinition stream = vrtStream(3);
+    stream.data_format.data_item_format = BULKIO::VITA49_16T;
+    bulkio::vrt::Receiver receiver(stream);
+    bulkio::vrt::Sender sender(stream);
+
+    // Drain an input stream through the sender
+    bulkio::InFloatPort port("dataFloat_in");
+    BULKIO::StreamSRI sri = bulkio::sri::create("float_stream", 2e6);
+    port.pushSRI(sri);
+    bulkio::InFloatPort::PortSequenceType data;
+    data.length(512);
+    for (size_t index = 0; index < data.length(); ++index) {
+        data[index] = index;
+    }
+    port.pushPacket(data, bulkio::time::utils::now(), false, "float_stream");
+
+    bulkio::InFloatStream input = port.getStream("float_stream");
+    CPPUNIT_ASSERT_EQUAL((size_t) 512, sender.send(input));
+    CPPUNIT_ASSERT_EQUAL((size_t) 0, sender.send(input));
+
+    bulkio::net::PacketReceiver::BlockCallback callback = boost::bind(&PacketEngineTest::blockReceived, this, _1);
+    receivePackets(receiver, callback, 2);
+
+    std::vector<int16_t> result = receivedData<int16_t>();
+    CPPUNIT_ASSERT_EQUAL((size_t) 512, result.size());
+    for (size_t index = 0; index < result.size(); ++index) {
+        CPPUNIT_ASSERT_EQUAL((int16_t) index, result[index]);
+    }
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(sri.xdelta, blocks[0].xdelta, 1e-15);
+}
+
+void PacketEngineTest::testReceiveThread()
+{
+    BULKIO::SDDSStreamDefinition stream = sddsStream(4);
+    bulkio::sdds::Receiver receiver(stream);
+    bulkio::sdds::Sender sender(stream);
+
+    receiver.start(boost::bind(&PacketEngineTest::blockReceived, this, _1));
+    CPPUNIT_ASSERT(receiver.isRunning());
+
+    const size_t samples = bulkio::sdds::PAYLOAD_SIZE / sizeof(int16_t) * 4;
+    std::vector<int16_t> data = makeData<int16_t>(samples);
+    sender.write(&data[0], data.size(), true, bulkio::time::utils::now(), 1e-6);
+    sender.flush();
+
+    for (int tries = 0; (tries < 100) && (receiver.statistics().packets < 4); ++tries) {
+        boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+    }
+    receiver.stop();
+    CPPUNIT_ASSERT(!receiver.isRunning());
+    CPPUNIT_ASSERT_EQUAL(samples * sizeof(int16_t), received.size());
+}
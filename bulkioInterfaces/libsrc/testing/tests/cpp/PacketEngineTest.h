@@ -0,0 +1,73 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK bulkioInterfaces.
+ *
+ * REDHAWK bulkioInterfaces is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK bulkioInterfaces is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+#ifndef BULKIO_PACKETENGINETEST_H
+#define BULKIO_PACKETENGINETEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "bulkio.h"
+#include "bulkio_packet_engine.h"
+
+class PacketEngineTest : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE(PacketEngineTest);
+    CPPUNIT_TEST(testSDDSHeader);
+    CPPUNIT_TEST(testSDDSSequence);
+    CPPUNIT_TEST(testSDDSTimeTag);
+    CPPUNIT_TEST(testSDDSLoopback);
+    CPPUNIT_TEST(testSDDSDropped);
+    CPPUNIT_TEST(testVRTHeader);
+    CPPUNIT_TEST(testVRTContext);
+    CPPUNIT_TEST(testVRTLoopback);
+    CPPUNIT_TEST(testSendStream);
+    CPPUNIT_TEST(testReceiveThread);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp();
+    void tearDown();
+
+    void testSDDSHeader();
+    void testSDDSSequence();
+    void testSDDSTimeTag();
+    void testSDDSLoopback();
+    void testSDDSDropped();
+    void testVRTHeader();
+    void testVRTContext();
+    void testVRTLoopback();
+    void testSendStream();
+    void testReceiveThread();
+
+private:
+    void blockReceived(const bulkio::net::PacketBlock& block);
+
+    template <typename T>
+    std::vector<T> receivedData() const;
+
+    // Each test uses its own port so that packets from one test cannot be
+    // received by another
+    BULKIO::SDDSStreamDefinition sddsStream(unsigned short port) const;
+    BULKIO::VITA49StreamDefinition vrtStream(unsigned short port) const;
+
+    std::vector<bulkio::net::PacketBlock> blocks;
+    std::vector<unsigned char> received;
+};
+
+#endif  // BULKIO_PACKETENGINETEST_H
@@ -0,0 +1,243 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK bulkioInterfaces.
+ *
+ * REDHAWK bulkioInterfaces is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK bulkioInterfaces is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#include "StreamSelectorTest.h"
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+CPPUNIT_TEST_SUITE_REGISTRATION(StreamSelectorTest);
+
+namespace {
+    // Wakeups only affect a select that is already waiting, so give the
+    // test thread time to block first
+    void delayedInterrupt(bulkio::StreamSelector* selector)
+    {
+        boost::this_thread::sleep(boost::posix_time::milliseconds(50));
+        selector->interrupt();
+    }
+
+    void delayedStop(bulkio::InShortPort* port)
+    {
+        boost::this_thread::sleep(boost::posix_time::milliseconds(50));
+        port->stopPort();
+    }
+
+    void selectUntilInterrupted(bulkio::StreamSelector* selector)
+    {
+        while (!boost::this_thread::interruption_requested()) {
+            selector->select(bulkio::Const::NON_BLOCKING);
+        }
+    }
+}
+
+void StreamSelectorTest::setUp()
+{
+    floatPort = new bulkio::InFloatPort("dataFloat_in");
+    shortPort = new bulkio::InShortPort("dataShort_in");
+}
+
+void StreamSelectorTest::tearDown()
+{
+    delete floatPort;
+    delete shortPort;
+}
+
+template <class Port>
+void StreamSelectorTest::pushData(Port* port, const std::string& streamID, size_t length)
+{
+    typename Port::PortSequenceType data;
+    data.length(length);
+    port->pushPacket(data, bulkio::time::utils::now(), false, streamID.c_str());
+}
+
+void StreamSelectorTest::testSelect()
+{
+    floatPort->pushSRI(bulkio::sri::create("float_stream"));
+    shortPort->pushSRI(bulkio::sri::create("short_stream"));
+
+    // Data queued before the port is added is found immediately
+    pushData(floatPort, "float_stream", 16);
+    bulkio::StreamSelector selector;
+    selector.add(floatPort);
+    selector.add(shortPort);
+
+    bulkio::StreamSelector::ReadyList ready = selector.select(bulkio::Const::NON_BLOCKING);
+    CPPUNIT_ASSERT_EQUAL((size_t) 1, ready.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("float_stream"), ready[0].streamID());
+    CPPUNIT_ASSERT(ready[0].from(floatPort));
+    CPPUNIT_ASSERT(!ready[0].from(shortPort));
+    CPPUNIT_ASSERT(!ready[0].stream(shortPort));
+
+    // The stream is the port's stream, and stays ready until it is read
+    bulkio::InFloatStream stream = ready[0].stream(floatPort);
+    CPPUNIT_ASSERT(stream == floatPort->getStream("float_stream"));
+    CPPUNIT_ASSERT_EQUAL((size_t) 1, selector.select(bulkio::Const::NON_BLOCKING).size());
+    bulkio::InFloatStream::DataBlockType block = stream.read();
+    CPPUNIT_ASSERT_EQUAL((size_t) 16, block.size());
+    CPPUNIT_ASSERT(selector.select(bulkio::Const::NON_BLOCKING).empty());
+
+    // Streams on different port types are both returned
+    pushData(floatPort, "float_stream", 16);
+    pushData(shortPort, "short_stream", 16);
+    ready = selector.select(bulkio::Const::NON_BLOCKING);
+    CPPUNIT_ASSERT_EQUAL((size_t) 2, ready.size());
+}
+
+void StreamSelectorTest::testPriority()
+{
+    floatPort->pushSRI(bulkio::sri::create("float_stream"));
+    shortPort->pushSRI(bulkio::sri::create("short_stream"));
+
+    bulkio::StreamSelector selector;
+    selector.add(floatPort);
+    selector.add(shortPort, 1);
+
+    // The higher priority port comes first, regardless of arrival order
+    pushData(floatPort, "float_stream", 16);
+    pushData(shortPort, "short_stream", 16);
+    bulkio::StreamSelector::ReadyList ready = selector.select(bulkio::Const::NON_BLOCKING);
+    CPPUNIT_ASSERT_EQUAL((size_t) 2, ready.size());
+    CPPUNIT_ASSERT(ready[0].from(shortPort));
+    CPPUNIT_ASSERT_EQUAL(1, ready[0].priority());
+    CPPUNIT_ASSERT(ready[1].from(floatPort));
+
+    // Adding the port again changes its priority
+    selector.add(floatPort, 2);
+    ready = selector.select(bulkio::Const::NON_BLOCKING);
+    CPPUNIT_ASSERT_EQUAL((size_t) 2, ready.size());
+    CPPUNIT_ASSERT(ready[0].from(floatPort));
+}
+
+void StreamSelectorTest::testRoundRobin()
+{
+    bulkio::StreamSelector selector;
+    selector.add(floatPort);
+
+    const char* stream_ids[] = { "stream_a", "stream_b", "stream_c" };
+    for (size_t index = 0; index < 3; ++index) {
+        floatPort->pushSRI(bulkio::sri::create(stream_ids[index]));
+        pushData(floatPort, stream_ids[index], 16);
+    }
+
+    // With every stream always ready, next() cycles through them
+    bulkio::StreamSelector::ReadyStream ready;
+    std::vector<std::string> order;
+    for (size_t index = 0; index < 6; ++index) {
+        CPPUNIT_ASSERT(selector.next(ready, bulkio::Const::NON_BLOCKING));
+        order.push_back(ready.streamID());
+    }
+    for (size_t index = 0; index < 3; ++index) {
+        CPPUNIT_ASSERT(order[index] != order[(index + 1) % 3]);
+        CPPUNIT_ASSERT_EQUAL(order[index], order[index + 3]);
+    }
+
+    // A stream that becomes ready after being idle goes ahead of the ones
+    // that were serviced in the meantime
+    bulkio::InFloatStream stream = floatPort->getStream(order[0]);
+    stream.read();
+    CPPUNIT_ASSERT(selector.next(ready, bulkio::Const::NON_BLOCKING));
+    CPPUNIT_ASSERT(selector.next(ready, bulkio::Const::NON_BLOCKING));
+    pushData(floatPort, order[0], 16);
+    CPPUNIT_ASSERT(selector.next(ready, bulkio::Const::NON_BLOCKING));
+    CPPUNIT_ASSERT_EQUAL(order[0], ready.streamID());
+}
+
+void StreamSelectorTest::testSamples()
+{
+    floatPort->pushSRI(bulkio::sri::create("float_stream"));
+    bulkio::StreamSelector selector;
+    selector.add(floatPort);
+
+    pushData(floatPort, "float_stream", 16);
+    CPPUNIT_ASSERT(selector.select(32, bulkio::Const::NON_BLOCKING).empty());
+    pushData(floatPort, "float_stream", 16);
+    CPPUNIT_ASSERT_EQUAL((size_t) 1, selector.select(32, bulkio::Const::NON_BLOCKING).size());
+}
+
+void StreamSelectorTest::testWakeup()
+{
+    floatPort->pushSRI(bulkio::sri::create("float_stream"));
+    bulkio::StreamSelector selector;
+    selector.add(floatPort);
+    selector.add(shortPort);
+
+    // Timeout with no data
+    CPPUNIT_ASSERT(selector.select(0.05).empty());
+
+    // Data arriving from another thread wakes the selector
+    boost::thread pusher(boost::bind(&StreamSelectorTest::pushData<bulkio::InFloatPort>,
+                                     this, floatPort, std::string("float_stream"), 16));
+    bulkio::StreamSelector::ReadyList ready = selector.select(5.0);
+    pusher.join();
+    CPPUNIT_ASSERT_EQUAL((size_t) 1, ready.size());
+    floatPort->getStream("float_stream").read();
+
+    // Stopping a port or interrupting the selector also wakes it
+    boost::thread stopper(boost::bind(&delayedStop, shortPort));
+    CPPUNIT_ASSERT(selector.select(5.0).empty());
+    stopper.join();
+
+    boost::thread interrupter(boost::bind(&delayedInterrupt, &selector));
+    CPPUNIT_ASSERT(selector.select(5.0).empty());
+    interrupter.join();
+
+    // An interrupt with no select in progress is not remembered
+    selector.interrupt();
+    boost::system_time start = boost::get_system_time();
+    CPPUNIT_ASSERT(selector.select(0.1).empty());
+    CPPUNIT_ASSERT((boost::get_system_time() - start) >= boost::posix_time::milliseconds(90));
+}
+
+void StreamSelectorTest::testRemove()
+{
+    floatPort->pushSRI(bulkio::sri::create("float_stream"));
+    bulkio::StreamSelector selector;
+    selector.add(floatPort);
+    pushData(floatPort, "float_stream", 16);
+    selector.remove(floatPort);
+    CPPUNIT_ASSERT(selector.select(bulkio::Const::NON_BLOCKING).empty());
+
+    // Destroying a port removes it from the selector
+    bulkio::InDoublePort* port = new bulkio::InDoublePort("dataDouble_in");
+    port->pushSRI(bulkio::sri::create("double_stream"));
+    selector.add(port);
+    pushData(port, "double_stream", 16);
+    delete port;
+    CPPUNIT_ASSERT(selector.select(bulkio::Const::NON_BLOCKING).empty());
+}
+
+void StreamSelectorTest::testDestroyWhileSelecting()
+{
+    // Ports are destroyed while another thread is checking their streams;
+    // each port must leave the selector before its streams are torn down
+    bulkio::StreamSelector selector;
+    boost::thread selecting(&selectUntilInterrupted, &selector);
+    for (int iteration = 0; iteration < 100; ++iteration) {
+        bulkio::InDoublePort* port = new bulkio::InDoublePort("dataDouble_in");
+        port->pushSRI(bulkio::sri::create("double_stream"));
+        selector.add(port);
+        pushData(port, "double_stream", 16);
+        delete port;
+    }
+    selecting.interrupt();
+    selecting.join();
+    CPPUNIT_ASSERT(selector.select(bulkio::Const::NON_BLOCKING).empty());
+}
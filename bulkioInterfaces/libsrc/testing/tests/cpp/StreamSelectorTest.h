@@ -0,0 +1,59 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK bulkioInterfaces.
+ *
+ * REDHAWK bulkioInterfaces is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK bulkioInterfaces is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+#ifndef BULKIO_STREAMSELECTORTEST_H
+#define BULKIO_STREAMSELECTORTEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "bulkio.h"
+
+class StreamSelectorTest : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE(StreamSelectorTest);
+    CPPUNIT_TEST(testSelect);
+    CPPUNIT_TEST(testPriority);
+    CPPUNIT_TEST(testRoundRobin);
+    CPPUNIT_TEST(testSamples);
+    CPPUNIT_TEST(testWakeup);
+    CPPUNIT_TEST(testRemove);
+    CPPUNIT_TEST(testDestroyWhileSelecting);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp();
+    void tearDown();
+
+    void testSelect();
+    void testPriority();
+    void testRoundRobin();
+    void testSamples();
+    void testWakeup();
+    void testRemove();
+    void testDestroyWhileSelecting();
+
+private:
+    template <class Port>
+    void pushData(Port* port, const std::string& streamID, size_t length);
+
+    bulkio::InFloatPort* floatPort;
+    bulkio::InShortPort* shortPort;
+};
+
+#endif  // BULKIO_STREAMSELECTORTEST_H
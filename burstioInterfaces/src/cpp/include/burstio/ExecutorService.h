@@ -99,38 +99,7 @@ namespace burstio {
         typedef std::pair<boost::system_time,func_type> task_type;
         typedef std::list<task_type> task_queue;
 
-        void run ()
-        {
-            boost::mutex::scoped_lock lock(mutex_);
-            while (running_) {
-                while (!queue_.empty()) {
-                    // Start at the front of the queue every time--a task may
-                    // have been added while the lock was released to service
-                    // the last task
-                    task_queue::iterator task = queue_.begin();
-                    if (task->first > boost::get_system_time()) {
-                        // Head of queue is scheduled in the future
-                        break;
-                    }
-
-                    // Copy the task's function and remove it from the queue
-                    func_type func = task->second;
-                    queue_.erase(task);
-
-                    // Run task with the lock released
-                    lock.unlock();
-                    func();
-                    lock.lock();
-                }
-
-                if (queue_.empty()) {
-                    cond_.wait(lock);
-                } else {
-                    boost::system_time when = queue_.front().first;
-                    cond_.timed_wait(lock, when);
-                }
-            }
-        }
+        void run ();
 
         void insert_sorted (func_type func, boost::system_time when=boost::get_system_time())
         {
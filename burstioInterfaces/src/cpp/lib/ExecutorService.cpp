@@ -0,0 +1,62 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK burstioInterfaces.
+ *
+ * REDHAWK burstioInterfaces is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK burstioInterfaces is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#include <burstio/ExecutorService.h>
+
+#include <ossie/affinity.h>
+
+namespace burstio {
+
+    void ExecutorService::run ()
+    {
+        redhawk::affinity::set_thread_affinity(redhawk::affinity::PORT_MONITOR);
+
+        boost::mutex::scoped_lock lock(mutex_);
+        while (running_) {
+            while (!queue_.empty()) {
+                // Start at the front of the queue every time--a task may
+                // have been added while the lock was released to service
+                // the last task
+                task_queue::iterator task = queue_.begin();
+                if (task->first > boost::get_system_time()) {
+                    // Head of queue is scheduled in the future
+                    break;
+                }
+
+                // Copy the task's function and remove it from the queue
+                func_type func = task->second;
+                queue_.erase(task);
+
+                // Run task with the lock released
+                lock.unlock();
+                func();
+                lock.lock();
+            }
+
+            if (queue_.empty()) {
+                cond_.wait(lock);
+            } else {
+                boost::system_time when = queue_.front().first;
+                cond_.timed_wait(lock, when);
+            }
+        }
+    }
+
+}
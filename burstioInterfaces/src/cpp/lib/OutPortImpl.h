@@ -21,6 +21,7 @@
 #define BURSTIO_OUTPORTIMPL_H
 
 #include <burstio/utils.h>
+#include <ossie/tracing.h>
 
 #include "debug_impl.h"
 
@@ -96,6 +97,7 @@ namespace burstio {
                                          const BULKIO::PrecisionUTCTime& timestamp, bool eos,
                                          bool isComplex)
     {
+        RH_TRACE_SPAN("burstio", "OutPort::queueBurst");
         boost::mutex::scoped_lock lock(mutex_);
         // If this is the first burst, mark the time for latency guarantees
         if (bursts_.length() == 0) {
@@ -356,6 +358,7 @@ namespace burstio {
     void OutPort<Traits>::sendBursts(const BurstSequenceType& bursts, boost::system_time startTime, float queueDepth, const std::string& streamID)
     {
         //LOG_INSTANCE_DEBUG("Sending " << bursts.length() << " bursts");
+        RH_TRACE_SPAN("burstio", "OutPort::sendBursts");
 
         // Count up total elements
         size_t total_elements = 0;
@@ -376,6 +379,7 @@ namespace burstio {
             boost::posix_time::time_duration delay = boost::get_system_time() - startTime;
 
             try {
+                RH_TRACE_SPAN("burstio", "OutPort::pushBursts");
                 connection.port->pushBursts(bursts);
                 connection.info->alive = true;
                 connection.info->stats.record(bursts.length(), total_elements, queueDepth, delay.total_microseconds() * 1e-6);
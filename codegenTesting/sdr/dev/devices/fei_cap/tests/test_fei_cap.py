@@ -1,5 +1,6 @@
 #!/usr/bin/env python
 
+import threading
 import ossie.utils.testing
 from ossie.utils import sb
 import frontend
@@ -65,6 +66,90 @@ class DeviceTests(ossie.utils.testing.RHTestCase):
         self.comp.deallocateCapacity([a])
         self.assertEquals(self.comp._get_usageState(), CF.Device.IDLE)
 
+    def _allocations(self):
+        return [status.allocation_id_csv for status in self.comp.frontend_tuner_status]
+
+    def testBatchAllocation(self):
+        a=frontend.createTunerAllocation(tuner_type='RX_DIGITIZER',allocation_id='1',returnDict=False)
+        b=frontend.createTunerAllocation(tuner_type='RX_DIGITIZER',allocation_id='2',returnDict=False)
+        c=frontend.createTunerAllocation(tuner_type='RX_DIGITIZER',allocation_id='3',returnDict=False)
+        l=frontend.createTunerListenerAllocation('1',listener_allocation_id='listener',returnDict=False)
+
+        # Every request in the batch is allocated
+        self.assertEquals(self.comp.allocateCapacity([a, b]), True)
+        self.assertEquals(self.comp._get_usageState(), CF.Device.BUSY)
+        self.comp.deallocateCapacity([a, b])
+        self.assertEquals(self.comp._get_usageState(), CF.Device.IDLE)
+
+        # A request later in the batch may depend on an earlier one
+        self.assertEquals(self.comp.allocateCapacity([a, l]), True)
+        self.assertEquals(sorted(self._allocations()), ['', '1,listener'])
+        self.comp.deallocateCapacity([l, a])
+        self.assertEquals(self.comp._get_usageState(), CF.Device.IDLE)
+
+        # If any request fails, the ones allocated before it are released
+        self.assertEquals(self.comp.allocateCapacity([a, b, c]), False)
+        self.assertEquals(self.comp._get_usageState(), CF.Device.IDLE)
+        self.assertEquals(self._allocations(), ['', ''])
+
+    def testAllocationIndices(self):
+        a=frontend.createTunerAllocation(tuner_type='RX_DIGITIZER',allocation_id='1',returnDict=False)
+        self.assertEquals(self.comp.allocateCapacity([a]), True)
+
+        # Allocation ids are unique, across tuner and listener allocations
+        self.assertRaises(CF.Device.InvalidCapacity, self.comp.allocateCapacity, [a])
+        l=frontend.createTunerListenerAllocation('1',listener_allocation_id='1',returnDict=False)
+        self.assertRaises(CF.Device.InvalidCapacity, self.comp.allocateCapacity, [l])
+        l=frontend.createTunerListenerAllocation('unknown',listener_allocation_id='listener',returnDict=False)
+        self.assertEquals(self.comp.allocateCapacity([l]), False)
+        unknown=frontend.createTunerAllocation(tuner_type='RX_DIGITIZER',allocation_id='unknown',returnDict=False)
+        self.assertRaises(CF.Device.InvalidCapacity, self.comp.deallocateCapacity, [unknown])
+
+        # Tuners are matched by type, group and RF flow
+        for kwargs in ({'tuner_type':'CHANNELIZER'},
+                       {'tuner_type':'RX_DIGITIZER', 'group_id':'missing'},
+                       {'tuner_type':'RX_DIGITIZER', 'rf_flow_id':'missing'}):
+            request=frontend.createTunerAllocation(allocation_id='2',returnDict=False,**kwargs)
+            self.assertEquals(self.comp.allocateCapacity([request]), False, str(kwargs))
+        self.assertEquals(self.comp._get_usageState(), CF.Device.ACTIVE)
+
+        # The index is kept current as tuners are released and reallocated
+        self.comp.deallocateCapacity([a])
+        self.assertEquals(self.comp.allocateCapacity([a]), True)
+        self.comp.deallocateCapacity([a])
+        self.assertEquals(self.comp._get_usageState(), CF.Device.IDLE)
+
+    def testConcurrentAllocation(self):
+        # More requests than tuners, issued at the same time: each tuner goes
+        # to exactly one of them
+        requests = [frontend.createTunerAllocation(tuner_type='RX_DIGITIZER',allocation_id=str(ii),returnDict=False) for ii in range(16)]
+        results = {}
+        start = threading.Event()
+        def allocate(alloc_id):
+            start.wait()
+            results[alloc_id] = self.comp.allocateCapacity([requests[alloc_id]])
+        threads = [threading.Thread(target=allocate, args=(ii,)) for ii in range(len(requests))]
+        for thread in threads:
+            thread.start()
+        start.set()
+        for thread in threads:
+            thread.join()
+
+        allocated = sorted(alloc_id for alloc_id, result in results.items() if result)
+        self.assertEquals(len(results), len(requests))
+        self.assertEquals(len(allocated), 2)
+        self.assertEquals(sorted(self._allocations()), sorted(str(alloc_id) for alloc_id in allocated))
+        self.assertEquals(self.comp._get_usageState(), CF.Device.BUSY)
+
+        # Concurrent deallocations release every tuner
+        threads = [threading.Thread(target=self.comp.deallocateCapacity, args=([requests[alloc_id]],)) for alloc_id in allocated]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+        self.assertEquals(self.comp._get_usageState(), CF.Device.IDLE)
+        self.assertEquals(self._allocations(), ['', ''])
+
     def testRFInfo(self):
         _port = None
         for port in self.comp.ports:
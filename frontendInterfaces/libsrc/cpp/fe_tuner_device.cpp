@@ -19,6 +19,7 @@
  */
 #include "fe_tuner_device.h"
 #include <exception>
+#include <algorithm>
 
 namespace frontend {
     template < typename TunerStatusStructType > 
@@ -254,6 +255,9 @@ namespace frontend {
     void FrontendTunerDevice<TunerStatusStructType>::construct()
     {
         Resource_impl::_started = false;
+        indexed_tuners = 0;
+        tuner_index_stale = true;
+        concurrent_tuner_allocation = true;
         loadProperties();
     }
 
@@ -365,10 +369,18 @@ namespace frontend {
     template < typename TunerStatusStructType >
     CORBA::Boolean FrontendTunerDevice<TunerStatusStructType>::allocateCapacity(const CF::Properties & capacities)
     throw (CORBA::SystemException, CF::Device::InvalidCapacity, CF::Device::InvalidState) {
-        if (this->tuner_allocation_ids.size() != this->frontend_tuner_status.size()) {
-            this->tuner_allocation_ids.resize(this->frontend_tuner_status.size());
-        }
         LOG_TRACE(FrontendTunerDevice<TunerStatusStructType>,__PRETTY_FUNCTION__);
+        boost::recursive_mutex::scoped_lock serialize_lock(tuning_lock, boost::defer_lock);
+        if (!concurrent_tuner_allocation) {
+            serialize_lock.lock();
+        }
+
+        resizeTunerState();
+        boost::shared_lock<boost::shared_mutex> state_lock(tuner_state_lock);
+
+        // Every request in capacities must be satisfied; the requests allocated so far are kept so that they
+        // can be released if a later one fails
+        CF::Properties allocated;
         CORBA::ULong ii;
         try{
             for (ii = 0; ii < capacities.length(); ++ii) {
@@ -382,223 +394,334 @@ namespace frontend {
                     LOG_DEBUG(FrontendTunerDevice<TunerStatusStructType>, "UNKNOWN PROPERTY");
                     throw CF::Device::InvalidCapacity("UNKNOWN PROPERTY", capacities);
                 }
+                // The request is parsed into the property member, then copied so that it is not changed by
+                // concurrent requests
+                frontend_tuner_allocation_struct tuner_request;
+                frontend_listener_allocation_struct listener_request;
                 try{
+                    boost::recursive_mutex::scoped_lock parse_lock(tuning_lock);
                     property->setValue(capacities[ii].value);
+                    tuner_request = frontend_tuner_allocation;
+                    listener_request = frontend_listener_allocation;
                 }
                 catch(const std::logic_error &e){
                     LOG_DEBUG(FrontendTunerDevice<TunerStatusStructType>, "COULD NOT PARSE CAPACITY: " << e.what());
                     throw CF::Device::InvalidCapacity("COULD NOT PARSE CAPACITY", capacities);
                 };
                 if (id == "FRONTEND::tuner_allocation"){
-                    // Check allocation_id
-                    if (frontend_tuner_allocation.allocation_id.empty()) {
-                        LOG_INFO(FrontendTunerDevice<TunerStatusStructType>,"allocateCapacity: MISSING ALLOCATION_ID");
-                        throw CF::Device::InvalidCapacity("MISSING ALLOCATION_ID", capacities);
-                    }
-                    // Check if allocation ID has already been used
-                    if(getTunerMapping(frontend_tuner_allocation.allocation_id) >= 0){
-                        LOG_INFO(FrontendTunerDevice<TunerStatusStructType>,"allocateCapacity: ALLOCATION_ID ALREADY IN USE: [" << frontend_tuner_allocation.allocation_id << "]");
-                        throw AllocationAlreadyExists("ALLOCATION_ID ALREADY IN USE", capacities);
-                    }
-
-                    // Check if available tuner
-                    exclusive_lock lock(allocation_id_mapping_lock);
-
-                    // Next, try to allocate a new tuner
-                    for (size_t tuner_id = 0; tuner_id < tuner_allocation_ids.size(); tuner_id++) {
-                        if(frontend_tuner_status[tuner_id].tuner_type != frontend_tuner_allocation.tuner_type) {
-                            LOG_DEBUG(FrontendTunerDevice<TunerStatusStructType>,
-                              "allocateCapacity: Requested tuner type '"<<frontend_tuner_allocation.tuner_type <<"' does not match tuner[" << tuner_id << "].tuner_type ("<<frontend_tuner_status[tuner_id].tuner_type<<")");
-                            continue;
-                        }
-
-                        if(!frontend_tuner_allocation.group_id.empty() && frontend_tuner_allocation.group_id != frontend_tuner_status[tuner_id].group_id ){
-                            LOG_DEBUG(FrontendTunerDevice<TunerStatusStructType>,
-                              "allocateCapacity: Requested group_id '"<<frontend_tuner_allocation.group_id <<"' does not match tuner[" << tuner_id << "].group_id ("<<frontend_tuner_status[tuner_id].group_id<<")");
-                            continue;
-                        }
-
-                        // special case because allocation is specifying the input stream, which determines the rf_flow_id, etc.
-                        if(!frontend_tuner_allocation.rf_flow_id.empty()
-                            && frontend_tuner_allocation.rf_flow_id != frontend_tuner_status[tuner_id].rf_flow_id
-                            && frontend_tuner_allocation.tuner_type != "CHANNELIZER"){
-                            LOG_DEBUG(FrontendTunerDevice<TunerStatusStructType>,
-                              "allocateCapacity: Requested rf_flow_id '"<<frontend_tuner_allocation.rf_flow_id <<"' does not match tuner[" << tuner_id << "].rf_flow_id ("<<frontend_tuner_status[tuner_id].rf_flow_id<<")");
-                            continue;
-                        }
-
-                        if(frontend_tuner_allocation.device_control){
-                            double orig_bw = frontend_tuner_status[tuner_id].bandwidth;
-                            double orig_cf = frontend_tuner_status[tuner_id].center_frequency;
-                            double orig_sr = frontend_tuner_status[tuner_id].sample_rate;
-                            // pre-load frontend_tuner_status values (just in case the request is filled but the values are not populated)
-                            frontend_tuner_status[tuner_id].bandwidth = frontend_tuner_allocation.bandwidth;
-                            frontend_tuner_status[tuner_id].center_frequency = frontend_tuner_allocation.center_frequency;
-                            frontend_tuner_status[tuner_id].sample_rate = frontend_tuner_allocation.sample_rate;
-                            // device control
-                            if(!tuner_allocation_ids[tuner_id].control_allocation_id.empty() || !deviceSetTuning(frontend_tuner_allocation, frontend_tuner_status[tuner_id], tuner_id)){
-                                if (frontend_tuner_status[tuner_id].bandwidth == frontend_tuner_allocation.bandwidth)
-                                    frontend_tuner_status[tuner_id].bandwidth = orig_bw;
-                                if (frontend_tuner_status[tuner_id].center_frequency == frontend_tuner_allocation.center_frequency)
-                                    frontend_tuner_status[tuner_id].center_frequency = orig_cf;
-                                if (frontend_tuner_status[tuner_id].sample_rate == frontend_tuner_allocation.sample_rate)
-                                    frontend_tuner_status[tuner_id].sample_rate = orig_sr;
-                                // either not available or didn't succeed setting tuning, try next tuner
-                                LOG_DEBUG(FrontendTunerDevice<TunerStatusStructType>,
-                                    "allocateCapacity: Tuner["<<tuner_id<<"] is either not available or didn't succeed while setting tuning ");
-                                continue;
-                            }
-                            tuner_allocation_ids[tuner_id].control_allocation_id = frontend_tuner_allocation.allocation_id;
-                            allocation_id_to_tuner_id.insert(std::pair<std::string, size_t > (frontend_tuner_allocation.allocation_id, tuner_id));
-                            frontend_tuner_status[tuner_id].allocation_id_csv = createAllocationIdCsv(tuner_id);
-                        } else {
-                            // channelizer allocations must specify device control = true
-                            if(frontend_tuner_allocation.tuner_type == "CHANNELIZER" || frontend_tuner_allocation.tuner_type == "TX"){
-                                std::ostringstream eout;
-                                eout<<frontend_tuner_allocation.tuner_type<<" allocation with device_control=false is invalid.";
-                                LOG_DEBUG(FrontendTunerDevice<TunerStatusStructType>, eout.str());
-                                throw CF::Device::InvalidCapacity(eout.str().c_str(), capacities);
-                            }
-                            // listener
-                            if(tuner_allocation_ids[tuner_id].control_allocation_id.empty() || !listenerRequestValidation(frontend_tuner_allocation, tuner_id)){
-                                // either not allocated or can't support listener request
-                                LOG_DEBUG(FrontendTunerDevice<TunerStatusStructType>,
-                                    "allocateCapacity: Tuner["<<tuner_id<<"] is either not available or can not support listener request ");
-                                continue;
-                            }
-                            tuner_allocation_ids[tuner_id].listener_allocation_ids.push_back(frontend_tuner_allocation.allocation_id);
-                            allocation_id_to_tuner_id.insert(std::pair<std::string, size_t > (frontend_tuner_allocation.allocation_id, tuner_id));
-                            frontend_tuner_status[tuner_id].allocation_id_csv = createAllocationIdCsv(tuner_id);
-                            this->assignListener(frontend_tuner_allocation.allocation_id,tuner_allocation_ids[tuner_id].control_allocation_id);
-                        }
-                        // if we've reached here, we found an eligible tuner with correct frequency
-
-                        // check tolerances
-                        // only check when sample_rate was not set to don't care)
-                        LOG_DEBUG(FrontendTunerDevice<TunerStatusStructType>, std::fixed << " allocateCapacity - SR requested: " << frontend_tuner_allocation.sample_rate
-                                                                                                           << "  SR got: " << frontend_tuner_status[tuner_id].sample_rate);
-                        if( (floatingPointCompare(frontend_tuner_allocation.sample_rate,0)!=0) &&
-                            (floatingPointCompare(frontend_tuner_status[tuner_id].sample_rate,frontend_tuner_allocation.sample_rate)<0 ||
-                            floatingPointCompare(frontend_tuner_status[tuner_id].sample_rate,frontend_tuner_allocation.sample_rate+frontend_tuner_allocation.sample_rate * frontend_tuner_allocation.sample_rate_tolerance/100.0)>0 )){
-                            std::ostringstream eout;
-                            eout<<std::fixed<<"allocateCapacity("<<int(tuner_id)<<"): returned sr "<<frontend_tuner_status[tuner_id].sample_rate<<" does not meet tolerance criteria of "<<frontend_tuner_allocation.sample_rate_tolerance<<" percent";
-                            LOG_INFO(FrontendTunerDevice<TunerStatusStructType>, eout.str());
-                            throw std::logic_error(eout.str().c_str());
-                        }
-                        LOG_DEBUG(FrontendTunerDevice<TunerStatusStructType>, std::fixed << " allocateCapacity - BW requested: " << frontend_tuner_allocation.bandwidth
-                                                                                                           << "  BW got: " << frontend_tuner_status[tuner_id].bandwidth);
-                        // Only check when bandwidth was not set to don't care
-                        if( (floatingPointCompare(frontend_tuner_allocation.bandwidth,0)!=0) &&
-                            (floatingPointCompare(frontend_tuner_status[tuner_id].bandwidth,frontend_tuner_allocation.bandwidth)<0 ||
-                            floatingPointCompare(frontend_tuner_status[tuner_id].bandwidth,frontend_tuner_allocation.bandwidth+frontend_tuner_allocation.bandwidth * frontend_tuner_allocation.bandwidth_tolerance/100.0)>0 )){
-                            std::ostringstream eout;
-                            eout<<std::fixed<<"allocateCapacity("<<int(tuner_id)<<"): returned bw "<<frontend_tuner_status[tuner_id].bandwidth<<" does not meet tolerance criteria of "<<frontend_tuner_allocation.bandwidth_tolerance<<" percent";
-                            LOG_INFO(FrontendTunerDevice<TunerStatusStructType>, eout.str());
-                            throw std::logic_error(eout.str().c_str());
-                        }
-
-                        if(frontend_tuner_allocation.device_control){
-                            // enable tuner after successful allocation
-                            try {
-                                enableTuner(tuner_id,true);
-                            } catch(...){
-                                std::ostringstream eout;
-                                eout<<"allocateCapacity: Failed to enable tuner after allocation";
-                                LOG_INFO(FrontendTunerDevice<TunerStatusStructType>, eout.str());
-                                throw std::logic_error(eout.str().c_str());
-                            }
-                        }
-                        _usageState = updateUsageState();
-                        return true;
-                    }
-                    // if we made it here, we failed to find an available tuner
-                    std::ostringstream eout;
-                    eout<<"allocateCapacity: NO AVAILABLE TUNER. Make sure that the device has an initialized frontend_tuner_status";
-                    LOG_INFO(FrontendTunerDevice<TunerStatusStructType>, eout.str());
-                    throw std::logic_error(eout.str().c_str());
-                    
-                } else if (id == "FRONTEND::listener_allocation") {
-                    // Check validity of allocation_id's
-                    if (frontend_listener_allocation.existing_allocation_id.empty()){
-                        LOG_INFO(FrontendTunerDevice<TunerStatusStructType>,"allocateCapacity: MISSING EXISTING ALLOCATION ID");
-                        throw CF::Device::InvalidCapacity("MISSING EXISTING ALLOCATION ID", capacities);
-                    }
-                    if (frontend_listener_allocation.listener_allocation_id.empty()){
-                        LOG_INFO(FrontendTunerDevice<TunerStatusStructType>,"allocateCapacity: MISSING LISTENER ALLOCATION ID");
-                        throw CF::Device::InvalidCapacity("MISSING LISTENER ALLOCATION ID", capacities);
-                    }
-
-                    exclusive_lock lock(allocation_id_mapping_lock);
-
-                    // Check if listener allocation ID has already been used
-                    if(getTunerMapping(frontend_listener_allocation.listener_allocation_id) >= 0){
-                        LOG_INFO(FrontendTunerDevice<TunerStatusStructType>,"allocateCapacity: LISTENER ALLOCATION ID ALREADY IN USE: [" << frontend_listener_allocation.listener_allocation_id << "]");
-                        throw AllocationAlreadyExists("LISTENER ALLOCATION ID ALREADY IN USE", capacities);
-                    }
-                    // Do not allocate if existing allocation ID does not exist
-                    long tuner_id = getTunerMapping(frontend_listener_allocation.existing_allocation_id);
-                    if (tuner_id < 0){
-                        LOG_INFO(FrontendTunerDevice<TunerStatusStructType>,"allocateCapacity: UNKNOWN CONTROL ALLOCATION ID: ["<< frontend_listener_allocation.existing_allocation_id <<"]");
-                        throw FRONTEND::BadParameterException("UNKNOWN CONTROL ALLOCATION ID");
-                    }
-
-                    // listener allocations are not permitted for channelizers or TX
-                    if(frontend_tuner_status[tuner_id].tuner_type == "CHANNELIZER" || frontend_tuner_status[tuner_id].tuner_type == "TX"){
-                        std::ostringstream eout;
-                        eout<<"allocateCapacity: listener allocations are not permitted for " << std::string(frontend_tuner_status[tuner_id].tuner_type) << " tuner type";
-                        LOG_DEBUG(FrontendTunerDevice<TunerStatusStructType>, eout.str());
-                        throw CF::Device::InvalidCapacity(eout.str().c_str(), capacities);
-                    }
-
-                    tuner_allocation_ids[tuner_id].listener_allocation_ids.push_back(frontend_listener_allocation.listener_allocation_id);
-                    allocation_id_to_tuner_id.insert(std::pair<std::string, size_t > (frontend_listener_allocation.listener_allocation_id, tuner_id));
-                    frontend_tuner_status[tuner_id].allocation_id_csv = createAllocationIdCsv(tuner_id);
-                    this->assignListener(frontend_listener_allocation.listener_allocation_id,frontend_listener_allocation.existing_allocation_id);
-                    return true;
-                }
-                else {
-                    LOG_INFO(FrontendTunerDevice<TunerStatusStructType>,"allocateCapacity: UNKNOWN ALLOCATION PROPERTY2");
-                    throw CF::Device::InvalidCapacity("UNKNOWN ALLOCATION PROPERTY2", capacities);
+                    allocateTuner(tuner_request, capacities[ii], capacities, allocated);
+                } else {
+                    allocateListener(listener_request, capacities[ii], capacities, allocated);
                 }
             }
         }
         catch(const std::logic_error &e) {
             try {
-                deallocateCapacity(capacities);
+                if (allocated.length() > 0) deallocateRequests(allocated);
             } catch ( ... ) {}
             return false;
         }
         catch(AllocationAlreadyExists &e) {
-            // Don't call deallocateCapacity if the allocationId already exists
-            //   - Would end up deallocating a valid tuner/listener
+            // Only release the requests allocated by this call
+            //   - Deallocating the existing allocationId would end up deallocating a valid tuner/listener
+            try {
+                if (allocated.length() > 0) deallocateRequests(allocated);
+            } catch ( ... ) {}
             throw static_cast<CF::Device::InvalidCapacity>(e); 
         }
         catch(CF::Device::InvalidCapacity &e) {
             try {
-                deallocateCapacity(capacities);
+                if (allocated.length() > 0) deallocateRequests(allocated);
             } catch ( ... ) {}
             throw e;
         }
         catch(FRONTEND::BadParameterException &e) {
             try {
-                deallocateCapacity(capacities);
+                if (allocated.length() > 0) deallocateRequests(allocated);
             } catch ( ... ) {}
             return false;
         }
         catch(...){
             try {
-                deallocateCapacity(capacities);
+                if (allocated.length() > 0) deallocateRequests(allocated);
             } catch ( ... ) {}
             throw;
         };
         
+        _usageState = updateUsageState();
+        return true;
+    }
+
+    template < typename TunerStatusStructType >
+    void FrontendTunerDevice<TunerStatusStructType>::allocateTuner(frontend_tuner_allocation_struct request, const CF::DataType &capacity,
+                                                                   const CF::Properties &capacities, CF::Properties &allocated) {
+        // Check allocation_id
+        if (request.allocation_id.empty()) {
+            LOG_INFO(FrontendTunerDevice<TunerStatusStructType>,"allocateCapacity: MISSING ALLOCATION_ID");
+            throw CF::Device::InvalidCapacity("MISSING ALLOCATION_ID", capacities);
+        }
+        {
+            exclusive_lock lock(allocation_id_mapping_lock);
+            // Check if allocation ID has already been used, or is being allocated by another request
+            if(getTunerMapping(request.allocation_id) >= 0 || pending_allocation_ids.count(request.allocation_id)){
+                LOG_INFO(FrontendTunerDevice<TunerStatusStructType>,"allocateCapacity: ALLOCATION_ID ALREADY IN USE: [" << request.allocation_id << "]");
+                throw AllocationAlreadyExists("ALLOCATION_ID ALREADY IN USE", capacities);
+            }
+            pending_allocation_ids.insert(request.allocation_id);
+        }
+
+        try {
+            // Try the tuners from the index first; if none can be allocated, rebuild the index and try any
+            // tuners that were not in it
+            std::set<size_t> tried;
+            for (int pass = 0; pass < 2; ++pass) {
+                std::vector<std::pair<size_t, tuner_lock_ptr> > candidates;
+                {
+                    exclusive_lock lock(allocation_id_mapping_lock);
+                    if (pass > 0) {
+                        tuner_index_stale = true;
+                    }
+                    const std::vector<size_t> tuners = getTunerCandidates(request);
+                    for (std::vector<size_t>::const_iterator tuner = tuners.begin(); tuner != tuners.end(); ++tuner) {
+                        if (tried.find(*tuner) == tried.end()) {
+                            candidates.push_back(std::make_pair(*tuner, tuner_locks[*tuner]));
+                        }
+                    }
+                }
+                for (size_t ii = 0; ii < candidates.size(); ++ii) {
+                    tried.insert(candidates[ii].first);
+                    if (tryAllocateTuner(request, candidates[ii].first, candidates[ii].second, capacity, capacities, allocated)) {
+                        return;
+                    }
+                }
+            }
+        } catch (...) {
+            exclusive_lock lock(allocation_id_mapping_lock);
+            pending_allocation_ids.erase(request.allocation_id);
+            throw;
+        }
+
+        {
+            exclusive_lock lock(allocation_id_mapping_lock);
+            pending_allocation_ids.erase(request.allocation_id);
+        }
+        // if we made it here, we failed to find an available tuner
+        std::ostringstream eout;
+        eout<<"allocateCapacity: NO AVAILABLE TUNER. Make sure that the device has an initialized frontend_tuner_status";
+        LOG_INFO(FrontendTunerDevice<TunerStatusStructType>, eout.str());
+        throw std::logic_error(eout.str().c_str());
+    }
+
+    template < typename TunerStatusStructType >
+    bool FrontendTunerDevice<TunerStatusStructType>::tryAllocateTuner(frontend_tuner_allocation_struct &request, size_t tuner_id, const tuner_lock_ptr &tuner_lock,
+                                                                      const CF::DataType &capacity, const CF::Properties &capacities, CF::Properties &allocated) {
+        exclusive_lock lock(*tuner_lock);
+
+        if(frontend_tuner_status[tuner_id].tuner_type != request.tuner_type) {
+            LOG_DEBUG(FrontendTunerDevice<TunerStatusStructType>,
+              "allocateCapacity: Requested tuner type '"<<request.tuner_type <<"' does not match tuner[" << tuner_id << "].tuner_type ("<<frontend_tuner_status[tuner_id].tuner_type<<")");
+            exclusive_lock index_lock(allocation_id_mapping_lock);
+            tuner_index_stale = true;
+            return false;
+        }
+
+        if(!request.group_id.empty() && request.group_id != frontend_tuner_status[tuner_id].group_id ){
+            LOG_DEBUG(FrontendTunerDevice<TunerStatusStructType>,
+              "allocateCapacity: Requested group_id '"<<request.group_id <<"' does not match tuner[" << tuner_id << "].group_id ("<<frontend_tuner_status[tuner_id].group_id<<")");
+            return false;
+        }
+
+        // special case because allocation is specifying the input stream, which determines the rf_flow_id, etc.
+        if(!request.rf_flow_id.empty()
+            && request.rf_flow_id != frontend_tuner_status[tuner_id].rf_flow_id
+            && request.tuner_type != "CHANNELIZER"){
+            LOG_DEBUG(FrontendTunerDevice<TunerStatusStructType>,
+              "allocateCapacity: Requested rf_flow_id '"<<request.rf_flow_id <<"' does not match tuner[" << tuner_id << "].rf_flow_id ("<<frontend_tuner_status[tuner_id].rf_flow_id<<")");
+            return false;
+        }
+
+        if(request.device_control){
+            double orig_bw = frontend_tuner_status[tuner_id].bandwidth;
+            double orig_cf = frontend_tuner_status[tuner_id].center_frequency;
+            double orig_sr = frontend_tuner_status[tuner_id].sample_rate;
+            // pre-load frontend_tuner_status values (just in case the request is filled but the values are not populated)
+            frontend_tuner_status[tuner_id].bandwidth = request.bandwidth;
+            frontend_tuner_status[tuner_id].center_frequency = request.center_frequency;
+            frontend_tuner_status[tuner_id].sample_rate = request.sample_rate;
+            // device control
+            if(!tuner_allocation_ids[tuner_id].control_allocation_id.empty() || !deviceSetTuning(request, frontend_tuner_status[tuner_id], tuner_id)){
+                if (frontend_tuner_status[tuner_id].bandwidth == request.bandwidth)
+                    frontend_tuner_status[tuner_id].bandwidth = orig_bw;
+                if (frontend_tuner_status[tuner_id].center_frequency == request.center_frequency)
+                    frontend_tuner_status[tuner_id].center_frequency = orig_cf;
+                if (frontend_tuner_status[tuner_id].sample_rate == request.sample_rate)
+                    frontend_tuner_status[tuner_id].sample_rate = orig_sr;
+                // either not available or didn't succeed setting tuning, try next tuner
+                LOG_DEBUG(FrontendTunerDevice<TunerStatusStructType>,
+                    "allocateCapacity: Tuner["<<tuner_id<<"] is either not available or didn't succeed while setting tuning ");
+                return false;
+            }
+            {
+                exclusive_lock index_lock(allocation_id_mapping_lock);
+                tuner_allocation_ids[tuner_id].control_allocation_id = request.allocation_id;
+                allocation_id_to_tuner_id.insert(std::pair<std::string, size_t > (request.allocation_id, tuner_id));
+                pending_allocation_ids.erase(request.allocation_id);
+                frontend_tuner_status[tuner_id].allocation_id_csv = createAllocationIdCsv(tuner_id);
+            }
+            CORBA::ULong count = allocated.length();
+            allocated.length(count + 1);
+            allocated[count] = capacity;
+        } else {
+            // channelizer allocations must specify device control = true
+            if(request.tuner_type == "CHANNELIZER" || request.tuner_type == "TX"){
+                std::ostringstream eout;
+                eout<<request.tuner_type<<" allocation with device_control=false is invalid.";
+                LOG_DEBUG(FrontendTunerDevice<TunerStatusStructType>, eout.str());
+                throw CF::Device::InvalidCapacity(eout.str().c_str(), capacities);
+            }
+            // listener
+            if(tuner_allocation_ids[tuner_id].control_allocation_id.empty() || !listenerRequestValidation(request, tuner_id)){
+                // either not allocated or can't support listener request
+                LOG_DEBUG(FrontendTunerDevice<TunerStatusStructType>,
+                    "allocateCapacity: Tuner["<<tuner_id<<"] is either not available or can not support listener request ");
+                return false;
+            }
+            std::string control_allocation_id;
+            {
+                exclusive_lock index_lock(allocation_id_mapping_lock);
+                tuner_allocation_ids[tuner_id].listener_allocation_ids.push_back(request.allocation_id);
+                allocation_id_to_tuner_id.insert(std::pair<std::string, size_t > (request.allocation_id, tuner_id));
+                pending_allocation_ids.erase(request.allocation_id);
+                frontend_tuner_status[tuner_id].allocation_id_csv = createAllocationIdCsv(tuner_id);
+                control_allocation_id = tuner_allocation_ids[tuner_id].control_allocation_id;
+            }
+            CORBA::ULong count = allocated.length();
+            allocated.length(count + 1);
+            allocated[count] = capacity;
+            this->assignListener(request.allocation_id,control_allocation_id);
+        }
+        // if we've reached here, we found an eligible tuner with correct frequency
+
+        // check tolerances
+        // only check when sample_rate was not set to don't care)
+        LOG_DEBUG(FrontendTunerDevice<TunerStatusStructType>, std::fixed << " allocateCapacity - SR requested: " << request.sample_rate
+                                                                                           << "  SR got: " << frontend_tuner_status[tuner_id].sample_rate);
+        if( (floatingPointCompare(request.sample_rate,0)!=0) &&
+            (floatingPointCompare(frontend_tuner_status[tuner_id].sample_rate,request.sample_rate)<0 ||
+            floatingPointCompare(frontend_tuner_status[tuner_id].sample_rate,request.sample_rate+request.sample_rate * request.sample_rate_tolerance/100.0)>0 )){
+            std::ostringstream eout;
+            eout<<std::fixed<<"allocateCapacity("<<int(tuner_id)<<"): returned sr "<<frontend_tuner_status[tuner_id].sample_rate<<" does not meet tolerance criteria of "<<request.sample_rate_tolerance<<" percent";
+            LOG_INFO(FrontendTunerDevice<TunerStatusStructType>, eout.str());
+            throw std::logic_error(eout.str().c_str());
+        }
+        LOG_DEBUG(FrontendTunerDevice<TunerStatusStructType>, std::fixed << " allocateCapacity - BW requested: " << request.bandwidth
+                                                                                           << "  BW got: " << frontend_tuner_status[tuner_id].bandwidth);
+        // Only check when bandwidth was not set to don't care
+        if( (floatingPointCompare(request.bandwidth,0)!=0) &&
+            (floatingPointCompare(frontend_tuner_status[tuner_id].bandwidth,request.bandwidth)<0 ||
+            floatingPointCompare(frontend_tuner_status[tuner_id].bandwidth,request.bandwidth+request.bandwidth * request.bandwidth_tolerance/100.0)>0 )){
+            std::ostringstream eout;
+            eout<<std::fixed<<"allocateCapacity("<<int(tuner_id)<<"): returned bw "<<frontend_tuner_status[tuner_id].bandwidth<<" does not meet tolerance criteria of "<<request.bandwidth_tolerance<<" percent";
+            LOG_INFO(FrontendTunerDevice<TunerStatusStructType>, eout.str());
+            throw std::logic_error(eout.str().c_str());
+        }
+
+        if(request.device_control){
+            // enable tuner after successful allocation
+            try {
+                enableTuner(tuner_id,true);
+            } catch(...){
+                std::ostringstream eout;
+                eout<<"allocateCapacity: Failed to enable tuner after allocation";
+                LOG_INFO(FrontendTunerDevice<TunerStatusStructType>, eout.str());
+                throw std::logic_error(eout.str().c_str());
+            }
+        }
         return true;
     }
 
+    template < typename TunerStatusStructType >
+    void FrontendTunerDevice<TunerStatusStructType>::allocateListener(const frontend_listener_allocation_struct &request, const CF::DataType &capacity,
+                                                                      const CF::Properties &capacities, CF::Properties &allocated) {
+        // Check validity of allocation_id's
+        if (request.existing_allocation_id.empty()){
+            LOG_INFO(FrontendTunerDevice<TunerStatusStructType>,"allocateCapacity: MISSING EXISTING ALLOCATION ID");
+            throw CF::Device::InvalidCapacity("MISSING EXISTING ALLOCATION ID", capacities);
+        }
+        if (request.listener_allocation_id.empty()){
+            LOG_INFO(FrontendTunerDevice<TunerStatusStructType>,"allocateCapacity: MISSING LISTENER ALLOCATION ID");
+            throw CF::Device::InvalidCapacity("MISSING LISTENER ALLOCATION ID", capacities);
+        }
+
+        long tuner_id;
+        tuner_lock_ptr tuner_lock;
+        {
+            exclusive_lock lock(allocation_id_mapping_lock);
+
+            // Check if listener allocation ID has already been used
+            if(getTunerMapping(request.listener_allocation_id) >= 0 || pending_allocation_ids.count(request.listener_allocation_id)){
+                LOG_INFO(FrontendTunerDevice<TunerStatusStructType>,"allocateCapacity: LISTENER ALLOCATION ID ALREADY IN USE: [" << request.listener_allocation_id << "]");
+                throw AllocationAlreadyExists("LISTENER ALLOCATION ID ALREADY IN USE", capacities);
+            }
+            // Do not allocate if existing allocation ID does not exist
+            tuner_id = getTunerMapping(request.existing_allocation_id);
+            if (tuner_id < 0){
+                LOG_INFO(FrontendTunerDevice<TunerStatusStructType>,"allocateCapacity: UNKNOWN CONTROL ALLOCATION ID: ["<< request.existing_allocation_id <<"]");
+                throw FRONTEND::BadParameterException("UNKNOWN CONTROL ALLOCATION ID");
+            }
+            tuner_lock = tuner_locks[tuner_id];
+            pending_allocation_ids.insert(request.listener_allocation_id);
+        }
+
+        try {
+            exclusive_lock lock(*tuner_lock);
+
+            // listener allocations are not permitted for channelizers or TX
+            if(frontend_tuner_status[tuner_id].tuner_type == "CHANNELIZER" || frontend_tuner_status[tuner_id].tuner_type == "TX"){
+                std::ostringstream eout;
+                eout<<"allocateCapacity: listener allocations are not permitted for " << std::string(frontend_tuner_status[tuner_id].tuner_type) << " tuner type";
+                LOG_DEBUG(FrontendTunerDevice<TunerStatusStructType>, eout.str());
+                throw CF::Device::InvalidCapacity(eout.str().c_str(), capacities);
+            }
+
+            {
+                exclusive_lock index_lock(allocation_id_mapping_lock);
+                // The existing allocation may have been released while waiting for the tuner
+                if (getTunerMapping(request.existing_allocation_id) != tuner_id) {
+                    LOG_INFO(FrontendTunerDevice<TunerStatusStructType>,"allocateCapacity: UNKNOWN CONTROL ALLOCATION ID: ["<< request.existing_allocation_id <<"]");
+                    throw FRONTEND::BadParameterException("UNKNOWN CONTROL ALLOCATION ID");
+                }
+                tuner_allocation_ids[tuner_id].listener_allocation_ids.push_back(request.listener_allocation_id);
+                allocation_id_to_tuner_id.insert(std::pair<std::string, size_t > (request.listener_allocation_id, tuner_id));
+                pending_allocation_ids.erase(request.listener_allocation_id);
+                frontend_tuner_status[tuner_id].allocation_id_csv = createAllocationIdCsv(tuner_id);
+            }
+            CORBA::ULong count = allocated.length();
+            allocated.length(count + 1);
+            allocated[count] = capacity;
+            this->assignListener(request.listener_allocation_id,request.existing_allocation_id);
+        } catch (...) {
+            exclusive_lock lock(allocation_id_mapping_lock);
+            pending_allocation_ids.erase(request.listener_allocation_id);
+            throw;
+        }
+    }
+
     template < typename TunerStatusStructType >
     void FrontendTunerDevice<TunerStatusStructType>::deallocateCapacity(const CF::Properties & capacities)
     throw (CORBA::SystemException, CF::Device::InvalidCapacity, CF::Device::InvalidState) {
         LOG_TRACE(FrontendTunerDevice<TunerStatusStructType>,__PRETTY_FUNCTION__);
+        boost::recursive_mutex::scoped_lock serialize_lock(tuning_lock, boost::defer_lock);
+        if (!concurrent_tuner_allocation) {
+            serialize_lock.lock();
+        }
+        resizeTunerState();
+        boost::shared_lock<boost::shared_mutex> state_lock(tuner_state_lock);
+        deallocateRequests(capacities);
+    }
+
+    template < typename TunerStatusStructType >
+    void FrontendTunerDevice<TunerStatusStructType>::deallocateRequests(const CF::Properties & capacities) {
         for (CORBA::ULong ii = 0; ii < capacities.length(); ++ii) {
             try{
                 const std::string id = (const char*) capacities[ii].id;
@@ -611,53 +734,22 @@ namespace frontend {
                     LOG_INFO(FrontendTunerDevice<TunerStatusStructType>,"deallocateCapacity: UNKNOWN PROPERTY");
                     throw CF::Device::InvalidCapacity("UNKNOWN PROPERTY", capacities);
                 }
+                frontend_tuner_allocation_struct tuner_request;
+                frontend_listener_allocation_struct listener_request;
                 try{
+                    boost::recursive_mutex::scoped_lock parse_lock(tuning_lock);
                     property->setValue(capacities[ii].value);
+                    tuner_request = frontend_tuner_allocation;
+                    listener_request = frontend_listener_allocation;
                 }
                 catch(const std::logic_error &e){
                     LOG_DEBUG(FrontendTunerDevice<TunerStatusStructType>, "COULD NOT PARSE CAPACITY: " << e.what());
                     throw CF::Device::InvalidCapacity("COULD NOT PARSE CAPACITY", capacities);
                 };
                 if (id == "FRONTEND::tuner_allocation"){
-                    //LOG_DEBUG(FrontendTunerDevice<TunerStatusStructType>,std::string(__PRETTY_FUNCTION__)+" tuner_allocation");
-                    // Try to remove control of the device
-                    long tuner_id = getTunerMapping(frontend_tuner_allocation.allocation_id);
-                    if (tuner_id < 0){
-                        LOG_DEBUG(FrontendTunerDevice<TunerStatusStructType>, "ALLOCATION_ID NOT FOUND: [" << frontend_tuner_allocation.allocation_id <<"]");
-                        throw CF::Device::InvalidCapacity("ALLOCATION_ID NOT FOUND", capacities);
-                    }
-                    //LOG_DEBUG(FrontendTunerDevice<TunerStatusStructType>,std::string(__PRETTY_FUNCTION__)+" tuner_id = " << tuner_id);
-                    if(tuner_allocation_ids[tuner_id].control_allocation_id == frontend_tuner_allocation.allocation_id){
-                        //LOG_DEBUG(FrontendTunerDevice<TunerStatusStructType>,std::string(__PRETTY_FUNCTION__)+" deallocating control for tuner_id = " << tuner_id);
-                        enableTuner(tuner_id, false);
-                        removeTunerMapping(tuner_id);
-                        frontend_tuner_status[tuner_id].allocation_id_csv = createAllocationIdCsv(tuner_id);
-                    }
-                    else {
-                        //LOG_DEBUG(FrontendTunerDevice<TunerStatusStructType>,std::string(__PRETTY_FUNCTION__)+" deallocating listener for tuner_id = " << tuner_id);
-                        // send EOS to listener connection only
-                        removeTunerMapping(tuner_id,frontend_tuner_allocation.allocation_id);
-                        frontend_tuner_status[tuner_id].allocation_id_csv = createAllocationIdCsv(tuner_id);
-                    }
-                }
-                else if (id == "FRONTEND::listener_allocation") {
-                    //LOG_DEBUG(FrontendTunerDevice<TunerStatusStructType>,std::string(__PRETTY_FUNCTION__)+" listener_allocation");
-                    long tuner_id = getTunerMapping(frontend_listener_allocation.listener_allocation_id);
-                    if (tuner_id < 0){
-                        LOG_DEBUG(FrontendTunerDevice<TunerStatusStructType>, "ALLOCATION_ID NOT FOUND: [" << frontend_listener_allocation.listener_allocation_id <<"]");
-                        throw CF::Device::InvalidCapacity("ALLOCATION_ID NOT FOUND", capacities);
-                    }
-                    if (this->tuner_allocation_ids[tuner_id].control_allocation_id == frontend_listener_allocation.listener_allocation_id) {
-                        LOG_DEBUG(FrontendTunerDevice<TunerStatusStructType>, "Controlling allocation id cannot be used as a listener id: [" << frontend_listener_allocation.listener_allocation_id <<"]");
-                        throw CF::Device::InvalidCapacity("Controlling allocation id cannot be used as a listener id", capacities);
-                    }
-                    //LOG_DEBUG(FrontendTunerDevice<TunerStatusStructType>,std::string(__PRETTY_FUNCTION__)+" tuner_id = " << tuner_id);
-                    // send EOS to listener connection only
-                    removeTunerMapping(tuner_id,frontend_listener_allocation.listener_allocation_id);
-                    frontend_tuner_status[tuner_id].allocation_id_csv = createAllocationIdCsv(tuner_id);
-                }
-                else {
-                    LOG_TRACE(FrontendTunerDevice<TunerStatusStructType>,"WARNING: UNKNOWN ALLOCATION PROPERTY \""+ std::string(property->name) + "\". IGNORING!");
+                    deallocateTuner(tuner_request, capacities);
+                } else {
+                    deallocateListener(listener_request, capacities);
                 }
             }
             catch(CF::Device::InvalidCapacity &e){
@@ -672,6 +764,148 @@ namespace frontend {
         _usageState = updateUsageState();
     }
 
+    template < typename TunerStatusStructType >
+    void FrontendTunerDevice<TunerStatusStructType>::deallocateTuner(const frontend_tuner_allocation_struct &request, const CF::Properties &capacities) {
+        // Try to remove control of the device
+        long tuner_id;
+        tuner_lock_ptr tuner_lock;
+        {
+            exclusive_lock lock(allocation_id_mapping_lock);
+            tuner_id = getTunerMapping(request.allocation_id);
+            if (tuner_id < 0){
+                LOG_DEBUG(FrontendTunerDevice<TunerStatusStructType>, "ALLOCATION_ID NOT FOUND: [" << request.allocation_id <<"]");
+                throw CF::Device::InvalidCapacity("ALLOCATION_ID NOT FOUND", capacities);
+            }
+            tuner_lock = tuner_locks[tuner_id];
+        }
+
+        exclusive_lock lock(*tuner_lock);
+        bool control;
+        {
+            exclusive_lock index_lock(allocation_id_mapping_lock);
+            // The allocation may have been released while waiting for the tuner
+            if (getTunerMapping(request.allocation_id) != tuner_id) {
+                LOG_DEBUG(FrontendTunerDevice<TunerStatusStructType>, "ALLOCATION_ID NOT FOUND: [" << request.allocation_id <<"]");
+                throw CF::Device::InvalidCapacity("ALLOCATION_ID NOT FOUND", capacities);
+            }
+            control = (tuner_allocation_ids[tuner_id].control_allocation_id == request.allocation_id);
+        }
+        if (control) {
+            enableTuner(tuner_id, false);
+            removeTunerMapping(tuner_id);
+        } else {
+            // send EOS to listener connection only
+            removeTunerMapping(tuner_id,request.allocation_id);
+        }
+        exclusive_lock index_lock(allocation_id_mapping_lock);
+        frontend_tuner_status[tuner_id].allocation_id_csv = createAllocationIdCsv(tuner_id);
+    }
+
+    template < typename TunerStatusStructType >
+    void FrontendTunerDevice<TunerStatusStructType>::deallocateListener(const frontend_listener_allocation_struct &request, const CF::Properties &capacities) {
+        long tuner_id;
+        tuner_lock_ptr tuner_lock;
+        {
+            exclusive_lock lock(allocation_id_mapping_lock);
+            tuner_id = getTunerMapping(request.listener_allocation_id);
+            if (tuner_id < 0){
+                LOG_DEBUG(FrontendTunerDevice<TunerStatusStructType>, "ALLOCATION_ID NOT FOUND: [" << request.listener_allocation_id <<"]");
+                throw CF::Device::InvalidCapacity("ALLOCATION_ID NOT FOUND", capacities);
+            }
+            if (this->tuner_allocation_ids[tuner_id].control_allocation_id == request.listener_allocation_id) {
+                LOG_DEBUG(FrontendTunerDevice<TunerStatusStructType>, "Controlling allocation id cannot be used as a listener id: [" << request.listener_allocation_id <<"]");
+                throw CF::Device::InvalidCapacity("Controlling allocation id cannot be used as a listener id", capacities);
+            }
+            tuner_lock = tuner_locks[tuner_id];
+        }
+
+        exclusive_lock lock(*tuner_lock);
+        {
+            exclusive_lock index_lock(allocation_id_mapping_lock);
+            if (getTunerMapping(request.listener_allocation_id) != tuner_id) {
+                LOG_DEBUG(FrontendTunerDevice<TunerStatusStructType>, "ALLOCATION_ID NOT FOUND: [" << request.listener_allocation_id <<"]");
+                throw CF::Device::InvalidCapacity("ALLOCATION_ID NOT FOUND", capacities);
+            }
+        }
+        // send EOS to listener connection only
+        removeTunerMapping(tuner_id,request.listener_allocation_id);
+        exclusive_lock index_lock(allocation_id_mapping_lock);
+        frontend_tuner_status[tuner_id].allocation_id_csv = createAllocationIdCsv(tuner_id);
+    }
+
+    template < typename TunerStatusStructType >
+    void FrontendTunerDevice<TunerStatusStructType>::resizeTunerState() {
+        {
+            boost::shared_lock<boost::shared_mutex> state_lock(tuner_state_lock);
+            if ((tuner_allocation_ids.size() == frontend_tuner_status.size()) && (tuner_locks.size() == frontend_tuner_status.size())) {
+                return;
+            }
+        }
+        // No request can be using a tuner while the lock is held exclusively; the mapping lock is also taken so
+        // that readers that only hold it (e.g., removeTunerMapping) never see a partial resize
+        boost::unique_lock<boost::shared_mutex> state_lock(tuner_state_lock);
+        exclusive_lock lock(allocation_id_mapping_lock);
+        if (tuner_allocation_ids.size() != frontend_tuner_status.size()) {
+            tuner_allocation_ids.resize(frontend_tuner_status.size());
+        }
+        while (tuner_locks.size() < frontend_tuner_status.size()) {
+            tuner_locks.push_back(tuner_lock_ptr(new boost::mutex()));
+        }
+        tuner_locks.resize(frontend_tuner_status.size());
+        tuner_index_stale = true;
+    }
+
+    template < typename TunerStatusStructType >
+    void FrontendTunerDevice<TunerStatusStructType>::rebuildTunerIndex() {
+        tuner_type_index.clear();
+        tuner_group_index.clear();
+        tuner_rf_flow_index.clear();
+        // Only tuners that resizeTunerState has accounted for are indexed
+        for (size_t tuner_id = 0; tuner_id < tuner_locks.size(); tuner_id++) {
+            const std::string tuner_type(frontend_tuner_status[tuner_id].tuner_type);
+            const std::string group_id(frontend_tuner_status[tuner_id].group_id);
+            const std::string rf_flow_id(frontend_tuner_status[tuner_id].rf_flow_id);
+            tuner_type_index[tuner_type].push_back(tuner_id);
+            tuner_group_index[std::make_pair(tuner_type, group_id)].push_back(tuner_id);
+            tuner_rf_flow_index[std::make_pair(tuner_type, rf_flow_id)].push_back(tuner_id);
+        }
+        indexed_tuners = tuner_locks.size();
+        tuner_index_stale = false;
+    }
+
+    template < typename TunerStatusStructType >
+    std::vector<size_t> FrontendTunerDevice<TunerStatusStructType>::getTunerCandidates(const frontend_tuner_allocation_struct &request) {
+        if (tuner_index_stale || (indexed_tuners != tuner_locks.size())) {
+            rebuildTunerIndex();
+        }
+        // Every index that applies to the request holds a superset of the eligible tuners, so the shortest one is
+        // searched. rf_flow_id does not restrict CHANNELIZER allocations, which select their input by it.
+        tuner_type_mapping::const_iterator by_type = tuner_type_index.find(request.tuner_type);
+        if (by_type == tuner_type_index.end()) {
+            return std::vector<size_t>();
+        }
+        const std::vector<size_t>* candidates = &by_type->second;
+        if (!request.group_id.empty()) {
+            tuner_group_mapping::const_iterator by_group = tuner_group_index.find(std::make_pair(request.tuner_type, request.group_id));
+            if (by_group == tuner_group_index.end()) {
+                return std::vector<size_t>();
+            }
+            if (by_group->second.size() < candidates->size()) {
+                candidates = &by_group->second;
+            }
+        }
+        if (!request.rf_flow_id.empty() && (request.tuner_type != "CHANNELIZER")) {
+            tuner_group_mapping::const_iterator by_rf_flow = tuner_rf_flow_index.find(std::make_pair(request.tuner_type, request.rf_flow_id));
+            if (by_rf_flow == tuner_rf_flow_index.end()) {
+                return std::vector<size_t>();
+            }
+            if (by_rf_flow->second.size() < candidates->size()) {
+                candidates = &by_rf_flow->second;
+            }
+        }
+        return *candidates;
+    }
+
     /*****************************************************************/
     /* Tuner Configurations                                          */
     /*****************************************************************/
@@ -787,15 +1021,9 @@ namespace frontend {
         LOG_TRACE(FrontendTunerDevice<TunerStatusStructType>,__PRETTY_FUNCTION__);
         removeListener(allocation_id);
         sendEOS(allocation_id);
-        std::vector<std::string>::iterator it = tuner_allocation_ids[tuner_id].listener_allocation_ids.begin();
-        while(it != tuner_allocation_ids[tuner_id].listener_allocation_ids.end()){
-            if(*it == allocation_id){
-                tuner_allocation_ids[tuner_id].listener_allocation_ids.erase(it);
-            } else {
-                ++it;
-            }
-        }
         exclusive_lock lock(allocation_id_mapping_lock);
+        std::vector<std::string> &listener_ids = tuner_allocation_ids[tuner_id].listener_allocation_ids;
+        listener_ids.erase(std::remove(listener_ids.begin(), listener_ids.end(), allocation_id), listener_ids.end());
         if(allocation_id_to_tuner_id.erase(allocation_id) > 0)
             return true;
         return false;
@@ -807,22 +1035,29 @@ namespace frontend {
         deviceDeleteTuning(frontend_tuner_status[tuner_id], tuner_id);
         removeAllocationIdRouting(tuner_id);
 
-        long cnt = 0;
-        exclusive_lock lock(allocation_id_mapping_lock);
-        string_number_mapping::iterator it = allocation_id_to_tuner_id.begin();
-        while(it != allocation_id_to_tuner_id.end()){
-            if(it->second == tuner_id){
-                std::string allocation_id = it->first;
-                removeListener(allocation_id);
-                sendEOS(allocation_id);
-                allocation_id_to_tuner_id.erase(it++);
-                cnt++;
-            } else {
-                ++it;
+        // The tuner's allocation ids are known, so only those mappings need to be checked; listeners and
+        // EOS are handled after releasing the lock, as they may make remote calls
+        std::vector<std::string> removed;
+        {
+            exclusive_lock lock(allocation_id_mapping_lock);
+            std::vector<std::string> allocation_ids = tuner_allocation_ids[tuner_id].listener_allocation_ids;
+            if (!tuner_allocation_ids[tuner_id].control_allocation_id.empty()) {
+                allocation_ids.insert(allocation_ids.begin(), tuner_allocation_ids[tuner_id].control_allocation_id);
+            }
+            for (std::vector<std::string>::iterator it = allocation_ids.begin(); it != allocation_ids.end(); ++it) {
+                string_number_mapping::iterator mapping = allocation_id_to_tuner_id.find(*it);
+                if (mapping != allocation_id_to_tuner_id.end() && mapping->second == tuner_id) {
+                    allocation_id_to_tuner_id.erase(mapping);
+                    removed.push_back(*it);
+                }
             }
+            tuner_allocation_ids[tuner_id].reset();
+        }
+        for (std::vector<std::string>::iterator it = removed.begin(); it != removed.end(); ++it) {
+            removeListener(*it);
+            sendEOS(*it);
         }
-        tuner_allocation_ids[tuner_id].reset();
-        return cnt > 0;
+        return !removed.empty();
     }
 
     template < typename TunerStatusStructType >
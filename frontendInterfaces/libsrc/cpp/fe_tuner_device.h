@@ -20,6 +20,10 @@
 #ifndef FE_TUNER_DEVICE_BASE_H
 #define FE_TUNER_DEVICE_BASE_H
 
+#include <set>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/recursive_mutex.hpp>
+#include <boost/thread/shared_mutex.hpp>
 #include <ossie/Device_impl.h>
 #include <uuid/uuid.h>
 #include <redhawk/FRONTEND/Frontend.h>
@@ -192,6 +196,35 @@ namespace frontend {
             string_number_mapping allocation_id_to_tuner_id;
             boost::mutex allocation_id_mapping_lock;
 
+            // Allocation IDs with an allocation in progress, so that concurrent requests cannot claim the same ID
+            std::set<std::string> pending_allocation_ids;
+
+            // Indices of tuners by tuner_type, by (tuner_type, group_id) and by (tuner_type, rf_flow_id), in tuner
+            // order. Entries are verified when used, and the indices are rebuilt when the number of tuners changes,
+            // when a tuner no longer matches its entry, or before a failed allocation gives up.
+            typedef std::map<std::string, std::vector<size_t> > tuner_type_mapping;
+            typedef std::map<std::pair<std::string, std::string>, std::vector<size_t> > tuner_group_mapping;
+            tuner_type_mapping tuner_type_index;
+            tuner_group_mapping tuner_group_index;
+            tuner_group_mapping tuner_rf_flow_index;
+            size_t indexed_tuners;
+            bool tuner_index_stale;
+
+            // One lock per tuner, held while a tuner's allocation state is decided and the device is tuned
+            typedef boost::shared_ptr<boost::mutex> tuner_lock_ptr;
+            std::vector<tuner_lock_ptr> tuner_locks;
+
+            // Held shared by allocations and deallocations for their duration, so that tuner_allocation_ids and
+            // tuner_locks are only resized (with the lock held exclusively) when no request is using a tuner
+            boost::shared_mutex tuner_state_lock;
+
+            // By default, only requests for the same tuner are serialized, so the device specific functions may
+            // be called concurrently for different tuners. Devices whose tuners share state (e.g., a single
+            // hardware handle) should set concurrent_tuner_allocation to false in their constructor, so that all
+            // allocations and deallocations are serialized.
+            bool concurrent_tuner_allocation;
+            boost::recursive_mutex tuning_lock;
+
             ///////////////////////////////
             // Device specific functions // -- virtual - to be implemented by device developer
             ///////////////////////////////
@@ -219,6 +252,26 @@ namespace frontend {
             virtual bool enableTuner(size_t tuner_id, bool enable);
             virtual bool listenerRequestValidation(frontend_tuner_allocation_struct &request, size_t tuner_id);
 
+            ///////////////////////////////
+            // Allocation helpers. Each allocates or deallocates a single request; allocated properties are
+            // appended to allocated so that a failed batch can be rolled back.
+            // All require tuner_state_lock to be held shared.
+            ///////////////////////////////
+            void allocateTuner(frontend_tuner_allocation_struct request, const CF::DataType &capacity, const CF::Properties &capacities, CF::Properties &allocated);
+            bool tryAllocateTuner(frontend_tuner_allocation_struct &request, size_t tuner_id, const tuner_lock_ptr &tuner_lock,
+                                  const CF::DataType &capacity, const CF::Properties &capacities, CF::Properties &allocated);
+            void allocateListener(const frontend_listener_allocation_struct &request, const CF::DataType &capacity, const CF::Properties &capacities, CF::Properties &allocated);
+            void deallocateRequests(const CF::Properties &capacities);
+            void deallocateTuner(const frontend_tuner_allocation_struct &request, const CF::Properties &capacities);
+            void deallocateListener(const frontend_listener_allocation_struct &request, const CF::Properties &capacities);
+
+            // Resizes tuner_allocation_ids and tuner_locks to match frontend_tuner_status; must be called without
+            // tuner_state_lock held
+            void resizeTunerState();
+
+            // The following require allocation_id_mapping_lock to be held
+            void rebuildTunerIndex();
+            std::vector<size_t> getTunerCandidates(const frontend_tuner_allocation_struct &request);
 
             ////////////////////////////
             // Other helper functions //
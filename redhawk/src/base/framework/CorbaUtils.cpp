@@ -20,12 +20,16 @@
 
 #include <iostream>
 
+#include <boost/thread/tss.hpp>
+
 #include <omniORB4/CORBA.h>
 #include <omniORB4/omniURI.h>
 #include <omniORB4/omniORB.h>
+#include <omniORB4/omniInterceptors.h>
 #include <omniORB4/internal/orbParameters.h>
 
 #include "ossie/CorbaUtils.h"
+#include "ossie/affinity.h"
 
 static CORBA::ORB_var orb = CORBA::ORB::_nil();
 static PortableServer::POA_var root_poa = PortableServer::POA::_nil();
@@ -55,11 +59,33 @@ CORBA::ORB_ptr OrbInit (int argc, char* argv[], bool persistentIORs)
     return OrbInit(argc, argv, ORBProperties(), persistentIORs);
 }
 
+// Applies the ORB worker thread directives (affinity and buffer allocation
+// policy) to threads that dispatch incoming calls. omniORB invokes this each
+// time it assigns a thread to upcalls, so the directives are only applied the
+// first time a given thread is seen; other ORB threads (e.g., connection
+// acceptors and the scavenger) are left alone.
+static boost::thread_specific_ptr<bool> orbWorkerBound;
+
+static void orbWorkerAffinity (omniInterceptors::assignUpcallThread_T::info_T& info)
+{
+    if (!orbWorkerBound.get()) {
+        orbWorkerBound.reset(new bool(true));
+        redhawk::affinity::set_thread_affinity(redhawk::affinity::ORB_WORKER);
+        redhawk::affinity::set_thread_affinity(redhawk::affinity::BUFFER_ALLOC);
+    }
+    info.run();
+}
+
 CORBA::ORB_ptr OrbInit (int argc, char* argv[], const ORBProperties& orbProperties, bool persistentIORs)
 {
     if (CORBA::is_nil(orb)) {
         persistenceEnabled = persistentIORs;
 
+        if (!redhawk::affinity::get_thread_directive(redhawk::affinity::ORB_WORKER).first.empty() ||
+            !redhawk::affinity::get_thread_directive(redhawk::affinity::BUFFER_ALLOC).first.empty()) {
+            omniORB::getInterceptors()->assignUpcallThread.add(orbWorkerAffinity);
+        }
+
         typedef const char* omni_arg[2];
         omni_arg* corba_args = new omni_arg[orbProperties.size()+1];
         size_t ii = 0;
@@ -26,6 +26,7 @@
 #include "ossie/Device_impl.h"
 #include "ossie/CorbaUtils.h"
 #include "ossie/Events.h"
+#include "ossie/tracing.h"
 
 
 PREPARE_CF_LOGGING(Device_impl)
@@ -1215,6 +1216,7 @@ void Device_impl::start_device(Device_impl::ctor_type ctor, struct sigaction sa,
     std::string log_label("");
     bool skip_run = false;
     bool enablesigfd=false;
+    std::string trace_path("");
         
     std::map<std::string, char*> execparams;
                 
@@ -1242,6 +1244,8 @@ void Device_impl::start_device(Device_impl::ctor_type ctor, struct sigaction sa,
             log_dpath = argv[++i];
         } else if (strcmp("USESIGFD", argv[i]) == 0){
             enablesigfd = true;
+        } else if (strcmp("TRACE", argv[i]) == 0) {
+            trace_path = argv[++i];
         } else if (strcmp("SKIP_RUN", argv[i]) == 0){
             skip_run = true;
             i++;             // skip flag has bogus argument need to skip over so execparams is processed correctly
@@ -1378,7 +1382,13 @@ void Device_impl::start_device(Device_impl::ctor_type ctor, struct sigaction sa,
     if (skip_run) {
         return;
     }    
+    if (!trace_path.empty()) {
+        redhawk::tracing::dumpOnSignal(trace_path);
+    }
     device->run();
+    if (!trace_path.empty() && !redhawk::tracing::dump(trace_path)) {
+        LOG_WARN(Device_impl, "Unable to write trace to " << trace_path);
+    }
     LOG_DEBUG(Device_impl, "Goodbye!");
     device->_remove_ref();
     ossie::logging::Terminate();
@@ -43,7 +43,16 @@
 #endif
 
 #include <errno.h>
+#include <dirent.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <signal.h>
 #include <boost/algorithm/string.hpp>
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/thread_time.hpp>
 #include <boost/algorithm/string/predicate.hpp>
 #include <sys/time.h>
 #include <libgen.h>
@@ -51,10 +60,96 @@
 #include "ossie/ExecutableDevice_impl.h"
 #include "ossie/prop_helpers.h"
 #include "ossie/affinity.h"
+#include "ossie/ossieSupport.h"
 #include "logging/rh_logger_stdout.h"
 
 PREPARE_CF_LOGGING(ExecutableDevice_impl)
 
+namespace {
+    // Returns the processes in a process group that have not exited; zombies
+    // (exited, but not yet reaped by their parent) are not included
+    std::vector<pid_t> getLiveGroupMembers(pid_t pgroup)
+    {
+        std::vector<pid_t> members;
+        DIR* proc = opendir("/proc");
+        if (!proc) {
+            return members;
+        }
+        struct dirent* entry;
+        while ((entry = readdir(proc)) != 0) {
+            char* end;
+            pid_t pid = strtol(entry->d_name, &end, 10);
+            if ((*end != '\0') || (pid <= 0)) {
+                continue;
+            }
+            char path[64];
+            snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+            FILE* file = fopen(path, "r");
+            if (!file) {
+                continue;
+            }
+            char buffer[512];
+            size_t length = fread(buffer, 1, sizeof(buffer)-1, file);
+            fclose(file);
+            buffer[length] = '\0';
+            // The command name may contain spaces; the state, parent pid and
+            // process group follow the closing parenthesis
+            const char* fields = strrchr(buffer, ')');
+            char state;
+            int ppid;
+            int group;
+            if (fields && (sscanf(fields + 1, " %c %d %d", &state, &ppid, &group) == 3)) {
+                if ((group == pgroup) && (state != 'Z') && (state != 'X')) {
+                    members.push_back(pid);
+                }
+            }
+        }
+        closedir(proc);
+        return members;
+    }
+
+    typedef boost::shared_ptr<ossie::helpers::process_watch> ProcessWatchPtr;
+
+    // Escalates from SIGINT (already sent) through SIGTERM to SIGKILL until
+    // every process in the group has exited. The group's members are found
+    // once, before the first signal; each signal still goes to the whole
+    // group, so any process started since then is signaled as well.
+    void escalateTermination(pid_t processId, pid_t pgroup, ProcessWatchPtr members)
+    {
+        std::vector< std::pair< int, float > > _signals;
+        _signals.push_back(std::make_pair(SIGINT, 2));
+        _signals.push_back(std::make_pair(SIGTERM, 2));
+        _signals.push_back(std::make_pair(SIGKILL, 0.5));
+
+        bool processes_dead = false;
+        for (std::vector< std::pair< int, float > >::iterator _signal=_signals.begin(); !processes_dead && _signal!=_signals.end(); _signal++) {
+            if (_signal != _signals.begin()) {
+                int retval = killpg(pgroup, _signal->first);
+                LOG_TRACE(ExecutableDevice_impl, "Process Termination pid/group " << processId << "/" << pgroup << " signal " << _signal->first << "   RET= " << retval);
+                if ( retval == -1 && errno == EPERM ) {
+                    LOG_ERROR(ExecutableDevice_impl, "Error sending pid/group " << processId << "/" <<  pgroup);
+                    continue;
+                }
+                if ( retval == -1 && errno == ESRCH ) {
+                    processes_dead = true;
+                    break;
+                }
+            }
+            processes_dead = (members->wait(_signal->second) == 0);
+        }
+        if ( processes_dead ) {
+            LOG_TRACE(ExecutableDevice_impl, "Process group terminated  " << processId << "/" <<  pgroup);
+        } else {
+            LOG_WARN(ExecutableDevice_impl, "Process group " << pgroup << " did not exit after SIGKILL");
+        }
+
+        // Reap the process if it is a child of this device that nothing else
+        // has reaped; this fails harmlessly with ECHILD otherwise
+        int status;
+        waitpid(processId, &status, WNOHANG);
+    }
+}
+
 /* ExecutableDevice_impl ****************************************
     - constructor 1: no capacities defined
 ****************************************************************** */
@@ -319,6 +414,14 @@ CF::ExecutableDevice::ProcessID_Type ExecutableDevice_impl::do_execute (const ch
         argv[i] = const_cast<char*> (args[i].c_str());
     }
 
+    // the resource's environment, including thread level affinity directives, is built before
+    // fork since the child of a multithreaded process may only make async-signal-safe calls
+    std::vector<std::string> environment = redhawk::affinity::thread_environment( options );
+    std::vector<char*> envp(environment.size() + 1, NULL);
+    for (std::size_t i = 0; i < environment.size(); ++i) {
+        envp[i] = const_cast<char*> (environment[i].c_str());
+    }
+
     rh_logger::LevelPtr  lvl = ExecutableDevice_impl::__logger->getLevel();
 
     // fork child process
@@ -368,9 +471,9 @@ CF::ExecutableDevice::ProcessID_Type ExecutableDevice_impl::do_execute (const ch
         {
           if (strcmp(argv[0], "valgrind") == 0) {
               // Find valgrind in the path
-              returnval = execvp(argv[0], &argv[0]);
+              returnval = execvpe(argv[0], &argv[0], &envp[0]);
           } else {
-              returnval = execv(argv[0], &argv[0]);
+              returnval = execve(argv[0], &argv[0], &envp[0]);
           }
 
           num_retries--;
@@ -435,10 +538,6 @@ CF::ExecutableDevice::ProcessID_Type ExecutableDevice_impl::do_execute (const ch
 void
 ExecutableDevice_impl::terminate (CF::ExecutableDevice::ProcessID_Type processId) throw (CORBA::SystemException, CF::ExecutableDevice::InvalidProcess, CF::Device::InvalidState)
 {
-    std::vector< std::pair< int, float > > _signals;
-    _signals.push_back(std::make_pair(SIGINT, 2));
-    _signals.push_back(std::make_pair(SIGTERM, 2));
-    _signals.push_back(std::make_pair(SIGKILL, 0.5));
 // validate device state
     if (isLocked () || isDisabled ()) {
         printf ("Cannot terminate. System is either LOCKED or DISABLED.");
@@ -449,37 +548,32 @@ ExecutableDevice_impl::terminate (CF::ExecutableDevice::ProcessID_Type processId
 
   // go ahead and terminate the process
   pid_t pgroup = getpgid(processId);
-  bool processes_dead = false;
-  for (std::vector< std::pair< int, float > >::iterator _signal=_signals.begin();!processes_dead &&_signal!=_signals.end();_signal++) {
-    int retval = killpg(pgroup, _signal->first);
-    LOG_TRACE(ExecutableDevice_impl,"Intitial Process Termination pid/group " << processId << "/" << pgroup << "   RET= " << retval);
-    if ( retval == -1 && errno == EPERM ) {
-      LOG_ERROR(ExecutableDevice_impl,"Error sending pid/group " << processId << "/" <<  pgroup);
-      continue;
-    }
-    if ( retval == -1 && errno == ESRCH )  { 
-      LOG_TRACE(ExecutableDevice_impl,"Process group is dead " << processId << "/" <<  pgroup);
-     processes_dead = true; 
-      continue;
-    }
-    struct timeval tv;
-    gettimeofday(&tv, NULL);
-    double now = tv.tv_sec + (((float)tv.tv_usec)/1e6) ;
-    double end_time = now + _signal->second;
-    int cnt=0;
-    while (!processes_dead && (retval != -1) and ( now < end_time )) {
-      retval = killpg(pgroup, 0);
-      LOG_TRACE(ExecutableDevice_impl,"Terminating Process.... (loop:" << cnt++ << " signal:" << _signal->first << ") pid/group " << processId << "/" << pgroup << "   RET= " << retval);
-      if (retval == -1 and (errno == ESRCH)) {
-        LOG_TRACE(ExecutableDevice_impl,"Process group terminated  " << processId << "/" <<  pgroup);
-        processes_dead = true;
-        continue;
-      }
+  if ( pgroup == -1 ) {
+    LOG_TRACE(ExecutableDevice_impl,"Process is dead " << processId);
+    return;
+  }
 
-      usleep(100000);
-      gettimeofday(&tv, NULL);
-      now = tv.tv_sec + (((double)tv.tv_usec)/1e6);
-    }
+  // Find the members of the group before signaling, so that the exit of
+  // each one can be waited on
+  ProcessWatchPtr members(new ossie::helpers::process_watch(getLiveGroupMembers(pgroup)));
+  int retval = killpg(pgroup, SIGINT);
+  LOG_TRACE(ExecutableDevice_impl,"Intitial Process Termination pid/group " << processId << "/" << pgroup << "   RET= " << retval);
+  if ( retval == -1 && errno == ESRCH )  {
+    LOG_TRACE(ExecutableDevice_impl,"Process group is dead " << processId << "/" <<  pgroup);
+    return;
+  }
+  if ( retval == -1 && errno == EPERM ) {
+    LOG_ERROR(ExecutableDevice_impl,"Error sending pid/group " << processId << "/" <<  pgroup);
+  }
+
+  // The rest of the shutdown happens in the background, so that the caller
+  // (and any other terminate calls) are not held up for the grace periods
+  try {
+    boost::thread escalation(boost::bind(&escalateTermination, processId, pgroup, members));
+    escalation.detach();
+  } catch (const boost::thread_resource_error&) {
+    LOG_WARN(ExecutableDevice_impl, "Unable to create termination thread, terminating process " << processId << " in place");
+    escalateTermination(processId, pgroup, members);
   }
 }
 
@@ -163,3 +163,149 @@ void PropertyMap::erase(iterator first, iterator last)
     // Resize to remove deleted items
     length(length()-(last-first));
 }
+
+const size_t PropertyIndex::DEFAULT_THRESHOLD;
+
+PropertyIndex::PropertyIndex(size_t threshold) :
+    _offsets(),
+    _indexed(0),
+    _valid(false),
+    _threshold(threshold)
+{
+}
+
+size_t PropertyIndex::find(const CF::Properties& properties, const std::string& id) const
+{
+    if (properties.length() < _threshold) {
+        _valid = false;
+        const PropertyMap& map = PropertyMap::cast(properties);
+        return map.find(id) - map.begin();
+    }
+
+    // The index covers every property in the sequence, so a miss means that
+    // there is no such id; owners invalidate the index on any other change
+    update(properties);
+    OffsetMap::const_iterator offset = _offsets.find(id);
+    if (offset == _offsets.end()) {
+        return properties.length();
+    }
+    return offset->second;
+}
+
+void PropertyIndex::invalidate()
+{
+    _valid = false;
+}
+
+void PropertyIndex::update(const CF::Properties& properties) const
+{
+    if (!_valid || (properties.length() < _indexed)) {
+        rebuild(properties);
+        return;
+    }
+
+    // Index properties appended since the last lookup; insert does not
+    // replace existing entries, so the first occurrence of an id wins
+    for (; _indexed < properties.length(); ++_indexed) {
+        _offsets.insert(std::make_pair(std::string(properties[_indexed].id), _indexed));
+    }
+}
+
+void PropertyIndex::rebuild(const CF::Properties& properties) const
+{
+    _offsets.clear();
+    _indexed = 0;
+    _valid = true;
+    update(properties);
+}
+
+
+IndexedPropertyMap::IndexedPropertyMap() :
+    PropertyMap(),
+    _index()
+{
+}
+
+IndexedPropertyMap::IndexedPropertyMap(const CF::Properties& properties) :
+    PropertyMap(properties),
+    _index()
+{
+}
+
+IndexedPropertyMap::IndexedPropertyMap(const IndexedPropertyMap& other) :
+    PropertyMap(other),
+    _index()
+{
+}
+
+IndexedPropertyMap& IndexedPropertyMap::operator=(const CF::Properties& properties)
+{
+    PropertyMap::operator=(properties);
+    _index.invalidate();
+    return *this;
+}
+
+IndexedPropertyMap& IndexedPropertyMap::operator=(const IndexedPropertyMap& other)
+{
+    return operator=(static_cast<const CF::Properties&>(other));
+}
+
+bool IndexedPropertyMap::contains (const std::string& id) const
+{
+    return find(id) != end();
+}
+
+Value& IndexedPropertyMap::operator[] (const std::string& id)
+{
+    iterator dt = find(id);
+    if (dt == end()) {
+        CF::DataType property;
+        property.id = id.c_str();
+        push_back(property);
+        dt = end()-1;
+    }
+    return dt->getValue();
+}
+
+const Value& IndexedPropertyMap::operator[] (const std::string& id) const
+{
+    const_iterator dt = find(id);
+    if (dt == end()) {
+        throw std::invalid_argument("id '"+id+"' not found");
+    }
+    return dt->getValue();
+}
+
+IndexedPropertyMap::iterator IndexedPropertyMap::find(const std::string& id)
+{
+    return begin() + _index.find(*this, id);
+}
+
+IndexedPropertyMap::const_iterator IndexedPropertyMap::find(const std::string& id) const
+{
+    return begin() + _index.find(*this, id);
+}
+
+void IndexedPropertyMap::erase(const std::string& id)
+{
+    erase(find(id));
+}
+
+void IndexedPropertyMap::erase(iterator pos)
+{
+    if (pos == end()) {
+        return;
+    }
+    erase(pos, pos + 1);
+}
+
+void IndexedPropertyMap::erase(iterator first, iterator last)
+{
+    PropertyMap::erase(first, last);
+    _index.invalidate();
+}
+
+void IndexedPropertyMap::reindex()
+{
+    _index.invalidate();
+}
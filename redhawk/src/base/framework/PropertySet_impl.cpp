@@ -19,6 +19,7 @@
  */
 
 
+#include <cstring>
 #include <iostream>
 
 #include "ossie/ThreadedComponent.h"
@@ -28,6 +29,7 @@
 #include "ossie/concurrent.h"
 #include "ossie/Events.h"
 #include "ossie/ossieSupport.h"
+#include "ossie/tracing.h"
 
 
 //
@@ -88,11 +90,18 @@ private:
 
 std::string PropertySet_impl::PropertyChangeRec::RSC_ID("UNK_RSC_ID");
 
+// Framework properties that every resource accepts in configure and query by
+// id; they are not part of the resource's PRF, so query-all does not return them
+static const std::string PROPERTY_MONITOR_MODE_ID("PROPERTY_CHANGE_MONITOR_MODE");
+static const std::string TRACE_ENABLED_ID("TRACE_ENABLED");
+static const std::string TRACE_DUMP_ID("TRACE_DUMP");
+
 PREPARE_CF_LOGGING(PropertySet_impl);
 
 PropertySet_impl::PropertySet_impl ():
   propertyChangePort(0),
   _propChangeThread( new PropertyChangeThread(*this), 0.1 ),
+  _propMonitorMode(POLLED_CHANGES),
   _propertiesInitialized(false)
 {
   
@@ -200,6 +209,7 @@ throw (CORBA::SystemException, CF::PropertySet::InvalidConfiguration,
 
     int validProperties = 0;
     CF::Properties invalidProperties;
+    bool dumpTrace = false;
 
     for (CORBA::ULong ii = 0; ii < configProperties.length(); ++ii) {
         PropertyInterface* property = getPropertyFromId((const char*)configProperties[ii].id);
@@ -254,6 +264,21 @@ throw (CORBA::SystemException, CF::PropertySet::InvalidConfiguration,
                 invalidProperties[count].id = CORBA::string_dup(configProperties[ii].id);
                 invalidProperties[count].value = configProperties[ii].value;
             }
+        } else if (TRACE_DUMP_ID == static_cast<const char*>(configProperties[ii].id)) {
+            // The trace is written once the lock has been released
+            CORBA::Boolean requested;
+            if (configProperties[ii].value >>= CORBA::Any::to_boolean(requested)) {
+                dumpTrace = dumpTrace || requested;
+                ++validProperties;
+            } else {
+                LOG_ERROR(PropertySet_impl, "Setting property " << TRACE_DUMP_ID << " failed.  Cause: value is not a boolean");
+                CORBA::ULong count = invalidProperties.length();
+                invalidProperties.length(count + 1);
+                invalidProperties[count].id = CORBA::string_dup(configProperties[ii].id);
+                invalidProperties[count].value = configProperties[ii].value;
+            }
+        } else if (configureFrameworkProperty(configProperties[ii])) {
+            ++validProperties;
         } else {
             CORBA::ULong count = invalidProperties.length();
             invalidProperties.length(count + 1);
@@ -261,6 +286,22 @@ throw (CORBA::SystemException, CF::PropertySet::InvalidConfiguration,
             invalidProperties[count].value = configProperties[ii].value;
         }
     }
+    lock.unlock();
+
+    if (dumpTrace) {
+        const std::string path = redhawk::tracing::dumpToDirectory();
+        if (path.empty()) {
+            LOG_ERROR(PropertySet_impl, "Setting property " << TRACE_DUMP_ID << " failed.  Cause: unable to write trace to "
+                      << redhawk::tracing::dumpDirectory());
+            --validProperties;
+            CORBA::ULong count = invalidProperties.length();
+            invalidProperties.length(count + 1);
+            invalidProperties[count].id = TRACE_DUMP_ID.c_str();
+            invalidProperties[count].value <<= CORBA::Any::from_boolean(true);
+        } else {
+            LOG_DEBUG(PropertySet_impl, "Wrote trace to " << path);
+        }
+    }
 
     if (invalidProperties.length () > 0) {
         if (validProperties > 0) {
@@ -284,23 +325,26 @@ throw (CORBA::SystemException, CF::UnknownProperties)
     // For queries of zero length, return all id/value pairs in propertySet.
     if (configProperties.length () == 0) {
         LOG_TRACE(PropertySet_impl, "Query all properties");
-        PropertyMap::iterator jj = propTable.begin();
-        for (CORBA::ULong ii = 0; ii < propTable.size(); ++ii) {
+        // Size the sequence once for all properties and trim afterwards,
+        // rather than growing (and copying) it for every property
+        configProperties.length(propTable.size());
+        CORBA::ULong count = 0;
+        for (PropertyMap::iterator jj = propTable.begin(); jj != propTable.end(); ++jj) {
             if (jj->second->isQueryable()) {
-                configProperties.length(configProperties.length()+1);
-                configProperties[configProperties.length()-1].id = CORBA::string_dup(jj->second->id.c_str());
+                configProperties[count].id = CORBA::string_dup(jj->second->id.c_str());
                 if (jj->second->isNilEnabled()) {
                     if (jj->second->isNil()) {
-                        configProperties[configProperties.length()-1].value = CORBA::Any();
+                        configProperties[count].value = CORBA::Any();
                     } else {
-                        jj->second->getValue(configProperties[configProperties.length()-1].value);
+                        jj->second->getValue(configProperties[count].value);
                     }
                 } else {
-                    jj->second->getValue(configProperties[configProperties.length()-1].value);
+                    jj->second->getValue(configProperties[count].value);
                 }
+                ++count;
             }
-            ++jj;
         }
+        configProperties.length(count);
     } else {
         // For queries of length > 0, return all requested pairs in propertySet
         CF::Properties invalidProperties;
@@ -320,6 +364,8 @@ throw (CORBA::SystemException, CF::UnknownProperties)
                 } else {
                     property->getValue(configProperties[ii].value);
                 }
+            } else if (queryFrameworkProperty(configProperties[ii])) {
+                LOG_TRACE(PropertySet_impl, "Queried framework property " << id);
             } else {
                 CORBA::ULong count = invalidProperties.length();
                 invalidProperties.length(count + 1);
@@ -438,6 +484,9 @@ char *PropertySet_impl::registerPropertyListener( CORBA::Object_ptr listener, co
     if ( prop ) {
       // check for matching propids..
      prop->addChangeListener( p->second, &PCL_Callback::recordChanged );
+     // changes are measured from the value at registration
+     prop->getValue( p->second->lastReported_ );
+     p->second->isReported_ = true;
     }
   }
 
@@ -503,6 +552,12 @@ PropertyInterface* PropertySet_impl::getPropertyFromId (const std::string& id)
 
 PropertyInterface* PropertySet_impl::getPropertyFromName (const std::string& name)
 {
+    PropertyNameMap::iterator indexed = propNames.find(name);
+    if ((indexed != propNames.end()) && isIndexed(indexed->second)) {
+        return indexed->second;
+    }
+
+    // Fall back to a search, for properties inserted into propTable directly
     for (PropertyMap::iterator property = propTable.begin(); property != propTable.end(); ++property) {
         if (name == property->second->name) {
             return property->second;
@@ -514,6 +569,11 @@ PropertyInterface* PropertySet_impl::getPropertyFromName (const std::string& nam
 
 PropertyInterface* PropertySet_impl::getPropertyFromAddress(const void* address)
 {
+    PropertyAddressMap::iterator indexed = propAddresses.find(address);
+    if ((indexed != propAddresses.end()) && isIndexed(indexed->second) && indexed->second->matchesAddress(address)) {
+        return indexed->second;
+    }
+
     for (PropertyMap::iterator property = propTable.begin(); property != propTable.end(); ++property) {
         if (property->second->matchesAddress(address)) {
             return property->second;
@@ -522,6 +582,23 @@ PropertyInterface* PropertySet_impl::getPropertyFromAddress(const void* address)
     return 0;
 }
 
+void PropertySet_impl::indexProperty(PropertyInterface* property, const void* address)
+{
+    // Names are not required to be unique; the search this replaces returned
+    // the property with the lowest id
+    PropertyNameMap::iterator named = propNames.find(property->name);
+    if ((named == propNames.end()) || !isIndexed(named->second) || (property->id < named->second->id)) {
+        propNames[property->name] = property;
+    }
+    propAddresses[address] = property;
+}
+
+bool PropertySet_impl::isIndexed(PropertyInterface* property) const
+{
+    PropertyMap::const_iterator entry = propTable.find(property->id);
+    return (entry != propTable.end()) && (entry->second == property);
+}
+
 void
 PropertySet_impl::validate (CF::Properties property,
                             CF::Properties& validProps,
@@ -612,6 +689,94 @@ void PropertySet_impl::stopPropertyChangeMonitor()
 }
 
 
+void PropertySet_impl::setPropertyMonitorMode( PropertyMonitorMode mode )
+{
+  SCOPED_LOCK(propertySetAccess);
+  _propMonitorMode = mode;
+}
+
+
+PropertySet_impl::PropertyMonitorMode PropertySet_impl::getPropertyMonitorMode() const
+{
+  return _propMonitorMode;
+}
+
+
+void PropertySet_impl::markPropertyChanged (const std::string& id)
+{
+  SCOPED_LOCK(propertySetAccess);
+  PropertyInterface *property = getPropertyFromId(id);
+  if ( !property ) {
+    LOG_WARN(PropertySet_impl, "Unable to mark change for unknown property " << id);
+    return;
+  }
+  // record the change for every registration that reports on the property
+  for ( PropertyChangeRegistry::iterator reg = _propChangeRegistry.begin(); reg != _propChangeRegistry.end(); reg++ ) {
+    PropertyReportTable::iterator rpt = reg->second.props.find(property->id);
+    if ( rpt != reg->second.props.end() ) {
+      rpt->second->recordChanged();
+    }
+  }
+}
+
+
+bool PropertySet_impl::configureFrameworkProperty (const CF::DataType& prop)
+{
+  // caller holds propertySetAccess
+  if ( PROPERTY_MONITOR_MODE_ID == static_cast<const char*>(prop.id) ) {
+    const char* mode;
+    if ( !(prop.value >>= mode) ) {
+      LOG_ERROR(PropertySet_impl, "Setting property " << PROPERTY_MONITOR_MODE_ID << " failed.  Cause: value is not a string");
+      return false;
+    }
+    if ( strcmp(mode, "POLLED") == 0 ) {
+      _propMonitorMode = POLLED_CHANGES;
+    } else if ( strcmp(mode, "SETTER") == 0 ) {
+      _propMonitorMode = SETTER_CHANGES;
+    } else {
+      LOG_ERROR(PropertySet_impl, "Setting property " << PROPERTY_MONITOR_MODE_ID << " failed.  Cause: unknown mode " << mode);
+      return false;
+    }
+    LOG_DEBUG(PropertySet_impl, "Property change monitor mode: " << mode);
+    return true;
+  }
+  if ( TRACE_ENABLED_ID == static_cast<const char*>(prop.id) ) {
+    CORBA::Boolean enabled;
+    if ( !(prop.value >>= CORBA::Any::to_boolean(enabled)) ) {
+      LOG_ERROR(PropertySet_impl, "Setting property " << TRACE_ENABLED_ID << " failed.  Cause: value is not a boolean");
+      return false;
+    }
+    if ( enabled ) {
+      redhawk::tracing::enable();
+    } else {
+      redhawk::tracing::disable();
+    }
+    LOG_DEBUG(PropertySet_impl, "Tracing " << (enabled ? "enabled" : "disabled"));
+    return true;
+  }
+  return false;
+}
+
+
+bool PropertySet_impl::queryFrameworkProperty (CF::DataType& prop)
+{
+  // caller holds propertySetAccess
+  if ( PROPERTY_MONITOR_MODE_ID == static_cast<const char*>(prop.id) ) {
+    prop.value <<= (_propMonitorMode == SETTER_CHANGES) ? "SETTER" : "POLLED";
+    return true;
+  }
+  if ( TRACE_ENABLED_ID == static_cast<const char*>(prop.id) ) {
+    prop.value <<= CORBA::Any::from_boolean(redhawk::tracing::isEnabled());
+    return true;
+  }
+  if ( TRACE_DUMP_ID == static_cast<const char*>(prop.id) ) {
+    prop.value <<= redhawk::tracing::lastDumpPath().c_str();
+    return true;
+  }
+  return false;
+}
+
+
 int PropertySet_impl::_propertyChangeServiceFunction() 
 {
   LOG_TRACE(PropertySet_impl, "Starting property change service function.");
@@ -619,6 +784,8 @@ int PropertySet_impl::_propertyChangeServiceFunction()
   {
     SCOPED_LOCK(propertySetAccess);
 
+    const bool setter_changes = (_propMonitorMode == SETTER_CHANGES);
+
     // get current time stamp....
     boost::posix_time::ptime now = boost::posix_time::microsec_clock::local_time();
 
@@ -630,8 +797,9 @@ int PropertySet_impl::_propertyChangeServiceFunction()
       LOG_DEBUG(PropertySet_impl, "Change Listener ... reg_id/interval :" << rec->regId << "/" << rec->reportInterval.total_milliseconds());
 
       PropertyReportTable::iterator rpt_iter = rec->props.begin();
-      // check all registered properties for changes
-      for( ; rpt_iter != rec->props.end() && _propChangeThread.threadRunning(); rpt_iter++) {
+      // in polled mode, compare all registered properties against their monitors; setter
+      // changes have already been recorded by the property's change listeners
+      for( ; !setter_changes && rpt_iter != rec->props.end() && _propChangeThread.threadRunning(); rpt_iter++) {
 	// check if property changed
 	LOG_DEBUG(PropertySet_impl, "   Property/set :" << rpt_iter->first << "/" << rpt_iter->second->isSet());
 	try{
@@ -647,30 +815,47 @@ int PropertySet_impl::_propertyChangeServiceFunction()
       boost::posix_time::time_duration dur = rec->expiration - now;
       LOG_DEBUG(PropertySet_impl, "   Check for expiration, dur=" << dur.total_milliseconds() );
       if ( dur.total_milliseconds()  <= 0 )  {
+        // batch all changes for this registration into a single notification
         CF::Properties  rpt_props;
+        rpt_props.length( rec->props.size() );
         CORBA::ULong idx = 0;
 	PropertyReportTable::iterator rpt_iter = rec->props.begin();
         // check all registered properties for changes
 	for( ; rpt_iter != rec->props.end() && _propChangeThread.threadRunning(); rpt_iter++) {
 	  LOG_DEBUG(PropertySet_impl, "   Sending Change Property/set :" << rpt_iter->first << "/" << rpt_iter->second->isChanged());
-	  if (rpt_iter->second->isChanged() ) {
-                
-	    // add to reporting change list
-	    idx = rpt_props.length();
-	    rpt_props.length( idx+1 );
-	    rpt_props[idx].id     = CORBA::string_dup(rpt_iter->first.c_str());
-	    LOG_DEBUG(PropertySet_impl, "   Getting getValue from property....prop: " << rpt_iter->first << " reg_id:" << rec->regId );
+	  // in setter mode, a member assigned directly by the component is not marked
+	  // as changed, so every registered property is compared with its last report
+	  if (rpt_iter->second->isChanged() || setter_changes ) {
+
+            // reset change indicator for next reporting cycle
+	    rpt_iter->second->reset();
+
+	    CORBA::Any value;
 	    PropertyInterface *property = getPropertyFromId(rpt_iter->first);
 	    if ( property ) {
 	      LOG_DEBUG(PropertySet_impl, "   Getting getValue from property....prop: " << rpt_iter->first << " reg_id:" << rec->regId );
-	      property->getValue( rpt_props[idx].value );
+	      property->getValue( value );
+
+	      // only report values that differ from the last notification, setters
+	      // may have changed the value and then restored it within the interval
+	      if ( setter_changes ) {
+	        if ( rpt_iter->second->isReported_ && property->compare( rpt_iter->second->lastReported_ ) == 0 ) {
+	          LOG_DEBUG(PropertySet_impl, "   Unchanged since last report, prop: " << rpt_iter->first << " reg_id:" << rec->regId );
+	          continue;
+	        }
+	      }
+	      rpt_iter->second->lastReported_ = value;
+	      rpt_iter->second->isReported_ = true;
 	    }
-            
-            // reset change indicator for next reporting cycle
-	    rpt_iter->second->reset();
+
+	    // add to reporting change list
+	    rpt_props[idx].id     = CORBA::string_dup(rpt_iter->first.c_str());
+	    rpt_props[idx].value  = value;
+	    idx++;
 	  }
 
 	}
+	rpt_props.length( idx );
 
 
 	// publish changes to listener
@@ -686,16 +871,17 @@ int PropertySet_impl::_propertyChangeServiceFunction()
 	dur = rec->reportInterval;
       }
 
-      if ( _propChangeRegistry.size() > 0 ) {
-	for( PropertyMonitorTable::iterator ii=_propMonitors.begin(); ii != _propMonitors.end();  ii++) ii->second->reset();
-      }
-      
       // determine delay interval based on shortest remaining duration interval
       if ( delay == 0 ) delay=dur.total_milliseconds();
       LOG_DEBUG(PropertySet_impl, "   Test for delay/duration (millisecs) ... :" << delay << "/" << dur.total_milliseconds());
       if ( dur.total_milliseconds() > 0 ) delay = std::min( delay, (time_t)dur.total_milliseconds() );
       LOG_DEBUG(PropertySet_impl, "   Minimum  delay (millisecs) ... :" << delay );
     }
+
+    // take a new snapshot once every registration has been checked against the current one
+    if ( !setter_changes && _propChangeRegistry.size() > 0 ) {
+      for( PropertyMonitorTable::iterator ii=_propMonitors.begin(); ii != _propMonitors.end();  ii++) ii->second->reset();
+    }
   }     
 
   LOG_DEBUG(PropertySet_impl, "Request sleep delay........(millisecs) :" << delay);
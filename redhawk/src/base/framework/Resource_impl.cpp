@@ -22,6 +22,7 @@
 
 #include "ossie/Resource_impl.h"
 #include "ossie/Events.h"
+#include "ossie/tracing.h"
 
 PREPARE_CF_LOGGING(Resource_impl)
 
@@ -207,6 +208,7 @@ void Resource_impl::start_component(Resource_impl::ctor_type ctor, int argc, cha
     std::map<std::string, char*> execparams;
     std::string logcfg_uri("");
     std::string dpath("");
+    std::string trace_path("");
     bool skip_run = false;
 
     // Parse execparams.
@@ -227,6 +229,8 @@ void Resource_impl::start_component(Resource_impl::ctor_type ctor, int argc, cha
             debug_level = atoi(argv[++i]);
         } else if (strcmp("DOM_PATH", argv[i]) == 0) {
             dpath = argv[++i];
+        } else if (strcmp("TRACE", argv[i]) == 0) {
+            trace_path = argv[++i];
         } else if (strcmp("-i", argv[i]) == 0) {
             standAlone = true;
         } else if (strcmp("SKIP_RUN", argv[i]) == 0) {
@@ -271,6 +275,12 @@ void Resource_impl::start_component(Resource_impl::ctor_type ctor, int argc, cha
         ossie::logging::Configure(logcfg_uri, debug_level, ctx);
     }
 
+    // Start recording spans before the component is created, so that any
+    // threads it starts are traced from the beginning
+    if (!trace_path.empty() && !skip_run) {
+        redhawk::tracing::dumpOnSignal(trace_path);
+    }
+
     Resource_impl* resource = 0;
     try {
         // Create the servant.
@@ -348,6 +358,10 @@ void Resource_impl::start_component(Resource_impl::ctor_type ctor, int argc, cha
             resource->run();
             LOG_TRACE(Resource_impl, "Component run loop terminated");
 
+            if (!trace_path.empty() && !redhawk::tracing::dump(trace_path)) {
+                LOG_WARN(Resource_impl, "Unable to write trace to " << trace_path);
+            }
+
             // Ignore SIGINT from here on out to ensure that the ORB gets shut down
             // properly
             sa.sa_handler = SIG_IGN;
@@ -19,6 +19,8 @@
  */
 
 #include <ossie/ThreadedComponent.h>
+#include <ossie/affinity.h>
+#include <ossie/tracing.h>
 
 namespace ossie {
 
@@ -41,8 +43,13 @@ void ProcessThread::start()
 
 void ProcessThread::run()
 {
+    redhawk::affinity::set_thread_affinity(redhawk::affinity::SERVICE_THREAD);
     while (_running) {
-        int state = _target->serviceFunction();
+        int state;
+        {
+            RH_TRACE_SPAN("component", "serviceFunction");
+            state = _target->serviceFunction();
+        }
         if (state == FINISH) {
             return;
         } else if (state == NOOP) {
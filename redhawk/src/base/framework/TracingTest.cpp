@@ -0,0 +1,215 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK core.
+ *
+ * REDHAWK core is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * REDHAWK core is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+//
+// Checks that the per-thread span buffers keep only the newest spans once they
+// wrap around, that dump() writes them as Chrome trace JSON, and that
+// dumpToDirectory() writes a new file in the dump directory each time.
+//
+
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include <unistd.h>
+
+#include <boost/thread/thread.hpp>
+
+#include <ossie/tracing.h>
+
+namespace {
+
+    const char* SPAN_NAMES[] = {
+        "span0", "span1", "span2", "span3", "span4",
+        "span5", "span6", "span7", "span8", "span9"
+    };
+    const size_t NUM_SPANS = sizeof(SPAN_NAMES) / sizeof(SPAN_NAMES[0]);
+
+    // Small enough that the spans wrap around the buffer more than once
+    const size_t BUFFER_SIZE = 4;
+
+    int failures = 0;
+
+    void check(bool condition, const std::string& message)
+    {
+        if (!condition) {
+            std::cerr << "FAILED: " << message << std::endl;
+            ++failures;
+        }
+    }
+
+    std::string dumpToString()
+    {
+        std::ostringstream out;
+        redhawk::tracing::dump(out);
+        return out.str();
+    }
+
+    size_t countOf(const std::string& text, const std::string& pattern)
+    {
+        size_t count = 0;
+        for (size_t pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1)) {
+            ++count;
+        }
+        return count;
+    }
+
+    std::string spanEvent(size_t index)
+    {
+        // Spans begin at index microseconds and last 1.5 microseconds
+        std::ostringstream event;
+        event << "\"ph\":\"X\",\"cat\":\"test\",\"name\":\"" << SPAN_NAMES[index] << "\"";
+        return event.str();
+    }
+
+    std::string spanTiming(size_t index)
+    {
+        std::ostringstream timing;
+        timing << "\"ts\":" << index << ".000,\"dur\":1.500}";
+        return timing.str();
+    }
+
+    void recordSpans()
+    {
+        for (size_t index = 0; index < NUM_SPANS; ++index) {
+            const unsigned long long begin = index * 1000;
+            redhawk::tracing::record("test", SPAN_NAMES[index], begin, begin + 1500);
+        }
+    }
+
+    // Checks that exactly the spans [first, NUM_SPANS) appear, in order
+    void checkSpans(const std::string& label, const std::string& trace, size_t first)
+    {
+        check(countOf(trace, "\"ph\":\"X\"") == (NUM_SPANS - first), label + ": wrong number of spans");
+        size_t last = 0;
+        for (size_t index = 0; index < NUM_SPANS; ++index) {
+            const size_t pos = trace.find(spanEvent(index));
+            if (index < first) {
+                check(pos == std::string::npos, label + ": overwritten span " + SPAN_NAMES[index] + " was written");
+                continue;
+            }
+            check(pos != std::string::npos, label + ": span " + SPAN_NAMES[index] + " is missing");
+            if (pos == std::string::npos) {
+                continue;
+            }
+            check(pos > last, label + ": span " + SPAN_NAMES[index] + " is out of order");
+            last = pos;
+            // Each event is on its own line
+            const size_t timing = trace.find(spanTiming(index), pos);
+            check((timing != std::string::npos) && (timing < trace.find('\n', pos)),
+                  label + ": span " + SPAN_NAMES[index] + " has the wrong timestamp");
+        }
+    }
+
+    std::string readFile(const std::string& path)
+    {
+        std::ifstream in(path.c_str());
+        return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    }
+
+    void checkDocument(const std::string& label, const std::string& trace)
+    {
+        const std::string header = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+        const std::string footer = "\n]}\n";
+        check(trace.compare(0, header.size(), header) == 0, label + ": missing trace header");
+        check((trace.size() >= footer.size()) && (trace.compare(trace.size() - footer.size(), footer.size(), footer) == 0),
+              label + ": missing trace footer");
+        check(countOf(trace, "{") == countOf(trace, "}"), label + ": unbalanced braces");
+        check(trace.find(",,") == std::string::npos, label + ": empty array element");
+        check(trace.find("[,") == std::string::npos, label + ": leading comma");
+    }
+}
+
+int main()
+{
+    redhawk::tracing::setBufferSize(BUFFER_SIZE);
+    redhawk::tracing::enable();
+
+    // A thread that has exited is no longer writing, so every slot in its
+    // buffer is valid
+    boost::thread worker(&recordSpans);
+    worker.join();
+    std::string trace = dumpToString();
+    checkDocument("exited thread", trace);
+    checkSpans("exited thread", trace, NUM_SPANS - BUFFER_SIZE);
+    check(countOf(trace, "\"ph\":\"M\",\"name\":\"thread_name\"") == 1, "exited thread: missing thread name");
+
+    // For a live thread, the oldest slot may be the one being overwritten, so
+    // it is left out
+    redhawk::tracing::clear();
+    recordSpans();
+    trace = dumpToString();
+    checkDocument("live thread", trace);
+    checkSpans("live thread", trace, NUM_SPANS - BUFFER_SIZE + 1);
+
+    // Fewer spans than the buffer holds are all kept
+    redhawk::tracing::clear();
+    redhawk::tracing::record("test", SPAN_NAMES[NUM_SPANS - 2], (NUM_SPANS - 2) * 1000, (NUM_SPANS - 2) * 1000 + 1500);
+    redhawk::tracing::record("test", SPAN_NAMES[NUM_SPANS - 1], (NUM_SPANS - 1) * 1000, (NUM_SPANS - 1) * 1000 + 1500);
+    trace = dumpToString();
+    checkDocument("partial buffer", trace);
+    checkSpans("partial buffer", trace, NUM_SPANS - 2);
+
+    // Strings are escaped
+    redhawk::tracing::clear();
+    redhawk::tracing::record("test", "quote\" backslash\\ tab\t", 0, 1);
+    trace = dumpToString();
+    checkDocument("escaping", trace);
+    check(trace.find("\"name\":\"quote\\\" backslash\\\\ tab \"") != std::string::npos, "escaping: name was not escaped");
+
+    // Spans are not recorded while tracing is disabled
+    redhawk::tracing::clear();
+    redhawk::tracing::disable();
+    {
+        redhawk::tracing::Span span("test", "disabled");
+    }
+    trace = dumpToString();
+    checkDocument("disabled", trace);
+    check(countOf(trace, "\"ph\":\"X\"") == 0, "disabled: span was recorded");
+
+    // Dumps to the dump directory get generated, distinct file names
+    char directory[] = "/tmp/tracetestXXXXXX";
+    if (!mkdtemp(directory)) {
+        check(false, "dump directory: unable to create temporary directory");
+    } else {
+        redhawk::tracing::setDumpDirectory(directory);
+        check(redhawk::tracing::dumpDirectory() == directory, "dump directory: directory was not set");
+        const std::string first = redhawk::tracing::dumpToDirectory();
+        const std::string second = redhawk::tracing::dumpToDirectory();
+        const std::string prefix = std::string(directory) + "/trace-";
+        check(first.compare(0, prefix.size(), prefix) == 0, "dump directory: trace written elsewhere");
+        check(!first.empty() && (first != second), "dump directory: file names are not distinct");
+        check(redhawk::tracing::lastDumpPath() == second, "dump directory: last path was not updated");
+        checkDocument("dump directory", readFile(first));
+        checkDocument("dump directory", readFile(second));
+        unlink(first.c_str());
+        unlink(second.c_str());
+        rmdir(directory);
+    }
+
+    if (failures) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -22,8 +22,12 @@
 #include <sstream>
 #include <list>
 #include <string>
+#include <cstring>
 #include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
 #include <boost/algorithm/string.hpp>
+#include <boost/thread/once.hpp>
 #ifdef HAVE_LIBNUMA
 #include <numa.h>
 #endif
@@ -50,6 +54,13 @@
 //     nic : interface string naem, assign processing affinity for cpu id or nodes that service hardware interrupts for the nic
 //     cgroup : name of the cgroup to add the resource to (i.e process id of resource). Follows rhel/centos group directory 
 //              path ( "/cgroup/cgroup_name/task" )
+//
+// id = affinity::service_thread, affinity::orb_worker, affinity::port_monitor
+//   Per thread directives as class:value, where class is socket, cpu or nic. Applied by the
+//   resource's framework threads to themselves (see set_thread_affinity)
+//
+// id = affinity::buffer_alloc
+//   Memory policy for threads that allocate port sample buffers, local or socket:<node string>
 
 static std::string _AFFINITY_PROPS_( "<?xml version=\"1.0\" encoding=\"UTF-8\"?> \
 <!DOCTYPE properties PUBLIC \"-//JTRS//DTD SCA V2.2.2 PRF//EN\" \"properties.dtd\"> \
@@ -71,6 +82,26 @@ static std::string _AFFINITY_PROPS_( "<?xml version=\"1.0\" encoding=\"UTF-8\"?>
       <kind kindtype=\"configure\"/> \
       <action type=\"external\"/> \
     </simple> \
+   <simple id=\"affinity::service_thread\" mode=\"readwrite\" name=\"service_thread\" type=\"string\" optional=\"true\"> \
+      <description>Affinity for the resource's service thread as class:value, class is socket, cpu or nic.</description> \
+      <kind kindtype=\"property\"/> \
+      <action type=\"external\"/> \
+    </simple> \
+   <simple id=\"affinity::orb_worker\" mode=\"readwrite\" name=\"orb_worker\" type=\"string\" optional=\"true\"> \
+      <description>Affinity for the resource's ORB dispatch threads as class:value, class is socket, cpu or nic.</description> \
+      <kind kindtype=\"property\"/> \
+      <action type=\"external\"/> \
+    </simple> \
+   <simple id=\"affinity::port_monitor\" mode=\"readwrite\" name=\"port_monitor\" type=\"string\" optional=\"true\"> \
+      <description>Affinity for port monitor threads as class:value, class is socket, cpu or nic.</description> \
+      <kind kindtype=\"property\"/> \
+      <action type=\"external\"/> \
+    </simple> \
+   <simple id=\"affinity::buffer_alloc\" mode=\"readwrite\" name=\"buffer_alloc\" type=\"string\" optional=\"true\"> \
+      <description>Memory policy for port sample buffers, local or socket:node</description> \
+      <kind kindtype=\"property\"/> \
+      <action type=\"external\"/> \
+    </simple> \
 </properties> \
  ");
 
@@ -630,13 +661,14 @@ namespace  redhawk {
                     throw AffinityFailed("Processor Socket affinity failed, unable to parse:  " + nodestr);
                 }
         
-                // plain  node binding if no cpus are listed.
-                if ( blacklist.size() == 0 ) {
+                // plain  node binding if no cpus are listed and this is our
+                // own process; numa_bind cannot be applied to another process
+                if ( blacklist.size() == 0 && getpid() == pid ) {
                     // bind to node... let system scheduler do its magic
                     RH_DEBUG(_affinity_logger, "Setting PROCESSOR SOCKET affinity to constraint :" << nodestr );
                     numa_bind( node_mask );
                 }
-                else { // remove blacklisted cpus from node binding
+                else { // bind to the node's cpus, less any blacklisted ones
                     bitmask *cpu_mask = numa_allocate_cpumask(); 
                     if ( !cpu_mask ) {
                         throw AffinityFailed("Unable to allocate cpu mask");
@@ -701,7 +733,6 @@ namespace  redhawk {
         // cpuset -- assign via cpuset
         if ( affinity_spec.first == "cpuset" ) {
           std::string cpuset_name = affinity_spec.second;
-          pid_t pid = getpid();
           std::string croot(get_cpuset_root());
           std::string sname( croot+"/"+cpuset_name+"/task");
           std::ofstream os(sname.c_str(), std::ofstream::out);
@@ -718,7 +749,6 @@ namespace  redhawk {
         // cgroup - assign to cgroup
         if ( affinity_spec.first == "cgroup" ) {
           std::string cgroup_name = affinity_spec.second;
-          pid_t pid = getpid();
           std::string croot(get_cgroup_root());
           std::string sname( croot + "/" + cgroup_name+"/task");
           std::ofstream os(sname.c_str(), std::ofstream::out);
@@ -739,6 +769,252 @@ namespace  redhawk {
 
     }
 
+
+    //
+    // Thread role directives, loaded once from the process environment
+    //
+    static const char *_thread_role_ids[THREAD_ROLE_COUNT] = {
+      "affinity::service_thread",
+      "affinity::orb_worker",
+      "affinity::port_monitor",
+      "affinity::buffer_alloc"
+    };
+
+    static AffinityDirective  _thread_directives[THREAD_ROLE_COUNT];
+    static boost::once_flag   _thread_directives_once = BOOST_ONCE_INIT;
+
+    //
+    // split a "class:value" string into a directive record, a value without a class (i.e. "local") 
+    // is returned as the class
+    //
+    static AffinityDirective _parse_thread_directive( const std::string &value ) {
+      AffinityDirective directive;
+      std::string::size_type pos = value.find(':');
+      if ( pos == std::string::npos ) {
+        directive.first = boost::trim_copy(value);
+      }
+      else {
+        directive.first = boost::trim_copy(value.substr(0, pos));
+        directive.second = boost::trim_copy(value.substr(pos+1));
+      }
+      return directive;
+    }
+
+    static int _find_thread_role( const std::string &id ) {
+      for ( int i=0; i < THREAD_ROLE_COUNT; i++ ) {
+        if ( boost::iequals(id, _thread_role_ids[i]) ) return i;
+      }
+      return -1;
+    }
+
+    static void _load_thread_directives() {
+      const char *env = std::getenv(THREAD_AFFINITY_ENV.c_str());
+      if ( env == NULL ) return;
+
+      std::vector< std::string > entries;
+      std::string envstr(env);
+      boost::split( entries, envstr, boost::is_any_of(";"), boost::token_compress_on );
+      std::vector< std::string >::iterator iter = entries.begin();
+      for ( ; iter != entries.end(); iter++ ) {
+        std::string::size_type pos = iter->find('=');
+        if ( pos == std::string::npos ) continue;
+        int role = _find_thread_role( iter->substr(0, pos) );
+        if ( role < 0 ) {
+          RH_WARN(_affinity_logger, "Ignoring unknown thread affinity directive: " << *iter );
+          continue;
+        }
+        _thread_directives[role] = _parse_thread_directive( iter->substr(pos+1) );
+        RH_DEBUG(_affinity_logger, "Thread affinity directive, role/class/value: " << _thread_role_ids[role] << "/" << 
+                 _thread_directives[role].first << "/" << _thread_directives[role].second );
+      }
+    }
+
+    std::string get_thread_role_id( const ThreadRole role ) {
+      if ( role < 0 || role >= THREAD_ROLE_COUNT ) return std::string();
+      return _thread_role_ids[role];
+    }
+
+    AffinityDirectives convert_thread_properties( const CF::Properties& options ) {
+      AffinityDirectives spec;
+
+      const redhawk::PropertyMap ops(options);
+      std::string aid  = AFFINITY_ID;
+      if ( ops.contains(aid) == false ) {
+        aid  = boost::to_upper_copy( aid );
+        if ( ops.contains(aid) == false ) {
+          return spec;
+        }
+      }
+
+      const redhawk::PropertyMap affinity_map(ops[aid].asProperties());
+      redhawk::PropertyMap::const_iterator iter = affinity_map.begin();
+      for ( ; iter != affinity_map.end(); iter++ ) {
+        int role = _find_thread_role( iter->getId() );
+        if ( role < 0 ) continue;
+        const std::string value = iter->getValue().toString();
+        if ( value.empty() ) continue;
+        RH_DEBUG(_affinity_logger, "Thread affinity directive ..:" << _thread_role_ids[role] << "/" << value );
+        spec.push_back( AffinityDirective( _thread_role_ids[role], value ) );
+      }
+      return spec;
+    }
+
+    bool has_thread_affinity( const CF::Properties &options ) {
+      return !convert_thread_properties(options).empty();
+    }
+
+    std::string format_thread_directives( const CF::Properties& options ) {
+      if ( is_disabled() ) {
+        return std::string();
+      }
+
+      AffinityDirectives spec = convert_thread_properties( options );
+      std::ostringstream os;
+      AffinityDirectives::const_iterator iter = spec.begin();
+      for ( ; iter != spec.end(); iter++ ) {
+        if ( iter != spec.begin() ) os << ";";
+        os << iter->first << "=" << iter->second;
+      }
+      return os.str();
+    }
+
+    std::vector<std::string> thread_environment( const CF::Properties& options ) {
+      const std::string directives = format_thread_directives( options );
+      const std::string prefix = THREAD_AFFINITY_ENV + "=";
+      std::vector<std::string> environment;
+      for ( char** var = environ; *var; ++var ) {
+        if ( !directives.empty() && strncmp( *var, prefix.c_str(), prefix.size() ) == 0 ) continue;
+        environment.push_back( *var );
+      }
+      if ( !directives.empty() ) {
+        RH_DEBUG(_affinity_logger, "Exporting thread affinity directives: " << directives );
+        environment.push_back( prefix + directives );
+      }
+      return environment;
+    }
+
+    AffinityDirective get_thread_directive( const ThreadRole role ) {
+      boost::call_once( _load_thread_directives, _thread_directives_once );
+      if ( role < 0 || role >= THREAD_ROLE_COUNT ) return AffinityDirective();
+      return _thread_directives[role];
+    }
+
+    void set_thread_directive( const ThreadRole role, const AffinityDirective &directive ) {
+      boost::call_once( _load_thread_directives, _thread_directives_once );
+      if ( role < 0 || role >= THREAD_ROLE_COUNT ) return;
+      _thread_directives[role] = directive;
+    }
+
+    //
+    // Apply memory allocation policy to the calling thread, used for threads that allocate port buffers
+    //
+    static int _set_thread_mempolicy( const AffinityDirective &directive ) {
+#ifdef HAVE_LIBNUMA
+      if ( numa_available() == -1 ) {
+        RH_WARN(_affinity_logger, "Missing affinity support from Redhawk libraries, ... ignoring buffer allocation policy ");
+        return 0;
+      }
+
+      if ( directive.first == "local" ) {
+        RH_DEBUG(_affinity_logger, "Setting thread buffer allocation policy to local node");
+        numa_set_localalloc();
+        return 0;
+      }
+
+      if ( directive.first == "socket" || directive.first == "node" ) {
+        struct bitmask *node_mask = numa_parse_nodestring((char *)directive.second.c_str());
+        if ( !node_mask )  {
+          throw AffinityFailed("Buffer allocation policy failed, unable to parse:  " + directive.second);
+        }
+        int nbytes = numa_bitmask_nbytes(node_mask);
+        for (int i=0; i < nbytes*8; i++ ){
+          if ( numa_bitmask_isbitset( node_mask, i ) ) {
+            RH_DEBUG(_affinity_logger, "Setting thread buffer allocation policy, preferred node:" << i );
+            numa_set_preferred(i);
+            break;
+          }
+        }
+        numa_bitmask_free(node_mask);
+        return 0;
+      }
+
+      throw AffinityFailed("Unsupported buffer allocation policy: " + directive.first);
+#else
+      RH_WARN(_affinity_logger, "Missing affinity support from Redhawk libraries, ... ignoring buffer allocation policy ");
+      return 0;
+#endif
+    }
+
+    int set_thread_affinity( const AffinityDirective &directive, const pid_t tid, const CpuList &blacklist )
+      throw (AffinityFailed)
+    {
+      if ( is_disabled() || directive.first.empty() ) {
+        return 0;
+      }
+
+      pid_t target = tid;
+      if ( target == 0 ) {
+        target = (pid_t)syscall(SYS_gettid);
+      }
+
+      CpuList cpulist;
+      if ( directive.first == "nic" ) {
+        cpulist = identify_cpus( directive.second );
+      }
+      else if ( directive.first == "socket" || directive.first == "node" || directive.first == "cpu" ) {
+        cpulist = get_cpu_list( directive.first, directive.second );
+      }
+      else {
+        throw AffinityFailed("Unsupported thread affinity directive: " + directive.first );
+      }
+
+      cpu_set_t cpu_mask;
+      CPU_ZERO(&cpu_mask);
+      int cpus=0;
+      for( int i=0; i < (int)cpulist.size();i++ ) {
+        if ( std::count( blacklist.begin(), blacklist.end(), cpulist[i] ) != 0  ) continue;
+        CPU_SET( cpulist[i], &cpu_mask );
+        cpus++;
+      }
+
+      if ( cpus == 0 ) {
+        std::ostringstream e;
+        e << "Thread affinity, no cpus available for directive: " << directive.first << ":" << directive.second;
+        throw AffinityFailed(e.str());
+      }
+
+      RH_DEBUG(_affinity_logger, "Setting thread affinity, tid/constraint:" << target << "/" << directive.first << ":" << directive.second );
+      if ( sched_setaffinity( target, sizeof(cpu_mask), &cpu_mask ) ) {
+        std::ostringstream e;
+        e << "Binding thread " << target << " to " << directive.first << ":" << directive.second;
+        throw AffinityFailed(e.str());
+      }
+
+      return 0;
+    }
+
+    int set_thread_affinity( const ThreadRole role ) {
+      if ( is_disabled() ) {
+        return 0;
+      }
+
+      AffinityDirective directive = get_thread_directive(role);
+      if ( directive.first.empty() ) {
+        return 0;
+      }
+
+      try {
+        if ( role == BUFFER_ALLOC ) {
+          return _set_thread_mempolicy( directive );
+        }
+        return set_thread_affinity( directive );
+      }
+      catch( AffinityFailed &e ) {
+        RH_WARN(_affinity_logger, "Unable to apply thread affinity, role: " << get_thread_role_id(role) << " Reason: " << e.what() );
+      }
+      return -1;
+    }
+
   };
 
 };
@@ -20,9 +20,24 @@
 
 
 #include <string>
+#include <algorithm>
+#include <errno.h>
+#include <poll.h>
+#include <cstdio>
+#include <cstring>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/syscall.h>
 #include <uuid/uuid.h>
+#include <boost/date_time/posix_time/posix_time.hpp>
 #include <ossie/ossieSupport.h>
 
+// pidfd_open has the same number on all architectures, but may not be
+// defined by older system headers
+#ifndef SYS_pidfd_open
+#define SYS_pidfd_open 434
+#endif
+
 std::string ossie::generateUUID()
 {
     uuid_t id;
@@ -86,6 +101,99 @@ namespace ossie {
       return retval;
     };
 
+
+    int open_process_fd( const pid_t pid ) {
+      // kernels prior to 5.3 fail with ENOSYS
+      return syscall(SYS_pidfd_open, pid, 0);
+    };
+
+
+    bool is_process_running( const pid_t pid ) {
+      if ( kill(pid, 0) == -1 && errno == ESRCH ) return false;
+
+      // the state follows the command name, which may contain spaces
+      char path[64];
+      snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+      FILE *file = fopen(path, "r");
+      if ( !file ) return (errno != ENOENT);
+      char buffer[512];
+      size_t length = fread(buffer, 1, sizeof(buffer)-1, file);
+      fclose(file);
+      buffer[length] = '\0';
+      const char *fields = strrchr(buffer, ')');
+      char state;
+      if ( fields && sscanf(fields + 1, " %c", &state) == 1 ) {
+        return (state != 'Z') && (state != 'X');
+      }
+      return true;
+    };
+
+
+    process_watch::process_watch( const std::vector<pid_t> &pids ) {
+      for ( std::vector<pid_t>::const_iterator pid = pids.begin(); pid != pids.end(); ++pid ) {
+        if ( !is_process_running(*pid) ) continue;
+        int fd = open_process_fd(*pid);
+        if ( fd >= 0 ) {
+          struct pollfd pfd = { fd, POLLIN, 0 };
+          _fds.push_back(pfd);
+        } else {
+          _checked.push_back(*pid);
+        }
+      }
+    };
+
+
+    process_watch::~process_watch() {
+      for ( std::vector<struct pollfd>::iterator fd = _fds.begin(); fd != _fds.end(); ++fd ) {
+        close(fd->fd);
+      }
+    };
+
+
+    size_t process_watch::wait( const double timeout ) {
+      // interval for checking processes that do not have a descriptor
+      const long check_interval = 10; // milliseconds
+      const boost::posix_time::ptime end = boost::posix_time::microsec_clock::universal_time() +
+        boost::posix_time::microseconds((long)(timeout*1e6));
+
+      // descriptors are readable once the process has exited, even if it has not been reaped
+      if ( !_fds.empty() ) poll(&_fds[0], _fds.size(), 0);
+
+      while ( true ) {
+        // drop processes that have exited
+        for ( std::vector<struct pollfd>::iterator fd = _fds.begin(); fd != _fds.end(); ) {
+          if ( fd->revents != 0 ) {
+            close(fd->fd);
+            fd = _fds.erase(fd);
+          } else {
+            ++fd;
+          }
+        }
+        for ( std::vector<pid_t>::iterator pid = _checked.begin(); pid != _checked.end(); ) {
+          if ( !is_process_running(*pid) ) {
+            pid = _checked.erase(pid);
+          } else {
+            ++pid;
+          }
+        }
+        if ( _fds.empty() && _checked.empty() ) break;
+
+        long remaining = (end - boost::posix_time::microsec_clock::universal_time()).total_milliseconds();
+        if ( remaining <= 0 ) break;
+        if ( !_checked.empty() ) remaining = std::min(remaining, check_interval);
+
+        if ( poll(_fds.empty() ? NULL : &_fds[0], _fds.size(), remaining) == -1 && errno != EINTR ) break;
+      }
+
+      return _fds.size() + _checked.size();
+    };
+
+
+    size_t wait_for_exit( const std::vector<pid_t> &pids, const double timeout ) {
+      process_watch watch(pids);
+      return watch.wait(timeout);
+    };
+
   };
 
 };
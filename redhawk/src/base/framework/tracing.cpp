@@ -0,0 +1,430 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK core.
+ *
+ * REDHAWK core is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * REDHAWK core is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <list>
+#include <sstream>
+#include <vector>
+
+#include <errno.h>
+#include <limits.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/tss.hpp>
+
+#include <ossie/tracing.h>
+#include <ossie/debug.h>
+
+namespace redhawk {
+namespace tracing {
+
+CREATE_LOGGER(Tracing);
+
+namespace detail {
+    volatile bool enabled = false;
+}
+
+namespace {
+
+    struct Event {
+        const char* category;
+        const char* name;
+        unsigned long long begin;
+        unsigned long long end;
+    };
+
+    // Ring buffer of spans for a single thread. Only the owning thread
+    // writes; dump() may read concurrently, and uses the total count to
+    // detect entries that were overwritten while they were being copied.
+    class ThreadBuffer {
+    public:
+        ThreadBuffer(size_t capacity) :
+            _events(capacity),
+            _count(0),
+            _exited(false)
+        {
+            _tid = syscall(SYS_gettid);
+            char name[16] = "";
+            prctl(PR_GET_NAME, name, 0, 0, 0);
+            _name = name;
+        }
+
+        void push(const char* category, const char* name, unsigned long long begin, unsigned long long end)
+        {
+            Event& event = _events[_count % _events.size()];
+            event.category = category;
+            event.name = name;
+            event.begin = begin;
+            event.end = end;
+            // Publish the event only after it has been completely written
+            __sync_synchronize();
+            _count = _count + 1;
+        }
+
+        void snapshot(std::vector<Event>& events) const
+        {
+            const unsigned long long capacity = _events.size();
+            unsigned long long last = _count;
+            __sync_synchronize();
+            unsigned long long first = (last > capacity) ? (last - capacity) : 0;
+            std::vector<Event> copied;
+            copied.reserve(last - first);
+            for (unsigned long long index = first; index < last; ++index) {
+                copied.push_back(_events[index % capacity]);
+            }
+            __sync_synchronize();
+
+            // Any event the writer reached during the copy may have replaced
+            // an older one, including the slot it is writing now (unless the
+            // thread has exited)
+            unsigned long long current = _count;
+            if (!_exited) {
+                ++current;
+            }
+            unsigned long long valid = (current > capacity) ? (current - capacity) : 0;
+            for (unsigned long long index = first; index < last; ++index) {
+                if (index >= valid) {
+                    events.push_back(copied[index - first]);
+                }
+            }
+        }
+
+        void reset()
+        {
+            // Only safe with respect to the owner if it is not recording; a
+            // racing span is at worst dropped or kept
+            _count = 0;
+        }
+
+        pid_t tid() const
+        {
+            return _tid;
+        }
+
+        const std::string& name() const
+        {
+            return _name;
+        }
+
+        void setExited()
+        {
+            _exited = true;
+        }
+
+    private:
+        std::vector<Event> _events;
+        volatile unsigned long long _count;
+        pid_t _tid;
+        std::string _name;
+        volatile bool _exited;
+    };
+
+    typedef boost::shared_ptr<ThreadBuffer> BufferPtr;
+
+    // Buffers of threads that have exited are kept so their spans can still
+    // be dumped, up to a limit, since ORB threads come and go
+    const size_t MAX_EXITED_BUFFERS = 64;
+
+    boost::mutex registryMutex;
+    std::list<BufferPtr> buffers;
+    std::deque<BufferPtr> exitedBuffers;
+    size_t bufferSize = 16384;
+    std::string lastPath;
+    std::string dumpDir;
+    unsigned int dumpCount = 0;
+
+    void retireBuffer(BufferPtr buffer)
+    {
+        boost::mutex::scoped_lock lock(registryMutex);
+        buffer->setExited();
+        buffers.remove(buffer);
+        exitedBuffers.push_back(buffer);
+        if (exitedBuffers.size() > MAX_EXITED_BUFFERS) {
+            exitedBuffers.pop_front();
+        }
+    }
+
+    // Owned by the thread-local pointer; unregisters the buffer when the
+    // thread exits
+    struct ThreadHandle {
+        ThreadHandle(const BufferPtr& buffer) :
+            buffer(buffer)
+        {
+        }
+
+        ~ThreadHandle()
+        {
+            retireBuffer(buffer);
+        }
+
+        BufferPtr buffer;
+    };
+
+    boost::thread_specific_ptr<ThreadHandle> threadHandle;
+
+    ThreadBuffer* getThreadBuffer()
+    {
+        ThreadHandle* handle = threadHandle.get();
+        if (!handle) {
+            boost::mutex::scoped_lock lock(registryMutex);
+            BufferPtr buffer(new ThreadBuffer(bufferSize));
+            buffers.push_back(buffer);
+            handle = new ThreadHandle(buffer);
+            threadHandle.reset(handle);
+        }
+        return handle->buffer.get();
+    }
+
+    void writeString(std::ostream& out, const char* str)
+    {
+        out << '"';
+        for (; *str; ++str) {
+            switch (*str) {
+            case '"':
+                out << "\\\"";
+                break;
+            case '\\':
+                out << "\\\\";
+                break;
+            default:
+                if (static_cast<unsigned char>(*str) < 0x20) {
+                    out << ' ';
+                } else {
+                    out << *str;
+                }
+            }
+        }
+        out << '"';
+    }
+
+    void writeTimestamp(std::ostream& out, unsigned long long nsec)
+    {
+        // Chrome trace timestamps are in microseconds
+        out << (nsec / 1000) << '.' << std::setw(3) << std::setfill('0') << (nsec % 1000);
+    }
+
+    // Signal-driven dumps: the handler only posts the semaphore, and a
+    // dedicated thread writes the file
+    sem_t dumpSemaphore;
+    std::string dumpPath;
+    boost::thread* dumpThread = 0;
+
+    void dumpOnSignalHandler(int)
+    {
+        sem_post(&dumpSemaphore);
+    }
+
+    void dumpThreadFunc()
+    {
+        while (true) {
+            if (sem_wait(&dumpSemaphore) != 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return;
+            }
+            if (!dump(dumpPath)) {
+                LOG_WARN(Tracing, "Unable to write trace to " << dumpPath);
+            }
+        }
+    }
+}
+
+void enable()
+{
+    detail::enabled = true;
+}
+
+void disable()
+{
+    detail::enabled = false;
+}
+
+void setBufferSize(size_t spans)
+{
+    boost::mutex::scoped_lock lock(registryMutex);
+    if (spans > 0) {
+        bufferSize = spans;
+    }
+}
+
+void clear()
+{
+    boost::mutex::scoped_lock lock(registryMutex);
+    for (std::list<BufferPtr>::iterator buffer = buffers.begin(); buffer != buffers.end(); ++buffer) {
+        (*buffer)->reset();
+    }
+    exitedBuffers.clear();
+}
+
+unsigned long long now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec * 1000000000ULL) + ts.tv_nsec;
+}
+
+void record(const char* category, const char* name, unsigned long long begin, unsigned long long end)
+{
+    getThreadBuffer()->push(category, name, begin, end);
+}
+
+void dump(std::ostream& out)
+{
+    std::vector<BufferPtr> snapshot;
+    {
+        boost::mutex::scoped_lock lock(registryMutex);
+        snapshot.assign(buffers.begin(), buffers.end());
+        snapshot.insert(snapshot.end(), exitedBuffers.begin(), exitedBuffers.end());
+    }
+
+    const pid_t pid = getpid();
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    std::vector<Event> events;
+    for (std::vector<BufferPtr>::iterator buffer = snapshot.begin(); buffer != snapshot.end(); ++buffer) {
+        const pid_t tid = (*buffer)->tid();
+        if (!first) {
+            out << ',';
+        }
+        first = false;
+        out << "\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":" << pid << ",\"tid\":" << tid << ",\"args\":{\"name\":";
+        writeString(out, (*buffer)->name().c_str());
+        out << "}}";
+
+        events.clear();
+        (*buffer)->snapshot(events);
+        for (std::vector<Event>::iterator event = events.begin(); event != events.end(); ++event) {
+            out << ",\n{\"ph\":\"X\",\"cat\":";
+            writeString(out, event->category);
+            out << ",\"name\":";
+            writeString(out, event->name);
+            out << ",\"pid\":" << pid << ",\"tid\":" << tid << ",\"ts\":";
+            writeTimestamp(out, event->begin);
+            out << ",\"dur\":";
+            writeTimestamp(out, event->end - event->begin);
+            out << '}';
+        }
+    }
+    out << "\n]}\n";
+}
+
+bool dump(const std::string& path)
+{
+    // Write to a temporary file and rename, so that readers never see a
+    // partial trace
+    const std::string temp = path + ".tmp";
+    {
+        std::ofstream out(temp.c_str());
+        if (!out) {
+            return false;
+        }
+        dump(out);
+        out.close();
+        if (!out) {
+            unlink(temp.c_str());
+            return false;
+        }
+    }
+    if (rename(temp.c_str(), path.c_str()) != 0) {
+        unlink(temp.c_str());
+        return false;
+    }
+    boost::mutex::scoped_lock lock(registryMutex);
+    lastPath = path;
+    return true;
+}
+
+std::string lastDumpPath()
+{
+    boost::mutex::scoped_lock lock(registryMutex);
+    return lastPath;
+}
+
+void setDumpDirectory(const std::string& directory)
+{
+    boost::mutex::scoped_lock lock(registryMutex);
+    dumpDir = directory;
+}
+
+std::string dumpDirectory()
+{
+    {
+        boost::mutex::scoped_lock lock(registryMutex);
+        if (!dumpDir.empty()) {
+            return dumpDir;
+        }
+    }
+    char cwd[PATH_MAX];
+    if (!getcwd(cwd, sizeof(cwd))) {
+        return ".";
+    }
+    return cwd;
+}
+
+std::string dumpToDirectory()
+{
+    unsigned int sequence;
+    {
+        boost::mutex::scoped_lock lock(registryMutex);
+        sequence = ++dumpCount;
+    }
+    std::ostringstream path;
+    path << dumpDirectory() << "/trace-" << getpid() << "-" << sequence << ".json";
+    if (!dump(path.str())) {
+        return std::string();
+    }
+    return path.str();
+}
+
+void dumpOnSignal(const std::string& path)
+{
+    enable();
+    if (dumpThread) {
+        return;
+    }
+    const std::string::size_type slash = path.rfind('/');
+    if (slash != std::string::npos) {
+        setDumpDirectory(path.substr(0, slash ? slash : 1));
+    }
+    dumpPath = path;
+    sem_init(&dumpSemaphore, 0, 0);
+    dumpThread = new boost::thread(&dumpThreadFunc);
+
+    struct sigaction sa;
+    sa.sa_handler = &dumpOnSignalHandler;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = SA_RESTART;
+    sigaction(SIGUSR2, &sa, NULL);
+}
+
+}
+}
@@ -23,6 +23,8 @@
 
 #include <ossie/CF/cf.h>
 
+#include <boost/unordered_map.hpp>
+
 #include "Value.h"
 #include "PropertyType.h"
 
@@ -76,6 +78,73 @@ namespace redhawk {
         void erase(iterator first, iterator last);
     };
 
+    /*
+     * Hashed index of property ids for a properties sequence that it does not
+     * own, so that it can be used with sequences reinterpreted as PropertyMaps
+     * (e.g., SRI keywords). The index is built on the first lookup once the
+     * sequence reaches the size threshold, and is extended as properties are
+     * appended. Lookups trust the index, including misses, so owners must call
+     * invalidate() whenever properties are erased, reordered or renamed in
+     * place.
+     */
+    class PropertyIndex {
+    public:
+        // Below this many properties, a linear search is cheaper than hashing
+        static const size_t DEFAULT_THRESHOLD = 16;
+
+        explicit PropertyIndex(size_t threshold=DEFAULT_THRESHOLD);
+
+        // Returns the offset of the first property with the given id, or the
+        // length of the sequence if there is none
+        size_t find(const CF::Properties& properties, const std::string& id) const;
+
+        void invalidate();
+
+    private:
+        void update(const CF::Properties& properties) const;
+        void rebuild(const CF::Properties& properties) const;
+
+        typedef boost::unordered_map<std::string,size_t> OffsetMap;
+        mutable OffsetMap _offsets;
+        mutable size_t _indexed;
+        mutable bool _valid;
+        size_t _threshold;
+    };
+
+    /*
+     * PropertyMap with a PropertyIndex for id lookups, for maps that hold many
+     * properties and are searched repeatedly. Changes must be made through this
+     * class (not a PropertyMap reference) to keep the index current, or be
+     * followed by a call to reindex().
+     */
+    class IndexedPropertyMap : public PropertyMap {
+    public:
+        IndexedPropertyMap();
+        explicit IndexedPropertyMap(const CF::Properties& properties);
+        IndexedPropertyMap(const IndexedPropertyMap& other);
+
+        IndexedPropertyMap& operator=(const CF::Properties& properties);
+        IndexedPropertyMap& operator=(const IndexedPropertyMap& other);
+
+        bool contains (const std::string& id) const;
+
+        using PropertyMap::operator[];
+        Value& operator[] (const std::string& id);
+        const Value& operator[] (const std::string& id) const;
+
+        iterator find(const std::string& id);
+        const_iterator find(const std::string& id) const;
+
+        void erase(const std::string& id);
+        void erase(iterator pos);
+        void erase(iterator first, iterator last);
+
+        void reindex();
+
+    private:
+        PropertyIndex _index;
+    };
+
 }
 
 #endif // REDHAWK_PROPERTYMAP_H
@@ -89,6 +89,27 @@ public:
    void   startPropertyChangeMonitor( const std::string &rsc_id);
    void   stopPropertyChangeMonitor();
 
+   //
+   // Change detection used for registered property change listeners
+   //
+   //   POLLED_CHANGES - each service cycle compares registered properties against a
+   //                    snapshot of their last value (default)
+   //   SETTER_CHANGES - no per-cycle snapshot; once per report interval each registered
+   //                    property is compared with the value last reported to the listener
+   //                    (or its value at registration), which also catches members the
+   //                    component assigned directly. Each listener receives a single batch
+   //                    per interval holding only the values that differ from its last report
+   //
+   // Remote clients select the mode by configuring the framework property
+   // PROPERTY_CHANGE_MONITOR_MODE to "POLLED" or "SETTER".
+   //
+   enum PropertyMonitorMode {
+       POLLED_CHANGES,
+       SETTER_CHANGES
+   };
+   void   setPropertyMonitorMode( PropertyMonitorMode mode );
+   PropertyMonitorMode getPropertyMonitorMode() const;
+
 protected:
 
     /*CF::Properties
@@ -116,6 +137,7 @@ protected:
         wrapper->isNil(true);
         ownedWrappers.push_back(wrapper);
         propTable[wrapper->id] = wrapper;
+        indexProperty(wrapper, &value);
         _propMonitors[wrapper->id] = PropertyChange::MonitorFactory::Create(value);
         return wrapper;
     }
@@ -308,6 +330,15 @@ protected:
      * Call the property change callback for the given identifier.
      */
     void executePropertyCallback (const std::string& id);
+
+    /*
+     * Record a change to a property whose member value was assigned directly
+     * (i.e., not through configure). SETTER_CHANGES monitoring finds such
+     * changes by comparison at the next report in any case; marking only
+     * flags the property for every registration at once. Must not be called
+     * while holding propertySetAccess.
+     */
+    void markPropertyChanged (const std::string& id);
     
     // This mutex is used to deal with configure/query concurrency
     boost::mutex propertySetAccess;
@@ -321,6 +352,16 @@ protected:
     PropertyMap propTable;
 
 private:
+    // Reverse indices for getPropertyFromName and getPropertyFromAddress;
+    // entries are checked against propTable, which remains authoritative
+    void indexProperty(PropertyInterface* property, const void* address);
+    bool isIndexed(PropertyInterface* property) const;
+
+    typedef std::map<std::string, PropertyInterface*> PropertyNameMap;
+    PropertyNameMap propNames;
+    typedef std::map<const void*, PropertyInterface*> PropertyAddressMap;
+    PropertyAddressMap propAddresses;
+
     template <typename T>
     PropertyWrapper<T>* castProperty(PropertyInterface* property)
     {
@@ -346,8 +387,10 @@ private:
     struct PCL_Callback {
       bool    isChanged_;
       bool    isRecorded_;
+      bool    isReported_;      // lastReported_ holds the value of the previous notification
+      CORBA::Any lastReported_;
 
-    PCL_Callback() : isChanged_(false), isRecorded_(false) {};
+    PCL_Callback() : isChanged_(false), isRecorded_(false), isReported_(false) {};
       void     recordChanged(void) { 
 	if ( !isRecorded_ )  {
 	  isChanged_ = true;
@@ -410,6 +453,17 @@ private:
 
     // service function that reports on change events
     int    _propertyChangeServiceFunction();
+
+    // configure/query of framework properties that are not in the PRF
+    // (PROPERTY_CHANGE_MONITOR_MODE, TRACE_ENABLED and, for query, TRACE_DUMP,
+    // which configure handles itself so that the trace is written without
+    // holding propertySetAccess); return false if the id is not one of them
+    // (or, for configure, the value is invalid)
+    bool   configureFrameworkProperty( const CF::DataType& prop );
+    bool   queryFrameworkProperty( CF::DataType& prop );
+
+    // change detection used by the service function
+    PropertyMonitorMode         _propMonitorMode;
     
     bool _propertiesInitialized;
 };
@@ -192,6 +192,97 @@ namespace redhawk
       int set_affinity( const AffinityDirectives &spec, const pid_t pid, const CpuList &blacklist = CpuList(0))
         throw (AffinityFailed);
 
+
+      /*
+         Thread level affinity
+
+         Framework created threads inside a resource can be assigned their own affinity directive
+         by role.  The directives are provided in the same <affinity> section as the process
+         directives, the value for each role is a "class:value" pair using the socket, cpu or
+         nic classes defined above.
+
+             <simpleref refid="affinity::service_thread" value="cpu:5"/>
+             <simpleref refid="affinity::orb_worker" value="socket:0"/>
+             <simpleref refid="affinity::port_monitor" value="cpu:6"/>
+             <simpleref refid="affinity::buffer_alloc" value="local"/>
+
+          affinity::service_thread   ProcessThread executing the resource's serviceFunction
+          affinity::orb_worker       ORB threads that dispatch incoming calls (i.e. pushPacket)
+          affinity::port_monitor     port support threads (i.e. burstio output monitor)
+          affinity::buffer_alloc     memory policy for ORB workers that unmarshal port sample buffers,
+                                     "local" allocates on the node of the executing cpu, otherwise a
+                                     numa node string for a preferred node
+
+         The deploying device exports the directives to the resource's environment (REDHAWK_THREAD_AFFINITY)
+         and each framework thread applies its directive to itself when it starts.
+      */
+      enum ThreadRole {
+        SERVICE_THREAD = 0,
+        ORB_WORKER,
+        PORT_MONITOR,
+        BUFFER_ALLOC,
+        THREAD_ROLE_COUNT
+      };
+
+      /*
+         Environment variable used to pass thread directives from the deploying device to the resource
+       */
+      const std::string THREAD_AFFINITY_ENV("REDHAWK_THREAD_AFFINITY");
+
+      /*
+         Return the property id (affinity::<role>) for a thread role
+       */
+      std::string get_thread_role_id( const ThreadRole role );
+
+      /*
+         Check if a properties set contains any thread role directives.
+      */
+      bool has_thread_affinity( const CF::Properties &options );
+
+      /*
+         convert a properties set that contains affinity namespaced thread role properties to a list
+         of (role property id, "class:value") records.
+       */
+      AffinityDirectives convert_thread_properties( const CF::Properties& options );
+
+      /*
+         Returns the calling process' environment with the thread role directives from a properties set
+         added, as "name=value" strings.  Devices build this before fork and pass it to execve, since the
+         child of a multithreaded process may not safely modify its environment.
+       */
+      std::vector<std::string> thread_environment( const CF::Properties& options );
+
+      /*
+         Returns the environment value export_thread_directives would set for a properties set, empty if there
+         are no thread role directives or processing is disabled.  Used when the resource's environment is
+         assembled outside the deploying process.
+       */
+      std::string format_thread_directives( const CF::Properties& options );
+
+      /*
+         Returns the directive for a thread role as a (class, value) record, the first member is empty if
+         the role has no directive.  Directives are loaded once from the process environment.
+       */
+      AffinityDirective get_thread_directive( const ThreadRole role );
+
+      /*
+         Override the directive for a thread role in this process
+       */
+      void set_thread_directive( const ThreadRole role, const AffinityDirective &directive );
+
+      /*
+         Apply the directive assigned to a thread role to the calling thread.   Returns 0 if no directive
+         is assigned or processing is disabled.   Failures are logged and do not throw so thread entry points
+         can call this unconditionally.
+       */
+      int set_thread_affinity( const ThreadRole role );
+
+      /*
+         Apply a (class, value) directive to a thread id (see gettid), 0 for the calling thread
+       */
+      int set_thread_affinity( const AffinityDirective &directive, const pid_t tid=0, const CpuList &blacklist = CpuList(0) )
+        throw (AffinityFailed);
+
     };  // affinity namespace
     
 }  // redhawk  Namespace
@@ -26,6 +26,8 @@
 #include <vector>
 
 #include <sched.h>
+#include <poll.h>
+#include <sys/types.h>
 
 #ifdef HAVE_OMNIORB4_CORBA_H
 #include "omniORB4/CORBA.h"
@@ -57,6 +59,55 @@ namespace ossie
 
       int is_jarfile( const std::string &jarPath );
 
+      /*
+         open_process_fd
+         Open a file descriptor that becomes readable when a process exits (see pidfd_open)
+         @return descriptor for the process, caller must close it
+         @return -1  process does not exist or kernel does not support process descriptors
+      */
+      int open_process_fd( const pid_t pid );
+
+      /*
+         is_process_running
+         Check whether a process exists and has not exited; a zombie (exited, but not yet
+         reaped by its parent) is not running
+      */
+      bool is_process_running( const pid_t pid );
+
+      /*
+         process_watch
+         A set of processes whose exits can be waited on repeatedly. Process descriptors are
+         opened once, when the watch is created; processes that do not have a descriptor are
+         checked at a short interval.
+      */
+      class process_watch {
+      public:
+        process_watch( const std::vector<pid_t> &pids );
+        ~process_watch();
+
+        /*
+           Wait up to timeout seconds for the watched processes to exit
+           @return number of processes that are still running
+        */
+        size_t wait( const double timeout );
+
+      private:
+        // not copyable, the watch owns its descriptors
+        process_watch( const process_watch& );
+        process_watch& operator=( const process_watch& );
+
+        std::vector<struct pollfd> _fds;
+        std::vector<pid_t> _checked;
+      };
+
+      /*
+         wait_for_exit
+         Wait for a list of processes to exit, up to timeout seconds. Waits on process
+         descriptors when supported, otherwise the processes are checked at a short interval.
+         @return number of processes that are still running
+      */
+      size_t wait_for_exit( const std::vector<pid_t> &pids, const double timeout );
+
     };
 }  // Close ossieSupport Namespace
 #endif
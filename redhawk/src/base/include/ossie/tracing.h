@@ -0,0 +1,197 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK core.
+ *
+ * REDHAWK core is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * REDHAWK core is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#ifndef REDHAWK_TRACING_H
+#define REDHAWK_TRACING_H
+
+#include <iosfwd>
+#include <string>
+
+/*
+ * Marks the enclosing scope as a span in the trace. The category and name
+ * must be string literals (or otherwise outlive the process), because only
+ * the pointers are recorded.
+ *
+ * Defining RH_DISABLE_TRACING before including this header compiles the
+ * spans out entirely.
+ */
+#ifdef RH_DISABLE_TRACING
+#define RH_TRACE_SPAN(category, name)
+#else
+#define RH_TRACE_SPAN(category, name) \
+    redhawk::tracing::Span RH_TRACE_SPAN_VAR(__LINE__)(category, name)
+#define RH_TRACE_SPAN_VAR(line) RH_TRACE_SPAN_CAT(_rh_trace_span_, line)
+#define RH_TRACE_SPAN_CAT(prefix, line) prefix##line
+#endif
+
+namespace redhawk {
+
+    /*
+     * Lightweight tracing of time spent in framework and component hot paths.
+     *
+     * Each thread records completed spans into its own fixed-size ring
+     * buffer, so recording never takes a lock; when the buffer is full the
+     * oldest spans are overwritten. Tracing is off by default, in which case
+     * a span costs a single flag check. The collected spans can be written
+     * at any time as Chrome trace JSON, which can be loaded in
+     * chrome://tracing or Perfetto.
+     *
+     * Components and devices enable tracing at startup with the TRACE
+     * command line argument, whose value is the path of the output file. The
+     * trace is written when the process exits, and whenever it receives
+     * SIGUSR2.
+     *
+     * At runtime, every resource also accepts two framework properties that
+     * are not part of its PRF: TRACE_ENABLED (boolean) starts or stops
+     * recording, and configuring TRACE_DUMP to true writes the trace to a new
+     * file in the trace directory. Querying TRACE_DUMP returns the last path
+     * written. Remote callers cannot choose the path; the trace directory is
+     * the directory of the TRACE file if one was given, or otherwise the
+     * process's working directory.
+     */
+    namespace tracing {
+
+        namespace detail {
+            extern volatile bool enabled;
+        }
+
+        /*
+         * Returns true if spans are being recorded.
+         */
+        inline bool isEnabled()
+        {
+            return detail::enabled;
+        }
+
+        /*
+         * Starts recording spans.
+         */
+        void enable();
+
+        /*
+         * Stops recording spans; spans that have already been recorded are
+         * kept until clear() is called.
+         */
+        void disable();
+
+        /*
+         * Sets the number of spans each thread's ring buffer holds. Only
+         * buffers created afterwards (i.e., for threads that have not yet
+         * recorded a span) are affected.
+         */
+        void setBufferSize(size_t spans);
+
+        /*
+         * Discards all recorded spans.
+         */
+        void clear();
+
+        /*
+         * Returns the current value of the monotonic clock used for spans, in
+         * nanoseconds.
+         */
+        unsigned long long now();
+
+        /*
+         * Records a completed span for the calling thread. The category and
+         * name must outlive the process.
+         */
+        void record(const char* category, const char* name, unsigned long long begin, unsigned long long end);
+
+        /*
+         * Writes all recorded spans as Chrome trace JSON.
+         */
+        void dump(std::ostream& out);
+
+        /*
+         * Writes all recorded spans as Chrome trace JSON to the file at path,
+         * replacing it if it exists. Returns false if the file could not be
+         * written.
+         */
+        bool dump(const std::string& path);
+
+        /*
+         * Returns the path of the file the trace was last written to, or an
+         * empty string if it has not been written.
+         */
+        std::string lastDumpPath();
+
+        /*
+         * Sets the directory that dumpToDirectory() writes to.
+         */
+        void setDumpDirectory(const std::string& directory);
+
+        /*
+         * Returns the directory that dumpToDirectory() writes to.
+         */
+        std::string dumpDirectory();
+
+        /*
+         * Writes all recorded spans as Chrome trace JSON to a new file in the
+         * dump directory, named for the process ID and a sequence number.
+         * Returns the path of the file, or an empty string if it could not be
+         * written.
+         */
+        std::string dumpToDirectory();
+
+        /*
+         * Enables tracing and arranges for the trace to be written to path
+         * whenever the process receives SIGUSR2; the directory of path also
+         * becomes the dump directory. Used by the component and device
+         * startup code.
+         */
+        void dumpOnSignal(const std::string& path);
+
+        /*
+         * Scope-based span; prefer the RH_TRACE_SPAN macro, which can be
+         * compiled out.
+         *
+         * The start time is only taken when tracing is enabled, so a span
+         * that begins while tracing is disabled is never recorded.
+         */
+        class Span {
+        public:
+            Span(const char* category, const char* name) :
+                _category(category),
+                _name(name),
+                _begin(isEnabled() ? now() : 0)
+            {
+            }
+
+            ~Span()
+            {
+                if (_begin) {
+                    record(_category, _name, _begin, now());
+                }
+            }
+
+        private:
+            // Non-copyable
+            Span(const Span&);
+            Span& operator=(const Span&);
+
+            const char* _category;
+            const char* _name;
+            const unsigned long long _begin;
+        };
+    }
+}
+
+#endif // REDHAWK_TRACING_H
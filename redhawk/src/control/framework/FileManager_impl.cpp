@@ -21,8 +21,21 @@
 
 #include <string>
 #include <list>
+#include <map>
+#include <cerrno>
+#include <cstring>
 
 #include <fnmatch.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/sendfile.h>
+#include <sys/syscall.h>
+
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/condition_variable.hpp>
 
 #include "ossie/FileManager_impl.h"
 #include "ossie/debug.h"
@@ -41,6 +54,343 @@ namespace {
         return path;
     }
 
+    // Maximum number of chunk reads that may be outstanding ahead of the
+    // write position when copying between file systems.
+    static const size_t COPY_CHUNKS_IN_FLIGHT = 4;
+
+    // Maximum number of files copied at the same time by copyTree.
+    static const size_t COPY_TREE_FILES_IN_FLIGHT = 4;
+
+    // Number of bytes at the end of a partial destination file that must
+    // match the source for a copy to be resumed.
+    static const CORBA::ULong RESUME_VERIFY_SIZE = 64 * 1024;
+
+    // Builds an error message for the exception currently being handled;
+    // must only be called from inside a catch block.
+    static std::string describeException (const std::string& operation)
+    {
+        std::ostringstream eout;
+        try {
+            throw;
+        } catch (const CF::File::IOException& ex) {
+            eout << "File IOException occurred during \"" << operation << "\": " << ex.msg.in();
+        } catch (const CF::FileException& ex) {
+            eout << "File Exception occurred during \"" << operation << "\": " << ex.msg.in();
+        } catch (const CORBA::Exception& ex) {
+            eout << "The following CORBA exception occurred: " << ex._name() << " while \"" << operation << "\"";
+        } catch (const std::exception& ex) {
+            eout << "The following standard exception occurred: " << ex.what() << " while \"" << operation << "\"";
+        } catch (...) {
+            eout << "\"" << operation << "\" failed with Unknown Exception";
+        }
+        return eout.str();
+    }
+
+    // Searches poa and its descendants for the servant of obj. File systems
+    // are usually activated in a child POA (e.g. the DeviceManager's), and a
+    // POA only resolves references to objects that it activated itself.
+    static PortableServer::Servant findServant (PortableServer::POA_ptr poa, CORBA::Object_ptr obj)
+    {
+        try {
+            return poa->reference_to_servant(obj);
+        } catch (const PortableServer::POA::WrongAdapter&) {
+            // Not activated in this POA
+        } catch (const PortableServer::POA::WrongPolicy&) {
+            // POA does not retain servants
+        } catch (const PortableServer::POA::ObjectNotActive&) {
+            return 0;
+        }
+
+        PortableServer::POAList_var children = poa->the_children();
+        for (CORBA::ULong index = 0; index < children->length(); ++index) {
+            PortableServer::Servant servant = findServant(children[index], obj);
+            if (servant) {
+                return servant;
+            }
+        }
+        return 0;
+    }
+
+    struct ScopedFd {
+        ScopedFd (int fd) : fd(fd) { }
+        ~ScopedFd () { if (fd >= 0) ::close(fd); }
+        int fd;
+    };
+
+    static ssize_t copyFileRange (int fdIn, off_t* offIn, int fdOut, off_t* offOut, size_t length)
+    {
+#ifdef SYS_copy_file_range
+        return syscall(SYS_copy_file_range, fdIn, offIn, fdOut, offOut, length, 0);
+#else
+        errno = ENOSYS;
+        return -1;
+#endif
+    }
+
+    static bool tailMatches (const char* source, const char* destination, size_t length)
+    {
+        return (memcmp(source, destination, length) == 0);
+    }
+
+    static off_t getLocalResumeOffset (int sourceFd, off_t sourceSize, const std::string& destPath)
+    {
+        struct stat status;
+        if ((stat(destPath.c_str(), &status) != 0) || !S_ISREG(status.st_mode)) {
+            return 0;
+        }
+        const off_t size = status.st_size;
+        if ((size == 0) || (size > sourceSize)) {
+            return 0;
+        }
+
+        ScopedFd dest(::open(destPath.c_str(), O_RDONLY));
+        if (dest.fd < 0) {
+            return 0;
+        }
+        const size_t length = std::min(size, static_cast<off_t>(RESUME_VERIFY_SIZE));
+        std::vector<char> sourceTail(length);
+        std::vector<char> destTail(length);
+        if ((pread(sourceFd, &sourceTail[0], length, size - length) != static_cast<ssize_t>(length)) ||
+            (pread(dest.fd, &destTail[0], length, size - length) != static_cast<ssize_t>(length))) {
+            return 0;
+        }
+        if (!tailMatches(&sourceTail[0], &destTail[0], length)) {
+            return 0;
+        }
+        return size;
+    }
+
+    // Copies a file between two local paths inside the kernel, using
+    // copy_file_range where supported and falling back to sendfile.
+    static void copyLocalFile (const std::string& sourcePath, const std::string& destPath, bool resume)
+    {
+        ScopedFd source(::open(sourcePath.c_str(), O_RDONLY));
+        if (source.fd < 0) {
+            std::string errmsg = "Could not open file: " + sourcePath;
+            throw CF::FileException(CF::CF_ENOENT, errmsg.c_str());
+        }
+        struct stat status;
+        if (fstat(source.fd, &status) != 0) {
+            std::string errmsg = "Could not stat file: " + sourcePath;
+            throw CF::FileException(CF::CF_EIO, errmsg.c_str());
+        } else if (S_ISDIR(status.st_mode)) {
+            std::string errmsg = sourcePath + " is a directory";
+            throw CF::FileException(CF::CF_EISDIR, errmsg.c_str());
+        }
+
+        off_t offset = 0;
+        if (resume) {
+            offset = getLocalResumeOffset(source.fd, status.st_size, destPath);
+        }
+        int flags = O_WRONLY|O_CREAT;
+        if (offset == 0) {
+            flags |= O_TRUNC;
+        }
+        // Create the destination with the source's permissions, as the
+        // file system copy does
+        ScopedFd dest(::open(destPath.c_str(), flags, status.st_mode & 07777));
+        if (dest.fd < 0) {
+            std::string errmsg = "Could not open file: " + destPath;
+            throw CF::FileException(CF::CF_EIO, errmsg.c_str());
+        }
+
+        off_t sourceOffset = offset;
+        off_t destOffset = offset;
+        bool useCopyRange = true;
+        while (sourceOffset < status.st_size) {
+            const size_t todo = status.st_size - sourceOffset;
+            ssize_t count;
+            if (useCopyRange) {
+                count = copyFileRange(source.fd, &sourceOffset, dest.fd, &destOffset, todo);
+                if ((count < 0) && (errno != EINTR)) {
+                    // Not supported for this kernel or pair of file systems
+                    useCopyRange = false;
+                    continue;
+                }
+            } else {
+                if (lseek(dest.fd, destOffset, SEEK_SET) < 0) {
+                    throw CF::FileException(CF::CF_EIO, "Error setting file pointer for file");
+                }
+                count = sendfile(dest.fd, source.fd, &sourceOffset, todo);
+                if (count > 0) {
+                    destOffset += count;
+                }
+            }
+            if (count < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                std::string errmsg = "Error copying " + sourcePath + " to " + destPath + ": " + strerror(errno);
+                throw CF::FileException(CF::CF_EIO, errmsg.c_str());
+            } else if (count == 0) {
+                // Source was truncated during the copy
+                break;
+            }
+        }
+    }
+
+    static CORBA::ULong getResumeOffset (CF::File_ptr srcFile, CF::File_ptr dstFile, CORBA::ULong sourceSize)
+    {
+        const CORBA::ULong size = dstFile->sizeOf();
+        if ((size == 0) || (size > sourceSize)) {
+            return 0;
+        }
+
+        const CORBA::ULong length = std::min(size, RESUME_VERIFY_SIZE);
+        CF::OctetSequence_var sourceTail;
+        srcFile->setFilePointer(size - length);
+        srcFile->read(sourceTail, length);
+        CF::OctetSequence_var destTail;
+        dstFile->setFilePointer(size - length);
+        dstFile->read(destTail, length);
+        if ((sourceTail->length() != length) || (destTail->length() != length)) {
+            return 0;
+        }
+        if (!tailMatches(reinterpret_cast<const char*>(sourceTail->get_buffer()),
+                         reinterpret_cast<const char*>(destTail->get_buffer()), length)) {
+            return 0;
+        }
+        return size;
+    }
+
+    // Streams a byte range from a set of source file handles to a single
+    // destination. Each reader handle fetches every Nth chunk, and reads are
+    // allowed to run ahead of the write position by a bounded number of
+    // chunks, so that several reads are outstanding while the ordered writes
+    // proceed.
+    class ChunkPipeline {
+    public:
+        typedef std::vector<CF::File_var> FileList;
+
+        ChunkPipeline (const FileList& readers, CF::File_ptr writer, CORBA::ULong offset,
+                       CORBA::ULong size, CORBA::ULong chunkSize) :
+            _readers(readers),
+            _writer(writer),
+            _offset(offset),
+            _size(size),
+            _chunkSize(chunkSize),
+            _chunkCount((size - offset + chunkSize - 1) / chunkSize),
+            _nextWrite(0),
+            _failed(false)
+        {
+        }
+
+        void run ()
+        {
+            boost::thread_group threads;
+            for (size_t reader = 0; reader < _readers.size(); ++reader) {
+                threads.create_thread(boost::bind(&ChunkPipeline::readChunks, this, reader));
+            }
+
+            try {
+                writeChunks();
+            } catch (...) {
+                setError(describeException("dstFile->write"));
+            }
+            threads.join_all();
+
+            if (_failed) {
+                throw CF::FileException(CF::CF_EIO, _error.c_str());
+            }
+        }
+
+    private:
+        typedef boost::shared_ptr<CF::OctetSequence> ChunkPtr;
+
+        void setError (const std::string& message)
+        {
+            boost::mutex::scoped_lock lock(_lock);
+            if (!_failed) {
+                _failed = true;
+                _error = message;
+            }
+            _cond.notify_all();
+        }
+
+        void readChunks (size_t reader)
+        {
+            CF::File_ptr file = _readers[reader].in();
+            try {
+                for (size_t index = reader; index < _chunkCount; index += _readers.size()) {
+                    {
+                        boost::mutex::scoped_lock lock(_lock);
+                        while (!_failed && (index >= (_nextWrite + COPY_CHUNKS_IN_FLIGHT))) {
+                            _cond.wait(lock);
+                        }
+                        if (_failed) {
+                            return;
+                        }
+                    }
+
+                    const CORBA::ULong position = _offset + index * _chunkSize;
+                    const CORBA::ULong length = std::min(_chunkSize, _size - position);
+                    CF::OctetSequence_var data;
+                    file->setFilePointer(position);
+                    file->read(data, length);
+                    if (data->length() != length) {
+                        setError("Short read from source file");
+                        return;
+                    }
+
+                    boost::mutex::scoped_lock lock(_lock);
+                    _chunks[index] = ChunkPtr(data._retn());
+                    _cond.notify_all();
+                }
+            } catch (...) {
+                setError(describeException("srcFile->read"));
+            }
+        }
+
+        void writeChunks ()
+        {
+            for (size_t index = 0; index < _chunkCount; ++index) {
+                ChunkPtr chunk;
+                {
+                    boost::mutex::scoped_lock lock(_lock);
+                    while (!_failed && (_chunks.find(index) == _chunks.end())) {
+                        _cond.wait(lock);
+                    }
+                    if (_failed) {
+                        return;
+                    }
+                    chunk = _chunks[index];
+                    _chunks.erase(index);
+                }
+
+                _writer->write(*chunk);
+
+                boost::mutex::scoped_lock lock(_lock);
+                ++_nextWrite;
+                _cond.notify_all();
+            }
+        }
+
+        const FileList& _readers;
+        CF::File_ptr _writer;
+        const CORBA::ULong _offset;
+        const CORBA::ULong _size;
+        const CORBA::ULong _chunkSize;
+        const size_t _chunkCount;
+
+        boost::mutex _lock;
+        boost::condition_variable _cond;
+        std::map<size_t,ChunkPtr> _chunks;
+        size_t _nextWrite;
+        bool _failed;
+        std::string _error;
+    };
+
+    static bool closeFile (CF::File_ptr file, const std::string& operation, std::string& error)
+    {
+        try {
+            file->close();
+            return true;
+        } catch (...) {
+            error = describeException(operation);
+            return false;
+        }
+    }
+
 }
 
 
@@ -114,8 +464,22 @@ void FileManager_impl::mount (const char* mountPoint, CF::FileSystem_ptr fileSys
         }
     }
 
-    LOG_TRACE(FileManager_impl, "Mounting remote file system on " << mountPath);
-    mountedFileSystems.push_back(MountPoint(mountPath, fileSystem));
+    // If the file system is served from this process, keep its servant so
+    // that copies can access its files directly instead of through CORBA
+    // calls.
+    MountPoint mount(mountPath, fileSystem);
+    try {
+        mount.servant = findServant(ossie::corba::RootPOA(), fileSystem);
+        mount.local = dynamic_cast<FileSystem_impl*>(mount.servant.in());
+    } catch (const CORBA::Exception& ex) {
+        LOG_TRACE(FileManager_impl, "Unable to look up servant for " << mountPath << ": " << ex._name());
+    }
+    if (mount.local) {
+        LOG_TRACE(FileManager_impl, "Mounting local file system on " << mountPath);
+    } else {
+        LOG_TRACE(FileManager_impl, "Mounting remote file system on " << mountPath);
+    }
+    mountedFileSystems.push_back(mount);
 
     TRACE_EXIT(FileManager_impl)
 }
@@ -217,142 +581,198 @@ void FileManager_impl::copy (const char* sourceFileName, const char* destination
     }
 
     LOG_TRACE(FileManager_impl, "Copying between filesystems");
+    copyFile(getFileLocation(sourceFileName), getFileLocation(destinationFileName), false);
 
-    // Open the source file (may be local).
-    CF::File_var srcFile;
-    if (sourceMount == mountedFileSystems.end()) {
-        srcFile = FileSystem_impl::open(sourceFileName, true);
-    } else {
-        const std::string srcPath = sourceMount->getRelativePath(sourceFileName);
-        srcFile = sourceMount->fs->open(srcPath.c_str(), true);
+    TRACE_EXIT(FileManager_impl);
+}
+
+
+void FileManager_impl::copyTree (const char* sourcePath, const char* destinationPath, bool resume)
+    throw (CORBA::SystemException, CF::InvalidFileName, CF::FileException)
+{
+    TRACE_ENTER(FileManager_impl);
+
+    // Validate absolute directory names
+    const std::string sourceDir = normalizeMountPath(sourcePath);
+    const std::string destDir = normalizeMountPath(destinationPath);
+    if (sourcePath[0] != '/' || !ossie::isValidFileName(sourcePath)) {
+        throw CF::InvalidFileName(CF::CF_EINVAL, "Invalid source directory name");
+    } else if (destinationPath[0] != '/' || !ossie::isValidFileName(destinationPath)) {
+        throw CF::InvalidFileName(CF::CF_EINVAL, "Invalid destination directory name");
+    } else if (sourceDir == destDir) {
+        throw CF::InvalidFileName(CF::CF_EINVAL, "Destination directory name is identical to source directory name");
+    } else if (destDir.find(sourceDir + "/") == 0) {
+        throw CF::InvalidFileName(CF::CF_EINVAL, "Destination directory is inside source directory");
     }
 
-    // Open the destination file (may be local).
-    CF::File_var dstFile;
-    if (destMount == mountedFileSystems.end()) {
-        if (FileSystem_impl::exists(destinationFileName)) {
-            FileSystem_impl::remove(destinationFileName);
-        }
-        dstFile = FileSystem_impl::create(destinationFileName);
-    } else {
-        const std::string dstPath = destMount->getRelativePath(destinationFileName);
-        CF::FileSystem_ptr destFS = destMount->fs;
-        if (destFS->exists(dstPath.c_str())) {
-            destFS->remove(dstPath.c_str());
+    LOG_TRACE(FileManager_impl, "Copy tree " << sourceDir << " to " << destDir);
+
+    // Lock the mount table shared to allow others to access the file system,
+    // but prevent changes to the mount table itself.
+    boost::shared_lock<boost::shared_mutex> lock(mountsLock);
+
+    FileLocation source = getFileLocation(sourceDir);
+    if (!source.exists()) {
+        throw CF::FileException(CF::CF_ENOENT, "Source directory does not exist");
+    }
+
+    // Walk the source tree first, creating the destination directories, so
+    // that the files themselves can be copied concurrently.
+    CopyList files;
+    collectTree(source, getFileLocation(destDir), files);
+
+    size_t nextFile = 0;
+    std::string error;
+    boost::mutex copyLock;
+    boost::thread_group threads;
+    const size_t workers = std::min(files.size(), COPY_TREE_FILES_IN_FLIGHT);
+    for (size_t ii = 0; ii < workers; ++ii) {
+        threads.create_thread(boost::bind(&FileManager_impl::copyTreeFiles, this, boost::cref(files),
+                                          boost::ref(nextFile), boost::ref(error), boost::ref(copyLock), resume));
+    }
+    threads.join_all();
+
+    if (!error.empty()) {
+        LOG_ERROR(FileManager_impl, error);
+        throw CF::FileException(CF::CF_EIO, error.c_str());
+    }
+    LOG_DEBUG(FileManager_impl, "Copied " << files.size() << " files from " << sourceDir << " to " << destDir);
+
+    TRACE_EXIT(FileManager_impl);
+}
+
+
+void FileManager_impl::collectTree (const FileLocation& source, const FileLocation& destination, CopyList& files)
+{
+    if (!destination.exists()) {
+        destination.mkdir();
+    }
+
+    CF::FileSystem::FileInformationSequence_var contents = source.list(source.path + "/");
+    for (CORBA::ULong index = 0; index < contents->length(); ++index) {
+        const std::string name = static_cast<const char*>(contents[index].name);
+        if (contents[index].kind == CF::FileSystem::DIRECTORY) {
+            collectTree(source.child(name), destination.child(name), files);
+        } else if (contents[index].kind == CF::FileSystem::PLAIN) {
+            files.push_back(std::make_pair(source.child(name), destination.child(name)));
         }
-        dstFile = destFS->create(dstPath.c_str());
     }
+}
+
+
+void FileManager_impl::copyTreeFiles (const CopyList& files, size_t& nextFile, std::string& error, boost::mutex& lock, bool resume)
+{
+    while (true) {
+        size_t index;
+        {
+            boost::mutex::scoped_lock guard(lock);
+            if (!error.empty() || (nextFile >= files.size())) {
+                return;
+            }
+            index = nextFile++;
+        }
 
-    std::ostringstream eout;
-    bool fe=false;
-    try {
-      // Read the data
-      CF::OctetSequence_var data;
-      CORBA::ULong bytes = srcFile->sizeOf();
-      const CORBA::ULong DEFAULT_CHUNK_SIZE =  ossie::corba::giopMaxMsgSize() * 0.95;
-      while (bytes > 0) {
-        // Read the file data in 1MB chunks. If omniORB uses the GIOP protocol to talk to the source filesystem
-        // (i.e. it is in a different ORB), reads of more than about 2MB will exceed the maximum GIOP packet
-        // size and raise a MARSHAL exception.
-        CORBA::ULong chunkSize = std::min(bytes, DEFAULT_CHUNK_SIZE);
-        bytes -= chunkSize;
-        
-        try {
-          srcFile->read(data, chunkSize);
-        } catch ( std::exception& ex ) {
-          eout << "The following standard exception occurred: "<<ex.what()<<" While \"srcFile->read\"";
-          throw(CF::FileException());
-        } catch ( CF::FileException& ex ) {
-          eout << "File Exception occured,  While \"srcFile->read\"";
-          throw;
-        } catch ( CF::File::IOException& ex ) {
-          eout << "File IOException occured,  While \"srcFile->read\"";
-          throw;
-        } catch ( CORBA::Exception& ex ) {
-          eout << "The following CORBA exception occurred: "<<ex._name()<<" While \"srcFile->read\"";
-          throw(CF::FileException());
-        } catch( ... ) {
-          eout << "[FileManager::copy] \"srcFile->read\" failed with Unknown Exception\n";
-          throw(CF::FileException());
-        }
-
-        // write the data
         try {
-          dstFile->write(data);
-        } catch ( std::exception& ex ) {
-          std::ostringstream eout;
-          eout << "The following standard exception occurred: "<<ex.what()<<" While \"dstFile->write\"";
-          throw(CF::FileException());
-        } catch ( CF::FileException& ex ) {
-          eout << "File Exception occurred, during \"dstFile->write\"";
-          throw;
-        } catch ( CF::File::IOException& ex ) {
-          eout << "File IOException occurred, during \"dstFile->write\"";
-          throw;
-        } catch ( CORBA::Exception& ex ) {
-          eout << "The following CORBA exception occurred: "<<ex._name()<<" While \"dstFile->write\"";
-          throw(CF::FileException());
-        } catch( ... ) {
-          eout << "[FileManager::copy] \"dstFile->write\" failed with Unknown Exception\n";
-          throw(CF::FileException());
-        }
-
-      }
-    }
-    catch(...) {
-      LOG_ERROR(FileManager_impl, eout.str());
-      fe = true;
-    }
-
-   // close the files
-    try {
-      try {
-        srcFile->close();
-      } catch ( std::exception& ex ) {
-        eout << "The following standard exception occurred: "<<ex.what()<<" While \"srcFile->close\"";
-        throw(CF::FileException());
-      } catch ( CF::FileException& ex ) {
-        eout << "File Exception occured, during \"srcFile->close\"";
-        throw;
-      } catch ( CORBA::Exception& ex ) {
-        eout << "The following CORBA exception occurred: "<<ex._name()<<" While \"srcFile->close\"";
-        throw(CF::FileException());
-      } catch( ... ) {
-        eout << "[FileManager::copy] \"srcFile->close\" failed with Unknown Exception\n";
-        throw(CF::FileException());
-      }
-    } catch(...) {
-      LOG_ERROR(FileManager_impl, eout.str());
-      fe = true;
+            copyFile(files[index].first, files[index].second, resume);
+        } catch (...) {
+            const std::string operation = "copy " + files[index].first.path;
+            boost::mutex::scoped_lock guard(lock);
+            if (error.empty()) {
+                error = describeException(operation);
+            }
+        }
+    }
+}
+
+
+void FileManager_impl::copyFile (const FileLocation& source, const FileLocation& destination, bool resume)
+{
+    // If both ends are directly accessible, let the kernel copy the data.
+    const std::string localSource = source.getLocalPath();
+    const std::string localDest = destination.getLocalPath();
+    if (!localSource.empty() && !localDest.empty()) {
+        LOG_TRACE(FileManager_impl, "Copying " << localSource << " to " << localDest << " locally");
+        copyLocalFile(localSource, localDest, resume);
+        return;
+    } else if (!resume && (source.mount == destination.mount)) {
+        LOG_TRACE(FileManager_impl, "Copying locally on remote file system");
+        source.fs->copy(source.path.c_str(), destination.path.c_str());
+        return;
     }
 
+    // Open the source file (may be local).
+    CF::File_var srcFile = source.open(true);
+    const CORBA::ULong size = srcFile->sizeOf();
+
+    // If resuming, keep a partial destination file whose tail matches the
+    // source; otherwise, replace the destination file.
+    CF::File_var dstFile;
+    CORBA::ULong offset = 0;
+    std::string error;
+    bool fe = false;
+    if (resume && destination.exists()) {
+        try {
+            dstFile = destination.open(false);
+            offset = getResumeOffset(srcFile, dstFile, size);
+            if (offset > 0) {
+                dstFile->setFilePointer(offset);
+            } else if (!closeFile(dstFile, "dstFile->close", error)) {
+                LOG_WARN(FileManager_impl, error);
+            }
+        } catch (...) {
+            LOG_WARN(FileManager_impl, describeException("resume " + destination.path));
+            if (!CORBA::is_nil(dstFile) && !closeFile(dstFile, "dstFile->close", error)) {
+                LOG_WARN(FileManager_impl, error);
+            }
+            offset = 0;
+        }
+        if (offset > 0) {
+            LOG_DEBUG(FileManager_impl, "Resuming copy of " << source.path << " at byte " << offset);
+        }
+    }
+    if (offset == 0) {
+        if (destination.exists()) {
+            destination.remove();
+        }
+        dstFile = destination.create();
+    }
 
+    // Read the file in chunks slightly smaller than the maximum GIOP message
+    // size. If omniORB uses the GIOP protocol to talk to the source file
+    // system (i.e. it is in a different ORB), larger reads would raise a
+    // MARSHAL exception.
+    ChunkPipeline::FileList readers;
+    readers.push_back(CF::File::_duplicate(srcFile));
+    const CORBA::ULong chunkSize = ossie::corba::giopMaxMsgSize() * 0.95;
+    const size_t chunks = (size - offset + chunkSize - 1) / chunkSize;
     try {
-      try {
-        dstFile->close();
-      } catch ( std::exception& ex ) {
-        eout << "The following standard exception occurred: "<<ex.what()<<" While \"dstFile->close\"";
-        throw(CF::FileException());
-      } catch ( CF::FileException& ex ) {
-        eout << "File Exception occured, during \"srcFile->close\"";
-        throw;
-      } catch ( CORBA::Exception& ex ) {
-        eout << "The following CORBA exception occurred: "<<ex._name()<<" While \"dstFile->close\"";
-        throw(CF::FileException());
-      } catch( ... ) {
-        eout << "[FileManager::copy] \"dstFile->close\" failed with Unknown Exception\n";
-        throw(CF::FileException());
-      }
-    } catch(...) {
-      LOG_ERROR(FileManager_impl, eout.str());
-      fe = true;
-    }
-
-    if ( fe ) {
-        throw(CF::FileException());
+        // Open additional handles so each reader has its own file pointer
+        while ((readers.size() < std::min(chunks, COPY_CHUNKS_IN_FLIGHT))) {
+            readers.push_back(source.open(true));
+        }
+        ChunkPipeline pipeline(readers, dstFile, offset, size, chunkSize);
+        pipeline.run();
+    } catch (...) {
+        error = describeException("copy " + source.path);
+        LOG_ERROR(FileManager_impl, error);
+        fe = true;
     }
 
-    TRACE_EXIT(FileManager_impl);
+    // close the files
+    for (ChunkPipeline::FileList::iterator reader = readers.begin(); reader != readers.end(); ++reader) {
+        if (!closeFile(*reader, "srcFile->close", error)) {
+            LOG_ERROR(FileManager_impl, error);
+            fe = true;
+        }
+    }
+    if (!closeFile(dstFile, "dstFile->close", error)) {
+        LOG_ERROR(FileManager_impl, error);
+        fe = true;
+    }
+
+    if (fe) {
+        throw CF::FileException(CF::CF_EIO, error.c_str());
+    }
 }
 
 
@@ -713,3 +1133,85 @@ FileManager_impl::MountList::iterator FileManager_impl::getMountForPath (const s
     }
     return mount;
 }
+
+
+FileManager_impl::FileLocation FileManager_impl::getFileLocation (const std::string& fileName)
+{
+    FileLocation location;
+    location.mount = getMountForPath(fileName);
+    if (location.mount == mountedFileSystems.end()) {
+        location.path = fileName;
+        location.local = this;
+    } else {
+        location.path = location.mount->getRelativePath(fileName);
+        location.fs = CF::FileSystem::_duplicate(location.mount->fs);
+        location.local = location.mount->local;
+    }
+    return location;
+}
+
+
+FileManager_impl::FileLocation FileManager_impl::FileLocation::child (const std::string& name) const
+{
+    FileLocation location(*this);
+    location.path += "/" + name;
+    return location;
+}
+
+std::string FileManager_impl::FileLocation::getLocalPath () const
+{
+    if (local) {
+        return local->getLocalPath(path.c_str());
+    }
+    return std::string();
+}
+
+CORBA::Boolean FileManager_impl::FileLocation::exists () const
+{
+    if (local) {
+        return local->FileSystem_impl::exists(path.c_str());
+    }
+    return fs->exists(path.c_str());
+}
+
+void FileManager_impl::FileLocation::remove () const
+{
+    if (local) {
+        local->FileSystem_impl::remove(path.c_str());
+    } else {
+        fs->remove(path.c_str());
+    }
+}
+
+void FileManager_impl::FileLocation::mkdir () const
+{
+    if (local) {
+        local->FileSystem_impl::mkdir(path.c_str());
+    } else {
+        fs->mkdir(path.c_str());
+    }
+}
+
+CF::File_ptr FileManager_impl::FileLocation::open (bool readOnly) const
+{
+    if (local) {
+        return local->FileSystem_impl::open(path.c_str(), readOnly);
+    }
+    return fs->open(path.c_str(), readOnly);
+}
+
+CF::File_ptr FileManager_impl::FileLocation::create () const
+{
+    if (local) {
+        return local->FileSystem_impl::create(path.c_str());
+    }
+    return fs->create(path.c_str());
+}
+
+CF::FileSystem::FileInformationSequence* FileManager_impl::FileLocation::list (const std::string& pattern) const
+{
+    if (local) {
+        return local->FileSystem_impl::list(pattern.c_str());
+    }
+    return fs->list(pattern.c_str());
+}
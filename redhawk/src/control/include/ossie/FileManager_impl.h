@@ -24,7 +24,9 @@
 
 #include <string>
 #include <list>
+#include <vector>
 
+#include <boost/thread/mutex.hpp>
 #include <boost/thread/shared_mutex.hpp>
 
 #include <ossie/CF/cf.h>
@@ -78,14 +80,27 @@ public:
 
     CF::FileManager::MountSequence* getMounts () throw (CORBA::SystemException);
 
+    /*
+     * Copy the directory sourcePath, including all of its subdirectories, to destinationPath.
+     * Files are copied concurrently; if resume is true, destination files left behind by an
+     * interrupted copy are completed instead of being copied again.
+     */
+    void copyTree (const char* sourcePath, const char* destinationPath, bool resume=false)
+        throw (CF::FileException, CF::InvalidFileName, CORBA::SystemException);
+
 private:
     struct MountPoint {
         std::string path;
         CF::FileSystem_var fs;
+        // Set when the file system is served from this process
+        PortableServer::ServantBase_var servant;
+        FileSystem_impl* local;
         
         MountPoint (const std::string& path, CF::FileSystem_ptr fs):
             path(path),
-            fs(CF::FileSystem::_duplicate(fs))
+            fs(CF::FileSystem::_duplicate(fs)),
+            servant(),
+            local(0)
         {
         }
 
@@ -99,6 +114,33 @@ private:
 
     MountList::iterator getMountForPath (const std::string& path);
 
+    // Resolved file path on either the local file system or a mounted file system; local is
+    // set when the file system is served from this process, allowing direct file access.
+    struct FileLocation {
+        MountList::iterator mount;
+        std::string path;
+        CF::FileSystem_var fs;
+        FileSystem_impl* local;
+
+        FileLocation child (const std::string& name) const;
+        std::string getLocalPath () const;
+
+        CORBA::Boolean exists () const;
+        void remove () const;
+        void mkdir () const;
+        CF::File_ptr open (bool readOnly) const;
+        CF::File_ptr create () const;
+        CF::FileSystem::FileInformationSequence* list (const std::string& pattern) const;
+    };
+
+    typedef std::vector<std::pair<FileLocation,FileLocation> > CopyList;
+
+    FileLocation getFileLocation (const std::string& fileName);
+
+    void copyFile (const FileLocation& source, const FileLocation& destination, bool resume);
+    void collectTree (const FileLocation& source, const FileLocation& destination, CopyList& files);
+    void copyTreeFiles (const CopyList& files, size_t& nextFile, std::string& error, boost::mutex& lock, bool resume);
+
     CORBA::ULongLong getCombinedProperty (const char* propId);
 
 };                  /* END CLASS DEFINITION FileManager */
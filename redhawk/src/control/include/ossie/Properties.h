@@ -340,6 +340,9 @@ namespace ossie {
         return out;
     }
 
+    class PRFImage;
+    class PRFLoader;
+
     /*
      *
      */
@@ -363,34 +366,43 @@ namespace ossie {
         _ctorProperties(), 
         _allocationProperties(), 
         _execProperties(), 
-        _factoryProperties() 
+        _factoryProperties(),
+        _loader(0)
         {}
 
-        ~PRF() {
-        LOG_TRACE(PRF, "Deleting PRF containing " << _allProperties.size() << " properties");
-        // Clear all vectors
-        std::vector<const Property*>::iterator p;
-        for (p = _allProperties.begin(); p != _allProperties.end(); ++p) {
-            delete *p;
-        }
-
-        _allProperties.clear();
-        _configProperties.clear();
-        _ctorProperties.clear();
-        _allocationProperties.clear();
-        _execProperties.clear();
-        _factoryProperties.clear();
+        /*
+         * Creates a property set that is decoded from a parsed image one
+         * section at a time, as the sections are first requested
+         */
+        explicit PRF(const boost::shared_ptr<const PRFImage>& image);
 
-        // Clear the property map
-        _properties.clear();
-        }
+        ~PRF();
 
         void addProperty(const Property* p) throw (ossie::parser_error);
 
     protected:
-        PRF(const PRF&) // Hide copy constructor
+        PRF(const PRF&) : // Hide copy constructor
+        _loader(0)
         {}
 
+    private:
+        friend class Properties;
+
+        /*
+         * Ensures that the given sections (a mask of kinds, private to the
+         * parser) are filled in
+         */
+        void materialize(unsigned int sections);
+
+        /*
+         * Returns the property with the given id, decoding only that property
+         * if the full set has not been requested
+         */
+        const Property* findProperty(const std::string& id);
+
+        // Decoding state for a PRF created from an image; null if the PRF was
+        // parsed directly
+        PRFLoader* _loader;
     };
 
     /*
@@ -442,11 +454,28 @@ namespace ossie {
          */
         void override(const ossie::ComponentPropertyList & values);
 
+        /*
+         * Sets the maximum total size, in bytes, of the parsed PRF images that
+         * are kept to speed up loading the same PRF again; zero disables the
+         * cache
+         */
+        static void setCacheLimit(size_t bytes);
+
     protected:
         Properties(const Properties&) // Hide copy constructor
         {}
 
     private:
+        friend class PRF;
+        friend class PRFImage;
+        friend class PRFLoader;
+
+        static std::auto_ptr<ossie::PRF> parse(std::istream& input) throw (ossie::parser_error);
+
+        // Compact binary form of the parsed properties
+        static void encode(std::string& data, const Property* property);
+        static Property* decode(const char*& pos, const char* end) throw (ossie::parser_error);
+
 	boost::shared_ptr<ossie::PRF> _prf;
     };
 
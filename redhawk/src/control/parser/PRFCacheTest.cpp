@@ -0,0 +1,296 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK core.
+ *
+ * REDHAWK core is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK core is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+//
+// Checks that PRFs loaded from the ossie::Properties image cache are the same
+// as a direct parse: every field of every property, in every section, whether
+// the cached copy is read a section at a time or a property at a time.
+//
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ossie/Properties.h"
+
+namespace {
+
+    const char* PRF_TEXT =
+        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        "<properties>\n"
+        "  <simple id=\"count\" name=\"Count\" mode=\"readwrite\" type=\"ulong\">\n"
+        "    <value>7</value>\n"
+        "    <kind kindtype=\"configure\"/>\n"
+        "    <kind kindtype=\"property\"/>\n"
+        "    <action type=\"external\"/>\n"
+        "  </simple>\n"
+        "  <simple id=\"gain\" mode=\"readonly\" type=\"double\" commandline=\"true\">\n"
+        "    <value>1.5</value>\n"
+        "    <kind kindtype=\"property\"/>\n"
+        "    <action type=\"external\"/>\n"
+        "  </simple>\n"
+        "  <simple id=\"mode\" mode=\"readwrite\" type=\"string\">\n"
+        "    <value>fast</value>\n"
+        "    <kind kindtype=\"execparam\"/>\n"
+        "    <action type=\"external\"/>\n"
+        "  </simple>\n"
+        "  <simple id=\"seed\" mode=\"readwrite\" type=\"long\">\n"
+        "    <kind kindtype=\"factoryparam\"/>\n"
+        "    <action type=\"external\"/>\n"
+        "  </simple>\n"
+        "  <simple id=\"os_name\" mode=\"readonly\" type=\"string\">\n"
+        "    <value>Linux</value>\n"
+        "    <kind kindtype=\"allocation\"/>\n"
+        "    <action type=\"eq\"/>\n"
+        "  </simple>\n"
+        "  <simplesequence id=\"constellation\" name=\"Constellation\" mode=\"readwrite\" type=\"float\" complex=\"true\">\n"
+        "    <values>\n"
+        "      <value>1+j0</value>\n"
+        "      <value>0+j1</value>\n"
+        "      <value>-1+j0</value>\n"
+        "    </values>\n"
+        "    <kind kindtype=\"configure\"/>\n"
+        "    <action type=\"external\"/>\n"
+        "  </simplesequence>\n"
+        "  <simplesequence id=\"channels\" mode=\"readwrite\" type=\"short\" optional=\"true\">\n"
+        "    <kind kindtype=\"allocation\"/>\n"
+        "    <action type=\"external\"/>\n"
+        "  </simplesequence>\n"
+        "  <struct id=\"station\" name=\"Station\" mode=\"readwrite\">\n"
+        "    <simple id=\"station::name\" type=\"string\">\n"
+        "      <value>WBJC</value>\n"
+        "    </simple>\n"
+        "    <simple id=\"station::frequency\" type=\"float\" optional=\"true\">\n"
+        "      <value>91.7</value>\n"
+        "    </simple>\n"
+        "    <simplesequence id=\"station::taps\" type=\"double\">\n"
+        "      <values>\n"
+        "        <value>0.25</value>\n"
+        "        <value>0.5</value>\n"
+        "      </values>\n"
+        "    </simplesequence>\n"
+        "    <configurationkind kindtype=\"property\"/>\n"
+        "  </struct>\n"
+        "  <struct id=\"capacity\" mode=\"writeonly\">\n"
+        "    <simple id=\"capacity::cores\" type=\"short\"/>\n"
+        "    <configurationkind kindtype=\"allocation\"/>\n"
+        "  </struct>\n"
+        "  <structsequence id=\"servers\" name=\"Servers\" mode=\"readwrite\">\n"
+        "    <struct id=\"endpoint\">\n"
+        "      <simple id=\"servers::host\" type=\"string\">\n"
+        "        <value>localhost</value>\n"
+        "      </simple>\n"
+        "      <simple id=\"servers::port\" type=\"short\"/>\n"
+        "      <simplesequence id=\"servers::aliases\" type=\"string\"/>\n"
+        "    </struct>\n"
+        "    <structvalue>\n"
+        "      <simpleref refid=\"servers::host\" value=\"alpha\"/>\n"
+        "      <simpleref refid=\"servers::port\" value=\"8080\"/>\n"
+        "      <simplesequenceref refid=\"servers::aliases\">\n"
+        "        <values>\n"
+        "          <value>a</value>\n"
+        "          <value>first</value>\n"
+        "        </values>\n"
+        "      </simplesequenceref>\n"
+        "    </structvalue>\n"
+        "    <structvalue>\n"
+        "      <simpleref refid=\"servers::port\" value=\"9090\"/>\n"
+        "    </structvalue>\n"
+        "    <configurationkind kindtype=\"configure\"/>\n"
+        "  </structsequence>\n"
+        "</properties>\n";
+
+    int failures = 0;
+
+    void check(bool condition, const std::string& message)
+    {
+        if (!condition) {
+            std::cerr << "FAILED: " << message << std::endl;
+            ++failures;
+        }
+    }
+
+    void describe(std::ostream& out, const ossie::Property* property);
+
+    void describeStruct(std::ostream& out, const ossie::StructProperty& structProp)
+    {
+        out << "{";
+        const std::vector<ossie::Property*>& fields = structProp.getValue();
+        for (std::vector<ossie::Property*>::const_iterator field = fields.begin(); field != fields.end(); ++field) {
+            describe(out, *field);
+            out << ";";
+        }
+        out << "}";
+    }
+
+    // Writes every field that the parser fills in, so that two descriptions
+    // are equal only if the properties are
+    void describe(std::ostream& out, const ossie::Property* property)
+    {
+        out << "id=" << property->getID() << " name=" << property->getName()
+            << " mode=" << property->getMode() << " action=" << property->getAction()
+            << " commandline=" << property->isCommandLine() << " kinds=[";
+        const std::vector<std::string>& kinds = property->getKinds();
+        for (std::vector<std::string>::const_iterator kind = kinds.begin(); kind != kinds.end(); ++kind) {
+            out << *kind << ",";
+        }
+        out << "]";
+
+        if (const ossie::SimpleProperty* simple = dynamic_cast<const ossie::SimpleProperty*>(property)) {
+            out << " simple type=" << simple->getType() << " complex=" << simple->getComplex()
+                << " optional=" << simple->getOptional();
+            if (simple->isNone()) {
+                out << " value=<none>";
+            } else {
+                out << " value=" << simple->getValue();
+            }
+        } else if (const ossie::SimpleSequenceProperty* sequence = dynamic_cast<const ossie::SimpleSequenceProperty*>(property)) {
+            out << " simplesequence type=" << sequence->getType() << " complex=" << sequence->getComplex()
+                << " optional=" << sequence->getOptional() << " values=[";
+            const std::vector<std::string>& values = sequence->getValues();
+            for (std::vector<std::string>::const_iterator value = values.begin(); value != values.end(); ++value) {
+                out << *value << ",";
+            }
+            out << "]";
+        } else if (const ossie::StructProperty* structProp = dynamic_cast<const ossie::StructProperty*>(property)) {
+            out << " struct ";
+            describeStruct(out, *structProp);
+        } else if (const ossie::StructSequenceProperty* structSeq = dynamic_cast<const ossie::StructSequenceProperty*>(property)) {
+            out << " structsequence def=";
+            describeStruct(out, structSeq->getStruct());
+            out << " values=[";
+            const std::vector<ossie::StructProperty>& values = structSeq->getValues();
+            for (std::vector<ossie::StructProperty>::const_iterator value = values.begin(); value != values.end(); ++value) {
+                describeStruct(out, *value);
+                out << ",";
+            }
+            out << "]";
+        } else {
+            out << " unknown";
+        }
+    }
+
+    std::string describe(const ossie::Property* property)
+    {
+        if (!property) {
+            return "<null>";
+        }
+        std::ostringstream out;
+        describe(out, property);
+        return out.str();
+    }
+
+    std::vector<std::string> describe(const std::vector<const ossie::Property*>& properties)
+    {
+        std::vector<std::string> result;
+        for (std::vector<const ossie::Property*>::const_iterator prop = properties.begin(); prop != properties.end(); ++prop) {
+            result.push_back(describe(*prop));
+        }
+        return result;
+    }
+
+    void compareSection(const std::string& label, const std::string& section,
+                        const std::vector<const ossie::Property*>& expected,
+                        const std::vector<const ossie::Property*>& actual)
+    {
+        const std::vector<std::string> expectedDesc = describe(expected);
+        const std::vector<std::string> actualDesc = describe(actual);
+        check(expectedDesc.size() == actualDesc.size(), label + ": " + section + " size differs");
+        for (size_t index = 0; index < expectedDesc.size() && index < actualDesc.size(); ++index) {
+            check(expectedDesc[index] == actualDesc[index],
+                  label + ": " + section + " differs\n  expected: " + expectedDesc[index] + "\n  actual:   " + actualDesc[index]);
+        }
+    }
+
+    void compareProperties(const std::string& label, ossie::Properties& expected, ossie::Properties& actual)
+    {
+        compareSection(label, "all", expected.getProperties(), actual.getProperties());
+        compareSection(label, "configure", expected.getConfigureProperties(), actual.getConfigureProperties());
+        compareSection(label, "property", expected.getConstructProperties(), actual.getConstructProperties());
+        compareSection(label, "allocation", expected.getAllocationProperties(), actual.getAllocationProperties());
+        compareSection(label, "execparam", expected.getExecParamProperties(), actual.getExecParamProperties());
+        compareSection(label, "factoryparam", expected.getFactoryParamProperties(), actual.getFactoryParamProperties());
+    }
+
+    void compareById(const std::string& label, ossie::Properties& expected, ossie::Properties& actual)
+    {
+        // Look up every property before any section has been requested, so
+        // that the cached copy decodes them one at a time
+        const std::vector<const ossie::Property*>& all = expected.getProperties();
+        for (std::vector<const ossie::Property*>::const_iterator prop = all.begin(); prop != all.end(); ++prop) {
+            const std::string id = (*prop)->getID();
+            check(describe(*prop) == describe(actual.getProperty(id)), label + ": property '" + id + "' differs");
+            check(describe(expected.getAllocationProperty(id)) == describe(actual.getAllocationProperty(id)),
+                  label + ": allocation property '" + id + "' differs");
+        }
+        check(actual.getProperty("missing") == 0, label + ": lookup of unknown id returned a property");
+    }
+
+    void load(ossie::Properties& props)
+    {
+        std::istringstream input(PRF_TEXT);
+        props.load(input);
+    }
+}
+
+int main()
+{
+    try {
+        // Reference parse, bypassing the cache
+        ossie::Properties::setCacheLimit(0);
+        ossie::Properties parsed;
+        load(parsed);
+        check(parsed.getProperties().size() == 10, "direct parse did not return every property");
+
+        ossie::Properties::setCacheLimit(1024 * 1024);
+
+        // The first load parses the document and adds it to the cache
+        ossie::Properties first;
+        load(first);
+        compareProperties("first load", parsed, first);
+
+        // Later loads are decoded from the image: by section, then by id
+        ossie::Properties bySection;
+        load(bySection);
+        compareProperties("cached load by section", parsed, bySection);
+
+        ossie::Properties byId;
+        load(byId);
+        compareById("cached load by id", parsed, byId);
+        compareProperties("cached load by id", parsed, byId);
+
+        // Sections requested out of order, starting with a partial one
+        ossie::Properties allocationFirst;
+        load(allocationFirst);
+        compareSection("cached load allocation first", "allocation",
+                       parsed.getAllocationProperties(), allocationFirst.getAllocationProperties());
+        compareProperties("cached load allocation first", parsed, allocationFirst);
+    } catch (const ossie::parser_error& error) {
+        std::cerr << "FAILED: parser error: " << error.what() << std::endl;
+        return 1;
+    }
+
+    if (failures) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    return 0;
+}
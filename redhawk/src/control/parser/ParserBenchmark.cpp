@@ -0,0 +1,256 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file 
+ * distributed with this source distribution.
+ * 
+ * This file is part of REDHAWK core.
+ * 
+ * REDHAWK core is free software: you can redistribute it and/or modify it 
+ * under the terms of the GNU Lesser General Public License as published by the 
+ * Free Software Foundation, either version 3 of the License, or (at your 
+ * option) any later version.
+ * 
+ * REDHAWK core is distributed in the hope that it will be useful, but WITHOUT 
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or 
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License 
+ * for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License 
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+//
+// Measures the time to parse the profiles in one or more SDR trees, for
+// example the codegenTesting profiles:
+//
+//   ParserBenchmark ../../../../codegenTesting/sdr
+//
+// Every profile is parsed from memory, so that file system access is not
+// included. PRF files are also loaded through ossie::Properties with its
+// image cache, which is how the domain loads the same PRF for each device or
+// component instance: once reading every section, and once reading only the
+// allocation properties.
+//
+// usage: ParserBenchmark [-n iterations] <directory or file>...
+//
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include "ossie/Properties.h"
+#include "ossie/SoftPkg.h"
+#include "ossie/ComponentDescriptor.h"
+#include "ossie/SoftwareAssembly.h"
+#include "ossie/DeviceManagerConfiguration.h"
+
+namespace {
+
+    int iterations = 20;
+
+    struct Profile {
+        std::string path;
+        std::string text;
+    };
+
+    struct Result {
+        Result() : files(0), bytes(0), seconds(0.0), failures(0) { }
+        size_t files;
+        size_t bytes;
+        double seconds;
+        size_t failures;
+    };
+
+    double now()
+    {
+        static const boost::posix_time::ptime epoch = boost::posix_time::microsec_clock::universal_time();
+        return (boost::posix_time::microsec_clock::universal_time() - epoch).total_microseconds() * 1e-6;
+    }
+
+    bool endsWith(const std::string& value, const std::string& suffix)
+    {
+        return (value.size() >= suffix.size()) && (value.compare(value.size() - suffix.size(), suffix.size(), suffix) == 0);
+    }
+
+    void findProfiles(const std::string& path, const std::string& suffix, std::vector<Profile>& profiles)
+    {
+        struct stat status;
+        if (stat(path.c_str(), &status)) {
+            return;
+        }
+        if (S_ISDIR(status.st_mode)) {
+            DIR* dir = opendir(path.c_str());
+            if (!dir) {
+                return;
+            }
+            std::vector<std::string> names;
+            struct dirent* entry;
+            while ((entry = readdir(dir)) != 0) {
+                if (entry->d_name[0] != '.') {
+                    names.push_back(entry->d_name);
+                }
+            }
+            closedir(dir);
+            std::sort(names.begin(), names.end());
+            for (std::vector<std::string>::iterator name = names.begin(); name != names.end(); ++name) {
+                findProfiles(path + "/" + *name, suffix, profiles);
+            }
+        } else if (endsWith(path, suffix)) {
+            std::ifstream file(path.c_str());
+            Profile profile;
+            profile.path = path;
+            profile.text.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            profiles.push_back(profile);
+        }
+    }
+
+    // Parses each profile the given number of times, returning the total
+    // time; profiles that fail to parse are counted but not timed again
+    template <class Parser>
+    Result measure(const std::vector<Profile>& profiles, Parser parser)
+    {
+        Result result;
+        for (std::vector<Profile>::const_iterator profile = profiles.begin(); profile != profiles.end(); ++profile) {
+            try {
+                // Parse once outside of the timing, which also primes the
+                // PRF image cache where it is used
+                parser(*profile);
+            } catch (const std::exception& exc) {
+                std::cerr << "  " << profile->path << ": " << exc.what() << std::endl;
+                result.failures++;
+                continue;
+            }
+            double start = now();
+            for (int ii = 0; ii < iterations; ++ii) {
+                parser(*profile);
+            }
+            result.seconds += now() - start;
+            result.files++;
+            result.bytes += profile->text.size();
+        }
+        return result;
+    }
+
+    void parsePRF(const Profile& profile)
+    {
+        std::istringstream stream(profile.text);
+        ossie::Properties prf(stream);
+        prf.getProperties();
+    }
+
+    void loadPRF(const Profile& profile)
+    {
+        std::istringstream stream(profile.text);
+        ossie::Properties prf(stream);
+        prf.getProperties();
+        prf.getConfigureProperties();
+        prf.getConstructProperties();
+        prf.getAllocationProperties();
+        prf.getExecParamProperties();
+        prf.getFactoryParamProperties();
+    }
+
+    void loadAllocationPRF(const Profile& profile)
+    {
+        std::istringstream stream(profile.text);
+        ossie::Properties prf(stream);
+        prf.getAllocationProperties();
+    }
+
+    void parseSPD(const Profile& profile)
+    {
+        std::istringstream stream(profile.text);
+        ossie::SoftPkg spd(stream, profile.path);
+    }
+
+    void parseSCD(const Profile& profile)
+    {
+        std::istringstream stream(profile.text);
+        ossie::ComponentDescriptor scd(stream);
+    }
+
+    void parseSAD(const Profile& profile)
+    {
+        std::istringstream stream(profile.text);
+        ossie::SoftwareAssembly sad(stream);
+    }
+
+    void parseDCD(const Profile& profile)
+    {
+        std::istringstream stream(profile.text);
+        ossie::DeviceManagerConfiguration dcd(stream);
+    }
+
+    void report(const std::string& name, const Result& result)
+    {
+        std::cout << std::setw(22) << std::left << name << std::right
+                  << std::setw(7) << result.files
+                  << std::setw(11) << result.bytes;
+        if (result.files > 0) {
+            double perFile = result.seconds / (result.files * iterations);
+            double rate = (result.bytes * iterations) / result.seconds;
+            std::cout << std::fixed << std::setprecision(1)
+                      << std::setw(13) << (perFile * 1e6)
+                      << std::setw(11) << (rate / (1024 * 1024));
+        }
+        if (result.failures > 0) {
+            std::cout << "  (" << result.failures << " failed)";
+        }
+        std::cout << std::endl;
+    }
+}
+
+int main(int argc, const char* argv[])
+{
+    std::vector<std::string> paths;
+    for (int arg = 1; arg < argc; ++arg) {
+        if ((strcmp(argv[arg], "-n") == 0) && ((arg + 1) < argc)) {
+            iterations = std::max(1, atoi(argv[++arg]));
+        } else {
+            paths.push_back(argv[arg]);
+        }
+    }
+    if (paths.empty()) {
+        std::cerr << "usage: " << argv[0] << " [-n iterations] <directory or file>..." << std::endl;
+        return 1;
+    }
+
+    std::vector<Profile> prfs, spds, scds, sads, dcds;
+    for (std::vector<std::string>::iterator path = paths.begin(); path != paths.end(); ++path) {
+        findProfiles(*path, ".prf.xml", prfs);
+        findProfiles(*path, ".spd.xml", spds);
+        findProfiles(*path, ".scd.xml", scds);
+        findProfiles(*path, ".sad.xml", sads);
+        findProfiles(*path, ".dcd.xml", dcds);
+    }
+
+    std::cout << "Parsing each profile " << iterations << " times" << std::endl;
+    std::cout << std::setw(22) << std::left << "profile" << std::right
+              << std::setw(7) << "files" << std::setw(11) << "bytes"
+              << std::setw(13) << "us/file" << std::setw(11) << "MB/s" << std::endl;
+
+    // Full parses, with the PRF image cache disabled
+    ossie::Properties::setCacheLimit(0);
+    report("PRF", measure(prfs, parsePRF));
+    report("SPD", measure(spds, parseSPD));
+    report("SCD", measure(scds, parseSCD));
+    report("SAD", measure(sads, parseSAD));
+    report("DCD", measure(dcds, parseDCD));
+
+    // Repeated loads of the same PRFs, decoded from their cached images
+    ossie::Properties::setCacheLimit(64 * 1024 * 1024);
+    report("PRF (cached)", measure(prfs, loadPRF));
+    report("PRF (cached, alloc)", measure(prfs, loadAllocationPRF));
+
+    return 0;
+}
@@ -19,6 +19,9 @@
  */
 
 #include<sstream>
+#include<list>
+#include<iterator>
+#include <boost/thread/mutex.hpp>
 #include"ossie/Properties.h"
 #include"internal/prf-parser.h"
 #include"ossie/ossieparser.h"
@@ -34,9 +37,339 @@ PREPARE_CF_LOGGING(SimpleSequenceProperty)
 PREPARE_CF_LOGGING(StructProperty)
 PREPARE_CF_LOGGING(StructSequenceProperty)
 
+namespace {
+
+    // Sections of a property set, by kind, which are decoded from a PRF image
+    // as they are first requested
+    enum {
+        SECTION_ALLOCATION   = 0x01,
+        SECTION_CONFIGURE    = 0x02,
+        SECTION_PROPERTY     = 0x04,
+        SECTION_EXECPARAM    = 0x08,
+        SECTION_FACTORYPARAM = 0x10,
+        SECTION_ALL          = 0x20,
+        SECTION_EVERYTHING   = 0x3F
+    };
+
+    // Tags for the property types in a PRF image
+    enum {
+        SIMPLE = 1,
+        SIMPLE_SEQUENCE = 2,
+        STRUCT = 3,
+        STRUCT_SEQUENCE = 4
+    };
+
+    const char IMAGE_MAGIC[] = "PRF1";
+    const size_t IMAGE_MAGIC_SIZE = 4;
+
+    void writeCount(std::string& data, size_t value)
+    {
+        for (int shift = 0; shift < 32; shift += 8) {
+            data += static_cast<char>((value >> shift) & 0xFF);
+        }
+    }
+
+    void writeString(std::string& data, const std::string& value)
+    {
+        writeCount(data, value.size());
+        data += value;
+    }
+
+    void writeStrings(std::string& data, const std::vector<std::string>& values)
+    {
+        writeCount(data, values.size());
+        for (std::vector<std::string>::const_iterator value = values.begin(); value != values.end(); ++value) {
+            writeString(data, *value);
+        }
+    }
+
+    void checkAvailable(const char* pos, const char* end, size_t size)
+    {
+        if (static_cast<size_t>(end - pos) < size) {
+            throw ossie::parser_error("Truncated PRF image");
+        }
+    }
+
+    unsigned char readByte(const char*& pos, const char* end)
+    {
+        checkAvailable(pos, end, 1);
+        return static_cast<unsigned char>(*pos++);
+    }
+
+    size_t readCount(const char*& pos, const char* end)
+    {
+        checkAvailable(pos, end, 4);
+        size_t value = 0;
+        for (int shift = 0; shift < 32; shift += 8) {
+            value |= static_cast<size_t>(static_cast<unsigned char>(*pos++)) << shift;
+        }
+        return value;
+    }
+
+    std::string readString(const char*& pos, const char* end)
+    {
+        size_t size = readCount(pos, end);
+        checkAvailable(pos, end, size);
+        std::string value(pos, size);
+        pos += size;
+        return value;
+    }
+
+    void readStrings(const char*& pos, const char* end, std::vector<std::string>& values)
+    {
+        size_t count = readCount(pos, end);
+        values.reserve(count);
+        for (size_t index = 0; index < count; ++index) {
+            values.push_back(readString(pos, end));
+        }
+    }
+
+    unsigned int getSections(const Property* property)
+    {
+        unsigned int sections = 0;
+        if (property->isAllocation()) {
+            sections |= SECTION_ALLOCATION;
+        }
+        if (property->isConfigure()) {
+            sections |= SECTION_CONFIGURE;
+        }
+        if (property->isProperty()) {
+            sections |= SECTION_PROPERTY;
+        }
+        if (property->isExecParam()) {
+            sections |= SECTION_EXECPARAM;
+        }
+        if (property->isFactoryParam()) {
+            sections |= SECTION_FACTORYPARAM;
+        }
+        return sections;
+    }
+
+    unsigned long long hashSource(const std::string& source)
+    {
+        // 64-bit FNV-1a
+        unsigned long long hash = 14695981039346656037ULL;
+        for (std::string::const_iterator ch = source.begin(); ch != source.end(); ++ch) {
+            hash ^= static_cast<unsigned char>(*ch);
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+}
+
+namespace ossie {
+
+    /*
+     * Parsed form of a PRF document: a compact encoding of each property,
+     * preceded by its id and the sections it belongs to, so that properties
+     * can be found and decoded individually.
+     *
+     *   "PRF1" <count> { <sections> <id> <length> <encoded property> }...
+     *
+     * Counts and lengths are 32-bit little-endian; strings are a length
+     * followed by the characters.
+     */
+    class PRFImage
+    {
+    public:
+        struct Entry {
+            std::string id;
+            unsigned int sections;
+            size_t offset;
+            size_t length;
+        };
+
+        PRFImage(const std::string& source, const std::vector<const Property*>& properties) :
+            source(source),
+            hash(hashSource(source))
+        {
+            data.append(IMAGE_MAGIC, IMAGE_MAGIC_SIZE);
+            writeCount(data, properties.size());
+            std::string encoded;
+            for (std::vector<const Property*>::const_iterator prop = properties.begin(); prop != properties.end(); ++prop) {
+                encoded.clear();
+                Properties::encode(encoded, *prop);
+                data += static_cast<char>(getSections(*prop));
+                writeString(data, (*prop)->getID());
+                writeString(data, encoded);
+            }
+            index();
+        }
+
+        size_t size() const
+        {
+            return source.size() + data.size();
+        }
+
+        // The XML text the image was parsed from, to confirm cache matches
+        const std::string source;
+        const unsigned long long hash;
+
+        std::string data;
+        std::vector<Entry> entries;
+        std::map<std::string, size_t> ids;
+
+    private:
+        void index()
+        {
+            const char* pos = data.data();
+            const char* end = pos + data.size();
+            checkAvailable(pos, end, IMAGE_MAGIC_SIZE);
+            if (data.compare(0, IMAGE_MAGIC_SIZE, IMAGE_MAGIC) != 0) {
+                throw ossie::parser_error("Invalid PRF image");
+            }
+            pos += IMAGE_MAGIC_SIZE;
+
+            size_t count = readCount(pos, end);
+            entries.resize(count);
+            for (size_t index = 0; index < count; ++index) {
+                Entry& entry = entries[index];
+                entry.sections = readByte(pos, end);
+                entry.id = readString(pos, end);
+                entry.length = readCount(pos, end);
+                checkAvailable(pos, end, entry.length);
+                entry.offset = pos - data.data();
+                pos += entry.length;
+                // As with a parsed PRF, a later duplicate id replaces an earlier one
+                ids[entry.id] = index;
+            }
+        }
+    };
+
+    /*
+     * Per-PRF state for decoding properties from a shared image on demand.
+     */
+    class PRFLoader
+    {
+    public:
+        PRFLoader(const boost::shared_ptr<const PRFImage>& image) :
+            image(image),
+            decoded(image->entries.size(), 0),
+            materialized(0)
+        {
+        }
+
+        // Called with the lock held
+        const Property* decode(size_t index)
+        {
+            if (!decoded[index]) {
+                const PRFImage::Entry& entry = image->entries[index];
+                const char* pos = image->data.data() + entry.offset;
+                decoded[index] = Properties::decode(pos, pos + entry.length);
+            }
+            return decoded[index];
+        }
+
+        // Released once every section has been decoded
+        boost::shared_ptr<const PRFImage> image;
+        // Decoded properties by image index; owns them until the full set is
+        // requested
+        std::vector<const Property*> decoded;
+        unsigned int materialized;
+        boost::mutex mutex;
+    };
+
+}
+
+namespace {
+
+    /*
+     * Process-wide cache of PRF images, most recently used first; the same
+     * PRF is typically loaded once per device or component instance.
+     */
+    class ImageCache
+    {
+    public:
+        static ImageCache& instance()
+        {
+            static ImageCache cache;
+            return cache;
+        }
+
+        boost::shared_ptr<const PRFImage> find(const std::string& source)
+        {
+            const unsigned long long hash = hashSource(source);
+            boost::mutex::scoped_lock lock(_mutex);
+            for (ImageList::iterator image = _images.begin(); image != _images.end(); ++image) {
+                if (((*image)->hash == hash) && ((*image)->source == source)) {
+                    _images.splice(_images.begin(), _images, image);
+                    return _images.front();
+                }
+            }
+            return boost::shared_ptr<const PRFImage>();
+        }
+
+        void insert(const boost::shared_ptr<const PRFImage>& image)
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            if (image->size() > _limit) {
+                return;
+            }
+            _images.push_front(image);
+            _size += image->size();
+            trim();
+        }
+
+        void setLimit(size_t bytes)
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            _limit = bytes;
+            trim();
+        }
+
+        bool enabled()
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            return (_limit > 0);
+        }
+
+    private:
+        typedef std::list< boost::shared_ptr<const PRFImage> > ImageList;
+
+        ImageCache() :
+            _limit(8*1024*1024),
+            _size(0)
+        {
+        }
+
+        void trim()
+        {
+            while (_size > _limit) {
+                _size -= _images.back()->size();
+                _images.pop_back();
+            }
+        }
+
+        boost::mutex _mutex;
+        ImageList _images;
+        size_t _limit;
+        size_t _size;
+    };
+
+}
+
 /*
  * PRF class
  */
+PRF::PRF(const boost::shared_ptr<const PRFImage>& image) :
+    _loader(new PRFLoader(image))
+{
+}
+
+PRF::~PRF()
+{
+    LOG_TRACE(PRF, "Deleting PRF containing " << _allProperties.size() << " properties");
+    // Until the full set is requested, the decoded properties are only owned
+    // by the loader
+    const bool partial = _loader && !(_loader->materialized & SECTION_ALL);
+    std::vector<const Property*>& owned = partial ? _loader->decoded : _allProperties;
+    std::vector<const Property*>::iterator p;
+    for (p = owned.begin(); p != owned.end(); ++p) {
+        delete *p;
+    }
+    delete _loader;
+}
+
 void PRF::addProperty(const Property* p) throw (ossie::parser_error)
 {
     LOG_TRACE(PRF, "Adding property " << p->getID() << " " << p);
@@ -69,6 +402,73 @@ void PRF::addProperty(const Property* p) throw (ossie::parser_error)
     }
 }
 
+void PRF::materialize(unsigned int sections)
+{
+    if (!_loader) {
+        // Parsed directly, so every section is already filled in
+        return;
+    }
+
+    boost::mutex::scoped_lock lock(_loader->mutex);
+    sections &= ~_loader->materialized;
+    if (!sections) {
+        return;
+    }
+
+    const std::vector<PRFImage::Entry>& entries = _loader->image->entries;
+    for (size_t index = 0; index < entries.size(); ++index) {
+        const unsigned int kinds = entries[index].sections & sections;
+        if (!kinds && !(sections & SECTION_ALL)) {
+            continue;
+        }
+        const Property* property = _loader->decode(index);
+        if (sections & SECTION_ALL) {
+            _properties[property->getID()] = property;
+            _allProperties.push_back(property);
+        }
+        if (kinds & SECTION_ALLOCATION) {
+            _allocationProperties.push_back(property);
+        }
+        if (kinds & SECTION_CONFIGURE) {
+            _configProperties.push_back(property);
+        }
+        if (kinds & SECTION_PROPERTY) {
+            _ctorProperties.push_back(property);
+        }
+        if (kinds & SECTION_EXECPARAM) {
+            _execProperties.push_back(property);
+        }
+        if (kinds & SECTION_FACTORYPARAM) {
+            _factoryProperties.push_back(property);
+        }
+    }
+    _loader->materialized |= sections;
+    if (_loader->materialized == SECTION_EVERYTHING) {
+        LOG_TRACE(PRF, "Decoded all " << _allProperties.size() << " properties");
+        _loader->decoded.clear();
+        _loader->image.reset();
+    }
+}
+
+const Property* PRF::findProperty(const std::string& id)
+{
+    if (_loader) {
+        boost::mutex::scoped_lock lock(_loader->mutex);
+        if (!(_loader->materialized & SECTION_ALL)) {
+            std::map<std::string, size_t>::const_iterator index = _loader->image->ids.find(id);
+            if (index == _loader->image->ids.end()) {
+                return 0;
+            }
+            return _loader->decode(index->second);
+        }
+    }
+    std::map<std::string, const Property*>::iterator p = _properties.find(id);
+    if (p != _properties.end()) {
+        return p->second;
+    }
+    return 0;
+}
+
 /*
  * Properties class
  */
@@ -93,20 +493,54 @@ Properties& Properties::operator=(const Properties &other) {
   return *this;
 }
 
+void Properties::setCacheLimit(size_t bytes)
+{
+    ImageCache::instance().setLimit(bytes);
+}
+
+std::auto_ptr<ossie::PRF> Properties::parse(std::istream& input) throw (ossie::parser_error)
+{
+    ImageCache& cache = ImageCache::instance();
+    if (!cache.enabled()) {
+        return ossie::internalparser::parsePRF(input);
+    }
+
+    std::string source;
+    try {
+        source.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+    } catch (const std::ios_base::failure& e) {
+        throw ossie::parser_error(e.what());
+    }
+
+    boost::shared_ptr<const PRFImage> image = cache.find(source);
+    if (image) {
+        LOG_TRACE(Properties, "Using cached PRF image with " << image->entries.size() << " properties");
+        return std::auto_ptr<ossie::PRF>(new ossie::PRF(image));
+    }
+
+    // Only documents that parse successfully are cached, so that errors are
+    // always reported by the parser
+    std::istringstream stream(source);
+    std::auto_ptr<ossie::PRF> prf = ossie::internalparser::parsePRF(stream);
+    cache.insert(boost::shared_ptr<const PRFImage>(new PRFImage(source, prf->_allProperties)));
+    return prf;
+}
 
 void Properties::load(std::istream& input) throw (ossie::parser_error) {
-  std::auto_ptr<ossie::PRF> t = ossie::internalparser::parsePRF(input);
+  std::auto_ptr<ossie::PRF> t = parse(input);
   _prf.reset(t.release());
 }
 
 void Properties::join(std::istream& input) throw (ossie::parser_error) {
     LOG_TRACE(Properties, "Loading property set")
-      std::auto_ptr<ossie::PRF> _joinedprf = ossie::internalparser::parsePRF(input);
+      std::auto_ptr<ossie::PRF> _joinedprf = parse(input);
     if (_prf.get() == 0) {
         LOG_TRACE(Properties, "No initial load, using join set for properties")
         _prf.reset(_joinedprf.release());
     } else {
         LOG_TRACE(Properties, "Merging property sets")
+        _prf->materialize(SECTION_EVERYTHING);
+        _joinedprf->materialize(SECTION_EVERYTHING);
         std::vector<const Property*>::iterator jp_iter;
         for (jp_iter = _joinedprf->_allProperties.begin(); jp_iter != _joinedprf->_allProperties.end(); ++jp_iter) {
             std::map<std::string, const Property*>::iterator p;
@@ -139,6 +573,8 @@ void Properties::join(std::istream& input) throw (ossie::parser_error) {
 void Properties::join(ossie::Properties& props) throw (ossie::parser_error) {
     LOG_TRACE(Properties, "Loading property set")
     LOG_TRACE(Properties, "Merging property sets")
+    _prf->materialize(SECTION_EVERYTHING);
+    props._prf->materialize(SECTION_EVERYTHING);
     std::vector<const Property*>::iterator jp_iter;
     for (jp_iter = props._prf->_allProperties.begin(); jp_iter != props._prf->_allProperties.end(); ++jp_iter) {
         std::map<std::string, const Property*>::iterator p;
@@ -183,23 +619,20 @@ void Properties::override(const ossie::ComponentPropertyList & values)
 const std::vector<const Property*>& Properties::getProperties() const
 {
     assert(_prf.get() != 0);
+    _prf->materialize(SECTION_ALL);
     return _prf->_allProperties;
 }
 
 const Property* Properties::getProperty(const std::string& id)
 {
     assert(_prf.get() != 0);
-    std::map<std::string, const Property*>::iterator p = _prf->_properties.find(id);
-    if (p != _prf->_properties.end()) {
-        return p->second;
-    } else {
-        return 0;
-    }
+    return _prf->findProperty(id);
 }
 
 const std::vector<const Property*>& Properties::getConfigureProperties() const
 {
     assert(_prf.get() != 0);
+    _prf->materialize(SECTION_CONFIGURE);
     return _prf->_configProperties;
 }
 
@@ -207,12 +640,14 @@ const std::vector<const Property*>& Properties::getConfigureProperties() const
 const std::vector<const Property*>& Properties::getConstructProperties() const
 {
     assert(_prf.get() != 0);
+    _prf->materialize(SECTION_PROPERTY);
     return _prf->_ctorProperties;
 }
 
 const std::vector<const Property*>& Properties::getAllocationProperties() const
 {
     assert(_prf.get() != 0);
+    _prf->materialize(SECTION_ALLOCATION);
     return _prf->_allocationProperties;
 }
 
@@ -228,15 +663,139 @@ const Property* Properties::getAllocationProperty(const std::string& id)
 const std::vector<const Property*>& Properties::getExecParamProperties() const
 {
     assert(_prf.get() != 0);
+    _prf->materialize(SECTION_EXECPARAM);
     return _prf->_execProperties;
 }
 
 const std::vector<const Property*>& Properties::getFactoryParamProperties() const
 {
     assert(_prf.get() != 0);
+    _prf->materialize(SECTION_FACTORYPARAM);
     return _prf->_factoryProperties;
 }
 
+void Properties::encode(std::string& data, const Property* property)
+{
+    const SimpleProperty* simple = dynamic_cast<const SimpleProperty*>(property);
+    const SimpleSequenceProperty* simpleseq = dynamic_cast<const SimpleSequenceProperty*>(property);
+    const StructProperty* structprop = dynamic_cast<const StructProperty*>(property);
+    const StructSequenceProperty* structseq = dynamic_cast<const StructSequenceProperty*>(property);
+
+    if (simple) {
+        data += static_cast<char>(SIMPLE);
+    } else if (simpleseq) {
+        data += static_cast<char>(SIMPLE_SEQUENCE);
+    } else if (structprop) {
+        data += static_cast<char>(STRUCT);
+    } else if (structseq) {
+        data += static_cast<char>(STRUCT_SEQUENCE);
+    } else {
+        throw ossie::parser_error(std::string("Unknown type for property ") + property->getID());
+    }
+
+    writeString(data, property->id);
+    writeString(data, property->name);
+    writeString(data, property->mode);
+    writeString(data, property->action);
+    writeStrings(data, property->kinds);
+    writeString(data, property->commandline);
+
+    if (simple) {
+        writeString(data, simple->type);
+        if (simple->value.isSet()) {
+            data += '\1';
+            writeString(data, *(simple->value));
+        } else {
+            data += '\0';
+        }
+        writeString(data, simple->_complex);
+        writeString(data, simple->optional);
+    } else if (simpleseq) {
+        writeString(data, simpleseq->type);
+        writeStrings(data, simpleseq->values);
+        writeString(data, simpleseq->_complex);
+        writeString(data, simpleseq->optional);
+    } else if (structprop) {
+        writeCount(data, structprop->value.size());
+        for (std::vector<Property*>::const_iterator field = structprop->value.begin(); field != structprop->value.end(); ++field) {
+            encode(data, *field);
+        }
+    } else {
+        encode(data, &(structseq->structdef));
+        writeCount(data, structseq->values.size());
+        for (std::vector<StructProperty>::const_iterator value = structseq->values.begin(); value != structseq->values.end(); ++value) {
+            encode(data, &(*value));
+        }
+    }
+}
+
+Property* Properties::decode(const char*& pos, const char* end) throw (ossie::parser_error)
+{
+    std::auto_ptr<Property> property;
+    SimpleProperty* simple = 0;
+    SimpleSequenceProperty* simpleseq = 0;
+    StructProperty* structprop = 0;
+    StructSequenceProperty* structseq = 0;
+    switch (readByte(pos, end)) {
+    case SIMPLE:
+        property.reset(simple = new SimpleProperty());
+        break;
+    case SIMPLE_SEQUENCE:
+        property.reset(simpleseq = new SimpleSequenceProperty());
+        break;
+    case STRUCT:
+        property.reset(structprop = new StructProperty());
+        break;
+    case STRUCT_SEQUENCE:
+        property.reset(structseq = new StructSequenceProperty());
+        break;
+    default:
+        throw ossie::parser_error("Invalid property type in PRF image");
+    }
+
+    property->id = readString(pos, end);
+    property->name = readString(pos, end);
+    property->mode = readString(pos, end);
+    property->action = readString(pos, end);
+    readStrings(pos, end, property->kinds);
+    property->commandline = readString(pos, end);
+
+    if (simple) {
+        simple->type = readString(pos, end);
+        if (readByte(pos, end)) {
+            simple->value = readString(pos, end);
+        }
+        simple->_complex = readString(pos, end);
+        simple->optional = readString(pos, end);
+    } else if (simpleseq) {
+        simpleseq->type = readString(pos, end);
+        readStrings(pos, end, simpleseq->values);
+        simpleseq->_complex = readString(pos, end);
+        simpleseq->optional = readString(pos, end);
+    } else if (structprop) {
+        size_t count = readCount(pos, end);
+        for (size_t index = 0; index < count; ++index) {
+            structprop->value.push_back(decode(pos, end));
+        }
+    } else {
+        std::auto_ptr<Property> structdef(decode(pos, end));
+        if (!dynamic_cast<StructProperty*>(structdef.get())) {
+            throw ossie::parser_error("Invalid struct definition in PRF image");
+        }
+        structseq->structdef = *static_cast<StructProperty*>(structdef.get());
+        size_t count = readCount(pos, end);
+        structseq->values.reserve(count);
+        for (size_t index = 0; index < count; ++index) {
+            std::auto_ptr<Property> value(decode(pos, end));
+            if (!dynamic_cast<StructProperty*>(value.get())) {
+                throw ossie::parser_error("Invalid struct value in PRF image");
+            }
+            structseq->values.push_back(*static_cast<StructProperty*>(value.get()));
+        }
+    }
+    return property.release();
+}
+
 /*
  * Property class
  */
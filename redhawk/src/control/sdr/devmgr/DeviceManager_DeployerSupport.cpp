@@ -19,12 +19,16 @@
  */
 
 #include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <sys/stat.h>
 #include <sys/utsname.h>
 #include <boost/filesystem.hpp>
 #include <boost/algorithm/string.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
 
 #include <ossie/ossieSupport.h>
 #include <ossie/debug.h>
@@ -56,6 +60,24 @@ static bool checkPath(const std::string& envpath, const std::string& pattern, ch
     return ((end == envpath.size()) || (envpath[end] == delim));
 }
 
+// Returns the first executable file named name in the colon-separated list of
+// directories, or name itself if there is none
+static std::string findExecutable(const std::string& name, const std::string& envpath)
+{
+    std::vector<std::string> dirs;
+    boost::algorithm::split(dirs, envpath, boost::algorithm::is_any_of(":"));
+    for (std::vector<std::string>::const_iterator dir = dirs.begin(); dir != dirs.end(); ++dir) {
+        if (dir->empty()) {
+            continue;
+        }
+        std::string candidate = *dir + "/" + name;
+        if (access(candidate.c_str(), X_OK) == 0) {
+            return candidate;
+        }
+    }
+    return name;
+}
+
 void DeviceManager_impl::createDeviceThreadAndHandleExceptions(
         const ossie::ComponentPlacement&              componentPlacement,
 	local_spd::ProgramProfile                     *compProfile,
@@ -76,9 +98,6 @@ void DeviceManager_impl::createDeviceThreadAndHandleExceptions(
 	  compProfile->overrideProperty( overrideProps[j] );
 	}
 
-        // these variables will cleanup path and environment from package mods that might have failed
-        ProcessEnvironment  restoreState;
-
         createDeviceThread(componentPlacement,
 			   compProfile,
                            componentType,
@@ -149,9 +168,7 @@ void DeviceManager_impl::createDeviceThread(
     //get code type 
     const local_spd::ImplementationInfo *matchingImpl = compProfile->getSelectedImplementation();
     bool isSharedLibrary = (matchingImpl->getCodeType() == CF::LoadableDevice::SHARED_LIBRARY);
-    
-    // reset package modifications list
-    sharedPkgs.clear();
+    boost::posix_time::ptime stageStart = boost::posix_time::microsec_clock::local_time();
 
     // Logic for persona devices
     // check is parent exists and if the code type is "SharedLibrary"
@@ -219,6 +236,8 @@ void DeviceManager_impl::createDeviceThread(
         LOG_DEBUG(DeviceManager_impl, "Execute '" << codeFilePath << "' on parent device: " << execDevice->identifier());
         execDevice->executeLinked(codeFilePath.c_str(), options, personaProps, dep_seq);
         LOG_DEBUG(DeviceManager_impl, "Execute complete");
+        LOG_DEBUG(DeviceManager_impl, "Deployed '" << usageName << "' to parent device " << execDevId << " in "
+                  << (boost::posix_time::microsec_clock::local_time() - stageStart).total_milliseconds() << " ms");
 
     } else {
 
@@ -252,14 +271,104 @@ void DeviceManager_impl::createDeviceThread(
 
         loadDependencies( compProfile, CF::LoadableDevice::_nil(), matchingImpl->getSoftPkgDependencies() );
 
-        setEnvironment( myenv, compProfile->getResolvedSoftPkgDependencies(), sharedPkgs );
+        PackageMods pkgMods;
+        {
+            boost::mutex::scoped_lock lock(sharedPkgsmutex);
+            pkgMods = sharedPkgs;
+        }
+        setEnvironment( myenv, compProfile->getResolvedSoftPkgDependencies(), pkgMods );
+
+        // Everything the child needs is prepared here, because other launch
+        // threads may hold the allocator or logging locks at the time of the
+        // fork; between fork and exec the child only makes async-signal-safe
+        // calls
+        std::vector<std::string> envStrings;
+        const ProcessEnvironment::Variables& variables = myenv.environ();
+        for (ProcessEnvironment::Variables::const_iterator var = variables.begin(); var != variables.end(); ++var) {
+            envStrings.push_back(var->first + "=" + var->second);
+        }
+        std::vector<char*> envp(envStrings.size() + 1, NULL);
+        for (std::size_t i = 0; i < envStrings.size(); ++i) {
+            envp[i] = const_cast<char*>(envStrings[i].c_str());
+        }
+
+        // execve does not search the path, so find valgrind the way execvp
+        // would have, using the child's PATH
+        std::string execPath = new_argv[0];
+        if (execPath == "valgrind") {
+            ProcessEnvironment::Variables::const_iterator path = variables.find("PATH");
+            if (path != variables.end()) {
+                execPath = findExecutable(execPath, path->second);
+            }
+        }
 
-        rh_logger::LevelPtr  lvl = DeviceManager_impl::__logger->getLevel();
+        // Affinity is applied to the child by the parent, which holds the
+        // child before exec until it is done
+        CF::Properties affinityOptions = getResourceOptions( instantiation );
+        bool applyAffinity = false;
+        if ( redhawk::affinity::has_affinity(affinityOptions) ) {
+            if ( redhawk::affinity::is_disabled() ) {
+                LOG_WARN(DeviceManager_impl, "Affinity processing is disabled, unable to apply AFFINITY properties for resource: " << usageName );
+            } else {
+                applyAffinity = true;
+            }
+        }
 
+        sigset_t  sigset;
+        sigemptyset(&sigset);
+        sigaddset(&sigset, SIGINT);
+        sigaddset(&sigset, SIGQUIT);
+        sigaddset(&sigset, SIGTERM);
+        sigaddset(&sigset, SIGCHLD);
+
+        // The child writes errno to the status pipe if exec fails; on success
+        // the pipe is closed by the exec
+        int releasePipe[2];
+        int statusPipe[2];
+        if (pipe2(releasePipe, O_CLOEXEC) < 0) {
+            LOG_ERROR(DeviceManager_impl, "[DeviceManager::execute] Cannot create device thread: " << strerror(errno));
+            throw std::runtime_error("unable to create launch pipe");
+        }
+        if (pipe2(statusPipe, O_CLOEXEC) < 0) {
+            LOG_ERROR(DeviceManager_impl, "[DeviceManager::execute] Cannot create device thread: " << strerror(errno));
+            close(releasePipe[0]);
+            close(releasePipe[1]);
+            throw std::runtime_error("unable to create launch pipe");
+        }
+        const char* workDir = devcache.c_str();
+        const char* execFile = execPath.c_str();
+
+        boost::posix_time::ptime launchStart = boost::posix_time::microsec_clock::local_time();
         int pid = fork();
         if (pid > 0) {
             // parent process: pid is the process ID of the child
+            close(releasePipe[0]);
+            close(statusPipe[1]);
+            if (applyAffinity) {
+                try {
+                    LOG_DEBUG(DeviceManager_impl, "Applying AFFINITY properties, resource: " << usageName );
+                    redhawk::affinity::set_affinity( affinityOptions, pid, cpu_blacklist );
+                }
+                catch( redhawk::affinity::AffinityFailed &e) {
+                    LOG_WARN(DeviceManager_impl, "AFFINITY REQUEST FAILED, RESOURCE: " << usageName << ", REASON: " << e.what() );
+                }
+            }
+            close(releasePipe[1]);
+
+            int execError = 0;
+            ssize_t status;
+            do {
+                status = read(statusPipe[0], &execError, sizeof(execError));
+            } while ((status < 0) && (errno == EINTR));
+            close(statusPipe[0]);
+            if (status == sizeof(execError)) {
+                LOG_ERROR(DeviceManager_impl, new_argv[0] << " did not execute : " << strerror(execError));
+            }
+
             LOG_TRACE(DeviceManager_impl, "Resulting PID: " << pid);
+            LOG_DEBUG(DeviceManager_impl, "Launched '" << usageName << "' (pid " << pid << "): staged in "
+                      << (launchStart - stageStart).total_milliseconds() << " ms, forked in "
+                      << (boost::posix_time::microsec_clock::local_time() - launchStart).total_milliseconds() << " ms");
 
             // Add the new device/service to the pending list. When it registers, the remaining
             // fields will be filled out and it will be moved to the registered list.
@@ -282,69 +391,28 @@ void DeviceManager_impl::createDeviceThread(
         else if (pid == 0) {
             // Child process
 
-            rh_logger::LoggerPtr __logger = rh_logger::StdOutLogger::getRootLogger();
-            __logger->setLevel(lvl);
-
-            // apply environment changes for the process
-            myenv.apply();
-
-            int err;
-            sigset_t  sigset;
-            err=sigemptyset(&sigset);
-            err = sigaddset(&sigset, SIGINT);
-            if ( err ) {
-                RH_ERROR(__logger, "sigaction(SIGINT): " << strerror(errno));
-            }
-            err = sigaddset(&sigset, SIGQUIT);
-            if ( err ) {
-                RH_ERROR(__logger, "sigaction(SIGQUIT): " << strerror(errno));
-            }
-            err = sigaddset(&sigset, SIGTERM);
-            if ( err ) {
-                RH_ERROR(__logger, "sigaction(SIGTERM): " << strerror(errno));
-            }
-            err = sigaddset(&sigset, SIGCHLD);
-            if ( err ) {
-                RH_ERROR(__logger, "sigaction(SIGCHLD): " << strerror(errno));
-            }
+            //////////////////////////////////////////////////////////////
+            // Only async-signal-safe calls between the fork and the exec
+            //////////////////////////////////////////////////////////////
+            close(releasePipe[1]);
+            close(statusPipe[0]);
 
             // We must unblock the signals for child processes
-            err = sigprocmask(SIG_UNBLOCK, &sigset, NULL);
+            sigprocmask(SIG_UNBLOCK, &sigset, NULL);
 
-            //////////////////////////////////////////////////////////////
-            // DO not put any LOG calls between the fork and the execv
-            //////////////////////////////////////////////////////////////
+            // wait for the parent to finish setting up the process
+            char release;
+            while ((read(releasePipe[0], &release, 1) < 0) && (errno == EINTR));
 
             // switch to working directory
-            chdir(devcache.c_str());
-
-            // honor affinity requests
-            try {
-                CF::Properties options;
-                options = getResourceOptions( instantiation );
-                if ( redhawk::affinity::has_affinity(options) ){
-                    if ( redhawk::affinity::is_disabled() ) {
-                        RH_WARN(__logger, "Affinity processing is disabled, unable to apply AFFINITY properties for resource: " << usageName );
-                    }
-                    else {
-                        RH_DEBUG(__logger, "Applying AFFINITY properties, resource: " << usageName );
-                        redhawk::affinity::set_affinity( options, getpid(), cpu_blacklist );
-                    }
-                }
-            }
-            catch( redhawk::affinity::AffinityFailed &e) {
-                RH_WARN(__logger, "AFFINITY REQUEST FAILED, RESOURCE: " << usageName << ", REASON: " << e.what() );
-            }
+            chdir(workDir);
 
             // now exec - we should not return from this
-            if (strcmp(argv[0], "valgrind") == 0) {
-                execvp(argv[0], &argv[0]);
-            } else {
-                execv(argv[0], &argv[0]);
-            }
+            execve(execFile, &argv[0], &envp[0]);
 
-            RH_ERROR(__logger, new_argv[0] << " did not execute : " << strerror(errno));
-            exit(-1);
+            int execError = errno;
+            write(statusPipe[1], &execError, sizeof(execError));
+            _exit(-1);
         }
         else {
             // The system cannot support deployment of the device
@@ -352,7 +420,11 @@ void DeviceManager_impl::createDeviceThread(
             // threads, in which case the system is in bad shape.  Exit
             // with an error to allow the system to recover.
             LOG_ERROR(DeviceManager_impl, "[DeviceManager::execute] Cannot create device thread: " << strerror(errno)); 
-            throw;
+            close(releasePipe[0]);
+            close(releasePipe[1]);
+            close(statusPipe[0]);
+            close(statusPipe[1]);
+            throw std::runtime_error("unable to fork device process");
         }
     }
 }
@@ -376,7 +448,6 @@ void DeviceManager_impl::createDeviceExecStatement(
     // DO not put any LOG calls in this method, as it is called beteen
     // fork() and execv().
     std::string logcfg_path("");
-    deviceMgrIOR = ossie::corba::objectToString(myObj);
     if (getenv("VALGRIND")) {
         const char* valgrind = getenv("VALGRIND");
         if (strlen(valgrind) > 0) {
@@ -534,7 +605,6 @@ DeviceManager_impl::ExecparamList DeviceManager_impl::createDeviceExecparams(
     // fork() and execv().
     ExecparamList execparams;
     std::string logcfg_path("");
-    deviceMgrIOR = ossie::corba::objectToString(myObj);
     if (componentType == "device") {
         execparams.push_back(std::make_pair("PROFILE_NAME", compProfile->getSpdFileName()));
         execparams.push_back(std::make_pair("DEVICE_ID", instantiation.getID()));
@@ -720,7 +790,7 @@ void DeviceManager_impl::setEnvironment( ProcessEnvironment &env,
             // it is not a loaded package
         } else {
             LOG_TRACE(DeviceManager_impl, "adding to Mod List dep: " << dep );
-            mod_list.push_back(sharedPkgs[dep]);
+            mod_list.push_back(pkgMods.find(dep)->second);
         }
     }
 
@@ -918,11 +988,13 @@ void DeviceManager_impl::do_load ( CF::FileSystem_ptr fs,
                     }
                 }
                 relativePath.assign(relativeFileName, 0, lastSlash);
-                // change parent directory and try to import module
-                if (chdir(relativePath.c_str())) {
+                // try to import module from its parent directory; the import runs in a
+                // subshell so that the working directory of the DeviceManager, which may
+                // be launching other devices concurrently, is unaffected
+                if (access(relativePath.c_str(), X_OK)) {
                     // this is an invalid path
                 } else {
-                    std::string command = "python -c \"import ";
+                    std::string command = "cd \"" + relativePath + "\" && python -c \"import ";
                     command += fileOrDirectoryName;
                     command += std::string("\" 2>&1"); // redirect stdout and stderr to /dev/null
                     LOG_DEBUG(DeviceManager_impl, "cmd= " << command << 
@@ -938,8 +1010,6 @@ void DeviceManager_impl::do_load ( CF::FileSystem_ptr fs,
                 }
             }
 
-            chdir(currentPath.c_str());
-
         }
 
         // Check to see if it's a Java package
@@ -959,6 +1029,7 @@ void DeviceManager_impl::do_load ( CF::FileSystem_ptr fs,
             env_changes.addJavaPath(additionalPath);
             env_changes.addOctavePath(additionalPath);
         }
+        boost::mutex::scoped_lock lock(sharedPkgsmutex);
         sharedPkgs[env_changes.pkgId] = env_changes;
     }
 }
@@ -23,8 +23,14 @@
 #include <sys/wait.h>
 #include <sys/stat.h>
 #include <sys/utsname.h>
+#include <algorithm>
 #include <boost/filesystem.hpp>
 #include <boost/algorithm/string.hpp>
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
 
 #include <ossie/debug.h>
 #include <ossie/ossieSupport.h>
@@ -44,6 +50,115 @@ namespace fs = boost::filesystem;
 
 using namespace ossie;
 
+namespace {
+
+    typedef std::vector< boost::function<void ()> > TaskList;
+
+    // Runs a list of tasks on up to maxThreads threads, starting them in list
+    // order. Once a task fails no further tasks are started, and the failure
+    // is rethrown after the running tasks have finished: CORBA system
+    // exceptions as themselves, anything else as std::runtime_error, which
+    // are the exceptions postConstructor is allowed to throw.
+    class TaskRunner {
+    public:
+        TaskRunner(const TaskList& tasks) :
+            _tasks(tasks),
+            _next(0)
+        {
+        }
+
+        void run(size_t maxThreads)
+        {
+            boost::thread_group threads;
+            size_t count = std::min(std::max(maxThreads, size_t(1)), _tasks.size());
+            for (size_t ii = 0; ii < count; ++ii) {
+                threads.create_thread(boost::bind(&TaskRunner::execute, this));
+            }
+            threads.join_all();
+
+            if (_systemError) {
+                _systemError->_raise();
+            }
+            if (!_error.empty()) {
+                throw std::runtime_error(_error);
+            }
+        }
+
+    private:
+        void execute()
+        {
+            while (true) {
+                size_t index;
+                {
+                    boost::mutex::scoped_lock lock(_lock);
+                    if (!_error.empty() || (_next >= _tasks.size())) {
+                        return;
+                    }
+                    index = _next++;
+                }
+
+                std::string error;
+                try {
+                    _tasks[index]();
+                } catch (const CORBA::SystemException& ex) {
+                    boost::mutex::scoped_lock lock(_lock);
+                    if (_error.empty()) {
+                        _error = std::string("Device launch failed: CORBA::") + ex._name();
+                        _systemError.reset(ex._NP_duplicate());
+                    }
+                    continue;
+                } catch (const std::exception& ex) {
+                    error = ex.what();
+                } catch (const CORBA::Exception& ex) {
+                    error = std::string("CORBA::") + ex._name();
+                } catch (...) {
+                    error = "unknown exception";
+                }
+                if (!error.empty()) {
+                    boost::mutex::scoped_lock lock(_lock);
+                    if (_error.empty()) {
+                        _error = "Device launch failed: " + error;
+                    }
+                }
+            }
+        }
+
+        const TaskList& _tasks;
+        size_t _next;
+        std::string _error;
+        boost::scoped_ptr<CORBA::Exception> _systemError;
+        boost::mutex _lock;
+    };
+
+    static void runTasks(const TaskList& tasks, size_t maxThreads)
+    {
+        TaskRunner runner(tasks);
+        runner.run(maxThreads);
+    }
+
+    // Position of a placement in the launch list: composite parents come
+    // before their children, otherwise DCD order is kept
+    struct LaunchOrder {
+        LaunchOrder(size_t depth, size_t index) :
+            depth(depth),
+            index(index)
+        {
+        }
+
+        bool operator<(const LaunchOrder& other) const
+        {
+            if (depth != other.depth) {
+                return depth < other.depth;
+            }
+            return index < other.index;
+        }
+
+        size_t depth;
+        size_t index;
+    };
+
+}
+
 rh_logger::LoggerPtr DeviceManager_impl::__logger;
 
 DeviceManager_impl::DeviceManager_impl(
@@ -144,6 +259,15 @@ DeviceManager_impl::DeviceManager_impl(
                "millisec",
                "external",
                "property");
+
+    addProperty(DEVICE_LAUNCH_CONCURRENCY,
+                4,
+               "DEVICE_LAUNCH_CONCURRENCY",
+               "DEVICE_LAUNCH_CONCURRENCY",
+               "readwrite",
+               "",
+               "external",
+               "property");
  
     // translate cpuBlackList to cpu ids 
     try {
@@ -396,7 +520,7 @@ void DeviceManager_impl::recordComponentInstantiationId(
         const ComponentInstantiation& instantiation,
         const std::string &impl_id ) {
 
-    boost::mutex::scoped_try_lock lock(componentImplMapmutex);
+    boost::mutex::scoped_lock lock(componentImplMapmutex);
     _componentImplMap[instantiation.getID()] = impl_id;
 }
 
@@ -582,7 +706,8 @@ void DeviceManager_impl::getCompositeDeviceIOR(
                     LOG_TRACE(DeviceManager_impl, "CompositePartOfDevice: Found parent device instance <" 
                             << componentPlacements[cp_idx].getInstantiations()[ci_idx].getID() 
                             << "> for child device <" << componentPlacementInst.getFileRefId() << ">");
-                    // now get the associated IOR
+                    // now get the associated IOR, waiting for the parent to register
+                    boost::recursive_mutex::scoped_lock lock(registeredDevicesmutex);
                     while (true) {
                         std::string tmpior = getIORfromID(instanceID);
                         if (!tmpior.empty()) {
@@ -590,7 +715,7 @@ void DeviceManager_impl::getCompositeDeviceIOR(
                             LOG_TRACE(DeviceManager_impl, "CompositePartOfDevice: Found parent device IOR <" << compositeDeviceIOR << ">");
                             break;
                         }
-                        usleep(100);
+                        launchStateChanged.wait(lock);
                     }
                 }
 
@@ -688,6 +813,7 @@ void DeviceManager_impl::postConstructor (
     fs_servant->_remove_ref();
     _fileSys = fs_servant->_this();
     fileSysIOR = ossie::corba::objectToString(_fileSys);
+    deviceMgrIOR = ossie::corba::objectToString(myObj);
 
     // create filesystem for local dom root.. used for softpkgs
     FileSystem_impl *local_dom_fs = new FileSystem_impl(_local_domroot.c_str());
@@ -766,103 +892,215 @@ void DeviceManager_impl::postConstructor (
     ////////////////////////////////////////////////////////////////////////////
     // Split component placements by compositePartOf tag
     //      The following logic exists below:
-    //      - Split non-deployOnDevice from deployOnDevice compPlacements
-    //      - Iterate and launch all non-deployOnDevice compPlacements
-    //      - Iterate and launch all deployOnDevice compPlacements
+    //      - Resolve the profiles of all compPlacements concurrently, and split
+    //        non-deployOnDevice from deployOnDevice compPlacements
+    //      - Launch all non-deployOnDevice compPlacements concurrently, starting
+    //        them in DCD order, with composite parents ahead of their children
+    //      - Launch all deployOnDevice compPlacements concurrently, with each
+    //        parent device's compPlacements launched in DCD order
+    boost::posix_time::ptime phaseStart = boost::posix_time::microsec_clock::local_time();
     DeploymentList standaloneComponentPlacements;
     DeploymentList  compositePartDeviceComponentPlacements;
-    ComponentPlacements::const_iterator constCompPlaceIter;
-    for (constCompPlaceIter =  componentPlacements.begin();
-         constCompPlaceIter != componentPlacements.end();
-         constCompPlaceIter++) {
-        
-         local_spd::ProgramProfile *newResource = 0;
-         const ComponentPlacement &componentPlacement = *constCompPlaceIter;
-         std::string compId(constCompPlaceIter->instantiations[0].getID());
-	 std::ostringstream emsg;
-         emsg << "Skipping instantiation of device " << compId;
-         try {
-             // load up device/service software profile
-             LOG_TRACE(DeviceManager_impl, "Getting file name for refid " << componentPlacement.getFileRefId());
-             const char* spdFile = node_dcd.getFileNameFromRefId(componentPlacement.getFileRefId());
-             newResource = local_spd::ProgramProfile::LoadProfile( _fileSys, spdFile, _local_dom_filesys );             
-
-             // check if we have matching implementation
-             if ( !resolveImplementation( newResource ) )  {
-	       std::ostringstream eout;
-	       eout  << "Device '" << compId  << "' - '" << newResource->getID() << "; "
-		     << "No available device implementations match device manager " << devmgr_info->getID();
-	       throw std::runtime_error(eout.str().c_str());
-             }
-
-             local_spd::ImplementationInfo *matchingImpl = newResource->selectedImplementation();        
-             // resolve soft package dependenices for matching implementation
-             if ( !resolveSoftpkgDependencies(matchingImpl) ) {
-	       std::ostringstream eout;
-	       eout  << "Device '" << compId  << "' - '" << newResource->getID() << "; "
-		     << "No available softpkg dependenices match device manager implementation" << devmgr_info->getID();
-	       throw std::runtime_error(eout.str().c_str());
-             }
-
-             bool isSharedLibrary = (matchingImpl->getCodeType() == CF::LoadableDevice::SHARED_LIBRARY);
-	     bool isCompositePartOf = constCompPlaceIter->isCompositePartOf();
-             Deployment d( (*constCompPlaceIter), newResource );
-
-	     if (isCompositePartOf && isSharedLibrary) {
-                 compositePartDeviceComponentPlacements.push_back( d );
-	     } else {
-                 standaloneComponentPlacements.push_back( d );
-	     }
-
-         }
-         catch ( std::runtime_error &ex ) {
-             LOG_ERROR(DeviceManager_impl, ex.what() );
-             LOG_ERROR(DeviceManager_impl, emsg.str() );
-            if (newResource) delete newResource;
-            continue;
-         }
-         catch ( ... ) {
-             LOG_ERROR(DeviceManager_impl, emsg.str() );
-             if (newResource) delete newResource;
-             continue;
-         }
-    }
+    resolveDeployments(componentPlacements, standaloneComponentPlacements, compositePartDeviceComponentPlacements);
+    const boost::posix_time::time_duration resolveTime = boost::posix_time::microsec_clock::local_time() - phaseStart;
+
+    // Restore any environment changes once all of the devices and services
+    // have been launched
+    ProcessEnvironment restoreState;
 
     ////////////////////////////////////////////////////////////////////////////
     // Iterate and launch all non-deployOnDevice compPlacements
+    phaseStart = boost::posix_time::microsec_clock::local_time();
+    DeploymentList orderedComponentPlacements;
+    orderForLaunch(standaloneComponentPlacements, orderedComponentPlacements);
+    TaskList launches;
     DeploymentList::const_iterator cIter;
-    for (cIter =  standaloneComponentPlacements.begin();
-         cIter != standaloneComponentPlacements.end();
+    for (cIter =  orderedComponentPlacements.begin();
+         cIter != orderedComponentPlacements.end();
          cIter++) {
-      
-      const ComponentPlacement &compPlacement = cIter->first;
-      local_spd::ProgramProfile *compProfile = cIter->second;
-      const local_spd::ImplementationInfo *matchingImpl = compProfile->getSelectedImplementation();
-      std::string compId(compPlacement.instantiations[0].getID());
-      LOG_INFO(DeviceManager_impl, "Placing Component CompId: " << compId << " ProfileName : " << compProfile->getName() );
+        launches.push_back(boost::bind(&DeviceManager_impl::launchStandaloneDeployment, this,
+                                       boost::cref(*cIter), boost::cref(componentPlacements), fs_servant));
+    }
+    runTasks(launches, DEVICE_LAUNCH_CONCURRENCY);
+    const boost::posix_time::time_duration launchTime = boost::posix_time::microsec_clock::local_time() - phaseStart;
 
-      // should not happen
-      if (!matchingImpl) continue;
+    ////////////////////////////////////////////////////////////////////////////
+    // Iterate and launch all deployOnDevice compPlacements, grouped by their
+    // parent device
+    phaseStart = boost::posix_time::microsec_clock::local_time();
+    std::vector<std::string> parentIds;
+    std::map<std::string, DeploymentList> compositeParts;
+    for (cIter =  compositePartDeviceComponentPlacements.begin();
+         cIter != compositePartDeviceComponentPlacements.end();
+         cIter++) {
+        const std::string parentId = cIter->first.getCompositePartOfDeviceID();
+        if (compositeParts.find(parentId) == compositeParts.end()) {
+            parentIds.push_back(parentId);
+        }
+        compositeParts[parentId].push_back(*cIter);
+    }
+    launches.clear();
+    for (std::vector<std::string>::const_iterator parentId = parentIds.begin(); parentId != parentIds.end(); ++parentId) {
+        launches.push_back(boost::bind(&DeviceManager_impl::launchCompositePartDeployments, this,
+                                       boost::cref(compositeParts[*parentId]), boost::cref(standaloneComponentPlacements),
+                                       boost::cref(componentPlacements), fs_servant));
+    }
+    runTasks(launches, DEVICE_LAUNCH_CONCURRENCY);
+    const boost::posix_time::time_duration compositeTime = boost::posix_time::microsec_clock::local_time() - phaseStart;
+
+    LOG_INFO(DeviceManager_impl, "Startup timing: resolved " << componentPlacements.size() << " profiles in "
+             << resolveTime.total_milliseconds() << " ms, launched " << standaloneComponentPlacements.size()
+             << " devices/services in " << launchTime.total_milliseconds() << " ms, launched "
+             << compositePartDeviceComponentPlacements.size() << " composite parts in "
+             << compositeTime.total_milliseconds() << " ms");
+}
 
-      ossie::Properties deviceProperties;
-      if (!addDeviceImplProperties( compProfile, *matchingImpl )) {
-	LOG_INFO(DeviceManager_impl, "Skipping instantiation of device '" << compProfile->getInstantiationIdentifier() << 
-		 ", failed to merge properties ");
-	continue;
-      }
 
-      std::string compositeDeviceIOR;
-      getCompositeDeviceIOR(compositeDeviceIOR, 
-			    componentPlacements, 
-			    compPlacement);
+void DeviceManager_impl::resolveDeployments(
+        const ComponentPlacements& componentPlacements,
+        DeploymentList&            standaloneComponentPlacements,
+        DeploymentList&            compositePartDeviceComponentPlacements)
+{
+    // Load the profiles concurrently, keeping the results in DCD order
+    std::vector<local_spd::ProgramProfile*> profiles(componentPlacements.size(), 0);
+    TaskList resolves;
+    for (size_t index = 0; index < componentPlacements.size(); ++index) {
+        resolves.push_back(boost::bind(&DeviceManager_impl::resolveDeployment, this,
+                                       boost::cref(componentPlacements[index]), boost::ref(profiles[index])));
+    }
+    runTasks(resolves, DEVICE_LAUNCH_CONCURRENCY);
+
+    for (size_t index = 0; index < componentPlacements.size(); ++index) {
+        local_spd::ProgramProfile *newResource = profiles[index];
+        if (!newResource) {
+            continue;
+        }
+        const local_spd::ImplementationInfo *matchingImpl = newResource->getSelectedImplementation();
+        bool isSharedLibrary = (matchingImpl->getCodeType() == CF::LoadableDevice::SHARED_LIBRARY);
+        bool isCompositePartOf = componentPlacements[index].isCompositePartOf();
+        Deployment d( componentPlacements[index], newResource );
 
-      std::vector<ComponentInstantiation>::const_iterator cpInstIter;
-      for (cpInstIter =  compPlacement.getInstantiations().begin(); 
-	   cpInstIter != compPlacement.getInstantiations().end(); 
-	   cpInstIter++) {
+        if (isCompositePartOf && isSharedLibrary) {
+            compositePartDeviceComponentPlacements.push_back( d );
+        } else {
+            standaloneComponentPlacements.push_back( d );
+        }
+    }
+}
+
+
+void DeviceManager_impl::resolveDeployment(
+        const ComponentPlacement&   componentPlacement,
+        local_spd::ProgramProfile*& newResource)
+{
+    std::string compId(componentPlacement.instantiations[0].getID());
+    std::ostringstream emsg;
+    emsg << "Skipping instantiation of device " << compId;
+    try {
+        // load up device/service software profile
+        LOG_TRACE(DeviceManager_impl, "Getting file name for refid " << componentPlacement.getFileRefId());
+        const char* spdFile = node_dcd.getFileNameFromRefId(componentPlacement.getFileRefId());
+        newResource = local_spd::ProgramProfile::LoadProfile( _fileSys, spdFile, _local_dom_filesys );
+
+        // check if we have matching implementation
+        if ( !resolveImplementation( newResource ) )  {
+            std::ostringstream eout;
+            eout  << "Device '" << compId  << "' - '" << newResource->getID() << "; "
+                  << "No available device implementations match device manager " << devmgr_info->getID();
+            throw std::runtime_error(eout.str().c_str());
+        }
+
+        local_spd::ImplementationInfo *matchingImpl = newResource->selectedImplementation();
+        // resolve soft package dependenices for matching implementation
+        if ( !resolveSoftpkgDependencies(matchingImpl) ) {
+            std::ostringstream eout;
+            eout  << "Device '" << compId  << "' - '" << newResource->getID() << "; "
+                  << "No available softpkg dependenices match device manager implementation" << devmgr_info->getID();
+            throw std::runtime_error(eout.str().c_str());
+        }
+    }
+    catch ( std::runtime_error &ex ) {
+        LOG_ERROR(DeviceManager_impl, ex.what() );
+        LOG_ERROR(DeviceManager_impl, emsg.str() );
+        if (newResource) delete newResource;
+        newResource = 0;
+    }
+    catch ( ... ) {
+        LOG_ERROR(DeviceManager_impl, emsg.str() );
+        if (newResource) delete newResource;
+        newResource = 0;
+    }
+}
+
+
+void DeviceManager_impl::orderForLaunch(
+        const DeploymentList& deployments,
+        DeploymentList&       ordered)
+{
+    // Instantiation identifiers of the deployments, to find composite parents
+    std::map<std::string, size_t> indices;
+    for (size_t index = 0; index < deployments.size(); ++index) {
+        indices[deployments[index].first.getInstantiations()[0].getID()] = index;
+    }
+
+    // A compositePartOf child waits on its parent's registration while it
+    // holds a launch thread; starting every parent before its children means
+    // those waits can never use up the threads the parents need
+    std::vector<LaunchOrder> order;
+    for (size_t index = 0; index < deployments.size(); ++index) {
+        LaunchOrder launch(0, index);
+        const ComponentPlacement* placement = &deployments[index].first;
+        while (placement->isCompositePartOf() && (launch.depth < deployments.size())) {
+            std::map<std::string, size_t>::const_iterator parent = indices.find(placement->getCompositePartOfDeviceID());
+            if (parent == indices.end()) {
+                break;
+            }
+            placement = &deployments[parent->second].first;
+            ++launch.depth;
+        }
+        order.push_back(launch);
+    }
+    std::sort(order.begin(), order.end());
+
+    for (std::vector<LaunchOrder>::const_iterator launch = order.begin(); launch != order.end(); ++launch) {
+        ordered.push_back(deployments[launch->index]);
+    }
+}
+
+
+void DeviceManager_impl::launchStandaloneDeployment(
+        const Deployment&          deployment,
+        const ComponentPlacements& componentPlacements,
+        FileSystem_impl*           fs_servant)
+{
+    const ComponentPlacement &compPlacement = deployment.first;
+    local_spd::ProgramProfile *compProfile = deployment.second;
+    const local_spd::ImplementationInfo *matchingImpl = compProfile->getSelectedImplementation();
+    std::string compId(compPlacement.instantiations[0].getID());
+    LOG_INFO(DeviceManager_impl, "Placing Component CompId: " << compId << " ProfileName : " << compProfile->getName() );
+
+    // should not happen
+    if (!matchingImpl) return;
+
+    ossie::Properties deviceProperties;
+    if (!addDeviceImplProperties( compProfile, *matchingImpl )) {
+        LOG_INFO(DeviceManager_impl, "Skipping instantiation of device '" << compProfile->getInstantiationIdentifier() << 
+                 ", failed to merge properties ");
+        return;
+    }
+
+    std::string compositeDeviceIOR;
+    getCompositeDeviceIOR(compositeDeviceIOR, 
+                          componentPlacements, 
+                          compPlacement);
+
+    std::vector<ComponentInstantiation>::const_iterator cpInstIter;
+    for (cpInstIter =  compPlacement.getInstantiations().begin(); 
+         cpInstIter != compPlacement.getInstantiations().end(); 
+         cpInstIter++) {
 
-	const ComponentInstantiation instantiation = *cpInstIter;
-	LOG_TRACE(DeviceManager_impl, "Placing component id: " << instantiation.getID());
+        const ComponentInstantiation instantiation = *cpInstIter;
+        LOG_TRACE(DeviceManager_impl, "Placing component id: " << instantiation.getID());
 
         // setup profile with instantiation context
         recordComponentInstantiationId(instantiation, matchingImpl->getId());
@@ -874,43 +1112,50 @@ void DeviceManager_impl::postConstructor (
         compProfile->setAffinity( instantiation.getAffinity() );
         compProfile->setLoggingConfig( instantiation.getLoggingConfig() );
 
-	//spawn device
-	std::string codeFilePath;
-	if (!getCodeFilePath(codeFilePath,
-			     *matchingImpl,
-			     compProfile->spd,
-			     fs_servant)) {
-	  continue;
-	}
-
-	std::string componentType;
-	if (!getDeviceOrService(componentType, compProfile )) {
-	  // We got a type other than "device" or "service"
-	  continue;
-	}
-
-	// add to list of deployed resources
+        //spawn device
+        std::string codeFilePath;
+        if (!getCodeFilePath(codeFilePath,
+                             *matchingImpl,
+                             compProfile->spd,
+                             fs_servant)) {
+            continue;
+        }
+
+        std::string componentType;
+        if (!getDeviceOrService(componentType, compProfile )) {
+            // We got a type other than "device" or "service"
+            continue;
+        }
+
+        // add to list of deployed resources
         {
             SCOPED_LOCK(componentImplMapmutex);
-            deployed_comps.push_back( *cIter );
-	}
+            deployed_comps.push_back( deployment );
+        }
         // Attempt to create the requested device or service
         createDeviceThreadAndHandleExceptions(compPlacement,
-					      compProfile,
-					      componentType,
-					      codeFilePath,
-					      instantiation,
-					      compositeDeviceIOR );
-      }
+                                              compProfile,
+                                              componentType,
+                                              codeFilePath,
+                                              instantiation,
+                                              compositeDeviceIOR );
     }
+}
 
-    ////////////////////////////////////////////////////////////////////////////
-    // Iterate and launch all deployOnDevice compPlacements
+
+void DeviceManager_impl::launchCompositePartDeployments(
+        const DeploymentList&      compositeParts,
+        const DeploymentList&      standaloneComponentPlacements,
+        const ComponentPlacements& componentPlacements,
+        FileSystem_impl*           fs_servant)
+{
+    // All of the compPlacements share the same parent device, which loads
+    // them one at a time in DCD order
+    DeploymentList::const_iterator cIter;
     DeploymentList::const_iterator compPlaceIter;
-    for (compPlaceIter =  compositePartDeviceComponentPlacements.begin();
-         compPlaceIter != compositePartDeviceComponentPlacements.end();
+    for (compPlaceIter =  compositeParts.begin();
+         compPlaceIter != compositeParts.end();
          compPlaceIter++) {
-
       const ComponentPlacement &compPlacement = compPlaceIter->first;
       local_spd::ProgramProfile *compProfile = compPlaceIter->second;
       std::string compId("UT OHHH");
@@ -2306,6 +2551,7 @@ void DeviceManager_impl::increment_registeredServices(CORBA::Object_ptr register
     serviceNode->service = CORBA::Object::_duplicate(registeringService);
 
     _registeredServices.push_back(serviceNode);
+    launchStateChanged.notify_all();
 }
 
 /*
@@ -2345,6 +2591,7 @@ void DeviceManager_impl::increment_registeredDevices(CF::Device_ptr registeringD
     deviceNode->device = CF::Device::_duplicate(registeringDevice);
 
     _registeredDevices.push_back(deviceNode);
+    launchStateChanged.notify_all();
 }
 
 /*
@@ -2418,10 +2665,13 @@ void DeviceManager_impl::clean_externalServices(){
 void DeviceManager_impl::clean_registeredServices(){
 
     boost::recursive_mutex::scoped_lock lock(registeredDevicesmutex);
-    std::vector<unsigned int> pids;
+    std::vector<pid_t> pids;
 
+    // Only wait on services that were launched by this device manager
     for (ServiceList::iterator serviceIter = _registeredServices.begin(); serviceIter != _registeredServices.end(); ++serviceIter) {
-        pids.push_back((*serviceIter)->pid);
+        if ((*serviceIter)->pid != 0) {
+            pids.push_back((*serviceIter)->pid);
+        }
     }
     for (ServiceList::iterator serviceIter = _pendingServices.begin(); serviceIter != _pendingServices.end(); ++serviceIter) {
         pids.push_back((*serviceIter)->pid);
@@ -2448,33 +2698,11 @@ void DeviceManager_impl::clean_registeredServices(){
 
     lock.unlock();
 
-    // Release the lock and allow time for the devices to exit.
+    // Release the lock and allow time for the services to exit, waking up as
+    // soon as the last one does
     if (pids.size() != 0) {
-        struct timeval tmp_time;
-        struct timezone tmp_tz;
-        gettimeofday(&tmp_time, &tmp_tz);
-        double wsec_begin = tmp_time.tv_sec;
-        double fsec_begin = tmp_time.tv_usec / 1e6;
-        double wsec_end = wsec_begin;
-        double fsec_end = fsec_begin;
-        double time_diff = (wsec_end + fsec_end)-(wsec_begin + fsec_begin);
-        bool registered_pending_pid_gone = false;
-        while ((time_diff < 0.5) and (not registered_pending_pid_gone)) {
-            registered_pending_pid_gone = true;
-            for (std::vector<unsigned int>::iterator p_pid = pids.begin(); p_pid != pids.end(); ++p_pid) {
-                if (kill(*p_pid, 0) != -1) {
-                    registered_pending_pid_gone = false;
-                    break;
-                }
-            }
-            if (not registered_pending_pid_gone) {
-                gettimeofday(&tmp_time, &tmp_tz);
-                wsec_end = tmp_time.tv_sec;
-                fsec_end = tmp_time.tv_usec / 1e6;
-                time_diff = (wsec_end + fsec_end)-(wsec_begin + fsec_begin);
-                usleep(1000);
-            }
-        }
+        size_t running = ossie::helpers::wait_for_exit(pids, 0.5);
+        LOG_DEBUG(DeviceManager_impl, running << " of " << pids.size() << " service(s) still running after SIGTERM");
     }
     lock.lock();
 
@@ -2559,6 +2787,7 @@ DeviceManager_impl::DeviceNode* DeviceManager_impl::getDeviceNode(const pid_t pi
             if (_pendingDevices.empty()) {
                 pendingDevicesEmpty.notify_all();
             }
+            launchStateChanged.notify_all();
             return deviceNode;
         }
     }
@@ -2591,6 +2820,7 @@ void DeviceManager_impl::childExited (pid_t pid, int status)
             if ((*serviceIter)->pid == pid){
                 serviceNode = (*serviceIter);
                 _pendingServices.erase(serviceIter);
+                launchStateChanged.notify_all();
                 break;
             }
         }
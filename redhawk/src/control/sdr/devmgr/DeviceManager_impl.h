@@ -154,6 +154,7 @@ private:
     std::string     HOSTNAME;
     float           DEVICE_FORCE_QUIT_TIME;
     CORBA::ULong    CLIENT_WAIT_TIME;
+    CORBA::ULong    DEVICE_LAUNCH_CONCURRENCY;
 
     // read only attributes
     struct utsname _uname;
@@ -215,6 +216,30 @@ private:
         const std::vector<ossie::ComponentPlacement>& componentPlacements,
         const ossie::ComponentPlacement&              componentPlacementInst);
 
+    void resolveDeployments(
+        const ComponentPlacements&                    componentPlacements,
+        DeploymentList&                               standaloneComponentPlacements,
+        DeploymentList&                               compositePartDeviceComponentPlacements);
+
+    void resolveDeployment(
+        const ossie::ComponentPlacement&              componentPlacement,
+        local_spd::ProgramProfile*&                   newResource);
+
+    void orderForLaunch(
+        const DeploymentList&                         deployments,
+        DeploymentList&                               ordered);
+
+    void launchStandaloneDeployment(
+        const Deployment&                             deployment,
+        const ComponentPlacements&                    componentPlacements,
+        FileSystem_impl*                              fs_servant);
+
+    void launchCompositePartDeployments(
+        const DeploymentList&                         compositeParts,
+        const DeploymentList&                         standaloneComponentPlacements,
+        const ComponentPlacements&                    componentPlacements,
+        FileSystem_impl*                              fs_servant);
+
     bool addDeviceImplProperties (
         local_spd::ProgramProfile *compProfile,
         const local_spd::ImplementationInfo& deviceImpl );
@@ -309,6 +334,8 @@ private:
     // this mutex is used for synchronizing _registeredDevices, _pendingDevices, and _registeredServices
     boost::recursive_mutex registeredDevicesmutex;  
     boost::condition_variable_any pendingDevicesEmpty;
+    // signaled when a launched device or service registers or exits
+    boost::condition_variable_any launchStateChanged;
     void increment_registeredDevices(CF::Device_ptr registeringDevice);
     void increment_registeredServices(CORBA::Object_ptr registeringService, 
                                       const char* name);
@@ -344,6 +371,7 @@ private:
     std::map<std::string, std::string> _componentImplMap;
     DeploymentList                     deployed_comps;
     PackageMods                        sharedPkgs;
+    boost::mutex                       sharedPkgsmutex;
 
     
     // DeviceManager context... 
@@ -104,6 +104,65 @@ static void rotateDeviceList(DeviceList& devices, const std::string& identifier)
     }
 }
 
+// Relative cost of carrying one unit of connection bandwidth between two
+// connected components. Devices that share a DeviceManager are on the same
+// host, and anything else is assumed to cross the network. On the same
+// device, components bound to different processor sockets or NICs (which the
+// GPP resolves to sockets, see affinity.cpp) cross the socket interconnect.
+static const double PLACEMENT_COST_SAME_DEVICE  = 0.0;
+static const double PLACEMENT_COST_CROSS_SOCKET = 0.5;
+static const double PLACEMENT_COST_SAME_NODE    = 1.0;
+static const double PLACEMENT_COST_REMOTE       = 10.0;
+
+static double getDevicePlacementDistance(const DeviceNode& lhs, const DeviceNode& rhs)
+{
+    if (lhs.identifier == rhs.identifier) {
+        return PLACEMENT_COST_SAME_DEVICE;
+    } else if (lhs.devMgr.identifier == rhs.devMgr.identifier) {
+        return PLACEMENT_COST_SAME_NODE;
+    }
+    return PLACEMENT_COST_REMOTE;
+}
+
+// Returns the processor socket or NIC a component is bound to, as
+// "socket:<value>" or "nic:<value>", or an empty string if it is not bound
+static std::string getSocketLocality(ossie::ComponentInfo* component)
+{
+    const CF::Properties affinity = component->getAffinityOptionsWithAssignment();
+    const redhawk::PropertyMap& affinitymap = redhawk::PropertyMap::cast(affinity);
+    if (affinitymap.contains("socket")) {
+        return "socket:" + affinitymap["socket"].toString();
+    } else if (affinitymap.contains("affinity::exec_directive_class") &&
+               (affinitymap["affinity::exec_directive_class"].toString() == "socket") &&
+               affinitymap.contains("affinity::exec_directive_value")) {
+        return "socket:" + affinitymap["affinity::exec_directive_value"].toString();
+    } else if (affinitymap.contains("nic")) {
+        return "nic:" + affinitymap["nic"].toString();
+    }
+    return std::string();
+}
+
+static double getComponentPlacementDistance(ossie::ComponentInfo* component, const DeviceNode& device,
+                                            ossie::ComponentInfo* peer, const DeviceNode& peerDevice)
+{
+    const double distance = getDevicePlacementDistance(device, peerDevice);
+    if (distance != PLACEMENT_COST_SAME_DEVICE) {
+        return distance;
+    }
+    const std::string locality = getSocketLocality(component);
+    const std::string peer_locality = getSocketLocality(peer);
+    if (!locality.empty() && !peer_locality.empty() && (locality != peer_locality)) {
+        return PLACEMENT_COST_CROSS_SOCKET;
+    }
+    return PLACEMENT_COST_SAME_DEVICE;
+}
+
+static bool comparePlacementCost(const std::pair<double,boost::shared_ptr<DeviceNode> >& lhs,
+                                 const std::pair<double,boost::shared_ptr<DeviceNode> >& rhs)
+{
+    return lhs.first < rhs.first;
+}
+
 static std::vector<std::string> mergeProcessorDeps(const ossie::ImplementationInfo::List& implementations)
 {
     // this function merges the overlap in processors between the different components that have been selected
@@ -742,9 +801,14 @@ void createHelper::_configureComponents()
 
 void createHelper::assignRemainingComponentsToDevices(const std::string &appIdentifier)
 {
+    PlacementList components = _requiredComponents;
+    if (_topologyAware) {
+        _orderComponentsByConnectivity(components);
+    }
+
     PlacementList::iterator componentIter;
-    for (componentIter  = _requiredComponents.begin(); 
-         componentIter != _requiredComponents.end(); 
+    for (componentIter  = components.begin(); 
+         componentIter != components.end(); 
          componentIter++)
     {
         if (!(*componentIter)->isAssignedToDevice()) {
@@ -753,6 +817,260 @@ void createHelper::assignRemainingComponentsToDevices(const std::string &appIden
     }
 }
 
+/* Build a weighted, undirected graph of the connections between the
+ * application's components. The weight of each connection is the bandwidth
+ * hint of the component on the uses side of the connection.
+ */
+void createHelper::_buildConnectionGraph()
+{
+    _connectionGraph.clear();
+    const std::vector<Connection>& connections = _appFact._sadParser.getConnections();
+    for (std::vector<Connection>::const_iterator conn = connections.begin(); conn != connections.end(); ++conn) {
+        const UsesPort* uses = conn->getUsesPort();
+        const Port* provides = 0;
+        if (conn->isProvidesPort()) {
+            provides = conn->getProvidesPort();
+        } else if (conn->isComponentSupportedInterface()) {
+            provides = conn->getComponentSupportedInterface();
+        }
+        if (!provides || !uses->isComponentInstantiationRef() || !provides->isComponentInstantiationRef()) {
+            // Only connections between components in this application affect placement
+            continue;
+        }
+
+        const std::string usesId = uses->getComponentInstantiationRefID();
+        const std::string providesId = provides->getComponentInstantiationRefID();
+        if (usesId == providesId) {
+            continue;
+        }
+        ossie::ComponentInfo* source = findComponentByInstantiationId(usesId);
+        if (!source || !findComponentByInstantiationId(providesId)) {
+            continue;
+        }
+
+        const double weight = _getBandwidthHint(source);
+        _connectionGraph[usesId][providesId] += weight;
+        _connectionGraph[providesId][usesId] += weight;
+        LOG_TRACE(ApplicationFactory_impl, "Placement connection " << conn->getID() << " "
+                  << usesId << " -> " << providesId << " weight " << weight);
+    }
+}
+
+/* Returns the bandwidth hint for a component's output, taken from the
+ * "placement::bandwidth" property (PRF default or SAD override). Components
+ * without a hint weight each of their connections equally.
+ */
+double createHelper::_getBandwidthHint(ossie::ComponentInfo* component)
+{
+    static const std::string BANDWIDTH_HINT_ID("placement::bandwidth");
+    CF::Properties props = component->getConfigureProperties();
+    const CF::Properties& construct_props = component->getConstructProperties();
+    ossie::corba::extend(props, construct_props);
+    const redhawk::PropertyMap& propmap = redhawk::PropertyMap::cast(props);
+    redhawk::PropertyMap::const_iterator hint = propmap.find(BANDWIDTH_HINT_ID);
+    if (hint != propmap.end() && !hint->getValue().isNil()) {
+        try {
+            double bandwidth = hint->getValue().toDouble();
+            if (bandwidth > 0.0) {
+                return bandwidth;
+            }
+        } catch (...) {
+            LOG_WARN(ApplicationFactory_impl, "Ignoring invalid " << BANDWIDTH_HINT_ID << " for component "
+                     << component->getInstantiationIdentifier());
+        }
+    }
+    return 1.0;
+}
+
+/* Cost of placing a component on a device, given the placement of the
+ * components it is connected to
+ */
+double createHelper::_getPlacementCost(ossie::ComponentInfo* component, const ossie::DeviceNode& device)
+{
+    ConnectionGraph::const_iterator peers = _connectionGraph.find(component->getInstantiationIdentifier());
+    if (peers == _connectionGraph.end()) {
+        return 0.0;
+    }
+
+    double cost = 0.0;
+    for (ConnectionWeights::const_iterator peer = peers->second.begin(); peer != peers->second.end(); ++peer) {
+        ossie::ComponentInfo* peerComponent = findComponentByInstantiationId(peer->first);
+        if (!peerComponent || !peerComponent->isAssignedToDevice()) {
+            continue;
+        }
+        cost += peer->second * getComponentPlacementDistance(component, device, peerComponent, *(peerComponent->getAssignedDevice()));
+    }
+    return cost;
+}
+
+/* Reorders candidate devices from lowest to highest placement cost; devices
+ * with equal cost keep their existing order
+ */
+void createHelper::_orderDevicesByPlacementCost(ossie::ComponentInfo* component, ossie::DeviceList& devices)
+{
+    std::vector<std::pair<double,boost::shared_ptr<DeviceNode> > > ranked;
+    for (DeviceList::iterator device = devices.begin(); device != devices.end(); ++device) {
+        ranked.push_back(std::make_pair(_getPlacementCost(component, **device), *device));
+    }
+    std::stable_sort(ranked.begin(), ranked.end(), comparePlacementCost);
+
+    devices.clear();
+    for (size_t index = 0; index < ranked.size(); ++index) {
+        LOG_TRACE(ApplicationFactory_impl, "Placement cost for component " << component->getInstantiationIdentifier()
+                  << " on device " << ranked[index].second->identifier << ": " << ranked[index].first);
+        devices.push_back(ranked[index].second);
+    }
+}
+
+/* Orders components so that each one is placed after the components it is
+ * most heavily connected to, starting from those that have already been
+ * assigned (DAS or host collocation)
+ */
+void createHelper::_orderComponentsByConnectivity(PlacementList& components)
+{
+    std::set<std::string> placed;
+    PlacementList pending;
+    PlacementList ordered;
+    for (PlacementList::iterator comp = components.begin(); comp != components.end(); ++comp) {
+        if ((*comp)->isAssignedToDevice()) {
+            placed.insert((*comp)->getInstantiationIdentifier());
+            ordered.push_back(*comp);
+        } else {
+            pending.push_back(*comp);
+        }
+    }
+
+    while (!pending.empty()) {
+        PlacementList::iterator best = pending.begin();
+        double best_placed = -1.0;
+        double best_total = -1.0;
+        for (PlacementList::iterator comp = pending.begin(); comp != pending.end(); ++comp) {
+            double to_placed = 0.0;
+            double total = 0.0;
+            ConnectionGraph::const_iterator peers = _connectionGraph.find((*comp)->getInstantiationIdentifier());
+            if (peers != _connectionGraph.end()) {
+                for (ConnectionWeights::const_iterator peer = peers->second.begin(); peer != peers->second.end(); ++peer) {
+                    total += peer->second;
+                    if (placed.count(peer->first)) {
+                        to_placed += peer->second;
+                    }
+                }
+            }
+            if ((to_placed > best_placed) || ((to_placed == best_placed) && (total > best_total))) {
+                best = comp;
+                best_placed = to_placed;
+                best_total = total;
+            }
+        }
+        placed.insert((*best)->getInstantiationIdentifier());
+        ordered.push_back(*best);
+        pending.erase(best);
+    }
+
+    components = ordered;
+}
+
+/* For components that share a device with their most heavily connected peer,
+ * follow the peer's processor socket or NIC affinity so that their traffic
+ * stays on one socket; the GPP maps the socket or NIC to processors when it
+ * executes the component. Components with their own affinity are left alone.
+ */
+void createHelper::_alignConnectedAffinity()
+{
+    for (PlacementList::iterator comp = _requiredComponents.begin(); comp != _requiredComponents.end(); ++comp) {
+        ossie::ComponentInfo* component = *comp;
+        if (!component->isAssignedToDevice() || !getSocketLocality(component).empty()) {
+            continue;
+        }
+        ConnectionGraph::const_iterator peers = _connectionGraph.find(component->getInstantiationIdentifier());
+        if (peers == _connectionGraph.end()) {
+            continue;
+        }
+
+        ossie::ComponentInfo* target = 0;
+        double target_weight = 0.0;
+        for (ConnectionWeights::const_iterator peer = peers->second.begin(); peer != peers->second.end(); ++peer) {
+            ossie::ComponentInfo* peerComponent = findComponentByInstantiationId(peer->first);
+            if (!peerComponent || !peerComponent->isAssignedToDevice() || (peer->second <= target_weight)) {
+                continue;
+            }
+            if (peerComponent->getAssignedDevice()->identifier != component->getAssignedDevice()->identifier) {
+                continue;
+            }
+            if (getSocketLocality(peerComponent).empty()) {
+                continue;
+            }
+            target = peerComponent;
+            target_weight = peer->second;
+        }
+        if (!target) {
+            continue;
+        }
+
+        const CF::Properties peer_affinity = target->getAffinityOptionsWithAssignment();
+        const redhawk::PropertyMap& peermap = redhawk::PropertyMap::cast(peer_affinity);
+        redhawk::PropertyMap affinity;
+        if (peermap.contains("socket")) {
+            affinity["socket"] = peermap["socket"];
+        } else if (peermap.contains("affinity::exec_directive_class") &&
+                   (peermap["affinity::exec_directive_class"].toString() == "socket")) {
+            affinity["affinity::exec_directive_class"] = peermap["affinity::exec_directive_class"];
+            affinity["affinity::exec_directive_value"] = peermap["affinity::exec_directive_value"];
+        } else if (peermap.contains("nic")) {
+            affinity["nic"] = peermap["nic"];
+        }
+        LOG_DEBUG(ApplicationFactory_impl, "Component " << component->getInstantiationIdentifier()
+                  << " following socket affinity of connected component " << target->getInstantiationIdentifier());
+        component->mergeAffinityOptions(affinity);
+    }
+}
+
+/* Logs the cost of the final placement, broken down by how far each
+ * connection's traffic travels
+ */
+void createHelper::_reportPlacementCost(const std::string &appIdentifier)
+{
+    double total_cost = 0.0;
+    int local = 0;
+    int cross_socket = 0;
+    int cross_device = 0;
+    int remote = 0;
+    for (ConnectionGraph::const_iterator node = _connectionGraph.begin(); node != _connectionGraph.end(); ++node) {
+        ossie::ComponentInfo* component = findComponentByInstantiationId(node->first);
+        if (!component || !component->isAssignedToDevice()) {
+            continue;
+        }
+        for (ConnectionWeights::const_iterator peer = node->second.begin(); peer != node->second.end(); ++peer) {
+            // Each edge appears twice in the graph, count it once
+            if (peer->first < node->first) {
+                continue;
+            }
+            ossie::ComponentInfo* peerComponent = findComponentByInstantiationId(peer->first);
+            if (!peerComponent || !peerComponent->isAssignedToDevice()) {
+                continue;
+            }
+            const double distance = getComponentPlacementDistance(component, *(component->getAssignedDevice()),
+                                                                  peerComponent, *(peerComponent->getAssignedDevice()));
+            if (distance == PLACEMENT_COST_SAME_DEVICE) {
+                ++local;
+            } else if (distance == PLACEMENT_COST_CROSS_SOCKET) {
+                ++cross_socket;
+            } else if (distance == PLACEMENT_COST_SAME_NODE) {
+                ++cross_device;
+            } else {
+                ++remote;
+            }
+            total_cost += peer->second * distance;
+            LOG_DEBUG(ApplicationFactory_impl, "Placement cost " << node->first << " <-> " << peer->first
+                      << " weight " << peer->second << " distance " << distance);
+        }
+    }
+    LOG_INFO(ApplicationFactory_impl, "Topology aware placement for application " << appIdentifier
+             << ": cost " << total_cost << " (connections on same device " << local
+             << ", across sockets on same device " << cross_socket
+             << ", across devices on same node " << cross_device << ", across nodes " << remote << ")");
+}
+
 void createHelper::_assignComponentsUsingDAS(const DeviceAssignmentMap& deviceAssignments, const std::string &appIdentifier)
 {
     LOG_TRACE(ApplicationFactory_impl, "Assigning " << deviceAssignments.size() 
@@ -1398,6 +1716,22 @@ throw (CORBA::SystemException,
             modifiedInitConfiguration = initConfiguration;
         }
 
+        // Check for topology aware placement; the property is consumed here
+        // and not passed on to the assembly controller
+        const std::string topology_aware_property_id("TOPOLOGY_AWARE_PLACEMENT");
+        for (unsigned int initCount = 0; initCount < modifiedInitConfiguration.length(); initCount++) {
+            if (std::string(modifiedInitConfiguration[initCount].id) == topology_aware_property_id) {
+                if (!(modifiedInitConfiguration[initCount].value >>= _topologyAware)) {
+                    LOG_WARN(ApplicationFactory_impl, "Ignoring non-boolean " << topology_aware_property_id << " value");
+                }
+                for (unsigned int rem_idx=initCount; rem_idx<modifiedInitConfiguration.length()-1; rem_idx++) {
+                    modifiedInitConfiguration[rem_idx] = modifiedInitConfiguration[rem_idx+1];
+                }
+                modifiedInitConfiguration.length(modifiedInitConfiguration.length()-1);
+                break;
+            }
+        }
+
         const std::string specialized_reservation("SPECIALIZED_CPU_RESERVATION");
         for (unsigned int initCount = 0; initCount < modifiedInitConfiguration.length(); initCount++) {
             if (std::string(modifiedInitConfiguration[initCount].id) == specialized_reservation) {
@@ -1447,6 +1781,10 @@ throw (CORBA::SystemException,
         // Load the components to instantiate from the SAD
         getRequiredComponents();
 
+        if (_topologyAware) {
+            _buildConnectionGraph();
+        }
+
         ossie::ComponentInfo* assemblyControllerComponent = getAssemblyController();
         if (assemblyControllerComponent) {
             overrideProperties(modifiedInitConfiguration, assemblyControllerComponent);
@@ -1507,6 +1845,12 @@ throw (CORBA::SystemException,
 
         assignRemainingComponentsToDevices(appIdentifier);
 
+        if (_topologyAware) {
+            // keep heavily connected components on the same processor socket
+            _alignConnectedAffinity();
+            _reportPlacementCost(appIdentifier);
+        }
+
         ////////////////////////////////////////////////
         // Create the Application servant
 
@@ -1559,7 +1903,8 @@ throw (CORBA::SystemException,
             _appUsedDevs, 
             _startSeq, 
             connections, 
-            allocationIDs);
+            allocationIDs,
+            _startOrders);
 
         // Add a reference to the new application to the 
         // ApplicationSequence in DomainManager
@@ -2062,6 +2407,8 @@ ossie::AllocationResult createHelper::allocateComponentToDevice( ossie::Componen
         // Remove all non-requested devices
         devices.erase(devices.begin(), device++);
         devices.erase(device, devices.end());
+    } else if (_topologyAware) {
+        _orderDevicesByPlacementCost(component, devices);
     }
 
     const std::string requestid = ossie::generateUUID();
@@ -2411,8 +2758,10 @@ void createHelper::getRequiredComponents()
 
     // Build the start order instantiation ID vector in the right order
     _startOrderIds.clear();
+    _startOrders.clear();
     for (std::map<int,std::vector<std::string> >::iterator ii = startOrders.begin(); ii != startOrders.end(); ++ii) {
         _startOrderIds.insert(_startOrderIds.end(), ii->second.begin(), ii->second.end());
+        _startOrders.insert(_startOrders.end(), ii->second.size(), ii->first);
     }
 
     TRACE_EXIT(ApplicationFactory_impl);
@@ -3526,6 +3875,7 @@ createHelper::createHelper (
     _appFact(appFact),
     _allocationMgr(_appFact._domainManager->_allocationMgr),
     _allocations(*_allocationMgr),
+    _topologyAware(false),
     _isComplete(false),
     _application(0)
 {
@@ -208,12 +208,20 @@ private:
     PlacementList     _requiredComponents;
     std::map<std::string,float> specialized_reservations;
 
+    // Topology aware placement, weights candidate devices by the connections
+    // to components that have already been placed
+    typedef std::map<std::string, double>             ConnectionWeights;
+    typedef std::map<std::string, ConnectionWeights>  ConnectionGraph;
+    bool              _topologyAware;
+    ConnectionGraph   _connectionGraph;
+
     //
     // List of used devices allocated during application creation
     //
     DeviceAssignmentList          _appUsedDevs;
     std::vector<CF::Resource_var> _startSeq;
     std::vector<std::string>      _startOrderIds;
+    std::vector<int>              _startOrders;
     
     // waveform instance-specific naming context (unique to the instance of the waveform)
     std::string _waveformContextName; 
@@ -232,6 +240,13 @@ private:
     void overrideExternalProperties(const CF::Properties& initConfiguration);
     void overrideProperties(const CF::Properties& initConfiguration, ossie::ComponentInfo* component);
     void assignRemainingComponentsToDevices(const std::string &appIdentifier);
+    void _buildConnectionGraph();
+    double _getBandwidthHint(ossie::ComponentInfo* component);
+    double _getPlacementCost(ossie::ComponentInfo* component, const ossie::DeviceNode& device);
+    void _orderDevicesByPlacementCost(ossie::ComponentInfo* component, ossie::DeviceList& devices);
+    void _orderComponentsByConnectivity(PlacementList& components);
+    void _alignConnectedAffinity();
+    void _reportPlacementCost(const std::string &appIdentifier);
     void _assignComponentsUsingDAS(
         const DeviceAssignmentMap& deviceAssignments, const std::string &appIdentifier);
     void _getComponentsToPlace(
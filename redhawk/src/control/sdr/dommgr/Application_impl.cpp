@@ -21,6 +21,13 @@
 #include <stdexcept>
 #include <string>
 #include <sstream>
+#include <algorithm>
+#include <deque>
+
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
+#include <boost/thread.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
 
 #include <ossie/debug.h>
 #include <ossie/CorbaUtils.h>
@@ -111,8 +118,242 @@ namespace {
     {
         convert_sequence_if(out, in.begin(), in.end(), func, pred);
     }
+
+    // Upper bound on the number of concurrent calls made for one batch of
+    // component calls (start, stop, teardown, configure and query); the
+    // workers that make them are shared by all applications
+    const size_t MAX_CONCURRENT_CALLS = 16;
+
+    // Report interval, in seconds, requested of the components for changes
+    // to cached query values
+    const CORBA::Float QUERY_CACHE_LISTENER_INTERVAL = 0.1;
+
+    // Per-call timeouts during teardown
+    const unsigned long RELEASE_CALL_TIMEOUT = 3000; // milliseconds
+    const unsigned long MIN_TEARDOWN_CALL_TIMEOUT = 3000; // milliseconds
+
+    typedef std::vector< boost::function<void ()> > TaskList;
+
+    // Persistent pool of worker threads, shared by every application, that
+    // makes the calls to components. Workers are started as batches need
+    // them, up to MAX_CONCURRENT_CALLS - 1, and stay for the life of the
+    // process. The thread that submits a batch works on it too, so a batch
+    // always makes progress, even when every worker is busy (for instance,
+    // with the tasks of another batch that is waiting on this one). Tasks
+    // are expected to handle their own errors.
+    class CallPool {
+    public:
+        static CallPool& instance()
+        {
+            boost::call_once(&CallPool::create, _instanceFlag);
+            return *_instance;
+        }
+
+        void run(const TaskList& tasks)
+        {
+            if (tasks.empty()) {
+                return;
+            } else if (tasks.size() == 1) {
+                execute(tasks[0]);
+                return;
+            }
+
+            Batch batch(tasks);
+            {
+                boost::mutex::scoped_lock lock(_lock);
+                _queue.push_back(&batch);
+                startWorkers(tasks.size() - 1);
+                _available.notify_all();
+            }
+
+            while (true) {
+                size_t index;
+                {
+                    boost::mutex::scoped_lock lock(_lock);
+                    if (!takeTask(&batch, index)) {
+                        break;
+                    }
+                }
+                execute(batch.tasks[index]);
+                finishTask(&batch);
+            }
+
+            // Wait for the tasks that workers took to finish
+            boost::mutex::scoped_lock lock(_lock);
+            while (batch.pending > 0) {
+                batch.done.wait(lock);
+            }
+        }
+
+    private:
+        struct Batch {
+            Batch(const TaskList& tasks) :
+                tasks(tasks),
+                next(0),
+                pending(tasks.size())
+            {
+            }
+
+            const TaskList& tasks;
+            size_t next;
+            size_t pending;
+            boost::condition_variable done;
+        };
+
+        CallPool() :
+            _workers(0)
+        {
+        }
+
+        static void create()
+        {
+            // Never destroyed, as workers may still be in a call at exit
+            _instance = new CallPool();
+        }
+
+        // Must be called with _lock held
+        void startWorkers(size_t wanted)
+        {
+            const size_t limit = std::min(wanted, MAX_CONCURRENT_CALLS - 1);
+            while (_workers < limit) {
+                try {
+                    boost::thread worker(boost::bind(&CallPool::work, this));
+                    worker.detach();
+                } catch (const boost::thread_resource_error&) {
+                    // The submitting threads still work on their own batches
+                    break;
+                }
+                ++_workers;
+            }
+        }
+
+        // Must be called with _lock held; a batch leaves the queue once all
+        // of its tasks have been taken
+        bool takeTask(Batch* batch, size_t& index)
+        {
+            if (batch->next >= batch->tasks.size()) {
+                return false;
+            }
+            index = batch->next++;
+            if (batch->next == batch->tasks.size()) {
+                _queue.erase(std::find(_queue.begin(), _queue.end(), batch));
+            }
+            return true;
+        }
+
+        void finishTask(Batch* batch)
+        {
+            // The batch belongs to the submitting thread, and may be gone as
+            // soon as the lock is released after the last task
+            boost::mutex::scoped_lock lock(_lock);
+            if (--batch->pending == 0) {
+                batch->done.notify_all();
+            }
+        }
+
+        void work()
+        {
+            while (true) {
+                Batch* batch;
+                size_t index;
+                {
+                    boost::mutex::scoped_lock lock(_lock);
+                    while (_queue.empty()) {
+                        _available.wait(lock);
+                    }
+                    batch = _queue.front();
+                    takeTask(batch, index);
+                }
+                execute(batch->tasks[index]);
+                finishTask(batch);
+            }
+        }
+
+        static void execute(const boost::function<void ()>& task)
+        {
+            try {
+                task();
+            } catch (...) {
+                // Tasks report their own errors
+            }
+        }
+
+        static CallPool* _instance;
+        static boost::once_flag _instanceFlag;
+
+        boost::mutex _lock;
+        boost::condition_variable _available;
+        std::deque<Batch*> _queue;
+        size_t _workers;
+    };
+
+    CallPool* CallPool::_instance = 0;
+    boost::once_flag CallPool::_instanceFlag = BOOST_ONCE_INIT;
+
+    void runTasks(const TaskList& tasks)
+    {
+        CallPool::instance().run(tasks);
+    }
+
+    // Returns a new reference to a component's assigned device. The CORBA
+    // call timeout belongs to the object reference, and every component on a
+    // device shares one, so each concurrent teardown call sets its timeout on
+    // a reference of its own.
+    template <class T>
+    typename T::_ptr_type getDeviceReference(const ossie::ApplicationComponent* component)
+    {
+        if (CORBA::is_nil(component->assignedDevice)) {
+            return T::_nil();
+        }
+        try {
+            const std::string ior = ossie::corba::objectToString(component->assignedDevice);
+            CORBA::Object_var device = ossie::corba::stringToObject(ior);
+            return ossie::corba::_narrowSafe<T>(device);
+        } catch (...) {
+            return T::_nil();
+        }
+    }
+
+    // Returns the CORBA call timeout to use for a teardown call, limited by
+    // the time remaining before the deadline (but no less than the minimum,
+    // so that calls made after the deadline are still attempted)
+    unsigned long getTeardownCallTimeout(const boost::posix_time::ptime& deadline, unsigned long limit=0)
+    {
+        long remaining = (deadline - boost::posix_time::microsec_clock::universal_time()).total_milliseconds();
+        unsigned long timeout = std::max(remaining, (long)MIN_TEARDOWN_CALL_TIMEOUT);
+        if (limit > 0) {
+            timeout = std::min(timeout, limit);
+        }
+        return timeout;
+    }
+
+    long elapsedMillis(const boost::posix_time::ptime& start)
+    {
+        return (boost::posix_time::microsec_clock::universal_time() - start).total_milliseconds();
+    }
 }
 
+// Receives the property change events for cached query values; events are
+// matched to components by their registration id, as the resource id in an
+// event is not guaranteed to be the component's identifier
+class Application_impl::QueryCacheListener : public virtual POA_CF::PropertyChangeListener
+{
+public:
+    QueryCacheListener(Application_impl* application) :
+        _application(application)
+    {
+    }
+
+    void propertyChange(const CF::PropertyChangeListener::PropertyChangeEvent& event)
+        throw (CORBA::SystemException)
+    {
+        _application->cachedPropertiesChanged(std::string(event.reg_id), event.properties);
+    }
+
+private:
+    Application_impl* _application;
+};
+
 Application_impl::Application_impl (const std::string& id, const std::string& name, const std::string& profile,
                                     DomainManager_impl* domainManager, const std::string& waveformContextName,
                                     CosNaming::NamingContext_ptr waveformContext, bool aware, CosNaming::NamingContext_ptr DomainContext) :
@@ -132,18 +373,22 @@ Application_impl::Application_impl (const std::string& id, const std::string& na
     if (!_isAware) {
         _fakeProxy = new FakeApplication(this);
     }
+    _queryCacheGeneration = 0;
+    _queryCacheListener = new QueryCacheListener(this);
 };
 
 void Application_impl::populateApplication(CF::Resource_ptr _controller,
                                            std::vector<ossie::DeviceAssignmentInfo>&  _devSeq,
                                            std::vector<CF::Resource_var> _startSeq,
                                            std::vector<ConnectionNode>& connections,
-                                           std::vector<std::string> allocationIDs)
+                                           std::vector<std::string> allocationIDs,
+                                           const std::vector<int>& startOrders)
 {
     TRACE_ENTER(Application_impl)
     _connections = connections;
     _componentDevices = _devSeq;
     _appStartSeq = _startSeq;
+    _appStartOrders = startOrders;
 
     LOG_DEBUG(Application_impl, "Creating allocation sequence");
     this->_allocationIDs = allocationIDs;
@@ -154,6 +399,9 @@ void Application_impl::populateApplication(CF::Resource_ptr _controller,
         LOG_INFO(Application_impl, "Assembly controller is non SCA-compliant");
     } else {
         assemblyController = CF::Resource::_duplicate(_controller);
+        try {
+            _assemblyControllerId = ossie::corba::returnString(assemblyController->identifier());
+        } CATCH_LOG_WARN(Application_impl, "Unable to retrieve assembly controller identifier");
     }
     TRACE_EXIT(Application_impl)
 }
@@ -185,6 +433,9 @@ PortableServer::ObjectId* Application_impl::Activate(Application_impl* applicati
         reg_oid = ossie::corba::activatePersistentObject(poa, application->_fakeProxy, proxyId);
     }
 
+    const std::string listenerId = application->_identifier + ".querycache";
+    reg_oid = ossie::corba::activatePersistentObject(poa, application->_queryCacheListener, listenerId);
+
     return oid._retn();
 }
 
@@ -217,19 +468,33 @@ throw (CORBA::SystemException, CF::Resource::StartError)
     }
 
     try {
+        const boost::posix_time::ptime start_time = boost::posix_time::microsec_clock::universal_time();
         omniORB::setClientCallTimeout(assemblyController, 0);       
         LOG_TRACE(Application_impl, "Calling start on assembly controller")
         assemblyController->start ();
 
-        // Start the rest of the components
-        for (unsigned int i = 0; i < _appStartSeq.size(); i++){
-            std::string msg = "Calling start for ";
-            msg = msg.append(ossie::corba::returnString(_appStartSeq[i]->identifier()));
-            LOG_TRACE(Application_impl, msg)
+        // Start the rest of the components; components that share a start
+        // order are started concurrently, and each group finishes starting
+        // before the next one begins
+        const StartGroups groups = getStartGroups();
+        for (StartGroups::const_iterator group = groups.begin(); group != groups.end(); ++group) {
+            std::vector<CallResult> results(group->second - group->first);
+            TaskList tasks;
+            for (size_t index = group->first; index < group->second; ++index) {
+                tasks.push_back(boost::bind(&Application_impl::startComponentCall, this,
+                                            _appStartSeq[index].in(), &results[index - group->first]));
+            }
+            runTasks(tasks);
 
-            omniORB::setClientCallTimeout(_appStartSeq[i], 0);       
-            _appStartSeq[i]-> start();
+            for (std::vector<CallResult>::iterator result = results.begin(); result != results.end(); ++result) {
+                if (result->failed) {
+                    throw CF::Resource::StartError(result->errorNumber, result->message.c_str());
+                }
+            }
         }
+        LOG_INFO(Application_impl, "Start timing for " << _identifier << ": " << _appStartSeq.size()+1
+                 << " component(s) in " << groups.size() << " start order group(s) in "
+                 << elapsedMillis(start_time) << " ms");
     } catch( CF::Resource::StartError& se ) {
         LOG_ERROR(Application_impl, "Start failed with CF:Resource::StartError");
         throw;
@@ -270,6 +535,59 @@ bool Application_impl::stopComponent (CF::Resource_ptr component)
     return false;
 }
 
+void Application_impl::stopComponentCall (CF::Resource_ptr component, CallResult* result)
+{
+    result->failed = !stopComponent(component);
+}
+
+void Application_impl::startComponentCall (CF::Resource_ptr component, CallResult* result)
+{
+    result->failed = true;
+    std::string identifier;
+    try {
+        identifier = ossie::corba::returnString(component->identifier());
+        LOG_TRACE(Application_impl, "Calling start for " << identifier);
+        omniORB::setClientCallTimeout(component, 0);
+        component->start();
+        result->failed = false;
+        return;
+    } catch (const CF::Resource::StartError& error) {
+        // Pass the component's own error on unchanged
+        result->errorNumber = error.errorNumber;
+        result->message = static_cast<const char*>(error.msg);
+        LOG_ERROR(Application_impl, "Failed to start " << identifier << "; CF::Resource::StartError '" << error.msg << "'");
+        return;
+    } catch (const CORBA::Exception& ex) {
+        result->message = std::string("CORBA::") + ex._name();
+    } catch (const std::exception& ex) {
+        result->message = ex.what();
+    } catch (...) {
+        result->message = "unknown exception";
+    }
+    if (identifier.empty()) {
+        result->message = "Failed to get component identifier: " + result->message;
+    } else {
+        result->message = "Failed to start " + identifier + ": " + result->message;
+    }
+    LOG_ERROR(Application_impl, result->message);
+}
+
+Application_impl::StartGroups Application_impl::getStartGroups () const
+{
+    // Without start order values (i.e., an application restored from the
+    // persistence store), each component is its own group
+    const bool ordered = (_appStartOrders.size() == _appStartSeq.size());
+    StartGroups groups;
+    size_t first = 0;
+    for (size_t index = 1; index <= _appStartSeq.size(); ++index) {
+        if ((index == _appStartSeq.size()) || !ordered || (_appStartOrders[index] != _appStartOrders[first])) {
+            groups.push_back(std::make_pair(first, index));
+            first = index;
+        }
+    }
+    return groups;
+}
+
 void Application_impl::stop ()
 throw (CORBA::SystemException, CF::Resource::StopError)
 {
@@ -293,11 +611,24 @@ throw (CORBA::SystemException, CF::Resource::StopError)
         return;
     }
 
+    const boost::posix_time::ptime start_time = boost::posix_time::microsec_clock::universal_time();
     int failures = 0;
-    // Stop the components in the reverse order they were started
-    for (int i = (int)(_appStartSeq.size()-1); i >= 0; i--){
-        if (!stopComponent(_appStartSeq[i])) {
-            failures++;
+    // Stop the components in the reverse order they were started; components
+    // that share a start order are stopped concurrently
+    const StartGroups groups = getStartGroups();
+    for (StartGroups::const_reverse_iterator group = groups.rbegin(); group != groups.rend(); ++group) {
+        std::vector<CallResult> results(group->second - group->first);
+        TaskList tasks;
+        for (size_t index = group->first; index < group->second; ++index) {
+            tasks.push_back(boost::bind(&Application_impl::stopComponentCall, this,
+                                        _appStartSeq[index].in(), &results[index - group->first]));
+        }
+        runTasks(tasks);
+
+        for (std::vector<CallResult>::iterator result = results.begin(); result != results.end(); ++result) {
+            if (result->failed) {
+                failures++;
+            }
         }
     }
 
@@ -305,6 +636,8 @@ throw (CORBA::SystemException, CF::Resource::StopError)
     if (!stopComponent(assemblyController)) {
         failures++;
     }
+    LOG_INFO(Application_impl, "Stop timing for " << _identifier << ": " << _appStartSeq.size()+1
+             << " component(s) in " << elapsedMillis(start_time) << " ms");
     if (failures > 0) {
         std::ostringstream oss;
         oss << failures << " component(s) failed to stop";
@@ -341,96 +674,68 @@ throw (CF::PropertySet::PartialConfiguration, CF::PropertySet::InvalidConfigurat
 void Application_impl::configure (const CF::Properties& configProperties)
 throw (CF::PropertySet::PartialConfiguration, CF::PropertySet::InvalidConfiguration, CORBA::SystemException)
 {
-    int validProperties = 0;
     CF::Properties invalidProperties;
 
-    // Creates a map from componentIdentifier -> (rsc_ptr, ConfigPropSet)
-    // to allow for one batched configure call per component
-
-    CF::Properties acProps;
-    const std::string acId = ossie::corba::returnString(assemblyController->identifier());
-    std::map<std::string, std::pair<CF::Resource_ptr, CF::Properties> > batch;
-    batch[acId] = std::pair<CF::Resource_ptr, CF::Properties>(assemblyController, acProps);
+    // Groups the properties by component to allow for one configure call per
+    // component; non-external properties are batched with the assembly controller
+    PropertyBatches batches;
 
     // Loop through each passed external property, mapping it with its respective resource
     for (unsigned int i = 0; i < configProperties.length(); ++i) {
         // Gets external ID for property mapping
         const std::string extId(configProperties[i].id);
+        std::map<std::string, externalPropertyRecord>::const_iterator external = _properties.find(extId);
 
-        if (_properties.count(extId)) {
+        CF::DataType property;
+        property.value = configProperties[i].value;
+        if (external != _properties.end()) {
             // Gets the component and its internal property id
-            const std::string propId = _properties[extId].id;
-            CF::Resource_ptr comp = _properties[extId].component;
+            const std::string& propId = external->second.id;
+            CF::Resource_ptr comp = external->second.component;
 
             if (CORBA::is_nil(comp)) {
                 LOG_ERROR(Application_impl, "Unable to retrieve component for external property: " << extId);
-                int count = invalidProperties.length();
-                invalidProperties.length(count + 1);
-                invalidProperties[count].id = CORBA::string_dup(extId.c_str());
-                invalidProperties[count].value = configProperties[i].value;
-            } else {
-                // Key used for map
-                const std::string compId = ossie::corba::returnString(comp->identifier());
+                ossie::corba::push_back(invalidProperties, configProperties[i]);
+                continue;
+            }
+            const std::string compId = getExternalComponentId(external->second);
 
-                LOG_TRACE(Application_impl, "Configure external property: " << extId << " on "
-                        << compId << " (propid: " << propId << ")");
+            LOG_TRACE(Application_impl, "Configure external property: " << extId << " on "
+                    << compId << " (propid: " << propId << ")");
 
-                // Adds property to component ID mapping
-                // If one doesn't exist, adds it
-                if (batch.count(compId)) {
-                    int count = batch[compId].second.length();
-                    batch[compId].second.length(count + 1);
-                    batch[compId].second[count].id = propId.c_str();
-                    batch[compId].second[count].value = configProperties[i].value;
-                } else {
-                    CF::Properties tempProp;
-                    tempProp.length(1);
-                    tempProp[0].id = propId.c_str();
-                    tempProp[0].value = configProperties[i].value;
-                    batch[compId] = std::pair<CF::Resource_ptr, CF::Properties>(comp, tempProp);
-                }
-            }
+            property.id = propId.c_str();
+            PropertyBatch& batch = batches[compId];
+            batch.component = comp;
+            ossie::corba::push_back(batch.properties, property);
         } else if (!CORBA::is_nil(assemblyController)) {
-            // Properties that are not external get batched with assembly controller
             LOG_TRACE(Application_impl, "Calling configure on assembly controller for property: " << configProperties[i].id);
-            int count = batch[acId].second.length();
-            batch[acId].second.length(count + 1);
-            batch[acId].second[count].id = configProperties[i].id;
-            batch[acId].second[count].value = configProperties[i].value;
+            property.id = configProperties[i].id;
+            PropertyBatch& batch = batches[_assemblyControllerId];
+            batch.component = assemblyController;
+            ossie::corba::push_back(batch.properties, property);
         } else {
             LOG_ERROR(Application_impl, "Unable to retrieve assembly controller for external property: " << extId);
-            int count = invalidProperties.length();
-            invalidProperties.length(count + 1);
-            invalidProperties[count].id = CORBA::string_dup(extId.c_str());
-            invalidProperties[count].value = configProperties[i].value;
+            ossie::corba::push_back(invalidProperties, configProperties[i]);
         }
     }
 
-    // -Loop through each component with a property that needs to be configured and make configure call
-    // -Catch any errors
-    for (std::map<std::string, std::pair<CF::Resource_ptr, CF::Properties> >::const_iterator comp = batch.begin();
-            comp != batch.end(); ++comp) {
-        int propLength = comp->second.second.length();
-        try {
-            comp->second.first->configure(comp->second.second);
-            validProperties += propLength;
-        } catch (CF::PropertySet::InvalidConfiguration e) {
-            // Add invalid properties to return list
-            for (unsigned int i = 0; i < e.invalidProperties.length(); ++i) {
-                int count = invalidProperties.length();
-                invalidProperties.length(count + 1);
-                invalidProperties[count].id = CORBA::string_dup(e.invalidProperties[i].id);
-                invalidProperties[count].value = e.invalidProperties[i].value;
-            }
-        } catch (CF::PropertySet::PartialConfiguration e) {
-            // Add invalid properties to return list
-            for (unsigned int i = 0; i < e.invalidProperties.length(); ++i) {
-                int count = invalidProperties.length();
-                invalidProperties.length(count + 1);
-                invalidProperties[count].id = CORBA::string_dup(e.invalidProperties[i].id);
-                invalidProperties[count].value = e.invalidProperties[i].value;
-            }
-            validProperties += propLength - e.invalidProperties.length();
+    // Configure the components concurrently; configuring may change other
+    // values, so any cached values for the components are discarded
+    std::vector<PropertyBatch*> calls;
+    for (PropertyBatches::iterator batch = batches.begin(); batch != batches.end(); ++batch) {
+        invalidateCachedValues(batch->first);
+        calls.push_back(&batch->second);
+    }
+    runPropertyBatches(calls, &Application_impl::configureComponentCall);
+
+    int validProperties = 0;
+    for (PropertyBatches::const_iterator batch = batches.begin(); batch != batches.end(); ++batch) {
+        if (batch->second.error) {
+            batch->second.error->_raise();
+        }
+        validProperties += batch->second.validCount;
+        for (unsigned int i = 0; i < batch->second.invalidProperties.length(); ++i) {
+            ossie::corba::push_back(invalidProperties, batch->second.invalidProperties[i]);
         }
     }
 
@@ -450,23 +755,20 @@ throw (CF::UnknownProperties, CORBA::SystemException)
 {
     CF::Properties invalidProperties;
 
-    // Creates a map from componentIdentifier -> (rsc_ptr, ConfigPropSet)
-    // to allow for one batched query call per component
-    const std::string acId = ossie::corba::returnString(assemblyController->identifier());
-    std::map<std::string, std::pair<CF::Resource_ptr, CF::Properties> > batch;
+    // Groups the requested properties by component to allow for one query
+    // call per component, and makes the calls concurrently
+    PropertyBatches batches;
+    std::vector<PropertyBatch*> calls;
 
     // For queries of zero length, return all external properties
     if (configProperties.length() == 0) {
         LOG_TRACE(Application_impl, "Query all external and assembly controller properties");
 
-        configProperties.length(0);
-
         // Loop through each external property and add it to the batch with its respective component
         for (std::map<std::string, externalPropertyRecord>::const_iterator prop = _properties.begin();
                 prop != _properties.end(); ++prop) {
             // Gets the property mapping info
-            std::string extId = prop->first;
-            std::string propId = prop->second.id;
+            const std::string& extId = prop->first;
             CF::Resource_ptr comp = prop->second.component;
 
             if (prop->second.access == "writeonly")
@@ -474,192 +776,184 @@ throw (CF::UnknownProperties, CORBA::SystemException)
 
             if (CORBA::is_nil(comp)) {
                 LOG_ERROR(Application_impl, "Unable to retrieve component for external property: " << extId);
-                int count = invalidProperties.length();
-                invalidProperties.length(count + 1);
-                invalidProperties[count].id = CORBA::string_dup(extId.c_str());
-                invalidProperties[count].value = CORBA::Any();
-            } else {
-                // Key used for map
-                const std::string compId = ossie::corba::returnString(comp->identifier());
+                CF::DataType invalid;
+                invalid.id = extId.c_str();
+                ossie::corba::push_back(invalidProperties, invalid);
+                continue;
+            }
+            const std::string compId = getExternalComponentId(prop->second);
 
-                LOG_TRACE(Application_impl, "Query external property: " << extId << " on "
-                        << compId << " (propid: " << propId << ")");
+            LOG_TRACE(Application_impl, "Query external property: " << extId << " on "
+                    << compId << " (propid: " << prop->second.id << ")");
 
-                // Adds property to component ID mapping
-                // If one doesn't exist, creates it
-                if (batch.count(compId)) {
-                    int count = batch[compId].second.length();
-                    batch[compId].second.length(count + 1);
-                    batch[compId].second[count].id = propId.c_str();
-                } else {
-                    CF::Properties tempProp;
-                    tempProp.length(1);
-                    tempProp[0].id = propId.c_str();
-                    batch[compId] = std::pair<CF::Resource_ptr, CF::Properties>(comp, tempProp);
-                }
+            CF::DataType property;
+            property.id = prop->second.id.c_str();
+            PropertyBatch& batch = batches[compId];
+            batch.component = comp;
+            if (isCacheable(extId)) {
+                batch.cacheComponentId = compId;
             }
+            ossie::corba::push_back(batch.properties, property);
         }
 
-        // -Loop through each component with an external property and make query() call
-        // -Catch any errors
-        for (std::map<std::string, std::pair<CF::Resource_ptr, CF::Properties> >::iterator comp = batch.begin();
-                comp != batch.end(); ++comp) {
-            try {
-                comp->second.first->query(comp->second.second);
-
-                // Adds each individual queried property
-                for (unsigned int i = 0; i < comp->second.second.length(); ++i) {
-                    // Gets the external property ID from the component ID and internal prop ID
-                    std::string extId = getExternalPropertyId(comp->first, std::string(comp->second.second[i].id));
-                    int count = configProperties.length();
-                    configProperties.length(count + 1);
-                    configProperties[count].id = CORBA::string_dup(extId.c_str());
-                    configProperties[count].value = comp->second.second[i].value;
-                }
-            } catch (CF::UnknownProperties e) {
-                for (unsigned int i = 0; i < e.invalidProperties.length(); ++i) {
-                    // Add invalid properties to return list
-                    int count = invalidProperties.length();
-                    invalidProperties.length(count + 1);
-                    invalidProperties[count].id = CORBA::string_dup(e.invalidProperties[i].id);
-                    invalidProperties[count].value = e.invalidProperties[i].value;
-                }
+        // The assembly controller is queried for all of its properties
+        // alongside the external property queries
+        PropertyBatch acBatch;
+        acBatch.component = assemblyController;
+        for (PropertyBatches::iterator batch = batches.begin(); batch != batches.end(); ++batch) {
+            calls.push_back(&batch->second);
+        }
+        if (!CORBA::is_nil(assemblyController)) {
+            calls.push_back(&acBatch);
+        }
+        const unsigned long generation = getQueryCacheGeneration();
+        runPropertyBatches(calls, &Application_impl::queryComponentCall);
+
+        for (std::vector<PropertyBatch*>::const_iterator call = calls.begin(); call != calls.end(); ++call) {
+            if ((*call)->error) {
+                (*call)->error->_raise();
             }
         }
 
-        // Query Assembly Controller properties
-        CF::Properties tempProp;
-        try {
-            assemblyController->query(tempProp);
-        } catch (CF::UnknownProperties e) {
-            int count = invalidProperties.length();
-            invalidProperties.length(count + e.invalidProperties.length());
-            for (unsigned int i = 0; i < e.invalidProperties.length(); ++i) {
-                LOG_ERROR(Application_impl, "Invalid assembly controller property name: " << e.invalidProperties[i].id);
-                invalidProperties[count + i] = e.invalidProperties[i];
+        // Adds each individual queried property
+        for (PropertyBatches::const_iterator batch = batches.begin(); batch != batches.end(); ++batch) {
+            const CF::Properties& results = batch->second.properties;
+            for (unsigned int i = 0; i < batch->second.invalidProperties.length(); ++i) {
+                ossie::corba::push_back(invalidProperties, batch->second.invalidProperties[i]);
+            }
+            if (batch->second.invalidProperties.length() > 0) {
+                continue;
+            }
+            for (unsigned int i = 0; i < results.length(); ++i) {
+                // Gets the external property ID from the component ID and internal prop ID
+                const std::string propId(results[i].id);
+                const std::string extId = getExternalPropertyId(batch->first, propId);
+                if (isCacheable(extId)) {
+                    cacheValue(batch->first, propId, results[i].value, generation);
+                }
+                CF::DataType property;
+                property.id = extId.c_str();
+                property.value = results[i].value;
+                ossie::corba::push_back(configProperties, property);
             }
         }
 
         // Adds Assembly Controller properties
-        for (unsigned int i = 0; i < tempProp.length(); ++i) {
+        for (unsigned int i = 0; i < acBatch.invalidProperties.length(); ++i) {
+            LOG_ERROR(Application_impl, "Invalid assembly controller property name: " << acBatch.invalidProperties[i].id);
+            ossie::corba::push_back(invalidProperties, acBatch.invalidProperties[i]);
+        }
+        for (unsigned int i = 0; i < acBatch.properties.length(); ++i) {
             // Only add AC props that aren't already promoted as external
-            if (this->getExternalPropertyId(acId, std::string(tempProp[i].id)) == "") {
-                int count = configProperties.length();
-                configProperties.length(count + 1);
-                configProperties[count].id = CORBA::string_dup(tempProp[i].id);
-                configProperties[count].value = tempProp[i].value;
+            const std::string propId(acBatch.properties[i].id);
+            if (getExternalPropertyId(_assemblyControllerId, propId).empty()) {
+                ossie::corba::push_back(configProperties, acBatch.properties[i]);
             }
         }
     } else {
         // For queries of length > 0, return all requested pairs that are valid external properties
-        // or are Assembly Controller Properties
-        CF::Properties acProps;
-        batch[acId] = std::pair<CF::Resource_ptr, CF::Properties>(assemblyController, acProps);
+        // or are Assembly Controller Properties; records the (component, property) each
+        // requested id resolves to, or an empty component id if it was answered already
+        std::vector<ComponentPropertyKey> targets(configProperties.length());
+        std::set<ComponentPropertyKey> cacheable;
 
         for (unsigned int i = 0; i < configProperties.length(); ++i) {
             // Gets external ID for property mapping
             const std::string extId(configProperties[i].id);
+            std::map<std::string, externalPropertyRecord>::const_iterator external = _properties.find(extId);
 
-            if (_properties.count(extId)) {
-                if (_properties[extId].access == "writeonly") {
+            std::string compId;
+            std::string propId;
+            CF::Resource_ptr comp;
+            if (external != _properties.end()) {
+                if (external->second.access == "writeonly") {
                     LOG_ERROR(Application_impl, "Cannot read writeonly external property: " << extId);
-                    int count = invalidProperties.length();
-                    invalidProperties.length(count + 1);
-                    invalidProperties[count].id = CORBA::string_dup(extId.c_str());
-                    invalidProperties[count].value = configProperties[i].value;
+                    ossie::corba::push_back(invalidProperties, configProperties[i]);
                     continue;
                 }
 
                 // Gets the component and its property id
-                const std::string propId = _properties[extId].id;
-                CF::Resource_ptr comp = _properties[extId].component;
+                propId = external->second.id;
+                comp = external->second.component;
 
                 if (CORBA::is_nil(comp)) {
                     LOG_ERROR(Application_impl, "Unable to retrieve component for external property: " << extId);
-                    int count = invalidProperties.length();
-                    invalidProperties.length(count + 1);
-                    invalidProperties[count].id = CORBA::string_dup(extId.c_str());
-                    invalidProperties[count].value = configProperties[i].value;
-                } else {
-                    // Key used for map
-                    std::string compId = ossie::corba::returnString(comp->identifier());
-
-                    LOG_TRACE(Application_impl, "Query external property: " << extId << " on "
-                            << compId << " (propid: " << propId << ")");
-
-                    // Adds property to component ID mapping
-                    // If one doesn't exist, adds it
-                    if (batch.count(compId)) {
-                        int count = batch[compId].second.length();
-                        batch[compId].second.length(count + 1);
-                        batch[compId].second[count].id = propId.c_str();
-                        batch[compId].second[count].value = configProperties[i].value;
-                    } else {
-                        CF::Properties tempProp;
-                        tempProp.length(1);
-                        tempProp[0].id = propId.c_str();
-                        tempProp[0].value = configProperties[i].value;
-                        batch[compId] = std::pair<CF::Resource_ptr, CF::Properties>(comp, tempProp);
-                    }
+                    ossie::corba::push_back(invalidProperties, configProperties[i]);
+                    continue;
                 }
+                compId = getExternalComponentId(external->second);
+
+                LOG_TRACE(Application_impl, "Query external property: " << extId << " on "
+                        << compId << " (propid: " << propId << ")");
             } else if (!CORBA::is_nil(assemblyController)) {
                 // Properties that are not external get batched with assembly controller
                 LOG_TRACE(Application_impl, "Calling query on assembly controller for property: "
                         << configProperties[i].id);
-                int count = batch[acId].second.length();
-                batch[acId].second.length(count + 1);
-                batch[acId].second[count].id = configProperties[i].id;
-                batch[acId].second[count].value = configProperties[i].value;
+                propId = extId;
+                comp = assemblyController;
+                compId = _assemblyControllerId;
             } else {
                 LOG_ERROR(Application_impl, "Unable to retrieve assembly controller for external property: " << extId);
-                int count = invalidProperties.length();
-                invalidProperties.length(count + 1);
-                invalidProperties[count].id = CORBA::string_dup(extId.c_str());
-                invalidProperties[count].value = configProperties[i].value;
+                ossie::corba::push_back(invalidProperties, configProperties[i]);
+                continue;
+            }
+
+            targets[i] = ComponentPropertyKey(compId, propId);
+            if (isCacheable(extId)) {
+                if (getCachedValue(compId, propId, configProperties[i].value)) {
+                    targets[i] = ComponentPropertyKey();
+                    continue;
+                }
+                cacheable.insert(targets[i]);
+            }
+
+            CF::DataType property;
+            property.id = propId.c_str();
+            property.value = configProperties[i].value;
+            PropertyBatch& batch = batches[compId];
+            batch.component = comp;
+            if (cacheable.count(targets[i])) {
+                batch.cacheComponentId = compId;
             }
+            ossie::corba::push_back(batch.properties, property);
         }
 
-        // -Loop through each component with a property that needs to be queried and make query() call
-        // -Catch any errors
-        for (std::map<std::string, std::pair<CF::Resource_ptr, CF::Properties> >::iterator comp = batch.begin();
-                comp != batch.end(); ++comp) {
-            try {
-                comp->second.first->query(comp->second.second);
-            } catch (CF::UnknownProperties e) {
-                for (unsigned int i = 0; i < e.invalidProperties.length(); ++i) {
-                    // Add invalid properties to return list
-                    int count = invalidProperties.length();
-                    invalidProperties.length(count + 1);
-                    invalidProperties[count].id = CORBA::string_dup(e.invalidProperties[i].id);
-                    invalidProperties[count].value = e.invalidProperties[i].value;
+        for (PropertyBatches::iterator batch = batches.begin(); batch != batches.end(); ++batch) {
+            calls.push_back(&batch->second);
+        }
+        const unsigned long generation = getQueryCacheGeneration();
+        runPropertyBatches(calls, &Application_impl::queryComponentCall);
+
+        // Indexes the returned values by (component, property) and caches them
+        std::map<ComponentPropertyKey, const CORBA::Any*> results;
+        for (PropertyBatches::const_iterator batch = batches.begin(); batch != batches.end(); ++batch) {
+            if (batch->second.error) {
+                batch->second.error->_raise();
+            }
+            for (unsigned int i = 0; i < batch->second.invalidProperties.length(); ++i) {
+                ossie::corba::push_back(invalidProperties, batch->second.invalidProperties[i]);
+            }
+            if (batch->second.invalidProperties.length() > 0) {
+                continue;
+            }
+            const CF::Properties& values = batch->second.properties;
+            for (unsigned int i = 0; i < values.length(); ++i) {
+                const ComponentPropertyKey key(batch->first, std::string(values[i].id));
+                results[key] = &values[i].value;
+                if (cacheable.count(key)) {
+                    cacheValue(key.first, key.second, values[i].value, generation);
                 }
             }
         }
 
-        // Loops through requested property IDs to find value that was returned from internal call
+        // Fills in the requested properties from the returned values
         for (unsigned int i = 0; i < configProperties.length(); ++i) {
-            const std::string extId(configProperties[i].id);
-            std::string propId;
-            std::string compId;
-
-            // Checks if property ID is external or AC property
-            if (_properties.count(extId)) {
-                propId = _properties[extId].id;
-                compId = ossie::corba::returnString(_properties[extId].component->identifier());
-            } else {
-                propId = extId;
-                compId = ossie::corba::returnString(assemblyController->identifier());
+            if (targets[i].first.empty() && targets[i].second.empty()) {
+                continue;
             }
-
-            // Loops through batched query results finding requested property
-            for (std::map<std::string, std::pair<CF::Resource_ptr, CF::Properties> >::const_iterator comp = batch.begin();
-                    comp != batch.end(); ++comp) {
-                for (unsigned int j = 0; j < comp->second.second.length(); ++j) {
-                    const std::string currPropId(comp->second.second[j].id);
-                    if (compId == comp->first && propId == currPropId) {
-                        configProperties[i].value = comp->second.second[j].value;
-                    }
-                }
+            std::map<ComponentPropertyKey, const CORBA::Any*>::const_iterator result = results.find(targets[i]);
+            if (result != results.end()) {
+                configProperties[i].value = *(result->second);
             }
         }
     }
@@ -672,6 +966,199 @@ throw (CF::UnknownProperties, CORBA::SystemException)
             " external and assembly controller properties");
 }
 
+void Application_impl::configureComponentCall(PropertyBatch* batch)
+{
+    const CORBA::ULong count = batch->properties.length();
+    try {
+        batch->component->configure(batch->properties);
+        batch->validCount = count;
+    } catch (const CF::PropertySet::InvalidConfiguration& e) {
+        batch->invalidProperties = e.invalidProperties;
+    } catch (const CF::PropertySet::PartialConfiguration& e) {
+        batch->invalidProperties = e.invalidProperties;
+        batch->validCount = count - e.invalidProperties.length();
+    } catch (const CORBA::SystemException& e) {
+        batch->error.reset(e._NP_duplicate());
+    }
+}
+
+void Application_impl::queryComponentCall(PropertyBatch* batch)
+{
+    // The listener is registered before the query, so that any change after
+    // the values are read is reported
+    if (!batch->cacheComponentId.empty()) {
+        watchCachedProperties(batch->cacheComponentId, batch->component);
+    }
+    try {
+        batch->component->query(batch->properties);
+    } catch (const CF::UnknownProperties& e) {
+        batch->invalidProperties = e.invalidProperties;
+    } catch (const CORBA::SystemException& e) {
+        batch->error.reset(e._NP_duplicate());
+    }
+}
+
+void Application_impl::runPropertyBatches(const std::vector<PropertyBatch*>& batches, PropertyBatchCall call)
+{
+    // A single component is called directly, avoiding a worker thread
+    if (batches.size() == 1) {
+        (this->*call)(batches[0]);
+        return;
+    }
+
+    TaskList tasks;
+    for (std::vector<PropertyBatch*>::const_iterator batch = batches.begin(); batch != batches.end(); ++batch) {
+        tasks.push_back(boost::bind(call, this, *batch));
+    }
+    runTasks(tasks);
+}
+
+boost::posix_time::time_duration Application_impl::getQueryCacheTimeout() const
+{
+    if (!_domainManager) {
+        return boost::posix_time::milliseconds(0);
+    }
+    return boost::posix_time::milliseconds(_domainManager->getApplicationQueryCacheTimeout());
+}
+
+bool Application_impl::isCacheable(const std::string& extId) const
+{
+    // Only readonly external properties are cached; others may be changed
+    // by the component or through another path without the application
+    // knowing
+    std::map<std::string, externalPropertyRecord>::const_iterator external = _properties.find(extId);
+    if (external == _properties.end()) {
+        return false;
+    }
+    return (external->second.access == "readonly");
+}
+
+bool Application_impl::getCachedValue(const std::string& compId, const std::string& propId, CORBA::Any& value)
+{
+    if (getQueryCacheTimeout().total_milliseconds() <= 0) {
+        return false;
+    }
+
+    boost::mutex::scoped_lock lock(_queryCacheLock);
+    std::map<ComponentPropertyKey, CachedValue>::iterator cached = _queryCache.find(ComponentPropertyKey(compId, propId));
+    if (cached == _queryCache.end()) {
+        return false;
+    }
+    if (boost::posix_time::microsec_clock::universal_time() >= cached->second.expires) {
+        _queryCache.erase(cached);
+        return false;
+    }
+    value = cached->second.value;
+    return true;
+}
+
+unsigned long Application_impl::getQueryCacheGeneration()
+{
+    boost::mutex::scoped_lock lock(_queryCacheLock);
+    return _queryCacheGeneration;
+}
+
+void Application_impl::cacheValue(const std::string& compId, const std::string& propId, const CORBA::Any& value,
+                                  unsigned long generation)
+{
+    const boost::posix_time::time_duration timeout = getQueryCacheTimeout();
+    if (timeout.total_milliseconds() <= 0) {
+        return;
+    }
+
+    boost::mutex::scoped_lock lock(_queryCacheLock);
+    // Values changed (or configured) since the query began may be stale, and
+    // values from components that do not report changes are not kept
+    if (generation != _queryCacheGeneration) {
+        return;
+    }
+    std::map<std::string, std::string>::const_iterator registration = _queryCacheRegistrations.find(compId);
+    if ((registration == _queryCacheRegistrations.end()) || registration->second.empty()) {
+        return;
+    }
+    CachedValue& cached = _queryCache[ComponentPropertyKey(compId, propId)];
+    cached.value = value;
+    cached.expires = boost::posix_time::microsec_clock::universal_time() + timeout;
+}
+
+void Application_impl::invalidateCachedValues(const std::string& compId)
+{
+    boost::mutex::scoped_lock lock(_queryCacheLock);
+    ++_queryCacheGeneration;
+    std::map<ComponentPropertyKey, CachedValue>::iterator cached = _queryCache.lower_bound(ComponentPropertyKey(compId, std::string()));
+    while (cached != _queryCache.end() && cached->first.first == compId) {
+        _queryCache.erase(cached++);
+    }
+}
+
+void Application_impl::cachedPropertiesChanged(const std::string& regId, const CF::Properties& changes)
+{
+    boost::mutex::scoped_lock lock(_queryCacheLock);
+    ++_queryCacheGeneration;
+
+    std::string compId;
+    for (std::map<std::string, std::string>::const_iterator registration = _queryCacheRegistrations.begin();
+         registration != _queryCacheRegistrations.end(); ++registration) {
+        if (registration->second == regId) {
+            compId = registration->first;
+            break;
+        }
+    }
+    if (compId.empty()) {
+        // The event arrived before the registration call returned
+        LOG_TRACE(Application_impl, "Discarding all cached query values for unknown registration " << regId);
+        _queryCache.clear();
+        return;
+    }
+
+    for (CORBA::ULong index = 0; index < changes.length(); ++index) {
+        const std::string propId(changes[index].id);
+        LOG_TRACE(Application_impl, "Discarding cached query value " << propId << " for " << compId);
+        _queryCache.erase(ComponentPropertyKey(compId, propId));
+    }
+}
+
+void Application_impl::watchCachedProperties(const std::string& compId, CF::Resource_ptr component)
+{
+    if (getQueryCacheTimeout().total_milliseconds() <= 0) {
+        return;
+    }
+
+    // Only the first query for a component registers; a failed registration
+    // is not retried, and values from that component are not cached
+    {
+        boost::mutex::scoped_lock lock(_queryCacheLock);
+        if (!_queryCacheListener || _queryCacheRegistrations.count(compId)) {
+            return;
+        }
+        _queryCacheRegistrations[compId] = std::string();
+    }
+
+    CF::StringSequence propIds;
+    for (std::map<std::string, externalPropertyRecord>::const_iterator external = _properties.begin();
+         external != _properties.end(); ++external) {
+        if ((getExternalComponentId(external->second) == compId) && isCacheable(external->first)) {
+            ossie::corba::push_back(propIds, external->second.id.c_str());
+        }
+    }
+    if (propIds.length() == 0) {
+        return;
+    }
+
+    std::string regId;
+    try {
+        CF::PropertyChangeListener_var listener = _queryCacheListener->_this();
+        regId = ossie::corba::returnString(component->registerPropertyListener(listener, propIds, QUERY_CACHE_LISTENER_INTERVAL));
+    } catch (const CORBA::Exception& ex) {
+        LOG_DEBUG(Application_impl, "Not caching query values for " << compId << ", unable to register for property changes: "
+                  << ex._name());
+        return;
+    }
+
+    boost::mutex::scoped_lock lock(_queryCacheLock);
+    _queryCacheRegistrations[compId] = regId;
+}
+
 
 char *Application_impl::registerPropertyListener( CORBA::Object_ptr listener, const CF::StringSequence &prop_ids, const CORBA::Float interval)
   throw(CF::UnknownProperties, CF::InvalidObjectReference)
@@ -978,7 +1465,9 @@ throw (CORBA::SystemException, CF::LifeCycle::ReleaseError)
     // search thru all waveform components
     // unload and deallocate capacity
 
-    releaseComponents();
+    // All component teardown shares a single deadline
+    const boost::posix_time::ptime deadline = getTeardownDeadline(boost::posix_time::not_a_date_time);
+    releaseComponents(deadline);
 
     // Search thru all waveform components
     //  - unbind from NS
@@ -1004,8 +1493,8 @@ throw (CORBA::SystemException, CF::LifeCycle::ReleaseError)
         LOG_DEBUG(Application_impl, "Next component")
     }
 
-    terminateComponents();
-    unloadComponents();
+    terminateComponents(deadline);
+    unloadComponents(deadline);
 
     // deallocate capacities
     try {
@@ -1078,73 +1567,126 @@ throw (CORBA::SystemException, CF::LifeCycle::ReleaseError)
   TRACE_EXIT(Application_impl);
 }
 
-void Application_impl::releaseComponents()
+void Application_impl::releaseComponents(boost::posix_time::ptime deadline)
 {
+    deadline = getTeardownDeadline(deadline);
+    const boost::posix_time::ptime start_time = boost::posix_time::microsec_clock::universal_time();
+
+    TaskList tasks;
     for (ossie::ComponentList::iterator ii = _components.begin(); ii != _components.end(); ++ii) {
         if (CORBA::is_nil(ii->componentObject)) {
             // Ignore components that never registered
             continue;
         }
-
-        LOG_DEBUG(Application_impl, "Releasing component '" << ii->identifier << "'");
-        try {
-            CF::Resource_var resource = CF::Resource::_narrow(ii->componentObject);
-            unsigned long timeout = 3; // seconds
-            omniORB::setClientCallTimeout(resource, timeout * 1000);
-            resource->releaseObject();
-        } CATCH_LOG_WARN(Application_impl, "releaseObject failed for component '" << ii->identifier << "'");
+        tasks.push_back(boost::bind(&Application_impl::releaseComponent, this, &(*ii), deadline));
     }
+
+    // Every component is asked to release; once the deadline has passed the
+    // remaining calls use the minimum timeout
+    runTasks(tasks);
+    LOG_INFO(Application_impl, "Teardown timing for " << _identifier << ": released "
+             << tasks.size() << " component(s) in " << elapsedMillis(start_time) << " ms");
 }
 
-void Application_impl::terminateComponents()
+void Application_impl::releaseComponent(const ossie::ApplicationComponent* component,
+                                        const boost::posix_time::ptime& deadline)
 {
-    // Terminate any components that were executed on devices
+    LOG_DEBUG(Application_impl, "Releasing component '" << component->identifier << "'");
+    try {
+        CF::Resource_var resource = CF::Resource::_narrow(component->componentObject);
+        omniORB::setClientCallTimeout(resource, getTeardownCallTimeout(deadline, RELEASE_CALL_TIMEOUT));
+        resource->releaseObject();
+    } CATCH_LOG_WARN(Application_impl, "releaseObject failed for component '" << component->identifier << "'");
+}
+
+void Application_impl::terminateComponents(boost::posix_time::ptime deadline)
+{
+    deadline = getTeardownDeadline(deadline);
+    const boost::posix_time::ptime start_time = boost::posix_time::microsec_clock::universal_time();
+
+    // Terminate any components that were executed on devices; every process
+    // is terminated, even once the deadline has passed
+    TaskList tasks;
     for (ossie::ComponentList::iterator ii = _components.begin(); ii != _components.end(); ++ii) {
-        const unsigned long pid = ii->processId;
-        if (pid == 0) {
+        if (ii->processId == 0) {
             continue;
         }
+        tasks.push_back(boost::bind(&Application_impl::terminateComponent, this, &(*ii), deadline));
+    }
+    runTasks(tasks);
+    LOG_INFO(Application_impl, "Teardown timing for " << _identifier << ": terminated "
+             << tasks.size() << " component(s) in " << elapsedMillis(start_time) << " ms");
+}
 
-        LOG_DEBUG(Application_impl, "Terminating component '" << ii->identifier << "' pid " << pid);
+void Application_impl::terminateComponent(const ossie::ApplicationComponent* component,
+                                          const boost::posix_time::ptime& deadline)
+{
+    const unsigned long pid = component->processId;
+    LOG_DEBUG(Application_impl, "Terminating component '" << component->identifier << "' pid " << pid);
 
-        CF::ExecutableDevice_var device = ossie::corba::_narrowSafe<CF::ExecutableDevice>(ii->assignedDevice);
-        if (CORBA::is_nil(device)) {
-            LOG_WARN(Application_impl, "Cannot find device to terminate component " << ii->identifier);
-        } else {
-            try {
-                device->terminate(ii->processId);
-            } CATCH_LOG_WARN(Application_impl, "Unable to terminate process " << pid);
-        }
+    CF::ExecutableDevice_var device = getDeviceReference<CF::ExecutableDevice>(component);
+    if (CORBA::is_nil(device)) {
+        LOG_WARN(Application_impl, "Cannot find device to terminate component " << component->identifier);
+    } else {
+        try {
+            omniORB::setClientCallTimeout(device, getTeardownCallTimeout(deadline));
+            device->terminate(pid);
+        } CATCH_LOG_WARN(Application_impl, "Unable to terminate process " << pid);
     }
 }
 
-void Application_impl::unloadComponents()
+void Application_impl::unloadComponents(boost::posix_time::ptime deadline)
 {
-    // Terminate any components that were executed on devices
+    deadline = getTeardownDeadline(deadline);
+    const boost::posix_time::ptime start_time = boost::posix_time::microsec_clock::universal_time();
+
+    // Unload the files for any components that were loaded on devices
+    TaskList tasks;
     for (ossie::ComponentList::iterator ii = _components.begin(); ii != _components.end(); ++ii) {
         if (ii->loadedFiles.empty()) {
             continue;
         }
+        tasks.push_back(boost::bind(&Application_impl::unloadComponent, this, &(*ii), deadline));
+    }
+    runTasks(tasks);
+    LOG_INFO(Application_impl, "Teardown timing for " << _identifier << ": unloaded files for "
+             << tasks.size() << " component(s) in " << elapsedMillis(start_time) << " ms");
+}
 
-        LOG_DEBUG(Application_impl, "Unloading " << ii->loadedFiles.size() << " file(s) for component '"
-                  << ii->identifier << "'");
-        
-        CF::LoadableDevice_var device = ossie::corba::_narrowSafe<CF::LoadableDevice>(ii->assignedDevice);
-        if (CORBA::is_nil(device)) {
-            LOG_WARN(Application_impl, "Cannot find device to unload files for component " << ii->identifier);
-            continue;
-        }
+void Application_impl::unloadComponent(const ossie::ApplicationComponent* component,
+                                       const boost::posix_time::ptime& deadline)
+{
+    LOG_DEBUG(Application_impl, "Unloading " << component->loadedFiles.size() << " file(s) for component '"
+              << component->identifier << "'");
 
-        for (std::vector<std::string>::iterator file = ii->loadedFiles.begin(); file != ii->loadedFiles.end();
-             ++file) {
-            LOG_TRACE(Application_impl, "Unloading file " << *file);
-            try {
-                device->unload(file->c_str());
-            } CATCH_LOG_WARN(Application_impl, "Unable to unload file " << *file);
-        }
+    CF::LoadableDevice_var device = getDeviceReference<CF::LoadableDevice>(component);
+    if (CORBA::is_nil(device)) {
+        LOG_WARN(Application_impl, "Cannot find device to unload files for component " << component->identifier);
+        return;
+    }
+
+    for (std::vector<std::string>::const_iterator file = component->loadedFiles.begin();
+         file != component->loadedFiles.end(); ++file) {
+        LOG_TRACE(Application_impl, "Unloading file " << *file);
+        try {
+            omniORB::setClientCallTimeout(device, getTeardownCallTimeout(deadline));
+            device->unload(file->c_str());
+        } CATCH_LOG_WARN(Application_impl, "Unable to unload file " << *file);
     }
 }
 
+boost::posix_time::ptime Application_impl::getTeardownDeadline(const boost::posix_time::ptime& deadline) const
+{
+    if (!deadline.is_not_a_date_time()) {
+        return deadline;
+    }
+    unsigned long timeout = DomainManager_impl::DEFAULT_APPLICATION_TEARDOWN_TIMEOUT;
+    if (_domainManager) {
+        timeout = _domainManager->getApplicationTeardownTimeout();
+    }
+    return boost::posix_time::microsec_clock::universal_time() + boost::posix_time::seconds(timeout);
+}
+
 void Application_impl::_cleanupActivations()
 {
     // Use the existance of the application registry as a sentinel for whether
@@ -1170,6 +1712,13 @@ void Application_impl::_cleanupActivations()
         _fakeProxy = 0;
     }
 
+    // The query cache listener; the components' registrations go away with
+    // the components
+    oid = app_poa->servant_to_id(_queryCacheListener);
+    app_poa->deactivate_object(oid);
+    _queryCacheListener->_remove_ref();
+    _queryCacheListener = 0;
+
     // Release this application
     oid = app_poa->servant_to_id(this);
     app_poa->deactivate_object(oid);
@@ -1312,8 +1861,20 @@ void Application_impl::addExternalProperty (const std::string& propId, const std
         throw std::runtime_error("External Property name " + externalId + " is already in use");
     }
 
-    externalPropertyRecord external(propId, access, CF::Resource::_duplicate(comp));
+    // Record the component's identifier up front, so that batching and
+    // result mapping do not need a remote call per property
+    std::string compId;
+    try {
+        compId = ossie::corba::returnString(comp->identifier());
+    } catch (...) {
+        LOG_WARN(Application_impl, "Unable to retrieve identifier of component for external property: " << externalId);
+    }
+
+    externalPropertyRecord external(propId, access, comp, compId);
     _properties.insert(std::pair<std::string, externalPropertyRecord>(externalId, external));
+    if (!compId.empty()) {
+        _externalPropertyIds[ComponentPropertyKey(compId, propId)] = externalId;
+    }
 }
 
 bool Application_impl::checkConnectionDependency (Endpoint::DependencyType type, const std::string& identifier) const
@@ -1403,24 +1964,25 @@ void Application_impl::registerComponent (CF::Resource_ptr resource)
     _registrationCondition.notify_all();
 }
 
-std::string Application_impl::getExternalPropertyId(std::string compIdIn, std::string propIdIn)
+std::string Application_impl::getExternalPropertyId(const std::string& compId, const std::string& propId) const
 {
-    for (std::map<std::string, externalPropertyRecord>::const_iterator prop = _properties.begin();
-            prop != _properties.end(); ++prop) {
-        // Gets the property mapping info
-        std::string extId = prop->first;
-        std::string propId = prop->second.id;
-        // Gets the Resource identifier
-        std::string compId = ossie::corba::returnString(prop->second.component->identifier());
-
-        if (compId == compIdIn && propId == propIdIn) {
-            return extId;
-        }
+    std::map<ComponentPropertyKey, std::string>::const_iterator extId = _externalPropertyIds.find(ComponentPropertyKey(compId, propId));
+    if (extId != _externalPropertyIds.end()) {
+        return extId->second;
     }
-
     return "";
 }
 
+std::string Application_impl::getExternalComponentId(const externalPropertyRecord& record) const
+{
+    // The identifier is recorded when the external property is added; fall
+    // back to asking the component if it could not be retrieved then
+    if (!record.componentId.empty()) {
+        return record.componentId;
+    }
+    return ossie::corba::returnString(record.component->identifier());
+}
+
 ossie::ApplicationComponent* Application_impl::findComponent(const std::string& identifier)
 {
     for (ossie::ComponentList::iterator ii = _components.begin(); ii != _components.end(); ++ii) {
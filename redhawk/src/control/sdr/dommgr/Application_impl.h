@@ -26,7 +26,9 @@
 #include <map>
 #include <set>
 
+#include <boost/shared_ptr.hpp>
 #include <boost/thread/condition_variable.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
 
 #include <ossie/CF/cf.h>
 #include <ossie/debug.h>
@@ -58,7 +60,8 @@ public:
                               std::vector<ossie::DeviceAssignmentInfo>& _devSequence,
                               std::vector<CF::Resource_var> _startSeq,
                               std::vector<ossie::ConnectionNode>& connections,
-                              std::vector<std::string> allocationIDs);
+                              std::vector<std::string> allocationIDs,
+                              const std::vector<int>& startOrders=std::vector<int>());
 
     ~Application_impl ();
 
@@ -149,9 +152,12 @@ public:
     void setComponentDevice(const std::string& identifier, CF::Device_ptr device);
     void addComponentLoadedFile(const std::string& identifier, const std::string& fileName);
 
-    void releaseComponents();
-    void terminateComponents();
-    void unloadComponents();
+    // Teardown of the application's components; calls are made in parallel,
+    // with timeouts bounded by the time remaining before the deadline (by
+    // default, the domain's APPLICATION_TEARDOWN_TIMEOUT from now)
+    void releaseComponents(boost::posix_time::ptime deadline=boost::posix_time::not_a_date_time);
+    void terminateComponents(boost::posix_time::ptime deadline=boost::posix_time::not_a_date_time);
+    void unloadComponents(boost::posix_time::ptime deadline=boost::posix_time::not_a_date_time);
 
     bool waitForComponents(std::set<std::string>& identifiers, int timeout);
 
@@ -164,13 +170,16 @@ public:
         std::string id;
         std::string access;
         CF::Resource_var component;
+        std::string componentId;
 
         externalPropertyRecord() {};
 
-        externalPropertyRecord(const std::string &_id, const std::string &_access, CF::Resource_ptr _component) {
+        externalPropertyRecord(const std::string &_id, const std::string &_access, CF::Resource_ptr _component,
+                               const std::string &_componentId=std::string()) {
             id = _id;
             access = _access;
             component = CF::Resource::_duplicate(_component);
+            componentId = _componentId;
         };
     };
 
@@ -194,6 +203,74 @@ private:
 
     bool stopComponent(CF::Resource_ptr component);
 
+    // Outcome of a start or stop call made on a worker thread
+    struct CallResult {
+        CallResult() : failed(false), errorNumber(CF::CF_NOTSET) {};
+        bool failed;
+        CF::ErrorNumberType errorNumber;
+        std::string message;
+    };
+
+    // Ranges [first, last) of _appStartSeq that share the same start order
+    typedef std::vector< std::pair<size_t, size_t> > StartGroups;
+    StartGroups getStartGroups() const;
+
+    void startComponentCall(CF::Resource_ptr component, CallResult* result);
+    void stopComponentCall(CF::Resource_ptr component, CallResult* result);
+
+    // Properties sent to one component in a single configure or query call,
+    // and the outcome of that call, which may be made on a worker thread
+    struct PropertyBatch {
+        PropertyBatch() : component(CF::Resource::_nil()), validCount(0) {};
+        CF::Resource_ptr component;
+        // Set when query results for the component are to be cached
+        std::string cacheComponentId;
+        CF::Properties properties;
+        CF::Properties invalidProperties;
+        CORBA::ULong validCount;
+        boost::shared_ptr<CORBA::Exception> error;
+    };
+    typedef std::map<std::string, PropertyBatch> PropertyBatches;
+    typedef void (Application_impl::*PropertyBatchCall)(PropertyBatch*);
+
+    void configureComponentCall(PropertyBatch* batch);
+    void queryComponentCall(PropertyBatch* batch);
+    void runPropertyBatches(const std::vector<PropertyBatch*>& batches, PropertyBatchCall call);
+
+    // Identifier of the component that holds an external property
+    std::string getExternalComponentId(const externalPropertyRecord& record) const;
+
+    // Cache of queried readonly external property values, keyed by
+    // (component id, property id). Values are only cached for components
+    // that accepted a property change listener for them, and a change event
+    // discards the changed values; entries also expire after the
+    // DomainManager's APPLICATION_QUERY_CACHE_TIMEOUT
+    struct CachedValue {
+        CORBA::Any value;
+        boost::posix_time::ptime expires;
+    };
+    typedef std::pair<std::string, std::string> ComponentPropertyKey;
+    class QueryCacheListener;
+    friend class QueryCacheListener;
+    boost::posix_time::time_duration getQueryCacheTimeout() const;
+    bool isCacheable(const std::string& extId) const;
+    bool getCachedValue(const std::string& compId, const std::string& propId, CORBA::Any& value);
+    // The generation changes whenever cached values are discarded; a value
+    // is only cached if the generation is still the one read before the
+    // query was made
+    unsigned long getQueryCacheGeneration();
+    void cacheValue(const std::string& compId, const std::string& propId, const CORBA::Any& value,
+                    unsigned long generation);
+    void invalidateCachedValues(const std::string& compId);
+    void cachedPropertiesChanged(const std::string& regId, const CF::Properties& changes);
+    void watchCachedProperties(const std::string& compId, CF::Resource_ptr component);
+
+    void releaseComponent(const ossie::ApplicationComponent* component, const boost::posix_time::ptime& deadline);
+    void terminateComponent(const ossie::ApplicationComponent* component, const boost::posix_time::ptime& deadline);
+    void unloadComponent(const ossie::ApplicationComponent* component, const boost::posix_time::ptime& deadline);
+
+    boost::posix_time::ptime getTeardownDeadline(const boost::posix_time::ptime& deadline) const;
+
     bool _checkRegistrations(std::set<std::string>& identifiers);
 
     const std::string _identifier;
@@ -202,6 +279,7 @@ private:
     std::vector<ossie::DeviceAssignmentInfo> _componentDevices;
     std::vector<ossie::ConnectionNode> _connections;
     std::vector<CF::Resource_var> _appStartSeq;
+    std::vector<int> _appStartOrders;
     std::vector<std::string> _allocationIDs;
     DomainManager_impl* _domainManager;
     const std::string _waveformContextName;
@@ -220,6 +298,17 @@ private:
 
     std::map<std::string, CORBA::Object_var> _ports;
     std::map<std::string, externalPropertyRecord> _properties;
+    std::map<ComponentPropertyKey, std::string> _externalPropertyIds;
+    std::string _assemblyControllerId;
+
+    std::map<ComponentPropertyKey, CachedValue> _queryCache;
+    unsigned long _queryCacheGeneration;
+    // Listener registration id for each component that has been asked to
+    // report changes to its cached properties; empty while the registration
+    // is being made, or if the component refused it
+    std::map<std::string, std::string> _queryCacheRegistrations;
+    boost::mutex _queryCacheLock;
+    QueryCacheListener* _queryCacheListener;
 
     bool _releaseAlreadyCalled;
     boost::mutex releaseObjectLock;
@@ -230,7 +319,7 @@ private:
 
     // Returns externalpropid if one exists based off of compId and
     // internal propId, returns empty string if no external prop exists
-    std::string getExternalPropertyId(std::string compId, std::string propId);
+    std::string getExternalPropertyId(const std::string& compId, const std::string& propId) const;
 
 
     friend class ApplicationRegistrar_impl;
@@ -68,6 +68,8 @@ static const ComponentInstantiation* findComponentInstantiation (const std::vect
 
 PREPARE_CF_LOGGING(DomainManager_impl)
 
+const unsigned long DomainManager_impl::DEFAULT_APPLICATION_TEARDOWN_TIMEOUT;
+
 // If _overrideDomainName == NULL read the domain name from the DMD file
 DomainManager_impl::DomainManager_impl (const char* dmdFile, const char* _rootpath, const char* domainName, 
 					const char *db_uri,
@@ -95,6 +97,12 @@ DomainManager_impl::DomainManager_impl (const char* dmdFile, const char* _rootpa
     addProperty(componentBindingTimeout, 60, "COMPONENT_BINDING_TIMEOUT", "component_binding_timeout",
                 "readwrite", "seconds", "external", "configure");
 
+    addProperty(applicationTeardownTimeout, DEFAULT_APPLICATION_TEARDOWN_TIMEOUT, "APPLICATION_TEARDOWN_TIMEOUT",
+                "application_teardown_timeout", "readwrite", "seconds", "external", "configure");
+
+    addProperty(applicationQueryCacheTimeout, 0, "APPLICATION_QUERY_CACHE_TIMEOUT",
+                "application_query_cache_timeout", "readwrite", "milliseconds", "external", "configure");
+
     addProperty(redhawk_version, VERSION, "REDHAWK_VERSION", "redhawk_version",
                 "readonly", "", "external", "configure");
 
@@ -379,7 +387,7 @@ void DomainManager_impl::restoreState(const std::string& _db_uri) {
                 LOG_INFO(DomainManager_impl, "Recovered connection to Service: " << ii->name);
                 ossie::DeviceManagerList::iterator deviceManager = findDeviceManagerById(ii->deviceManagerId);
                 if (deviceManager != _registeredDeviceManagers.end()) {
-                    storeServiceInDomainMgr(ii->service, deviceManager->deviceManager, ii->name.c_str(), ii->serviceId.c_str());
+                    storeServiceInDomainMgr(ii->service, deviceManager->identifier, ii->name.c_str(), ii->serviceId.c_str());
                 } else {
                     LOG_WARN(DomainManager_impl, "Failed to recover connection to Service: " << ii->name << ": DeviceManager "
                              << ii->deviceManagerId << " no longer exists");
@@ -631,16 +639,16 @@ void DomainManager_impl::shutdownAllDeviceManagers()
         } catch ( std::exception& ex ) {
             LOG_ERROR(DomainManager_impl, "The following standard exception occurred: "<<ex.what()<<" while attempting to shutdown a DeviceManager : " << dm_label << ", continuing shutdown process.");
             if (lenRegDevMgr == _registeredDeviceManagers.size()) {
-                _registeredDeviceManagers.erase(_registeredDeviceManagers.begin());
+                eraseDeviceManagerNode(_registeredDeviceManagers.begin());
             }
         } catch( const CORBA::Exception& e ) {
             LOG_ERROR(DomainManager_impl, "DeviceManager: " << dm_label << " failed shutdown, continuing shutdown process. Exception: " << e._name());
             if (lenRegDevMgr == _registeredDeviceManagers.size()) {
-                _registeredDeviceManagers.erase(_registeredDeviceManagers.begin());
+                eraseDeviceManagerNode(_registeredDeviceManagers.begin());
             }
         } catch ( ... ) {
             if (lenRegDevMgr == _registeredDeviceManagers.size()) {
-                _registeredDeviceManagers.erase(_registeredDeviceManagers.begin());
+                eraseDeviceManagerNode(_registeredDeviceManagers.begin());
             }
             LOG_ERROR(DomainManager_impl, "Error shutting down Device Manager: " << dm_label << ", an unknown exception occurred." );
         }
@@ -1005,7 +1013,10 @@ DomainManager_impl::registerDeviceManager (CF::DeviceManager_ptr deviceMgr)
 throw (CORBA::SystemException, CF::InvalidObjectReference, CF::InvalidProfile,
        CF::DomainManager::RegisterError)
 {
-    boost::mutex::scoped_lock lock(interfaceAccess);
+    // Registration does not hold interfaceAccess; the remote calls to the
+    // DeviceManager are made without any lock and the domain state is only
+    // locked to commit the registration, so that many nodes can register at
+    // once without blocking each other or other domain calls
     ossie::corba::overrideBlockingCall(deviceMgr,getManagerWaitTime());
     _local_registerDeviceManager(deviceMgr);
 
@@ -1017,66 +1028,89 @@ throw (CORBA::SystemException, CF::InvalidObjectReference, CF::InvalidProfile,
 void DomainManager_impl::_local_registerDeviceManager (CF::DeviceManager_ptr deviceMgr)
 {
     TRACE_ENTER(DomainManager_impl)
-    boost::recursive_mutex::scoped_lock lock(stateAccess);
 
     if (CORBA::is_nil (deviceMgr)) {
         throw (CF::InvalidObjectReference("Cannot register DeviceManager. It is a nil reference."));
     }
 
+    DeviceManagerNode node;
+    node.deviceManager = CF::DeviceManager::_duplicate(deviceMgr);
+    node.identifier = ossie::corba::returnString(deviceMgr->identifier());
+    node.label = ossie::corba::returnString(deviceMgr->label());
+    const std::string& identifier = node.identifier;
+
     // Per the specification two conditions can arise if the device manager is already registered
     //  1. If the registered device manager refers to an existing object:
     //        - Return without exception and NOT register a new device manager
     //  2. The registered device manager refers to a non-existent object
     //        - Register the new deviceMgr
-    std::string identifier = ossie::corba::returnString(deviceMgr->identifier());
-
-    DeviceManagerList::iterator node = findDeviceManagerById(identifier);
-    if (node != _registeredDeviceManagers.end()) {
-        if (!ossie::corba::objectExists(node->deviceManager)) {
+    CF::DeviceManager_var registered;
+    {
+        boost::recursive_mutex::scoped_lock lock(stateAccess);
+        DeviceManagerList::iterator existing = findDeviceManagerById(identifier);
+        if (existing != _registeredDeviceManagers.end()) {
+            registered = CF::DeviceManager::_duplicate(existing->deviceManager);
+        }
+    }
+    if (!CORBA::is_nil(registered)) {
+        if (ossie::corba::objectExists(registered)) {
+            // The registering DeviceManager answered above, so both are alive
+            ostringstream eout;
+            eout << "Attempt re-register existing device manager: " << identifier;
+            LOG_ERROR(DomainManager_impl, eout.str());
+            throw CF::DomainManager::RegisterError(CF::CF_NOTSET, eout.str().c_str());
+        }
+        boost::recursive_mutex::scoped_lock lock(stateAccess);
+        DeviceManagerList::iterator existing = findDeviceManagerById(identifier);
+        if ((existing != _registeredDeviceManagers.end()) && (existing->deviceManager->_is_equivalent(registered))) {
             LOG_WARN(DomainManager_impl, "Cleaning up registration of dead device manager: " << identifier);
-            catastrophicUnregisterDeviceManager(node);
+            catastrophicUnregisterDeviceManager(existing);
             LOG_TRACE(DomainManager_impl, "Continuing with registration of new device manager: " << identifier);
-        } else {
-            bool DevMgr_alive = false;
-            try {
-                CORBA::String_var identifier = deviceMgr->identifier();
-                DevMgr_alive = true;
-            } catch ( ... ) {
-                LOG_WARN(DomainManager_impl, "Cleaning up registration of dead device manager: " << identifier);
-                catastrophicUnregisterDeviceManager(node);
-                LOG_TRACE(DomainManager_impl, "Continuing with registration of new device manager: " << identifier);
-            }
-            if (DevMgr_alive) {
-                ostringstream eout;
-                eout << "Attempt re-register existing device manager: " << identifier;
-                LOG_ERROR(DomainManager_impl, eout.str());
-                throw CF::DomainManager::RegisterError(CF::CF_NOTSET, eout.str().c_str());
-            }
         }
     }
 
-    addDeviceMgr (deviceMgr);
-
-    CORBA::String_var devMgrLabel;
+    // Read the DCD before committing the registration
+    CF::FileSystem_var devMgrFileSys;
+    DeviceManagerConfiguration dcdParser;
     try {
-        mountDeviceMgrFileSys(deviceMgr);
-
         LOG_TRACE(DomainManager_impl, "Getting connections from DeviceManager DCD");
-        DeviceManagerConfiguration dcdParser;
-        try {
-            CF::FileSystem_var devMgrFileSys = deviceMgr->fileSys();
-            CORBA::String_var profile = deviceMgr->deviceConfigurationProfile();
-            File_stream dcd(devMgrFileSys, profile);
-            dcdParser.load(dcd);
-            dcd.close();
-        } catch ( ossie::parser_error& e ) {
-            std::string parser_error_line = ossie::retrieveParserErrorLineNumber(e.what());
-            LOG_ERROR(DomainManager_impl, "Failed device manager registration; error parsing device manager DCD: " << deviceMgr->deviceConfigurationProfile() << ". " << parser_error_line << " The XML parser returned the following error: " << e.what())
-            throw(CF::DomainManager::RegisterError());
-        }
+        devMgrFileSys = deviceMgr->fileSys();
+        CORBA::String_var profile = deviceMgr->deviceConfigurationProfile();
+        File_stream dcd(devMgrFileSys, profile);
+        dcdParser.load(dcd);
+        dcd.close();
+    } catch ( ossie::parser_error& e ) {
+        std::string parser_error_line = ossie::retrieveParserErrorLineNumber(e.what());
+        LOG_ERROR(DomainManager_impl, "Failed device manager registration; error parsing device manager DCD: " << deviceMgr->deviceConfigurationProfile() << ". " << parser_error_line << " The XML parser returned the following error: " << e.what())
+        throw(CF::DomainManager::RegisterError());
+    } catch ( std::exception& ex ) {
+        std::ostringstream eout;
+        eout << "The following standard exception occurred: "<<ex.what()<<" while recovering the change to device manager connections";
+        LOG_ERROR(DomainManager_impl, eout.str())
+        throw CF::DomainManager::RegisterError(CF::CF_NOTSET, eout.str().c_str());
+    } catch ( CORBA::Exception& ex ) {
+        std::ostringstream eout;
+        eout << "The following CORBA exception occurred: "<<ex._name()<<" while recovering the change to device manager connections";
+        LOG_ERROR(DomainManager_impl, eout.str())
+        throw CF::DomainManager::RegisterError(CF::CF_NOTSET, eout.str().c_str());
+    }
 
-        const std::vector<Connection>& connections = dcdParser.getConnections();
+    // Commit the registration, mount the file system and add the DCD connections
+    boost::recursive_mutex::scoped_lock lock(stateAccess);
+    if (!addDeviceMgr(node)) {
+        // Another registration with the same identifier completed first
+        ostringstream eout;
+        eout << "Attempt re-register existing device manager: " << identifier;
+        LOG_ERROR(DomainManager_impl, eout.str());
+        throw CF::DomainManager::RegisterError(CF::CF_NOTSET, eout.str().c_str());
+    }
+
+    try {
+        std::string mountPoint = "/" + node.label;
+        LOG_TRACE(DomainManager_impl, "Mounting DeviceManager FileSystem at " << mountPoint)
+        _fileMgr->mount(mountPoint.c_str(), devMgrFileSys);
 
+        const std::vector<Connection>& connections = dcdParser.getConnections();
         for (size_t ii = 0; ii < connections.size(); ++ii) {
             try {
                 _connectionManager.addConnection(dcdParser.getName(), connections[ii]);
@@ -1113,27 +1147,39 @@ void DomainManager_impl::_local_registerDeviceManager (CF::DeviceManager_ptr dev
 
 void
 DomainManager_impl::addDeviceMgr (CF::DeviceManager_ptr deviceMgr)
+{
+    TRACE_ENTER(DomainManager_impl)
+
+    DeviceManagerNode node;
+    node.deviceManager = CF::DeviceManager::_duplicate(deviceMgr);
+    node.identifier = ossie::corba::returnString(deviceMgr->identifier());
+    node.label = ossie::corba::returnString(deviceMgr->label());
+    addDeviceMgr(node);
+
+    TRACE_EXIT(DomainManager_impl)
+}
+
+bool
+DomainManager_impl::addDeviceMgr (const ossie::DeviceManagerNode& node)
 {
     TRACE_ENTER(DomainManager_impl)
     boost::recursive_mutex::scoped_lock lock(stateAccess);
 
-    if (!deviceMgrIsRegistered (deviceMgr)) {
-        LOG_TRACE(DomainManager_impl, "Adding DeviceManager ref to list")
-        DeviceManagerNode tmp_devMgr;
-        CORBA::String_var identifier = deviceMgr->identifier();
-        CORBA::String_var label = deviceMgr->label();
-        tmp_devMgr.deviceManager = CF::DeviceManager::_duplicate(deviceMgr);
-        tmp_devMgr.identifier = static_cast<char*>(identifier);
-        tmp_devMgr.label = static_cast<char*>(label);
-        _registeredDeviceManagers.push_back(tmp_devMgr);
+    if (findDeviceManagerById(node.identifier) != _registeredDeviceManagers.end()) {
+        TRACE_EXIT(DomainManager_impl)
+        return false;
+    }
 
-        try {
-            db.store("DEVICE_MANAGERS", _registeredDeviceManagers);
-        } catch (const ossie::PersistenceException& ex) {
-            LOG_ERROR(DomainManager_impl, "Error persisting change to device managers");
-        }
+    LOG_TRACE(DomainManager_impl, "Adding DeviceManager ref to list")
+    addDeviceManagerNode(node);
+
+    try {
+        db.store("DEVICE_MANAGERS", _registeredDeviceManagers);
+    } catch (const ossie::PersistenceException& ex) {
+        LOG_ERROR(DomainManager_impl, "Error persisting change to device managers");
     }
     TRACE_EXIT(DomainManager_impl)
+    return true;
 }
 
 void DomainManager_impl::addDomainMgr (CF::DomainManager_ptr domainMgr)
@@ -1182,24 +1228,33 @@ throw (CORBA::SystemException, CF::InvalidObjectReference,
         throw CF::InvalidObjectReference("Cannot unregister nil DeviceManager");
     }
 
-    DeviceManagerList::iterator devMgrIter = findDeviceManagerByObject(deviceMgr);
-    if (devMgrIter == _registeredDeviceManagers.end()) {
-        LOG_WARN(DomainManager_impl, "Ignoring attempt to unregister device manager that was not registered with this domain");
-        return;
-    }
+    // The lookup, its checks and the removal are made under a single lock, so
+    // that a concurrent registration or unregistration cannot invalidate the
+    // iterator in between
+    const std::string lookupId = lookupDeviceManagerIdentifier(deviceMgr);
+    std::string identifier;
+    std::string label;
+    {
+        boost::recursive_mutex::scoped_lock state(stateAccess);
+        DeviceManagerList::iterator devMgrIter = findDeviceManagerByObject(deviceMgr, lookupId);
+        if (devMgrIter == _registeredDeviceManagers.end()) {
+            LOG_WARN(DomainManager_impl, "Ignoring attempt to unregister device manager that was not registered with this domain");
+            return;
+        }
 
-    if (!devMgrIter->deviceManager->_is_equivalent(deviceMgr)) {
-        LOG_TRACE(DomainManager_impl, "Ignoring attempt to unregister device manager with same identifier but different object");
-        return;
-    }
+        if (!devMgrIter->deviceManager->_is_equivalent(deviceMgr)) {
+            LOG_TRACE(DomainManager_impl, "Ignoring attempt to unregister device manager with same identifier but different object");
+            return;
+        }
 
-    // Save the identifier and label, as the iterator will be invalidated.
-    const std::string identifier = devMgrIter->identifier;
-    const std::string label = devMgrIter->label;
+        // Save the identifier and label, as the iterator will be invalidated.
+        identifier = devMgrIter->identifier;
+        label = devMgrIter->label;
 
-    try {
-        _local_unregisterDeviceManager(devMgrIter);
-    } CATCH_LOG_ERROR(DomainManager_impl, "Exception unregistering device manager");
+        try {
+            _local_unregisterDeviceManager(devMgrIter);
+        } CATCH_LOG_ERROR(DomainManager_impl, "Exception unregistering device manager");
+    }
 
     sendRemoveEvent( _identifier.c_str(), identifier.c_str(), label.c_str(), StandardEvent::DEVICE_MANAGER );
 }
@@ -1294,7 +1349,7 @@ ossie::DeviceManagerList::iterator DomainManager_impl::removeDeviceManager (ossi
     TRACE_ENTER(DomainManager_impl)
     boost::recursive_mutex::scoped_lock lock(stateAccess);
 
-    deviceManager = _registeredDeviceManagers.erase(deviceManager);
+    deviceManager = eraseDeviceManagerNode(deviceManager);
     try {
         db.store("DEVICE_MANAGERS", _registeredDeviceManagers);
     } catch (const ossie::PersistenceException& ex) {
@@ -1312,7 +1367,8 @@ throw (CORBA::SystemException, CF::InvalidObjectReference, CF::InvalidProfile,
        CF::DomainManager::DeviceManagerNotRegistered,
        CF::DomainManager::RegisterError)
 {
-    boost::mutex::scoped_lock lock(interfaceAccess);
+    // Like registerDeviceManager, device registration does not hold
+    // interfaceAccess and only locks the domain state to commit
     ossie::corba::overrideBlockingCall(registeringDevice,getDeviceWaitTime());
     ossie::corba::overrideBlockingCall(registeredDeviceMgr,getManagerWaitTime());
     _local_registerDevice(registeringDevice, registeredDeviceMgr);
@@ -1326,7 +1382,6 @@ void DomainManager_impl::_local_registerDevice (CF::Device_ptr registeringDevice
                                                 CF::DeviceManager_ptr registeredDeviceMgr)
 {
     TRACE_ENTER(DomainManager_impl)
-    boost::recursive_mutex::scoped_lock lock(stateAccess);
 
     //Verify they are not a nil reference
     if (CORBA::is_nil (registeringDevice)
@@ -1340,27 +1395,55 @@ void DomainManager_impl::_local_registerDevice (CF::Device_ptr registeringDevice
         throw CF::DomainManager::DeviceManagerNotRegistered ();
     }
 
-    std::string devId = ossie::corba::returnString(registeringDevice->identifier());
+    // Gather the device's attributes and profile
+    boost::shared_ptr<DeviceNode> newDeviceNode = gatherDeviceInfo(registeringDevice, registeredDeviceMgr);
+    if (!newDeviceNode) {
+        return;
+    }
+    const std::string devId = newDeviceNode->identifier;
     LOG_TRACE(DomainManager_impl, "Registering Device " << devId);
 
-    DeviceList::iterator deviceNode = findDeviceById(devId);
-    if (deviceNode != _registeredDevices.end()) {
+    CF::Device_var registered;
+    {
+        boost::recursive_mutex::scoped_lock lock(stateAccess);
+        DeviceList::iterator deviceNode = findDeviceById(devId);
+        if (deviceNode != _registeredDevices.end()) {
+            registered = CF::Device::_duplicate((*deviceNode)->device);
+        }
+    }
+    if (!CORBA::is_nil(registered)) {
         LOG_TRACE(DomainManager_impl, "Device <" << devId << "> already registered; checking existence");
-        if (!ossie::corba::objectExists((*deviceNode)->device)) {
-            LOG_WARN(DomainManager_impl, "Cleaning up registration; device <" << devId << "> is registered and no longer exists");
-            try {
-                _local_unregisterDevice(deviceNode);
-            } CATCH_LOG_WARN(DomainManager_impl, "_local_unregisterDevice failed");
-        } else {
+        if (ossie::corba::objectExists(registered)) {
             ostringstream eout;
             eout << "Attempt re-register existing device : " << devId;
             LOG_ERROR(DomainManager_impl, eout.str());
             throw CF::DomainManager::RegisterError(CF::CF_NOTSET, eout.str().c_str());
         }
+        boost::recursive_mutex::scoped_lock lock(stateAccess);
+        DeviceList::iterator deviceNode = findDeviceById(devId);
+        if ((deviceNode != _registeredDevices.end()) && ((*deviceNode)->device->_is_equivalent(registered))) {
+            LOG_WARN(DomainManager_impl, "Cleaning up registration; device <" << devId << "> is registered and no longer exists");
+            try {
+                _local_unregisterDevice(deviceNode);
+            } CATCH_LOG_WARN(DomainManager_impl, "_local_unregisterDevice failed");
+        }
+    }
+
+    boost::recursive_mutex::scoped_lock lock(stateAccess);
+
+    // The registries may have changed since the checks above
+    if (findDeviceById(devId) != _registeredDevices.end()) {
+        ostringstream eout;
+        eout << "Attempt re-register existing device : " << devId;
+        LOG_ERROR(DomainManager_impl, eout.str());
+        throw CF::DomainManager::RegisterError(CF::CF_NOTSET, eout.str().c_str());
+    }
+    if (findDeviceManagerById(newDeviceNode->devMgr.identifier) == _registeredDeviceManagers.end()) {
+        throw CF::DomainManager::DeviceManagerNotRegistered ();
     }
 
     //Add registeringDevice and its attributes to domain manager
-    storeDeviceInDomainMgr (registeringDevice, registeredDeviceMgr);
+    commitDevice(newDeviceNode);
 
     //Check the DCD for connections and establish them
     try {
@@ -1381,40 +1464,28 @@ void DomainManager_impl::_local_registerDevice (CF::Device_ptr registeringDevice
 }
 
 
-//This function adds the registeringDevice and its attributes to the DomainMgr.
-//if the device already exists it does nothing
-void DomainManager_impl::storeDeviceInDomainMgr (CF::Device_ptr registeringDevice,
-                                                 CF::DeviceManager_ptr registeredDeviceMgr)
+//This function reads the registering device's attributes and profile. It makes
+//remote calls to the device and its DeviceManager, and does not access the
+//domain state. Returns an empty pointer if the DeviceManager is unreachable.
+boost::shared_ptr<DeviceNode> DomainManager_impl::gatherDeviceInfo (CF::Device_ptr registeringDevice,
+                                                                    CF::DeviceManager_ptr registeredDeviceMgr)
 {
-    TRACE_ENTER(DomainManager_impl)
-    boost::recursive_mutex::scoped_lock lock(stateAccess);
-
-//check if device is already registered
-    if (deviceIsRegistered (registeringDevice)) {
-        LOG_TRACE(DomainManager_impl, "Device already registered, refusing to store into domain manager")
-        TRACE_EXIT(DomainManager_impl)
-        return;
-    }
+    boost::shared_ptr<DeviceNode> newDeviceNode;
 
     std::string devMgrId;
     try {
         devMgrId = ossie::corba::returnString(registeredDeviceMgr->identifier());
     } CATCH_LOG_ERROR(DomainManager_impl, "DeviceManager is unreachable during device registrations")
     if (devMgrId.empty()){
-        return;
-    }
-
-    DeviceManagerList::iterator pDevMgr = findDeviceManagerById(devMgrId);
-    if (pDevMgr ==  _registeredDeviceManagers.end()) {
-        LOG_ERROR(DomainManager_impl, "Device Manager for Device is not registered")
-        return;
+        return newDeviceNode;
     }
 
-    // If this part is reached, the registering device has to be added
-    // Get read-only attributes from registeringDevice
-    boost::shared_ptr<DeviceNode> newDeviceNode(new DeviceNode());
+    // Get read-only attributes from registeringDevice; the DeviceManager
+    // record is filled in from the registry on commit
+    newDeviceNode.reset(new DeviceNode());
     newDeviceNode->device = CF::Device::_duplicate(registeringDevice);
-    newDeviceNode->devMgr = *pDevMgr;
+    newDeviceNode->devMgr.deviceManager = CF::DeviceManager::_duplicate(registeredDeviceMgr);
+    newDeviceNode->devMgr.identifier = devMgrId;
     newDeviceNode->label = ossie::corba::returnString(registeringDevice->label());
     newDeviceNode->softwareProfile = ossie::corba::returnString(registeringDevice->softwareProfile());
     newDeviceNode->identifier = ossie::corba::returnString(registeringDevice->identifier());
@@ -1424,7 +1495,19 @@ void DomainManager_impl::storeDeviceInDomainMgr (CF::Device_ptr registeringDevic
 
     parseDeviceProfile(*newDeviceNode);
 
-    _registeredDevices.push_back (newDeviceNode);
+    return newDeviceNode;
+}
+
+
+//This function adds a gathered device to the DomainMgr; the caller has checked
+//that the device is not registered and its DeviceManager is
+void DomainManager_impl::commitDevice (const boost::shared_ptr<DeviceNode>& newDeviceNode)
+{
+    TRACE_ENTER(DomainManager_impl)
+    boost::recursive_mutex::scoped_lock lock(stateAccess);
+
+    newDeviceNode->devMgr = *findDeviceManagerById(newDeviceNode->devMgr.identifier);
+    addDeviceNode(newDeviceNode);
 
     try {
         db.store("DEVICES", _registeredDevices);
@@ -1435,10 +1518,43 @@ void DomainManager_impl::storeDeviceInDomainMgr (CF::Device_ptr registeringDevic
     TRACE_EXIT(DomainManager_impl)
 }
 
+
+//This function adds the registeringDevice and its attributes to the DomainMgr.
+//if the device already exists it does nothing
+void DomainManager_impl::storeDeviceInDomainMgr (CF::Device_ptr registeringDevice,
+                                                 CF::DeviceManager_ptr registeredDeviceMgr)
+{
+    TRACE_ENTER(DomainManager_impl)
+
+    boost::shared_ptr<DeviceNode> newDeviceNode = gatherDeviceInfo(registeringDevice, registeredDeviceMgr);
+    if (!newDeviceNode) {
+        TRACE_EXIT(DomainManager_impl)
+        return;
+    }
+
+    boost::recursive_mutex::scoped_lock lock(stateAccess);
+
+    //check if device is already registered
+    if (findDeviceById(newDeviceNode->identifier) != _registeredDevices.end()) {
+        LOG_TRACE(DomainManager_impl, "Device already registered, refusing to store into domain manager")
+        TRACE_EXIT(DomainManager_impl)
+        return;
+    }
+
+    if (findDeviceManagerById(newDeviceNode->devMgr.identifier) == _registeredDeviceManagers.end()) {
+        LOG_ERROR(DomainManager_impl, "Device Manager for Device is not registered")
+        return;
+    }
+
+    commitDevice(newDeviceNode);
+
+    TRACE_EXIT(DomainManager_impl)
+}
+
 //This function adds the registeringService and its name to the DomainMgr.
 //if the service already exists it does nothing
 void
-DomainManager_impl::storeServiceInDomainMgr (CORBA::Object_ptr registeringService, CF::DeviceManager_ptr registeredDeviceMgr, const char* name, const char * serviceId)
+DomainManager_impl::storeServiceInDomainMgr (CORBA::Object_ptr registeringService, const std::string& devMgrId, const char* name, const char * serviceId)
 {
     TRACE_ENTER(DomainManager_impl)
     boost::recursive_mutex::scoped_lock lock(stateAccess);
@@ -1451,11 +1567,6 @@ DomainManager_impl::storeServiceInDomainMgr (CORBA::Object_ptr registeringServic
     }
 
     // The service needs to be added to the list.
-    std::string devMgrId;
-    try {
-        devMgrId = ossie::corba::returnString(registeredDeviceMgr->identifier());
-    } CATCH_LOG_ERROR(DomainManager_impl, "DeviceManager is unreachable during service registration")
-
     ServiceNode node;
     node.service = CORBA::Object::_duplicate(registeringService);
     node.deviceManagerId = devMgrId;
@@ -1463,7 +1574,7 @@ DomainManager_impl::storeServiceInDomainMgr (CORBA::Object_ptr registeringServic
     node.serviceId = serviceId;
 
     // Add service to registered list, updating changes in the persistence store.
-    _registeredServices.push_back(node);
+    addServiceNode(node);
     try {
         db.store("SERVICES", _registeredServices);
     } catch (const ossie::PersistenceException& ex) {
@@ -1479,7 +1590,9 @@ throw (CORBA::SystemException, CF::InvalidObjectReference,
 {
     boost::mutex::scoped_lock lock(interfaceAccess);
 
-    DeviceList::iterator deviceNode = findDeviceByObject(unregisteringDevice);
+    const std::string identifier = lookupDeviceIdentifier(unregisteringDevice);
+    boost::recursive_mutex::scoped_lock state(stateAccess);
+    DeviceList::iterator deviceNode = findDeviceByObject(unregisteringDevice, identifier);
     if (deviceNode == _registeredDevices.end()) {
         throw CF::InvalidObjectReference("Device not registered with domain");
     }
@@ -1533,7 +1646,7 @@ ossie::DeviceList::iterator DomainManager_impl::_local_unregisterDevice (ossie::
                      StandardEvent::DEVICE );
 
     // Remove the device from the internal list.
-    deviceNode = _registeredDevices.erase(deviceNode);
+    deviceNode = eraseDeviceNode(deviceNode);
 
     // Write the updated device list to the persistence store.
     try {
@@ -1550,9 +1663,12 @@ ossie::DeviceList::iterator DomainManager_impl::_local_unregisterDevice (ossie::
 bool DomainManager_impl::deviceIsRegistered (CF::Device_ptr registeredDevice)
 {
     TRACE_ENTER(DomainManager_impl)
-    boost::recursive_mutex::scoped_lock lock(stateAccess);
 
-    DeviceList::iterator device = findDeviceByObject(registeredDevice);
+    // The identifier may need to be queried from the device, which is done
+    // before locking the domain state
+    const std::string identifier = lookupDeviceIdentifier(registeredDevice);
+    boost::recursive_mutex::scoped_lock lock(stateAccess);
+    DeviceList::iterator device = findDeviceByObject(registeredDevice, identifier);
 
     TRACE_EXIT(DomainManager_impl);
     return (device !=_registeredDevices.end());
@@ -1581,9 +1697,12 @@ void DomainManager_impl::closeAllOpenFileHandles()
 bool DomainManager_impl::deviceMgrIsRegistered (CF::DeviceManager_ptr registeredDeviceMgr)
 {
     TRACE_ENTER(DomainManager_impl)
-    boost::recursive_mutex::scoped_lock lock(stateAccess);
 
-    DeviceManagerList::iterator node = findDeviceManagerByObject(registeredDeviceMgr);
+    // The identifier may need to be queried from the DeviceManager, which is
+    // done before locking the domain state
+    const std::string identifier = lookupDeviceManagerIdentifier(registeredDeviceMgr);
+    boost::recursive_mutex::scoped_lock lock(stateAccess);
+    DeviceManagerList::iterator node = findDeviceManagerByObject(registeredDeviceMgr, identifier);
 
     TRACE_EXIT(DomainManager_impl);
     return (node != _registeredDeviceManagers.end());;
@@ -2006,7 +2125,8 @@ void DomainManager_impl::_local_unregisterFromEventChannel (std::string &unregis
 void DomainManager_impl::registerService (CORBA::Object_ptr registeringService, CF::DeviceManager_ptr registeredDeviceMgr, const char* name)
     throw (CF::DomainManager::RegisterError, CF::DomainManager::DeviceManagerNotRegistered, CF::InvalidObjectReference, CORBA::SystemException)
 {
-    boost::mutex::scoped_lock lock(interfaceAccess);
+    // Like registerDeviceManager, service registration does not hold
+    // interfaceAccess and only locks the domain state to commit
     ossie::corba::overrideBlockingCall(registeringService,getServiceWaitTime());
     ossie::corba::overrideBlockingCall(registeredDeviceMgr,getManagerWaitTime());
     _local_registerService(registeringService, registeredDeviceMgr, name);
@@ -2015,8 +2135,6 @@ void DomainManager_impl::registerService (CORBA::Object_ptr registeringService,
 void DomainManager_impl::_local_registerService (CORBA::Object_ptr registeringService, CF::DeviceManager_ptr registeredDeviceMgr, const char* name)
 {
     TRACE_ENTER(DomainManager_impl)
-    boost::recursive_mutex::scoped_lock lock(stateAccess);
-
 
     // Verify that the service and DeviceManager are not nil references
     if (CORBA::is_nil(registeringService)) {
@@ -2033,34 +2151,21 @@ void DomainManager_impl::_local_registerService (CORBA::Object_ptr registeringSe
         throw CF::DomainManager::DeviceManagerNotRegistered();
     }
     
-    DeviceManagerConfiguration _DCDParser;
-    bool readDCD = true;
-    std::string serviceId("");
-    std::string inputUsageName(name);
+    // Query the DeviceManager before taking the lock
+    std::string devMgrId;
     try {
-        CF::FileSystem_var devMgrFileSys = registeredDeviceMgr->fileSys();
-        CORBA::String_var profile = registeredDeviceMgr->deviceConfigurationProfile();
-        File_stream _dcd(devMgrFileSys, profile);
-        _DCDParser.load(_dcd);
-        _dcd.close();
+        devMgrId = ossie::corba::returnString(registeredDeviceMgr->identifier());
     } catch ( ... ) {
-        readDCD = false;
-    }
-    if (readDCD) {
-        const std::vector<ossie::ComponentPlacement>& componentPlacements = _DCDParser.getComponentPlacements();
-        bool foundId = false;
-        for (unsigned int i = 0; i < componentPlacements.size(); i++) {
-            for (unsigned int j=0; j<componentPlacements[i].getInstantiations().size(); j++) {
-                std::string usageName(componentPlacements[i].getInstantiations()[j].getUsageName());
-                if (usageName == inputUsageName) {
-                    serviceId = componentPlacements[i].getInstantiations()[j].getID();
-                    foundId = true;
-                    break;
-                }
-            }
-            if (foundId)
-                break;
-        }
+        LOG_WARN(DomainManager_impl, "Ignoring attempt to register a Service from an unreachable DeviceManager");
+        throw CF::DomainManager::DeviceManagerNotRegistered();
+    }
+    std::string serviceId("");
+    lookupServiceId(registeredDeviceMgr, name, serviceId);
+
+    boost::recursive_mutex::scoped_lock lock(stateAccess);
+    if (findDeviceManagerById(devMgrId) == _registeredDeviceManagers.end()) {
+        LOG_WARN(DomainManager_impl, "Ignoring attempt to register a Service from an unregistered DeviceManager");
+        throw CF::DomainManager::DeviceManagerNotRegistered();
     }
 
 //The registerService operation shall add the registeringServices object reference and the
@@ -2075,7 +2180,7 @@ void DomainManager_impl::_local_registerService (CORBA::Object_ptr registeringSe
 
 //Add registeringService and its name to domain manager
     try {
-        storeServiceInDomainMgr(registeringService, registeredDeviceMgr, name, serviceId.c_str());
+        storeServiceInDomainMgr(registeringService, devMgrId, name, serviceId.c_str());
     } catch ( ... ) {
         throw;
     }
@@ -2105,6 +2210,7 @@ void DomainManager_impl::_local_registerService (CORBA::Object_ptr registeringSe
 //3. The sourceName shall be the input name parameter for the registering service.
 //4. The sourceIOR shall be the registered service object reference.
 //5. The sourceCategory shall be SERVICE.
+    lock.unlock();
     sendAddEvent( _identifier.c_str(), serviceId.c_str(), name, registeringService, StandardEvent::SERVICE );
 
 //The registerService operation shall raise the RegisterError exception when an internal error
@@ -2112,6 +2218,36 @@ void DomainManager_impl::_local_registerService (CORBA::Object_ptr registeringSe
 }
 
 
+//This function finds the instantiation id of the service with the given usage
+//name in the DeviceManager's DCD. It makes remote calls to the DeviceManager
+//and its file system, and does not access the domain state.
+bool DomainManager_impl::lookupServiceId (CF::DeviceManager_ptr registeredDeviceMgr, const std::string& name, std::string& serviceId)
+{
+    DeviceManagerConfiguration _DCDParser;
+    try {
+        CF::FileSystem_var devMgrFileSys = registeredDeviceMgr->fileSys();
+        CORBA::String_var profile = registeredDeviceMgr->deviceConfigurationProfile();
+        File_stream _dcd(devMgrFileSys, profile);
+        _DCDParser.load(_dcd);
+        _dcd.close();
+    } catch ( ... ) {
+        return false;
+    }
+
+    const std::vector<ossie::ComponentPlacement>& componentPlacements = _DCDParser.getComponentPlacements();
+    for (unsigned int i = 0; i < componentPlacements.size(); i++) {
+        for (unsigned int j=0; j<componentPlacements[i].getInstantiations().size(); j++) {
+            std::string usageName(componentPlacements[i].getInstantiations()[j].getUsageName());
+            if (usageName == name) {
+                serviceId = componentPlacements[i].getInstantiations()[j].getID();
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+
 void DomainManager_impl::unregisterService(CORBA::Object_ptr unregisteringService, const char* name)
     throw (CF::DomainManager::UnregisterError, CF::InvalidObjectReference, CORBA::SystemException)
 {
@@ -2152,7 +2288,7 @@ ossie::ServiceList::iterator DomainManager_impl::_local_unregisterService(ossie:
     std::string serviceId(service->serviceId);
 
     // Remove the service from the internal list.
-    service = _registeredServices.erase(service);
+    service = eraseServiceNode(service);
 
     if (!_applications.empty()) {
         std::vector<Application_impl*> appsToRelease;
@@ -2316,29 +2452,127 @@ void DomainManager_impl::catastrophicUnregisterDeviceManager (ossie::DeviceManag
 }
 
 
-ossie::DeviceList::iterator DomainManager_impl::findDeviceById (const std::string& identifier)
+ossie::DeviceList::iterator DomainManager_impl::addDeviceNode (const boost::shared_ptr<DeviceNode>& node)
 {
+    // The list and its indices always change together under the state lock
     boost::recursive_mutex::scoped_lock lock(stateAccess);
+    DeviceList::iterator device = _registeredDevices.insert(_registeredDevices.end(), node);
+    _deviceIdIndex[node->identifier] = device;
+    if (!CORBA::is_nil(node->device)) {
+        _deviceObjectIndex[ossie::corba::objectToString(node->device)] = device;
+    }
+    return device;
+}
 
-    DeviceList::iterator device;
-    for (device = _registeredDevices.begin(); device != _registeredDevices.end(); ++device) {
-        if (identifier == (*device)->identifier) {
-            break;
+ossie::DeviceList::iterator DomainManager_impl::eraseDeviceNode (ossie::DeviceList::iterator device)
+{
+    boost::recursive_mutex::scoped_lock lock(stateAccess);
+    // Only drop index entries that refer to this node; a replacement may
+    // already have been registered under the same key
+    DeviceIndex::iterator entry = _deviceIdIndex.find((*device)->identifier);
+    if ((entry != _deviceIdIndex.end()) && (entry->second == device)) {
+        _deviceIdIndex.erase(entry);
+    }
+    if (!CORBA::is_nil((*device)->device)) {
+        entry = _deviceObjectIndex.find(ossie::corba::objectToString((*device)->device));
+        if ((entry != _deviceObjectIndex.end()) && (entry->second == device)) {
+            _deviceObjectIndex.erase(entry);
         }
     }
-    return device;
+    return _registeredDevices.erase(device);
+}
+
+ossie::DeviceManagerList::iterator DomainManager_impl::addDeviceManagerNode (const DeviceManagerNode& node)
+{
+    boost::recursive_mutex::scoped_lock lock(stateAccess);
+    DeviceManagerList::iterator deviceManager = _registeredDeviceManagers.insert(_registeredDeviceManagers.end(), node);
+    _deviceManagerIdIndex[node.identifier] = deviceManager;
+    if (!CORBA::is_nil(node.deviceManager)) {
+        _deviceManagerObjectIndex[ossie::corba::objectToString(node.deviceManager)] = deviceManager;
+    }
+    return deviceManager;
+}
+
+ossie::DeviceManagerList::iterator DomainManager_impl::eraseDeviceManagerNode (ossie::DeviceManagerList::iterator deviceManager)
+{
+    boost::recursive_mutex::scoped_lock lock(stateAccess);
+    DeviceManagerIndex::iterator entry = _deviceManagerIdIndex.find(deviceManager->identifier);
+    if ((entry != _deviceManagerIdIndex.end()) && (entry->second == deviceManager)) {
+        _deviceManagerIdIndex.erase(entry);
+    }
+    if (!CORBA::is_nil(deviceManager->deviceManager)) {
+        entry = _deviceManagerObjectIndex.find(ossie::corba::objectToString(deviceManager->deviceManager));
+        if ((entry != _deviceManagerObjectIndex.end()) && (entry->second == deviceManager)) {
+            _deviceManagerObjectIndex.erase(entry);
+        }
+    }
+    return _registeredDeviceManagers.erase(deviceManager);
+}
+
+ossie::ServiceList::iterator DomainManager_impl::addServiceNode (const ServiceNode& node)
+{
+    boost::recursive_mutex::scoped_lock lock(stateAccess);
+    ServiceList::iterator service = _registeredServices.insert(_registeredServices.end(), node);
+    _serviceNameIndex[node.name] = service;
+    return service;
 }
 
-ossie::DeviceList::iterator DomainManager_impl::findDeviceByObject (CF::Device_ptr device)
+ossie::ServiceList::iterator DomainManager_impl::eraseServiceNode (ossie::ServiceList::iterator service)
 {
     boost::recursive_mutex::scoped_lock lock(stateAccess);
+    ServiceIndex::iterator entry = _serviceNameIndex.find(service->name);
+    if ((entry != _serviceNameIndex.end()) && (entry->second == service)) {
+        _serviceNameIndex.erase(entry);
+    }
+    return _registeredServices.erase(service);
+}
+
+
+ossie::DeviceList::iterator DomainManager_impl::findDeviceById (const std::string& identifier)
+{
+    boost::recursive_mutex::scoped_lock lock(stateAccess);
+
+    DeviceIndex::iterator entry = _deviceIdIndex.find(identifier);
+    if (entry == _deviceIdIndex.end()) {
+        return _registeredDevices.end();
+    }
+    return entry->second;
+}
+
+std::string DomainManager_impl::lookupDeviceIdentifier (CF::Device_ptr device)
+{
+    // Most lookups are for the same reference that was registered, which is
+    // found by its stringified IOR without contacting the device
+    {
+        boost::recursive_mutex::scoped_lock lock(stateAccess);
+        if (_deviceObjectIndex.count(ossie::corba::objectToString(device))) {
+            return std::string();
+        }
+    }
 
+    // Query the identifier outside of the lock, so that an unresponsive
+    // device does not block the domain state
     try {
-        std::string identifier = ossie::corba::returnString(device->identifier());
-        return findDeviceById(identifier);
+        return ossie::corba::returnString(device->identifier());
     } catch (...) {
-        // Device is not reachable for some reason, try checking by object.
+        // Device is not reachable for some reason; it can only be found by
+        // object.
     }
+    return std::string();
+}
+
+ossie::DeviceList::iterator DomainManager_impl::findDeviceByObject (CF::Device_ptr device, const std::string& identifier)
+{
+    boost::recursive_mutex::scoped_lock lock(stateAccess);
+
+    DeviceIndex::iterator entry = _deviceObjectIndex.find(ossie::corba::objectToString(device));
+    if (entry != _deviceObjectIndex.end()) {
+        return entry->second;
+    }
+    if (!identifier.empty()) {
+        return findDeviceById(identifier);
+    }
+
     DeviceList::iterator node;
     for (node = _registeredDevices.begin(); node != _registeredDevices.end(); ++node) {
         if (device->_is_equivalent((*node)->device)) {
@@ -2374,26 +2608,43 @@ ossie::DeviceManagerList::iterator DomainManager_impl::findDeviceManagerById (co
 {
     boost::recursive_mutex::scoped_lock lock(stateAccess);
 
-    DeviceManagerList::iterator node;
-    for (node = _registeredDeviceManagers.begin(); node != _registeredDeviceManagers.end(); ++node) {
-        if (identifier == node->identifier) {
-            break;
+    DeviceManagerIndex::iterator entry = _deviceManagerIdIndex.find(identifier);
+    if (entry == _deviceManagerIdIndex.end()) {
+        return _registeredDeviceManagers.end();
+    }
+    return entry->second;
+}
+
+
+std::string DomainManager_impl::lookupDeviceManagerIdentifier (CF::DeviceManager_ptr deviceManager)
+{
+    {
+        boost::recursive_mutex::scoped_lock lock(stateAccess);
+        if (_deviceManagerObjectIndex.count(ossie::corba::objectToString(deviceManager))) {
+            return std::string();
         }
     }
 
-    return node;
+    try {
+        return ossie::corba::returnString(deviceManager->identifier());
+    } catch (...) {
+        // DeviceManager is not reachable for some reason; it can only be
+        // found by object.
+    }
+    return std::string();
 }
 
 
-ossie::DeviceManagerList::iterator DomainManager_impl::findDeviceManagerByObject (CF::DeviceManager_ptr deviceManager)
+ossie::DeviceManagerList::iterator DomainManager_impl::findDeviceManagerByObject (CF::DeviceManager_ptr deviceManager, const std::string& identifier)
 {
     boost::recursive_mutex::scoped_lock lock(stateAccess);
 
-    try {
-        std::string identifier = ossie::corba::returnString(deviceManager->identifier());
+    DeviceManagerIndex::iterator entry = _deviceManagerObjectIndex.find(ossie::corba::objectToString(deviceManager));
+    if (entry != _deviceManagerObjectIndex.end()) {
+        return entry->second;
+    }
+    if (!identifier.empty()) {
         return findDeviceManagerById(identifier);
-    } catch (...) {
-        // DeviceManager is not reachable for some reason, try checking by object.
     }
 
     DeviceManagerList::iterator node;
@@ -2411,13 +2662,11 @@ ossie::ServiceList::iterator DomainManager_impl::findServiceByName (const std::s
 {
     boost::recursive_mutex::scoped_lock lock(stateAccess);
 
-    ServiceList::iterator node;
-    for (node = _registeredServices.begin(); node != _registeredServices.end(); ++node) {
-        if (name == node->name) {
-            break;
-        }
+    ServiceIndex::iterator entry = _serviceNameIndex.find(name);
+    if (entry == _serviceNameIndex.end()) {
+        return _registeredServices.end();
     }
-    return node;
+    return entry->second;
 }
 
 
@@ -28,6 +28,7 @@
 
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/recursive_mutex.hpp>
+#include <boost/unordered_map.hpp>
 
 #include <COS/CosEventChannelAdmin.hh>
 
@@ -178,6 +179,19 @@ public:
       return componentBindingTimeout;
     }
 
+    // Time, in seconds, allowed for releasing an application's components
+    static const unsigned long DEFAULT_APPLICATION_TEARDOWN_TIMEOUT = 30;
+
+    unsigned long getApplicationTeardownTimeout (void) const {
+      return applicationTeardownTimeout;
+    }
+
+    // Time, in milliseconds, that an application keeps the queried values of
+    // readonly external properties; 0 disables caching
+    unsigned long getApplicationQueryCacheTimeout (void) const {
+      return applicationQueryCacheTimeout;
+    }
+
     ossie::DeviceList getRegisteredDevices(); // Get a copy of registered devices
 
     ossie::DomainManagerList getRegisteredRemoteDomainManagers(); // Get a copy of registered devices
@@ -253,12 +267,28 @@ protected:
 
     void parseDMDProfile();
     void storeDeviceInDomainMgr (CF::Device_ptr, CF::DeviceManager_ptr);
-    void storeServiceInDomainMgr (CORBA::Object_ptr, CF::DeviceManager_ptr, const char*, const char*);
+    void storeServiceInDomainMgr (CORBA::Object_ptr, const std::string&, const char*, const char*);
     bool deviceMgrIsRegistered (CF::DeviceManager_ptr);
     bool domainMgrIsRegistered (CF::DomainManager_ptr);
     bool deviceIsRegistered (CF::Device_ptr);
     bool serviceIsRegistered (const char*);
     void addDeviceMgr (CF::DeviceManager_ptr deviceMgr);
+    bool addDeviceMgr (const ossie::DeviceManagerNode& node);
+
+    // Registration is split into a gather phase, which makes all of the remote
+    // calls to the registering object without holding stateAccess, and a
+    // commit phase that only updates the registries
+    boost::shared_ptr<ossie::DeviceNode> gatherDeviceInfo (CF::Device_ptr, CF::DeviceManager_ptr);
+    void commitDevice (const boost::shared_ptr<ossie::DeviceNode>& node);
+    bool lookupServiceId (CF::DeviceManager_ptr, const std::string& name, std::string& serviceId);
+
+    // Keep the registries and their indices in step; callers hold stateAccess
+    ossie::DeviceList::iterator addDeviceNode (const boost::shared_ptr<ossie::DeviceNode>& node);
+    ossie::DeviceList::iterator eraseDeviceNode (ossie::DeviceList::iterator device);
+    ossie::DeviceManagerList::iterator addDeviceManagerNode (const ossie::DeviceManagerNode& node);
+    ossie::DeviceManagerList::iterator eraseDeviceManagerNode (ossie::DeviceManagerList::iterator deviceManager);
+    ossie::ServiceList::iterator addServiceNode (const ossie::ServiceNode& node);
+    ossie::ServiceList::iterator eraseServiceNode (ossie::ServiceList::iterator service);
     void mountDeviceMgrFileSys (CF::DeviceManager_ptr deviceMgr);
     void addDomainMgr (CF::DomainManager_ptr domainMgr);
     void catastrophicUnregisterDeviceManager (ossie::DeviceManagerList::iterator node);
@@ -268,13 +298,18 @@ protected:
 
     void cleanupDomainNamingContext (CosNaming::NamingContext_ptr nc);
 
-    ossie::DeviceManagerList::iterator findDeviceManagerByObject (CF::DeviceManager_ptr deviceManager);
+    // Lookups by object take the identifier returned by the matching lookup*Identifier call, which may make
+    // a remote call and so must be made without holding stateAccess. The caller must hold stateAccess across
+    // the lookup and any use of the returned iterator.
+    std::string lookupDeviceManagerIdentifier (CF::DeviceManager_ptr deviceManager);
+    ossie::DeviceManagerList::iterator findDeviceManagerByObject (CF::DeviceManager_ptr deviceManager, const std::string& identifier);
     ossie::DeviceManagerList::iterator findDeviceManagerById (const std::string& identifier);
 
     ossie::DomainManagerList::iterator findDomainManagerByObject (CF::DomainManager_ptr deviceManager);
     ossie::DomainManagerList::iterator findDomainManagerById (const std::string& identifier);
 
-    ossie::DeviceList::iterator findDeviceByObject (CF::Device_ptr device);
+    std::string lookupDeviceIdentifier (CF::Device_ptr device);
+    ossie::DeviceList::iterator findDeviceByObject (CF::Device_ptr device, const std::string& identifier);
     ossie::DeviceList::iterator findDeviceById (const std::string& identifier);
 
     ossie::ServiceList::iterator findServiceByName (const std::string& name);
@@ -312,6 +347,18 @@ protected:
     ossie::ServiceList _registeredServices;
     std::vector < ossie::EventChannelNode > _eventChannels;
 
+    // Registry indices by identifier (name for services) and by stringified
+    // object reference, so that lookups do not scan the lists or make remote
+    // calls to the object being looked up
+    typedef boost::unordered_map<std::string, ossie::DeviceList::iterator> DeviceIndex;
+    typedef boost::unordered_map<std::string, ossie::DeviceManagerList::iterator> DeviceManagerIndex;
+    typedef boost::unordered_map<std::string, ossie::ServiceList::iterator> ServiceIndex;
+    DeviceIndex _deviceIdIndex;
+    DeviceIndex _deviceObjectIndex;
+    DeviceManagerIndex _deviceManagerIdIndex;
+    DeviceManagerIndex _deviceManagerObjectIndex;
+    ServiceIndex _serviceNameIndex;
+
 
 
     //
@@ -358,6 +405,8 @@ private:
     std::string      logging_config_uri;
     StringProperty*  logging_config_prop;
     CORBA::ULong     componentBindingTimeout;
+    CORBA::ULong     applicationTeardownTimeout;
+    CORBA::ULong     applicationQueryCacheTimeout;
     std::string      redhawk_version;
     bool             _useLogConfigUriResolver;
     bool             _strict_spd_validation;
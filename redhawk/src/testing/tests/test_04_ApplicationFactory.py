@@ -563,6 +563,37 @@ class ApplicationFactoryTest(scatest.CorbaTestCase):
 
         domMgr.uninstallApplication(appFact._get_identifier())
 
+    def test_TopologyAwarePlacement(self):
+        # components connected to an already placed component should be
+        # placed on the same device when topology aware placement is requested
+        nodebooter, domMgr = self.launchDomainManager()
+        self.assertNotEqual(domMgr, None)
+
+        nodebooter, devMgr = self.launchDeviceManager("/nodes/test_BasicTestDevice_node/DeviceManager.dcd.xml")
+        self.assertNotEqual(devMgr, None)
+        nodebooter, devMgr2 = self.launchDeviceManager("/nodes/test_BasicTestDevice2_node/DeviceManager.dcd.xml")
+        self.assertNotEqual(devMgr2, None)
+        self.assertEqual(len(domMgr._get_deviceManagers()), 2)
+        device2 = devMgr2._get_registeredDevices()[0]
+
+        domMgr.installApplication("/waveforms/PortConnectProvidesPort/PortConnectProvidesPort.sad.xml")
+        appFact = domMgr._get_applicationFactories()[0]
+
+        # Assign the uses side of the connection to the second node; its
+        # provides side peer is not assigned
+        das = [ CF.DeviceAssignmentType("DCE:5faf296f-3193-49cc-8751-f8a64b315fdf", device2._get_identifier()) ]
+        props = [ CF.DataType(id="TOPOLOGY_AWARE_PLACEMENT", value=any.to_any(True)) ]
+        app = appFact.create(appFact._get_name(), props, das)
+        self.assertNotEqual(app, None)
+
+        compDevs = app._get_componentDevices()
+        self.assertTrue(len(compDevs) >= 2)
+        for compDev in compDevs:
+            self.assertEqual(compDev.assignedDeviceId, device2._get_identifier())
+
+        app.releaseObject()
+        domMgr.uninstallApplication(appFact._get_identifier())
+
     def test_MalformedComponentFile(self):
         # test basic operation of launching an application and checking allocation capacities
 
@@ -2502,6 +2533,51 @@ class ApplicationFactoryTest(scatest.CorbaTestCase):
         app.stop()
         app.releaseObject()
 
+    def test_sharedStartOrder(self):
+        nodebooter, domMgr = self.launchDomainManager()
+        self.assertNotEqual(domMgr, None)
+        nodebooter, devMgr = self.launchDeviceManager("/nodes/test_BasicTestDevice_node/DeviceManager.dcd.xml")
+        self.assertNotEqual(devMgr, None)
+
+        # A short teardown deadline must not cause any component to be skipped
+        timeout = CF.DataType(id="APPLICATION_TEARDOWN_TIMEOUT", value=any.to_any(None))
+        self.assertEqual(domMgr.query([timeout])[0].value._v, 30)
+        domMgr.configure([CF.DataType(id="APPLICATION_TEARDOWN_TIMEOUT", value=CORBA.Any(CORBA.TC_ulong, 1))])
+        self.assertEqual(domMgr.query([timeout])[0].value._v, 1)
+
+        domMgr.installApplication("/waveforms/CommandWrapperStartOrderTests/CommandWrapperSharedOrder.sad.xml")
+        self.assertEqual(len(domMgr._get_applicationFactories()), 1)
+        appFact = domMgr._get_applicationFactories()[0]
+
+        app = appFact.create(appFact._get_name(), [], [])
+        components = [x.componentObject._narrow(CF.Resource) for x in app._get_registeredComponents()]
+        self.assertEqual(len(components), 6)
+
+        # Components that share a start order are started as a group
+        app.start()
+        for component in components:
+            props = dict( [(p.id, any.from_any(p.value)) for p in component.query([])] )
+            self.assertEqual(props["startCounter"], 1)
+            self.assertTrue(component._get_started())
+
+        app.stop()
+        for component in components:
+            self.assertFalse(component._get_started())
+
+        app.start()
+        for component in components:
+            props = dict( [(p.id, any.from_any(p.value)) for p in component.query([])] )
+            self.assertEqual(props["startCounter"], 2)
+
+        app.releaseObject()
+        self.assertEqual(len(domMgr._get_applications()), 0)
+        for component in components:
+            try:
+                self.assertTrue(component._non_existent())
+            except (CORBA.TRANSIENT, CORBA.COMM_FAILURE):
+                # The component's process has exited
+                pass
+
     def test_sadULongLongPropertyOverride(self):
         nodebooter, domMgr = self.launchDomainManager()
         self.assertNotEqual(domMgr, None)
@@ -88,6 +88,27 @@ def get_process_affinity( pname, use_pidof=True):
     return cpus_allowed   
 
 
+def get_thread_affinities( pname ):
+    # returns a dictionary of thread id to cpus allowed for a process, empty
+    # if the process is not running
+    threads={}
+    o1=os.popen("pgrep -f testing/.*/"+pname )
+    pid=o1.read().split('\n')[0]
+    if not pid:
+        return threads
+    for tid in os.listdir('/proc/'+pid+'/task'):
+        try:
+            status=open('/proc/'+pid+'/task/'+tid+'/status')
+        except IOError:
+            # the thread exited after the task directory was listed
+            continue
+        for line in status:
+            if line.startswith('Cpus_allowed_list'):
+                threads[tid]=line.split()[1]
+    threads['main']=threads[pid]
+    return threads
+
+
 class TestNodeAffinity(scatest.CorbaTestCase):
 
     def get_node_info(self):
@@ -180,6 +201,46 @@ class TestWaveformAffinity(scatest.CorbaTestCase):
         self.assertEqual(len(domMgr._get_deviceManagers()), 0)
 
 
+    def test_OrbWorkerThreadAffinity(self):
+        nodebooter, domMgr = self.launchDomainManager()
+        devBooter, devMgr = self.launchDeviceManager("/nodes/test_affinity_node_unlocked/DeviceManager.dcd.xml")
+
+        # Ensure the expected device is available
+        self.assertNotEqual(devMgr, None)
+        # wait for all devices to register
+        count=0
+        for count in range(10):
+            if len( devMgr._get_registeredDevices() ) < 2 :
+                time.sleep(1)
+            else:
+                break
+
+        rhdom= redhawk.attach(scatest.getTestDomainName())
+        app=rhdom.createApplication('affinity_test4')
+        self.assertNotEqual(app, None)
+
+        # make a few calls so the component has assigned ORB threads to upcalls
+        for comp in app.comps:
+            for ii in range(5):
+                comp.ref._get_identifier()
+
+        threads = get_thread_affinities('C2')
+        self.assertTrue('main' in threads)
+        match = get_match("5")
+
+        # only the ORB threads that dispatched calls are bound, the main
+        # thread keeps the process affinity
+        self.assertNotEqual(threads['main'], match)
+        bound = [ tid for tid, cpus in threads.items() if tid != 'main' and cpus == match ]
+        self.assertTrue(len(bound) > 0)
+        self.assertTrue(len(bound) < len(threads)-1)
+
+        app.releaseObject()
+        devMgr.shutdown()
+
+        self.assertEqual(len(domMgr._get_deviceManagers()), 0)
+
+
     def test_DeployOnSocketPolicy(self):
         nodebooter, domMgr = self.launchDomainManager()
         devBooter, devMgr = self.launchDeviceManager("/nodes/test_affinity_node_socket/DeviceManager.dcd.xml")
@@ -529,4 +590,5 @@ setXmlSource( "./sdr/dom/components/C1/C1.spd.xml.GOLD")
 setXmlSource( "./sdr/dom/waveforms/affinity_test1/affinity_test1.sad.xml.GOLD")
 setXmlSource( "./sdr/dom/waveforms/affinity_test2/affinity_test2.sad.xml.GOLD")
 setXmlSource( "./sdr/dom/waveforms/affinity_test3/affinity_test3.sad.xml.GOLD")
+setXmlSource( "./sdr/dom/waveforms/affinity_test4/affinity_test4.sad.xml.GOLD")
 
@@ -153,6 +153,67 @@ class PropertyChangeListenerTest(scatest.CorbaTestCase):
         self._app=None
 
 
+    def test_PropertyChangeListener_CPP_SetterMode(self):
+        self._devBooter, self._devMgr = self.launchDeviceManager(execDeviceNode, self._domMgr)
+        self.assertNotEqual(self._devBooter, None)
+        self._domMgr.installApplication("/waveforms/PropertyChangeListenerNoJava/PropertyChangeListenerNoJava.sad.xml")
+        appFact = self._domMgr._get_applicationFactories()[0]
+        self.assertNotEqual(appFact, None)
+        app = appFact.create(appFact._get_name(), [], [])
+        self.assertNotEqual(app, None)
+        self._app = app
+
+        d=redhawk.attach(scatest.getTestDomainName())
+        a=d.apps[0]
+        c=filter( lambda c : c.name == 'PropertyChange_C1', a.comps )[0]
+        self.assertNotEqual(c,None)
+        ps = c.ref._narrow(CF.PropertySet)
+        self.assertNotEqual(ps,None)
+
+        # the monitor mode is a framework property, not part of the PRF
+        mode = CF.DataType(id='PROPERTY_CHANGE_MONITOR_MODE', value=any.to_any(None))
+        self.assertEquals(ps.query([mode])[0].value._v, 'POLLED')
+        ps.configure([CF.DataType(id='PROPERTY_CHANGE_MONITOR_MODE', value=any.to_any('SETTER'))])
+        self.assertEquals(ps.query([mode])[0].value._v, 'SETTER')
+        self.assertFalse('PROPERTY_CHANGE_MONITOR_MODE' in [p.id for p in ps.query([])])
+        self.assertRaises(CF.PropertySet.InvalidConfiguration, ps.configure,
+                          [CF.DataType(id='PROPERTY_CHANGE_MONITOR_MODE', value=any.to_any('BOGUS'))])
+
+        # create listener interface
+        myl = PropertyChangeListener_Receiver()
+        t=float(0.5)
+        regid=ps.registerPropertyListener( myl._this(), ['prop1'],t)
+        app.start()
+        time.sleep(1)
+
+        # changes are measured from the value at registration, so there is
+        # no initial report
+        self.assertEquals(myl.count,0)
+
+        # assign 3 changed values
+        c.prop1 = 100.0
+        time.sleep(.6)   # wait for listener to receive notice
+        c.prop1 = 200.0
+        time.sleep(.6)   # wait for listener to receive notice
+        c.prop1 = 300.0
+        time.sleep(.6)   # wait for listener to receive notice
+        self.assertEquals(myl.count,3)
+
+        # setting the value that was last reported is not a change
+        c.prop1 = 300.0
+        time.sleep(.6)   # wait for listener to receive notice
+        self.assertEquals(myl.count,3)
+
+        # change unmonitored property
+        c.prop2 = 100
+        time.sleep(.6)   # wait for listener to receive notice
+        self.assertEquals(myl.count,3)
+
+        ps.unregisterPropertyListener( regid )
+
+        app.releaseObject()
+        self._app=None
+
     def test_PropertyChangeListener_PYTHON(self):
         self.localEvent = threading.Event()
         self.eventFlag = False
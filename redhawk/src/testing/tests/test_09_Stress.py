@@ -209,6 +209,89 @@ class StressTest(scatest.CorbaTestCase):
         # that the DomainManager is still callable)
         self.assertEqual(len(domMgr._get_deviceManagers()), 0)
 
+    def _threadRegister(self, dcd):
+        self.startSignal.wait()
+        devBooter, devMgr = self.launchDeviceManager(dcdFile=dcd)
+        if devMgr:
+            self._threadCheckin()
+
+    def test_ConcurrentRegistration(self):
+        # Starts many nodes with many devices each simultaneously, and checks
+        # that the domain sees every node and every device once they have all
+        # registered. Also reports how long registration takes and how long
+        # domain queries take while registrations are in progress.
+        nodeDir = os.path.join(self.devRoot, 'nodes', 'test_Concurrent_nodes')
+        if not os.path.isdir(nodeDir):
+            os.mkdir(nodeDir)
+
+        nodebooter, domMgr = self.launchDomainManager()
+        self.assertNotEqual(domMgr, None)
+
+        numDevMgr = 10
+        numDevices = 10
+        self.count = numDevMgr
+        self.countCondition = threading.Condition()
+        self.startSignal = threading.Event()
+
+        threads = []
+        for ii in range(1, numDevMgr+1):
+            name = "ConcurrentNode%d" % (ii,)
+            dcdFile = "/nodes/test_Concurrent_nodes/DeviceManager_%d.dcd.xml" % (ii,)
+            self._createNode(name, self.devRoot + dcdFile, numDevices)
+            t = threading.Thread(target=self._threadRegister, args=(dcdFile,))
+            t.start()
+            threads.append(t)
+
+        # Device registration completes asynchronously with respect to the
+        # DeviceManager launch; poll the domain's view of its devices while
+        # the threads start their DeviceManagers, timing each query
+        allocMgr = domMgr._get_allocationMgr()
+        latencies = []
+        registered = 0
+        start = time.time()
+        self.startSignal.set()
+        timeout = start + numDevMgr * 1.0 + numDevMgr * numDevices * 0.1
+        while time.time() < timeout:
+            begin = time.time()
+            domMgr._get_deviceManagers()
+            latencies.append(time.time() - begin)
+            registered = len(allocMgr._get_localDevices())
+            if registered == numDevMgr * numDevices:
+                break
+            time.sleep(0.05)
+        elapsed = time.time() - start
+
+        latencies.sort()
+        print
+        print "Registered %d devices on %d nodes in %.3f s" % (registered, numDevMgr, elapsed)
+        print "deviceManagers query latency (ms): median %.2f max %.2f over %d calls" % (
+            latencies[len(latencies)/2] * 1e3, latencies[-1] * 1e3, len(latencies))
+
+        # Every thread must have finished launching its DeviceManager
+        for t in threads:
+            t.join(numDevMgr * 1.0)
+            self.assertFalse(t.isAlive())
+        self.assertEqual(self.count, 0)
+
+        devMgrs = domMgr._get_deviceManagers()
+        self.assertEqual(len(devMgrs), numDevMgr)
+        identifiers = set(devMgr._get_identifier() for devMgr in devMgrs)
+        self.assertEqual(len(identifiers), numDevMgr)
+
+        # Every device the domain knows about must belong to one of its
+        # DeviceManagers, with each DeviceManager contributing all of its
+        # devices exactly once
+        devicesByNode = dict((identifier, set()) for identifier in identifiers)
+        for location in allocMgr._get_localDevices():
+            identifier = location.devMgr._get_identifier()
+            self.assertTrue(identifier in devicesByNode)
+            devicesByNode[identifier].add(location.dev._get_identifier())
+        for devMgr in devMgrs:
+            devices = devicesByNode[devMgr._get_identifier()]
+            self.assertEqual(len(devices), numDevices)
+            registered = set(dev._get_identifier() for dev in devMgr._get_registeredDevices())
+            self.assertEqual(devices, registered)
+
     def test_WaveformCreation(self):
         """A test to check the ApplicationFactory's ability to handle
            many simulataneous creation and tear down events of an application"""
@@ -25,6 +25,10 @@ from ossie.cf import CF
 from omniORB import CORBA, URI, any
 import struct
 import time
+import os
+import json
+import shutil
+import tempfile
 from ossie.utils import sb
 from ossie.utils import redhawk
 
@@ -810,6 +814,73 @@ class CppCallbacksTest(scatest.CorbaTestCase):
         self.assertEqual(comp.callbacks_run, [])
 
 
+class CppTracingTest(scatest.CorbaTestCase):
+    def setUp(self):
+        self._tempdir = tempfile.mkdtemp()
+        self._tracefiles = []
+
+    def tearDown(self):
+        sb.release()
+        shutil.rmtree(self._tempdir)
+        for path in self._tracefiles:
+            if os.path.exists(path):
+                os.unlink(path)
+        scatest.CorbaTestCase.tearDown(self)
+
+    def test_TraceFrameworkProperties(self):
+        comp = sb.launch('CppCallbacks')
+        ps = comp.ref
+
+        # The trace controls are framework properties, not part of the PRF
+        enabled = CF.DataType(id='TRACE_ENABLED', value=any.to_any(None))
+        dump = CF.DataType(id='TRACE_DUMP', value=any.to_any(None))
+        self.assertEquals(ps.query([enabled])[0].value._v, False)
+        self.assertEquals(ps.query([dump])[0].value._v, '')
+        ids = [p.id for p in ps.query([])]
+        self.assertFalse('TRACE_ENABLED' in ids)
+        self.assertFalse('TRACE_DUMP' in ids)
+        self.assertRaises(CF.PropertySet.InvalidConfiguration, ps.configure,
+                          [CF.DataType(id='TRACE_ENABLED', value=any.to_any('yes'))])
+
+        # Record the component's service function while it runs
+        ps.configure([CF.DataType(id='TRACE_ENABLED', value=any.to_any(True))])
+        self.assertEquals(ps.query([enabled])[0].value._v, True)
+        comp.start()
+        time.sleep(0.5)
+        ps.configure([CF.DataType(id='TRACE_ENABLED', value=any.to_any(False))])
+        self.assertEquals(ps.query([enabled])[0].value._v, False)
+
+        # Dumps are written to a generated file in the trace directory, which
+        # defaults to the component's working directory
+        ps.configure([CF.DataType(id='TRACE_DUMP', value=any.to_any(True))])
+        path = ps.query([dump])[0].value._v
+        self._tracefiles.append(path)
+        self.assertTrue(os.path.isabs(path))
+        self.assertTrue(os.path.basename(path).startswith('trace-'))
+        trace = json.load(open(path))
+        spans = [e for e in trace['traceEvents'] if e['ph'] == 'X']
+        self.assertTrue(('component', 'serviceFunction') in [(s['cat'], s['name']) for s in spans])
+        for span in spans:
+            self.assertTrue(span['dur'] >= 0)
+        names = [e for e in trace['traceEvents'] if e['ph'] == 'M']
+        self.assertTrue(set(s['tid'] for s in spans) <= set(n['tid'] for n in names))
+
+        # Each dump gets its own file
+        ps.configure([CF.DataType(id='TRACE_DUMP', value=any.to_any(True))])
+        second = ps.query([dump])[0].value._v
+        self._tracefiles.append(second)
+        self.assertNotEqual(second, path)
+        self.assertEquals(os.path.dirname(second), os.path.dirname(path))
+        self.assertTrue(os.path.exists(second))
+
+        # Callers cannot choose the path
+        bad_path = os.path.join(self._tempdir, 'trace.json')
+        self.assertRaises(CF.PropertySet.InvalidConfiguration, ps.configure,
+                          [CF.DataType(id='TRACE_DUMP', value=any.to_any(bad_path))])
+        self.assertFalse(os.path.exists(bad_path))
+        self.assertEquals(ps.query([dump])[0].value._v, second)
+
+
 class CPPPropertyTest(scatest.CorbaTestCase):
     def setUp(self):
         self._domBooter, self._domMgr = self.launchDomainManager()